@@ -75,7 +75,7 @@
 
 #define REDCONF_ALIGNMENT_SIZE 4U
 
-#define REDCONF_CRC_ALGORITHM CRC_SLICEBY8
+#define REDCONF_CRC_ALGORITHM CRC_SARWATE
 
 #define REDCONF_INODE_BLOCKS 1
 
@@ -91,7 +91,13 @@
 
 #define REDCONF_BUFFER_ALIGNMENT 8U
 
-#define REDCONF_BUFFER_WRITE_GATHER_SIZE_KB 0U
+#define REDCONF_BUFFER_WRITE_GATHER_SIZE_KB 16U
+
+#define REDCONF_DIR_INDEX_ENTRIES 4096U
+
+#define REDCONF_DIR_INDEX_DIRS 4U
+
+#define REDCONF_DCACHE_ENTRIES 32U
 
 #define RedMemCpyUnchecked memcpy
 
@@ -8,6 +8,7 @@
 
 #include "sd_driver.h"
 #include "usb_device.h"
+#include "usbd_storage_if.h"
 #include "joy_msp.h"
 
 #include <redfs.h>
@@ -57,7 +58,12 @@ int main(void)
 //
 //    HAL_Delay(5000);
 
-    //    MX_USB_DEVICE_Init();   // USB stack initialize
+    /* Open the NOR volume before USB starts: the storage callbacks run in the USB
+       interrupt and only report whether it is ready */
+    (void)STORAGE_Open_FS();
+
+    /* USB mass storage on the NOR volume (owns the media, no red_mount here) */
+    MX_USB_DEVICE_Init();
 
     while (1)
     {
@@ -67,6 +73,8 @@ int main(void)
             joy.sel = RESET;
         }
 
+        /* Storage side of the USB MSC data stages, kept out of the USB interrupt */
+        MX_USB_DEVICE_Process();
     }
 
 }
@@ -91,8 +91,9 @@ void HAL_QSPI_MspInit(QSPI_HandleTypeDef *hqspi)
   HAL_GPIO_Init(QSPI_D3_GPIO_PORT, &GPIO_InitStruct);
 
   /*##-3- Configure the NVIC for QSPI #########################################*/
-  /* NVIC configuration for QSPI interrupt */
-  HAL_NVIC_SetPriority(QUADSPI_IRQn, 0x0F, 0);
+  /* NVIC configuration for QSPI interrupt: above OTG_FS (0x02), whose handlers may wait for
+     flash completion, and below SysTick (0x00), which keeps the HAL timeouts running */
+  HAL_NVIC_SetPriority(QUADSPI_IRQn, 0x01, 0);
   HAL_NVIC_EnableIRQ(QUADSPI_IRQn);
 
   /*##-4- Configure the DMA channel ###########################################*/
@@ -113,8 +114,8 @@ void HAL_QSPI_MspInit(QSPI_HandleTypeDef *hqspi)
   __HAL_LINKDMA(hqspi, hdma, hdma);
   HAL_DMA_Init(&hdma);
 
-  /* NVIC configuration for DMA interrupt */
-  HAL_NVIC_SetPriority(QSPI_DMA_IRQ, 0x00, 0);
+  /* NVIC configuration for DMA interrupt (same level as QUADSPI) */
+  HAL_NVIC_SetPriority(QSPI_DMA_IRQ, 0x01, 0);
   HAL_NVIC_EnableIRQ(QSPI_DMA_IRQ);
 }
 
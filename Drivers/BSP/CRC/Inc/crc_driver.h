@@ -0,0 +1,36 @@
+/*
+ * crc_driver.h
+ *
+ *  Created on: 17 окт. 2026 г.
+ *      Author: SimON
+ *      Brief: CRC-32 over aligned 32-bit words with the STM32 CRC unit
+ *
+ *      Computes the reflected CRC-32 used by Reliance Edge (polynomial
+ *      0x04C11DB7 reflected, initial value and final XOR 0xFFFFFFFF), chained
+ *      the same way as RedCrc32Update: pass 0 to start, then the previous
+ *      result. Words are little-endian, i.e. the bytes as they lie in memory.
+ *
+ *      The F4 CRC unit is fixed to the non-reflected algorithm and can not be
+ *      loaded with a start value, so every word is bit reversed (RBIT) by the
+ *      CPU and the start value is folded into the first word. DMA can not feed
+ *      the unit for this reason: it would write the words unreversed.
+ *
+ *      The unit is shared, calls must not be made concurrently (Reliance Edge
+ *      calls it under its volume mutex).
+ *
+ *      Host builds replace crc_driver.c with Host/Src/crc_host_port.c.
+ */
+
+#ifndef INC_CRC_DRIVER_H_
+#define INC_CRC_DRIVER_H_
+
+#include <stdint.h>
+
+
+/**
+ * Exported driver functions
+ */
+uint32_t crc_driver_update(uint32_t crc, const uint32_t *words, uint32_t count);
+const char *crc_driver_backend(void);
+
+#endif /* INC_CRC_DRIVER_H_ */
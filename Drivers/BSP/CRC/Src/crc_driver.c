@@ -0,0 +1,57 @@
+/*
+ * crc_driver.c
+ *
+ *  Created on: 17 окт. 2026 г.
+ *      Author: SimON
+ */
+#include "crc_driver.h"
+#include "stm32f4xx_hal.h"
+
+
+/**
+ * @brief Update a reflected CRC-32 with 32-bit words
+ *
+ * In the unit's (non-reflected) domain the reflected CRC state ~crc is
+ * __RBIT(~crc) and a word w is __RBIT(w). After the reset the unit holds
+ * 0xFFFFFFFF and XORs the first data word into it, so writing
+ * 0xFFFFFFFF ^ __RBIT(~crc) ^ __RBIT(w0) = __RBIT(w0 ^ crc) starts from the
+ * given state.
+ *
+ * @param crc   Starting CRC value (0 for a new CRC)
+ * @param words Data, 32-bit aligned
+ * @param count Number of words
+ * @return updated CRC value
+ */
+uint32_t crc_driver_update(uint32_t crc, const uint32_t *words, uint32_t count)
+{
+    if (count == 0)
+    {
+        return crc;
+    }
+
+    if ((RCC->AHB1ENR & RCC_AHB1ENR_CRCEN) == 0)
+    {
+        __HAL_RCC_CRC_CLK_ENABLE();
+    }
+
+    CRC->CR = CRC_CR_RESET;
+    CRC->DR = __RBIT(words[0] ^ crc);
+
+    for (uint32_t i = 1; i < count; i++)
+    {
+        // The bus is stalled while the previous word is computed (4 AHB cycles)
+        CRC->DR = __RBIT(words[i]);
+    }
+
+    return ~__RBIT(CRC->DR);
+}
+
+/**
+ * @brief Name of the CRC backend
+ *
+ * @return backend name
+ */
+const char *crc_driver_backend(void)
+{
+    return "stm32-crc";
+}
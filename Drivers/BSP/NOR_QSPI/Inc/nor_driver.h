@@ -34,14 +34,28 @@
 
 
 
-/* Driver block and sector size matched with phy flash memory block and size*/
+/*
+ * LevelX block geometry (changing it requires reformat of the volume):
+ *  - default                   : 64 KByte sector erase, 127 data sectors per block;
+ *  - DRIVER_SUBSECTOR_GEOMETRY : 4 KByte subsector erase, 7 data sectors per block.
+ *                                Reclaim moves at most 7 sectors and an erase stalls
+ *                                I/O for tSSE instead of tSE, 1/8 of the array holds
+ *                                LevelX block metadata.
+ * The last 64 KByte sector is not managed by LevelX in both modes, it holds the
+ * LevelX fast-mount checkpoint records (LX_NOR_ENABLE_CHECKPOINT).
+ */
+#ifdef DRIVER_SUBSECTOR_GEOMETRY
+#define DRIVER_BLOCK_SIZE                    N25_SUBSECTOR_SIZE
+#else
 #define DRIVER_BLOCK_SIZE                    N25_SECTOR_SIZE
-#define DRIVER_BLOCK_COUNT                   N25_SECTOR_COUNT - 1
-#define DRIVER_BASE_OFFSET_MEM               0x90000000
+#endif
+#define DRIVER_BLOCK_COUNT                   ((N25_MEMORY_SIZE - N25_SECTOR_SIZE) / DRIVER_BLOCK_SIZE)
+#define DRIVER_BASE_OFFSET_MEM               0x90000000 /* QUADSPI bank, memory-mapped when LX_DIRECT_READ */
 #define DRIVER_LOWER_ADDRESS_FLASH_MEMORY    DRIVER_BASE_OFFSET_MEM + N25_BASE_ADDR
 #define DRIVER_HIGHER_ADDRESS_FLASH_MEMORY   DRIVER_BASE_OFFSET_MEM + N25_HIGH_ADDR
 #define DRIVER_LOW_BLK_IDX                   N25_LOW_SS_IDX
-#define DRIVER_HIGH_BLK_IDX                  N25_HIGH_SS_IDX
+#define DRIVER_HIGH_BLK_IDX                  (DRIVER_BLOCK_COUNT - 1)
+#define DRIVER_CHECKPOINT_BLOCKS             (N25_SECTOR_SIZE / DRIVER_BLOCK_SIZE) /* Blocks after DRIVER_HIGH_BLK_IDX */
 
 
 /* Default timeout (ms) */
@@ -51,6 +65,9 @@
 
 #define N25Q128A_DEFAULT_TIMEOUT             1000
 
+/* Peripheral flag polls of one wait in the request queue steps (~20 us at 100 MHz) */
+#define N25Q128A_ASYNC_MAX_POLLS             1000
+
 /* Reset Operations */
 #define RESET_ENABLE_CMD                     0x66
 #define RESET_MEMORY_CMD                     0x99
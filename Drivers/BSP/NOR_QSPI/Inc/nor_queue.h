@@ -0,0 +1,159 @@
+/*
+ * nor_queue.h
+ *
+ *  Created on: 17 окт. 2026 г.
+ *      Author: SimON
+ *      Brief: Asynchronous request queue for the QSPI NOR flash
+ *
+ *      Read/program/erase descriptors are queued and executed one after
+ *      another by an interrupt driven state machine:
+ *
+ *      READ    : read command + DMA                -> transfer complete
+ *      PROGRAM : page segments are computed once per request, then for
+ *                every page
+ *                WREN, page program + DMA          -> transfer complete
+ *                WIP auto-poll (IT)                -> status match
+ *                (the next page is started from the status match)
+ *      ERASE   : WREN, erase command,
+ *                WIP auto-poll (IT)                -> status match
+ *
+ *      Transfers up to NORQ_PIO_MAX_SIZE bytes (LevelX metadata words) are
+ *      cheaper in polling mode than DMA setup + interrupt, the port may run
+ *      them synchronously and report the completion before returning.
+ *
+ *      The state machine knows nothing about HAL: hardware steps are started
+ *      through a norq_port and completions are reported back with
+ *      norq_on_transfer_complete/norq_on_status_match/norq_on_error.
+ *      nor_driver.c provides the QUADSPI port (HAL callbacks), the host build
+ *      provides a port on top of the LevelX NOR simulator.
+ *
+ *      Requests are owned by the caller until their callback is invoked (or
+ *      norq_wait returns). The callback runs in interrupt context on target.
+ *
+ *      Every hardware step of a request (data transfer, WIP wait) must end
+ *      within the request timeout. norq_wait checks the step in flight on
+ *      the port millisecond tick while it waits: past the limit the step is
+ *      aborted and the request completes with NORQ_STS_ERROR, so a stuck
+ *      WIP bit or a lost interrupt fails the call instead of hanging it.
+ */
+
+#ifndef INC_NOR_QUEUE_H_
+#define INC_NOR_QUEUE_H_
+
+#include "lx_api.h"
+
+
+/* Page program buffer of the flash */
+#define NORQ_PAGE_SIZE                       256
+
+/* Transfers up to this size may be done by the port without DMA */
+#define NORQ_PIO_MAX_SIZE                    32
+
+
+/**
+ * Request type
+ */
+typedef enum
+{
+    NORQ_OP_READ,
+    NORQ_OP_PROGRAM,
+    NORQ_OP_ERASE
+} norq_op;
+
+/**
+ * Request status
+ */
+typedef enum
+{
+    NORQ_STS_IDLE,      // Not queued
+    NORQ_STS_PENDING,   // Waiting in queue
+    NORQ_STS_ACTIVE,    // Owned by the state machine
+    NORQ_STS_DONE,      // Completed successfully
+    NORQ_STS_ERROR      // Completed with error
+} norq_status;
+
+typedef struct norq_request norq_request;
+
+/* Completion callback */
+typedef void (*norq_callback)(norq_request *req);
+
+/**
+ * Request descriptor
+ */
+struct norq_request
+{
+    norq_op             op;         // Operation
+    ULONG               address;    // Flash address (without fake memory offset)
+    UCHAR              *data;       // Source/destination buffer (not used by ERASE)
+    ULONG               size;       // Size in bytes (ERASE: erase unit size)
+    ULONG               timeout;    // Time limit of one hardware step, port ms (0 - no limit)
+    norq_callback       callback;   // Completion callback, may be NULL
+    void               *context;    // User context for the callback
+    volatile norq_status status;    // Request status
+    ULONG               done;       // Bytes already transferred
+    norq_request       *next;       // Queue link
+};
+
+/**
+ * Hardware port. Every start function returns LX_SUCCESS when the step is
+ * running, its completion is reported through the norq_on_* functions.
+ */
+typedef struct
+{
+    UINT (*write_enable)(void);                                     // WREN (synchronous, WEL set on return, no tick waits: runs in the IRQ)
+    UINT (*read)(ULONG address, UCHAR *data, ULONG size);           // Read + DMA            -> transfer complete
+    UINT (*program)(ULONG address, UCHAR *data, ULONG size);        // Page program + DMA    -> transfer complete
+    UINT (*erase)(ULONG address, ULONG size);                       // Erase + WIP auto-poll -> status match
+    UINT (*poll_ready)(void);                                       // WIP auto-poll         -> status match
+    void (*busy)(void);                                             // Queue leaves idle (close memory-mapped window)
+    void (*idle)(void);                                             // Queue drained (reopen memory-mapped window)
+    void (*wait)(void);                                             // Called by norq_wait while request is in flight
+    void (*lock)(void);                                             // Enter critical section
+    void (*unlock)(void);                                           // Leave critical section
+    ULONG (*ticks)(void);                                           // Free running counter for phase timings
+    ULONG (*ms)(void);                                              // Millisecond tick for the step time limits
+    void (*abort)(void);                                            // Stop the step in flight (time limit hit)
+} norq_port;
+
+/**
+ * Queue statistics
+ */
+typedef struct
+{
+    ULONG               submitted;  // Requests accepted
+    ULONG               completed;  // Requests completed successfully
+    ULONG               failed;     // Requests completed with error
+    ULONG               timeouts;   // Steps aborted on the request time limit
+    ULONG               steps;      // Hardware steps started
+    ULONG               waits;      // Port wait calls made by norq_wait
+    ULONG               max_depth;  // Maximum number of queued requests
+
+    /* Per-phase timings, port ticks (CPU cycles on target, ns on host) */
+    ULONG               pages;          // Page segments programmed
+    ULONG               erases;         // Erase units erased
+    ULONG64             program_bytes;  // Bytes sent with page program
+    ULONG64             read_bytes;     // Bytes read
+    ULONG64             data_ticks;     // WREN + program command + data transfer
+    ULONG64             busy_ticks;     // Page program busy (WIP auto-poll)
+    ULONG64             erase_ticks;    // WREN + erase command + erase busy
+    ULONG64             read_ticks;     // Read command + data transfer
+    ULONG64             request_ticks;  // Request start to completion
+} norq_stats;
+
+
+/**
+ * Exported queue functions
+ */
+void norq_init(const norq_port *port);
+UINT norq_submit(norq_request *req);
+UINT norq_wait(norq_request *req);
+UINT norq_busy(void);
+void norq_stats_get(norq_stats *stats);
+void norq_stats_reset(void);
+
+/* Completion events, called from the port (interrupt context on target) */
+void norq_on_transfer_complete(void);
+void norq_on_status_match(void);
+void norq_on_error(void);
+
+#endif /* INC_NOR_QUEUE_H_ */
@@ -5,6 +5,7 @@
  *      Author: SimON
  */
 #include "nor_driver.h"
+#include "nor_queue.h"
 #include "lx_api.h"
 #include "stm32f4xx.h"
 #include "gpio_defs.h"
@@ -14,13 +15,32 @@
 // QSPI дескриптор
 QSPI_HandleTypeDef QSPIHandle;
 
-// Флаги завершения чтения/записи данных через DMA
-UCHAR __IO TxCplt, RxCplt, ErrCblk = 0;
+// Вложенность критической секции очереди и сохраненный PRIMASK
+static ULONG lock_nesting = 0;
+static ULONG lock_primask = 0;
 
 // ULONG size aligned buffer for driver sector access
 ULONG sector_buffer[LX_NOR_SECTOR_SIZE] __attribute__((aligned(4))) = {0};
 ULONG verify_sector_buffer[LX_NOR_SECTOR_SIZE] __attribute__((aligned(4))) = {0};
 
+#ifdef LX_NOR_ENABLE_CHECKPOINT
+// One bit per LevelX block: changed since the last checkpoint
+static ULONG checkpoint_block_map[(DRIVER_BLOCK_COUNT + 31) / 32];
+#endif
+
+#if defined(LX_NOR_ENABLE_BLOCK_STATS) && !defined(DRIVER_SUBSECTOR_GEOMETRY)
+// Per block counts for the next block to erase (6 KB, 7 KB with LX_NOR_ENABLE_RECLAIM_POLICY),
+// bucketed by obsolete count.
+// Not supplied with 4 KByte blocks: 4080 entries would take 96 KB of RAM or more
+static LX_NOR_FLASH_BLOCK_STATS block_stats[DRIVER_BLOCK_COUNT];
+static USHORT block_stats_buckets[LX_NOR_BLOCK_STATS_BUCKETS(DRIVER_BLOCK_SIZE / sizeof(ULONG))];
+#endif
+
+#ifdef LX_DIRECT_READ
+// Флаг активного memory-mapped окна (чтение QSPI банка напрямую по адресу 0x90000000)
+UCHAR __IO MemMapped = 0;
+#endif
+
 
 
 /* Driver auxiliary functions*/
@@ -28,10 +48,46 @@ UINT _driver_qspi_init(void);
 UINT _driver_nor_flash_wait_eop(ULONG);
 UINT _driver_nor_flash_write_enable(void);
 UINT _driver_nor_flash_configure(void);
-UINT _driver_nor_flash_page_prog(ULONG address, UCHAR* data, ULONG size);
+UINT _driver_nor_flash_memory_mapped_enter(void);
+UINT _driver_nor_flash_memory_mapped_exit(void);
 UINT _driver_test_block(ULONG block);
 UINT compare_buffers(uint8_t *dst, uint8_t *src, uint32_t size);
 
+/* Request queue port (interrupt driven steps) */
+static UINT _driver_async_wait_flag(ULONG flags, ULONG set);
+static UINT _driver_async_command(ULONG ccr, ULONG address, ULONG size);
+static UINT _driver_async_command_end(void);
+static UINT _driver_async_write_enable(void);
+static UINT _driver_async_read(ULONG address, UCHAR *data, ULONG size);
+static UINT _driver_async_program(ULONG address, UCHAR *data, ULONG size);
+static UINT _driver_async_erase(ULONG address, ULONG size);
+static UINT _driver_async_poll_ready(void);
+static void _driver_async_busy(void);
+static void _driver_async_idle(void);
+static void _driver_async_wait(void);
+static void _driver_async_lock(void);
+static void _driver_async_unlock(void);
+static ULONG _driver_async_ticks(void);
+static ULONG _driver_async_ms(void);
+static void _driver_async_abort(void);
+
+static const norq_port driver_queue_port =
+{
+    _driver_async_write_enable,
+    _driver_async_read,
+    _driver_async_program,
+    _driver_async_erase,
+    _driver_async_poll_ready,
+    _driver_async_busy,
+    _driver_async_idle,
+    _driver_async_wait,
+    _driver_async_lock,
+    _driver_async_unlock,
+    _driver_async_ticks,
+    _driver_async_ms,
+    _driver_async_abort
+};
+
 /* IO driver main functions */
 UINT _driver_nor_flash_block_erase(ULONG block, ULONG erase_count);
 UINT _driver_nor_flash_read(ULONG *flash_address, ULONG *destination, ULONG words);
@@ -59,6 +115,18 @@ UINT flash_driver_init(LX_NOR_FLASH *instance)
     // RAM buffer 512 bytes aligned by 4 bytes
     instance->lx_nor_flash_sector_buffer   = (ULONG*)&sector_buffer[0];
 
+#ifdef LX_NOR_ENABLE_CHECKPOINT
+    // Checkpoint records live in the last sector, right after the managed blocks
+    instance->lx_nor_flash_checkpoint_blocks    = DRIVER_CHECKPOINT_BLOCKS;
+    instance->lx_nor_flash_checkpoint_block_map = checkpoint_block_map;
+#endif
+
+#if defined(LX_NOR_ENABLE_BLOCK_STATS) && !defined(DRIVER_SUBSECTOR_GEOMETRY)
+    // RAM block statistics, filled by lx_nor_flash_open
+    instance->lx_nor_flash_block_stats         = block_stats;
+    instance->lx_nor_flash_block_stats_buckets = block_stats_buckets;
+#endif
+
     // Link driver function
     instance->lx_nor_flash_driver_read                  = _driver_nor_flash_read;
     instance->lx_nor_flash_driver_write                 = _driver_nor_flash_write;
@@ -72,12 +140,26 @@ UINT flash_driver_init(LX_NOR_FLASH *instance)
         return LX_ERROR;
     }
 
+    // Cycle counter for the queue phase timings
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL  |= DWT_CTRL_CYCCNTENA_Msk;
+
+    // Attach request queue to QUADSPI
+    norq_init(&driver_queue_port);
+
     // Configure flash memory
     if (_driver_nor_flash_configure() != LX_SUCCESS)
     {
         return LX_ERROR;
     }
 
+    // Open read window for LevelX direct metadata access
+    if (_driver_nor_flash_memory_mapped_enter() != LX_SUCCESS)
+    {
+        return LX_ERROR;
+    }
+
     return LX_SUCCESS;
 }
 
@@ -88,6 +170,12 @@ UINT flash_driver_init(LX_NOR_FLASH *instance)
  */
 UINT flash_driver_deinit()
 {
+    /* Close read window */
+    if (_driver_nor_flash_memory_mapped_exit() != LX_SUCCESS)
+    {
+        return LX_ERROR;
+    }
+
     /* Deinitialize QSPI peripheral*/
     if (HAL_QSPI_DeInit(&QSPIHandle) != HAL_OK)
     {
@@ -109,6 +197,8 @@ UINT flash_driver_deinit()
  */
 UINT _driver_nor_flash_write(ULONG *flash_address, ULONG *source, ULONG words)
 {
+    norq_request req = {0};
+
     // Is address valid ?
     if ((ULONG)flash_address > DRIVER_HIGHER_ADDRESS_FLASH_MEMORY || (ULONG)flash_address < DRIVER_LOWER_ADDRESS_FLASH_MEMORY)
     {
@@ -119,55 +209,19 @@ UINT _driver_nor_flash_write(ULONG *flash_address, ULONG *source, ULONG words)
         flash_address = flash_address - DRIVER_BASE_OFFSET_MEM / sizeof(ULONG); // Удаляем фейковый оффсет адреса памяти
     }
 
-    ULONG address = (ULONG)flash_address; // Extract address from pointer
-    ULONG size = words * sizeof(ULONG);   // Calculate size in bytes
-    UCHAR *data = (UCHAR*)source;         // Byte pointer to source data
-
-    // Остаток байт вмещающихся до границы программируемой страницы
-    ULONG temp_prog_size = N25_PAGE_PROG_SIZE - (address % N25_PAGE_PROG_SIZE);
-    ULONG temp_prog_addr = address;        // Счетчик адреса
-    ULONG end_address    = address + size; // Адрес байта следующего за последним байтом запрограмированных данных
-
-    // Если свободного места больше чем у нас имеется данных для записи
-    if (size < temp_prog_size)
-    {
-        /*
-         * Когда размер программируемых данных меньше пустой области до конца
-         * программируемой странице, функция программирования страницы будет
-         * вызвана один раз только для программирования этого кусочка данных.
-         * Поэтому программируемый размер данных составит ровно столько, сколько
-         * передано в функцию.
-         */
-        temp_prog_size = size;
-    }
+    // Разбиение на программируемые страницы выполняет очередь
+    req.op      = NORQ_OP_PROGRAM;
+    req.address = (ULONG)flash_address;   // Extract address from pointer
+    req.data    = (UCHAR*)source;         // Byte pointer to source data
+    req.size    = words * sizeof(ULONG);  // Calculate size in bytes
+    req.timeout = N25Q128A_DEFAULT_TIMEOUT; // Per page: transfer, then tPP
 
-    do
+    if (norq_submit(&req) != LX_SUCCESS)
     {
-        // Выполняем программирование с учетом полученного выравнивающего количества данных для первой страницы
-        if (_driver_nor_flash_page_prog(temp_prog_addr, data, temp_prog_size) != LX_SUCCESS)
-        {
-            return LX_ERROR;
-        }
-
-        // Увеличиваем счетчики
-        temp_prog_addr += temp_prog_size;
-        data           += temp_prog_size;
-
-        // Если до конца памяти осталось меньше чем размер программируемой страницы
-        if ((temp_prog_addr + N25_PAGE_PROG_SIZE) > end_address)
-        {
-            // Последний чанк есть разница между адресами конца и текущего
-            temp_prog_size = end_address - temp_prog_addr;
-        }
-        else
-        {
-            // В противном случае размер равен полному блоку программируемой страницы
-            temp_prog_size = N25_PAGE_PROG_SIZE;
-        }
+        return LX_ERROR;
     }
-    while(temp_prog_addr < end_address);
 
-    return LX_SUCCESS;
+    return norq_wait(&req);
 }
 
 
@@ -181,6 +235,7 @@ UINT _driver_nor_flash_write(ULONG *flash_address, ULONG *source, ULONG words)
  */
 UINT _driver_nor_flash_read(ULONG *flash_address, ULONG *destination, ULONG words)
 {
+    norq_request req = {0};
 
     // Is address valid ?
     if ((ULONG)flash_address > DRIVER_HIGHER_ADDRESS_FLASH_MEMORY || (ULONG)flash_address < DRIVER_LOWER_ADDRESS_FLASH_MEMORY)
@@ -188,61 +243,47 @@ UINT _driver_nor_flash_read(ULONG *flash_address, ULONG *destination, ULONG word
         // IO error !
         _driver_nor_flash_system_error(LX_ERROR);
     }
-    else
-    {
-        // Extract offset
-        flash_address = flash_address - DRIVER_BASE_OFFSET_MEM / sizeof(ULONG);
-    }
-
-    QSPI_CommandTypeDef cmd;
 
-    /* Command params struct fill */
-    cmd.InstructionMode   = QSPI_INSTRUCTION_1_LINE;
-    cmd.AddressSize       = QSPI_ADDRESS_24_BITS;
-    cmd.AddressMode       = QSPI_ADDRESS_4_LINES;
-    cmd.DataMode          = QSPI_DATA_4_LINES;
-    cmd.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE;
-    cmd.DdrMode           = QSPI_DDR_MODE_DISABLE;
-    cmd.DdrHoldHalfCycle  = QSPI_DDR_HHC_ANALOG_DELAY;
-    cmd.SIOOMode          = QSPI_SIOO_INST_EVERY_CMD;
+#ifdef LX_DIRECT_READ
+    // Read window is open while no request is in flight
+    if (norq_busy() == 0)
+    {
+        if (_driver_nor_flash_memory_mapped_enter() != LX_SUCCESS)
+        {
+            return LX_ERROR;
+        }
 
-    /* Read data */
-    cmd.Instruction = QUAD_INOUT_FAST_READ_CMD;
-    cmd.Address     = (ULONG)flash_address;
-    cmd.DummyCycles = N25Q128A_VCR_NB_DUMMY >> 4;
-    cmd.NbData = words * sizeof(ULONG); // Data transfer size in bytes
+        // Plain loads from QSPI bank, quad I/O fast read is issued by the peripheral
+        while (words--)
+        {
+            *destination++ = *flash_address++;
+        }
 
-    if (HAL_QSPI_Command(&QSPIHandle, &cmd, N25Q128A_DEFAULT_TIMEOUT) != HAL_OK)
-    {
-        return LX_ERROR;
+        return LX_SUCCESS;
     }
+#endif
 
-    MODIFY_REG(QSPIHandle.Instance->DCR, QUADSPI_DCR_CSHT, QSPI_CS_HIGH_TIME_2_CYCLE);
+    // Extract offset
+    flash_address = flash_address - DRIVER_BASE_OFFSET_MEM / sizeof(ULONG);
 
-    if (HAL_QSPI_Receive_DMA(&QSPIHandle, (uint8_t*)destination) != HAL_OK)
-    {
-        return LX_ERROR;
-    }
+    // Indirect read + DMA through the queue
+    req.op      = NORQ_OP_READ;
+    req.address = (ULONG)flash_address;
+    req.data    = (UCHAR*)destination;
+    req.size    = words * sizeof(ULONG); // Data transfer size in bytes
+    req.timeout = N25Q128A_DEFAULT_TIMEOUT;
 
-    // Waiting EOR
-    while(RxCplt == 0 && ErrCblk == 0);
-    RxCplt = 0;
-    if (ErrCblk != 0)
+    if (norq_submit(&req) != LX_SUCCESS)
     {
-        ErrCblk = 0;
         return LX_ERROR;
     }
 
-
-    /* Restore S# timing for nonRead commands */
-    MODIFY_REG(QSPIHandle.Instance->DCR, QUADSPI_DCR_CSHT, QSPI_CS_HIGH_TIME_5_CYCLE);
-
-    return LX_SUCCESS;
+    return norq_wait(&req);
 }
 
 
 /**
- * @brief Perform SUBSECTOR erase (4-kByte size sector)
+ * @brief Erase one LevelX block (64 KByte sector or 4 KByte subsector, see DRIVER_BLOCK_SIZE)
  *
  * @param block			: Number of block
  * @param erase_count   : Diagnostic information
@@ -250,50 +291,27 @@ UINT _driver_nor_flash_read(ULONG *flash_address, ULONG *destination, ULONG word
  */
 UINT _driver_nor_flash_block_erase(ULONG block, ULONG erase_count)
 {
-    // Is block valid ?
-    if (block > DRIVER_HIGH_BLK_IDX || block < DRIVER_LOW_BLK_IDX)
+    norq_request req = {0};
+
+    // Is block valid ? (checkpoint blocks included)
+    if (block > (DRIVER_HIGH_BLK_IDX + DRIVER_CHECKPOINT_BLOCKS) || block < DRIVER_LOW_BLK_IDX)
     {
         // IO error !
         _driver_nor_flash_system_error(LX_ERROR);
     }
 
-    QSPI_CommandTypeDef cmd;
-
-    /* Erasing Sequence -------------------------------------------------- */
-    cmd.AddressSize       = QSPI_ADDRESS_24_BITS;
-    cmd.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE;
-    cmd.DdrMode           = QSPI_DDR_MODE_DISABLE;
-    cmd.DdrHoldHalfCycle  = QSPI_DDR_HHC_ANALOG_DELAY;
-    cmd.SIOOMode          = QSPI_SIOO_INST_EVERY_CMD;
-
-    cmd.Instruction         = SECTOR_ERASE_CMD;
-    cmd.AddressMode         = QSPI_ADDRESS_1_LINE;
-    cmd.InstructionMode     = QSPI_INSTRUCTION_1_LINE;
-    cmd.DataMode            = QSPI_DATA_NONE;
-    cmd.DummyCycles         = 0;
-
-    // Write enable latch set
-    if (_driver_nor_flash_write_enable() != LX_SUCCESS)
-    {
-        return LX_ERROR; // Exit if error occured
-    }
-
     // Calculate block address
-    cmd.Address = block * DRIVER_BLOCK_SIZE;
-
-    // Send ERASE command
-    if (HAL_QSPI_Command(&QSPIHandle, &cmd, N25Q128A_DEFAULT_TIMEOUT) != HAL_OK)
-    {
-        return LX_ERROR;
-    }
+    req.op      = NORQ_OP_ERASE;
+    req.address = block * DRIVER_BLOCK_SIZE;
+    req.size    = DRIVER_BLOCK_SIZE;
+    req.timeout = (DRIVER_BLOCK_SIZE == N25_SECTOR_SIZE) ? N25Q128A_SECTOR_ERASE_MAX_TIME : N25Q128A_SUBSECTOR_ERASE_MAX_TIME;
 
-    // Wait end of end ERASE subsector sequence
-    if (_driver_nor_flash_wait_eop(N25Q128A_SUBSECTOR_ERASE_MAX_TIME) != LX_SUCCESS)
+    if (norq_submit(&req) != LX_SUCCESS)
     {
         return LX_ERROR;
     }
 
-    return LX_SUCCESS;
+    return norq_wait(&req);
 }
 
 
@@ -352,69 +370,6 @@ UINT _driver_nor_flash_system_error(UINT error_code)
 
 /** AUXILLARY FUNCTIONS FOR DRIVER **/
 
-/**
- * @brief Place 256-byte page into selected area by address
- *
- * @param address : Address in FLASH memory
- * @param data    : Pointer to data buffer
- * @param size    : Buffer size (in bytes)
- * @return
- */
-UINT _driver_nor_flash_page_prog(ULONG address, UCHAR* data, ULONG size)
-{
-    QSPI_CommandTypeDef cmd;
-
-    if (_driver_nor_flash_write_enable() != LX_SUCCESS)
-    {
-        return LX_ERROR;
-    }
-
-    /* Command params struct fill */
-    cmd.InstructionMode   = QSPI_INSTRUCTION_1_LINE;
-    cmd.AddressMode       = QSPI_ADDRESS_4_LINES;
-    cmd.AddressSize       = QSPI_ADDRESS_24_BITS;
-    cmd.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE;
-    cmd.DataMode          = QSPI_DATA_4_LINES;
-    cmd.DummyCycles       = 0;
-    cmd.DdrMode           = QSPI_DDR_MODE_DISABLE;
-    cmd.DdrHoldHalfCycle  = QSPI_DDR_HHC_ANALOG_DELAY;
-    cmd.SIOOMode          = QSPI_SIOO_INST_EVERY_CMD;
-
-    /* Write data command*/
-    cmd.Instruction = EXT_QUAD_IN_FAST_PROG_CMD;
-    cmd.Address     = address;
-    cmd.DummyCycles = 0;
-    cmd.NbData      = size; // Data transfer size in bytes
-
-    if (HAL_QSPI_Command(&QSPIHandle, &cmd, N25Q128A_DEFAULT_TIMEOUT) != HAL_OK)
-    {
-        return LX_ERROR;
-    }
-
-    if (HAL_QSPI_Transmit_DMA(&QSPIHandle, (uint8_t*)data) != HAL_OK)
-    {
-        return LX_ERROR;
-    }
-
-    // Waiting EOT
-    while(TxCplt == 0 && ErrCblk == 0);
-    TxCplt = 0;
-    if (ErrCblk != 0)
-    {
-        ErrCblk = 0;
-        return LX_ERROR;
-    }
-
-    // Wait EOP
-    if (_driver_nor_flash_wait_eop(N25Q128A_DEFAULT_TIMEOUT) != LX_SUCCESS)
-    {
-        return LX_ERROR;
-    }
-
-    return LX_SUCCESS;
-}
-
-
 /**
  * Perform QUADSPI MCU peripheral init + setting up memory
  * @return Status of initialization process
@@ -425,6 +380,11 @@ UINT _driver_qspi_init()
     QSPIHandle.Instance = QUADSPI;
     HAL_QSPI_DeInit(&QSPIHandle);
 
+#ifdef LX_DIRECT_READ
+    // Peripheral reset closes read window
+    MemMapped = 0;
+#endif
+
     QSPIHandle.Init.ClockPrescaler = 0;
     QSPIHandle.Init.FifoThreshold = 1;
     QSPIHandle.Init.SampleShifting = QSPI_SAMPLE_SHIFTING_HALFCYCLE;
@@ -553,6 +513,11 @@ UINT _driver_nor_flash_bulk_erase()
 {
     QSPI_CommandTypeDef cmd;
 
+    if (_driver_nor_flash_memory_mapped_exit() != LX_SUCCESS)
+    {
+        return LX_ERROR;
+    }
+
     if (_driver_nor_flash_write_enable() != LX_SUCCESS)
     {
         return LX_ERROR;
@@ -580,6 +545,90 @@ UINT _driver_nor_flash_bulk_erase()
         return LX_ERROR;
     }
 
+    return _driver_nor_flash_memory_mapped_enter();
+}
+
+
+/**
+ * @brief Open memory-mapped read window (quad I/O fast read)
+ *
+ * With LX_DIRECT_READ LevelX dereferences lx_nor_flash_base_address, so the
+ * QSPI bank must stay mapped whenever no program/erase is running.
+ * Timeout counter is disabled: nCS stays low between accesses, the window is
+ * always closed by abort before the next indirect command.
+ *
+ * @return Error code
+ */
+UINT _driver_nor_flash_memory_mapped_enter()
+{
+#ifdef LX_DIRECT_READ
+    QSPI_CommandTypeDef cmd;
+    QSPI_MemoryMappedTypeDef cfg;
+
+    // Already mapped
+    if (MemMapped != 0)
+    {
+        return LX_SUCCESS;
+    }
+
+    /* Read command used by the peripheral for every bus access */
+    cmd.InstructionMode   = QSPI_INSTRUCTION_1_LINE;
+    cmd.Instruction       = QUAD_INOUT_FAST_READ_CMD;
+    cmd.AddressSize       = QSPI_ADDRESS_24_BITS;
+    cmd.AddressMode       = QSPI_ADDRESS_4_LINES;
+    cmd.DataMode          = QSPI_DATA_4_LINES;
+    cmd.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE;
+    cmd.DummyCycles       = N25Q128A_VCR_NB_DUMMY >> 4;
+    cmd.DdrMode           = QSPI_DDR_MODE_DISABLE;
+    cmd.DdrHoldHalfCycle  = QSPI_DDR_HHC_ANALOG_DELAY;
+    cmd.SIOOMode          = QSPI_SIOO_INST_EVERY_CMD;
+
+    cfg.TimeOutActivation = QSPI_TIMEOUT_COUNTER_DISABLE;
+    cfg.TimeOutPeriod     = 0;
+
+    /* Same S# timing as indirect read */
+    MODIFY_REG(QSPIHandle.Instance->DCR, QUADSPI_DCR_CSHT, QSPI_CS_HIGH_TIME_2_CYCLE);
+
+    if (HAL_QSPI_MemoryMapped(&QSPIHandle, &cmd, &cfg) != HAL_OK)
+    {
+        return LX_ERROR;
+    }
+
+    MemMapped = 1;
+#endif
+
+    return LX_SUCCESS;
+}
+
+
+/**
+ * @brief Close memory-mapped read window before indirect command
+ *
+ * Abort stops the prefetch and releases nCS, the peripheral returns to
+ * indirect mode with default S# timing.
+ *
+ * @return Error code
+ */
+UINT _driver_nor_flash_memory_mapped_exit()
+{
+#ifdef LX_DIRECT_READ
+    // Not mapped
+    if (MemMapped == 0)
+    {
+        return LX_SUCCESS;
+    }
+
+    if (HAL_QSPI_Abort(&QSPIHandle) != HAL_OK)
+    {
+        return LX_ERROR;
+    }
+
+    /* Restore S# timing for nonRead commands */
+    MODIFY_REG(QSPIHandle.Instance->DCR, QUADSPI_DCR_CSHT, QSPI_CS_HIGH_TIME_5_CYCLE);
+
+    MemMapped = 0;
+#endif
+
     return LX_SUCCESS;
 }
 
@@ -630,6 +679,369 @@ UINT _driver_nor_flash_write_enable()
 
 }
 
+/** REQUEST QUEUE PORT (INTERRUPT DRIVEN STEPS) **/
+
+/**
+ * @brief Wait for a QUADSPI status flag with a bounded count of polls. The
+ *        queue steps run from the QUADSPI/DMA interrupt or with interrupts
+ *        masked, so the HAL waits on HAL_GetTick can't be used there.
+ *
+ * @param flags : QUADSPI_SR flags (any of them)
+ * @param set   : Wait for set (1) or for all of them cleared (0)
+ * @return status of operation
+ */
+static UINT _driver_async_wait_flag(ULONG flags, ULONG set)
+{
+    ULONG polls = N25Q128A_ASYNC_MAX_POLLS;
+
+    while ((READ_BIT(QSPIHandle.Instance->SR, flags) != 0) != (set != 0))
+    {
+        if (--polls == 0)
+        {
+            return LX_ERROR;
+        }
+    }
+
+    return LX_SUCCESS;
+}
+
+/**
+ * @brief Start an indirect write command on the registers (HAL_QSPI_Command
+ *        without its tick waits). Without a data phase the command runs
+ *        right away, with data it waits for the FIFO (or for the switch to
+ *        indirect read and the AR rewrite).
+ *
+ * @param ccr     : CCR value (instruction, modes, dummy cycles)
+ * @param address : Address (written only with an address phase)
+ * @param size    : Data size in bytes (0 - no data phase)
+ * @return status of operation
+ */
+static UINT _driver_async_command(ULONG ccr, ULONG address, ULONG size)
+{
+    // Предыдущая команда (остановка auto-polling, DMA) должна завершиться
+    if (_driver_async_wait_flag(QUADSPI_SR_BUSY, 0) != LX_SUCCESS)
+    {
+        return LX_ERROR;
+    }
+
+    WRITE_REG(QSPIHandle.Instance->FCR, QUADSPI_FCR_CTCF);
+
+    if (size != 0)
+    {
+        WRITE_REG(QSPIHandle.Instance->DLR, size - 1);
+    }
+
+    // FMODE = 00: indirect write
+    WRITE_REG(QSPIHandle.Instance->CCR, ccr & ~QUADSPI_CCR_FMODE);
+
+    if (READ_BIT(ccr, QUADSPI_CCR_ADMODE) != 0)
+    {
+        WRITE_REG(QSPIHandle.Instance->AR, address);
+    }
+
+    return LX_SUCCESS;
+}
+
+/**
+ * @brief Wait for the end of the command and clear the flag
+ *
+ * @return status of operation
+ */
+static UINT _driver_async_command_end(void)
+{
+    if (_driver_async_wait_flag(QUADSPI_SR_TCF, 1) != LX_SUCCESS)
+    {
+        return LX_ERROR;
+    }
+
+    WRITE_REG(QSPIHandle.Instance->FCR, QUADSPI_FCR_CTCF);
+
+    return LX_SUCCESS;
+}
+
+/**
+ * @brief Write Enable of the queue steps. The next page is started from the
+ *        QUADSPI interrupt: the instruction only command is polled on the
+ *        peripheral flags. WEL is set when the command ends, no status read
+ *        is needed.
+ *
+ * @return status of operation
+ */
+static UINT _driver_async_write_enable(void)
+{
+    if (_driver_async_command(QSPI_INSTRUCTION_1_LINE | WRITE_ENABLE_CMD, 0, 0) != LX_SUCCESS)
+    {
+        return LX_ERROR;
+    }
+
+    return _driver_async_command_end();
+}
+
+/**
+ * @brief Start quad I/O fast read with DMA (short reads are done in polling mode)
+ *
+ * @param address : Address in FLASH memory
+ * @param data    : Destination buffer
+ * @param size    : Size in bytes
+ * @return status of operation (completion -> HAL_QSPI_RxCpltCallback)
+ */
+static UINT _driver_async_read(ULONG address, UCHAR *data, ULONG size)
+{
+    ULONG ccr = QSPI_INSTRUCTION_1_LINE | QSPI_ADDRESS_4_LINES | QSPI_ADDRESS_24_BITS |
+                QSPI_DATA_4_LINES | ((N25Q128A_VCR_NB_DUMMY >> 4) << QUADSPI_CCR_DCYC_Pos) |
+                QUAD_INOUT_FAST_READ_CMD;
+    UINT status = LX_SUCCESS;
+
+    if (_driver_async_command(ccr, address, size) != LX_SUCCESS)
+    {
+        return LX_ERROR;
+    }
+
+    MODIFY_REG(QSPIHandle.Instance->DCR, QUADSPI_DCR_CSHT, QSPI_CS_HIGH_TIME_2_CYCLE);
+
+    // Несколько слов быстрее забрать из FIFO, чем настраивать DMA и ждать прерывание
+    if (size <= NORQ_PIO_MAX_SIZE)
+    {
+        // Переключение в indirect read и повторная запись AR запускают чтение
+        MODIFY_REG(QSPIHandle.Instance->CCR, QUADSPI_CCR_FMODE, QUADSPI_CCR_FMODE_0);
+        WRITE_REG(QSPIHandle.Instance->AR, address);
+
+        while ((size-- != 0) && (status == LX_SUCCESS))
+        {
+            status = _driver_async_wait_flag(QUADSPI_SR_FTF | QUADSPI_SR_TCF, 1);
+            if (status == LX_SUCCESS)
+            {
+                *data++ = *(__IO uint8_t *)&QSPIHandle.Instance->DR;
+            }
+        }
+
+        if (status == LX_SUCCESS)
+        {
+            status = _driver_async_command_end();
+        }
+
+        /* Restore S# timing for nonRead commands */
+        MODIFY_REG(QSPIHandle.Instance->DCR, QUADSPI_DCR_CSHT, QSPI_CS_HIGH_TIME_5_CYCLE);
+
+        if (status != LX_SUCCESS)
+        {
+            return LX_ERROR;
+        }
+
+        norq_on_transfer_complete();
+        return LX_SUCCESS;
+    }
+
+    if (HAL_QSPI_Receive_DMA(&QSPIHandle, (uint8_t*)data) != HAL_OK)
+    {
+        return LX_ERROR;
+    }
+
+    return LX_SUCCESS;
+}
+
+/**
+ * @brief Start program of one page (or its part) with DMA (short segments
+ *        are sent in polling mode). WEL must be set by the caller.
+ *
+ * @param address : Address in FLASH memory
+ * @param data    : Source buffer
+ * @param size    : Size in bytes (up to the page boundary)
+ * @return status of operation (completion -> HAL_QSPI_TxCpltCallback)
+ */
+static UINT _driver_async_program(ULONG address, UCHAR *data, ULONG size)
+{
+    ULONG ccr = QSPI_INSTRUCTION_1_LINE | QSPI_ADDRESS_4_LINES | QSPI_ADDRESS_24_BITS |
+                QSPI_DATA_4_LINES | EXT_QUAD_IN_FAST_PROG_CMD;
+
+    if (_driver_async_command(ccr, address, size) != LX_SUCCESS)
+    {
+        return LX_ERROR;
+    }
+
+    // Метаданные LevelX (одно слово) отправляем без DMA
+    if (size <= NORQ_PIO_MAX_SIZE)
+    {
+        while (size-- != 0)
+        {
+            if (_driver_async_wait_flag(QUADSPI_SR_FTF, 1) != LX_SUCCESS)
+            {
+                return LX_ERROR;
+            }
+
+            *(__IO uint8_t *)&QSPIHandle.Instance->DR = *data++;
+        }
+
+        if (_driver_async_command_end() != LX_SUCCESS)
+        {
+            return LX_ERROR;
+        }
+
+        norq_on_transfer_complete();
+        return LX_SUCCESS;
+    }
+
+    if (HAL_QSPI_Transmit_DMA(&QSPIHandle, (uint8_t*)data) != HAL_OK)
+    {
+        return LX_ERROR;
+    }
+
+    return LX_SUCCESS;
+}
+
+/**
+ * @brief Send erase command and start WIP auto-polling. WEL must be set by the caller.
+ *
+ * @param address : Address of the erase unit
+ * @param size    : Erase unit size (64 KByte sector or 4 KByte subsector)
+ * @return status of operation (completion -> HAL_QSPI_StatusMatchCallback)
+ */
+static UINT _driver_async_erase(ULONG address, ULONG size)
+{
+    ULONG ccr = QSPI_INSTRUCTION_1_LINE | QSPI_ADDRESS_1_LINE | QSPI_ADDRESS_24_BITS |
+                ((size == N25_SECTOR_SIZE) ? SECTOR_ERASE_CMD : SUBSECTOR_ERASE_CMD);
+
+    // Send ERASE command
+    if ((_driver_async_command(ccr, address, 0) != LX_SUCCESS) ||
+        (_driver_async_command_end() != LX_SUCCESS))
+    {
+        return LX_ERROR;
+    }
+
+    return _driver_async_poll_ready();
+}
+
+/**
+ * @brief Start WIP auto-polling in interrupt mode
+ *
+ * @return status of operation (completion -> HAL_QSPI_StatusMatchCallback)
+ */
+static UINT _driver_async_poll_ready(void)
+{
+    QSPI_CommandTypeDef cmd;
+    QSPI_AutoPollingTypeDef cfg;
+
+    /* Configure automatic polling mode to wait for memory ready ------ */
+    cmd.InstructionMode = QSPI_INSTRUCTION_1_LINE;
+    cmd.Instruction = READ_STATUS_REG_CMD;
+    cmd.AddressMode = QSPI_ADDRESS_NONE;
+    cmd.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE;
+    cmd.DataMode = QSPI_DATA_1_LINE;
+    cmd.DummyCycles = 0;
+    cmd.DdrMode = QSPI_DDR_MODE_DISABLE;
+    cmd.DdrHoldHalfCycle = QSPI_DDR_HHC_ANALOG_DELAY;
+    cmd.SIOOMode = QSPI_SIOO_INST_EVERY_CMD;
+
+    cfg.Match = 0x00;
+    cfg.Mask = 0x01;
+    cfg.MatchMode = QSPI_MATCH_MODE_AND;
+    cfg.StatusBytesSize = 1;
+    cfg.Interval = 0x10;
+    cfg.AutomaticStop = QSPI_AUTOMATIC_STOP_ENABLE;
+
+    // HAL ждет BUSY по HAL_GetTick: к вызову флаг уже должен быть сброшен
+    if (_driver_async_wait_flag(QUADSPI_SR_BUSY, 0) != LX_SUCCESS)
+    {
+        return LX_ERROR;
+    }
+
+    if (HAL_QSPI_AutoPolling_IT(&QSPIHandle, &cmd, &cfg) != HAL_OK)
+    {
+        return LX_ERROR;
+    }
+
+    return LX_SUCCESS;
+}
+
+/**
+ * @brief Queue leaves idle state: indirect mode is needed
+ */
+static void _driver_async_busy(void)
+{
+    if (_driver_nor_flash_memory_mapped_exit() != LX_SUCCESS)
+    {
+        _driver_nor_flash_system_error(LX_ERROR);
+    }
+}
+
+/**
+ * @brief Queue drained: reopen read window
+ */
+static void _driver_async_idle(void)
+{
+    if (_driver_nor_flash_memory_mapped_enter() != LX_SUCCESS)
+    {
+        _driver_nor_flash_system_error(LX_ERROR);
+    }
+}
+
+/**
+ * @brief Sleep until the next interrupt (called with interrupts masked,
+ *        pending QUADSPI/DMA interrupt wakes the core up)
+ */
+static void _driver_async_wait(void)
+{
+    __WFI();
+}
+
+/**
+ * @brief Enter queue critical section (nested)
+ */
+static void _driver_async_lock(void)
+{
+    ULONG primask = __get_PRIMASK();
+
+    __disable_irq();
+    if (lock_nesting++ == 0)
+    {
+        lock_primask = primask;
+    }
+}
+
+/**
+ * @brief Leave queue critical section
+ */
+static void _driver_async_unlock(void)
+{
+    if (--lock_nesting == 0)
+    {
+        __set_PRIMASK(lock_primask);
+    }
+}
+
+/**
+ * @brief Time base of the queue statistics
+ *
+ * @return CPU cycle counter
+ */
+static ULONG _driver_async_ticks(void)
+{
+    return DWT->CYCCNT;
+}
+
+/**
+ * @brief Time base of the request time limits
+ *
+ * @return HAL millisecond tick
+ */
+static ULONG _driver_async_ms(void)
+{
+    return HAL_GetTick();
+}
+
+/**
+ * @brief Stop the step over its time limit: DMA, auto-polling or the
+ *        command in flight (called with interrupts enabled)
+ */
+static void _driver_async_abort(void)
+{
+    (void)HAL_QSPI_Abort(&QSPIHandle);
+
+    /* Restore S# timing for nonRead commands */
+    MODIFY_REG(QSPIHandle.Instance->DCR, QUADSPI_DCR_CSHT, QSPI_CS_HIGH_TIME_5_CYCLE);
+}
+
+
 /**
  * @brief Проверка стирания, записи и удержания информации в секторе (64 KByte)
  *
@@ -706,19 +1118,27 @@ UINT compare_buffers(uint8_t *dst, uint8_t *src, uint32_t size)
 void HAL_QSPI_RxCpltCallback(QSPI_HandleTypeDef *hqspi)
 {
     (void)hqspi;
-    RxCplt = 1;
+
+    /* Restore S# timing for nonRead commands */
+    MODIFY_REG(QSPIHandle.Instance->DCR, QUADSPI_DCR_CSHT, QSPI_CS_HIGH_TIME_5_CYCLE);
+
+    norq_on_transfer_complete();
 }
 
 void HAL_QSPI_TxCpltCallback(QSPI_HandleTypeDef *hqspi)
 {
     (void)hqspi;
-    TxCplt = 1;
+    norq_on_transfer_complete();
 }
 
-void HAL_QSPI_ErrorCallback(QSPI_HandleTypeDef *hqspi)
+void HAL_QSPI_StatusMatchCallback(QSPI_HandleTypeDef *hqspi)
 {
     (void)hqspi;
-    ErrCblk = 1;
+    norq_on_status_match();
 }
 
-
+void HAL_QSPI_ErrorCallback(QSPI_HandleTypeDef *hqspi)
+{
+    (void)hqspi;
+    norq_on_error();
+}
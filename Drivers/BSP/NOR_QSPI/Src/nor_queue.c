@@ -0,0 +1,488 @@
+/*
+ * nor_queue.c
+ *
+ *  Created on: 17 окт. 2026 г.
+ *      Author: SimON
+ */
+#include "nor_queue.h"
+
+
+/**
+ * Hardware step the active request is waiting for
+ */
+typedef enum
+{
+    NORQ_PH_IDLE,       // Nothing in flight
+    NORQ_PH_DATA,       // Command + DMA running
+    NORQ_PH_BUSY,       // Program/erase running, waiting WIP == 0
+    NORQ_PH_DISPATCH,   // Completion callback is running
+    NORQ_PH_ABORT       // Step over its time limit is being aborted
+} norq_phase;
+
+
+// Порт аппаратной части
+static const norq_port *norq_hw = 0;
+
+// Очередь запросов (голова - активный запрос)
+static norq_request *norq_head = 0;
+static norq_request *norq_tail = 0;
+static ULONG         norq_depth = 0;
+
+// Состояние автомата
+static volatile norq_phase norq_phase_cur = NORQ_PH_IDLE;
+static ULONG               norq_chunk = 0;      // Size of the page segment in flight
+static ULONG               norq_first = 0;      // First segment of the request (up to the page boundary)
+static ULONG               norq_pages = 0;      // Segments left, including the one in flight
+
+// Отметки времени текущей фазы и запроса (такты порта)
+static ULONG               norq_t_phase = 0;
+static ULONG               norq_t_request = 0;
+
+// Начало аппаратного шага в полете (мс порта) для контроля таймаута
+static ULONG               norq_t_step = 0;
+
+// Статистика
+static norq_stats norq_stat;
+
+
+/* Queue auxiliary functions */
+static void norq_step(void);
+static UINT norq_expired(void);
+static UINT norq_program_page(norq_request *req);
+static void norq_complete(norq_status status);
+static ULONG norq_lap(void);
+
+
+/**
+ * @brief Attach hardware port and reset the queue
+ *
+ * @param port : Hardware port
+ */
+void norq_init(const norq_port *port)
+{
+    static const norq_stats zero_stats = {0};
+
+    norq_hw        = port;
+    norq_head      = 0;
+    norq_tail      = 0;
+    norq_depth     = 0;
+    norq_phase_cur = NORQ_PH_IDLE;
+    norq_chunk     = 0;
+    norq_first     = 0;
+    norq_pages     = 0;
+    norq_stat      = zero_stats;
+}
+
+
+/**
+ * @brief Queue request. Execution starts at once if the queue is idle.
+ *
+ * @param req : Request descriptor (owned by the queue until completion)
+ * @return status of operation
+ */
+UINT norq_submit(norq_request *req)
+{
+    // Is request valid ?
+    if (req == 0 || norq_hw == 0)
+    {
+        return LX_ERROR;
+    }
+
+    if (req->op != NORQ_OP_ERASE && (req->data == 0 || req->size == 0))
+    {
+        return LX_ERROR;
+    }
+
+    req->status = NORQ_STS_PENDING;
+    req->done   = 0;
+    req->next   = 0;
+
+    norq_hw->lock();
+
+    norq_stat.submitted++;
+    if (++norq_depth > norq_stat.max_depth)
+    {
+        norq_stat.max_depth = norq_depth;
+    }
+
+    // Ставим в хвост очереди
+    if (norq_tail != 0)
+    {
+        norq_tail->next = req;
+        norq_tail       = req;
+    }
+    else
+    {
+        norq_head = req;
+        norq_tail = req;
+
+        // Очередь простаивала - запускаем (из callback'а запуск выполнит norq_complete)
+        if (norq_phase_cur == NORQ_PH_IDLE)
+        {
+            norq_hw->busy();
+            norq_step();
+        }
+    }
+
+    norq_hw->unlock();
+
+    return LX_SUCCESS;
+}
+
+
+/**
+ * @brief Wait request completion
+ *
+ * The port wait function is called inside the critical section, so a
+ * completion interrupt can't be lost between the status check and sleep
+ * (WFI wakes up on pending interrupt even with PRIMASK set, SysTick
+ * included, so the time limit is checked at least every millisecond).
+ *
+ * A step in flight over the time limit of its request is aborted outside
+ * the critical section (the port abort may wait for the peripheral), the
+ * request completes with error and the next one is started.
+ *
+ * @param req : Request descriptor
+ * @return LX_SUCCESS if request completed without error
+ */
+UINT norq_wait(norq_request *req)
+{
+    for (;;)
+    {
+        norq_hw->lock();
+
+        if (req->status == NORQ_STS_DONE || req->status == NORQ_STS_ERROR)
+        {
+            norq_hw->unlock();
+            break;
+        }
+
+        // Шаг в полете не уложился в лимит - события от него больше не принимаем
+        if (norq_expired() != 0)
+        {
+            norq_phase_cur = NORQ_PH_ABORT;
+            norq_stat.timeouts++;
+            norq_hw->unlock();
+
+            norq_hw->abort();
+
+            norq_hw->lock();
+            norq_complete(NORQ_STS_ERROR);
+            norq_hw->unlock();
+            continue;
+        }
+
+        norq_stat.waits++;
+        norq_hw->wait();
+
+        norq_hw->unlock();
+    }
+
+    return (req->status == NORQ_STS_DONE) ? LX_SUCCESS : LX_ERROR;
+}
+
+
+/**
+ * @brief Check if any request is queued or in flight
+ *
+ * @return 0 - queue is idle
+ */
+UINT norq_busy(void)
+{
+    return (norq_head != 0 || norq_phase_cur != NORQ_PH_IDLE) ? 1 : 0;
+}
+
+
+/**
+ * @brief Get queue statistics
+ *
+ * @param stats : Destination
+ */
+void norq_stats_get(norq_stats *stats)
+{
+    norq_hw->lock();
+    *stats = norq_stat;
+    norq_hw->unlock();
+}
+
+
+/**
+ * @brief Clear queue statistics (queued requests are not affected)
+ */
+void norq_stats_reset(void)
+{
+    static const norq_stats zero_stats = {0};
+
+    norq_hw->lock();
+    norq_stat = zero_stats;
+    norq_hw->unlock();
+}
+
+
+/**
+ * @brief DMA transfer of the active step finished
+ */
+void norq_on_transfer_complete(void)
+{
+    norq_request *req = norq_head;
+
+    if (req == 0 || norq_phase_cur != NORQ_PH_DATA)
+    {
+        return;
+    }
+
+    if (req->op == NORQ_OP_READ)
+    {
+        // Чтение завершено целиком
+        norq_stat.read_ticks += norq_lap();
+        norq_stat.read_bytes += req->size;
+        req->done = req->size;
+        norq_complete(NORQ_STS_DONE);
+    }
+    else
+    {
+        // Страница передана - ждем окончания программирования
+        norq_stat.data_ticks += norq_lap();
+        req->done += norq_chunk;
+        norq_phase_cur = NORQ_PH_BUSY;
+        norq_t_step = norq_hw->ms();
+
+        norq_stat.steps++;
+        if (norq_hw->poll_ready() != LX_SUCCESS)
+        {
+            norq_complete(NORQ_STS_ERROR);
+        }
+    }
+}
+
+
+/**
+ * @brief Auto-polling matched (WEL set or WIP cleared)
+ */
+void norq_on_status_match(void)
+{
+    norq_request *req = norq_head;
+    UINT status = LX_SUCCESS;
+
+    if (req == 0)
+    {
+        return;
+    }
+
+    if (norq_phase_cur != NORQ_PH_BUSY)
+    {
+        return;
+    }
+
+    if (req->op == NORQ_OP_PROGRAM)
+    {
+        norq_stat.busy_ticks += norq_lap();
+        norq_stat.pages++;
+
+        if (--norq_pages != 0)
+        {
+            // Следующая страница запускается прямо из прерывания WIP
+            status = norq_program_page(req);
+        }
+        else
+        {
+            norq_complete(NORQ_STS_DONE);
+        }
+    }
+    else
+    {
+        norq_stat.erase_ticks += norq_lap();
+        norq_stat.erases++;
+        req->done = req->size;
+        norq_complete(NORQ_STS_DONE);
+    }
+
+    if (status != LX_SUCCESS)
+    {
+        norq_complete(NORQ_STS_ERROR);
+    }
+}
+
+
+/**
+ * @brief Error reported by the port (DMA, timeout, transfer error)
+ */
+void norq_on_error(void)
+{
+    if (norq_head != 0 && (norq_phase_cur == NORQ_PH_DATA || norq_phase_cur == NORQ_PH_BUSY))
+    {
+        norq_complete(NORQ_STS_ERROR);
+    }
+}
+
+
+/** AUXILLARY FUNCTIONS FOR QUEUE **/
+
+/**
+ * @brief Start the first hardware step of the head request
+ */
+static void norq_step(void)
+{
+    norq_request *req = norq_head;
+    UINT status;
+
+    req->status    = NORQ_STS_ACTIVE;
+    norq_t_request = norq_hw->ticks();
+    norq_t_phase   = norq_t_request;
+    norq_t_step    = norq_hw->ms();
+
+    if (req->op == NORQ_OP_READ)
+    {
+        norq_stat.steps++;
+        norq_phase_cur = NORQ_PH_DATA;
+        status = norq_hw->read(req->address, req->data, req->size);
+    }
+    else if (req->op == NORQ_OP_PROGRAM)
+    {
+        // Разбиение запроса на сегменты по границам страниц
+        norq_first = NORQ_PAGE_SIZE - (req->address % NORQ_PAGE_SIZE);
+        if (norq_first > req->size)
+        {
+            norq_first = req->size;
+        }
+        norq_pages = 1 + (req->size - norq_first + NORQ_PAGE_SIZE - 1) / NORQ_PAGE_SIZE;
+
+        status = norq_program_page(req);
+    }
+    else
+    {
+        norq_stat.steps++;
+        norq_phase_cur = NORQ_PH_BUSY;
+        status = norq_hw->write_enable();
+        if (status == LX_SUCCESS)
+        {
+            status = norq_hw->erase(req->address, req->size);
+        }
+    }
+
+    if (status != LX_SUCCESS)
+    {
+        norq_complete(NORQ_STS_ERROR);
+    }
+}
+
+
+/**
+ * @brief Start the next page segment of the program request: WREN, page
+ *        program command and data transfer are issued back to back
+ *
+ * @param req : Active program request
+ * @return status of operation
+ */
+static UINT norq_program_page(norq_request *req)
+{
+    UINT status;
+
+    norq_chunk = (req->done == 0) ? norq_first : (req->size - req->done);
+    if (norq_chunk > NORQ_PAGE_SIZE)
+    {
+        norq_chunk = NORQ_PAGE_SIZE;
+    }
+
+    norq_phase_cur = NORQ_PH_DATA;
+    norq_t_step    = norq_hw->ms();
+    norq_stat.steps++;
+    norq_stat.program_bytes += norq_chunk;
+
+    // WEL устанавливается по окончании команды WREN, отдельное ожидание не нужно
+    status = norq_hw->write_enable();
+    if (status == LX_SUCCESS)
+    {
+        // Порт может выполнить короткую передачу синхронно и вызвать norq_on_transfer_complete сам
+        status = norq_hw->program(req->address + req->done, req->data + req->done, norq_chunk);
+    }
+
+    return status;
+}
+
+
+/**
+ * @brief Check the step in flight against the time limit of its request
+ *        (called inside the critical section)
+ *
+ * @return 1 - the step must be aborted
+ */
+static UINT norq_expired(void)
+{
+    norq_request *req = norq_head;
+
+    if (req == 0 || req->timeout == 0)
+    {
+        return 0;
+    }
+
+    if (norq_phase_cur != NORQ_PH_DATA && norq_phase_cur != NORQ_PH_BUSY)
+    {
+        return 0;
+    }
+
+    return ((norq_hw->ms() - norq_t_step) > req->timeout) ? 1 : 0;
+}
+
+
+/**
+ * @brief Duration of the finished phase, starts the next one
+ *
+ * @return elapsed port ticks
+ */
+static ULONG norq_lap(void)
+{
+    ULONG now = norq_hw->ticks();
+    ULONG elapsed = now - norq_t_phase;
+
+    norq_t_phase = now;
+    return elapsed;
+}
+
+
+/**
+ * @brief Retire the head request, call its callback and start the next one
+ *
+ * @param status : Final request status
+ */
+static void norq_complete(norq_status status)
+{
+    norq_request *req = norq_head;
+
+    // Извлекаем запрос из очереди
+    norq_head = req->next;
+    if (norq_head == 0)
+    {
+        norq_tail = 0;
+    }
+    norq_depth--;
+
+    norq_stat.request_ticks += norq_hw->ticks() - norq_t_request;
+
+    if (status == NORQ_STS_DONE)
+    {
+        norq_stat.completed++;
+    }
+    else
+    {
+        norq_stat.failed++;
+    }
+
+    // Callback может поставить в очередь новый запрос, запуск выполним ниже
+    norq_phase_cur = NORQ_PH_DISPATCH;
+    req->status = status;
+    if (req->callback != 0)
+    {
+        req->callback(req);
+    }
+
+    norq_phase_cur = NORQ_PH_IDLE;
+    if (norq_head != 0)
+    {
+        norq_step();
+    }
+    else
+    {
+        norq_hw->idle();
+    }
+}
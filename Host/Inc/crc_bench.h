@@ -0,0 +1,44 @@
+/**
+ ********************************************************************************
+ * @file    crc_bench.h
+ * @author  SimON
+ * @date    17 окт. 2026 г.
+ * @brief   Reliance Edge CRC-32 backends: software table vs. CRC instructions
+ ********************************************************************************
+ */
+
+#ifndef HOST_CRC_BENCH_H_
+#define HOST_CRC_BENCH_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include <stdint.h>
+
+/************************************
+ * MACROS AND DEFINES
+ ************************************/
+
+/************************************
+ * TYPEDEFS
+ ************************************/
+
+/************************************
+ * EXPORTED VARIABLES
+ ************************************/
+
+/************************************
+ * GLOBAL FUNCTION PROTOTYPES
+ ************************************/
+int32_t CRCBENCH_Run(void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
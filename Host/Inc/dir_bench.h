@@ -0,0 +1,44 @@
+/**
+ ********************************************************************************
+ * @file    dir_bench.h
+ * @author  SimON
+ * @date    17 окт. 2026 г.
+ * @brief   Reliance Edge name lookup and create cost in a large directory
+ ********************************************************************************
+ */
+
+#ifndef HOST_DIR_BENCH_H_
+#define HOST_DIR_BENCH_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include <stdint.h>
+
+/************************************
+ * MACROS AND DEFINES
+ ************************************/
+
+/************************************
+ * TYPEDEFS
+ ************************************/
+
+/************************************
+ * EXPORTED VARIABLES
+ ************************************/
+
+/************************************
+ * GLOBAL FUNCTION PROTOTYPES
+ ************************************/
+int32_t DIRBENCH_Run(void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
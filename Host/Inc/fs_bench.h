@@ -0,0 +1,69 @@
+/**
+ ********************************************************************************
+ * @file    fs_bench.h
+ * @author  SimON
+ * @date    17 окт. 2026 г.
+ * @brief   Reliance Edge + LevelX benchmark suite over the simulated NOR volume
+ ********************************************************************************
+ */
+
+#ifndef HOST_FS_BENCH_H_
+#define HOST_FS_BENCH_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include <stdint.h>
+#include "lx_api.h"
+#include "lx_nor_flash_simulator.h"
+
+/************************************
+ * MACROS AND DEFINES
+ ************************************/
+#define FSBENCH_VOLUME              "SPIF:"
+
+/************************************
+ * TYPEDEFS
+ ************************************/
+
+/* Output format of the results */
+typedef enum
+{
+    FSBENCH_FMT_TEXT,
+    FSBENCH_FMT_JSON
+} fsbench_format;
+
+/* Result of one workload */
+typedef struct
+{
+    const char                     *pszName;
+    uint64_t                        ullOps;         /* File system calls issued */
+    uint64_t                        ullBytes;       /* User payload moved */
+    uint64_t                        ullBytesWritten;/* User payload written (write amplification base) */
+    uint64_t                        ullHostNs;      /* Host CPU time spent in the stack */
+    uint64_t                        ullBufLookups;  /* Reliance Edge buffer lookups (RedBufferGet) */
+    uint64_t                        ullBufHits;     /* Lookups which found the block buffered */
+    uint64_t                        ullDcLookups;   /* Reliance Edge name lookups (RedCoreLookup) */
+    uint64_t                        ullDcHits;      /* Name lookups answered by the lookup cache */
+    LX_NOR_FLASH_SIMULATOR_STATS    flash;          /* Flash counters, busy_ns is the device time */
+} fsbench_result;
+
+/************************************
+ * EXPORTED VARIABLES
+ ************************************/
+
+/************************************
+ * GLOBAL FUNCTION PROTOTYPES
+ ************************************/
+int32_t FSBENCH_Run(const char *pszFilter, fsbench_format format);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,44 @@
+/**
+ ********************************************************************************
+ * @file    gc_bench.h
+ * @author  SimON
+ * @date    17 окт. 2026 г.
+ * @brief   LevelX write latency: inline reclaim vs. background reclaim at idle
+ ********************************************************************************
+ */
+
+#ifndef HOST_GC_BENCH_H_
+#define HOST_GC_BENCH_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include <stdint.h>
+
+/************************************
+ * MACROS AND DEFINES
+ ************************************/
+
+/************************************
+ * TYPEDEFS
+ ************************************/
+
+/************************************
+ * EXPORTED VARIABLES
+ ************************************/
+
+/************************************
+ * GLOBAL FUNCTION PROTOTYPES
+ ************************************/
+int32_t GCBENCH_Run(void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
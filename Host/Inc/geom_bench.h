@@ -0,0 +1,44 @@
+/**
+ ********************************************************************************
+ * @file    geom_bench.h
+ * @author  SimON
+ * @date    17 окт. 2026 г.
+ * @brief   LevelX block geometry comparison: 64 KB sectors vs. 4 KB subsectors
+ ********************************************************************************
+ */
+
+#ifndef HOST_GEOM_BENCH_H_
+#define HOST_GEOM_BENCH_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include <stdint.h>
+
+/************************************
+ * MACROS AND DEFINES
+ ************************************/
+
+/************************************
+ * TYPEDEFS
+ ************************************/
+
+/************************************
+ * EXPORTED VARIABLES
+ ************************************/
+
+/************************************
+ * GLOBAL FUNCTION PROTOTYPES
+ ************************************/
+int32_t GEOMBENCH_Run(void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
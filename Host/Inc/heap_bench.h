@@ -0,0 +1,44 @@
+/**
+ ********************************************************************************
+ * @file    heap_bench.h
+ * @author  SimON
+ * @date    17 окт. 2026 г.
+ * @brief   Reliance Edge heap: TLSF allocator vs. linear best fit on random traces
+ ********************************************************************************
+ */
+
+#ifndef HOST_HEAP_BENCH_H_
+#define HOST_HEAP_BENCH_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include <stdint.h>
+
+/************************************
+ * MACROS AND DEFINES
+ ************************************/
+
+/************************************
+ * TYPEDEFS
+ ************************************/
+
+/************************************
+ * EXPORTED VARIABLES
+ ************************************/
+
+/************************************
+ * GLOBAL FUNCTION PROTOTYPES
+ ************************************/
+int32_t HEAPBENCH_Run(void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
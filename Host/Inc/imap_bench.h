@@ -0,0 +1,44 @@
+/**
+ ********************************************************************************
+ * @file    imap_bench.h
+ * @author  SimON
+ * @date    17 окт. 2026 г.
+ * @brief   Reliance Edge imap free block/inode search: bit-at-a-time vs. word scan
+ ********************************************************************************
+ */
+
+#ifndef HOST_IMAP_BENCH_H_
+#define HOST_IMAP_BENCH_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include <stdint.h>
+
+/************************************
+ * MACROS AND DEFINES
+ ************************************/
+
+/************************************
+ * TYPEDEFS
+ ************************************/
+
+/************************************
+ * EXPORTED VARIABLES
+ ************************************/
+
+/************************************
+ * GLOBAL FUNCTION PROTOTYPES
+ ************************************/
+int32_t IMAPBENCH_Run(void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,44 @@
+/**
+ ********************************************************************************
+ * @file    mount_bench.h
+ * @author  SimON
+ * @date    17 окт. 2026 г.
+ * @brief   LevelX cold mount time: full scan vs. fast-mount checkpoint
+ ********************************************************************************
+ */
+
+#ifndef HOST_MOUNT_BENCH_H_
+#define HOST_MOUNT_BENCH_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include <stdint.h>
+
+/************************************
+ * MACROS AND DEFINES
+ ************************************/
+
+/************************************
+ * TYPEDEFS
+ ************************************/
+
+/************************************
+ * EXPORTED VARIABLES
+ ************************************/
+
+/************************************
+ * GLOBAL FUNCTION PROTOTYPES
+ ************************************/
+int32_t MOUNTBENCH_Run(void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
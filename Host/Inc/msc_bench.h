@@ -0,0 +1,44 @@
+/**
+ ********************************************************************************
+ * @file    msc_bench.h
+ * @author  SimON
+ * @date    17 окт. 2026 г.
+ * @brief   USB MSC LUN on LevelX: SCSI command streams replayed through the class driver
+ ********************************************************************************
+ */
+
+#ifndef HOST_MSC_BENCH_H_
+#define HOST_MSC_BENCH_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include <stdint.h>
+
+/************************************
+ * MACROS AND DEFINES
+ ************************************/
+
+/************************************
+ * TYPEDEFS
+ ************************************/
+
+/************************************
+ * EXPORTED VARIABLES
+ ************************************/
+
+/************************************
+ * GLOBAL FUNCTION PROTOTYPES
+ ************************************/
+int32_t MSCBENCH_Run(const char *pszTrace);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
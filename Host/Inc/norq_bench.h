@@ -0,0 +1,44 @@
+/**
+ ********************************************************************************
+ * @file    norq_bench.h
+ * @author  SimON
+ * @date    17 окт. 2026 г.
+ * @brief   Synchronous vs. queued QSPI flash access over the simulated part
+ ********************************************************************************
+ */
+
+#ifndef HOST_NORQ_BENCH_H_
+#define HOST_NORQ_BENCH_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include <stdint.h>
+
+/************************************
+ * MACROS AND DEFINES
+ ************************************/
+
+/************************************
+ * TYPEDEFS
+ ************************************/
+
+/************************************
+ * EXPORTED VARIABLES
+ ************************************/
+
+/************************************
+ * GLOBAL FUNCTION PROTOTYPES
+ ************************************/
+int32_t NORQBENCH_Run(void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,47 @@
+/**
+ ********************************************************************************
+ * @file    norq_sim_port.h
+ * @author  SimON
+ * @date    17 окт. 2026 г.
+ * @brief   nor_queue.h hardware port backed by the LevelX NOR flash simulator
+ ********************************************************************************
+ */
+
+#ifndef HOST_NORQ_SIM_PORT_H_
+#define HOST_NORQ_SIM_PORT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include "lx_api.h"
+#include "nor_queue.h"
+
+/************************************
+ * MACROS AND DEFINES
+ ************************************/
+
+/************************************
+ * TYPEDEFS
+ ************************************/
+
+/************************************
+ * EXPORTED VARIABLES
+ ************************************/
+
+/************************************
+ * GLOBAL FUNCTION PROTOTYPES
+ ************************************/
+void    NORQSIM_Init(void);
+ULONG64 NORQSIM_TimeGet(void);
+void    NORQSIM_Run(ULONG64 ullNs);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
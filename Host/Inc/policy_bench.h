@@ -0,0 +1,44 @@
+/**
+ ********************************************************************************
+ * @file    policy_bench.h
+ * @author  SimON
+ * @date    17 окт. 2026 г.
+ * @brief   LevelX reclaim policies: write amplification and wear under skew
+ ********************************************************************************
+ */
+
+#ifndef HOST_POLICY_BENCH_H_
+#define HOST_POLICY_BENCH_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include <stdint.h>
+
+/************************************
+ * MACROS AND DEFINES
+ ************************************/
+
+/************************************
+ * TYPEDEFS
+ ************************************/
+
+/************************************
+ * EXPORTED VARIABLES
+ ************************************/
+
+/************************************
+ * GLOBAL FUNCTION PROTOTYPES
+ ************************************/
+int32_t POLICYBENCH_Run(void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,82 @@
+/**
+ ********************************************************************************
+ * @file    usbd_conf.h
+ * @author  SimON
+ * @date    17 окт. 2026 г.
+ * @brief   USB device library configuration for host builds
+ *
+ *          Replaces Middlewares/USBFS/usb_device_app/Target/usbd_conf.h (keep
+ *          Target off the include path) so that the ST core and MSC class
+ *          compile without the HAL. Values match the target configuration,
+ *          MSC_MEDIA_PACKET can be overridden from the command line.
+ ********************************************************************************
+ */
+
+#ifndef __USBD_CONF__H__
+#define __USBD_CONF__H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/************************************
+ * MACROS AND DEFINES
+ ************************************/
+#define USBD_MAX_NUM_INTERFACES         1U
+#define USBD_MAX_NUM_CONFIGURATION      1U
+#define USBD_MAX_STR_DESC_SIZ           512U
+#define USBD_DEBUG_LEVEL                0U
+#define USBD_LPM_ENABLED                1U
+#define USBD_SELF_POWERED               1U
+
+#ifndef MSC_MEDIA_PACKET
+#define MSC_MEDIA_PACKET                4096U
+#endif
+
+#define DEVICE_FS                       0
+#define DEVICE_HS                       1
+
+#define USBD_malloc                     (void *)USBD_static_malloc
+#define USBD_free                       USBD_static_free
+#define USBD_memset                     memset
+#define USBD_memcpy                     memcpy
+#define USBD_Delay(ms)                  ((void)(ms))
+
+#define USBD_UsrLog(...)
+#define USBD_ErrLog(...)
+#define USBD_DbgLog(...)
+
+/* CMSIS compiler macros used by usbd_def.h */
+#ifndef UNUSED
+#define UNUSED(X)                       (void)(X)
+#endif
+#ifndef __IO
+#define __IO                            volatile
+#endif
+#ifndef __PACKED
+#define __PACKED                        __attribute__((packed))
+#endif
+#ifndef __STATIC_INLINE
+#define __STATIC_INLINE                 static inline
+#endif
+
+/************************************
+ * GLOBAL FUNCTION PROTOTYPES
+ ************************************/
+void *USBD_static_malloc(uint32_t size);
+void USBD_static_free(void *p);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,56 @@
+/**
+ ********************************************************************************
+ * @file    usbd_host_port.h
+ * @author  SimON
+ * @date    17 окт. 2026 г.
+ * @brief   USB device low level driver (usbd_core.h USBD_LL_*) for host builds
+ ********************************************************************************
+ */
+
+#ifndef HOST_USBD_HOST_PORT_H_
+#define HOST_USBD_HOST_PORT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include <stdint.h>
+
+#include "usbd_def.h"
+
+/************************************
+ * MACROS AND DEFINES
+ ************************************/
+#define USBDHOST_FS_PACKET_SIZE     64U
+
+/************************************
+ * TYPEDEFS
+ ************************************/
+typedef uint64_t (*usbdhost_clock)(void);   /* Simulated time in ns */
+
+/************************************
+ * EXPORTED VARIABLES
+ ************************************/
+
+/************************************
+ * GLOBAL FUNCTION PROTOTYPES
+ ************************************/
+int32_t  USBDHOST_Out(USBD_HandleTypeDef *pdev, uint8_t bEpAddr, const uint8_t *pbData, uint32_t ulLen);
+int32_t  USBDHOST_In(USBD_HandleTypeDef *pdev, uint8_t bEpAddr, uint8_t *pbData, uint32_t ulMax, uint32_t *pulLen);
+uint8_t  USBDHOST_IsStalled(uint8_t bEpAddr);
+uint8_t  USBDHOST_IsArmed(uint8_t bEpAddr, uint32_t *pulLen, uint64_t *pullArmNs);
+void     USBDHOST_Setup(USBD_HandleTypeDef *pdev, const uint8_t *pbSetup);
+void     USBDHOST_ClearStall(USBD_HandleTypeDef *pdev, uint8_t bEpAddr);
+uint64_t USBDHOST_PacketsGet(void);
+uint32_t USBDHOST_PacketsOf(uint32_t ulLen);
+void     USBDHOST_ClockSet(usbdhost_clock pfnClock);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
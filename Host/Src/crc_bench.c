@@ -0,0 +1,274 @@
+/**
+ ********************************************************************************
+ * @file    crc_bench.c
+ * @author  SimON
+ * @date    17 окт. 2026 г.
+ * @brief   Reliance Edge CRC-32 backends: software table vs. CRC instructions
+ *
+ *          Times, per buffer size, the three ways a metadata CRC can be
+ *          computed in a host build:
+ *          - sw      : RedCrc32UpdateSw, the REDCONF_CRC_ALGORITHM table path;
+ *          - port    : crc_driver_update, the host CRC kernel (PCLMUL/ARMv8);
+ *          - dispatch: RedCrc32Update, unaligned ends in software, the rest
+ *                      through RedOsCrc32Update when REDOSCONF_CRC_OVERRIDE.
+ *
+ *          Cycles are TSC ticks on x86-64 (reference clock, not core cycles
+ *          under turbo), other hosts report ns/byte only. The STM32 CRC unit
+ *          itself can only be measured on target (about 1 cycle/byte: RBIT and
+ *          a store per word, the unit needs 4 AHB cycles per word).
+ *
+ *          Before timing, every backend is checked against a bitwise reference
+ *          on random buffers with all start alignments, lengths and chaining.
+ ********************************************************************************
+ */
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <redfs.h>
+#include <redutils.h>
+
+#include "crc_driver.h"
+#include "crc_bench.h"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <x86intrin.h>
+#define CRCBENCH_TSC    1
+#endif
+
+/************************************
+ * PRIVATE MACROS AND DEFINES
+ ************************************/
+#define CRCBENCH_MAX_SIZE           65536U
+#define CRCBENCH_BYTES_PER_SIZE     (64U * 1024U * 1024U)
+#define CRCBENCH_CHECKS             20000U
+
+/************************************
+ * PRIVATE TYPEDEFS
+ ************************************/
+typedef uint32_t (*crcbench_fn)(uint32_t ulCrc, const uint8_t *pbData, uint32_t ulSize);
+
+/************************************
+ * STATIC FUNCTION PROTOTYPES
+ ************************************/
+static uint32_t CRCBENCH_Reference(uint32_t ulCrc, const uint8_t *pbData, uint32_t ulSize);
+static uint32_t CRCBENCH_Sw(uint32_t ulCrc, const uint8_t *pbData, uint32_t ulSize);
+static uint32_t CRCBENCH_Port(uint32_t ulCrc, const uint8_t *pbData, uint32_t ulSize);
+static uint32_t CRCBENCH_Dispatch(uint32_t ulCrc, const uint8_t *pbData, uint32_t ulSize);
+static int32_t CRCBENCH_Check(void);
+static void CRCBENCH_Time(crcbench_fn fn, uint32_t ulSize, double *pdNsPerByte, double *pdCycPerByte);
+static uint64_t CRCBENCH_HostNs(void);
+static uint64_t CRCBENCH_Cycles(void);
+static uint32_t CRCBENCH_Rand(void);
+
+/************************************
+ * STATIC VARIABLES
+ ************************************/
+static const uint32_t gaulSizes[] = { 64U, 512U, 4096U, 65536U };
+
+static uint32_t aulData[(CRCBENCH_MAX_SIZE + 64U) / sizeof(uint32_t)];
+static uint32_t ulRandState = 1U;
+static volatile uint32_t ulSink;
+
+/************************************
+ * STATIC FUNCTIONS
+ ************************************/
+
+/**
+ * @brief Bit-at-a-time CRC-32, the reference every backend must match
+ */
+static uint32_t CRCBENCH_Reference(uint32_t ulCrc, const uint8_t *pbData, uint32_t ulSize)
+{
+    ulCrc = ~ulCrc;
+    for (uint32_t i = 0; i < ulSize; i++)
+    {
+        ulCrc ^= pbData[i];
+        for (uint32_t bit = 0; bit < 8U; bit++)
+        {
+            ulCrc = (ulCrc >> 1) ^ (0xEDB88320U & (0U - (ulCrc & 1U)));
+        }
+    }
+
+    return ~ulCrc;
+}
+
+/**
+ * @brief Software table path
+ */
+static uint32_t CRCBENCH_Sw(uint32_t ulCrc, const uint8_t *pbData, uint32_t ulSize)
+{
+    return RedCrc32UpdateSw(ulCrc, pbData, ulSize);
+}
+
+/**
+ * @brief Host CRC kernel, whole words only (callers pass aligned multiples of 4)
+ */
+static uint32_t CRCBENCH_Port(uint32_t ulCrc, const uint8_t *pbData, uint32_t ulSize)
+{
+    return crc_driver_update(ulCrc, (const uint32_t *)(const void *)pbData, ulSize / 4U);
+}
+
+/**
+ * @brief What Reliance Edge calls
+ */
+static uint32_t CRCBENCH_Dispatch(uint32_t ulCrc, const uint8_t *pbData, uint32_t ulSize)
+{
+    return RedCrc32Update(ulCrc, pbData, ulSize);
+}
+
+/**
+ * @brief Compare all backends with the reference
+ *
+ * @return 0 on success, -1 on mismatch
+ */
+static int32_t CRCBENCH_Check(void)
+{
+    const uint8_t *pbData = (const uint8_t *)aulData;
+
+    for (uint32_t i = 0; i < CRCBENCH_CHECKS; i++)
+    {
+        uint32_t ulOffset = CRCBENCH_Rand() % 64U;
+        uint32_t ulSize = ((i % 16U) == 0U) ? (CRCBENCH_Rand() % 8192U) : (CRCBENCH_Rand() % 300U);
+        uint32_t ulSplit = (ulSize != 0U) ? (CRCBENCH_Rand() % ulSize) : 0U;
+        uint32_t ulInit = ((i & 1U) != 0U) ? CRCBENCH_Rand() : 0U;
+        uint32_t ulWordBytes = (ulSize / 4U) * 4U;
+        uint32_t ulRef = CRCBENCH_Reference(ulInit, &pbData[ulOffset], ulSize);
+        uint32_t ulSw = RedCrc32UpdateSw(RedCrc32UpdateSw(ulInit, &pbData[ulOffset], ulSplit), &pbData[ulOffset + ulSplit], ulSize - ulSplit);
+        uint32_t ulDisp = RedCrc32Update(RedCrc32Update(ulInit, &pbData[ulOffset], ulSplit), &pbData[ulOffset + ulSplit], ulSize - ulSplit);
+        uint32_t ulPort = CRCBENCH_Port(ulInit, pbData, ulWordBytes);
+
+        if ((ulSw != ulRef) || (ulDisp != ulRef) || (ulPort != CRCBENCH_Reference(ulInit, pbData, ulWordBytes)))
+        {
+            fprintf(stderr, "crc_bench: offset %lu size %lu split %lu: ref %08lx sw %08lx dispatch %08lx port %08lx\n",
+                    (unsigned long)ulOffset, (unsigned long)ulSize, (unsigned long)ulSplit, (unsigned long)ulRef,
+                    (unsigned long)ulSw, (unsigned long)ulDisp, (unsigned long)ulPort);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Time one backend on CRCBENCH_BYTES_PER_SIZE bytes in ulSize pieces
+ */
+static void CRCBENCH_Time(crcbench_fn fn, uint32_t ulSize, double *pdNsPerByte, double *pdCycPerByte)
+{
+    const uint8_t *pbData = (const uint8_t *)aulData;
+    uint32_t ulRounds = CRCBENCH_BYTES_PER_SIZE / ulSize;
+    uint32_t ulCrc = 0U;
+    uint64_t ullNs;
+    uint64_t ullCycles;
+
+    ullNs = CRCBENCH_HostNs();
+    ullCycles = CRCBENCH_Cycles();
+    for (uint32_t i = 0; i < ulRounds; i++)
+    {
+        ulCrc = fn(ulCrc, pbData, ulSize);
+    }
+    ullCycles = CRCBENCH_Cycles() - ullCycles;
+    ullNs = CRCBENCH_HostNs() - ullNs;
+
+    ulSink = ulCrc;
+
+    *pdNsPerByte = (double)ullNs / (double)CRCBENCH_BYTES_PER_SIZE;
+    *pdCycPerByte = (double)ullCycles / (double)CRCBENCH_BYTES_PER_SIZE;
+}
+
+/**
+ * @brief Monotonic host time in nanoseconds
+ */
+static uint64_t CRCBENCH_HostNs(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Cycle counter (TSC on x86-64, 0 elsewhere)
+ */
+static uint64_t CRCBENCH_Cycles(void)
+{
+#ifdef CRCBENCH_TSC
+    return __rdtsc();
+#else
+    return 0U;
+#endif
+}
+
+/**
+ * @brief Deterministic pseudo random generator (xorshift32), same sequence on every run
+ */
+static uint32_t CRCBENCH_Rand(void)
+{
+    ulRandState ^= ulRandState << 13;
+    ulRandState ^= ulRandState >> 17;
+    ulRandState ^= ulRandState << 5;
+
+    return ulRandState;
+}
+
+/************************************
+ * GLOBAL FUNCTIONS
+ ************************************/
+
+/**
+ * @brief Check, then time every backend on every buffer size
+ *
+ * @return 0 on success, -1 if a backend disagrees with the reference
+ */
+int32_t CRCBENCH_Run(void)
+{
+    static const struct
+    {
+        const char *pszName;
+        crcbench_fn fn;
+    } aBackend[] =
+    {
+        { "sw",       CRCBENCH_Sw },
+        { "port",     CRCBENCH_Port },
+        { "dispatch", CRCBENCH_Dispatch },
+    };
+
+    ulRandState = 1U;
+    for (uint32_t i = 0; i < (sizeof(aulData) / sizeof(aulData[0])); i++)
+    {
+        aulData[i] = CRCBENCH_Rand();
+    }
+
+    if (CRCBENCH_Check() != 0)
+    {
+        return -1;
+    }
+
+    printf("# port backend %s, %u MB per size, cycles are %s\n", crc_driver_backend(),
+           (unsigned)(CRCBENCH_BYTES_PER_SIZE >> 20),
+#ifdef CRCBENCH_TSC
+           "TSC ticks"
+#else
+           "not available"
+#endif
+           );
+    printf("%-10s %8s %10s %10s\n", "backend", "size", "ns/byte", "cyc/byte");
+
+    for (uint32_t b = 0; b < (sizeof(aBackend) / sizeof(aBackend[0])); b++)
+    {
+        for (uint32_t s = 0; s < (sizeof(gaulSizes) / sizeof(gaulSizes[0])); s++)
+        {
+            double dNs;
+            double dCyc;
+
+            CRCBENCH_Time(aBackend[b].fn, gaulSizes[s], &dNs, &dCyc);
+            printf("%-10s %8lu %10.3f %10.3f\n", aBackend[b].pszName, (unsigned long)gaulSizes[s], dNs, dCyc);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,297 @@
+/**
+ ********************************************************************************
+ * @file    crc_host_port.c
+ * @author  SimON
+ * @date    17 окт. 2026 г.
+ * @brief   crc_driver.h entry points backed by host CPU CRC instructions
+ *
+ *          Replaces Drivers/BSP/CRC/Src/crc_driver.c in host builds, so that
+ *          Reliance Edge (and host tools linked with it) CRC metadata with the
+ *          fastest kernel the build machine offers:
+ *
+ *          - x86-64 : PCLMULQDQ folding (4 x 128 bits per 64 byte step, then
+ *                     Barrett reduction), chosen at run time from CPUID;
+ *          - AArch64: CRC32X/CRC32W instructions, chosen at compile time when
+ *                     built with -march=armv8-a+crc (or any CPU with +crc);
+ *          - others : bit-at-a-time reference.
+ *
+ *          The x86 SSE4.2 CRC32 instruction is not used: it computes CRC-32C
+ *          (Castagnoli), not the CRC-32 stored by Reliance Edge.
+ ********************************************************************************
+ */
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include <stddef.h>
+
+#include "crc_driver.h"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define CRCHOST_PCLMUL  1
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define CRCHOST_ARMV8   1
+#endif
+
+/************************************
+ * PRIVATE MACROS AND DEFINES
+ ************************************/
+#define CRCHOST_POLY_REFLECTED      0xEDB88320U
+
+/* PCLMUL folding needs at least four 128 bit lanes */
+#define CRCHOST_PCLMUL_MIN_WORDS    16U
+
+/************************************
+ * STATIC FUNCTION PROTOTYPES
+ ************************************/
+static uint32_t CRCHOST_Bitwise(uint32_t state, const uint32_t *words, uint32_t count);
+#ifdef CRCHOST_PCLMUL
+static uint32_t CRCHOST_Pclmul(uint32_t state, const uint32_t *words, uint32_t count);
+static int CRCHOST_PclmulSupported(void);
+#endif
+#ifdef CRCHOST_ARMV8
+static uint32_t CRCHOST_Armv8(uint32_t state, const uint32_t *words, uint32_t count);
+#endif
+
+/************************************
+ * STATIC FUNCTIONS
+ ************************************/
+
+/**
+ * @brief Reference kernel, one bit at a time
+ *
+ * @param state Inverted CRC (internal state)
+ * @param words Data
+ * @param count Number of words
+ * @return updated state
+ */
+static uint32_t CRCHOST_Bitwise(uint32_t state, const uint32_t *words, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        state ^= words[i];
+        for (uint32_t bit = 0; bit < 32U; bit++)
+        {
+            state = (state >> 1) ^ (CRCHOST_POLY_REFLECTED & (0U - (state & 1U)));
+        }
+    }
+
+    return state;
+}
+
+#ifdef CRCHOST_PCLMUL
+/**
+ * @brief PCLMULQDQ kernel (Intel, "Fast CRC Computation for Generic
+ *        Polynomials Using PCLMULQDQ Instruction", bit-reflected constants)
+ *
+ * @param state Inverted CRC (internal state)
+ * @param words Data, count >= CRCHOST_PCLMUL_MIN_WORDS
+ * @param count Number of words
+ * @return updated state
+ */
+__attribute__((target("pclmul,sse4.1")))
+static uint32_t CRCHOST_Pclmul(uint32_t state, const uint32_t *words, uint32_t count)
+{
+    static const uint64_t k1k2[2] __attribute__((aligned(16))) = { 0x0154442BD4ULL, 0x01C6E41596ULL };
+    static const uint64_t k3k4[2] __attribute__((aligned(16))) = { 0x01751997D0ULL, 0x00CCAA009EULL };
+    static const uint64_t k5k0[2] __attribute__((aligned(16))) = { 0x0163CD6124ULL, 0x0000000000ULL };
+    static const uint64_t poly[2] __attribute__((aligned(16))) = { 0x01DB710641ULL, 0x01F7011641ULL };
+
+    const uint8_t *buf = (const uint8_t *)words;
+    size_t len = ((size_t)count * 4U) & ~(size_t)15U;
+    uint32_t tail = count - (uint32_t)(len / 4U);
+    __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, y5, y6, y7, y8;
+
+    x1 = _mm_loadu_si128((const __m128i *)(buf + 0x00));
+    x2 = _mm_loadu_si128((const __m128i *)(buf + 0x10));
+    x3 = _mm_loadu_si128((const __m128i *)(buf + 0x20));
+    x4 = _mm_loadu_si128((const __m128i *)(buf + 0x30));
+
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int)state));
+    x0 = _mm_load_si128((const __m128i *)k1k2);
+
+    buf += 64;
+    len -= 64;
+
+    /* Fold four lanes in parallel */
+    while (len >= 64)
+    {
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+        x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+        x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+
+        y5 = _mm_loadu_si128((const __m128i *)(buf + 0x00));
+        y6 = _mm_loadu_si128((const __m128i *)(buf + 0x10));
+        y7 = _mm_loadu_si128((const __m128i *)(buf + 0x20));
+        y8 = _mm_loadu_si128((const __m128i *)(buf + 0x30));
+
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), y5);
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), y6);
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), y7);
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), y8);
+
+        buf += 64;
+        len -= 64;
+    }
+
+    /* Fold the four lanes into one */
+    x0 = _mm_load_si128((const __m128i *)k3k4);
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+    /* Remaining 16 byte blocks */
+    while (len >= 16)
+    {
+        x2 = _mm_loadu_si128((const __m128i *)buf);
+
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+        buf += 16;
+        len -= 16;
+    }
+
+    /* 128 -> 64 bits */
+    x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+    x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+    x1 = _mm_srli_si128(x1, 8);
+    x1 = _mm_xor_si128(x1, x2);
+
+    x0 = _mm_loadl_epi64((const __m128i *)k5k0);
+
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, x3);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    /* Barrett reduction to 32 bits */
+    x0 = _mm_load_si128((const __m128i *)poly);
+
+    x2 = _mm_and_si128(x1, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+    x2 = _mm_and_si128(x2, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    state = (uint32_t)_mm_extract_epi32(x1, 1);
+
+    /* Up to three words left over */
+    return CRCHOST_Bitwise(state, (const uint32_t *)buf, tail);
+}
+
+/**
+ * @brief Whether the CPU has PCLMULQDQ and SSE4.1 (checked once)
+ *
+ * @return nonzero if supported
+ */
+static int CRCHOST_PclmulSupported(void)
+{
+    static int supported = -1;
+
+    if (supported < 0)
+    {
+        __builtin_cpu_init();
+        supported = (__builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1")) ? 1 : 0;
+    }
+
+    return supported;
+}
+#endif
+
+#ifdef CRCHOST_ARMV8
+/**
+ * @brief ARMv8 CRC32 instruction kernel, eight bytes per instruction
+ *
+ * @param state Inverted CRC (internal state)
+ * @param words Data
+ * @param count Number of words
+ * @return updated state
+ */
+static uint32_t CRCHOST_Armv8(uint32_t state, const uint32_t *words, uint32_t count)
+{
+    uint32_t i = 0;
+
+    for (; (i + 2U) <= count; i += 2U)
+    {
+        state = __crc32d(state, (uint64_t)words[i] | ((uint64_t)words[i + 1U] << 32));
+    }
+
+    if (i < count)
+    {
+        state = __crc32w(state, words[i]);
+    }
+
+    return state;
+}
+#endif
+
+/************************************
+ * GLOBAL FUNCTIONS
+ ************************************/
+
+/**
+ * @brief Update a reflected CRC-32 with 32-bit words
+ *
+ * @param crc   Starting CRC value (0 for a new CRC)
+ * @param words Data, 32-bit aligned
+ * @param count Number of words
+ * @return updated CRC value
+ */
+uint32_t crc_driver_update(uint32_t crc, const uint32_t *words, uint32_t count)
+{
+    uint32_t state = ~crc;
+
+#if defined(CRCHOST_ARMV8)
+    state = CRCHOST_Armv8(state, words, count);
+#elif defined(CRCHOST_PCLMUL)
+    if ((count >= CRCHOST_PCLMUL_MIN_WORDS) && CRCHOST_PclmulSupported())
+    {
+        state = CRCHOST_Pclmul(state, words, count);
+    }
+    else
+    {
+        state = CRCHOST_Bitwise(state, words, count);
+    }
+#else
+    state = CRCHOST_Bitwise(state, words, count);
+#endif
+
+    return ~state;
+}
+
+/**
+ * @brief Name of the CRC backend
+ *
+ * @return backend name
+ */
+const char *crc_driver_backend(void)
+{
+#if defined(CRCHOST_ARMV8)
+    return "armv8-crc32";
+#elif defined(CRCHOST_PCLMUL)
+    return CRCHOST_PclmulSupported() ? "x86-pclmul" : "bitwise";
+#else
+    return "bitwise";
+#endif
+}
@@ -0,0 +1,437 @@
+/**
+ ********************************************************************************
+ * @file    dir_bench.c
+ * @author  SimON
+ * @date    17 окт. 2026 г.
+ * @brief   Reliance Edge name lookup and create cost in a large directory
+ *
+ *          The "SPIF:" volume is formatted and a data logger directory of
+ *          DIRBENCH_NAMES names is built and committed before anything is
+ *          measured. The volume has far fewer inodes than that, so the names
+ *          are hard links to one file: the dirents are laid out exactly as
+ *          for as many files. Measured phases:
+ *          - lookup      : red_stat of random existing names;
+ *          - lookup_miss : red_stat of names that do not exist;
+ *          - create      : new files (red_open O_CREAT | O_EXCL, red_close);
+ *          - rotate      : the oldest name is unlinked and a new one linked.
+ *          Every phase is committed after its counters are sampled: the cost
+ *          of red_transact does not depend on how the names are looked up.
+ *
+ *          Reported per operation: Reliance Edge buffer lookups (directory
+ *          blocks touched), blocks read from the disk, bytes read from the
+ *          flash, the device time of these reads and the whole time
+ *          (simulated device plus host; creates also program and erase). The
+ *          directory is listed at the end and must hold exactly the expected
+ *          names.
+ *
+ *          The directory index is a build option (REDCONF_DIR_INDEX_ENTRIES,
+ *          redconf.h): compare with a build of a lower budget, or 0 for the
+ *          plain directory scan.
+ ********************************************************************************
+ */
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <redfs.h>
+#include <redposix.h>
+#include <redcore.h>
+
+#include "dir_bench.h"
+#include "lx_api.h"
+#include "lx_nor_flash_simulator.h"
+
+/************************************
+ * PRIVATE MACROS AND DEFINES
+ ************************************/
+#define DIRBENCH_VOLUME             "SPIF:"
+#define DIRBENCH_DIR                DIRBENCH_VOLUME "/log"
+#define DIRBENCH_TARGET             DIRBENCH_DIR "/data.bin"
+#define DIRBENCH_NAMES              3000U
+#define DIRBENCH_FILL_TRANSACT      64U
+#define DIRBENCH_LOOKUPS            1024U
+#define DIRBENCH_MISSES             256U
+#define DIRBENCH_CREATES            64U
+#define DIRBENCH_ROTATES            256U
+
+#ifndef REDCONF_DIR_INDEX_ENTRIES
+#define REDCONF_DIR_INDEX_ENTRIES   0U
+#endif
+#ifndef REDCONF_DIR_INDEX_DIRS
+#define REDCONF_DIR_INDEX_DIRS      0U
+#endif
+
+/************************************
+ * PRIVATE TYPEDEFS
+ ************************************/
+
+/* Counters of one measured phase */
+typedef struct
+{
+    const char                     *pszName;
+    uint32_t                        ulOps;
+    REDBUFFERSTATS                  buf;
+    LX_NOR_FLASH_SIMULATOR_STATS    flash;
+    uint64_t                        ullHostNs;
+} dirbench_phase;
+
+/* Measured phase, in run order */
+typedef struct
+{
+    const char         *pszName;
+    int32_t           (*pfnRun)(dirbench_phase *pPhase);
+} dirbench_entry;
+
+/************************************
+ * STATIC FUNCTION PROTOTYPES
+ ************************************/
+static int32_t DIRBENCH_Fill(void);
+static int32_t DIRBENCH_Lookup(dirbench_phase *pPhase);
+static int32_t DIRBENCH_LookupMiss(dirbench_phase *pPhase);
+static int32_t DIRBENCH_Create(dirbench_phase *pPhase);
+static int32_t DIRBENCH_Rotate(dirbench_phase *pPhase);
+static int32_t DIRBENCH_Check(void);
+static void DIRBENCH_Begin(dirbench_phase *pPhase, const char *pszName);
+static void DIRBENCH_End(dirbench_phase *pPhase);
+static void DIRBENCH_Name(char *pszPath, uint32_t ulIdx);
+static uint64_t DIRBENCH_HostNs(void);
+static uint32_t DIRBENCH_Rand(void);
+
+/************************************
+ * STATIC VARIABLES
+ ************************************/
+static const dirbench_entry gaPhases[] =
+{
+    { "lookup",         DIRBENCH_Lookup     },
+    { "lookup_miss",    DIRBENCH_LookupMiss },
+    { "create",         DIRBENCH_Create     },
+    { "rotate",         DIRBENCH_Rotate     },
+};
+
+static uint32_t ulRandState = 1U;
+
+/* Names rec00000 .. are linked in order, [ulFirst, ulNext) exist */
+static uint32_t ulFirst;
+static uint32_t ulNext;
+
+/************************************
+ * STATIC FUNCTIONS
+ ************************************/
+
+/**
+ * @brief Build the directory: the target file and DIRBENCH_NAMES links to it
+ */
+static int32_t DIRBENCH_Fill(void)
+{
+    char szPath[48];
+    int32_t fd;
+
+    if (red_mkdir(DIRBENCH_DIR) != 0)
+    {
+        return -1;
+    }
+
+    fd = red_open(DIRBENCH_TARGET, RED_O_CREAT | RED_O_EXCL | RED_O_WRONLY);
+    if ((fd < 0) || (red_close(fd) != 0))
+    {
+        return -1;
+    }
+
+    for (ulNext = 0; ulNext < DIRBENCH_NAMES; ulNext++)
+    {
+        DIRBENCH_Name(szPath, ulNext);
+        if (red_link(DIRBENCH_TARGET, szPath) != 0)
+        {
+            return -1;
+        }
+
+        if (((ulNext + 1U) % DIRBENCH_FILL_TRANSACT) == 0U)
+        {
+            if (red_transact(DIRBENCH_VOLUME) != 0)
+            {
+                return -1;
+            }
+        }
+    }
+
+    ulFirst = 0;
+
+    return red_transact(DIRBENCH_VOLUME);
+}
+
+/**
+ * @brief Stat random existing names
+ */
+static int32_t DIRBENCH_Lookup(dirbench_phase *pPhase)
+{
+    char szPath[48];
+    REDSTAT st;
+
+    for (uint32_t i = 0; i < DIRBENCH_LOOKUPS; i++)
+    {
+        DIRBENCH_Name(szPath, ulFirst + (DIRBENCH_Rand() % (ulNext - ulFirst)));
+        if (red_stat(szPath, &st) != 0)
+        {
+            return -1;
+        }
+
+        pPhase->ulOps++;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Stat names which are not in the directory
+ */
+static int32_t DIRBENCH_LookupMiss(dirbench_phase *pPhase)
+{
+    char szPath[48];
+    REDSTAT st;
+
+    for (uint32_t i = 0; i < DIRBENCH_MISSES; i++)
+    {
+        (void)snprintf(szPath, sizeof(szPath), DIRBENCH_DIR "/miss%05lu.log", (unsigned long)i);
+        if ((red_stat(szPath, &st) == 0) || (red_errno != RED_ENOENT))
+        {
+            return -1;
+        }
+
+        pPhase->ulOps++;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Create new empty files, each one needs the name to be absent and a free dirent
+ */
+static int32_t DIRBENCH_Create(dirbench_phase *pPhase)
+{
+    char szPath[48];
+
+    for (uint32_t i = 0; i < DIRBENCH_CREATES; i++)
+    {
+        (void)snprintf(szPath, sizeof(szPath), DIRBENCH_DIR "/new%05lu.log", (unsigned long)i);
+
+        int32_t fd = red_open(szPath, RED_O_CREAT | RED_O_EXCL | RED_O_WRONLY);
+        if ((fd < 0) || (red_close(fd) != 0))
+        {
+            return -1;
+        }
+
+        pPhase->ulOps++;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Log rotation: unlink the oldest name, link a new one
+ */
+static int32_t DIRBENCH_Rotate(dirbench_phase *pPhase)
+{
+    char szPath[48];
+
+    for (uint32_t i = 0; i < DIRBENCH_ROTATES; i++)
+    {
+        DIRBENCH_Name(szPath, ulFirst);
+        if (red_unlink(szPath) != 0)
+        {
+            return -1;
+        }
+        ulFirst++;
+
+        DIRBENCH_Name(szPath, ulNext);
+        if (red_link(DIRBENCH_TARGET, szPath) != 0)
+        {
+            return -1;
+        }
+        ulNext++;
+
+        pPhase->ulOps++;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief List the directory: the target, the live names and the created files, nothing else
+ */
+static int32_t DIRBENCH_Check(void)
+{
+    REDDIR *pDir = red_opendir(DIRBENCH_DIR);
+    uint32_t ulCount = 0;
+    REDSTAT st;
+
+    if (pDir == NULL)
+    {
+        return -1;
+    }
+
+    while (red_readdir(pDir) != NULL)
+    {
+        ulCount++;
+    }
+
+    if ((red_closedir(pDir) != 0) || (ulCount != ((ulNext - ulFirst) + DIRBENCH_CREATES + 1U)))
+    {
+        fprintf(stderr, "dir_bench: %lu names listed\n", (unsigned long)ulCount);
+        return -1;
+    }
+
+    /* One link per live name plus the target itself */
+    if ((red_stat(DIRBENCH_TARGET, &st) != 0) || (st.st_nlink != ((ulNext - ulFirst) + 1U)))
+    {
+        fprintf(stderr, "dir_bench: target link count mismatch\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Sample the counters at the start of a phase
+ */
+static void DIRBENCH_Begin(dirbench_phase *pPhase, const char *pszName)
+{
+    memset(pPhase, 0, sizeof(*pPhase));
+    pPhase->pszName = pszName;
+
+    RedBufferStatsGet(&pPhase->buf);
+    _lx_nor_flash_simulator_stats_get(&pPhase->flash);
+    pPhase->ullHostNs = DIRBENCH_HostNs();
+}
+
+/**
+ * @brief Print the per operation cost of a phase
+ */
+static void DIRBENCH_End(dirbench_phase *pPhase)
+{
+    REDBUFFERSTATS buf;
+    LX_NOR_FLASH_SIMULATOR_STATS flash;
+    LX_NOR_FLASH_SIMULATOR_TIMING timing;
+    uint64_t ullHostNs = DIRBENCH_HostNs() - pPhase->ullHostNs;
+    uint64_t ullBytesRead;
+    uint64_t ullReadNs;
+    double dOps;
+
+    RedBufferStatsGet(&buf);
+    _lx_nor_flash_simulator_stats_get(&flash);
+    _lx_nor_flash_simulator_timing_get(&timing);
+
+    ullBytesRead = flash.lx_nor_flash_simulator_bytes_read - pPhase->flash.lx_nor_flash_simulator_bytes_read;
+    ullReadNs = ((flash.lx_nor_flash_simulator_read_commands - pPhase->flash.lx_nor_flash_simulator_read_commands) * timing.lx_nor_flash_simulator_command_ns) +
+                (ullBytesRead * timing.lx_nor_flash_simulator_read_byte_ns);
+
+    dOps = (pPhase->ulOps != 0U) ? (double)pPhase->ulOps : 1.0;
+
+    printf("%-12s %6lu %12.1f %12.2f %12.1f %12.1f %10.1f\n",
+           pPhase->pszName, (unsigned long)pPhase->ulOps,
+           (double)(buf.ulLookups - pPhase->buf.ulLookups) / dOps,
+           (double)(buf.ulReads - pPhase->buf.ulReads) / dOps,
+           (double)ullBytesRead / dOps,
+           (double)ullReadNs / (dOps * 1000.0),
+           ((double)(flash.lx_nor_flash_simulator_busy_ns - pPhase->flash.lx_nor_flash_simulator_busy_ns) + (double)ullHostNs) / (dOps * 1000.0));
+}
+
+/**
+ * @brief Path of the name number ulIdx
+ */
+static void DIRBENCH_Name(char *pszPath, uint32_t ulIdx)
+{
+    (void)snprintf(pszPath, 48U, DIRBENCH_DIR "/rec%05lu.log", (unsigned long)ulIdx);
+}
+
+/**
+ * @brief Monotonic host time in nanoseconds
+ */
+static uint64_t DIRBENCH_HostNs(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Deterministic pseudo random generator (xorshift32), same sequence on every run
+ */
+static uint32_t DIRBENCH_Rand(void)
+{
+    ulRandState ^= ulRandState << 13;
+    ulRandState ^= ulRandState >> 17;
+    ulRandState ^= ulRandState << 5;
+
+    return ulRandState;
+}
+
+/************************************
+ * GLOBAL FUNCTIONS
+ ************************************/
+
+/**
+ * @brief Build the large directory on a fresh volume and measure each phase
+ *
+ * @return 0 on success, -1 if a phase failed or the directory check failed
+ */
+int32_t DIRBENCH_Run(void)
+{
+    dirbench_phase phase;
+    int32_t ret = 0;
+
+    (void)_lx_nor_flash_simulator_erase_all();
+    _lx_nor_flash_simulator_stats_reset();
+
+    if ((red_init() != 0) || (red_format(DIRBENCH_VOLUME) != 0) || (red_mount(DIRBENCH_VOLUME) != 0))
+    {
+        fprintf(stderr, "dir_bench: volume setup failed, errno %d\n", (int)red_errno);
+        return -1;
+    }
+
+    if (DIRBENCH_Fill() != 0)
+    {
+        fprintf(stderr, "dir_bench: fill failed at name %lu, errno %d\n", (unsigned long)ulNext, (int)red_errno);
+        (void)red_umount(DIRBENCH_VOLUME);
+        (void)red_uninit();
+        return -1;
+    }
+
+    printf("# directory of %u names, index budget %u names over %u directories, buffers %u\n",
+           (unsigned)DIRBENCH_NAMES, (unsigned)REDCONF_DIR_INDEX_ENTRIES, (unsigned)REDCONF_DIR_INDEX_DIRS,
+           (unsigned)REDCONF_BUFFER_COUNT);
+    printf("%-12s %6s %12s %12s %12s %12s %10s\n", "phase", "ops", "buf_get/op", "disk_rd/op", "bytes_rd/op", "read_us/op", "us/op");
+
+    ulRandState = 1U;
+
+    for (uint32_t i = 0; (ret == 0) && (i < (sizeof(gaPhases) / sizeof(gaPhases[0]))); i++)
+    {
+        DIRBENCH_Begin(&phase, gaPhases[i].pszName);
+
+        if (gaPhases[i].pfnRun(&phase) != 0)
+        {
+            fprintf(stderr, "dir_bench: %s failed, errno %d\n", phase.pszName, (int)red_errno);
+            ret = -1;
+            break;
+        }
+
+        DIRBENCH_End(&phase);
+
+        ret = red_transact(DIRBENCH_VOLUME);
+    }
+
+    if (ret == 0)
+    {
+        ret = DIRBENCH_Check();
+    }
+
+    (void)red_umount(DIRBENCH_VOLUME);
+    (void)red_uninit();
+
+    return ret;
+}
@@ -0,0 +1,645 @@
+/**
+ ********************************************************************************
+ * @file    fs_bench.c
+ * @author  SimON
+ * @date    17 окт. 2026 г.
+ * @brief   Reliance Edge + LevelX benchmark suite over the simulated NOR volume
+ *
+ *          Every run starts from an erased part: the "SPIF:" volume from
+ *          gaRedVolConf is formatted and mounted through red_init/red_mount and
+ *          each workload is driven through the POSIX-like API. Setup work of a
+ *          workload (preallocated files etc.) is committed before the counters
+ *          are sampled, every workload ends with red_transact so the flash
+ *          traffic of the commit is part of its result.
+ ********************************************************************************
+ */
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <redfs.h>
+#include <redposix.h>
+#include <redcore.h>
+
+#include "fs_bench.h"
+
+/************************************
+ * EXTERN VARIABLES
+ ************************************/
+
+/************************************
+ * PRIVATE MACROS AND DEFINES
+ ************************************/
+
+/* Sequential append logging */
+#define SEQ_RECORD_SIZE             256U
+#define SEQ_RECORD_COUNT            2048U
+#define SEQ_TRANSACT_EVERY          64U
+
+/* Random overwrites inside a preallocated file */
+#define RAND_FILE_SIZE              (256U * 1024U)
+#define RAND_512_COUNT              1024U
+#define RAND_4K_COUNT               512U
+#define RAND_TRANSACT_EVERY         16U
+
+/* Many small files */
+#define SMALL_FILE_COUNT            48U
+#define SMALL_FILE_SIZE             1024U
+
+/* Directory churn */
+#define DIR_CHURN_ROUNDS            32U
+
+/* Repeated open of a deep path */
+#define DEEP_OPEN_COUNT             256U
+#define DEEP_RECORD_SIZE            64U
+#define DEEP_TRANSACT_EVERY         16U
+
+/* red_transact cadence sweep */
+#define SWEEP_WRITE_SIZE            4096U
+#define SWEEP_WRITE_COUNT           64U
+
+#define BENCH_BUFFER_SIZE           4096U
+
+/************************************
+ * PRIVATE TYPEDEFS
+ ************************************/
+typedef int32_t (*fsbench_workload)(fsbench_result *pRes, uint32_t ulParam);
+
+typedef struct
+{
+    const char         *pszName;
+    fsbench_workload    pfnRun;
+    uint32_t            ulParam;
+} fsbench_entry;
+
+/************************************
+ * STATIC FUNCTION PROTOTYPES
+ ************************************/
+static int32_t FSBENCH_SeqAppend(fsbench_result *pRes, uint32_t ulParam);
+static int32_t FSBENCH_RandOverwrite(fsbench_result *pRes, uint32_t ulParam);
+static int32_t FSBENCH_SmallFiles(fsbench_result *pRes, uint32_t ulParam);
+static int32_t FSBENCH_DirChurn(fsbench_result *pRes, uint32_t ulParam);
+static int32_t FSBENCH_DeepOpen(fsbench_result *pRes, uint32_t ulParam);
+static int32_t FSBENCH_TransactSweep(fsbench_result *pRes, uint32_t ulParam);
+
+static int32_t FSBENCH_Prepare(const char *pszPath, uint32_t ulSize);
+static void FSBENCH_Begin(fsbench_result *pRes, const char *pszName);
+static void FSBENCH_End(fsbench_result *pRes);
+static void FSBENCH_Report(const fsbench_result *pRes, fsbench_format format);
+static uint64_t FSBENCH_HostNs(void);
+static uint32_t FSBENCH_Rand(void);
+
+/************************************
+ * STATIC VARIABLES
+ ************************************/
+
+/* Workload table, the name is what the filter matches against */
+static const fsbench_entry gaWorkloads[] =
+{
+    { "seq_append",      FSBENCH_SeqAppend,      0U   },
+    { "rand_512",        FSBENCH_RandOverwrite,  512U },
+    { "rand_4k",         FSBENCH_RandOverwrite,  4096U },
+    { "small_files",     FSBENCH_SmallFiles,     0U   },
+    { "dir_churn",       FSBENCH_DirChurn,       0U   },
+    { "deep_open",       FSBENCH_DeepOpen,       0U   },
+    { "transact_1",      FSBENCH_TransactSweep,  1U   },
+    { "transact_4",      FSBENCH_TransactSweep,  4U   },
+    { "transact_16",     FSBENCH_TransactSweep,  16U  },
+    { "transact_64",     FSBENCH_TransactSweep,  64U  },
+};
+
+static uint8_t abBuffer[BENCH_BUFFER_SIZE] __attribute__((aligned(4)));
+static uint32_t ulRandState = 1U;
+
+/* Sample of the counters at the start of the running workload */
+static LX_NOR_FLASH_SIMULATOR_STATS startStats;
+static REDBUFFERSTATS startBufStats;
+static REDDCACHESTATS startDcStats;
+static uint64_t ullStartNs;
+
+/************************************
+ * GLOBAL VARIABLES
+ ************************************/
+
+/************************************
+ * STATIC FUNCTIONS
+ ************************************/
+
+/**
+ * @brief Append fixed size records to a log file
+ */
+static int32_t FSBENCH_SeqAppend(fsbench_result *pRes, uint32_t ulParam)
+{
+    (void)ulParam;
+
+    int32_t fd = red_open(FSBENCH_VOLUME "/seq.log", RED_O_CREAT | RED_O_WRONLY | RED_O_APPEND);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < SEQ_RECORD_COUNT; i++)
+    {
+        if (red_write(fd, abBuffer, SEQ_RECORD_SIZE) != (int32_t)SEQ_RECORD_SIZE)
+        {
+            (void)red_close(fd);
+            return -1;
+        }
+
+        pRes->ullOps++;
+        pRes->ullBytes += SEQ_RECORD_SIZE;
+        pRes->ullBytesWritten += SEQ_RECORD_SIZE;
+
+        if (((i + 1U) % SEQ_TRANSACT_EVERY) == 0U)
+        {
+            if (red_transact(FSBENCH_VOLUME) != 0)
+            {
+                (void)red_close(fd);
+                return -1;
+            }
+        }
+    }
+
+    if (red_close(fd) != 0)
+    {
+        return -1;
+    }
+
+    return red_unlink(FSBENCH_VOLUME "/seq.log");
+}
+
+/**
+ * @brief Random aligned overwrites of ulParam bytes inside a preallocated file
+ */
+static int32_t FSBENCH_RandOverwrite(fsbench_result *pRes, uint32_t ulParam)
+{
+    uint32_t ulCount = (ulParam == 512U) ? RAND_512_COUNT : RAND_4K_COUNT;
+    uint32_t ulSlots = RAND_FILE_SIZE / ulParam;
+
+    int32_t fd = red_open(FSBENCH_VOLUME "/rand.dat", RED_O_WRONLY);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < ulCount; i++)
+    {
+        uint64_t ullOffset = (uint64_t)(FSBENCH_Rand() % ulSlots) * ulParam;
+
+        if (red_pwrite(fd, abBuffer, ulParam, ullOffset) != (int32_t)ulParam)
+        {
+            (void)red_close(fd);
+            return -1;
+        }
+
+        pRes->ullOps++;
+        pRes->ullBytes += ulParam;
+        pRes->ullBytesWritten += ulParam;
+
+        if (((i + 1U) % RAND_TRANSACT_EVERY) == 0U)
+        {
+            if (red_transact(FSBENCH_VOLUME) != 0)
+            {
+                (void)red_close(fd);
+                return -1;
+            }
+        }
+    }
+
+    return red_close(fd);
+}
+
+/**
+ * @brief Create, read back and delete many small files
+ */
+static int32_t FSBENCH_SmallFiles(fsbench_result *pRes, uint32_t ulParam)
+{
+    char szPath[32];
+    REDSTAT st;
+
+    (void)ulParam;
+
+    for (uint32_t i = 0; i < SMALL_FILE_COUNT; i++)
+    {
+        (void)snprintf(szPath, sizeof(szPath), FSBENCH_VOLUME "/f%03lu.bin", (unsigned long)i);
+
+        int32_t fd = red_open(szPath, RED_O_CREAT | RED_O_EXCL | RED_O_WRONLY);
+        if ((fd < 0) || (red_write(fd, abBuffer, SMALL_FILE_SIZE) != (int32_t)SMALL_FILE_SIZE) || (red_close(fd) != 0))
+        {
+            return -1;
+        }
+
+        pRes->ullOps += 3U;
+        pRes->ullBytes += SMALL_FILE_SIZE;
+        pRes->ullBytesWritten += SMALL_FILE_SIZE;
+    }
+
+    if (red_transact(FSBENCH_VOLUME) != 0)
+    {
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < SMALL_FILE_COUNT; i++)
+    {
+        (void)snprintf(szPath, sizeof(szPath), FSBENCH_VOLUME "/f%03lu.bin", (unsigned long)i);
+
+        if (red_stat(szPath, &st) != 0)
+        {
+            return -1;
+        }
+
+        int32_t fd = red_open(szPath, RED_O_RDONLY);
+        if ((fd < 0) || (red_read(fd, abBuffer, SMALL_FILE_SIZE) != (int32_t)SMALL_FILE_SIZE) || (red_close(fd) != 0))
+        {
+            return -1;
+        }
+
+        pRes->ullOps += 4U;
+        pRes->ullBytes += SMALL_FILE_SIZE;
+    }
+
+    for (uint32_t i = 0; i < SMALL_FILE_COUNT; i++)
+    {
+        (void)snprintf(szPath, sizeof(szPath), FSBENCH_VOLUME "/f%03lu.bin", (unsigned long)i);
+
+        if (red_unlink(szPath) != 0)
+        {
+            return -1;
+        }
+
+        pRes->ullOps++;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Repeatedly create and remove a directory with a file inside
+ */
+static int32_t FSBENCH_DirChurn(fsbench_result *pRes, uint32_t ulParam)
+{
+    (void)ulParam;
+
+    for (uint32_t i = 0; i < DIR_CHURN_ROUNDS; i++)
+    {
+        if (red_mkdir(FSBENCH_VOLUME "/churn") != 0)
+        {
+            return -1;
+        }
+
+        int32_t fd = red_open(FSBENCH_VOLUME "/churn/entry", RED_O_CREAT | RED_O_WRONLY);
+        if ((fd < 0) || (red_write(fd, abBuffer, SEQ_RECORD_SIZE) != (int32_t)SEQ_RECORD_SIZE) || (red_close(fd) != 0))
+        {
+            return -1;
+        }
+
+        if ((red_unlink(FSBENCH_VOLUME "/churn/entry") != 0) || (red_rmdir(FSBENCH_VOLUME "/churn") != 0))
+        {
+            return -1;
+        }
+
+        if (red_transact(FSBENCH_VOLUME) != 0)
+        {
+            return -1;
+        }
+
+        pRes->ullOps += 7U;
+        pRes->ullBytes += SEQ_RECORD_SIZE;
+        pRes->ullBytesWritten += SEQ_RECORD_SIZE;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Logger pattern: open a file deep in the tree, append a record and
+ *        close it again, checking for a file that does not exist every time
+ */
+static int32_t FSBENCH_DeepOpen(fsbench_result *pRes, uint32_t ulParam)
+{
+    static const char * const apszDirs[] =
+    {
+        FSBENCH_VOLUME "/log",
+        FSBENCH_VOLUME "/log/2026",
+        FSBENCH_VOLUME "/log/2026/10",
+        FSBENCH_VOLUME "/log/2026/10/17",
+    };
+    REDSTAT st;
+
+    (void)ulParam;
+
+    for (uint32_t i = 0; i < (sizeof(apszDirs) / sizeof(apszDirs[0])); i++)
+    {
+        if (red_mkdir(apszDirs[i]) != 0)
+        {
+            return -1;
+        }
+    }
+
+    for (uint32_t i = 0; i < DEEP_OPEN_COUNT; i++)
+    {
+        int32_t fd = red_open(FSBENCH_VOLUME "/log/2026/10/17/app.log", RED_O_CREAT | RED_O_WRONLY | RED_O_APPEND);
+        if ((fd < 0) || (red_write(fd, abBuffer, DEEP_RECORD_SIZE) != (int32_t)DEEP_RECORD_SIZE) || (red_close(fd) != 0))
+        {
+            return -1;
+        }
+
+        if ((red_stat(FSBENCH_VOLUME "/log/2026/10/17/app.log.1", &st) == 0) || (red_errno != RED_ENOENT))
+        {
+            return -1;
+        }
+
+        pRes->ullOps += 4U;
+        pRes->ullBytes += DEEP_RECORD_SIZE;
+        pRes->ullBytesWritten += DEEP_RECORD_SIZE;
+
+        if (((i + 1U) % DEEP_TRANSACT_EVERY) == 0U)
+        {
+            if (red_transact(FSBENCH_VOLUME) != 0)
+            {
+                return -1;
+            }
+        }
+    }
+
+    if (red_unlink(FSBENCH_VOLUME "/log/2026/10/17/app.log") != 0)
+    {
+        return -1;
+    }
+
+    for (uint32_t i = (sizeof(apszDirs) / sizeof(apszDirs[0])); i > 0U; i--)
+    {
+        if (red_rmdir(apszDirs[i - 1U]) != 0)
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Append 4 KB writes, committing a transaction every ulParam writes
+ */
+static int32_t FSBENCH_TransactSweep(fsbench_result *pRes, uint32_t ulParam)
+{
+    int32_t fd = red_open(FSBENCH_VOLUME "/sweep.dat", RED_O_CREAT | RED_O_WRONLY | RED_O_TRUNC);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < SWEEP_WRITE_COUNT; i++)
+    {
+        if (red_write(fd, abBuffer, SWEEP_WRITE_SIZE) != (int32_t)SWEEP_WRITE_SIZE)
+        {
+            (void)red_close(fd);
+            return -1;
+        }
+
+        pRes->ullOps++;
+        pRes->ullBytes += SWEEP_WRITE_SIZE;
+        pRes->ullBytesWritten += SWEEP_WRITE_SIZE;
+
+        if (((i + 1U) % ulParam) == 0U)
+        {
+            if (red_transact(FSBENCH_VOLUME) != 0)
+            {
+                (void)red_close(fd);
+                return -1;
+            }
+        }
+    }
+
+    if (red_close(fd) != 0)
+    {
+        return -1;
+    }
+
+    return red_unlink(FSBENCH_VOLUME "/sweep.dat");
+}
+
+/**
+ * @brief Create a file of the given size and commit it (not measured)
+ */
+static int32_t FSBENCH_Prepare(const char *pszPath, uint32_t ulSize)
+{
+    int32_t fd = red_open(pszPath, RED_O_CREAT | RED_O_WRONLY | RED_O_TRUNC);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    for (uint32_t ulDone = 0; ulDone < ulSize; ulDone += BENCH_BUFFER_SIZE)
+    {
+        if (red_write(fd, abBuffer, BENCH_BUFFER_SIZE) != (int32_t)BENCH_BUFFER_SIZE)
+        {
+            (void)red_close(fd);
+            return -1;
+        }
+    }
+
+    if (red_close(fd) != 0)
+    {
+        return -1;
+    }
+
+    return red_transact(FSBENCH_VOLUME);
+}
+
+/**
+ * @brief Sample the counters at the start of a workload
+ */
+static void FSBENCH_Begin(fsbench_result *pRes, const char *pszName)
+{
+    memset(pRes, 0, sizeof(*pRes));
+    pRes->pszName = pszName;
+
+    _lx_nor_flash_simulator_stats_get(&startStats);
+    RedBufferStatsGet(&startBufStats);
+    RedDcacheStatsGet(&startDcStats);
+    ullStartNs = FSBENCH_HostNs();
+}
+
+/**
+ * @brief Turn the counters into deltas since FSBENCH_Begin()
+ */
+static void FSBENCH_End(fsbench_result *pRes)
+{
+    LX_NOR_FLASH_SIMULATOR_STATS now;
+    REDBUFFERSTATS bufNow;
+    REDDCACHESTATS dcNow;
+
+    pRes->ullHostNs = FSBENCH_HostNs() - ullStartNs;
+    _lx_nor_flash_simulator_stats_get(&now);
+    RedBufferStatsGet(&bufNow);
+    RedDcacheStatsGet(&dcNow);
+
+    pRes->ullBufLookups = bufNow.ulLookups - startBufStats.ulLookups;
+    pRes->ullBufHits    = bufNow.ulHits    - startBufStats.ulHits;
+    pRes->ullDcLookups  = dcNow.ulLookups  - startDcStats.ulLookups;
+    pRes->ullDcHits     = dcNow.ulHits     - startDcStats.ulHits;
+
+    pRes->flash.lx_nor_flash_simulator_read_commands      = now.lx_nor_flash_simulator_read_commands      - startStats.lx_nor_flash_simulator_read_commands;
+    pRes->flash.lx_nor_flash_simulator_bytes_read         = now.lx_nor_flash_simulator_bytes_read         - startStats.lx_nor_flash_simulator_bytes_read;
+    pRes->flash.lx_nor_flash_simulator_write_requests     = now.lx_nor_flash_simulator_write_requests     - startStats.lx_nor_flash_simulator_write_requests;
+    pRes->flash.lx_nor_flash_simulator_page_programs      = now.lx_nor_flash_simulator_page_programs      - startStats.lx_nor_flash_simulator_page_programs;
+    pRes->flash.lx_nor_flash_simulator_bytes_programmed   = now.lx_nor_flash_simulator_bytes_programmed   - startStats.lx_nor_flash_simulator_bytes_programmed;
+    pRes->flash.lx_nor_flash_simulator_subsector_erases   = now.lx_nor_flash_simulator_subsector_erases   - startStats.lx_nor_flash_simulator_subsector_erases;
+    pRes->flash.lx_nor_flash_simulator_sector_erases      = now.lx_nor_flash_simulator_sector_erases      - startStats.lx_nor_flash_simulator_sector_erases;
+    pRes->flash.lx_nor_flash_simulator_erased_verifies    = now.lx_nor_flash_simulator_erased_verifies    - startStats.lx_nor_flash_simulator_erased_verifies;
+    pRes->flash.lx_nor_flash_simulator_program_violations = now.lx_nor_flash_simulator_program_violations - startStats.lx_nor_flash_simulator_program_violations;
+    pRes->flash.lx_nor_flash_simulator_system_errors      = now.lx_nor_flash_simulator_system_errors      - startStats.lx_nor_flash_simulator_system_errors;
+    pRes->flash.lx_nor_flash_simulator_busy_ns            = now.lx_nor_flash_simulator_busy_ns            - startStats.lx_nor_flash_simulator_busy_ns;
+}
+
+/**
+ * @brief Print one result line
+ *
+ * Throughput is computed on the simulated device time plus the host time
+ * spent in the stack, which approximates the wall time on the target.
+ */
+static void FSBENCH_Report(const fsbench_result *pRes, fsbench_format format)
+{
+    const LX_NOR_FLASH_SIMULATOR_STATS *f = &pRes->flash;
+    double dSeconds = (double)(f->lx_nor_flash_simulator_busy_ns + pRes->ullHostNs) / 1e9;
+    double dOpsPerSec = (dSeconds > 0.0) ? ((double)pRes->ullOps / dSeconds) : 0.0;
+    double dBytesPerSec = (dSeconds > 0.0) ? ((double)pRes->ullBytes / dSeconds) : 0.0;
+    double dWriteAmp = (pRes->ullBytesWritten != 0U) ? ((double)f->lx_nor_flash_simulator_bytes_programmed / (double)pRes->ullBytesWritten) : 0.0;
+    uint64_t ullErases = f->lx_nor_flash_simulator_subsector_erases + f->lx_nor_flash_simulator_sector_erases;
+    double dBufHit = (pRes->ullBufLookups != 0U) ? (100.0 * (double)pRes->ullBufHits / (double)pRes->ullBufLookups) : 0.0;
+    double dDcHit = (pRes->ullDcLookups != 0U) ? (100.0 * (double)pRes->ullDcHits / (double)pRes->ullDcLookups) : 0.0;
+
+    if (format == FSBENCH_FMT_JSON)
+    {
+        printf("{\"workload\":\"%s\",\"ops\":%llu,\"bytes\":%llu,\"ops_per_s\":%.1f,\"bytes_per_s\":%.1f,"
+               "\"device_ns\":%llu,\"host_ns\":%llu,\"page_programs\":%llu,\"bytes_programmed\":%llu,"
+               "\"erases\":%llu,\"read_commands\":%llu,\"bytes_read\":%llu,\"write_amp\":%.3f,"
+               "\"program_violations\":%llu,\"system_errors\":%llu,\"buffer_lookups\":%llu,\"buffer_hits\":%llu,"
+               "\"dcache_lookups\":%llu,\"dcache_hits\":%llu}\n",
+               pRes->pszName,
+               (unsigned long long)pRes->ullOps, (unsigned long long)pRes->ullBytes, dOpsPerSec, dBytesPerSec,
+               (unsigned long long)f->lx_nor_flash_simulator_busy_ns, (unsigned long long)pRes->ullHostNs,
+               (unsigned long long)f->lx_nor_flash_simulator_page_programs, (unsigned long long)f->lx_nor_flash_simulator_bytes_programmed,
+               (unsigned long long)ullErases, (unsigned long long)f->lx_nor_flash_simulator_read_commands,
+               (unsigned long long)f->lx_nor_flash_simulator_bytes_read, dWriteAmp,
+               (unsigned long long)f->lx_nor_flash_simulator_program_violations,
+               (unsigned long long)f->lx_nor_flash_simulator_system_errors,
+               (unsigned long long)pRes->ullBufLookups, (unsigned long long)pRes->ullBufHits,
+               (unsigned long long)pRes->ullDcLookups, (unsigned long long)pRes->ullDcHits);
+    }
+    else
+    {
+        printf("%-14s %8llu %10.1f %12.1f %10llu %8llu %14llu %8.3f %7.1f%% %7.1f%%\n",
+               pRes->pszName,
+               (unsigned long long)pRes->ullOps, dOpsPerSec, dBytesPerSec,
+               (unsigned long long)f->lx_nor_flash_simulator_page_programs, (unsigned long long)ullErases,
+               (unsigned long long)f->lx_nor_flash_simulator_bytes_read, dWriteAmp, dBufHit, dDcHit);
+    }
+}
+
+/**
+ * @brief Monotonic host time in nanoseconds
+ */
+static uint64_t FSBENCH_HostNs(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Deterministic pseudo random generator (xorshift32), same sequence on every run
+ */
+static uint32_t FSBENCH_Rand(void)
+{
+    ulRandState ^= ulRandState << 13;
+    ulRandState ^= ulRandState >> 17;
+    ulRandState ^= ulRandState << 5;
+
+    return ulRandState;
+}
+
+/************************************
+ * GLOBAL FUNCTIONS
+ ************************************/
+
+/**
+ * @brief Format the simulated volume and run the workloads
+ *
+ * @param pszFilter : run only workloads whose name contains this string (NULL for all)
+ * @param format    : output format
+ * @return 0 on success, -1 if a workload failed
+ */
+int32_t FSBENCH_Run(const char *pszFilter, fsbench_format format)
+{
+    fsbench_result res;
+    int32_t ret = 0;
+
+    for (uint32_t i = 0; i < BENCH_BUFFER_SIZE; i++)
+    {
+        abBuffer[i] = (uint8_t)(i * 31U);
+    }
+
+    /* Start from a factory fresh part */
+    (void)_lx_nor_flash_simulator_erase_all();
+    _lx_nor_flash_simulator_stats_reset();
+
+    if ((red_init() != 0) || (red_format(FSBENCH_VOLUME) != 0) || (red_mount(FSBENCH_VOLUME) != 0))
+    {
+        fprintf(stderr, "fs_bench: volume setup failed, errno %d\n", (int)red_errno);
+        return -1;
+    }
+
+    if (format == FSBENCH_FMT_TEXT)
+    {
+        printf("# block %u, buffers %u, sector %u bytes\n", (unsigned)REDCONF_BLOCK_SIZE, (unsigned)REDCONF_BUFFER_COUNT, (unsigned)(LX_NOR_SECTOR_SIZE * sizeof(ULONG)));
+        printf("%-14s %8s %10s %12s %10s %8s %14s %8s %8s %8s\n", "workload", "ops", "ops/s", "bytes/s", "programs", "erases", "bytes_read", "wamp", "buf_hit", "dc_hit");
+    }
+
+    for (uint32_t i = 0; i < (sizeof(gaWorkloads) / sizeof(gaWorkloads[0])); i++)
+    {
+        const fsbench_entry *pEntry = &gaWorkloads[i];
+
+        if ((pszFilter != NULL) && (strstr(pEntry->pszName, pszFilter) == NULL))
+        {
+            continue;
+        }
+
+        if ((pEntry->pfnRun == FSBENCH_RandOverwrite) && (FSBENCH_Prepare(FSBENCH_VOLUME "/rand.dat", RAND_FILE_SIZE) != 0))
+        {
+            fprintf(stderr, "fs_bench: %s: setup failed, errno %d\n", pEntry->pszName, (int)red_errno);
+            ret = -1;
+            break;
+        }
+
+        FSBENCH_Begin(&res, pEntry->pszName);
+
+        if ((pEntry->pfnRun(&res, pEntry->ulParam) != 0) || (red_transact(FSBENCH_VOLUME) != 0))
+        {
+            fprintf(stderr, "fs_bench: %s failed, errno %d\n", pEntry->pszName, (int)red_errno);
+            ret = -1;
+            break;
+        }
+
+        FSBENCH_End(&res);
+        FSBENCH_Report(&res, format);
+
+        if ((pEntry->pfnRun == FSBENCH_RandOverwrite) && ((red_unlink(FSBENCH_VOLUME "/rand.dat") != 0) || (red_transact(FSBENCH_VOLUME) != 0)))
+        {
+            ret = -1;
+            break;
+        }
+    }
+
+    (void)red_umount(FSBENCH_VOLUME);
+    (void)red_uninit();
+
+    return ret;
+}
@@ -0,0 +1,496 @@
+/**
+ ********************************************************************************
+ * @file    gc_bench.c
+ * @author  SimON
+ * @date    17 окт. 2026 г.
+ * @brief   LevelX write latency: inline reclaim vs. background reclaim at idle
+ *
+ *          LevelX is driven directly on GCBENCH_AREA_SIZE of the default 64 KB
+ *          geometry with the mapping table and extended cache of osbdev.c. The
+ *          logical space is filled to GCBENCH_FILL_PCT percent, then bursts of
+ *          GCBENCH_BURST random single sector overwrites are timed one by one,
+ *          each burst followed by GCBENCH_IDLE_MS of idle device time. With
+ *          inline reclaim the idle time is unused and sector writes pay for
+ *          the relocation and erase of whole blocks. With background reclaim
+ *          lx_nor_flash_background_reclaim is called with the scenario budget
+ *          until the idle time is over or it has nothing left to do.
+ *
+ *          The inline_scan scenario runs without the block statistics table
+ *          (LX_NOR_ENABLE_BLOCK_STATS), so the next block to erase is found
+ *          by scanning the flash. After each burst the choice of the next
+ *          block to erase is timed once: device time of its flash reads and
+ *          host time.
+ *
+ *          Reported per scenario: write amplification, erases (of which done
+ *          in the background), sector moves done in the background, write
+ *          latency percentiles, the longest background call and the mean
+ *          cost of a victim choice, then a log2 histogram of the write
+ *          latencies. At the end every logical sector is read back and
+ *          checked, the instance counts must add up and every entry of the
+ *          block statistics table must match its block on the flash.
+ ********************************************************************************
+ */
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "gc_bench.h"
+#include "lx_api.h"
+#include "lx_nor_flash_simulator.h"
+
+#ifdef LX_NOR_ENABLE_BACKGROUND_RECLAIM
+
+/************************************
+ * PRIVATE MACROS AND DEFINES
+ ************************************/
+#define GCBENCH_AREA_SIZE           (1024U * 1024U)
+#define GCBENCH_BLOCK_SIZE          65536U
+#define GCBENCH_FILL_PCT            75U
+#define GCBENCH_BURST               32U
+#define GCBENCH_BURSTS              256U
+#define GCBENCH_IDLE_MS             1000U
+#define GCBENCH_MAPPING_TABLE       32640U  /* BDEV_MAPPING_TABLE_SECTORS, osbdev.c */
+#define GCBENCH_EXTENDED_CACHE      (12U * 1024U)  /* BDEV_EXTENDED_CACHE_SIZE, osbdev.c */
+#define GCBENCH_MAX_SECTORS         (GCBENCH_AREA_SIZE / (LX_NOR_SECTOR_SIZE * sizeof(ULONG)))
+#define GCBENCH_WRITES              (GCBENCH_BURST * GCBENCH_BURSTS)
+#define GCBENCH_BUCKETS             12U     /* < 1 ms, then doubling up to >= 1024 ms */
+
+/************************************
+ * PRIVATE TYPEDEFS
+ ************************************/
+typedef struct
+{
+    const char         *pszName;
+    ULONG               ulBudget;           /* Microseconds per background call, 0: inline only */
+    ULONG               ulScan;             /* Find the next block to erase by scanning the flash */
+} gcbench_entry;
+
+/************************************
+ * STATIC FUNCTION PROTOTYPES
+ ************************************/
+static int32_t GCBENCH_Scenario(const gcbench_entry *pEntry, ULONG aulHistogram[GCBENCH_BUCKETS]);
+static int32_t GCBENCH_Idle(ULONG ulBudget, ULONG64 *pullMaxCall);
+static int32_t GCBENCH_Find(ULONG64 *pullDevice, uint64_t *pullHost);
+static int32_t GCBENCH_StatsCheck(void);
+static UINT GCBENCH_ScanInitialize(LX_NOR_FLASH *nor_flash);
+static uint64_t GCBENCH_HostNs(void);
+static void GCBENCH_Fill(ULONG ulSector, ULONG ulVersion);
+static int GCBENCH_Compare(const void *pA, const void *pB);
+static uint32_t GCBENCH_Rand(void);
+
+/************************************
+ * STATIC VARIABLES
+ ************************************/
+static const gcbench_entry gaScenarios[] =
+{
+    { "inline_scan",    0U,         1U },
+    { "inline",         0U,         0U },
+    { "bg_750ms",       750000U,    0U },
+    { "bg_20ms",        20000U,     0U },
+};
+
+#define GCBENCH_SCENARIOS           (sizeof(gaScenarios) / sizeof(gaScenarios[0]))
+
+static LX_NOR_FLASH norFlash;
+static LX_NOR_MAPPING_TABLE_TYPE ausMappingTable[GCBENCH_MAPPING_TABLE];
+static ULONG aulExtendedCache[GCBENCH_EXTENDED_CACHE / sizeof(ULONG)];
+static ULONG aulSector[LX_NOR_SECTOR_SIZE];
+static ULONG aulCheck[LX_NOR_SECTOR_SIZE];
+static ULONG aulVersion[GCBENCH_MAX_SECTORS];
+static ULONG64 aullLatency[GCBENCH_WRITES];
+static ULONG aulHistograms[GCBENCH_SCENARIOS][GCBENCH_BUCKETS];
+static uint32_t ulRandState = 1U;
+
+/************************************
+ * STATIC FUNCTIONS
+ ************************************/
+
+/**
+ * @brief Fill, run the bursts and verify the area with one reclaim scenario
+ */
+static int32_t GCBENCH_Scenario(const gcbench_entry *pEntry, ULONG aulHistogram[GCBENCH_BUCKETS])
+{
+    LX_NOR_FLASH_SIMULATOR_STATS before;
+    LX_NOR_FLASH_SIMULATOR_STATS after;
+    ULONG ulLogical;
+    ULONG ulMoves;
+    ULONG ulErases;
+    ULONG64 ullMaxCall = 0;
+    ULONG64 ullFindDevice = 0;
+    uint64_t ullFindHost = 0;
+    uint64_t ullErases;
+
+    (void)_lx_nor_flash_simulator_erase_all();
+    if ((_lx_nor_flash_open(&norFlash, (CHAR *)pEntry->pszName,
+                            (pEntry->ulScan != 0U) ? GCBENCH_ScanInitialize : _lx_nor_flash_simulator_initialize) != LX_SUCCESS) ||
+        (_lx_nor_flash_mapping_table_enable(&norFlash, ausMappingTable, sizeof(ausMappingTable)) != LX_SUCCESS) ||
+        (_lx_nor_flash_extended_cache_enable(&norFlash, aulExtendedCache, sizeof(aulExtendedCache)) != LX_SUCCESS))
+    {
+        return -1;
+    }
+
+    ulLogical = (norFlash.lx_nor_flash_total_physical_sectors * GCBENCH_FILL_PCT) / 100U;
+
+    /* Initial fill is not measured */
+    for (ULONG i = 0; i < ulLogical; i++)
+    {
+        aulVersion[i] = 0;
+        GCBENCH_Fill(i, 0);
+        if (_lx_nor_flash_sector_write(&norFlash, i, aulSector) != LX_SUCCESS)
+        {
+            return -1;
+        }
+    }
+
+    ulRandState = 1U;
+    ulMoves  = norFlash.lx_nor_flash_background_reclaim_moves;
+    ulErases = norFlash.lx_nor_flash_background_reclaim_erases;
+    _lx_nor_flash_simulator_stats_get(&before);
+
+    for (ULONG i = 0; i < GCBENCH_WRITES; i++)
+    {
+        ULONG ulSector = GCBENCH_Rand() % ulLogical;
+        ULONG64 ullStart = _lx_nor_flash_simulator_time_get();
+
+        GCBENCH_Fill(ulSector, ++aulVersion[ulSector]);
+        if (_lx_nor_flash_sector_write(&norFlash, ulSector, aulSector) != LX_SUCCESS)
+        {
+            return -1;
+        }
+
+        aullLatency[i] = _lx_nor_flash_simulator_time_get() - ullStart;
+
+        if (((i + 1U) % GCBENCH_BURST) != 0U)
+        {
+            continue;
+        }
+
+        /* Time the choice a reclaim would make now, then the host goes idle */
+        if ((GCBENCH_Find(&ullFindDevice, &ullFindHost) != 0) ||
+            ((pEntry->ulBudget != 0U) && (GCBENCH_Idle(pEntry->ulBudget, &ullMaxCall) != 0)))
+        {
+            return -1;
+        }
+    }
+
+    _lx_nor_flash_simulator_stats_get(&after);
+    ulMoves  = norFlash.lx_nor_flash_background_reclaim_moves - ulMoves;
+    ulErases = norFlash.lx_nor_flash_background_reclaim_erases - ulErases;
+
+    if ((norFlash.lx_nor_flash_free_physical_sectors + norFlash.lx_nor_flash_mapped_physical_sectors +
+         norFlash.lx_nor_flash_obsolete_physical_sectors) != norFlash.lx_nor_flash_total_physical_sectors)
+    {
+        fprintf(stderr, "gc_bench: %s: instance counts do not add up\n", pEntry->pszName);
+        return -1;
+    }
+
+    if (GCBENCH_StatsCheck() != 0)
+    {
+        fprintf(stderr, "gc_bench: %s: block statistics do not match the flash\n", pEntry->pszName);
+        return -1;
+    }
+
+    /* Every sector must read back its last version */
+    for (ULONG i = 0; i < ulLogical; i++)
+    {
+        GCBENCH_Fill(i, aulVersion[i]);
+        if ((_lx_nor_flash_sector_read(&norFlash, i, aulCheck) != LX_SUCCESS) ||
+            (memcmp(aulSector, aulCheck, sizeof(aulSector)) != 0))
+        {
+            fprintf(stderr, "gc_bench: %s: sector %lu mismatch\n", pEntry->pszName, (unsigned long)i);
+            return -1;
+        }
+    }
+
+    (void)_lx_nor_flash_close(&norFlash);
+
+    if ((after.lx_nor_flash_simulator_system_errors != 0U) || (after.lx_nor_flash_simulator_program_violations != 0U))
+    {
+        return -1;
+    }
+
+    for (ULONG i = 0; i < GCBENCH_WRITES; i++)
+    {
+        ULONG ulBucket = 0;
+
+        for (ULONG64 ullMs = aullLatency[i] / 1000000U; (ullMs != 0U) && (ulBucket < (GCBENCH_BUCKETS - 1U)); ullMs >>= 1)
+        {
+            ulBucket++;
+        }
+        aulHistogram[ulBucket]++;
+    }
+
+    qsort(aullLatency, GCBENCH_WRITES, sizeof(aullLatency[0]), GCBENCH_Compare);
+    ullErases = (after.lx_nor_flash_simulator_sector_erases + after.lx_nor_flash_simulator_subsector_erases) -
+                (before.lx_nor_flash_simulator_sector_erases + before.lx_nor_flash_simulator_subsector_erases);
+
+    printf("%-11s %8.3f %7llu %8lu %8lu %9.3f %9.3f %9.3f %9.3f %10.3f %8.1f %8.0f\n",
+           pEntry->pszName,
+           (double)(after.lx_nor_flash_simulator_bytes_programmed - before.lx_nor_flash_simulator_bytes_programmed) /
+           ((double)GCBENCH_WRITES * LX_NOR_SECTOR_SIZE * sizeof(ULONG)),
+           (unsigned long long)ullErases, (unsigned long)ulErases, (unsigned long)ulMoves,
+           (double)aullLatency[GCBENCH_WRITES / 2U] / 1e6,
+           (double)aullLatency[(GCBENCH_WRITES * 99U) / 100U] / 1e6,
+           (double)aullLatency[(GCBENCH_WRITES * 999U) / 1000U] / 1e6,
+           (double)aullLatency[GCBENCH_WRITES - 1U] / 1e6,
+           (double)ullMaxCall / 1e6,
+           (double)ullFindDevice / (1e3 * GCBENCH_BURSTS),
+           (double)ullFindHost / GCBENCH_BURSTS);
+
+    return 0;
+}
+
+/**
+ * @brief Background reclaim calls until the idle time is over or nothing is left to do
+ */
+static int32_t GCBENCH_Idle(ULONG ulBudget, ULONG64 *pullMaxCall)
+{
+    ULONG64 ullIdle = _lx_nor_flash_simulator_time_get();
+
+    while ((_lx_nor_flash_simulator_time_get() - ullIdle) < ((ULONG64)GCBENCH_IDLE_MS * 1000000U))
+    {
+        ULONG64 ullStart = _lx_nor_flash_simulator_time_get();
+        ULONG ulUsed;
+
+        if (_lx_nor_flash_background_reclaim(&norFlash, ulBudget, &ulUsed) != LX_SUCCESS)
+        {
+            return -1;
+        }
+
+        ullStart = _lx_nor_flash_simulator_time_get() - ullStart;
+        if (ullStart > *pullMaxCall)
+        {
+            *pullMaxCall = ullStart;
+        }
+
+        if (ulUsed == 0U)
+        {
+            break;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief One victim choice, adds its device time (flash reads) and host time
+ */
+static int32_t GCBENCH_Find(ULONG64 *pullDevice, uint64_t *pullHost)
+{
+    ULONG ulBlock;
+    ULONG ulEraseCount;
+    ULONG ulMapped;
+    ULONG ulObsolete;
+    ULONG64 ullStart = _lx_nor_flash_simulator_time_get();
+    uint64_t ullHost = GCBENCH_HostNs();
+
+    if (_lx_nor_flash_next_block_to_erase_find(&norFlash, &ulBlock, &ulEraseCount, &ulMapped, &ulObsolete) != LX_SUCCESS)
+    {
+        return -1;
+    }
+
+    *pullHost += GCBENCH_HostNs() - ullHost;
+    *pullDevice += _lx_nor_flash_simulator_time_get() - ullStart;
+
+    return 0;
+}
+
+/**
+ * @brief Every block statistics entry must match the header, bit map and mapping list of its block,
+ *        and the free sectors must be the last ones of the block
+ */
+static int32_t GCBENCH_StatsCheck(void)
+{
+#ifdef LX_NOR_ENABLE_BLOCK_STATS
+    ULONG ulSectors = norFlash.lx_nor_flash_physical_sectors_per_block;
+
+    if (norFlash.lx_nor_flash_block_stats == LX_NULL)
+    {
+        return 0;
+    }
+
+    for (ULONG i = 0; i < norFlash.lx_nor_flash_total_blocks; i++)
+    {
+        const LX_NOR_FLASH_BLOCK_STATS *pStats = &norFlash.lx_nor_flash_block_stats[i];
+        const ULONG *pulBlock = norFlash.lx_nor_flash_base_address + (i * norFlash.lx_nor_flash_words_per_block);
+        ULONG ulFree = 0;
+        ULONG ulObsolete = 0;
+        ULONG ulFirstFree = ulSectors - pStats->lx_nor_flash_block_stats_free_sectors;
+
+        for (ULONG j = 0; j < ulSectors; j++)
+        {
+            ULONG ulEntry = pulBlock[norFlash.lx_nor_flash_block_physical_sector_mapping_offset + j];
+            ULONG ulBit = (pulBlock[norFlash.lx_nor_flash_block_free_bit_map_offset + (j / 32U)] >> (j % 32U)) & 1U;
+
+            if (ulBit != ((j >= ulFirstFree) ? 1U : 0U))
+            {
+                return -1;
+            }
+            ulFree += ulBit;
+            ulObsolete += ((ulEntry != LX_NOR_PHYSICAL_SECTOR_FREE) && ((ulEntry & LX_NOR_PHYSICAL_SECTOR_VALID) == 0U)) ? 1U : 0U;
+        }
+
+        if ((pStats->lx_nor_flash_block_stats_erase_count != pulBlock[0]) ||
+            (pStats->lx_nor_flash_block_stats_free_sectors != ulFree) ||
+            (pStats->lx_nor_flash_block_stats_obsolete_sectors != ulObsolete) ||
+            (pStats->lx_nor_flash_block_stats_mapped_sectors != (ulSectors - ulFree - ulObsolete)))
+        {
+            return -1;
+        }
+    }
+#endif
+
+    return 0;
+}
+
+/**
+ * @brief Simulator driver without the block statistics table: the next block to erase is found by scanning
+ */
+static UINT GCBENCH_ScanInitialize(LX_NOR_FLASH *nor_flash)
+{
+    UINT status = _lx_nor_flash_simulator_initialize(nor_flash);
+
+#ifdef LX_NOR_ENABLE_BLOCK_STATS
+    nor_flash->lx_nor_flash_block_stats = LX_NULL;
+#endif
+
+    return status;
+}
+
+/**
+ * @brief Monotonic host time in nanoseconds
+ */
+static uint64_t GCBENCH_HostNs(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Sector contents depend on the logical sector and its version
+ */
+static void GCBENCH_Fill(ULONG ulSector, ULONG ulVersion)
+{
+    for (ULONG i = 0; i < LX_NOR_SECTOR_SIZE; i++)
+    {
+        aulSector[i] = (ulSector << 16) ^ (ulVersion << 8) ^ i;
+    }
+}
+
+static int GCBENCH_Compare(const void *pA, const void *pB)
+{
+    ULONG64 ullA = *(const ULONG64 *)pA;
+    ULONG64 ullB = *(const ULONG64 *)pB;
+
+    return (ullA > ullB) - (ullA < ullB);
+}
+
+/**
+ * @brief Deterministic pseudo random generator (xorshift32), same sequence on every run
+ */
+static uint32_t GCBENCH_Rand(void)
+{
+    ulRandState ^= ulRandState << 13;
+    ulRandState ^= ulRandState >> 17;
+    ulRandState ^= ulRandState << 5;
+
+    return ulRandState;
+}
+
+#endif /* LX_NOR_ENABLE_BACKGROUND_RECLAIM */
+
+/************************************
+ * GLOBAL FUNCTIONS
+ ************************************/
+
+/**
+ * @brief Run the burst workload with inline and background reclaim
+ *
+ * @return 0 on success, -1 if LevelX failed or read back data differs
+ */
+int32_t GCBENCH_Run(void)
+{
+#ifdef LX_NOR_ENABLE_BACKGROUND_RECLAIM
+    ULONG ulBlockSize;
+    ULONG ulTotalBlocks;
+    int32_t ret = 0;
+
+    _lx_nor_flash_simulator_geometry_get(&ulBlockSize, &ulTotalBlocks);
+    if (_lx_nor_flash_simulator_geometry_set(GCBENCH_BLOCK_SIZE, GCBENCH_AREA_SIZE / GCBENCH_BLOCK_SIZE) != LX_SUCCESS)
+    {
+        return -1;
+    }
+    _lx_nor_flash_initialize();
+
+    printf("# area %u KB of %u KB blocks, fill %u%%, %u bursts of %u overwrites, %u ms idle after each, "
+           "charged move %u us, erase %u us\n",
+           (unsigned)(GCBENCH_AREA_SIZE / 1024U), (unsigned)(GCBENCH_BLOCK_SIZE / 1024U), (unsigned)GCBENCH_FILL_PCT,
+           (unsigned)GCBENCH_BURSTS, (unsigned)GCBENCH_BURST, (unsigned)GCBENCH_IDLE_MS,
+           (unsigned)LX_NOR_BACKGROUND_RECLAIM_MOVE_TIME, (unsigned)LX_NOR_BACKGROUND_RECLAIM_ERASE_TIME);
+    printf("%-11s %8s %7s %8s %8s %9s %9s %9s %9s %10s %8s %8s\n",
+           "reclaim", "wamp", "erases", "bg_erase", "bg_moves", "p50_ms", "p99_ms", "p999_ms", "max_ms", "bg_call_ms",
+           "find_us", "find_ns");
+
+    for (uint32_t i = 0; i < GCBENCH_SCENARIOS; i++)
+    {
+        if (GCBENCH_Scenario(&gaScenarios[i], aulHistograms[i]) != 0)
+        {
+            fprintf(stderr, "gc_bench: %s failed\n", gaScenarios[i].pszName);
+            ret = -1;
+            break;
+        }
+    }
+
+    if (ret == 0)
+    {
+        printf("\n%-12s", "latency_ms");
+        for (uint32_t i = 0; i < GCBENCH_SCENARIOS; i++)
+        {
+            printf(" %11s", gaScenarios[i].pszName);
+        }
+        printf("\n");
+
+        for (uint32_t j = 0; j < GCBENCH_BUCKETS; j++)
+        {
+            char szRange[16];
+
+            if (j == 0U)
+            {
+                (void)snprintf(szRange, sizeof(szRange), "< 1");
+            }
+            else if (j == (GCBENCH_BUCKETS - 1U))
+            {
+                (void)snprintf(szRange, sizeof(szRange), ">= %u", 1U << (j - 1U));
+            }
+            else
+            {
+                (void)snprintf(szRange, sizeof(szRange), "%u - %u", 1U << (j - 1U), 1U << j);
+            }
+
+            printf("%-12s", szRange);
+            for (uint32_t i = 0; i < GCBENCH_SCENARIOS; i++)
+            {
+                printf(" %11lu", (unsigned long)aulHistograms[i][j]);
+            }
+            printf("\n");
+        }
+    }
+
+    /* Leave the simulator as found */
+    (void)_lx_nor_flash_simulator_geometry_set(ulBlockSize, ulTotalBlocks);
+
+    return ret;
+#else
+    printf("# LX_NOR_ENABLE_BACKGROUND_RECLAIM is not defined\n");
+
+    return 0;
+#endif
+}
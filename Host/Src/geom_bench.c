@@ -0,0 +1,248 @@
+/**
+ ********************************************************************************
+ * @file    geom_bench.c
+ * @author  SimON
+ * @date    17 окт. 2026 г.
+ * @brief   LevelX block geometry comparison: 64 KB sectors vs. 4 KB subsectors
+ *
+ *          Both geometries of nor_driver.h (default and DRIVER_SUBSECTOR_GEOMETRY)
+ *          are run on the same GEOMBENCH_AREA_SIZE part of the simulated array.
+ *          LevelX is driven directly: the logical space is filled to
+ *          GEOMBENCH_FILL_PCT percent of the physical sectors, then random
+ *          single sector overwrites are timed one by one, so the reclaim
+ *          work (relocation + erase) shows up as the latency tail. At the end
+ *          every logical sector is read back and checked.
+ *
+ *          Reported per geometry:
+ *          - metadata overhead : share of the area not available for sectors;
+ *          - write amplification: bytes programmed / bytes written by the user;
+ *          - erases, flash read commands and device time per overwrite
+ *            (mean, p99, max).
+ ********************************************************************************
+ */
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "geom_bench.h"
+#include "lx_api.h"
+#include "lx_nor_flash_simulator.h"
+
+/************************************
+ * PRIVATE MACROS AND DEFINES
+ ************************************/
+#define GEOMBENCH_AREA_SIZE         (1024U * 1024U)
+#define GEOMBENCH_FILL_PCT          75U
+#define GEOMBENCH_OVERWRITE_ROUNDS  4U
+#define GEOMBENCH_MAX_SECTORS       (GEOMBENCH_AREA_SIZE / (LX_NOR_SECTOR_SIZE * sizeof(ULONG)))
+#define GEOMBENCH_MAX_WRITES        (GEOMBENCH_MAX_SECTORS * GEOMBENCH_OVERWRITE_ROUNDS)
+
+/************************************
+ * PRIVATE TYPEDEFS
+ ************************************/
+typedef struct
+{
+    const char         *pszName;
+    ULONG               ulBlockSize;
+} geombench_entry;
+
+/************************************
+ * STATIC FUNCTION PROTOTYPES
+ ************************************/
+static int32_t GEOMBENCH_Geometry(const geombench_entry *pEntry);
+static void GEOMBENCH_Fill(ULONG ulSector, ULONG ulVersion);
+static int GEOMBENCH_Compare(const void *pA, const void *pB);
+static uint32_t GEOMBENCH_Rand(void);
+
+/************************************
+ * STATIC VARIABLES
+ ************************************/
+static const geombench_entry gaGeometries[] =
+{
+    { "sector_64k",     65536U },
+    { "subsector_4k",   4096U  },
+};
+
+static LX_NOR_FLASH norFlash;
+static ULONG aulSector[LX_NOR_SECTOR_SIZE];
+static ULONG aulCheck[LX_NOR_SECTOR_SIZE];
+static ULONG aulVersion[GEOMBENCH_MAX_SECTORS];
+static ULONG64 aullLatency[GEOMBENCH_MAX_WRITES];
+static uint32_t ulRandState = 1U;
+
+/************************************
+ * STATIC FUNCTIONS
+ ************************************/
+
+/**
+ * @brief Fill, overwrite and verify the area with one block geometry
+ */
+static int32_t GEOMBENCH_Geometry(const geombench_entry *pEntry)
+{
+    LX_NOR_FLASH_SIMULATOR_STATS before;
+    LX_NOR_FLASH_SIMULATOR_STATS after;
+    ULONG ulLogical;
+    ULONG ulWrites;
+    ULONG64 ullSum = 0;
+    uint64_t ullErases;
+    double dOverhead;
+
+    if (_lx_nor_flash_simulator_geometry_set(pEntry->ulBlockSize, GEOMBENCH_AREA_SIZE / pEntry->ulBlockSize) != LX_SUCCESS)
+    {
+        return -1;
+    }
+
+    (void)_lx_nor_flash_simulator_erase_all();
+    if (_lx_nor_flash_open(&norFlash, (CHAR *)pEntry->pszName, _lx_nor_flash_simulator_initialize) != LX_SUCCESS)
+    {
+        return -1;
+    }
+
+    ulLogical = (norFlash.lx_nor_flash_total_physical_sectors * GEOMBENCH_FILL_PCT) / 100U;
+    ulWrites  = ulLogical * GEOMBENCH_OVERWRITE_ROUNDS;
+    dOverhead = 100.0 * (1.0 - (double)(norFlash.lx_nor_flash_total_physical_sectors * LX_NOR_SECTOR_SIZE * sizeof(ULONG)) /
+                               (double)GEOMBENCH_AREA_SIZE);
+
+    /* Initial fill is not measured */
+    for (ULONG i = 0; i < ulLogical; i++)
+    {
+        aulVersion[i] = 0;
+        GEOMBENCH_Fill(i, 0);
+        if (_lx_nor_flash_sector_write(&norFlash, i, aulSector) != LX_SUCCESS)
+        {
+            return -1;
+        }
+    }
+
+    ulRandState = 1U;
+    _lx_nor_flash_simulator_stats_get(&before);
+
+    for (ULONG i = 0; i < ulWrites; i++)
+    {
+        ULONG ulSector = GEOMBENCH_Rand() % ulLogical;
+        ULONG64 ullStart = _lx_nor_flash_simulator_time_get();
+
+        GEOMBENCH_Fill(ulSector, ++aulVersion[ulSector]);
+        if (_lx_nor_flash_sector_write(&norFlash, ulSector, aulSector) != LX_SUCCESS)
+        {
+            return -1;
+        }
+
+        aullLatency[i] = _lx_nor_flash_simulator_time_get() - ullStart;
+        ullSum += aullLatency[i];
+    }
+
+    _lx_nor_flash_simulator_stats_get(&after);
+
+    /* Every sector must read back its last version */
+    for (ULONG i = 0; i < ulLogical; i++)
+    {
+        GEOMBENCH_Fill(i, aulVersion[i]);
+        if ((_lx_nor_flash_sector_read(&norFlash, i, aulCheck) != LX_SUCCESS) ||
+            (memcmp(aulSector, aulCheck, sizeof(aulSector)) != 0))
+        {
+            fprintf(stderr, "geom_bench: %s: sector %lu mismatch\n", pEntry->pszName, (unsigned long)i);
+            return -1;
+        }
+    }
+
+    (void)_lx_nor_flash_close(&norFlash);
+
+    if ((after.lx_nor_flash_simulator_system_errors != 0U) || (after.lx_nor_flash_simulator_program_violations != 0U))
+    {
+        return -1;
+    }
+
+    qsort(aullLatency, ulWrites, sizeof(aullLatency[0]), GEOMBENCH_Compare);
+    ullErases = (after.lx_nor_flash_simulator_sector_erases + after.lx_nor_flash_simulator_subsector_erases) -
+                (before.lx_nor_flash_simulator_sector_erases + before.lx_nor_flash_simulator_subsector_erases);
+
+    printf("%-14s %6lu %7lu %8.2f%% %8.3f %8llu %8.1f %10.3f %10.3f %10.3f %10.3f\n",
+           pEntry->pszName,
+           (unsigned long)(norFlash.lx_nor_flash_words_per_block * sizeof(ULONG)),
+           (unsigned long)norFlash.lx_nor_flash_total_physical_sectors, dOverhead,
+           (double)(after.lx_nor_flash_simulator_bytes_programmed - before.lx_nor_flash_simulator_bytes_programmed) /
+           ((double)ulWrites * LX_NOR_SECTOR_SIZE * sizeof(ULONG)),
+           (unsigned long long)ullErases,
+           (double)(after.lx_nor_flash_simulator_read_commands - before.lx_nor_flash_simulator_read_commands) / (double)ulWrites,
+           (double)ullSum / (double)ulWrites / 1e6,
+           (double)aullLatency[(ulWrites * 99U) / 100U] / 1e6,
+           (double)aullLatency[ulWrites - 1U] / 1e6,
+           (double)ullSum / 1e9);
+
+    return 0;
+}
+
+/**
+ * @brief Sector contents depend on the logical sector and its version
+ */
+static void GEOMBENCH_Fill(ULONG ulSector, ULONG ulVersion)
+{
+    for (ULONG i = 0; i < LX_NOR_SECTOR_SIZE; i++)
+    {
+        aulSector[i] = (ulSector << 16) ^ (ulVersion << 8) ^ i;
+    }
+}
+
+static int GEOMBENCH_Compare(const void *pA, const void *pB)
+{
+    ULONG64 ullA = *(const ULONG64 *)pA;
+    ULONG64 ullB = *(const ULONG64 *)pB;
+
+    return (ullA > ullB) - (ullA < ullB);
+}
+
+/**
+ * @brief Deterministic pseudo random generator (xorshift32), same sequence on every run
+ */
+static uint32_t GEOMBENCH_Rand(void)
+{
+    ulRandState ^= ulRandState << 13;
+    ulRandState ^= ulRandState >> 17;
+    ulRandState ^= ulRandState << 5;
+
+    return ulRandState;
+}
+
+/************************************
+ * GLOBAL FUNCTIONS
+ ************************************/
+
+/**
+ * @brief Run the overwrite workload on both geometries
+ *
+ * @return 0 on success, -1 if LevelX failed or read back data differs
+ */
+int32_t GEOMBENCH_Run(void)
+{
+    ULONG ulBlockSize;
+    ULONG ulTotalBlocks;
+    int32_t ret = 0;
+
+    _lx_nor_flash_simulator_geometry_get(&ulBlockSize, &ulTotalBlocks);
+    _lx_nor_flash_initialize();
+
+    printf("# area %u KB, fill %u%%, %u overwrite rounds, latency = device time per 512 B overwrite\n",
+           (unsigned)(GEOMBENCH_AREA_SIZE / 1024U), (unsigned)GEOMBENCH_FILL_PCT, (unsigned)GEOMBENCH_OVERWRITE_ROUNDS);
+    printf("%-14s %6s %7s %9s %8s %8s %8s %10s %10s %10s %10s\n",
+           "geometry", "block", "sectors", "overhead", "wamp", "erases", "reads", "mean_ms", "p99_ms", "max_ms", "total_s");
+
+    for (uint32_t i = 0; i < (sizeof(gaGeometries) / sizeof(gaGeometries[0])); i++)
+    {
+        if (GEOMBENCH_Geometry(&gaGeometries[i]) != 0)
+        {
+            fprintf(stderr, "geom_bench: %s failed\n", gaGeometries[i].pszName);
+            ret = -1;
+            break;
+        }
+    }
+
+    /* Leave the simulator as found */
+    (void)_lx_nor_flash_simulator_geometry_set(ulBlockSize, ulTotalBlocks);
+
+    return ret;
+}
@@ -0,0 +1,516 @@
+/**
+ ********************************************************************************
+ * @file    heap_bench.c
+ * @author  SimON
+ * @date    17 окт. 2026 г.
+ * @brief   Reliance Edge heap: TLSF allocator vs. linear best fit on random traces
+ *
+ *          Replays randomized alloc/free/realloc traces against two allocators
+ *          sharing the same pool size:
+ *          - tlsf   : Middlewares/RelianceEdge/util/heap.c (RedHeapAlloc & co.);
+ *          - bestfit: a linear best fit over all blocks, the algorithm heap.c
+ *                     used before, kept here as the baseline.
+ *
+ *          Each trace keeps a table of live allocations; every step picks a
+ *          random slot and allocates into it when empty, otherwise frees or
+ *          resizes it. Every call is timed on its own (average and worst
+ *          case), failed allocations are counted, and the free space left at
+ *          the end is reported as free bytes, largest allocatable block and
+ *          fragmentation = 1 - largest / free.
+ *
+ *          Payloads are filled with a per-slot pattern that is verified before
+ *          every free/realloc, and RedHeapCheck() runs periodically, so the
+ *          benchmark doubles as a randomized test of the allocator.
+ *
+ *          The heap is only compiled with REDCONF_HEAP_ALLOCATOR, which also
+ *          maps malloc/free to it and cannot be set for a whole host build, so
+ *          heap.c is built into this translation unit instead.
+ ********************************************************************************
+ */
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define REDCONF_HEAP_ALLOCATOR
+#include <redfs.h>
+#include <redutils.h>
+#include "../../Middlewares/RelianceEdge/util/heap.c"
+
+#include "heap_bench.h"
+
+/************************************
+ * PRIVATE MACROS AND DEFINES
+ ************************************/
+#define HEAPBENCH_POOL_SIZE         (256U * 1024U)
+#define HEAPBENCH_MAX_SLOTS         1024U
+#define HEAPBENCH_OPS               1000000U
+#define HEAPBENCH_CHECK_INTERVAL    4096U
+
+#define HEAPBENCH_REF_HDR_SIZE      ((uint32_t)sizeof(heapbench_ref_hdr))
+
+/************************************
+ * PRIVATE TYPEDEFS
+ ************************************/
+typedef enum
+{
+    HEAPBENCH_TLSF = 0,
+    HEAPBENCH_BESTFIT,
+    HEAPBENCH_ALLOCATORS
+} heapbench_alloc;
+
+typedef struct
+{
+    const char *pszName;
+    uint32_t    ulSlots;        /* Live allocation table size */
+    uint32_t    ulSmallMin;     /* Small request range */
+    uint32_t    ulSmallMax;
+    uint32_t    ulLargeMin;     /* Large request range */
+    uint32_t    ulLargeMax;
+    uint32_t    ulLargePct;     /* Share of large requests, percent */
+    uint32_t    ulReallocPct;   /* Share of steps on a live slot that resize it, percent */
+} heapbench_trace;
+
+typedef struct
+{
+    uint8_t    *pbMem;
+    uint32_t    ulSize;
+    uint8_t     bTag;
+} heapbench_slot;
+
+typedef struct
+{
+    uint64_t    ullNs;
+    uint64_t    ullMaxNs;
+    uint32_t    ulOps;
+    uint32_t    ulFails;
+    uint32_t    ulFreeBytes;
+    uint32_t    ulLargest;
+} heapbench_result;
+
+/*  Baseline block header: sizes include the header */
+typedef struct
+{
+    uint32_t    ulSize;
+    uint32_t    ulPrevSize;
+    uint32_t    ulFree;
+    uint32_t    ulPad;
+} heapbench_ref_hdr;
+
+/************************************
+ * STATIC FUNCTION PROTOTYPES
+ ************************************/
+static void HEAPBENCH_RefInit(void);
+static void *HEAPBENCH_RefAlloc(uint32_t ulSize);
+static void HEAPBENCH_RefFree(void *pMem);
+static void *HEAPBENCH_RefRealloc(void *pMem, uint32_t ulSize);
+static void HEAPBENCH_RefFreeSpace(uint32_t *pulFreeBytes, uint32_t *pulLargest);
+static uint32_t HEAPBENCH_Size(const heapbench_trace *pTrace);
+static int32_t HEAPBENCH_Verify(const heapbench_slot *pSlot, uint32_t ulSize);
+static int32_t HEAPBENCH_Replay(const heapbench_trace *pTrace, heapbench_alloc alloc, heapbench_result *pResult);
+static uint64_t HEAPBENCH_HostNs(void);
+static uint32_t HEAPBENCH_Rand(void);
+
+/************************************
+ * STATIC VARIABLES
+ ************************************/
+static const heapbench_trace gaTraces[] =
+{
+    /* name      slots  small      large         large% realloc% */
+    { "small",    256U,  8U,  96U,    0U,     0U,  0U,  0U },
+    { "mixed",    512U, 16U, 128U,  512U,  6144U, 15U,  0U },
+    { "realloc",  256U, 16U, 256U,  256U,  4096U, 25U, 50U },
+    { "churn",   1024U,  8U, 256U, 1024U, 16384U, 10U, 10U },
+};
+
+static uint64_t aullPool[HEAPBENCH_POOL_SIZE / sizeof(uint64_t)];
+static heapbench_slot aSlots[HEAPBENCH_MAX_SLOTS];
+static uint32_t ulRandState = 1U;
+
+/************************************
+ * STATIC FUNCTIONS
+ ************************************/
+
+/**
+ * @brief Baseline: one free block spanning the pool, then an allocated end marker
+ */
+static void HEAPBENCH_RefInit(void)
+{
+    uint8_t *pbPool = (uint8_t *)aullPool;
+    heapbench_ref_hdr *pFirst = (heapbench_ref_hdr *)pbPool;
+    heapbench_ref_hdr *pLast = (heapbench_ref_hdr *)&pbPool[HEAPBENCH_POOL_SIZE - HEAPBENCH_REF_HDR_SIZE];
+
+    pFirst->ulSize = HEAPBENCH_POOL_SIZE - HEAPBENCH_REF_HDR_SIZE;
+    pFirst->ulPrevSize = 0U;
+    pFirst->ulFree = 1U;
+
+    pLast->ulSize = HEAPBENCH_REF_HDR_SIZE;
+    pLast->ulPrevSize = pFirst->ulSize;
+    pLast->ulFree = 0U;
+}
+
+/**
+ * @brief Baseline: walk every block for the smallest that fits, split it
+ */
+static void *HEAPBENCH_RefAlloc(uint32_t ulSize)
+{
+    uint8_t *pbPool = (uint8_t *)aullPool;
+    uint32_t ulNeed = ((ulSize + 15U) & ~15U) + HEAPBENCH_REF_HDR_SIZE;
+    heapbench_ref_hdr *pBest = NULL;
+    uint32_t ulOffset = 0U;
+
+    while (ulOffset < (HEAPBENCH_POOL_SIZE - HEAPBENCH_REF_HDR_SIZE))
+    {
+        heapbench_ref_hdr *pHdr = (heapbench_ref_hdr *)&pbPool[ulOffset];
+
+        if ((pHdr->ulFree != 0U) && (pHdr->ulSize >= ulNeed) && ((pBest == NULL) || (pHdr->ulSize < pBest->ulSize)))
+        {
+            pBest = pHdr;
+            if (pHdr->ulSize == ulNeed)
+            {
+                break;
+            }
+        }
+        ulOffset += pHdr->ulSize;
+    }
+
+    if (pBest == NULL)
+    {
+        return NULL;
+    }
+
+    if (pBest->ulSize >= (ulNeed + (2U * HEAPBENCH_REF_HDR_SIZE)))
+    {
+        heapbench_ref_hdr *pTail = (heapbench_ref_hdr *)((uint8_t *)pBest + ulNeed);
+        heapbench_ref_hdr *pNext = (heapbench_ref_hdr *)((uint8_t *)pBest + pBest->ulSize);
+
+        pTail->ulSize = pBest->ulSize - ulNeed;
+        pTail->ulPrevSize = ulNeed;
+        pTail->ulFree = 1U;
+        pNext->ulPrevSize = pTail->ulSize;
+        pBest->ulSize = ulNeed;
+    }
+    pBest->ulFree = 0U;
+
+    return (uint8_t *)pBest + HEAPBENCH_REF_HDR_SIZE;
+}
+
+/**
+ * @brief Baseline: mark free and merge with free neighbors
+ */
+static void HEAPBENCH_RefFree(void *pMem)
+{
+    heapbench_ref_hdr *pHdr = (heapbench_ref_hdr *)((uint8_t *)pMem - HEAPBENCH_REF_HDR_SIZE);
+    heapbench_ref_hdr *pNext = (heapbench_ref_hdr *)((uint8_t *)pHdr + pHdr->ulSize);
+
+    pHdr->ulFree = 1U;
+    if (pNext->ulFree != 0U)
+    {
+        pHdr->ulSize += pNext->ulSize;
+    }
+    if ((pHdr->ulPrevSize != 0U) && (((heapbench_ref_hdr *)((uint8_t *)pHdr - pHdr->ulPrevSize))->ulFree != 0U))
+    {
+        heapbench_ref_hdr *pPrev = (heapbench_ref_hdr *)((uint8_t *)pHdr - pHdr->ulPrevSize);
+
+        pPrev->ulSize += pHdr->ulSize;
+        pHdr = pPrev;
+    }
+    ((heapbench_ref_hdr *)((uint8_t *)pHdr + pHdr->ulSize))->ulPrevSize = pHdr->ulSize;
+}
+
+/**
+ * @brief Baseline: keep the block when it is large enough, otherwise move
+ */
+static void *HEAPBENCH_RefRealloc(void *pMem, uint32_t ulSize)
+{
+    heapbench_ref_hdr *pHdr = (heapbench_ref_hdr *)((uint8_t *)pMem - HEAPBENCH_REF_HDR_SIZE);
+    uint32_t ulHave = pHdr->ulSize - HEAPBENCH_REF_HDR_SIZE;
+    void *pNew;
+
+    if (ulSize <= ulHave)
+    {
+        return pMem;
+    }
+
+    pNew = HEAPBENCH_RefAlloc(ulSize);
+    if (pNew != NULL)
+    {
+        memcpy(pNew, pMem, ulHave);
+        HEAPBENCH_RefFree(pMem);
+    }
+
+    return pNew;
+}
+
+/**
+ * @brief Baseline: free bytes and largest allocatable block
+ */
+static void HEAPBENCH_RefFreeSpace(uint32_t *pulFreeBytes, uint32_t *pulLargest)
+{
+    uint8_t *pbPool = (uint8_t *)aullPool;
+    uint32_t ulOffset = 0U;
+
+    *pulFreeBytes = 0U;
+    *pulLargest = 0U;
+    while (ulOffset < (HEAPBENCH_POOL_SIZE - HEAPBENCH_REF_HDR_SIZE))
+    {
+        heapbench_ref_hdr *pHdr = (heapbench_ref_hdr *)&pbPool[ulOffset];
+
+        if (pHdr->ulFree != 0U)
+        {
+            *pulFreeBytes += pHdr->ulSize;
+            if ((pHdr->ulSize - HEAPBENCH_REF_HDR_SIZE) > *pulLargest)
+            {
+                *pulLargest = pHdr->ulSize - HEAPBENCH_REF_HDR_SIZE;
+            }
+        }
+        ulOffset += pHdr->ulSize;
+    }
+}
+
+/**
+ * @brief Draw a request size from the trace distribution
+ */
+static uint32_t HEAPBENCH_Size(const heapbench_trace *pTrace)
+{
+    if ((HEAPBENCH_Rand() % 100U) < pTrace->ulLargePct)
+    {
+        return pTrace->ulLargeMin + (HEAPBENCH_Rand() % (pTrace->ulLargeMax - pTrace->ulLargeMin + 1U));
+    }
+
+    return pTrace->ulSmallMin + (HEAPBENCH_Rand() % (pTrace->ulSmallMax - pTrace->ulSmallMin + 1U));
+}
+
+/**
+ * @brief Check the first ulSize payload bytes of a slot against its pattern
+ *
+ * @return 0 on success, -1 on mismatch
+ */
+static int32_t HEAPBENCH_Verify(const heapbench_slot *pSlot, uint32_t ulSize)
+{
+    for (uint32_t i = 0; i < ulSize; i++)
+    {
+        if (pSlot->pbMem[i] != (uint8_t)(pSlot->bTag + i))
+        {
+            fprintf(stderr, "heap_bench: payload %p corrupted at byte %lu\n", (void *)pSlot->pbMem, (unsigned long)i);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Replay one trace against one allocator
+ *
+ * @return 0 on success, -1 on payload or heap corruption
+ */
+static int32_t HEAPBENCH_Replay(const heapbench_trace *pTrace, heapbench_alloc alloc, heapbench_result *pResult)
+{
+    memset(aSlots, 0, sizeof(aSlots));
+    memset(pResult, 0, sizeof(*pResult));
+    ulRandState = 1U;
+
+    if (alloc == HEAPBENCH_TLSF)
+    {
+        RedHeapInit(aullPool, HEAPBENCH_POOL_SIZE);
+    }
+    else
+    {
+        HEAPBENCH_RefInit();
+    }
+
+    for (uint32_t ulOp = 0; ulOp < HEAPBENCH_OPS; ulOp++)
+    {
+        heapbench_slot *pSlot = &aSlots[HEAPBENCH_Rand() % pTrace->ulSlots];
+        uint32_t ulSize = 0U;
+        uint8_t *pbNew = NULL;
+        int fFree = 0;
+        uint64_t ullNs;
+
+        if (pSlot->pbMem == NULL)
+        {
+            ulSize = HEAPBENCH_Size(pTrace);
+        }
+        else if ((HEAPBENCH_Rand() % 100U) < pTrace->ulReallocPct)
+        {
+            ulSize = HEAPBENCH_Size(pTrace);
+            if (HEAPBENCH_Verify(pSlot, REDMIN(ulSize, pSlot->ulSize)) != 0)
+            {
+                return -1;
+            }
+        }
+        else
+        {
+            fFree = 1;
+            if (HEAPBENCH_Verify(pSlot, pSlot->ulSize) != 0)
+            {
+                return -1;
+            }
+        }
+
+        ullNs = HEAPBENCH_HostNs();
+        if (alloc == HEAPBENCH_TLSF)
+        {
+            if (fFree)
+            {
+                RedHeapFree(pSlot->pbMem);
+            }
+            else if (pSlot->pbMem != NULL)
+            {
+                pbNew = RedHeapRealloc(pSlot->pbMem, ulSize);
+            }
+            else
+            {
+                pbNew = RedHeapAlloc(ulSize);
+            }
+        }
+        else
+        {
+            if (fFree)
+            {
+                HEAPBENCH_RefFree(pSlot->pbMem);
+            }
+            else if (pSlot->pbMem != NULL)
+            {
+                pbNew = HEAPBENCH_RefRealloc(pSlot->pbMem, ulSize);
+            }
+            else
+            {
+                pbNew = HEAPBENCH_RefAlloc(ulSize);
+            }
+        }
+        ullNs = HEAPBENCH_HostNs() - ullNs;
+
+        pResult->ullNs += ullNs;
+        pResult->ulOps++;
+        if (ullNs > pResult->ullMaxNs)
+        {
+            pResult->ullMaxNs = ullNs;
+        }
+
+        if (fFree)
+        {
+            pSlot->pbMem = NULL;
+        }
+        else if (pbNew == NULL)
+        {
+            /* Out of memory: a failed realloc leaves the old block in place */
+            pResult->ulFails++;
+        }
+        else
+        {
+            uint32_t ulKeep = (pSlot->pbMem != NULL) ? REDMIN(ulSize, pSlot->ulSize) : 0U;
+
+            /* Fresh allocations get a fresh pattern, resized ones extend theirs */
+            if (pSlot->pbMem == NULL)
+            {
+                pSlot->bTag = (uint8_t)ulOp;
+            }
+            pSlot->pbMem = pbNew;
+            pSlot->ulSize = ulSize;
+            for (uint32_t i = ulKeep; i < ulSize; i++)
+            {
+                pbNew[i] = (uint8_t)(pSlot->bTag + i);
+            }
+        }
+
+        if ((alloc == HEAPBENCH_TLSF) && ((ulOp % HEAPBENCH_CHECK_INTERVAL) == 0U) && (RedHeapCheck(0U) != 0))
+        {
+            fprintf(stderr, "heap_bench: RedHeapCheck failed after %lu operations of %s\n", (unsigned long)ulOp, pTrace->pszName);
+            return -1;
+        }
+    }
+
+    if (alloc == HEAPBENCH_TLSF)
+    {
+        REDHEAPFRAG frag;
+
+        if (RedHeapCheck(0U) != 0)
+        {
+            fprintf(stderr, "heap_bench: RedHeapCheck failed at the end of %s\n", pTrace->pszName);
+            return -1;
+        }
+
+        RedHeapStats(NULL, NULL, NULL, NULL, &frag);
+        pResult->ulFreeBytes = frag.ulFreeBytes + frag.ulQuickBytes;
+        pResult->ulLargest = frag.ulLargestFree;
+    }
+    else
+    {
+        HEAPBENCH_RefFreeSpace(&pResult->ulFreeBytes, &pResult->ulLargest);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Monotonic host time in nanoseconds
+ */
+static uint64_t HEAPBENCH_HostNs(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Deterministic pseudo random generator (xorshift32), same sequence on every run
+ */
+static uint32_t HEAPBENCH_Rand(void)
+{
+    ulRandState ^= ulRandState << 13;
+    ulRandState ^= ulRandState >> 17;
+    ulRandState ^= ulRandState << 5;
+
+    return ulRandState;
+}
+
+/************************************
+ * GLOBAL FUNCTIONS
+ ************************************/
+
+/**
+ * @brief Replay every trace against both allocators
+ *
+ * @return 0 on success, -1 on payload or heap corruption
+ */
+int32_t HEAPBENCH_Run(void)
+{
+    static const char * const apszAlloc[HEAPBENCH_ALLOCATORS] = { "tlsf", "bestfit" };
+
+    printf("# pool %u KB, %u operations per trace, ns per call include clock_gettime\n",
+           (unsigned)(HEAPBENCH_POOL_SIZE >> 10), (unsigned)HEAPBENCH_OPS);
+    printf("%-8s %-8s %8s %8s %7s %8s %10s %6s\n", "trace", "alloc", "avg ns", "max ns", "fails", "free KB", "largest KB", "frag%");
+
+    for (uint32_t t = 0; t < (sizeof(gaTraces) / sizeof(gaTraces[0])); t++)
+    {
+        for (uint32_t a = 0; a < (uint32_t)HEAPBENCH_ALLOCATORS; a++)
+        {
+            heapbench_result result;
+            double dFrag = 0.0;
+
+            if (HEAPBENCH_Replay(&gaTraces[t], (heapbench_alloc)a, &result) != 0)
+            {
+                return -1;
+            }
+
+            if (result.ulFreeBytes != 0U)
+            {
+                dFrag = 100.0 * (1.0 - ((double)result.ulLargest / (double)result.ulFreeBytes));
+            }
+
+            printf("%-8s %-8s %8.1f %8lu %7lu %8.1f %10.1f %6.1f\n", gaTraces[t].pszName, apszAlloc[a],
+                   (double)result.ullNs / (double)result.ulOps, (unsigned long)result.ullMaxNs,
+                   (unsigned long)result.ulFails, (double)result.ulFreeBytes / 1024.0,
+                   (double)result.ulLargest / 1024.0, dFrag);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,191 @@
+/**
+ ********************************************************************************
+ * @file    host_main.c
+ * @author  SimON
+ * @date    17 окт. 2026 г.
+ * @brief   Host entry point of the file system benchmark suite
+ *
+ *          The Host/ tree is not part of the STM32CubeIDE project. It links the
+ *          unmodified LevelX and Reliance Edge sources against the NOR flash
+ *          simulator instead of the QSPI driver. Build from the repository root
+ *          with a native gcc, compiling every C file of:
+ *
+ *              Host/Src, Core/Src/redconf.c, Middlewares/AzureLevelX/Src/lx_nor_flash_*,
+ *              Drivers/BSP/NOR_QSPI/Src/nor_queue.c,
+ *              Middlewares/RelianceEdge/{core/driver,posix,util,bdev,fse},
+ *              Middlewares/RelianceEdge/os/bare_metal/services,
+ *              Middlewares/USBFS/Core/Src, Middlewares/USBFS/Class/MSC/Src (without
+ *              usbd_msc_storage_template.c),
+ *              Middlewares/USBFS/usb_device_app/App/usbd_storage_if.c
+ *
+ *          with -DLX_HOST_BUILD -DLX_INCLUDE_USER_DEFINE_FILE and the include
+ *          paths Host/Inc, Core/Inc, Drivers/BSP/NOR_QSPI/Inc, Drivers/BSP/CRC/Inc,
+ *          Middlewares/AzureLevelX/Inc, Middlewares/RelianceEdge/include,
+ *          Middlewares/RelianceEdge/core/{include,driver},
+ *          Middlewares/RelianceEdge/os/bare_metal/include, Middlewares/USBFS/Core/Inc,
+ *          Middlewares/USBFS/Class/MSC/Inc and Middlewares/USBFS/usb_device_app/App
+ *          (not .../Target: Host/Inc/usbd_conf.h replaces it).
+ *
+ *          Usage: fs_bench [-j] [-q] [-g] [-i] [-c] [-m] [-u] [-o] [-b] [-p] [-d] [workload filter | trace]
+ *          -j prints one JSON object per workload for regression tracking.
+ *          -q runs the sync vs. queued QSPI access comparison instead.
+ *          -g runs the 64 KB vs. 4 KB LevelX block geometry comparison instead.
+ *          -i runs the Reliance Edge imap free block/inode search microbenchmark instead.
+ *          -c runs the Reliance Edge CRC-32 backend comparison instead.
+ *          -m runs the Reliance Edge heap (TLSF vs. best fit) trace replay instead.
+ *          -u runs the USB MSC LUN workloads, or replays a SCSI command trace file, instead
+ *          (storage work in the USB callback, then overlapped from the main loop, then the
+ *          cold mount after a power cut with and without the idle and eject checkpoints).
+ *          -o runs the LevelX cold mount comparison (full scan vs. checkpoint, power loss) instead.
+ *          -b runs the LevelX write latency comparison (inline vs. background reclaim) instead.
+ *          -p runs the LevelX reclaim policy comparison (greedy, cost-benefit, hot/cold) instead.
+ *          -d runs the Reliance Edge lookup and create cost in a directory of thousands of names instead.
+ ********************************************************************************
+ */
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include <stdio.h>
+#include <string.h>
+
+#include "fs_bench.h"
+#include "norq_bench.h"
+#include "geom_bench.h"
+#include "imap_bench.h"
+#include "crc_bench.h"
+#include "heap_bench.h"
+#include "msc_bench.h"
+#include "mount_bench.h"
+#include "gc_bench.h"
+#include "policy_bench.h"
+#include "dir_bench.h"
+
+/************************************
+ * GLOBAL FUNCTIONS
+ ************************************/
+
+int main(int argc, char *argv[])
+{
+    fsbench_format format = FSBENCH_FMT_TEXT;
+    const char *pszFilter = NULL;
+    int bQueue = 0;
+    int bGeometry = 0;
+    int bImap = 0;
+    int bCrc = 0;
+    int bHeap = 0;
+    int bMsc = 0;
+    int bMount = 0;
+    int bReclaim = 0;
+    int bPolicy = 0;
+    int bDir = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-j") == 0)
+        {
+            format = FSBENCH_FMT_JSON;
+        }
+        else if (strcmp(argv[i], "-q") == 0)
+        {
+            bQueue = 1;
+        }
+        else if (strcmp(argv[i], "-g") == 0)
+        {
+            bGeometry = 1;
+        }
+        else if (strcmp(argv[i], "-i") == 0)
+        {
+            bImap = 1;
+        }
+        else if (strcmp(argv[i], "-c") == 0)
+        {
+            bCrc = 1;
+        }
+        else if (strcmp(argv[i], "-m") == 0)
+        {
+            bHeap = 1;
+        }
+        else if (strcmp(argv[i], "-u") == 0)
+        {
+            bMsc = 1;
+        }
+        else if (strcmp(argv[i], "-o") == 0)
+        {
+            bMount = 1;
+        }
+        else if (strcmp(argv[i], "-b") == 0)
+        {
+            bReclaim = 1;
+        }
+        else if (strcmp(argv[i], "-p") == 0)
+        {
+            bPolicy = 1;
+        }
+        else if (strcmp(argv[i], "-d") == 0)
+        {
+            bDir = 1;
+        }
+        else if (argv[i][0] == '-')
+        {
+            fprintf(stderr, "usage: %s [-j] [-q] [-g] [-i] [-c] [-m] [-u] [-o] [-b] [-p] [-d] [workload filter | trace]\n", argv[0]);
+            return 2;
+        }
+        else
+        {
+            pszFilter = argv[i];
+        }
+    }
+
+    if (bDir)
+    {
+        return (DIRBENCH_Run() == 0) ? 0 : 1;
+    }
+
+    if (bPolicy)
+    {
+        return (POLICYBENCH_Run() == 0) ? 0 : 1;
+    }
+
+    if (bReclaim)
+    {
+        return (GCBENCH_Run() == 0) ? 0 : 1;
+    }
+
+    if (bMount)
+    {
+        return (MOUNTBENCH_Run() == 0) ? 0 : 1;
+    }
+
+    if (bMsc)
+    {
+        return (MSCBENCH_Run(pszFilter) == 0) ? 0 : 1;
+    }
+
+    if (bHeap)
+    {
+        return (HEAPBENCH_Run() == 0) ? 0 : 1;
+    }
+
+    if (bCrc)
+    {
+        return (CRCBENCH_Run() == 0) ? 0 : 1;
+    }
+
+    if (bImap)
+    {
+        return (IMAPBENCH_Run() == 0) ? 0 : 1;
+    }
+
+    if (bGeometry)
+    {
+        return (GEOMBENCH_Run() == 0) ? 0 : 1;
+    }
+
+    if (bQueue)
+    {
+        return (NORQBENCH_Run() == 0) ? 0 : 1;
+    }
+
+    return (FSBENCH_Run(pszFilter, format) == 0) ? 0 : 1;
+}
@@ -0,0 +1,372 @@
+/**
+ ********************************************************************************
+ * @file    imap_bench.c
+ * @author  SimON
+ * @date    17 окт. 2026 г.
+ * @brief   Reliance Edge imap free block/inode search: bit-at-a-time vs. word scan
+ *
+ *          A free block is one that is clear in both the working and the
+ *          committed metaroot bitmaps. The previous RedImapIBlockFindFree loop
+ *          (byte skip + two RedBitGet calls per block) is kept here as the
+ *          reference and timed against RedBitFindClear, which the imap search
+ *          now uses, on synthetic bitmaps of IMAPBENCH_BITS blocks.
+ *
+ *          For every fill level the bitmaps are populated at random (the
+ *          committed state is a subset of the working state plus a few blocks
+ *          freed since the last transaction), then IMAPBENCH_QUERIES searches
+ *          with random start blocks are run with both implementations. Their
+ *          results must match, the wrap around to the first block is included.
+ *
+ *          The inode table part of the bitmap holds two bits (slots) per inode,
+ *          an inode is free when both are clear in the working state. The
+ *          previous InodeFindFree loop (first fit from the first inode, two
+ *          bit probes per inode) is timed against RedBitFindClearPair started
+ *          from a rotating allocation pointer, as InodeFindFree now does: the
+ *          same number of creates is run from the same populated table and
+ *          every returned inode must be free.
+ ********************************************************************************
+ */
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <redfs.h>
+#include <redutils.h>
+
+#include "imap_bench.h"
+
+/************************************
+ * PRIVATE MACROS AND DEFINES
+ ************************************/
+#define IMAPBENCH_BITS              65536U
+#define IMAPBENCH_QUERIES           20000U
+#define IMAPBENCH_NOT_FOUND         UINT32_MAX
+#define IMAPBENCH_INODES            (IMAPBENCH_BITS / 2U)
+#define IMAPBENCH_CREATES           4096U
+
+/************************************
+ * STATIC FUNCTION PROTOTYPES
+ ************************************/
+static void IMAPBENCH_Populate(uint32_t ulFillPermille);
+static uint32_t IMAPBENCH_FindBitwise(uint32_t ulStart);
+static uint32_t IMAPBENCH_FindWord(uint32_t ulStart);
+static void IMAPBENCH_InodePopulate(uint32_t ulFillPermille);
+static uint32_t IMAPBENCH_InodeFindBitwise(void);
+static uint32_t IMAPBENCH_InodeFindPair(uint32_t ulStart);
+static int32_t IMAPBENCH_InodeRun(void);
+static uint64_t IMAPBENCH_HostNs(void);
+static uint32_t IMAPBENCH_Rand(void);
+
+/************************************
+ * STATIC VARIABLES
+ ************************************/
+static const uint32_t gaulFillPermille[] = { 500U, 900U, 990U, 999U, 1000U };
+static const uint32_t gaulInodeFillPermille[] = { 0U, 500U, 900U, 990U, 999U };
+
+static uint8_t abCur[IMAPBENCH_BITS / 8U] __attribute__((aligned(4)));
+static uint8_t abCmt[IMAPBENCH_BITS / 8U] __attribute__((aligned(4)));
+static uint32_t aulStart[IMAPBENCH_QUERIES];
+static uint32_t aulResult[IMAPBENCH_QUERIES];
+static uint32_t ulRandState = 1U;
+
+/************************************
+ * STATIC FUNCTIONS
+ ************************************/
+
+/**
+ * @brief Allocate ulFillPermille / 1000 of the blocks in the working state,
+ *        the committed state lacks 1 % of them (allocated by this transaction)
+ *        and has 1 % of the free ones still allocated (freed by it)
+ */
+static void IMAPBENCH_Populate(uint32_t ulFillPermille)
+{
+    memset(abCur, 0, sizeof(abCur));
+    memset(abCmt, 0, sizeof(abCmt));
+
+    for (uint32_t i = 0; i < IMAPBENCH_BITS; i++)
+    {
+        uint32_t ulRoll = IMAPBENCH_Rand() % 1000U;
+
+        if (ulRoll < ulFillPermille)
+        {
+            RedBitSet(abCur, i);
+            if ((IMAPBENCH_Rand() % 100U) != 0U)
+            {
+                RedBitSet(abCmt, i);
+            }
+        }
+        else if ((IMAPBENCH_Rand() % 100U) == 0U)
+        {
+            RedBitSet(abCmt, i);
+        }
+    }
+}
+
+/**
+ * @brief Reference search, the loop RedImapIBlockFindFree used before.
+ *        The byte skip must not step over the start bit, otherwise a full
+ *        bitmap is searched forever when the start is not byte aligned.
+ */
+static uint32_t IMAPBENCH_FindBitwise(uint32_t ulStart)
+{
+    uint32_t ulBit = ulStart;
+
+    do
+    {
+        if (((ulBit & 7U) == 0U) && ((ulBit >> 3U) != (ulStart >> 3U)) && (abCur[ulBit >> 3U] == UINT8_MAX))
+        {
+            ulBit += REDMIN(8U, IMAPBENCH_BITS - ulBit);
+        }
+        else
+        {
+            if (!RedBitGet(abCur, ulBit) && !RedBitGet(abCmt, ulBit))
+            {
+                return ulBit;
+            }
+
+            ulBit++;
+        }
+
+        if (ulBit == IMAPBENCH_BITS)
+        {
+            ulBit = 0U;
+        }
+    } while (ulBit != ulStart);
+
+    return IMAPBENCH_NOT_FOUND;
+}
+
+/**
+ * @brief Word scan, same wrap around as RedImapIBlockFindFree
+ */
+static uint32_t IMAPBENCH_FindWord(uint32_t ulStart)
+{
+    uint32_t ulBit = RedBitFindClear(abCur, abCmt, ulStart, IMAPBENCH_BITS);
+
+    if (ulBit == IMAPBENCH_BITS)
+    {
+        ulBit = RedBitFindClear(abCur, abCmt, 0U, ulStart);
+        if (ulBit == ulStart)
+        {
+            ulBit = IMAPBENCH_NOT_FOUND;
+        }
+    }
+
+    return ulBit;
+}
+
+/**
+ * @brief Allocate one slot of ulFillPermille / 1000 of the inodes in abCur,
+ *        abCmt keeps a copy so that both searches start from the same table
+ */
+static void IMAPBENCH_InodePopulate(uint32_t ulFillPermille)
+{
+    memset(abCur, 0, sizeof(abCur));
+
+    for (uint32_t i = 0; i < IMAPBENCH_INODES; i++)
+    {
+        if ((IMAPBENCH_Rand() % 1000U) < ulFillPermille)
+        {
+            RedBitSet(abCur, (i * 2U) + (IMAPBENCH_Rand() & 1U));
+        }
+    }
+
+    memcpy(abCmt, abCur, sizeof(abCmt));
+}
+
+/**
+ * @brief Reference search, the loop InodeFindFree used before
+ */
+static uint32_t IMAPBENCH_InodeFindBitwise(void)
+{
+    for (uint32_t i = 0; i < IMAPBENCH_INODES; i++)
+    {
+        if (!RedBitGet(abCur, i * 2U) && !RedBitGet(abCur, (i * 2U) + 1U))
+        {
+            return i;
+        }
+    }
+
+    return IMAPBENCH_NOT_FOUND;
+}
+
+/**
+ * @brief Pair scan from the allocation pointer, same wrap around as InodeFindFree
+ */
+static uint32_t IMAPBENCH_InodeFindPair(uint32_t ulStart)
+{
+    uint32_t ulInode = RedBitFindClearPair(abCur, ulStart, IMAPBENCH_INODES);
+
+    if (ulInode == IMAPBENCH_INODES)
+    {
+        ulInode = RedBitFindClearPair(abCur, 0U, ulStart);
+        if (ulInode == ulStart)
+        {
+            ulInode = IMAPBENCH_NOT_FOUND;
+        }
+    }
+
+    return ulInode;
+}
+
+/**
+ * @brief Time the inode searches on every fill level
+ *
+ * @return 0 on success, -1 if a search returns an allocated inode
+ */
+static int32_t IMAPBENCH_InodeRun(void)
+{
+    printf("\n# %u inodes, up to %u creates per fill level\n",
+           (unsigned)IMAPBENCH_INODES, (unsigned)IMAPBENCH_CREATES);
+    printf("%-8s %10s %12s %12s %8s\n", "fill", "creates", "firstfit_ns", "pair_ns", "speedup");
+
+    for (uint32_t f = 0; f < (sizeof(gaulInodeFillPermille) / sizeof(gaulInodeFillPermille[0])); f++)
+    {
+        uint64_t ullBitwise;
+        uint64_t ullPair;
+        uint32_t ulCreates;
+        uint32_t ulNext = 0U;
+
+        IMAPBENCH_InodePopulate(gaulInodeFillPermille[f]);
+
+        /* Count the free inodes, the pair scan must stop on each of them */
+        ulCreates = 0U;
+        for (uint32_t i = 0; i < IMAPBENCH_INODES; i++)
+        {
+            bool fFree = !RedBitGet(abCur, i * 2U) && !RedBitGet(abCur, (i * 2U) + 1U);
+
+            if (fFree != (IMAPBENCH_InodeFindPair(i) == i))
+            {
+                fprintf(stderr, "imap_bench: inode %lu: pair scan disagrees\n", (unsigned long)i);
+                return -1;
+            }
+
+            ulCreates += fFree ? 1U : 0U;
+        }
+
+        /* Leave half of the free inodes free at the end of the run */
+        ulCreates = REDMIN(ulCreates / 2U, IMAPBENCH_CREATES);
+
+        ullBitwise = IMAPBENCH_HostNs();
+        for (uint32_t i = 0; i < ulCreates; i++)
+        {
+            RedBitSet(abCur, IMAPBENCH_InodeFindBitwise() * 2U);
+        }
+        ullBitwise = IMAPBENCH_HostNs() - ullBitwise;
+
+        memcpy(abCur, abCmt, sizeof(abCur));
+
+        ullPair = IMAPBENCH_HostNs();
+        for (uint32_t i = 0; i < ulCreates; i++)
+        {
+            uint32_t ulInode = IMAPBENCH_InodeFindPair(ulNext);
+
+            if ((ulInode == IMAPBENCH_NOT_FOUND) || RedBitGet(abCur, ulInode * 2U) || RedBitGet(abCur, (ulInode * 2U) + 1U))
+            {
+                fprintf(stderr, "imap_bench: create %lu: pair scan returned inode %lu\n",
+                        (unsigned long)i, (unsigned long)ulInode);
+                return -1;
+            }
+
+            RedBitSet(abCur, ulInode * 2U);
+            ulNext = (ulInode + 1U) % IMAPBENCH_INODES;
+        }
+        ullPair = IMAPBENCH_HostNs() - ullPair;
+
+        printf("%5.1f%%   %10lu %12.1f %12.1f %7.1fx\n",
+               (double)gaulInodeFillPermille[f] / 10.0, (unsigned long)ulCreates,
+               (double)ullBitwise / REDMAX(ulCreates, 1U), (double)ullPair / REDMAX(ulCreates, 1U),
+               (double)ullBitwise / (double)((ullPair != 0U) ? ullPair : 1U));
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Monotonic host time in nanoseconds
+ */
+static uint64_t IMAPBENCH_HostNs(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Deterministic pseudo random generator (xorshift32), same sequence on every run
+ */
+static uint32_t IMAPBENCH_Rand(void)
+{
+    ulRandState ^= ulRandState << 13;
+    ulRandState ^= ulRandState >> 17;
+    ulRandState ^= ulRandState << 5;
+
+    return ulRandState;
+}
+
+/************************************
+ * GLOBAL FUNCTIONS
+ ************************************/
+
+/**
+ * @brief Time both block searches, then both inode searches, on every fill level
+ *
+ * @return 0 on success, -1 if the searches disagree
+ */
+int32_t IMAPBENCH_Run(void)
+{
+    ulRandState = 1U;
+
+    printf("# %u blocks, %u searches per fill level, random start block\n",
+           (unsigned)IMAPBENCH_BITS, (unsigned)IMAPBENCH_QUERIES);
+    printf("%-8s %10s %12s %12s %8s\n", "fill", "not_found", "bitwise_ns", "word_ns", "speedup");
+
+    for (uint32_t f = 0; f < (sizeof(gaulFillPermille) / sizeof(gaulFillPermille[0])); f++)
+    {
+        uint64_t ullBitwise;
+        uint64_t ullWord;
+        uint32_t ulNotFound = 0U;
+
+        IMAPBENCH_Populate(gaulFillPermille[f]);
+        for (uint32_t i = 0; i < IMAPBENCH_QUERIES; i++)
+        {
+            aulStart[i] = IMAPBENCH_Rand() % IMAPBENCH_BITS;
+        }
+
+        ullBitwise = IMAPBENCH_HostNs();
+        for (uint32_t i = 0; i < IMAPBENCH_QUERIES; i++)
+        {
+            aulResult[i] = IMAPBENCH_FindBitwise(aulStart[i]);
+        }
+        ullBitwise = IMAPBENCH_HostNs() - ullBitwise;
+
+        ullWord = IMAPBENCH_HostNs();
+        for (uint32_t i = 0; i < IMAPBENCH_QUERIES; i++)
+        {
+            uint32_t ulFound = IMAPBENCH_FindWord(aulStart[i]);
+
+            if (ulFound != aulResult[i])
+            {
+                fprintf(stderr, "imap_bench: start %lu: bitwise %lu, word %lu\n",
+                        (unsigned long)aulStart[i], (unsigned long)aulResult[i], (unsigned long)ulFound);
+                return -1;
+            }
+
+            ulNotFound += (ulFound == IMAPBENCH_NOT_FOUND) ? 1U : 0U;
+        }
+        ullWord = IMAPBENCH_HostNs() - ullWord;
+
+        printf("%5.1f%%   %10lu %12.1f %12.1f %7.1fx\n",
+               (double)gaulFillPermille[f] / 10.0, (unsigned long)ulNotFound,
+               (double)ullBitwise / IMAPBENCH_QUERIES, (double)ullWord / IMAPBENCH_QUERIES,
+               (double)ullBitwise / (double)((ullWord != 0U) ? ullWord : 1U));
+    }
+
+    return IMAPBENCH_InodeRun();
+}
@@ -0,0 +1,729 @@
+/**
+ ********************************************************************************
+ * @file    mount_bench.c
+ * @author  SimON
+ * @date    17 окт. 2026 г.
+ * @brief   LevelX cold mount time: full scan vs. fast-mount checkpoint
+ *
+ *          The mount is the osbdev.c sequence: _lx_nor_flash_open, then the
+ *          mapping table and the extended cache of the same sizes. Its device
+ *          time is measured on the default geometry with the Reliance Edge
+ *          volume (MOUNTBENCH_VOLUME_SECTORS) written once and closed:
+ *          - full scan      : checkpoint disabled, every block is scanned;
+ *          - clean close    : the checkpoint written by _lx_nor_flash_close;
+ *          - loss_N         : N random overwrites after the mount, then power
+ *                             loss (no close), only changed blocks are scanned;
+ *          - idle_loss_N    : the same with a checkpoint at every
+ *                             MOUNTBENCH_IDLE_WRITES writes (RedOsBDevFlush);
+ *          - scan_loss_N    : power loss with the checkpoint disabled.
+ *          Every mount is compared to a full scan of the same image: instance
+ *          counts, erase counts, obsolete count cache, mapping bitmap and the
+ *          counts of the block statistics table must match and every sector
+ *          must read back.
+ *
+ *          The torn test then cuts the power at every driver write or erase
+ *          request (the last write programs half of its words) of a workload
+ *          on a small 4 KB block part that overwrites sectors, reclaims blocks
+ *          and writes a checkpoint every MOUNTBENCH_TORN_WRITES writes, past
+ *          the wrap of the checkpoint area. Before each checkpoint a background
+ *          reclaim step moves a few sectors (every other time also erases), so
+ *          cuts also hit half reclaimed blocks. Each cut image is mounted and
+ *          checked like above, then written to, closed and mounted again.
+ ********************************************************************************
+ */
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mount_bench.h"
+#include "lx_api.h"
+#include "lx_nor_flash_simulator.h"
+
+#ifdef LX_NOR_ENABLE_CHECKPOINT
+
+/************************************
+ * PRIVATE MACROS AND DEFINES
+ ************************************/
+#define MOUNTBENCH_VOLUME_SECTORS       4096U   /* Reliance Edge volume, redconf.c */
+#define MOUNTBENCH_MAPPING_TABLE        32640U  /* BDEV_MAPPING_TABLE_SECTORS, osbdev.c */
+#define MOUNTBENCH_EXTENDED_CACHE       (12U * 1024U)  /* BDEV_EXTENDED_CACHE_SIZE, osbdev.c */
+#define MOUNTBENCH_IDLE_WRITES          32U
+#define MOUNTBENCH_TORN_BLOCK_SIZE      4096U
+#define MOUNTBENCH_TORN_BLOCKS          96U
+#define MOUNTBENCH_TORN_FILL_PCT        75U
+#define MOUNTBENCH_TORN_WRITES          8U
+#define MOUNTBENCH_TORN_ROUNDS          80U
+#define MOUNTBENCH_TORN_MOVES           3U      /* Background reclaim budget per round, in sector moves */
+#define MOUNTBENCH_TORN_SMALL_TABLE     256U    /* Odd cuts: table does not cover the volume */
+#define MOUNTBENCH_MAX_BLOCKS           (LX_NOR_SIMULATOR_FLASH_SIZE / LX_NOR_SIMULATOR_SUBSECTOR_SIZE)
+
+/************************************
+ * PRIVATE TYPEDEFS
+ ************************************/
+typedef struct
+{
+    ULONG64             ullOpen;
+    ULONG64             ullTable;
+    ULONG64             ullCache;
+    ULONG               ulScanned;
+} mountbench_time;
+
+typedef struct
+{
+    ULONG               ulFree;
+    ULONG               ulMapped;
+    ULONG               ulObsolete;
+    ULONG               ulMinErase;
+    ULONG               ulMinErased;
+    ULONG               ulMaxErase;
+    ULONG               ulSearch;
+    LX_NOR_OBSOLETE_COUNT_CACHE_TYPE aObsolete[MOUNTBENCH_MAX_BLOCKS];
+    ULONG               aulBitmap[MOUNTBENCH_EXTENDED_CACHE / sizeof(ULONG)];
+#ifdef LX_NOR_ENABLE_BLOCK_STATS
+    LX_NOR_FLASH_BLOCK_STATS aStats[MOUNTBENCH_MAX_BLOCKS];     /* Counts only, the ranges of trusted blocks are not known */
+#endif
+} mountbench_state;
+
+/************************************
+ * STATIC FUNCTION PROTOTYPES
+ ************************************/
+static UINT MOUNTBENCH_InitCheckpoint(LX_NOR_FLASH *nor_flash);
+static UINT MOUNTBENCH_InitScan(LX_NOR_FLASH *nor_flash);
+static UINT MOUNTBENCH_Write(ULONG *flash_address, ULONG *source, ULONG words);
+static UINT MOUNTBENCH_Erase(ULONG block, ULONG erase_count);
+static int32_t MOUNTBENCH_Mount(UINT (*init)(LX_NOR_FLASH *), ULONG ulTable, int bCacheFirst, mountbench_time *pTime);
+static void MOUNTBENCH_StateGet(mountbench_state *pState);
+static int32_t MOUNTBENCH_Reference(const char *pszName, ULONG ulTable);
+static int32_t MOUNTBENCH_Check(const char *pszName);
+static int32_t MOUNTBENCH_Verify(const char *pszName, ULONG ulInFlight, ULONG ulInFlightVersion);
+static int32_t MOUNTBENCH_Overwrite(ULONG ulWrites, ULONG ulIdleWrites);
+static int32_t MOUNTBENCH_Scenario(const char *pszName, int bCheckpoint, ULONG ulWrites, ULONG ulIdleWrites);
+static int32_t MOUNTBENCH_TornWorkload(void);
+static int32_t MOUNTBENCH_Cut(ULONG ulCut);
+static int32_t MOUNTBENCH_Torn(void);
+static void MOUNTBENCH_Fill(ULONG ulSector, ULONG ulVersion);
+static uint32_t MOUNTBENCH_Rand(void);
+
+/************************************
+ * STATIC VARIABLES
+ ************************************/
+static LX_NOR_FLASH norFlash;
+static LX_NOR_MAPPING_TABLE_TYPE ausMappingTable[MOUNTBENCH_MAPPING_TABLE];
+static ULONG aulExtendedCache[MOUNTBENCH_EXTENDED_CACHE / sizeof(ULONG)];
+static ULONG aulSector[LX_NOR_SECTOR_SIZE];
+static ULONG aulCheck[LX_NOR_SECTOR_SIZE];
+static ULONG aulVersion[MOUNTBENCH_VOLUME_SECTORS];
+static ULONG ulSectors;
+static mountbench_state stateMount;
+static mountbench_state stateScan;
+static uint32_t ulRandState = 1U;
+
+/* Images: the filled volume and the image left by a power loss */
+static ULONG *pulBase;
+static ULONG *pulCut;
+static ULONG ulImageWords;
+
+/* Driver wrappers: count write/erase requests and cut the power at one of them */
+static UINT (*pfnWrite)(ULONG *flash_address, ULONG *source, ULONG words);
+static UINT (*pfnErase)(ULONG block, ULONG erase_count);
+static ULONG ulRequests;
+static ULONG ulCutAt;
+static ULONG ulInFlight;
+static ULONG ulInFlightVersion;
+static jmp_buf cutJump;
+
+/************************************
+ * STATIC FUNCTIONS
+ ************************************/
+
+/**
+ * @brief Simulator driver with the checkpoint area, requests go through the cut wrappers
+ */
+static UINT MOUNTBENCH_InitCheckpoint(LX_NOR_FLASH *nor_flash)
+{
+    UINT status = _lx_nor_flash_simulator_initialize(nor_flash);
+
+    pfnWrite = nor_flash->lx_nor_flash_driver_write;
+    pfnErase = nor_flash->lx_nor_flash_driver_block_erase;
+    nor_flash->lx_nor_flash_driver_write       = MOUNTBENCH_Write;
+    nor_flash->lx_nor_flash_driver_block_erase = MOUNTBENCH_Erase;
+
+    return status;
+}
+
+/**
+ * @brief Same driver without a checkpoint area: open scans every block
+ */
+static UINT MOUNTBENCH_InitScan(LX_NOR_FLASH *nor_flash)
+{
+    UINT status = MOUNTBENCH_InitCheckpoint(nor_flash);
+
+    nor_flash->lx_nor_flash_checkpoint_blocks = 0;
+
+    return status;
+}
+
+static UINT MOUNTBENCH_Write(ULONG *flash_address, ULONG *source, ULONG words)
+{
+    if (++ulRequests == ulCutAt)
+    {
+        /* Power fails while the request is programmed */
+        (void)pfnWrite(flash_address, source, words / 2U);
+        longjmp(cutJump, 1);
+    }
+
+    return pfnWrite(flash_address, source, words);
+}
+
+static UINT MOUNTBENCH_Erase(ULONG block, ULONG erase_count)
+{
+    if (++ulRequests == ulCutAt)
+    {
+        /* Power fails before the erase starts */
+        longjmp(cutJump, 1);
+    }
+
+    return pfnErase(block, erase_count);
+}
+
+/**
+ * @brief Cold mount like RedOsBDevOpen, device time of each step
+ *
+ * @param ulTable       Mapping table entries
+ * @param bCacheFirst   Enable the extended cache before the mapping table, so its
+ *                      mapping bitmap is built by scanning (reference mount)
+ */
+static int32_t MOUNTBENCH_Mount(UINT (*init)(LX_NOR_FLASH *), ULONG ulTable, int bCacheFirst, mountbench_time *pTime)
+{
+    ULONG64 ullStart;
+
+    /* A power loss leaves the instance on the open list */
+    _lx_nor_flash_initialize();
+
+    ullStart = _lx_nor_flash_simulator_time_get();
+    if (_lx_nor_flash_open(&norFlash, "mount", init) != LX_SUCCESS)
+    {
+        return -1;
+    }
+    pTime->ullOpen   = _lx_nor_flash_simulator_time_get() - ullStart;
+    pTime->ulScanned = norFlash.lx_nor_flash_total_blocks - norFlash.lx_nor_flash_checkpoint_trusted_blocks;
+
+    if (bCacheFirst)
+    {
+        ullStart = _lx_nor_flash_simulator_time_get();
+        if (_lx_nor_flash_extended_cache_enable(&norFlash, aulExtendedCache, sizeof(aulExtendedCache)) != LX_SUCCESS)
+        {
+            return -1;
+        }
+        pTime->ullCache = _lx_nor_flash_simulator_time_get() - ullStart;
+    }
+
+    ullStart = _lx_nor_flash_simulator_time_get();
+    if (_lx_nor_flash_mapping_table_enable(&norFlash, ausMappingTable, ulTable * sizeof(ausMappingTable[0])) != LX_SUCCESS)
+    {
+        return -1;
+    }
+    pTime->ullTable = _lx_nor_flash_simulator_time_get() - ullStart;
+
+    if (!bCacheFirst)
+    {
+        ullStart = _lx_nor_flash_simulator_time_get();
+        if (_lx_nor_flash_extended_cache_enable(&norFlash, aulExtendedCache, sizeof(aulExtendedCache)) != LX_SUCCESS)
+        {
+            return -1;
+        }
+        pTime->ullCache = _lx_nor_flash_simulator_time_get() - ullStart;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Everything open and the extended cache derive from the flash
+ */
+static void MOUNTBENCH_StateGet(mountbench_state *pState)
+{
+    memset(pState, 0, sizeof(*pState));
+    pState->ulFree      = norFlash.lx_nor_flash_free_physical_sectors;
+    pState->ulMapped    = norFlash.lx_nor_flash_mapped_physical_sectors;
+    pState->ulObsolete  = norFlash.lx_nor_flash_obsolete_physical_sectors;
+    pState->ulMinErase  = norFlash.lx_nor_flash_minimum_erase_count;
+    pState->ulMinErased = norFlash.lx_nor_flash_minimum_erased_blocks;
+    pState->ulMaxErase  = norFlash.lx_nor_flash_maximum_erase_count;
+    pState->ulSearch    = norFlash.lx_nor_flash_free_block_search;
+    memcpy(pState->aObsolete, norFlash.lx_nor_flash_extended_cache_obsolete_count,
+           norFlash.lx_nor_flash_extended_cache_obsolete_count_max_block * sizeof(LX_NOR_OBSOLETE_COUNT_CACHE_TYPE));
+    memcpy(pState->aulBitmap, norFlash.lx_nor_flash_extended_cache_mapping_bitmap,
+           (norFlash.lx_nor_flash_extended_cache_mapping_bitmap_max_logical_sector / 32U) * sizeof(ULONG));
+#ifdef LX_NOR_ENABLE_BLOCK_STATS
+    for (ULONG i = 0; (norFlash.lx_nor_flash_block_stats != LX_NULL) && (i < norFlash.lx_nor_flash_total_blocks); i++)
+    {
+        pState->aStats[i].lx_nor_flash_block_stats_erase_count     = norFlash.lx_nor_flash_block_stats[i].lx_nor_flash_block_stats_erase_count;
+        pState->aStats[i].lx_nor_flash_block_stats_free_sectors     = norFlash.lx_nor_flash_block_stats[i].lx_nor_flash_block_stats_free_sectors;
+        pState->aStats[i].lx_nor_flash_block_stats_mapped_sectors   = norFlash.lx_nor_flash_block_stats[i].lx_nor_flash_block_stats_mapped_sectors;
+        pState->aStats[i].lx_nor_flash_block_stats_obsolete_sectors = norFlash.lx_nor_flash_block_stats[i].lx_nor_flash_block_stats_obsolete_sectors;
+    }
+#endif
+}
+
+/**
+ * @brief Full scan mount of the image in pulCut, the image is restored afterwards
+ *
+ * The extended cache is enabled before the mapping table, so the mapping bitmap is scanned too.
+ */
+static int32_t MOUNTBENCH_Reference(const char *pszName, ULONG ulTable)
+{
+    mountbench_time time;
+
+    memcpy(norFlash.lx_nor_flash_base_address, pulCut, ulImageWords * sizeof(ULONG));
+    if (MOUNTBENCH_Mount(MOUNTBENCH_InitScan, ulTable, 1, &time) != 0)
+    {
+        fprintf(stderr, "mount_bench: %s: full scan mount failed\n", pszName);
+        return -1;
+    }
+    MOUNTBENCH_StateGet(&stateScan);
+    memcpy(norFlash.lx_nor_flash_base_address, pulCut, ulImageWords * sizeof(ULONG));
+
+    return 0;
+}
+
+/**
+ * @brief Compare the mounted instance to the reference full scan
+ */
+static int32_t MOUNTBENCH_Check(const char *pszName)
+{
+    MOUNTBENCH_StateGet(&stateMount);
+    if (memcmp(&stateMount, &stateScan, sizeof(stateMount)) != 0)
+    {
+        fprintf(stderr, "mount_bench: %s: mount differs from a full scan (free %lu/%lu mapped %lu/%lu obsolete %lu/%lu)\n", pszName,
+                (unsigned long)stateMount.ulFree, (unsigned long)stateScan.ulFree,
+                (unsigned long)stateMount.ulMapped, (unsigned long)stateScan.ulMapped,
+                (unsigned long)stateMount.ulObsolete, (unsigned long)stateScan.ulObsolete);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Every sector reads back its last version, the one written at the cut may be either
+ */
+static int32_t MOUNTBENCH_Verify(const char *pszName, ULONG ulInFlight, ULONG ulInFlightVersion)
+{
+    for (ULONG i = 0; i < ulSectors; i++)
+    {
+        if (_lx_nor_flash_sector_read(&norFlash, i, aulCheck) != LX_SUCCESS)
+        {
+            fprintf(stderr, "mount_bench: %s: sector %lu read failed\n", pszName, (unsigned long)i);
+            return -1;
+        }
+
+        MOUNTBENCH_Fill(i, aulVersion[i]);
+        if (memcmp(aulSector, aulCheck, sizeof(aulSector)) == 0)
+        {
+            continue;
+        }
+
+        MOUNTBENCH_Fill(i, ulInFlightVersion);
+        if ((i == ulInFlight) && (memcmp(aulSector, aulCheck, sizeof(aulSector)) == 0))
+        {
+            aulVersion[i] = ulInFlightVersion;
+            continue;
+        }
+
+        fprintf(stderr, "mount_bench: %s: sector %lu mismatch\n", pszName, (unsigned long)i);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Random single sector overwrites, a checkpoint every ulIdleWrites writes (0: none)
+ */
+static int32_t MOUNTBENCH_Overwrite(ULONG ulWrites, ULONG ulIdleWrites)
+{
+    for (ULONG i = 0; i < ulWrites; i++)
+    {
+        ULONG ulSector = MOUNTBENCH_Rand() % ulSectors;
+
+        ulInFlight        = ulSector;
+        ulInFlightVersion = aulVersion[ulSector] + 1U;
+        MOUNTBENCH_Fill(ulSector, ulInFlightVersion);
+        if (_lx_nor_flash_sector_write(&norFlash, ulSector, aulSector) != LX_SUCCESS)
+        {
+            return -1;
+        }
+        aulVersion[ulSector] = ulInFlightVersion;
+        ulInFlight = ulSectors;
+
+        if ((ulIdleWrites != 0U) && (((i + 1U) % ulIdleWrites) == 0U))
+        {
+            /* Transaction point of the file system */
+            (void)_lx_nor_flash_checkpoint_write(&norFlash, LX_NOR_CHECKPOINT_DIRTY_BLOCKS);
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Restore the filled volume, write, lose power and time the next mount
+ */
+static int32_t MOUNTBENCH_Scenario(const char *pszName, int bCheckpoint, ULONG ulWrites, ULONG ulIdleWrites)
+{
+    UINT (*init)(LX_NOR_FLASH *) = bCheckpoint ? MOUNTBENCH_InitCheckpoint : MOUNTBENCH_InitScan;
+    mountbench_time time;
+    ULONG ulCheckpoints = 0;
+
+    memcpy(norFlash.lx_nor_flash_base_address, pulBase, ulImageWords * sizeof(ULONG));
+    for (ULONG i = 0; i < ulSectors; i++)
+    {
+        aulVersion[i] = 0;
+    }
+    ulRandState = 1U;
+
+    if (ulWrites != 0U)
+    {
+        if (MOUNTBENCH_Mount(init, MOUNTBENCH_MAPPING_TABLE, 0, &time) != 0)
+        {
+            return -1;
+        }
+
+        ulCheckpoints = norFlash.lx_nor_flash_checkpoint_writes;
+        if (MOUNTBENCH_Overwrite(ulWrites, ulIdleWrites) != 0)
+        {
+            return -1;
+        }
+        ulCheckpoints = norFlash.lx_nor_flash_checkpoint_writes - ulCheckpoints;
+
+        /* Power loss: the instance is abandoned without close */
+    }
+
+    memcpy(pulCut, norFlash.lx_nor_flash_base_address, ulImageWords * sizeof(ULONG));
+    if ((MOUNTBENCH_Reference(pszName, MOUNTBENCH_MAPPING_TABLE) != 0) ||
+        (MOUNTBENCH_Mount(init, MOUNTBENCH_MAPPING_TABLE, 0, &time) != 0))
+    {
+        fprintf(stderr, "mount_bench: %s: mount failed\n", pszName);
+        return -1;
+    }
+
+    if ((MOUNTBENCH_Check(pszName) != 0) || (MOUNTBENCH_Verify(pszName, ulSectors, 0) != 0))
+    {
+        return -1;
+    }
+
+    printf("%-16s %6lu %6lu %8lu %9.3f %9.3f %9.3f %9.3f\n", pszName, (unsigned long)ulWrites, (unsigned long)ulCheckpoints,
+           (unsigned long)time.ulScanned, (double)time.ullOpen / 1e6, (double)time.ullTable / 1e6,
+           (double)time.ullCache / 1e6, (double)(time.ullOpen + time.ullTable + time.ullCache) / 1e6);
+
+    return 0;
+}
+
+/**
+ * @brief Torn test workload: overwrites with a checkpoint every MOUNTBENCH_TORN_WRITES writes
+ */
+static int32_t MOUNTBENCH_TornWorkload(void)
+{
+    for (ULONG i = 0; i < MOUNTBENCH_TORN_ROUNDS; i++)
+    {
+        if (MOUNTBENCH_Overwrite(MOUNTBENCH_TORN_WRITES, 0) != 0)
+        {
+            return -1;
+        }
+#ifdef LX_NOR_ENABLE_BACKGROUND_RECLAIM
+
+        /* Idle point: background reclaim step */
+        if (_lx_nor_flash_background_reclaim(&norFlash, (MOUNTBENCH_TORN_MOVES * LX_NOR_BACKGROUND_RECLAIM_MOVE_TIME) +
+                                                        ((i & 1U) ? LX_NOR_BACKGROUND_RECLAIM_ERASE_TIME : 0U), LX_NULL) != LX_SUCCESS)
+        {
+            return -1;
+        }
+#endif
+
+        if (_lx_nor_flash_checkpoint_write(&norFlash, 0) != LX_SUCCESS)
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Run the torn workload until the power fails at request ulCut
+ *
+ * @return 0 if the power failed, -1 if the workload completed
+ */
+static int32_t MOUNTBENCH_Cut(ULONG ulCut)
+{
+    ulRequests = 0;
+    ulCutAt    = ulCut;
+    if (setjmp(cutJump) == 0)
+    {
+        (void)MOUNTBENCH_TornWorkload();
+        ulCutAt = 0;
+        return -1;
+    }
+    ulCutAt = 0;
+
+    return 0;
+}
+
+/**
+ * @brief Cut the power at every request of the torn workload, mount and check each image
+ */
+static int32_t MOUNTBENCH_Torn(void)
+{
+    mountbench_time time;
+    ULONG64 ullSum = 0;
+    ULONG64 ullMax = 0;
+    ULONG ulTotal;
+    ULONG ulScanned = 0;
+    ULONG ulCheckpoints;
+    char acName[32];
+
+    if (_lx_nor_flash_simulator_geometry_set(MOUNTBENCH_TORN_BLOCK_SIZE, MOUNTBENCH_TORN_BLOCKS) != LX_SUCCESS)
+    {
+        return -1;
+    }
+
+    /* Fill and close: the image starts with a checkpoint */
+    (void)_lx_nor_flash_simulator_erase_all();
+    ulCutAt = 0;
+    if (MOUNTBENCH_Mount(MOUNTBENCH_InitCheckpoint, MOUNTBENCH_MAPPING_TABLE, 0, &time) != 0)
+    {
+        return -1;
+    }
+    ulImageWords = (norFlash.lx_nor_flash_total_blocks + norFlash.lx_nor_flash_checkpoint_blocks) * norFlash.lx_nor_flash_words_per_block;
+    ulSectors    = (norFlash.lx_nor_flash_total_physical_sectors * MOUNTBENCH_TORN_FILL_PCT) / 100U;
+    for (ULONG i = 0; i < ulSectors; i++)
+    {
+        aulVersion[i] = 0;
+        MOUNTBENCH_Fill(i, 0);
+        if (_lx_nor_flash_sector_write(&norFlash, i, aulSector) != LX_SUCCESS)
+        {
+            return -1;
+        }
+    }
+    (void)_lx_nor_flash_close(&norFlash);
+    memcpy(pulBase, norFlash.lx_nor_flash_base_address, ulImageWords * sizeof(ULONG));
+
+    /* Dry run: number of requests and checkpoints (area wraps) */
+    ulRandState = 1U;
+    if (MOUNTBENCH_Mount(MOUNTBENCH_InitCheckpoint, MOUNTBENCH_MAPPING_TABLE, 0, &time) != 0)
+    {
+        return -1;
+    }
+    ulRequests = 0;
+    if (MOUNTBENCH_TornWorkload() != 0)
+    {
+        return -1;
+    }
+    ulTotal       = ulRequests;
+    ulCheckpoints = norFlash.lx_nor_flash_checkpoint_writes;
+
+    for (ULONG ulCut = 1; ulCut <= ulTotal; ulCut++)
+    {
+        ULONG ulTable = (ulCut & 1U) ? MOUNTBENCH_TORN_SMALL_TABLE : MOUNTBENCH_MAPPING_TABLE;
+
+        snprintf(acName, sizeof(acName), "cut %lu", (unsigned long)ulCut);
+
+        memcpy(norFlash.lx_nor_flash_base_address, pulBase, ulImageWords * sizeof(ULONG));
+        for (ULONG i = 0; i < ulSectors; i++)
+        {
+            aulVersion[i] = 0;
+        }
+        ulRandState = 1U;
+        ulInFlight  = ulSectors;
+        ulCutAt     = 0;
+        if (MOUNTBENCH_Mount(MOUNTBENCH_InitCheckpoint, MOUNTBENCH_MAPPING_TABLE, 0, &time) != 0)
+        {
+            return -1;
+        }
+
+        if (MOUNTBENCH_Cut(ulCut) != 0)
+        {
+            fprintf(stderr, "mount_bench: %s: no cut\n", acName);
+            return -1;
+        }
+
+        /* Power is back */
+        memcpy(pulCut, norFlash.lx_nor_flash_base_address, ulImageWords * sizeof(ULONG));
+        if ((MOUNTBENCH_Reference(acName, ulTable) != 0) ||
+            (MOUNTBENCH_Mount(MOUNTBENCH_InitCheckpoint, ulTable, 0, &time) != 0))
+        {
+            fprintf(stderr, "mount_bench: %s: mount failed\n", acName);
+            return -1;
+        }
+        ullSum += time.ullOpen + time.ullTable + time.ullCache;
+        if ((time.ullOpen + time.ullTable + time.ullCache) > ullMax)
+        {
+            ullMax = time.ullOpen + time.ullTable + time.ullCache;
+        }
+        ulScanned += time.ulScanned;
+
+        if ((MOUNTBENCH_Check(acName) != 0) || (MOUNTBENCH_Verify(acName, ulInFlight, ulInFlightVersion) != 0))
+        {
+            return -1;
+        }
+
+        /* The recovered instance keeps working across a clean close */
+        ulInFlight = ulSectors;
+        if ((MOUNTBENCH_Overwrite(MOUNTBENCH_TORN_WRITES, 0) != 0) || (_lx_nor_flash_close(&norFlash) != LX_SUCCESS))
+        {
+            fprintf(stderr, "mount_bench: %s: write after recovery failed\n", acName);
+            return -1;
+        }
+        memcpy(pulCut, norFlash.lx_nor_flash_base_address, ulImageWords * sizeof(ULONG));
+        if ((MOUNTBENCH_Reference(acName, ulTable) != 0) ||
+            (MOUNTBENCH_Mount(MOUNTBENCH_InitCheckpoint, ulTable, 0, &time) != 0) ||
+            (time.ulScanned != 0U) ||
+            (MOUNTBENCH_Check(acName) != 0) || (MOUNTBENCH_Verify(acName, ulSectors, 0) != 0))
+        {
+            fprintf(stderr, "mount_bench: %s: mount after recovery failed\n", acName);
+            return -1;
+        }
+    }
+
+    printf("# torn: %lu cuts over %lu checkpoints (%lu blocks of %lu KB, area of %lu KB), all mounts match a full scan\n",
+           (unsigned long)ulTotal, (unsigned long)ulCheckpoints, (unsigned long)MOUNTBENCH_TORN_BLOCKS,
+           (unsigned long)(MOUNTBENCH_TORN_BLOCK_SIZE / 1024U),
+           (unsigned long)(norFlash.lx_nor_flash_checkpoint_blocks * MOUNTBENCH_TORN_BLOCK_SIZE / 1024U));
+    printf("# torn: mount after a cut %.3f ms mean, %.3f ms max, %.1f of %lu blocks scanned\n",
+           (double)ullSum / (double)ulTotal / 1e6, (double)ullMax / 1e6,
+           (double)ulScanned / (double)ulTotal, (unsigned long)MOUNTBENCH_TORN_BLOCKS);
+
+    return 0;
+}
+
+/**
+ * @brief Sector contents depend on the logical sector and its version
+ */
+static void MOUNTBENCH_Fill(ULONG ulSector, ULONG ulVersion)
+{
+    for (ULONG i = 0; i < LX_NOR_SECTOR_SIZE; i++)
+    {
+        aulSector[i] = (ulSector << 16) ^ (ulVersion << 8) ^ i;
+    }
+}
+
+/**
+ * @brief Deterministic pseudo random generator (xorshift32), same sequence on every run
+ */
+static uint32_t MOUNTBENCH_Rand(void)
+{
+    ulRandState ^= ulRandState << 13;
+    ulRandState ^= ulRandState >> 17;
+    ulRandState ^= ulRandState << 5;
+
+    return ulRandState;
+}
+
+#endif /* LX_NOR_ENABLE_CHECKPOINT */
+
+/************************************
+ * GLOBAL FUNCTIONS
+ ************************************/
+
+/**
+ * @brief Time the cold mount scenarios, then run the torn checkpoint test
+ *
+ * @return 0 on success, -1 if a mount failed or differs from a full scan
+ */
+int32_t MOUNTBENCH_Run(void)
+{
+#ifdef LX_NOR_ENABLE_CHECKPOINT
+    mountbench_time time;
+    ULONG ulBlockSize;
+    ULONG ulTotalBlocks;
+    ULONG64 ullClose;
+    int32_t ret = -1;
+
+    _lx_nor_flash_simulator_geometry_get(&ulBlockSize, &ulTotalBlocks);
+    _lx_nor_flash_simulator_stats_reset();
+
+    /* The filled volume and the image being mounted */
+    pulBase = malloc(LX_NOR_SIMULATOR_FLASH_SIZE);
+    pulCut  = malloc(LX_NOR_SIMULATOR_FLASH_SIZE);
+    if ((pulBase == NULL) || (pulCut == NULL))
+    {
+        goto exit;
+    }
+
+    /* Write the volume once and close: the close writes the first checkpoint */
+    (void)_lx_nor_flash_simulator_erase_all();
+    ulCutAt = 0;
+    if (MOUNTBENCH_Mount(MOUNTBENCH_InitCheckpoint, MOUNTBENCH_MAPPING_TABLE, 0, &time) != 0)
+    {
+        goto exit;
+    }
+    ulImageWords = (norFlash.lx_nor_flash_total_blocks + norFlash.lx_nor_flash_checkpoint_blocks) * norFlash.lx_nor_flash_words_per_block;
+    ulSectors    = MOUNTBENCH_VOLUME_SECTORS;
+    for (ULONG i = 0; i < ulSectors; i++)
+    {
+        MOUNTBENCH_Fill(i, 0);
+        if (_lx_nor_flash_sector_write(&norFlash, i, aulSector) != LX_SUCCESS)
+        {
+            goto exit;
+        }
+    }
+    ullClose = _lx_nor_flash_simulator_time_get();
+    (void)_lx_nor_flash_close(&norFlash);
+    ullClose = _lx_nor_flash_simulator_time_get() - ullClose;
+    memcpy(pulBase, norFlash.lx_nor_flash_base_address, ulImageWords * sizeof(ULONG));
+
+    printf("# %lu blocks of %lu KB, %u sector volume, mapping table %u sectors, extended cache %u KB, checkpoint at close %.3f ms\n",
+           (unsigned long)norFlash.lx_nor_flash_total_blocks, (unsigned long)(ulBlockSize / 1024U),
+           (unsigned)MOUNTBENCH_VOLUME_SECTORS, (unsigned)MOUNTBENCH_MAPPING_TABLE,
+           (unsigned)(MOUNTBENCH_EXTENDED_CACHE / 1024U), (double)ullClose / 1e6);
+    printf("%-16s %6s %6s %8s %9s %9s %9s %9s\n", "mount", "writes", "ckpts", "scanned", "open_ms", "table_ms", "cache_ms", "total_ms");
+
+    if ((MOUNTBENCH_Scenario("full_scan", 0, 0, 0) != 0) ||
+        (MOUNTBENCH_Scenario("clean_close", 1, 0, 0) != 0) ||
+        (MOUNTBENCH_Scenario("scan_loss_1024", 0, 1024, 0) != 0) ||
+        (MOUNTBENCH_Scenario("loss_64", 1, 64, 0) != 0) ||
+        (MOUNTBENCH_Scenario("loss_1024", 1, 1024, 0) != 0) ||
+        (MOUNTBENCH_Scenario("idle_loss_1024", 1, 1024, MOUNTBENCH_IDLE_WRITES) != 0))
+    {
+        goto exit;
+    }
+
+    if (MOUNTBENCH_Torn() != 0)
+    {
+        goto exit;
+    }
+
+    {
+        LX_NOR_FLASH_SIMULATOR_STATS stats;
+
+        _lx_nor_flash_simulator_stats_get(&stats);
+        if ((stats.lx_nor_flash_simulator_system_errors != 0U) || (stats.lx_nor_flash_simulator_program_violations != 0U))
+        {
+            fprintf(stderr, "mount_bench: %llu system errors, %llu program violations\n",
+                    (unsigned long long)stats.lx_nor_flash_simulator_system_errors,
+                    (unsigned long long)stats.lx_nor_flash_simulator_program_violations);
+            goto exit;
+        }
+    }
+
+    ret = 0;
+
+exit:
+    /* Leave the simulator as found */
+    (void)_lx_nor_flash_simulator_geometry_set(ulBlockSize, ulTotalBlocks);
+    free(pulBase);
+    free(pulCut);
+
+    return ret;
+#else
+    printf("# LX_NOR_ENABLE_CHECKPOINT is not defined\n");
+
+    return 0;
+#endif
+}
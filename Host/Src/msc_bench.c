@@ -0,0 +1,1069 @@
+/**
+ ********************************************************************************
+ * @file    msc_bench.c
+ * @author  SimON
+ * @date    17 окт. 2026 г.
+ * @brief   USB MSC LUN on LevelX: SCSI command streams replayed through the class driver
+ *
+ *          Plays the USB host against the unmodified ST core, MSC class and
+ *          usbd_storage_if.c (the LUN backed by nor_mem_desc) on the simulated
+ *          NOR part: every command is a real CBW, data phases go through the
+ *          bulk endpoints in the chunks the class arms (MSC_MEDIA_PACKET), the
+ *          CSW is checked. The stream is either the built-in workloads (what a
+ *          PC does when copying files to the drive, then discarding them) or a
+ *          recorded trace file, one command per line:
+ *
+ *              <i|o|-> <transfer length> <CDB bytes in hex>
+ *
+ *          i/o/- is the data direction; OUT data is a fixed pattern, IN data is
+ *          discarded. Lines starting with '#' are ignored.
+ *
+ *          Time is simulated event by event: a transfer starts on the wire
+ *          once the device armed it and the previous one finished, and lasts
+ *          its full speed packets (19 bulk packets of 64 bytes per 1 ms frame,
+ *          a typical host controller limit, 1.216 MB/s). MSC_BOT_Process (the
+ *          target main loop) runs when it has work and the CPU is free, and
+ *          takes the simulator busy time of the flash operations it does;
+ *          transfers it arms are stamped with the time reached so far. The
+ *          workloads run twice on a fresh part:
+ *
+ *              serial   MSC_BOT_Process right in the endpoint callback and the
+ *                       wire held meanwhile (the stock class, storage in the
+ *                       USB interrupt)
+ *              overlap  MSC_BOT_Process from the main loop, one media buffer
+ *                       on the wire while the other is read or committed
+ *
+ *          Host CPU time of the stack is reported separately. Build with
+ *          -DMSC_MEDIA_PACKET=512 to compare with the CubeMX default.
+ *
+ *          The cold mount table then writes 4 MB and 256 random 4 KB blocks
+ *          on a fresh part and cuts the power (no close) after:
+ *
+ *              no_idle     nothing, the main loop never went idle
+ *              idle        one STORAGE_Idle_FS (reclaim, checkpoint)
+ *              idle_tail   idle, MSCBENCH_TAIL_COMMANDS more 4 KB writes,
+ *                          idle again (too few changed blocks to checkpoint)
+ *              eject_tail  the same with START STOP UNIT (eject) before the
+ *                          last idle
+ *
+ *          and reports the checkpoints written and the blocks the next
+ *          _lx_nor_flash_open scans, with its device time.
+ ********************************************************************************
+ */
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "usbd_core.h"
+#include "usbd_msc.h"
+#include "usbd_msc_data.h"
+#include "usbd_storage_if.h"
+#include <redfs.h>
+#include "lx_api.h"
+#include "lx_nor_flash_simulator.h"
+#include "nor_driver.h"
+
+#include "usbd_host_port.h"
+#include "msc_bench.h"
+
+/************************************
+ * PRIVATE MACROS AND DEFINES
+ ************************************/
+#define MSCBENCH_BLOCK_SIZE         (LX_NOR_SECTOR_SIZE * sizeof(ULONG))
+#define MSCBENCH_REGION_BLOCKS      8192U                               /* 4 MB exercised by the workloads */
+#define MSCBENCH_MAX_XFER           (128U * MSCBENCH_BLOCK_SIZE)        /* 64 KB, the usual Windows transfer */
+#define MSCBENCH_PACKET_NS          (1000000ULL / 19ULL)                /* 19 bulk packets per frame */
+#define MSCBENCH_UNMAP_SPAN         128U                                /* Blocks per UNMAP descriptor */
+#define MSCBENCH_TAIL_COMMANDS      8U                                  /* 4 KB writes after the last idle checkpoint */
+
+#define MSCBENCH_CBW_SIGNATURE      0x43425355U
+#define MSCBENCH_CSW_SIGNATURE      0x53425355U
+
+/************************************
+ * PRIVATE TYPEDEFS
+ ************************************/
+typedef enum
+{
+    MSCBENCH_SEQ_WRITE,
+    MSCBENCH_SEQ_READ,
+    MSCBENCH_RAND_WRITE,
+    MSCBENCH_RAND_READ,
+    MSCBENCH_UNMAP,
+} mscbench_op;
+
+typedef struct
+{
+    const char     *pszName;
+    mscbench_op     op;
+    uint32_t        ulBlocksPerCmd;
+    uint32_t        ulCommands;             /* Random workloads only */
+} mscbench_entry;
+
+typedef struct
+{
+    const char                     *pszName;
+    uint32_t                        ulCommands;
+    uint64_t                        ullBytes;
+    uint64_t                        ullPackets;
+    uint64_t                        ullHostNs;
+    uint64_t                        ullSimNs;               /* Simulated elapsed time */
+    LX_NOR_FLASH_SIMULATOR_STATS    flash;
+} mscbench_result;
+
+typedef struct
+{
+    const char     *pszName;
+    uint8_t         bIdle;                  /* STORAGE_Idle_FS after the workloads */
+    uint8_t         bTail;                  /* Then a few writes and idle again */
+    uint8_t         bEject;                 /* START STOP UNIT (eject) before the last idle */
+} mscbench_mount;
+
+/************************************
+ * STATIC FUNCTION PROTOTYPES
+ ************************************/
+static int32_t MSCBENCH_Command(char cDir, const uint8_t *pbCdb, uint32_t ulCdbLen, uint8_t *pbData, uint32_t ulLen);
+static int32_t MSCBENCH_Out(const uint8_t *pbData, uint32_t ulLen);
+static int32_t MSCBENCH_In(uint8_t *pbData, uint32_t ulMax, uint32_t *pulGot);
+static void MSCBENCH_Setup(const uint8_t *pbSetup);
+static void MSCBENCH_ClearStall(uint8_t bEpAddr);
+static uint8_t MSCBENCH_Ready(uint8_t bEpAddr, uint32_t *pulLen, uint64_t *pullArmNs);
+static void MSCBENCH_Wire(uint64_t ullArmNs, uint32_t ulPackets);
+static void MSCBENCH_Callback(void);
+static void MSCBENCH_Poll(void);
+static uint64_t MSCBENCH_Clock(void);
+static uint64_t MSCBENCH_SimNs(void);
+static int32_t MSCBENCH_Fresh(uint8_t bSerial);
+static int32_t MSCBENCH_Pass(uint8_t bSerial, const char *pszTrace);
+static int32_t MSCBENCH_Mount(const mscbench_mount *pMount);
+static int32_t MSCBENCH_Rw10(uint8_t bOpcode, uint32_t ulLba, uint32_t ulBlocks, uint8_t *pbData);
+static int32_t MSCBENCH_Unmap(uint32_t ulLba, uint32_t ulBlocks);
+static int32_t MSCBENCH_Eject(void);
+static int32_t MSCBENCH_Attach(void);
+static int32_t MSCBENCH_Workload(const mscbench_entry *pEntry, mscbench_result *pRes);
+static int32_t MSCBENCH_Trace(const char *pszTrace, mscbench_result *pRes);
+static void MSCBENCH_Begin(mscbench_result *pRes, const char *pszName);
+static void MSCBENCH_End(mscbench_result *pRes);
+static void MSCBENCH_Report(const mscbench_result *pRes);
+static void MSCBENCH_Fill(uint8_t *pbData, uint32_t ulLen);
+static void MSCBENCH_Put32(uint8_t *pbDst, uint32_t ulValue);
+static uint32_t MSCBENCH_Get32(const uint8_t *pbSrc);
+static uint64_t MSCBENCH_HostNs(void);
+static uint32_t MSCBENCH_Rand(void);
+
+/************************************
+ * STATIC VARIABLES
+ ************************************/
+static const mscbench_entry gaWorkloads[] =
+{
+    { "seq_write",      MSCBENCH_SEQ_WRITE,  128U, 0U   },
+    { "seq_read",       MSCBENCH_SEQ_READ,   128U, 0U   },
+    { "rand_write_4k",  MSCBENCH_RAND_WRITE, 8U,   256U },
+    { "rand_read_4k",   MSCBENCH_RAND_READ,  8U,   256U },
+    { "seq_rewrite",    MSCBENCH_SEQ_WRITE,  128U, 0U   },
+    { "unmap",          MSCBENCH_UNMAP,      0U,   0U   },
+    { "write_unmapped", MSCBENCH_SEQ_WRITE,  128U, 0U   },
+};
+
+static const mscbench_entry gTail = { "tail", MSCBENCH_RAND_WRITE, 8U, MSCBENCH_TAIL_COMMANDS };
+
+static const mscbench_mount gaMounts[] =
+{
+    { "no_idle",    0U, 0U, 0U },
+    { "idle",       1U, 0U, 0U },
+    { "idle_tail",  1U, 1U, 0U },
+    { "eject_tail", 1U, 1U, 1U },
+};
+
+static uint8_t abImage[MSCBENCH_REGION_BLOCKS * MSCBENCH_BLOCK_SIZE];  /* What the LUN must return */
+static uint8_t abXfer[MSCBENCH_MAX_XFER];
+static uint32_t ulTag;
+static uint32_t ulUnmapMaxDesc;
+static uint32_t ulLunBlocks;
+static uint32_t ulRandState = 1U;
+
+static uint8_t bLunOpen;                /* LevelX opened by the LUN in a previous pass */
+static uint8_t bSerialMode;             /* MSC_BOT_Process in the endpoint callback */
+static uint8_t bInProcess;              /* Clock follows the flash busy time */
+static uint64_t ullNowNs;               /* Time of the last bus event */
+static uint64_t ullWireFreeNs;          /* Bus free from */
+static uint64_t ullCpuFreeNs;           /* MSC_BOT_Process free from */
+static uint64_t ullProcStartNs;
+static uint64_t ullProcBusyNs;          /* Simulator busy time when MSC_BOT_Process started */
+
+static LX_NOR_FLASH norMount;           /* Instance of the mount after the power cut */
+static ULONG *pulImage;                 /* Flash at the power cut */
+
+/************************************
+ * GLOBAL VARIABLES
+ ************************************/
+USBD_HandleTypeDef hUsbDeviceFS;
+
+extern LX_NOR_FLASH nor_mem_desc;       /* The LUN volume, osbdev.c */
+
+/************************************
+ * STATIC FUNCTIONS
+ ************************************/
+
+/**
+ * @brief Run one Bulk-Only command: CBW, data phase, stall recovery, CSW
+ *        (reset recovery if the device never returns one)
+ *
+ * @param cDir     'i' device to host, 'o' host to device, '-' no data
+ * @param pbCdb    Command block
+ * @param ulCdbLen Command block length (1..16)
+ * @param pbData   Data phase buffer
+ * @param ulLen    Transfer length (dDataLength)
+ * @return CSW status (0 passed, 1 failed, 2 phase error), -1 on a protocol error
+ */
+static int32_t MSCBENCH_Command(char cDir, const uint8_t *pbCdb, uint32_t ulCdbLen, uint8_t *pbData, uint32_t ulLen)
+{
+    const uint8_t abBotReset[8] = { 0x21U, BOT_RESET, 0x00U, 0x00U, 0x00U, 0x00U, 0x00U, 0x00U };
+    uint8_t abCbw[USBD_BOT_CBW_LENGTH] = { 0U };
+    uint8_t abCsw[USBD_BOT_CSW_LENGTH];
+    uint32_t ulDone = 0U;
+    uint32_t ulGot;
+
+    ulTag++;
+    MSCBENCH_Put32(&abCbw[0], MSCBENCH_CBW_SIGNATURE);
+    MSCBENCH_Put32(&abCbw[4], ulTag);
+    MSCBENCH_Put32(&abCbw[8], ulLen);
+    abCbw[12] = (cDir == 'i') ? 0x80U : 0x00U;
+    abCbw[14] = (uint8_t)ulCdbLen;
+    memcpy(&abCbw[15], pbCdb, ulCdbLen);
+
+    if (MSCBENCH_Out(abCbw, sizeof(abCbw)) != (int32_t)sizeof(abCbw))
+    {
+        return -1;
+    }
+
+    if (cDir == 'o')
+    {
+        while (ulDone < ulLen)
+        {
+            int32_t lTaken = MSCBENCH_Out(&pbData[ulDone], ulLen - ulDone);
+
+            if (lTaken <= 0)
+            {
+                break;
+            }
+            ulDone += (uint32_t)lTaken;
+        }
+    }
+    else if (cDir == 'i')
+    {
+        while (ulDone < ulLen)
+        {
+            if (MSCBENCH_In(&pbData[ulDone], ulLen - ulDone, &ulGot) != 0)
+            {
+                break;
+            }
+            ulDone += ulGot;
+
+            /* A short packet ends the data phase */
+            if ((ulGot % USBDHOST_FS_PACKET_SIZE) != 0U)
+            {
+                break;
+            }
+        }
+    }
+
+    /* Stalled data phase: clear OUT first, clearing IN makes the device send the CSW */
+    if (USBDHOST_IsStalled(MSC_EPOUT_ADDR) != 0U)
+    {
+        MSCBENCH_ClearStall(MSC_EPOUT_ADDR);
+    }
+    if (USBDHOST_IsStalled(MSC_EPIN_ADDR) != 0U)
+    {
+        MSCBENCH_ClearStall(MSC_EPIN_ADDR);
+    }
+
+    if (MSCBENCH_In(abCsw, sizeof(abCsw), &ulGot) != 0)
+    {
+        /* Still stalled (e.g. the class rejects an opcode as a bad CBW):
+           reset recovery, the command counts as a phase error */
+        if (USBDHOST_IsStalled(MSC_EPIN_ADDR) == 0U)
+        {
+            return -1;
+        }
+
+        MSCBENCH_Setup(abBotReset);
+        MSCBENCH_ClearStall(MSC_EPIN_ADDR);
+        MSCBENCH_ClearStall(MSC_EPOUT_ADDR);
+
+        return 2;
+    }
+
+    if ((ulGot != sizeof(abCsw)) || (MSCBENCH_Get32(&abCsw[0]) != MSCBENCH_CSW_SIGNATURE) || (MSCBENCH_Get32(&abCsw[4]) != ulTag))
+    {
+        return -1;
+    }
+
+    return (int32_t)abCsw[12];
+}
+
+/**
+ * @brief Host OUT transfer on the bulk endpoint, once the device armed it
+ *
+ * @return bytes taken by the device, -1 if the endpoint is stalled or never armed
+ */
+static int32_t MSCBENCH_Out(const uint8_t *pbData, uint32_t ulLen)
+{
+    uint32_t ulArmed;
+    uint64_t ullArmNs;
+    int32_t lTaken;
+
+    if (MSCBENCH_Ready(MSC_EPOUT_ADDR, &ulArmed, &ullArmNs) == 0U)
+    {
+        return -1;
+    }
+
+    MSCBENCH_Wire(ullArmNs, USBDHOST_PacketsOf((ulLen < ulArmed) ? ulLen : ulArmed));
+    lTaken = USBDHOST_Out(&hUsbDeviceFS, MSC_EPOUT_ADDR, pbData, ulLen);
+    MSCBENCH_Callback();
+
+    return lTaken;
+}
+
+/**
+ * @brief Host IN transfer on the bulk endpoint, once the device armed it
+ *
+ * @return 0 on success, -1 if the endpoint is stalled, never armed or the transfer does not fit
+ */
+static int32_t MSCBENCH_In(uint8_t *pbData, uint32_t ulMax, uint32_t *pulGot)
+{
+    uint32_t ulArmed;
+    uint64_t ullArmNs;
+    int32_t ret;
+
+    if ((MSCBENCH_Ready(MSC_EPIN_ADDR, &ulArmed, &ullArmNs) == 0U) || (ulArmed > ulMax))
+    {
+        return -1;
+    }
+
+    MSCBENCH_Wire(ullArmNs, USBDHOST_PacketsOf(ulArmed));
+    ret = USBDHOST_In(&hUsbDeviceFS, MSC_EPIN_ADDR, pbData, ulMax, pulGot);
+    MSCBENCH_Callback();
+
+    return ret;
+}
+
+/**
+ * @brief Control request without data stage (setup and status packets)
+ */
+static void MSCBENCH_Setup(const uint8_t *pbSetup)
+{
+    MSCBENCH_Wire(ullNowNs, 2U);
+    USBDHOST_Setup(&hUsbDeviceFS, pbSetup);
+    MSCBENCH_Callback();
+}
+
+/**
+ * @brief CLEAR_FEATURE(ENDPOINT_HALT)
+ */
+static void MSCBENCH_ClearStall(uint8_t bEpAddr)
+{
+    MSCBENCH_Wire(ullNowNs, 2U);
+    USBDHOST_ClearStall(&hUsbDeviceFS, bEpAddr);
+    MSCBENCH_Callback();
+}
+
+/**
+ * @brief Wait for the device to arm an endpoint: if it has not yet, the main
+ *        loop has the work to do (a media buffer to read or commit)
+ *
+ * @return 1 if a transfer is armed, 0 if the endpoint is stalled or the device
+ *         is not going to arm it
+ */
+static uint8_t MSCBENCH_Ready(uint8_t bEpAddr, uint32_t *pulLen, uint64_t *pullArmNs)
+{
+    if (USBDHOST_IsArmed(bEpAddr, pulLen, pullArmNs) != 0U)
+    {
+        return 1U;
+    }
+
+    if (USBDHOST_IsStalled(bEpAddr) == 0U)
+    {
+        MSCBENCH_Poll();
+    }
+
+    return USBDHOST_IsArmed(bEpAddr, pulLen, pullArmNs);
+}
+
+/**
+ * @brief Put a transfer on the bus: it starts once armed and the bus is free,
+ *        the endpoint callback runs when it completes
+ */
+static void MSCBENCH_Wire(uint64_t ullArmNs, uint32_t ulPackets)
+{
+    uint64_t ullStartNs = (ullArmNs > ullWireFreeNs) ? ullArmNs : ullWireFreeNs;
+
+    ullNowNs = ullStartNs + ((uint64_t)ulPackets * MSCBENCH_PACKET_NS);
+    ullWireFreeNs = ullNowNs;
+}
+
+/**
+ * @brief After an endpoint callback: in serial mode the storage work runs
+ *        right there and the bus waits for it
+ */
+static void MSCBENCH_Callback(void)
+{
+    if (bSerialMode != 0U)
+    {
+        MSCBENCH_Poll();
+        if (ullCpuFreeNs > ullWireFreeNs)
+        {
+            ullWireFreeNs = ullCpuFreeNs;
+        }
+    }
+}
+
+/**
+ * @brief One pass of the main loop: MSC_BOT_Process does everything it can
+ *        (it only stops to wait for the bus), starting at the last bus event
+ *        or when its previous pass ended, and lasts the flash busy time
+ */
+static void MSCBENCH_Poll(void)
+{
+    LX_NOR_FLASH_SIMULATOR_STATS stats;
+
+    ullProcStartNs = (ullNowNs > ullCpuFreeNs) ? ullNowNs : ullCpuFreeNs;
+    _lx_nor_flash_simulator_stats_get(&stats);
+    ullProcBusyNs = stats.lx_nor_flash_simulator_busy_ns;
+
+    bInProcess = 1U;
+    MSC_BOT_Process(&hUsbDeviceFS);
+    ullCpuFreeNs = MSCBENCH_Clock();
+    bInProcess = 0U;
+}
+
+/**
+ * @brief Simulated time for the port's arm stamps: the bus event being
+ *        handled, or how far MSC_BOT_Process got into its flash work
+ */
+static uint64_t MSCBENCH_Clock(void)
+{
+    LX_NOR_FLASH_SIMULATOR_STATS stats;
+
+    if (bInProcess == 0U)
+    {
+        return ullNowNs;
+    }
+
+    _lx_nor_flash_simulator_stats_get(&stats);
+
+    return ullProcStartNs + (stats.lx_nor_flash_simulator_busy_ns - ullProcBusyNs);
+}
+
+/**
+ * @brief Simulated time reached by the bus and the main loop
+ */
+static uint64_t MSCBENCH_SimNs(void)
+{
+    return (ullNowNs > ullCpuFreeNs) ? ullNowNs : ullCpuFreeNs;
+}
+
+/**
+ * @brief READ(10) / WRITE(10)
+ */
+static int32_t MSCBENCH_Rw10(uint8_t bOpcode, uint32_t ulLba, uint32_t ulBlocks, uint8_t *pbData)
+{
+    uint8_t abCdb[10] = { bOpcode, 0U, (uint8_t)(ulLba >> 24), (uint8_t)(ulLba >> 16), (uint8_t)(ulLba >> 8), (uint8_t)ulLba,
+                          0U, (uint8_t)(ulBlocks >> 8), (uint8_t)ulBlocks, 0U };
+
+    return MSCBENCH_Command((bOpcode == SCSI_READ10) ? 'i' : 'o', abCdb, sizeof(abCdb), pbData, ulBlocks * MSCBENCH_BLOCK_SIZE);
+}
+
+/**
+ * @brief UNMAP a range, as many descriptors per command as the LUN accepts (VPD page B0)
+ */
+static int32_t MSCBENCH_Unmap(uint32_t ulLba, uint32_t ulBlocks)
+{
+    while (ulBlocks != 0U)
+    {
+        uint32_t ulDesc = 0U;
+        uint32_t ulParamLen;
+        uint8_t abCdb[10] = { SCSI_UNMAP, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U };
+        int32_t ret;
+
+        memset(abXfer, 0, 8U);
+        while ((ulBlocks != 0U) && (ulDesc < ulUnmapMaxDesc))
+        {
+            uint8_t *pbDesc = &abXfer[8U + (ulDesc * 16U)];
+            uint32_t ulSpan = (ulBlocks < MSCBENCH_UNMAP_SPAN) ? ulBlocks : MSCBENCH_UNMAP_SPAN;
+
+            memset(pbDesc, 0, 16U);
+            pbDesc[4] = (uint8_t)(ulLba >> 24);
+            pbDesc[5] = (uint8_t)(ulLba >> 16);
+            pbDesc[6] = (uint8_t)(ulLba >> 8);
+            pbDesc[7] = (uint8_t)ulLba;
+            pbDesc[8] = (uint8_t)(ulSpan >> 24);
+            pbDesc[9] = (uint8_t)(ulSpan >> 16);
+            pbDesc[10] = (uint8_t)(ulSpan >> 8);
+            pbDesc[11] = (uint8_t)ulSpan;
+
+            ulLba += ulSpan;
+            ulBlocks -= ulSpan;
+            ulDesc++;
+        }
+
+        ulParamLen = 8U + (ulDesc * 16U);
+        abXfer[0] = (uint8_t)((ulParamLen - 2U) >> 8);
+        abXfer[1] = (uint8_t)(ulParamLen - 2U);
+        abXfer[2] = (uint8_t)((ulDesc * 16U) >> 8);
+        abXfer[3] = (uint8_t)(ulDesc * 16U);
+        abCdb[7] = (uint8_t)(ulParamLen >> 8);
+        abCdb[8] = (uint8_t)ulParamLen;
+
+        ret = MSCBENCH_Command('o', abCdb, sizeof(abCdb), abXfer, ulParamLen);
+        if (ret != 0)
+        {
+            return ret;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief START STOP UNIT with START=0 and LOEJ=1, as an OS sends on "eject"
+ */
+static int32_t MSCBENCH_Eject(void)
+{
+    const uint8_t abCdb[6] = { SCSI_START_STOP_UNIT, 0U, 0U, 0U, 0x02U, 0U };
+
+    return MSCBENCH_Command('-', abCdb, sizeof(abCdb), NULL, 0U);
+}
+
+/**
+ * @brief Configure the device and do what a host does on enumeration:
+ *        INQUIRY, TEST UNIT READY, READ CAPACITY, block limits VPD page
+ *
+ * @return 0 on success, -1 on failure
+ */
+static int32_t MSCBENCH_Attach(void)
+{
+    const uint8_t abInquiry[6] = { SCSI_INQUIRY, 0U, 0U, 0U, STANDARD_INQUIRY_DATA_LEN, 0U };
+    const uint8_t abTur[6] = { SCSI_TEST_UNIT_READY, 0U, 0U, 0U, 0U, 0U };
+    const uint8_t abCap10[10] = { SCSI_READ_CAPACITY10, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U };
+    const uint8_t abCap16[16] = { SCSI_READ_CAPACITY16, 0x10U, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 32U, 0U, 0U };
+    const uint8_t abPageB0[6] = { SCSI_INQUIRY, 0x01U, 0xB0U, 0U, LENGTH_INQUIRY_PAGEB0, 0U };
+    uint32_t ulLastLba;
+
+    /* Open the volume before the device starts, as main() does */
+    if (STORAGE_Open_FS() != USBD_OK)
+    {
+        return -1;
+    }
+
+    if ((USBD_Init(&hUsbDeviceFS, NULL, DEVICE_FS) != USBD_OK) || (USBD_RegisterClass(&hUsbDeviceFS, &USBD_MSC) != USBD_OK) ||
+        (USBD_MSC_RegisterStorage(&hUsbDeviceFS, &USBD_Storage_Interface_fops_FS) != USBD_OK))
+    {
+        return -1;
+    }
+
+    /* SET_CONFIGURATION(1) */
+    hUsbDeviceFS.dev_speed = USBD_SPEED_FULL;
+    hUsbDeviceFS.dev_state = USBD_STATE_CONFIGURED;
+    hUsbDeviceFS.dev_config = 1U;
+    if (USBD_SetClassConfig(&hUsbDeviceFS, 1U) != USBD_OK)
+    {
+        return -1;
+    }
+
+    if ((MSCBENCH_Command('i', abInquiry, sizeof(abInquiry), abXfer, STANDARD_INQUIRY_DATA_LEN) != 0) ||
+        (MSCBENCH_Command('-', abTur, sizeof(abTur), NULL, 0U) != 0) ||
+        (MSCBENCH_Command('i', abCap10, sizeof(abCap10), abXfer, 8U) != 0))
+    {
+        return -1;
+    }
+
+    ulLastLba = ((uint32_t)abXfer[0] << 24) | ((uint32_t)abXfer[1] << 16) | ((uint32_t)abXfer[2] << 8) | (uint32_t)abXfer[3];
+    if ((ulLastLba < MSCBENCH_REGION_BLOCKS) || ((((uint32_t)abXfer[6] << 8) | abXfer[7]) != MSCBENCH_BLOCK_SIZE))
+    {
+        fprintf(stderr, "msc_bench: unexpected capacity %lu x %u\n", (unsigned long)ulLastLba + 1UL, ((unsigned)abXfer[6] << 8) | abXfer[7]);
+        return -1;
+    }
+
+    if ((MSCBENCH_Command('i', abCap16, sizeof(abCap16), abXfer, 32U) != 0) || ((abXfer[14] & 0x80U) == 0U) ||
+        (MSCBENCH_Command('i', abPageB0, sizeof(abPageB0), abXfer, LENGTH_INQUIRY_PAGEB0) != 0))
+    {
+        fprintf(stderr, "msc_bench: LUN does not advertise UNMAP\n");
+        return -1;
+    }
+
+    ulUnmapMaxDesc = ((uint32_t)abXfer[24] << 24) | ((uint32_t)abXfer[25] << 16) | ((uint32_t)abXfer[26] << 8) | (uint32_t)abXfer[27];
+    ulLunBlocks = ulLastLba + 1U;
+
+    return (ulUnmapMaxDesc != 0U) ? 0 : -1;
+}
+
+/**
+ * @brief Run one built-in workload over the test region, checking every read
+ *
+ * @return 0 on success, -1 on a failed command or a data mismatch
+ */
+static int32_t MSCBENCH_Workload(const mscbench_entry *pEntry, mscbench_result *pRes)
+{
+    uint32_t ulCount;
+
+    switch (pEntry->op)
+    {
+        case MSCBENCH_SEQ_WRITE:
+        case MSCBENCH_SEQ_READ:
+            ulCount = MSCBENCH_REGION_BLOCKS / pEntry->ulBlocksPerCmd;
+            break;
+
+        case MSCBENCH_UNMAP:
+            ulCount = 1U;
+            break;
+
+        default:
+            ulCount = pEntry->ulCommands;
+            break;
+    }
+
+    for (uint32_t i = 0; i < ulCount; i++)
+    {
+        uint32_t ulLba = i * pEntry->ulBlocksPerCmd;
+        uint32_t ulBytes = pEntry->ulBlocksPerCmd * MSCBENCH_BLOCK_SIZE;
+        uint8_t *pbImage;
+
+        if ((pEntry->op == MSCBENCH_RAND_WRITE) || (pEntry->op == MSCBENCH_RAND_READ))
+        {
+            ulLba = (MSCBENCH_Rand() % (MSCBENCH_REGION_BLOCKS / pEntry->ulBlocksPerCmd)) * pEntry->ulBlocksPerCmd;
+        }
+        pbImage = &abImage[ulLba * MSCBENCH_BLOCK_SIZE];
+
+        switch (pEntry->op)
+        {
+            case MSCBENCH_SEQ_WRITE:
+            case MSCBENCH_RAND_WRITE:
+                MSCBENCH_Fill(abXfer, ulBytes);
+                if (MSCBENCH_Rw10(SCSI_WRITE10, ulLba, pEntry->ulBlocksPerCmd, abXfer) != 0)
+                {
+                    fprintf(stderr, "msc_bench: %s: WRITE(10) %lu failed\n", pEntry->pszName, (unsigned long)ulLba);
+                    return -1;
+                }
+                memcpy(pbImage, abXfer, ulBytes);
+                break;
+
+            case MSCBENCH_SEQ_READ:
+            case MSCBENCH_RAND_READ:
+                if ((MSCBENCH_Rw10(SCSI_READ10, ulLba, pEntry->ulBlocksPerCmd, abXfer) != 0) || (memcmp(abXfer, pbImage, ulBytes) != 0))
+                {
+                    fprintf(stderr, "msc_bench: %s: READ(10) %lu failed or returned wrong data\n", pEntry->pszName, (unsigned long)ulLba);
+                    return -1;
+                }
+                break;
+
+            case MSCBENCH_UNMAP:
+                ulBytes = 0U;
+                if (MSCBENCH_Unmap(0U, MSCBENCH_REGION_BLOCKS) != 0)
+                {
+                    fprintf(stderr, "msc_bench: %s: UNMAP failed\n", pEntry->pszName);
+                    return -1;
+                }
+                break;
+
+            default:
+                break;
+        }
+
+        pRes->ulCommands++;
+        pRes->ullBytes += ulBytes;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Replay a recorded command stream
+ *
+ * @return 0 on success, -1 if the file cannot be read, a line is malformed or
+ *         a command fails at the protocol level (a failed CSW status is not an error)
+ */
+static int32_t MSCBENCH_Trace(const char *pszTrace, mscbench_result *pRes)
+{
+    FILE *pFile = fopen(pszTrace, "r");
+    char szLine[256];
+    uint32_t ulLine = 0U;
+    uint32_t ulFailed = 0U;
+    int32_t ret = 0;
+
+    if (pFile == NULL)
+    {
+        fprintf(stderr, "msc_bench: cannot open %s\n", pszTrace);
+        return -1;
+    }
+
+    while (fgets(szLine, sizeof(szLine), pFile) != NULL)
+    {
+        uint8_t abCdb[16];
+        uint32_t ulCdbLen = 0U;
+        unsigned long ulLen;
+        char cDir;
+        char *pszPos;
+        int32_t lStatus;
+
+        ulLine++;
+        if ((szLine[0] == '#') || (sscanf(szLine, " %c %lu", &cDir, &ulLen) != 2))
+        {
+            continue;
+        }
+
+        /* CDB bytes: everything after the length, spaces optional */
+        pszPos = strpbrk(szLine, "0123456789");
+        pszPos += strspn(pszPos, "0123456789");
+        while ((*pszPos != '\0') && (ulCdbLen < sizeof(abCdb)))
+        {
+            unsigned int uByte;
+
+            pszPos += strspn(pszPos, " \t\r\n");
+            if (sscanf(pszPos, "%2x", &uByte) != 1)
+            {
+                break;
+            }
+            abCdb[ulCdbLen++] = (uint8_t)uByte;
+            pszPos += 2;
+        }
+
+        if (((cDir != 'i') && (cDir != 'o') && (cDir != '-')) || (ulCdbLen == 0U) || (ulLen > sizeof(abXfer)) ||
+            ((cDir == '-') != (ulLen == 0UL)))
+        {
+            fprintf(stderr, "msc_bench: %s:%lu: malformed command\n", pszTrace, (unsigned long)ulLine);
+            ret = -1;
+            break;
+        }
+
+        if (cDir == 'o')
+        {
+            MSCBENCH_Fill(abXfer, (uint32_t)ulLen);
+        }
+
+        lStatus = MSCBENCH_Command(cDir, abCdb, ulCdbLen, abXfer, (uint32_t)ulLen);
+        if (lStatus < 0)
+        {
+            fprintf(stderr, "msc_bench: %s:%lu: protocol error\n", pszTrace, (unsigned long)ulLine);
+            ret = -1;
+            break;
+        }
+
+        ulFailed += (lStatus != 0) ? 1U : 0U;
+        pRes->ulCommands++;
+        pRes->ullBytes += ulLen;
+    }
+
+    (void)fclose(pFile);
+
+    if (ulFailed != 0U)
+    {
+        printf("# %lu commands completed with a failed status\n", (unsigned long)ulFailed);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Snapshot the counters at the start of a workload
+ */
+static void MSCBENCH_Begin(mscbench_result *pRes, const char *pszName)
+{
+    memset(pRes, 0, sizeof(*pRes));
+    pRes->pszName = pszName;
+    pRes->ullPackets = USBDHOST_PacketsGet();
+    pRes->ullSimNs = MSCBENCH_SimNs();
+    _lx_nor_flash_simulator_stats_get(&pRes->flash);
+    pRes->ullHostNs = MSCBENCH_HostNs();
+}
+
+/**
+ * @brief Turn the snapshots into deltas
+ */
+static void MSCBENCH_End(mscbench_result *pRes)
+{
+    LX_NOR_FLASH_SIMULATOR_STATS now;
+
+    pRes->ullHostNs = MSCBENCH_HostNs() - pRes->ullHostNs;
+    pRes->ullPackets = USBDHOST_PacketsGet() - pRes->ullPackets;
+    pRes->ullSimNs = MSCBENCH_SimNs() - pRes->ullSimNs;
+    _lx_nor_flash_simulator_stats_get(&now);
+    pRes->flash.lx_nor_flash_simulator_busy_ns = now.lx_nor_flash_simulator_busy_ns - pRes->flash.lx_nor_flash_simulator_busy_ns;
+    pRes->flash.lx_nor_flash_simulator_page_programs = now.lx_nor_flash_simulator_page_programs - pRes->flash.lx_nor_flash_simulator_page_programs;
+    pRes->flash.lx_nor_flash_simulator_subsector_erases = now.lx_nor_flash_simulator_subsector_erases - pRes->flash.lx_nor_flash_simulator_subsector_erases;
+    pRes->flash.lx_nor_flash_simulator_sector_erases = now.lx_nor_flash_simulator_sector_erases - pRes->flash.lx_nor_flash_simulator_sector_erases;
+}
+
+/**
+ * @brief Print one result line
+ */
+static void MSCBENCH_Report(const mscbench_result *pRes)
+{
+    const LX_NOR_FLASH_SIMULATOR_STATS *f = &pRes->flash;
+    uint64_t ullWireNs = pRes->ullPackets * MSCBENCH_PACKET_NS;
+    double dSeconds = (double)pRes->ullSimNs / 1e9;
+
+    printf("%-15s %6lu %10llu %9.1f %9.1f %9.1f %8.2f %8llu %6llu %9.1f\n", pRes->pszName, (unsigned long)pRes->ulCommands,
+           (unsigned long long)pRes->ullBytes, (double)ullWireNs / 1e6, (double)f->lx_nor_flash_simulator_busy_ns / 1e6,
+           (double)pRes->ullSimNs / 1e6, (double)pRes->ullHostNs / 1e6, (unsigned long long)f->lx_nor_flash_simulator_page_programs,
+           (unsigned long long)(f->lx_nor_flash_simulator_subsector_erases + f->lx_nor_flash_simulator_sector_erases),
+           (dSeconds > 0.0) ? ((double)pRes->ullBytes / 1024.0 / dSeconds) : 0.0);
+}
+
+/**
+ * @brief Fresh pseudo random data for a write
+ */
+static void MSCBENCH_Fill(uint8_t *pbData, uint32_t ulLen)
+{
+    for (uint32_t i = 0; i < ulLen; i += 4U)
+    {
+        MSCBENCH_Put32(&pbData[i], MSCBENCH_Rand());
+    }
+}
+
+/**
+ * @brief Little endian store (CBW/CSW fields)
+ */
+static void MSCBENCH_Put32(uint8_t *pbDst, uint32_t ulValue)
+{
+    pbDst[0] = (uint8_t)ulValue;
+    pbDst[1] = (uint8_t)(ulValue >> 8);
+    pbDst[2] = (uint8_t)(ulValue >> 16);
+    pbDst[3] = (uint8_t)(ulValue >> 24);
+}
+
+/**
+ * @brief Little endian load (CBW/CSW fields)
+ */
+static uint32_t MSCBENCH_Get32(const uint8_t *pbSrc)
+{
+    return (uint32_t)pbSrc[0] | ((uint32_t)pbSrc[1] << 8) | ((uint32_t)pbSrc[2] << 16) | ((uint32_t)pbSrc[3] << 24);
+}
+
+/**
+ * @brief Monotonic host time in nanoseconds
+ */
+static uint64_t MSCBENCH_HostNs(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Deterministic pseudo random generator (xorshift32), same sequence on every run
+ */
+static uint32_t MSCBENCH_Rand(void)
+{
+    ulRandState ^= ulRandState << 13;
+    ulRandState ^= ulRandState >> 17;
+    ulRandState ^= ulRandState << 5;
+
+    return ulRandState;
+}
+
+/**
+ * @brief Attach the LUN on a factory fresh part
+ *
+ * @param bSerial  Storage work in the endpoint callback (1) or the main loop (0)
+ * @return 0 on success, -1 on failure
+ */
+static int32_t MSCBENCH_Fresh(uint8_t bSerial)
+{
+    /* The LUN opens LevelX again on attach */
+    if (bLunOpen != 0U)
+    {
+        (void)RedOsBDevClose(0U);
+        bLunOpen = 0U;
+    }
+    (void)_lx_nor_flash_simulator_erase_all();
+    _lx_nor_flash_simulator_stats_reset();
+    ulRandState = 1U;
+
+    bSerialMode = bSerial;
+    bInProcess = 0U;
+    ullNowNs = 0U;
+    ullWireFreeNs = 0U;
+    ullCpuFreeNs = 0U;
+    USBDHOST_ClockSet(MSCBENCH_Clock);
+
+    if (MSCBENCH_Attach() != 0)
+    {
+        fprintf(stderr, "msc_bench: attach failed\n");
+        return -1;
+    }
+    bLunOpen = 1U;
+
+    return 0;
+}
+
+/**
+ * @brief Attach the LUN on a factory fresh part, then replay the built-in
+ *        workloads or a trace file
+ *
+ * @param bSerial  Storage work in the endpoint callback (1) or the main loop (0)
+ * @param pszTrace Trace file, NULL for the built-in workloads
+ * @return 0 on success, -1 on failure
+ */
+static int32_t MSCBENCH_Pass(uint8_t bSerial, const char *pszTrace)
+{
+    mscbench_result res;
+
+    if (MSCBENCH_Fresh(bSerial) != 0)
+    {
+        return -1;
+    }
+
+    printf("# LUN %lu blocks of %u bytes, MSC_MEDIA_PACKET %u, UNMAP up to %lu descriptors\n",
+           (unsigned long)ulLunBlocks, (unsigned)MSCBENCH_BLOCK_SIZE, (unsigned)MSC_MEDIA_PACKET, (unsigned long)ulUnmapMaxDesc);
+    printf("# %s: storage work %s\n", (bSerial != 0U) ? "serial" : "overlap",
+           (bSerial != 0U) ? "in the endpoint callback, bus held meanwhile" : "in the main loop, ping-pong media buffers");
+    printf("%-15s %6s %10s %9s %9s %9s %8s %8s %6s %9s\n", "workload", "cmds", "bytes", "wire_ms", "flash_ms", "elapsed", "cpu_ms",
+           "programs", "erases", "KB/s");
+
+    if (pszTrace != NULL)
+    {
+        MSCBENCH_Begin(&res, "trace");
+        if (MSCBENCH_Trace(pszTrace, &res) != 0)
+        {
+            return -1;
+        }
+        MSCBENCH_End(&res);
+        MSCBENCH_Report(&res);
+
+        return 0;
+    }
+
+    for (uint32_t i = 0; i < (sizeof(gaWorkloads) / sizeof(gaWorkloads[0])); i++)
+    {
+        MSCBENCH_Begin(&res, gaWorkloads[i].pszName);
+        if (MSCBENCH_Workload(&gaWorkloads[i], &res) != 0)
+        {
+            return -1;
+        }
+        MSCBENCH_End(&res);
+        MSCBENCH_Report(&res);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Host writes through the LUN, the idle points of the scenario, then a
+ *        power cut and the cold mount of what is on the flash
+ *
+ * @return 0 on success, -1 on failure
+ */
+static int32_t MSCBENCH_Mount(const mscbench_mount *pMount)
+{
+    mscbench_result res;
+    ULONG ulImageWords;
+    ULONG ulCheckpoints;
+    ULONG64 ullOpen;
+    ULONG ulScanned;
+
+    if ((MSCBENCH_Fresh(0U) != 0) || (MSCBENCH_Workload(&gaWorkloads[0], &res) != 0) || (MSCBENCH_Workload(&gaWorkloads[2], &res) != 0))
+    {
+        return -1;
+    }
+
+    if (pMount->bIdle != 0U)
+    {
+        STORAGE_Idle_FS();
+    }
+
+    if (pMount->bTail != 0U)
+    {
+        if (MSCBENCH_Workload(&gTail, &res) != 0)
+        {
+            return -1;
+        }
+
+        if ((pMount->bEject != 0U) && (MSCBENCH_Eject() != 0))
+        {
+            fprintf(stderr, "msc_bench: START STOP UNIT failed\n");
+            return -1;
+        }
+
+        STORAGE_Idle_FS();
+    }
+
+    /* Power cut: keep the flash as it is, the close below only releases the instance */
+    ulCheckpoints = nor_mem_desc.lx_nor_flash_checkpoint_writes;
+    ulImageWords  = (nor_mem_desc.lx_nor_flash_total_blocks + nor_mem_desc.lx_nor_flash_checkpoint_blocks) *
+                    nor_mem_desc.lx_nor_flash_words_per_block;
+    memcpy(pulImage, nor_mem_desc.lx_nor_flash_base_address, ulImageWords * sizeof(ULONG));
+    (void)RedOsBDevClose(0U);
+    bLunOpen = 0U;
+    memcpy(nor_mem_desc.lx_nor_flash_base_address, pulImage, ulImageWords * sizeof(ULONG));
+
+    ullOpen = _lx_nor_flash_simulator_time_get();
+    if (_lx_nor_flash_open(&norMount, "mount", flash_driver_init) != LX_SUCCESS)
+    {
+        fprintf(stderr, "msc_bench: %s: open failed\n", pMount->pszName);
+        return -1;
+    }
+    ullOpen   = _lx_nor_flash_simulator_time_get() - ullOpen;
+    ulScanned = norMount.lx_nor_flash_total_blocks - norMount.lx_nor_flash_checkpoint_trusted_blocks;
+    (void)_lx_nor_flash_close(&norMount);
+
+    printf("%-15s %6lu %8lu %9.3f\n", pMount->pszName, (unsigned long)ulCheckpoints, (unsigned long)ulScanned, (double)ullOpen / 1e6);
+
+    return 0;
+}
+
+/************************************
+ * GLOBAL FUNCTIONS
+ ************************************/
+
+/**
+ * @brief Run the built-in workloads or a trace file, storage work in the
+ *        endpoint callback first, then in the main loop. After the built-in
+ *        workloads, the cold mount table.
+ *
+ * @param pszTrace Trace file, NULL for the built-in workloads
+ * @return 0 on success, -1 on failure
+ */
+int32_t MSCBENCH_Run(const char *pszTrace)
+{
+    int32_t ret = 0;
+
+    printf("# wire: %llu ns per 64 byte packet; rate = bytes / elapsed (simulated)\n", (unsigned long long)MSCBENCH_PACKET_NS);
+
+    if ((MSCBENCH_Pass(1U, pszTrace) != 0) || (MSCBENCH_Pass(0U, pszTrace) != 0))
+    {
+        return -1;
+    }
+
+    if (pszTrace != NULL)
+    {
+        return 0;
+    }
+
+    pulImage = malloc(LX_NOR_SIMULATOR_FLASH_SIZE);
+    if (pulImage == NULL)
+    {
+        return -1;
+    }
+
+    printf("# cold mount: %lu KB written, power cut without a close, LX_NOR_CHECKPOINT_DIRTY_BLOCKS %u\n",
+           (unsigned long)(((MSCBENCH_REGION_BLOCKS + (gaWorkloads[2].ulBlocksPerCmd * gaWorkloads[2].ulCommands)) * MSCBENCH_BLOCK_SIZE) / 1024U),
+           (unsigned)LX_NOR_CHECKPOINT_DIRTY_BLOCKS);
+    printf("%-15s %6s %8s %9s\n", "mount", "ckpts", "scanned", "open_ms");
+
+    for (uint32_t i = 0; (i < (sizeof(gaMounts) / sizeof(gaMounts[0]))) && (ret == 0); i++)
+    {
+        ret = MSCBENCH_Mount(&gaMounts[i]);
+    }
+
+    free(pulImage);
+    pulImage = NULL;
+
+    return ret;
+}
@@ -0,0 +1,52 @@
+/**
+ ********************************************************************************
+ * @file    nor_sim_port.c
+ * @author  SimON
+ * @date    17 окт. 2026 г.
+ * @brief   nor_driver.h entry points backed by the LevelX NOR flash simulator
+ *
+ *          Replaces Drivers/BSP/NOR_QSPI/Src/nor_driver.c in host builds so
+ *          that osbdev.c opens LevelX on the simulated part unchanged.
+ ********************************************************************************
+ */
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include "nor_driver.h"
+#include "lx_nor_flash_simulator.h"
+
+/************************************
+ * GLOBAL FUNCTIONS
+ ************************************/
+
+/**
+ * @brief Attach the simulator to the LevelX instance
+ *
+ * @param instance Driver settings instance
+ * @return status of operation
+ */
+UINT flash_driver_init(LX_NOR_FLASH *instance)
+{
+    return _lx_nor_flash_simulator_initialize(instance);
+}
+
+/**
+ * @brief Nothing to release for the simulator
+ *
+ * @return status of operation
+ */
+UINT flash_driver_deinit(void)
+{
+    return LX_SUCCESS;
+}
+
+/**
+ * @brief Return the whole simulated part to the erased state
+ *
+ * @return status of operation
+ */
+UINT _driver_nor_flash_bulk_erase(void)
+{
+    return _lx_nor_flash_simulator_erase_all();
+}
@@ -0,0 +1,320 @@
+/**
+ ********************************************************************************
+ * @file    norq_bench.c
+ * @author  SimON
+ * @date    17 окт. 2026 г.
+ * @brief   Synchronous vs. queued QSPI flash access over the simulated part
+ *
+ *          A producer prepares NORQBENCH_CHUNK_COUNT chunks (CPU work of a
+ *          given length, e.g. a USB packet or a checksum) and stores each one
+ *          with a PROGRAM request:
+ *
+ *          sync  - work, submit, norq_wait: the CPU idles for the whole page
+ *                  program time like the old polling driver did;
+ *          async - two buffers: chunk N is programmed by the queue while the
+ *                  CPU prepares chunk N + 1.
+ *
+ *          Time is the virtual time line of norq_sim_port.c. Every pass is
+ *          verified with READ requests through the queue.
+ *
+ *          The page pipeline pass programs one erase unit with a single
+ *          request and single words the way LevelX updates its metadata,
+ *          and prints the per-phase timings of the queue against the
+ *          datasheet page program throughput.
+ ********************************************************************************
+ */
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include <stdio.h>
+#include <string.h>
+
+#include "norq_bench.h"
+#include "norq_sim_port.h"
+#include "lx_nor_flash_simulator.h"
+
+/************************************
+ * PRIVATE MACROS AND DEFINES
+ ************************************/
+#define NORQBENCH_CHUNK_SIZE        4096U
+#define NORQBENCH_CHUNK_COUNT       64U
+#define NORQBENCH_AREA_SIZE         (NORQBENCH_CHUNK_SIZE * NORQBENCH_CHUNK_COUNT)
+#define NORQBENCH_WORD_COUNT        1024U
+
+/************************************
+ * STATIC FUNCTION PROTOTYPES
+ ************************************/
+static int32_t NORQBENCH_Pass(uint32_t bAsync, uint64_t ullWorkNs, uint64_t *pullTimeNs);
+static int32_t NORQBENCH_Pipeline(void);
+static void NORQBENCH_Phases(const char *pszName, const norq_stats *pStats);
+static int32_t NORQBENCH_Erase(void);
+static int32_t NORQBENCH_Verify(void);
+static void NORQBENCH_Fill(uint8_t *pBuf, uint32_t ulChunk);
+
+/************************************
+ * STATIC VARIABLES
+ ************************************/
+
+/* CPU work per chunk, ns */
+static const uint64_t aullWorkNs[] = { 0U, 100000U, 1000000U, 3000000U, 10000000U };
+
+static uint8_t abChunk[2][NORQBENCH_CHUNK_SIZE] __attribute__((aligned(4)));
+static uint8_t abCheck[NORQBENCH_CHUNK_SIZE] __attribute__((aligned(4)));
+
+/************************************
+ * STATIC FUNCTIONS
+ ************************************/
+
+/**
+ * @brief Store NORQBENCH_CHUNK_COUNT chunks, each preceded by ullWorkNs of CPU work
+ */
+static int32_t NORQBENCH_Pass(uint32_t bAsync, uint64_t ullWorkNs, uint64_t *pullTimeNs)
+{
+    norq_request req[2];
+    uint64_t ullStart;
+
+    if (NORQBENCH_Erase() != 0)
+    {
+        return -1;
+    }
+
+    memset(req, 0, sizeof(req));
+    ullStart = NORQSIM_TimeGet();
+
+    /* The first chunk can't overlap anything */
+    NORQSIM_Run(ullWorkNs);
+    NORQBENCH_Fill(abChunk[0], 0U);
+
+    for (uint32_t i = 0; i < NORQBENCH_CHUNK_COUNT; i++)
+    {
+        norq_request *pReq = &req[i & 1U];
+
+        pReq->op      = NORQ_OP_PROGRAM;
+        pReq->address = i * NORQBENCH_CHUNK_SIZE;
+        pReq->data    = abChunk[i & 1U];
+        pReq->size    = NORQBENCH_CHUNK_SIZE;
+
+        if (norq_submit(pReq) != LX_SUCCESS)
+        {
+            return -1;
+        }
+
+        if (!bAsync && (norq_wait(pReq) != LX_SUCCESS))
+        {
+            return -1;
+        }
+
+        /* Prepare the next chunk in the other buffer */
+        if ((i + 1U) < NORQBENCH_CHUNK_COUNT)
+        {
+            NORQSIM_Run(ullWorkNs);
+            NORQBENCH_Fill(abChunk[(i + 1U) & 1U], i + 1U);
+        }
+
+        /* The buffer is reused by the next chunk but one */
+        if (bAsync && (norq_wait(pReq) != LX_SUCCESS))
+        {
+            return -1;
+        }
+    }
+
+    *pullTimeNs = NORQSIM_TimeGet() - ullStart;
+
+    return NORQBENCH_Verify();
+}
+
+/**
+ * @brief One request per erase unit, then single word programs
+ */
+static int32_t NORQBENCH_Pipeline(void)
+{
+    LX_NOR_FLASH_SIMULATOR_TIMING timing;
+    norq_request req;
+    norq_stats stats;
+    ULONG ulWord;
+
+    if (NORQBENCH_Erase() != 0)
+    {
+        return -1;
+    }
+
+    _lx_nor_flash_simulator_timing_get(&timing);
+    printf("datasheet page program: %.3f MB/s\n",
+           (double)NORQ_PAGE_SIZE * 1e3 / (double)(timing.lx_nor_flash_simulator_page_program_ns +
+                                                   NORQ_PAGE_SIZE * timing.lx_nor_flash_simulator_write_byte_ns));
+
+    /* Bulk data: one request, 256 page segments */
+    for (uint32_t i = 0; i < NORQBENCH_CHUNK_COUNT / 2U; i++)
+    {
+        NORQBENCH_Fill(abChunk[0], i);
+        memset(&req, 0, sizeof(req));
+        req.op      = NORQ_OP_PROGRAM;
+        req.address = i * NORQBENCH_CHUNK_SIZE + 4U;   /* Unaligned start: partial first and last pages */
+        req.data    = abChunk[0];
+        req.size    = NORQBENCH_CHUNK_SIZE - 8U;
+
+        if (i == 0U)
+        {
+            norq_stats_reset();
+        }
+
+        if ((norq_submit(&req) != LX_SUCCESS) || (norq_wait(&req) != LX_SUCCESS))
+        {
+            return -1;
+        }
+    }
+
+    norq_stats_get(&stats);
+    NORQBENCH_Phases("bulk", &stats);
+
+    /* Metadata: single words */
+    norq_stats_reset();
+    for (uint32_t i = 0; i < NORQBENCH_WORD_COUNT; i++)
+    {
+        ulWord = 0x5A5A0000U | i;
+        memset(&req, 0, sizeof(req));
+        req.op      = NORQ_OP_PROGRAM;
+        req.address = (NORQBENCH_CHUNK_COUNT / 2U) * NORQBENCH_CHUNK_SIZE + i * sizeof(ULONG);
+        req.data    = (UCHAR *)&ulWord;
+        req.size    = sizeof(ULONG);
+
+        if ((norq_submit(&req) != LX_SUCCESS) || (norq_wait(&req) != LX_SUCCESS))
+        {
+            return -1;
+        }
+    }
+
+    norq_stats_get(&stats);
+    NORQBENCH_Phases("word", &stats);
+
+    return 0;
+}
+
+/**
+ * @brief Print the per-phase timings of the queue
+ */
+static void NORQBENCH_Phases(const char *pszName, const norq_stats *pStats)
+{
+    double dPages = (pStats->pages != 0U) ? (double)pStats->pages : 1.0;
+
+    printf("%-6s pages %5lu  data %7.2f us  busy %7.2f us  per page, %.3f MB/s, %.2f us per request\n",
+           pszName, (unsigned long)pStats->pages,
+           (double)pStats->data_ticks / dPages / 1e3, (double)pStats->busy_ticks / dPages / 1e3,
+           (double)pStats->program_bytes * 1e3 / (double)pStats->request_ticks,
+           (double)pStats->request_ticks / (double)pStats->completed / 1e3);
+}
+
+/**
+ * @brief Erase the test area with ERASE requests
+ */
+static int32_t NORQBENCH_Erase(void)
+{
+    norq_request req;
+
+    for (uint32_t ulAddr = 0; ulAddr < NORQBENCH_AREA_SIZE; ulAddr += LX_NOR_SIMULATOR_BLOCK_SIZE)
+    {
+        memset(&req, 0, sizeof(req));
+        req.op      = NORQ_OP_ERASE;
+        req.address = ulAddr;
+        req.size    = LX_NOR_SIMULATOR_BLOCK_SIZE;
+
+        if ((norq_submit(&req) != LX_SUCCESS) || (norq_wait(&req) != LX_SUCCESS))
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Read the test area back with READ requests
+ */
+static int32_t NORQBENCH_Verify(void)
+{
+    norq_request req;
+
+    for (uint32_t i = 0; i < NORQBENCH_CHUNK_COUNT; i++)
+    {
+        memset(&req, 0, sizeof(req));
+        req.op      = NORQ_OP_READ;
+        req.address = i * NORQBENCH_CHUNK_SIZE;
+        req.data    = abCheck;
+        req.size    = NORQBENCH_CHUNK_SIZE;
+
+        if ((norq_submit(&req) != LX_SUCCESS) || (norq_wait(&req) != LX_SUCCESS))
+        {
+            return -1;
+        }
+
+        NORQBENCH_Fill(abChunk[0], i);
+        if (memcmp(abChunk[0], abCheck, NORQBENCH_CHUNK_SIZE) != 0)
+        {
+            fprintf(stderr, "norq_bench: chunk %lu mismatch\n", (unsigned long)i);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Chunk contents depend on the chunk number
+ */
+static void NORQBENCH_Fill(uint8_t *pBuf, uint32_t ulChunk)
+{
+    for (uint32_t i = 0; i < NORQBENCH_CHUNK_SIZE; i++)
+    {
+        pBuf[i] = (uint8_t)((i * 7U) ^ (ulChunk * 13U) ^ (i >> 8));
+    }
+}
+
+/************************************
+ * GLOBAL FUNCTIONS
+ ************************************/
+
+/**
+ * @brief Run the sync/async comparison for every CPU work length
+ *
+ * @return 0 on success, -1 if a request failed or read back data differs
+ */
+int32_t NORQBENCH_Run(void)
+{
+    norq_stats stats;
+
+    NORQSIM_Init();
+
+    printf("%-10s %12s %12s %8s\n", "work_us", "sync_ms", "async_ms", "gain");
+
+    for (uint32_t i = 0; i < (sizeof(aullWorkNs) / sizeof(aullWorkNs[0])); i++)
+    {
+        uint64_t ullSync;
+        uint64_t ullAsync;
+
+        if ((NORQBENCH_Pass(0U, aullWorkNs[i], &ullSync) != 0) ||
+            (NORQBENCH_Pass(1U, aullWorkNs[i], &ullAsync) != 0))
+        {
+            fprintf(stderr, "norq_bench: pass failed\n");
+            return -1;
+        }
+
+        printf("%-10llu %12.3f %12.3f %7.2fx\n",
+               (unsigned long long)(aullWorkNs[i] / 1000U),
+               (double)ullSync / 1e6, (double)ullAsync / 1e6,
+               (double)ullSync / (double)ullAsync);
+    }
+
+    if (NORQBENCH_Pipeline() != 0)
+    {
+        fprintf(stderr, "norq_bench: page pipeline failed\n");
+        return -1;
+    }
+
+    norq_stats_get(&stats);
+    printf("requests %lu completed %lu failed %lu steps %lu waits %lu max_depth %lu\n",
+           (unsigned long)stats.submitted, (unsigned long)stats.completed, (unsigned long)stats.failed,
+           (unsigned long)stats.steps, (unsigned long)stats.waits, (unsigned long)stats.max_depth);
+
+    return (stats.failed == 0U) ? 0 : -1;
+}
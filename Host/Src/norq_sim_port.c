@@ -0,0 +1,306 @@
+/**
+ ********************************************************************************
+ * @file    norq_sim_port.c
+ * @author  SimON
+ * @date    17 окт. 2026 г.
+ * @brief   nor_queue.h hardware port backed by the LevelX NOR flash simulator
+ *
+ *          Runs the request queue state machine of nor_queue.c on a virtual
+ *          time line. Every hardware step is applied to the simulated array at
+ *          once and its completion event (transfer complete / status match) is
+ *          scheduled at the time the QUADSPI would raise the interrupt, using
+ *          the simulator latency model. The CPU side advances the time line
+ *          with NORQSIM_Run (work that overlaps flash busy time) or by waiting
+ *          in norq_wait (idle CPU); due events are delivered to the queue like
+ *          the HAL callbacks do on target, each delivery costs NORQSIM_IRQ_NS
+ *          of CPU time. Synchronous steps (WREN, polled short transfers) take
+ *          CPU time as well.
+ ********************************************************************************
+ */
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include "norq_sim_port.h"
+#include "lx_nor_flash_simulator.h"
+
+/************************************
+ * PRIVATE MACROS AND DEFINES
+ ************************************/
+
+/* Interrupt entry + HAL IRQ handler + callback at 100 MHz */
+#define NORQSIM_IRQ_NS              1500U
+
+/* SysTick period: wakes up norq_wait, time base of the request time limits */
+#define NORQSIM_TICK_NS             1000000U
+
+/************************************
+ * PRIVATE TYPEDEFS
+ ************************************/
+typedef enum
+{
+    NORQSIM_EV_NONE,
+    NORQSIM_EV_TRANSFER,
+    NORQSIM_EV_STATUS
+} norqsim_event;
+
+/************************************
+ * STATIC FUNCTION PROTOTYPES
+ ************************************/
+static UINT NORQSIM_WriteEnable(void);
+static UINT NORQSIM_Read(ULONG ulAddress, UCHAR *pData, ULONG ulSize);
+static UINT NORQSIM_Program(ULONG ulAddress, UCHAR *pData, ULONG ulSize);
+static UINT NORQSIM_Erase(ULONG ulAddress, ULONG ulSize);
+static UINT NORQSIM_PollReady(void);
+static void NORQSIM_Nop(void);
+static void NORQSIM_Wait(void);
+static ULONG NORQSIM_Ticks(void);
+static ULONG NORQSIM_Ms(void);
+static void NORQSIM_Abort(void);
+static void NORQSIM_Schedule(norqsim_event event, ULONG64 ullAt);
+static void NORQSIM_Fire(void);
+
+/************************************
+ * STATIC VARIABLES
+ ************************************/
+static const norq_port gSimPort =
+{
+    NORQSIM_WriteEnable,
+    NORQSIM_Read,
+    NORQSIM_Program,
+    NORQSIM_Erase,
+    NORQSIM_PollReady,
+    NORQSIM_Nop,
+    NORQSIM_Nop,
+    NORQSIM_Wait,
+    NORQSIM_Nop,
+    NORQSIM_Nop,
+    NORQSIM_Ticks,
+    NORQSIM_Ms,
+    NORQSIM_Abort
+};
+
+static LX_NOR_FLASH                     gSimFlash;      /* Only used for the simulator services and base address */
+static LX_NOR_FLASH_SIMULATOR_TIMING    gTiming;
+static ULONG64                          ullNow;         /* Virtual time line, ns */
+static ULONG64                          ullReadyAt;     /* End of the program/erase busy time */
+static ULONG64                          ullEventAt;
+static norqsim_event                    pendingEvent;
+
+/************************************
+ * GLOBAL FUNCTIONS
+ ************************************/
+
+/**
+ * @brief Attach the request queue to the simulated part
+ */
+void NORQSIM_Init(void)
+{
+    _lx_nor_flash_simulator_initialize(&gSimFlash);
+    _lx_nor_flash_simulator_timing_get(&gTiming);
+
+    ullNow       = 0;
+    ullReadyAt   = 0;
+    ullEventAt   = 0;
+    pendingEvent = NORQSIM_EV_NONE;
+
+    norq_init(&gSimPort);
+}
+
+/**
+ * @brief Current virtual time
+ *
+ * @return time in ns
+ */
+ULONG64 NORQSIM_TimeGet(void)
+{
+    return ullNow;
+}
+
+/**
+ * @brief CPU works for ullNs, flash events due in this window are delivered
+ *
+ * @param ullNs CPU time in ns
+ */
+void NORQSIM_Run(ULONG64 ullNs)
+{
+    /* Interrupts steal CPU time from the work */
+    while ((pendingEvent != NORQSIM_EV_NONE) && (ullEventAt <= ullNow + ullNs))
+    {
+        if (ullEventAt > ullNow)
+        {
+            ullNs -= ullEventAt - ullNow;
+            ullNow = ullEventAt;
+        }
+        NORQSIM_Fire();
+    }
+
+    ullNow += ullNs;
+}
+
+/************************************
+ * STATIC FUNCTIONS
+ ************************************/
+
+/* WREN + one polled status read, the CPU waits */
+static UINT NORQSIM_WriteEnable(void)
+{
+    ullNow += gTiming.lx_nor_flash_simulator_write_enable_ns;
+    return LX_SUCCESS;
+}
+
+static UINT NORQSIM_Read(ULONG ulAddress, UCHAR *pData, ULONG ulSize)
+{
+    ULONG64 ullTransferEnd;
+
+    if (((ulAddress | ulSize) & (sizeof(ULONG) - 1U)) != 0U)
+    {
+        return LX_ERROR;
+    }
+
+    if (gSimFlash.lx_nor_flash_driver_read(gSimFlash.lx_nor_flash_base_address + (ulAddress / sizeof(ULONG)),
+                                           (ULONG *)pData, ulSize / sizeof(ULONG)) != LX_SUCCESS)
+    {
+        return LX_ERROR;
+    }
+
+    ullTransferEnd = ullNow + gTiming.lx_nor_flash_simulator_command_ns +
+                     (ULONG64)ulSize * gTiming.lx_nor_flash_simulator_read_byte_ns;
+
+    /* Short transfer in polling mode, completion is reported before returning */
+    if (ulSize <= NORQ_PIO_MAX_SIZE)
+    {
+        ullNow = ullTransferEnd;
+        norq_on_transfer_complete();
+        return LX_SUCCESS;
+    }
+
+    NORQSIM_Schedule(NORQSIM_EV_TRANSFER, ullTransferEnd);
+    return LX_SUCCESS;
+}
+
+static UINT NORQSIM_Program(ULONG ulAddress, UCHAR *pData, ULONG ulSize)
+{
+    ULONG64 ullTransferEnd;
+
+    if (((ulAddress | ulSize) & (sizeof(ULONG) - 1U)) != 0U)
+    {
+        return LX_ERROR;
+    }
+
+    if (gSimFlash.lx_nor_flash_driver_write(gSimFlash.lx_nor_flash_base_address + (ulAddress / sizeof(ULONG)),
+                                            (ULONG *)pData, ulSize / sizeof(ULONG)) != LX_SUCCESS)
+    {
+        return LX_ERROR;
+    }
+
+    /* DMA completes after the data phase, the part stays busy for tPP */
+    ullTransferEnd = ullNow + gTiming.lx_nor_flash_simulator_command_ns +
+                     (ULONG64)ulSize * gTiming.lx_nor_flash_simulator_write_byte_ns;
+    ullReadyAt     = ullTransferEnd + gTiming.lx_nor_flash_simulator_page_program_ns;
+
+    if (ulSize <= NORQ_PIO_MAX_SIZE)
+    {
+        ullNow = ullTransferEnd;
+        norq_on_transfer_complete();
+        return LX_SUCCESS;
+    }
+
+    NORQSIM_Schedule(NORQSIM_EV_TRANSFER, ullTransferEnd);
+    return LX_SUCCESS;
+}
+
+static UINT NORQSIM_Erase(ULONG ulAddress, ULONG ulSize)
+{
+    ULONG ulBlockSize = gSimFlash.lx_nor_flash_words_per_block * sizeof(ULONG);
+
+    /* The simulator erases whole LevelX blocks */
+    if ((ulSize != ulBlockSize) || ((ulAddress % ulBlockSize) != 0U))
+    {
+        return LX_ERROR;
+    }
+
+    if (gSimFlash.lx_nor_flash_driver_block_erase(ulAddress / ulBlockSize, 0) != LX_SUCCESS)
+    {
+        return LX_ERROR;
+    }
+
+    ullReadyAt = ullNow + gTiming.lx_nor_flash_simulator_command_ns;
+    if ((ulSize % LX_NOR_SIMULATOR_SECTOR_SIZE) == 0U)
+    {
+        ullReadyAt += (ULONG64)(ulSize / LX_NOR_SIMULATOR_SECTOR_SIZE) * gTiming.lx_nor_flash_simulator_sector_erase_ns;
+    }
+    else
+    {
+        ullReadyAt += (ULONG64)(ulSize / LX_NOR_SIMULATOR_SUBSECTOR_SIZE) * gTiming.lx_nor_flash_simulator_subsector_erase_ns;
+    }
+
+    return NORQSIM_PollReady();
+}
+
+static UINT NORQSIM_PollReady(void)
+{
+    NORQSIM_Schedule(NORQSIM_EV_STATUS, (ullReadyAt > ullNow) ? ullReadyAt : ullNow);
+    return LX_SUCCESS;
+}
+
+static void NORQSIM_Nop(void)
+{
+}
+
+/* Idle CPU: jump to the next event, or to the next SysTick if nothing is in flight */
+static void NORQSIM_Wait(void)
+{
+    if (pendingEvent != NORQSIM_EV_NONE)
+    {
+        if (ullEventAt > ullNow)
+        {
+            ullNow = ullEventAt;
+        }
+        NORQSIM_Fire();
+    }
+    else
+    {
+        ullNow += NORQSIM_TICK_NS;
+    }
+}
+
+static ULONG NORQSIM_Ticks(void)
+{
+    return (ULONG)ullNow;
+}
+
+static ULONG NORQSIM_Ms(void)
+{
+    return (ULONG)(ullNow / NORQSIM_TICK_NS);
+}
+
+/* The aborted step raises no interrupt */
+static void NORQSIM_Abort(void)
+{
+    pendingEvent = NORQSIM_EV_NONE;
+}
+
+static void NORQSIM_Schedule(norqsim_event event, ULONG64 ullAt)
+{
+    pendingEvent = event;
+    ullEventAt   = ullAt;
+}
+
+/* Deliver the pending event like the HAL callbacks do */
+static void NORQSIM_Fire(void)
+{
+    norqsim_event event = pendingEvent;
+
+    pendingEvent = NORQSIM_EV_NONE;
+    ullNow      += NORQSIM_IRQ_NS;
+
+    if (event == NORQSIM_EV_TRANSFER)
+    {
+        norq_on_transfer_complete();
+    }
+    else if (event == NORQSIM_EV_STATUS)
+    {
+        norq_on_status_match();
+    }
+}
@@ -0,0 +1,302 @@
+/**
+ ********************************************************************************
+ * @file    policy_bench.c
+ * @author  SimON
+ * @date    17 окт. 2026 г.
+ * @brief   LevelX reclaim policies: write amplification and wear under skew
+ *
+ *          LevelX is driven directly on POLICYBENCH_AREA_SIZE of the default
+ *          64 KB geometry with the mapping table and extended cache of
+ *          osbdev.c. For every workload and reclaim policy the logical space
+ *          is filled to POLICYBENCH_FILL_PCT percent, overwritten for
+ *          POLICYBENCH_WARMUP_ROUNDS rounds to reach a steady state, then for
+ *          POLICYBENCH_ROUNDS measured rounds. Skewed workloads send a share
+ *          of the overwrites to a small hot part of the logical space, the
+ *          rest goes to the cold part; all picks are uniform within a part.
+ *
+ *          Reported per workload and policy: write amplification (bytes
+ *          programmed per byte written) and erases of the measured rounds,
+ *          then the lowest and highest block erase count and their spread
+ *          at the end. Every logical sector is read back and checked, and
+ *          the instance counts must add up.
+ ********************************************************************************
+ */
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include <stdio.h>
+#include <string.h>
+
+#include "policy_bench.h"
+#include "lx_api.h"
+#include "lx_nor_flash_simulator.h"
+
+#ifdef LX_NOR_ENABLE_RECLAIM_POLICY
+
+/************************************
+ * PRIVATE MACROS AND DEFINES
+ ************************************/
+#define POLICYBENCH_AREA_SIZE       (4U * 1024U * 1024U)
+#define POLICYBENCH_BLOCK_SIZE      65536U
+#define POLICYBENCH_FILL_PCT        80U
+#define POLICYBENCH_WARMUP_ROUNDS   2U
+#define POLICYBENCH_ROUNDS          8U
+#define POLICYBENCH_MAPPING_TABLE   32640U  /* BDEV_MAPPING_TABLE_SECTORS, osbdev.c */
+#define POLICYBENCH_EXTENDED_CACHE  (12U * 1024U)  /* BDEV_EXTENDED_CACHE_SIZE, osbdev.c */
+#define POLICYBENCH_MAX_SECTORS     (POLICYBENCH_AREA_SIZE / (LX_NOR_SECTOR_SIZE * sizeof(ULONG)))
+
+/************************************
+ * PRIVATE TYPEDEFS
+ ************************************/
+typedef struct
+{
+    const char         *pszName;
+    ULONG               ulHotWritePct;      /* Share of the overwrites that go to the hot part */
+    ULONG               ulHotSpacePct;      /* Size of the hot part, percent of the logical space */
+} policybench_workload;
+
+typedef struct
+{
+    const char         *pszName;
+    UINT                uiPolicy;           /* LX_NOR_RECLAIM_POLICY_* */
+} policybench_policy;
+
+/************************************
+ * STATIC FUNCTION PROTOTYPES
+ ************************************/
+static int32_t POLICYBENCH_Scenario(const policybench_workload *pWorkload, const policybench_policy *pPolicy);
+static int32_t POLICYBENCH_Overwrite(const policybench_workload *pWorkload, ULONG ulLogical, ULONG ulWrites);
+static void POLICYBENCH_Fill(ULONG ulSector, ULONG ulVersion);
+static uint32_t POLICYBENCH_Rand(void);
+
+/************************************
+ * STATIC VARIABLES
+ ************************************/
+static const policybench_workload gaWorkloads[] =
+{
+    { "uniform",        0U,     0U  },
+    { "hot_80_20",      80U,    20U },
+    { "hot_95_5",       95U,    5U  },
+};
+
+static const policybench_policy gaPolicies[] =
+{
+    { "greedy",         LX_NOR_RECLAIM_POLICY_GREEDY       },
+    { "cost_benefit",   LX_NOR_RECLAIM_POLICY_COST_BENEFIT },
+    { "hot_cold",       LX_NOR_RECLAIM_POLICY_HOT_COLD     },
+};
+
+static LX_NOR_FLASH norFlash;
+static LX_NOR_MAPPING_TABLE_TYPE ausMappingTable[POLICYBENCH_MAPPING_TABLE];
+static ULONG aulExtendedCache[POLICYBENCH_EXTENDED_CACHE / sizeof(ULONG)];
+static ULONG aulSector[LX_NOR_SECTOR_SIZE];
+static ULONG aulCheck[LX_NOR_SECTOR_SIZE];
+static ULONG aulVersion[POLICYBENCH_MAX_SECTORS];
+static uint32_t ulRandState = 1U;
+
+/************************************
+ * STATIC FUNCTIONS
+ ************************************/
+
+/**
+ * @brief Fill, warm up, run the measured rounds and verify the area with one workload and policy
+ */
+static int32_t POLICYBENCH_Scenario(const policybench_workload *pWorkload, const policybench_policy *pPolicy)
+{
+    LX_NOR_FLASH_SIMULATOR_STATS before;
+    LX_NOR_FLASH_SIMULATOR_STATS after;
+    ULONG ulLogical;
+    ULONG ulMinErase = LX_ALL_ONES;
+    ULONG ulMaxErase = 0;
+    uint64_t ullErases;
+
+    (void)_lx_nor_flash_simulator_erase_all();
+    if ((_lx_nor_flash_open(&norFlash, (CHAR *)pPolicy->pszName, _lx_nor_flash_simulator_initialize) != LX_SUCCESS) ||
+        (_lx_nor_flash_mapping_table_enable(&norFlash, ausMappingTable, sizeof(ausMappingTable)) != LX_SUCCESS) ||
+        (_lx_nor_flash_extended_cache_enable(&norFlash, aulExtendedCache, sizeof(aulExtendedCache)) != LX_SUCCESS) ||
+        (_lx_nor_flash_reclaim_policy_set(&norFlash, pPolicy->uiPolicy) != LX_SUCCESS))
+    {
+        return -1;
+    }
+
+    ulLogical = (norFlash.lx_nor_flash_total_physical_sectors * POLICYBENCH_FILL_PCT) / 100U;
+
+    /* Initial fill and warm up are not measured */
+    for (ULONG i = 0; i < ulLogical; i++)
+    {
+        aulVersion[i] = 0;
+        POLICYBENCH_Fill(i, 0);
+        if (_lx_nor_flash_sector_write(&norFlash, i, aulSector) != LX_SUCCESS)
+        {
+            return -1;
+        }
+    }
+
+    ulRandState = 1U;
+    if (POLICYBENCH_Overwrite(pWorkload, ulLogical, ulLogical * POLICYBENCH_WARMUP_ROUNDS) != 0)
+    {
+        return -1;
+    }
+
+    _lx_nor_flash_simulator_stats_get(&before);
+    if (POLICYBENCH_Overwrite(pWorkload, ulLogical, ulLogical * POLICYBENCH_ROUNDS) != 0)
+    {
+        return -1;
+    }
+    _lx_nor_flash_simulator_stats_get(&after);
+
+    if ((norFlash.lx_nor_flash_free_physical_sectors + norFlash.lx_nor_flash_mapped_physical_sectors +
+         norFlash.lx_nor_flash_obsolete_physical_sectors) != norFlash.lx_nor_flash_total_physical_sectors)
+    {
+        fprintf(stderr, "policy_bench: %s: instance counts do not add up\n", pPolicy->pszName);
+        return -1;
+    }
+
+    /* Every sector must read back its last version */
+    for (ULONG i = 0; i < ulLogical; i++)
+    {
+        POLICYBENCH_Fill(i, aulVersion[i]);
+        if ((_lx_nor_flash_sector_read(&norFlash, i, aulCheck) != LX_SUCCESS) ||
+            (memcmp(aulSector, aulCheck, sizeof(aulSector)) != 0))
+        {
+            fprintf(stderr, "policy_bench: %s: sector %lu mismatch\n", pPolicy->pszName, (unsigned long)i);
+            return -1;
+        }
+    }
+
+    /* Wear of every block, from the erase count word of its header */
+    for (ULONG i = 0; i < norFlash.lx_nor_flash_total_blocks; i++)
+    {
+        ULONG ulErase = norFlash.lx_nor_flash_base_address[i * norFlash.lx_nor_flash_words_per_block] & LX_BLOCK_ERASE_COUNT_MASK;
+
+        ulMinErase = (ulErase < ulMinErase) ? ulErase : ulMinErase;
+        ulMaxErase = (ulErase > ulMaxErase) ? ulErase : ulMaxErase;
+    }
+
+    (void)_lx_nor_flash_close(&norFlash);
+
+    if ((after.lx_nor_flash_simulator_system_errors != 0U) || (after.lx_nor_flash_simulator_program_violations != 0U))
+    {
+        return -1;
+    }
+
+    ullErases = (after.lx_nor_flash_simulator_sector_erases + after.lx_nor_flash_simulator_subsector_erases) -
+                (before.lx_nor_flash_simulator_sector_erases + before.lx_nor_flash_simulator_subsector_erases);
+
+    printf("%-10s %-12s %8.3f %7llu %7lu %7lu %7lu\n",
+           pWorkload->pszName, pPolicy->pszName,
+           (double)(after.lx_nor_flash_simulator_bytes_programmed - before.lx_nor_flash_simulator_bytes_programmed) /
+           ((double)ulLogical * POLICYBENCH_ROUNDS * LX_NOR_SECTOR_SIZE * sizeof(ULONG)),
+           (unsigned long long)ullErases, (unsigned long)ulMinErase, (unsigned long)ulMaxErase,
+           (unsigned long)(ulMaxErase - ulMinErase));
+
+    return 0;
+}
+
+/**
+ * @brief Overwrites picked by the workload: the hot part is the start of the logical space
+ */
+static int32_t POLICYBENCH_Overwrite(const policybench_workload *pWorkload, ULONG ulLogical, ULONG ulWrites)
+{
+    ULONG ulHot = (ulLogical * pWorkload->ulHotSpacePct) / 100U;
+
+    for (ULONG i = 0; i < ulWrites; i++)
+    {
+        ULONG ulSector;
+
+        if ((POLICYBENCH_Rand() % 100U) < pWorkload->ulHotWritePct)
+        {
+            ulSector = POLICYBENCH_Rand() % ulHot;
+        }
+        else
+        {
+            ulSector = ulHot + (POLICYBENCH_Rand() % (ulLogical - ulHot));
+        }
+
+        POLICYBENCH_Fill(ulSector, ++aulVersion[ulSector]);
+        if (_lx_nor_flash_sector_write(&norFlash, ulSector, aulSector) != LX_SUCCESS)
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Sector contents depend on the logical sector and its version
+ */
+static void POLICYBENCH_Fill(ULONG ulSector, ULONG ulVersion)
+{
+    for (ULONG i = 0; i < LX_NOR_SECTOR_SIZE; i++)
+    {
+        aulSector[i] = (ulSector << 16) ^ (ulVersion << 8) ^ i;
+    }
+}
+
+/**
+ * @brief Deterministic pseudo random generator (xorshift32), same sequence on every run
+ */
+static uint32_t POLICYBENCH_Rand(void)
+{
+    ulRandState ^= ulRandState << 13;
+    ulRandState ^= ulRandState >> 17;
+    ulRandState ^= ulRandState << 5;
+
+    return ulRandState;
+}
+
+#endif /* LX_NOR_ENABLE_RECLAIM_POLICY */
+
+/************************************
+ * GLOBAL FUNCTIONS
+ ************************************/
+
+/**
+ * @brief Run every workload with every reclaim policy
+ *
+ * @return 0 on success, -1 if LevelX failed or read back data differs
+ */
+int32_t POLICYBENCH_Run(void)
+{
+#ifdef LX_NOR_ENABLE_RECLAIM_POLICY
+    ULONG ulBlockSize;
+    ULONG ulTotalBlocks;
+    int32_t ret = 0;
+
+    _lx_nor_flash_simulator_geometry_get(&ulBlockSize, &ulTotalBlocks);
+    if (_lx_nor_flash_simulator_geometry_set(POLICYBENCH_BLOCK_SIZE, POLICYBENCH_AREA_SIZE / POLICYBENCH_BLOCK_SIZE) != LX_SUCCESS)
+    {
+        return -1;
+    }
+    _lx_nor_flash_initialize();
+
+    printf("# area %u KB of %u KB blocks, fill %u%%, %u warm up and %u measured overwrite rounds, erase count delta %u\n",
+           (unsigned)(POLICYBENCH_AREA_SIZE / 1024U), (unsigned)(POLICYBENCH_BLOCK_SIZE / 1024U), (unsigned)POLICYBENCH_FILL_PCT,
+           (unsigned)POLICYBENCH_WARMUP_ROUNDS, (unsigned)POLICYBENCH_ROUNDS, (unsigned)LX_NOR_FLASH_MAX_ERASE_COUNT_DELTA);
+    printf("%-10s %-12s %8s %7s %7s %7s %7s\n", "workload", "policy", "wamp", "erases", "ec_min", "ec_max", "spread");
+
+    for (uint32_t i = 0; (i < (sizeof(gaWorkloads) / sizeof(gaWorkloads[0]))) && (ret == 0); i++)
+    {
+        for (uint32_t j = 0; j < (sizeof(gaPolicies) / sizeof(gaPolicies[0])); j++)
+        {
+            if (POLICYBENCH_Scenario(&gaWorkloads[i], &gaPolicies[j]) != 0)
+            {
+                fprintf(stderr, "policy_bench: %s/%s failed\n", gaWorkloads[i].pszName, gaPolicies[j].pszName);
+                ret = -1;
+                break;
+            }
+        }
+    }
+
+    /* Leave the simulator as found */
+    (void)_lx_nor_flash_simulator_geometry_set(ulBlockSize, ulTotalBlocks);
+
+    return ret;
+#else
+    printf("# LX_NOR_ENABLE_RECLAIM_POLICY is not defined\n");
+
+    return 0;
+#endif
+}
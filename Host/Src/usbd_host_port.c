@@ -0,0 +1,399 @@
+/**
+ ********************************************************************************
+ * @file    usbd_host_port.c
+ * @author  SimON
+ * @date    17 окт. 2026 г.
+ * @brief   USB device low level driver (usbd_core.h USBD_LL_*) for host builds
+ *
+ *          Replaces Middlewares/USBFS/usb_device_app/Target/usbd_conf.c: there
+ *          is no PCD, each endpoint just remembers the buffer armed by
+ *          USBD_LL_Transmit / USBD_LL_PrepareReceive. A test plays the USB host
+ *          with USBDHOST_Out / USBDHOST_In, which move the data and then run the
+ *          same USBD_LL_DataOutStage / USBD_LL_DataInStage callbacks the PCD
+ *          interrupt would. Every transfer is counted in full speed bulk packets
+ *          and every arm is stamped with the test's clock (USBDHOST_ClockSet),
+ *          so the test can tell when the transfer could start on the wire.
+ ********************************************************************************
+ */
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include <string.h>
+
+#include "usbd_core.h"
+#include "usbd_msc.h"
+#include "usbd_host_port.h"
+
+/************************************
+ * PRIVATE MACROS AND DEFINES
+ ************************************/
+#define USBDHOST_EP_COUNT   16U
+
+/************************************
+ * PRIVATE TYPEDEFS
+ ************************************/
+typedef struct
+{
+    uint8_t    *pbBuf;          /* Armed buffer */
+    uint32_t    ulLen;          /* Armed length */
+    uint32_t    ulRxSize;       /* Bytes received by the last OUT transfer */
+    uint64_t    ullArmNs;       /* Clock when the buffer was armed */
+    uint8_t     bArmed;
+    uint8_t     bStalled;
+} usbdhost_ep;
+
+/************************************
+ * STATIC FUNCTION PROTOTYPES
+ ************************************/
+static usbdhost_ep *USBDHOST_Ep(uint8_t bEpAddr);
+static void USBDHOST_Count(uint32_t ulLen);
+static void USBDHOST_Arm(uint8_t bEpAddr, uint8_t *pbBuf, uint32_t ulLen);
+
+/************************************
+ * STATIC VARIABLES
+ ************************************/
+static usbdhost_ep aEpIn[USBDHOST_EP_COUNT];
+static usbdhost_ep aEpOut[USBDHOST_EP_COUNT];
+static uint64_t ullPackets;
+static usbdhost_clock pfnNow;
+
+/************************************
+ * STATIC FUNCTIONS
+ ************************************/
+
+/**
+ * @brief Endpoint state from an endpoint address (bit 7 set for IN)
+ */
+static usbdhost_ep *USBDHOST_Ep(uint8_t bEpAddr)
+{
+    uint8_t bNum = bEpAddr & 0x0FU;
+
+    return ((bEpAddr & 0x80U) != 0U) ? &aEpIn[bNum] : &aEpOut[bNum];
+}
+
+/**
+ * @brief Count the bulk packets of one transfer
+ */
+static void USBDHOST_Count(uint32_t ulLen)
+{
+    ullPackets += USBDHOST_PacketsOf(ulLen);
+}
+
+/**
+ * @brief Arm a transfer (USBD_LL_Transmit / USBD_LL_PrepareReceive)
+ */
+static void USBDHOST_Arm(uint8_t bEpAddr, uint8_t *pbBuf, uint32_t ulLen)
+{
+    usbdhost_ep *pEp = USBDHOST_Ep(bEpAddr);
+
+    pEp->pbBuf = pbBuf;
+    pEp->ulLen = ulLen;
+    pEp->ullArmNs = (pfnNow != NULL) ? pfnNow() : 0U;
+    pEp->bArmed = 1U;
+}
+
+/************************************
+ * GLOBAL FUNCTIONS
+ ************************************/
+
+/**
+ * @brief Host sends data to an OUT endpoint, the device takes at most the
+ *        length it armed (the PCD completes the transfer there)
+ *
+ * @param pdev    Device handle
+ * @param bEpAddr OUT endpoint address
+ * @param pbData  Data
+ * @param ulLen   Length
+ * @return bytes taken by the device, -1 if the endpoint is stalled or not armed
+ */
+int32_t USBDHOST_Out(USBD_HandleTypeDef *pdev, uint8_t bEpAddr, const uint8_t *pbData, uint32_t ulLen)
+{
+    usbdhost_ep *pEp = USBDHOST_Ep(bEpAddr);
+
+    if ((pEp->bStalled != 0U) || (pEp->bArmed == 0U))
+    {
+        return -1;
+    }
+
+    if (ulLen > pEp->ulLen)
+    {
+        ulLen = pEp->ulLen;
+    }
+
+    if (ulLen != 0U)
+    {
+        memcpy(pEp->pbBuf, pbData, ulLen);
+    }
+    pEp->ulRxSize = ulLen;
+    pEp->bArmed = 0U;
+    USBDHOST_Count(ulLen);
+
+    return (USBD_LL_DataOutStage(pdev, bEpAddr & 0x7FU, pEp->pbBuf) == USBD_OK) ? (int32_t)ulLen : -1;
+}
+
+/**
+ * @brief Host reads the transfer armed on an IN endpoint
+ *
+ * @param pdev    Device handle
+ * @param bEpAddr IN endpoint address
+ * @param pbData  Destination
+ * @param ulMax   Destination size
+ * @param pulLen  Bytes received
+ * @return 0 on success, -1 if the endpoint is stalled, has nothing armed or
+ *         the transfer does not fit
+ */
+int32_t USBDHOST_In(USBD_HandleTypeDef *pdev, uint8_t bEpAddr, uint8_t *pbData, uint32_t ulMax, uint32_t *pulLen)
+{
+    usbdhost_ep *pEp = USBDHOST_Ep(bEpAddr);
+
+    if ((pEp->bStalled != 0U) || (pEp->bArmed == 0U) || (pEp->ulLen > ulMax))
+    {
+        return -1;
+    }
+
+    /* Copy before the callback, which may rearm the same buffer */
+    if (pEp->ulLen != 0U)
+    {
+        memcpy(pbData, pEp->pbBuf, pEp->ulLen);
+    }
+    *pulLen = pEp->ulLen;
+    pEp->bArmed = 0U;
+    USBDHOST_Count(pEp->ulLen);
+
+    return (USBD_LL_DataInStage(pdev, bEpAddr & 0x7FU, pEp->pbBuf) == USBD_OK) ? 0 : -1;
+}
+
+/**
+ * @brief Whether the device stalled an endpoint
+ */
+uint8_t USBDHOST_IsStalled(uint8_t bEpAddr)
+{
+    return USBDHOST_Ep(bEpAddr)->bStalled;
+}
+
+/**
+ * @brief Whether a transfer is armed on an endpoint that is not stalled
+ *
+ * @param bEpAddr   Endpoint address
+ * @param pulLen    Armed length
+ * @param pullArmNs Clock when it was armed
+ * @return 1 if armed, 0 otherwise (outputs untouched)
+ */
+uint8_t USBDHOST_IsArmed(uint8_t bEpAddr, uint32_t *pulLen, uint64_t *pullArmNs)
+{
+    usbdhost_ep *pEp = USBDHOST_Ep(bEpAddr);
+
+    if ((pEp->bStalled != 0U) || (pEp->bArmed == 0U))
+    {
+        return 0U;
+    }
+
+    *pulLen = pEp->ulLen;
+    *pullArmNs = pEp->ullArmNs;
+
+    return 1U;
+}
+
+/**
+ * @brief Host sends a control request without data stage
+ *
+ * @param pdev    Device handle
+ * @param pbSetup 8 byte setup packet
+ */
+void USBDHOST_Setup(USBD_HandleTypeDef *pdev, const uint8_t *pbSetup)
+{
+    uint8_t abSetup[8];
+
+    memcpy(abSetup, pbSetup, sizeof(abSetup));
+
+    /* Setup and status stages */
+    ullPackets += 2U;
+
+    (void)USBD_LL_SetupStage(pdev, abSetup);
+}
+
+/**
+ * @brief Host clears a stall: CLEAR_FEATURE(ENDPOINT_HALT) through the
+ *        standard request path, so the class sees it as on the bus
+ */
+void USBDHOST_ClearStall(USBD_HandleTypeDef *pdev, uint8_t bEpAddr)
+{
+    const uint8_t abSetup[8] = { 0x02U, USB_REQ_CLEAR_FEATURE, USB_FEATURE_EP_HALT, 0x00U, bEpAddr, 0x00U, 0x00U, 0x00U };
+
+    USBDHOST_Setup(pdev, abSetup);
+}
+
+/**
+ * @brief Full speed bulk packets moved since start
+ */
+uint64_t USBDHOST_PacketsGet(void)
+{
+    return ullPackets;
+}
+
+/**
+ * @brief Full speed bulk packets of one transfer (a zero length transfer is one packet)
+ */
+uint32_t USBDHOST_PacketsOf(uint32_t ulLen)
+{
+    return (ulLen == 0U) ? 1U : ((ulLen + USBDHOST_FS_PACKET_SIZE - 1U) / USBDHOST_FS_PACKET_SIZE);
+}
+
+/**
+ * @brief Clock used to stamp armed transfers, NULL for none (stamps are 0)
+ */
+void USBDHOST_ClockSet(usbdhost_clock pfnClock)
+{
+    pfnNow = pfnClock;
+}
+
+USBD_StatusTypeDef USBD_LL_Init(USBD_HandleTypeDef *pdev)
+{
+    UNUSED(pdev);
+
+    memset(aEpIn, 0, sizeof(aEpIn));
+    memset(aEpOut, 0, sizeof(aEpOut));
+
+    return USBD_OK;
+}
+
+USBD_StatusTypeDef USBD_LL_DeInit(USBD_HandleTypeDef *pdev)
+{
+    UNUSED(pdev);
+
+    return USBD_OK;
+}
+
+USBD_StatusTypeDef USBD_LL_Start(USBD_HandleTypeDef *pdev)
+{
+    UNUSED(pdev);
+
+    return USBD_OK;
+}
+
+USBD_StatusTypeDef USBD_LL_Stop(USBD_HandleTypeDef *pdev)
+{
+    UNUSED(pdev);
+
+    return USBD_OK;
+}
+
+USBD_StatusTypeDef USBD_LL_OpenEP(USBD_HandleTypeDef *pdev, uint8_t ep_addr, uint8_t ep_type, uint16_t ep_mps)
+{
+    UNUSED(pdev);
+    UNUSED(ep_type);
+    UNUSED(ep_mps);
+
+    memset(USBDHOST_Ep(ep_addr), 0, sizeof(usbdhost_ep));
+
+    return USBD_OK;
+}
+
+USBD_StatusTypeDef USBD_LL_CloseEP(USBD_HandleTypeDef *pdev, uint8_t ep_addr)
+{
+    UNUSED(pdev);
+
+    USBDHOST_Ep(ep_addr)->bArmed = 0U;
+
+    return USBD_OK;
+}
+
+/**
+ * @brief The OTG core only empties the FIFO, a transfer armed on the endpoint stays armed
+ */
+USBD_StatusTypeDef USBD_LL_FlushEP(USBD_HandleTypeDef *pdev, uint8_t ep_addr)
+{
+    UNUSED(pdev);
+    UNUSED(ep_addr);
+
+    return USBD_OK;
+}
+
+USBD_StatusTypeDef USBD_LL_StallEP(USBD_HandleTypeDef *pdev, uint8_t ep_addr)
+{
+    UNUSED(pdev);
+
+    USBDHOST_Ep(ep_addr)->bStalled = 1U;
+
+    return USBD_OK;
+}
+
+USBD_StatusTypeDef USBD_LL_ClearStallEP(USBD_HandleTypeDef *pdev, uint8_t ep_addr)
+{
+    UNUSED(pdev);
+
+    USBDHOST_Ep(ep_addr)->bStalled = 0U;
+
+    return USBD_OK;
+}
+
+uint8_t USBD_LL_IsStallEP(USBD_HandleTypeDef *pdev, uint8_t ep_addr)
+{
+    UNUSED(pdev);
+
+    return USBDHOST_Ep(ep_addr)->bStalled;
+}
+
+USBD_StatusTypeDef USBD_LL_SetUSBAddress(USBD_HandleTypeDef *pdev, uint8_t dev_addr)
+{
+    UNUSED(pdev);
+    UNUSED(dev_addr);
+
+    return USBD_OK;
+}
+
+USBD_StatusTypeDef USBD_LL_Transmit(USBD_HandleTypeDef *pdev, uint8_t ep_addr, uint8_t *pbuf, uint32_t size)
+{
+    UNUSED(pdev);
+
+    USBDHOST_Arm(ep_addr, pbuf, size);
+
+    return USBD_OK;
+}
+
+USBD_StatusTypeDef USBD_LL_PrepareReceive(USBD_HandleTypeDef *pdev, uint8_t ep_addr, uint8_t *pbuf, uint32_t size)
+{
+    UNUSED(pdev);
+
+    USBDHOST_Arm(ep_addr, pbuf, size);
+
+    return USBD_OK;
+}
+
+uint32_t USBD_LL_GetRxDataSize(USBD_HandleTypeDef *pdev, uint8_t ep_addr)
+{
+    UNUSED(pdev);
+
+    return USBDHOST_Ep(ep_addr)->ulRxSize;
+}
+
+USBD_StatusTypeDef USBD_LL_SetTestMode(USBD_HandleTypeDef *pdev, uint8_t testmode)
+{
+    UNUSED(pdev);
+    UNUSED(testmode);
+
+    return USBD_OK;
+}
+
+void USBD_LL_Delay(uint32_t Delay)
+{
+    UNUSED(Delay);
+}
+
+/**
+ * @brief Static single allocation for the MSC class handle (as on target)
+ */
+void *USBD_static_malloc(uint32_t size)
+{
+    static uint32_t mem[(sizeof(USBD_MSC_BOT_HandleTypeDef) / 4U) + 1U];
+
+    UNUSED(size);
+
+    return mem;
+}
+
+void USBD_static_free(void *p)
+{
+    UNUSED(p);
+}
@@ -257,11 +257,61 @@ typedef unsigned long long                      ULONG64;
 #ifndef LX_NOR_EXTENDED_CACHE_SIZE
 #define LX_NOR_EXTENDED_CACHE_SIZE                  8           /* Maximum number of extended cache sectors.            */
 #endif
+#ifndef LX_NOR_EXTENDED_CACHE_WAYS
+#define LX_NOR_EXTENDED_CACHE_WAYS                  4           /* Extended cache sectors per hash set.                  */
+#endif
+#ifndef LX_NOR_SECTORS_WRITE_BATCH
+#define LX_NOR_SECTORS_WRITE_BATCH                  8           /* Sectors staged per batch by _lx_nor_flash_sectors_write. */
+#endif
 #ifdef LX_NOR_ENABLE_OBSOLETE_COUNT_CACHE
 #ifndef LX_NOR_OBSOLETE_COUNT_CACHE_TYPE
 #define LX_NOR_OBSOLETE_COUNT_CACHE_TYPE            UCHAR
 #endif
 #endif
+#ifdef LX_NOR_ENABLE_MAPPING_TABLE
+#ifndef LX_NOR_MAPPING_TABLE_TYPE
+#define LX_NOR_MAPPING_TABLE_TYPE                   USHORT      /* Must hold the total number of physical sectors.      */
+#endif
+#define LX_NOR_MAPPING_TABLE_ENTRY_FREE             ((LX_NOR_MAPPING_TABLE_TYPE) ~((LX_NOR_MAPPING_TABLE_TYPE) 0))
+#endif
+#ifdef LX_NOR_ENABLE_CHECKPOINT
+#ifndef LX_NOR_CHECKPOINT_DIRTY_BLOCKS
+#define LX_NOR_CHECKPOINT_DIRTY_BLOCKS              16          /* Changed blocks that make an idle checkpoint worth it. */
+#endif
+#define LX_NOR_CHECKPOINT_MAGIC                     ((ULONG) 0x4C58434B)
+#define LX_NOR_CHECKPOINT_MAGIC_OFFSET              0
+#define LX_NOR_CHECKPOINT_SEQUENCE_OFFSET           1
+#define LX_NOR_CHECKPOINT_BLOCKS_OFFSET             2
+#define LX_NOR_CHECKPOINT_SECTORS_OFFSET            3
+#define LX_NOR_CHECKPOINT_FREE_OFFSET               4
+#define LX_NOR_CHECKPOINT_MAPPED_OFFSET             5
+#define LX_NOR_CHECKPOINT_OBSOLETE_OFFSET           6
+#define LX_NOR_CHECKPOINT_CRC_OFFSET                7
+#define LX_NOR_CHECKPOINT_HEADER_WORDS              8
+#define LX_NOR_CHECKPOINT_SUMMARY_WORDS             2           /* Erase count word, free | obsolete << 16.              */
+#define LX_NOR_CHECKPOINT_OBSOLETE_SHIFT            16
+#define LX_NOR_CHECKPOINT_COUNT_MASK                0xFFFF
+#endif
+#ifdef LX_NOR_ENABLE_BACKGROUND_RECLAIM
+#ifndef LX_NOR_BACKGROUND_RECLAIM_OBSOLETE_BLOCKS
+#define LX_NOR_BACKGROUND_RECLAIM_OBSOLETE_BLOCKS   2           /* Obsolete sectors, in blocks, that start a reclaim.    */
+#endif
+#ifndef LX_NOR_BACKGROUND_RECLAIM_MOVE_TIME
+#define LX_NOR_BACKGROUND_RECLAIM_MOVE_TIME         3500        /* Microseconds charged for moving one sector.          */
+#endif
+#ifndef LX_NOR_BACKGROUND_RECLAIM_ERASE_TIME
+#define LX_NOR_BACKGROUND_RECLAIM_ERASE_TIME        702000      /* Microseconds charged for erasing one block.          */
+#endif
+#endif
+#ifdef LX_NOR_ENABLE_BLOCK_STATS
+#define LX_NOR_BLOCK_STATS_NONE                     ((USHORT) 0xFFFF)
+#define LX_NOR_BLOCK_STATS_BUCKETS(words_per_block) ((words_per_block) / LX_NOR_SECTOR_SIZE)
+#endif
+#ifdef LX_NOR_ENABLE_RECLAIM_POLICY
+#define LX_NOR_RECLAIM_POLICY_GREEDY                0           /* Most obsolete sectors, the default.                  */
+#define LX_NOR_RECLAIM_POLICY_COST_BENEFIT          1           /* Obsolete sectors times age over the cost.            */
+#define LX_NOR_RECLAIM_POLICY_HOT_COLD              2           /* Cost-benefit, relocated sectors written apart.       */
+#endif
 
 
 /* Define the mask for the hash index into the sector mapping cache table.  The sector mapping cache is divided 
@@ -295,6 +345,16 @@ typedef unsigned long long                      ULONG64;
 
 #endif
 
+/* Check reclaim policy configuration.  */
+#if defined(LX_NOR_ENABLE_RECLAIM_POLICY) && !defined(LX_NOR_ENABLE_BLOCK_STATS)
+#error "To enable reclaim policies, you need to define LX_NOR_ENABLE_BLOCK_STATS."
+#endif
+
+/* Check RAM allocation configuration.  */
+#if defined(LX_NOR_ENABLE_RAM_ALLOCATE) && !defined(LX_NOR_ENABLE_BLOCK_STATS)
+#error "To enable RAM allocation, you need to define LX_NOR_ENABLE_BLOCK_STATS."
+#endif
+
 /* Define NAND flash constants.  */
 
 #define LX_NAND_GOOD_BLOCK                          0xFF
@@ -563,10 +623,48 @@ typedef struct LX_NOR_FLASH_EXTENDED_CACHE_ENTRY_STRUCT
 {
     ULONG                           *lx_nor_flash_extended_cache_entry_sector_address; 
     ULONG                           *lx_nor_flash_extended_cache_entry_sector_memory;
-    ULONG                           lx_nor_flash_extended_cache_entry_access_count;
+    ULONG                           lx_nor_flash_extended_cache_entry_access_stamp;
 } LX_NOR_FLASH_EXTENDED_CACHE_ENTRY;
 
 
+/* Define the NOR flash extended cache statistics structure.  */
+
+typedef struct LX_NOR_FLASH_EXTENDED_CACHE_STATS_STRUCT
+{
+    ULONG                           lx_nor_flash_extended_cache_stats_entries;
+    ULONG                           lx_nor_flash_extended_cache_stats_hits;
+    ULONG                           lx_nor_flash_extended_cache_stats_misses;
+    ULONG                           lx_nor_flash_extended_cache_stats_mapping_bitmap_max_logical_sector;
+    ULONG                           lx_nor_flash_extended_cache_stats_mapping_bitmap_hits;
+    ULONG                           lx_nor_flash_extended_cache_stats_mapping_bitmap_misses;
+    ULONG                           lx_nor_flash_extended_cache_stats_obsolete_count_max_block;
+    ULONG                           lx_nor_flash_extended_cache_stats_obsolete_count_hits;
+    ULONG                           lx_nor_flash_extended_cache_stats_obsolete_count_misses;
+} LX_NOR_FLASH_EXTENDED_CACHE_STATS;
+
+
+#ifdef LX_NOR_ENABLE_BLOCK_STATS
+
+/* Define the NOR flash block statistics structure, one per block.  */
+
+typedef struct LX_NOR_FLASH_BLOCK_STATS_STRUCT
+{
+    ULONG                           lx_nor_flash_block_stats_erase_count;
+    ULONG                           lx_nor_flash_block_stats_min_logical_sector;
+    ULONG                           lx_nor_flash_block_stats_max_logical_sector;
+    USHORT                          lx_nor_flash_block_stats_free_sectors;
+    USHORT                          lx_nor_flash_block_stats_mapped_sectors;
+    USHORT                          lx_nor_flash_block_stats_obsolete_sectors;
+    USHORT                          lx_nor_flash_block_stats_next;
+    USHORT                          lx_nor_flash_block_stats_previous;
+    USHORT                          lx_nor_flash_block_stats_reserved;
+#ifdef LX_NOR_ENABLE_RECLAIM_POLICY
+    ULONG                           lx_nor_flash_block_stats_write_time;
+#endif
+} LX_NOR_FLASH_BLOCK_STATS;
+#endif
+
+
 /* Determine if the flash control block has an extension defined. If not, 
    define the extension to whitespace.  */
 
@@ -639,9 +737,53 @@ typedef struct LX_NOR_FLASH_STRUCT
     LX_NOR_SECTOR_MAPPING_CACHE_ENTRY   
                                     lx_nor_flash_sector_mapping_cache[LX_NOR_SECTOR_MAPPING_CACHE_SIZE];
 
+#ifdef LX_NOR_ENABLE_MAPPING_TABLE
+    LX_NOR_MAPPING_TABLE_TYPE       *lx_nor_flash_mapping_table;
+    ULONG                           lx_nor_flash_mapping_table_max_logical_sector;
+    ULONG                           lx_nor_flash_mapping_table_hits;
+    ULONG                           lx_nor_flash_mapping_table_complete;
+#endif
+
+#ifdef LX_NOR_ENABLE_CHECKPOINT
+    ULONG                           lx_nor_flash_checkpoint_blocks;
+    ULONG                           *lx_nor_flash_checkpoint_block_map;
+    ULONG                           *lx_nor_flash_checkpoint_record;
+    ULONG                           lx_nor_flash_checkpoint_record_words;
+    ULONG                           lx_nor_flash_checkpoint_sequence;
+    ULONG                           lx_nor_flash_checkpoint_dirty_blocks;
+    ULONG                           lx_nor_flash_checkpoint_trusted_blocks;
+    ULONG                           lx_nor_flash_checkpoint_writes;
+#endif
+
+#ifdef LX_NOR_ENABLE_BACKGROUND_RECLAIM
+    ULONG                           lx_nor_flash_background_reclaim_block;
+    ULONG                           lx_nor_flash_background_reclaim_sector;
+    ULONG                           lx_nor_flash_background_reclaim_erase_count;
+    ULONG                           lx_nor_flash_background_reclaim_moves;
+    ULONG                           lx_nor_flash_background_reclaim_erases;
+#endif
+
+#ifdef LX_NOR_ENABLE_BLOCK_STATS
+    LX_NOR_FLASH_BLOCK_STATS        *lx_nor_flash_block_stats;
+    USHORT                          *lx_nor_flash_block_stats_buckets;
+    ULONG                           lx_nor_flash_block_stats_highest_bucket;
+#endif
+
+#ifdef LX_NOR_ENABLE_RECLAIM_POLICY
+    UINT                            lx_nor_flash_reclaim_policy;
+    UINT                            (*lx_nor_flash_reclaim_policy_victim_find)(struct LX_NOR_FLASH_STRUCT *nor_flash, ULONG *return_erase_block, 
+                                                    ULONG *return_erase_count, ULONG *return_mapped_sectors, ULONG *return_obsolete_sectors);
+    ULONG                           lx_nor_flash_reclaim_policy_clock;
+    ULONG                           lx_nor_flash_reclaim_policy_relocate_search;
+    UINT                            lx_nor_flash_reclaim_policy_relocating;
+#endif
+
 #ifndef LX_NOR_DISABLE_EXTENDED_CACHE
 
     UINT                            lx_nor_flash_extended_cache_entries;
+    UINT                            lx_nor_flash_extended_cache_ways;
+    UINT                            lx_nor_flash_extended_cache_sets;
+    ULONG                           lx_nor_flash_extended_cache_access_stamp;
     LX_NOR_FLASH_EXTENDED_CACHE_ENTRY
                                     lx_nor_flash_extended_cache[LX_NOR_EXTENDED_CACHE_SIZE];
     ULONG                           lx_nor_flash_extended_cache_hits;
@@ -649,11 +791,15 @@ typedef struct LX_NOR_FLASH_STRUCT
 #ifdef LX_NOR_ENABLE_MAPPING_BITMAP
     ULONG                           *lx_nor_flash_extended_cache_mapping_bitmap;
     ULONG                           lx_nor_flash_extended_cache_mapping_bitmap_max_logical_sector;
+    ULONG                           lx_nor_flash_extended_cache_mapping_bitmap_hits;
+    ULONG                           lx_nor_flash_extended_cache_mapping_bitmap_misses;
 #endif
 #ifdef LX_NOR_ENABLE_OBSOLETE_COUNT_CACHE
     LX_NOR_OBSOLETE_COUNT_CACHE_TYPE
                                     *lx_nor_flash_extended_cache_obsolete_count;
     ULONG                           lx_nor_flash_extended_cache_obsolete_count_max_block;
+    ULONG                           lx_nor_flash_extended_cache_obsolete_count_hits;
+    ULONG                           lx_nor_flash_extended_cache_obsolete_count_misses;
 #endif      
 #endif
 
@@ -676,6 +822,68 @@ typedef struct LX_NOR_FLASH_STRUCT
 } LX_NOR_FLASH;
 
 
+/* When LX_NOR_ENABLE_CHECKPOINT is defined, the driver initialization may reserve the 
+   lx_nor_flash_checkpoint_blocks erase blocks that follow the managed blocks for fast-mount 
+   checkpoints and supply lx_nor_flash_checkpoint_block_map, one RAM bit per managed block. 
+   The area is a log of fixed size records, each rounded up to whole NOR sectors:
+
+    Offset              Meaning
+
+    0           Magic, programmed last. Cleared to 0 once a newer record is complete
+    4           Sequence number, the valid record with the highest one is used
+    8           Total blocks
+    12          Physical sectors per block
+    16          Free physical sectors
+    20          Mapped physical sectors
+    24          Obsolete physical sectors
+    28          CRC-32 of the block summaries followed by the words at offset 4 to 24
+    32          Block summaries, 8 bytes per block: the erase count word of the block,
+                then free sectors in bits 0-15 and obsolete sectors in bits 16-31
+    .           Changed block bit map, where a value of 0 indicates the block was 
+                written or erased after the record. Left erased when the record is
+                written, bits are cleared before the block is first modified
+
+   Open takes the summaries of unchanged blocks from the newest valid record and only 
+   scans the changed ones.  */
+
+
+/* When LX_NOR_ENABLE_BLOCK_STATS is defined, the driver initialization may supply 
+   lx_nor_flash_block_stats, one entry per managed block, and lx_nor_flash_block_stats_buckets,
+   LX_NOR_BLOCK_STATS_BUCKETS(lx_nor_flash_words_per_block) USHORT list heads. Open fills the 
+   table from its scan (or the checkpoint) and the sector writes, releases, reclaim moves and 
+   erases keep it current, so the choice of the next block to erase reads no flash. Each block 
+   is linked into the bucket of its obsolete sector count, the buckets are searched from the 
+   highest one down. The minimum and maximum logical sector of an entry cover every sector 
+   allocated in the block since its erase, 0 to LX_NOR_LOGICAL_SECTOR_MASK when the block was 
+   taken from a checkpoint and the range is not known.  
+
+   When LX_NOR_ENABLE_RAM_ALLOCATE is also defined, the table serves the physical sector allocation.
+   Free sectors are taken from the lowest bit of the free bit map up, so the free sectors of a block
+   are always its last ones and the free sector count of an entry mirrors the bit map: the next free 
+   sector is lx_nor_flash_physical_sectors_per_block minus the count. Full blocks are passed over in 
+   RAM and the minimum and maximum logical sector written when a block fills come from the entry. 
+   That range may also cover sectors obsoleted since, only a block with an unknown range has its 
+   mapping list read.  */
+
+
+/* When LX_NOR_ENABLE_RECLAIM_POLICY is defined, lx_nor_flash_reclaim_policy_set selects how the 
+   next block to erase is chosen from the block statistics table:
+
+    LX_NOR_RECLAIM_POLICY_GREEDY        The block with the most obsolete sectors, as without the option
+    LX_NOR_RECLAIM_POLICY_COST_BENEFIT  The block with the highest obsolete sectors times age over cost,
+                                        where the age is the number of sector allocations since the
+                                        block was last written and the cost is one block's worth of
+                                        sectors for the erase plus the mapped sectors to move
+    LX_NOR_RECLAIM_POLICY_HOT_COLD      Cost-benefit, and the sectors moved out of reclaimed blocks are
+                                        allocated from a search pointer of their own, so they fill 
+                                        other blocks than the sectors written by the application
+
+   All policies keep the erase counts of the chosen blocks within LX_NOR_FLASH_MAX_ERASE_COUNT_DELTA
+   of the minimum while enough sectors are free. The driver initialization may also install its own 
+   lx_nor_flash_reclaim_policy_victim_find, with the semantics of _lx_nor_flash_next_block_to_erase_find. 
+   Ages start over at open.  */
+
+
 /* Each physical NOR block has the following structure at the beginning of the block:
 
     Offset              Meaning
@@ -736,15 +944,22 @@ extern ULONG                                            _lx_nor_flash_opened_cou
 #define lx_nand_flash_256byte_ecc_check                 _lx_nand_flash_256byte_ecc_check
 #define lx_nand_flash_256byte_ecc_compute               _lx_nand_flash_256byte_ecc_compute
 
+#define lx_nor_flash_background_reclaim                 _lx_nor_flash_background_reclaim
+#define lx_nor_flash_checkpoint_write                   _lx_nor_flash_checkpoint_write
 #define lx_nor_flash_close                              _lx_nor_flash_close
 #define lx_nor_flash_defragment                         _lx_nor_flash_defragment
 #define lx_nor_flash_partial_defragment                 _lx_nor_flash_partial_defragment
 #define lx_nor_flash_extended_cache_enable              _lx_nor_flash_extended_cache_enable
+#define lx_nor_flash_extended_cache_stats_get           _lx_nor_flash_extended_cache_stats_get
 #define lx_nor_flash_initialize                         _lx_nor_flash_initialize
+#define lx_nor_flash_mapping_table_enable               _lx_nor_flash_mapping_table_enable
 #define lx_nor_flash_open                               _lx_nor_flash_open
+#define lx_nor_flash_reclaim_policy_set                 _lx_nor_flash_reclaim_policy_set
 #define lx_nor_flash_sector_read                        _lx_nor_flash_sector_read
 #define lx_nor_flash_sector_release                     _lx_nor_flash_sector_release
 #define lx_nor_flash_sector_write                       _lx_nor_flash_sector_write
+#define lx_nor_flash_sectors_read                       _lx_nor_flash_sectors_read
+#define lx_nor_flash_sectors_write                      _lx_nor_flash_sectors_write
 #endif
 
 
@@ -768,15 +983,22 @@ UINT    _lx_nand_flash_sectors_read(LX_NAND_FLASH* nand_flash, ULONG logical_sec
 UINT    _lx_nand_flash_sectors_release(LX_NAND_FLASH* nand_flash, ULONG logical_sector, ULONG sector_count);
 UINT    _lx_nand_flash_sectors_write(LX_NAND_FLASH* nand_flash, ULONG logical_sector, VOID* buffer, ULONG sector_count);
 
+UINT    _lx_nor_flash_background_reclaim(LX_NOR_FLASH *nor_flash, ULONG time_budget, ULONG *time_used);
+UINT    _lx_nor_flash_checkpoint_write(LX_NOR_FLASH *nor_flash, ULONG dirty_blocks);
 UINT    _lx_nor_flash_close(LX_NOR_FLASH *nor_flash);
 UINT    _lx_nor_flash_defragment(LX_NOR_FLASH *nor_flash);
 UINT    _lx_nor_flash_extended_cache_enable(LX_NOR_FLASH *nor_flash, VOID *memory, ULONG size);
+UINT    _lx_nor_flash_extended_cache_stats_get(LX_NOR_FLASH *nor_flash, LX_NOR_FLASH_EXTENDED_CACHE_STATS *stats);
 UINT    _lx_nor_flash_initialize(void);
+UINT    _lx_nor_flash_mapping_table_enable(LX_NOR_FLASH *nor_flash, VOID *memory, ULONG size);
 UINT    _lx_nor_flash_open(LX_NOR_FLASH  *nor_flash, CHAR *name, UINT (*nor_driver_initialize)(LX_NOR_FLASH *));
 UINT    _lx_nor_flash_partial_defragment(LX_NOR_FLASH *nor_flash, UINT max_blocks);
+UINT    _lx_nor_flash_reclaim_policy_set(LX_NOR_FLASH *nor_flash, UINT policy);
 UINT    _lx_nor_flash_sector_read(LX_NOR_FLASH *nor_flash, ULONG logical_sector, VOID *buffer);
 UINT    _lx_nor_flash_sector_release(LX_NOR_FLASH *nor_flash, ULONG logical_sector);
 UINT    _lx_nor_flash_sector_write(LX_NOR_FLASH *nor_flash, ULONG logical_sector, VOID *buffer);
+UINT    _lx_nor_flash_sectors_read(LX_NOR_FLASH *nor_flash, ULONG logical_sector, VOID *buffer, ULONG sector_count);
+UINT    _lx_nor_flash_sectors_write(LX_NOR_FLASH *nor_flash, ULONG logical_sector, VOID *buffer, ULONG sector_count);
 
 
 /* Internal LevelX prototypes.  */
@@ -809,13 +1031,31 @@ UINT    _lx_nand_flash_256byte_ecc_check(UCHAR *page_buffer, UCHAR *ecc_buffer);
 UINT    _lx_nand_flash_256byte_ecc_compute(UCHAR *page_buffer, UCHAR *ecc_buffer);
 
 UINT    _lx_nor_flash_block_reclaim(LX_NOR_FLASH *nor_flash);
+VOID    _lx_nor_flash_block_stats_allocate(LX_NOR_FLASH *nor_flash, ULONG block, ULONG logical_sector);
+VOID    _lx_nor_flash_block_stats_bucket_move(LX_NOR_FLASH *nor_flash, ULONG block, ULONG obsolete_sectors);
+VOID    _lx_nor_flash_block_stats_build(LX_NOR_FLASH *nor_flash);
+VOID    _lx_nor_flash_block_stats_erase(LX_NOR_FLASH *nor_flash, ULONG block, ULONG erase_count);
+VOID    _lx_nor_flash_block_stats_obsolete(LX_NOR_FLASH *nor_flash, ULONG *mapping_address);
+UINT    _lx_nor_flash_block_stats_sector_allocate(LX_NOR_FLASH *nor_flash, ULONG logical_sector, ULONG *search_pointer, ULONG search_blocks, 
+                                                  ULONG other_block, ULONG **physical_sector_map_entry, ULONG **physical_sector_address);
+UINT    _lx_nor_flash_block_stats_victim_find(LX_NOR_FLASH *nor_flash, ULONG *return_erase_block, ULONG *return_erase_count, ULONG *return_mapped_sectors, ULONG *return_obsolete_sectors);
+UINT    _lx_nor_flash_block_reclaim_erase(LX_NOR_FLASH *nor_flash, ULONG erase_block, ULONG erase_count, ULONG obsolete_sectors);
+UINT    _lx_nor_flash_block_reclaim_sector_move(LX_NOR_FLASH *nor_flash, ULONG erase_block, ULONG sector, ULONG list_word);
+UINT    _lx_nor_flash_checkpoint_block_dirty(LX_NOR_FLASH *nor_flash, ULONG block);
+UINT    _lx_nor_flash_checkpoint_block_get(LX_NOR_FLASH *nor_flash, ULONG block, ULONG *erase_count, ULONG *free_sectors, ULONG *obsolete_sectors);
+ULONG   _lx_nor_flash_checkpoint_crc(ULONG crc, ULONG *words, ULONG count);
+UINT    _lx_nor_flash_checkpoint_load(LX_NOR_FLASH *nor_flash);
 UINT    _lx_nor_flash_driver_block_erase(LX_NOR_FLASH *nor_flash, ULONG block, ULONG erase_count);
 UINT    _lx_nor_flash_driver_read(LX_NOR_FLASH *nor_flash, ULONG *flash_address, ULONG *destination, ULONG words);
 UINT    _lx_nor_flash_driver_write(LX_NOR_FLASH *nor_flash, ULONG *flash_address, ULONG *source, ULONG words);
 VOID    _lx_nor_flash_internal_error(LX_NOR_FLASH *nor_flash, ULONG error_code);
+LX_NOR_FLASH_EXTENDED_CACHE_ENTRY
+        *_lx_nor_flash_extended_cache_entry_find(LX_NOR_FLASH *nor_flash, ULONG *sector_address, LX_NOR_FLASH_EXTENDED_CACHE_ENTRY **victim_entry);
+VOID    _lx_nor_flash_mapping_table_update(LX_NOR_FLASH *nor_flash, ULONG logical_sector, ULONG *physical_sector_map_entry);
 UINT    _lx_nor_flash_logical_sector_find(LX_NOR_FLASH *nor_flash, ULONG logical_sector, ULONG superceded_check, ULONG **physical_sector_map_entry, ULONG **physical_sector_address);
 UINT    _lx_nor_flash_next_block_to_erase_find(LX_NOR_FLASH *nor_flash, ULONG *return_erase_block, ULONG *return_erase_count, ULONG *return_mapped_sectors, ULONG *return_obsolete_sectors);
 UINT    _lx_nor_flash_physical_sector_allocate(LX_NOR_FLASH *nor_flash, ULONG logical_sector, ULONG **physical_sector_map_entry, ULONG **physical_sector_address);
+UINT    _lx_nor_flash_reclaim_policy_cost_benefit_find(LX_NOR_FLASH *nor_flash, ULONG *return_erase_block, ULONG *return_erase_count, ULONG *return_mapped_sectors, ULONG *return_obsolete_sectors);
 VOID    _lx_nor_flash_sector_mapping_cache_invalidate(LX_NOR_FLASH *nor_flash, ULONG logical_sector);
 VOID    _lx_nor_flash_system_error(LX_NOR_FLASH *nor_flash, UINT error_code);
 
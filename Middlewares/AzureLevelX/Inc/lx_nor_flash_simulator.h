@@ -0,0 +1,105 @@
+/**************************************************************************/
+/**************************************************************************/
+/**                                                                       */
+/** LevelX Component                                                      */
+/**                                                                       */
+/**   NOR Flash Simulator                                                 */
+/**                                                                       */
+/**************************************************************************/
+/**************************************************************************/
+
+
+/**************************************************************************/
+/*                                                                        */
+/*  COMPONENT DEFINITION                                   RELEASE        */
+/*                                                                        */
+/*    lx_nor_flash_simulator.h                            PORTABLE C      */
+/*                                                                        */
+/*  DESCRIPTION                                                           */
+/*                                                                        */
+/*    This file defines the RAM backed NOR flash simulator used to run    */
+/*    LevelX (and the file system above it) on a host without the QSPI   */
+/*    part. The simulator implements the same five driver services as    */
+/*    nor_driver.c, enforces NOR programming semantics and accumulates   */
+/*    the device busy time of every operation using a configurable       */
+/*    latency model. Defaults follow the Micron N25Q128A datasheet.       */
+/*                                                                        */
+/**************************************************************************/
+
+#ifndef LX_NOR_FLASH_SIMULATOR_H
+#define LX_NOR_FLASH_SIMULATOR_H
+
+#ifdef __cplusplus
+extern   "C" {
+#endif
+
+#include "lx_api.h"
+
+
+/* Define the simulated part. The defaults mirror the N25Q128A and the geometry used by nor_driver.c.
+   The block geometry can be changed at run time with _lx_nor_flash_simulator_geometry_set, it is
+   applied by the next _lx_nor_flash_simulator_initialize.  */
+
+#ifndef LX_NOR_SIMULATOR_FLASH_SIZE
+#define LX_NOR_SIMULATOR_FLASH_SIZE                 (16 * 1024 * 1024)  /* 128 Mbit                                 */
+#endif
+#define LX_NOR_SIMULATOR_PAGE_SIZE                  256                 /* Page program buffer, address wraps       */
+#define LX_NOR_SIMULATOR_SUBSECTOR_SIZE             4096                /* Smallest erase unit                      */
+#define LX_NOR_SIMULATOR_SECTOR_SIZE                65536               /* Large erase unit                         */
+#ifndef LX_NOR_SIMULATOR_BLOCK_SIZE
+#define LX_NOR_SIMULATOR_BLOCK_SIZE                 LX_NOR_SIMULATOR_SECTOR_SIZE
+#endif
+#ifndef LX_NOR_SIMULATOR_TOTAL_BLOCKS
+#define LX_NOR_SIMULATOR_TOTAL_BLOCKS               ((LX_NOR_SIMULATOR_FLASH_SIZE / LX_NOR_SIMULATOR_BLOCK_SIZE) - 1)
+#endif
+
+
+/* Define the latency model. All values are in nanoseconds.  */
+
+typedef struct LX_NOR_FLASH_SIMULATOR_TIMING_STRUCT
+{
+    ULONG                           lx_nor_flash_simulator_command_ns;          /* Instruction, address and dummy phases    */
+    ULONG                           lx_nor_flash_simulator_read_byte_ns;        /* Quad I/O data phase, per byte            */
+    ULONG                           lx_nor_flash_simulator_write_byte_ns;       /* Quad input data phase, per byte          */
+    ULONG                           lx_nor_flash_simulator_write_enable_ns;     /* WREN plus the WEL status poll            */
+    ULONG                           lx_nor_flash_simulator_page_program_ns;     /* tPP, program busy time of one page       */
+    ULONG                           lx_nor_flash_simulator_subsector_erase_ns;  /* tSSE, 4 KB erase busy time               */
+    ULONG                           lx_nor_flash_simulator_sector_erase_ns;     /* tSE, 64 KB erase busy time               */
+} LX_NOR_FLASH_SIMULATOR_TIMING;
+
+
+/* Define the simulator counters.  */
+
+typedef struct LX_NOR_FLASH_SIMULATOR_STATS_STRUCT
+{
+    ULONG64                         lx_nor_flash_simulator_read_commands;
+    ULONG64                         lx_nor_flash_simulator_bytes_read;
+    ULONG64                         lx_nor_flash_simulator_write_requests;
+    ULONG64                         lx_nor_flash_simulator_page_programs;
+    ULONG64                         lx_nor_flash_simulator_bytes_programmed;
+    ULONG64                         lx_nor_flash_simulator_subsector_erases;
+    ULONG64                         lx_nor_flash_simulator_sector_erases;
+    ULONG64                         lx_nor_flash_simulator_erased_verifies;
+    ULONG64                         lx_nor_flash_simulator_program_violations;  /* Attempts to program a 0 bit back to 1    */
+    ULONG64                         lx_nor_flash_simulator_system_errors;
+    ULONG64                         lx_nor_flash_simulator_busy_ns;             /* Accumulated device time                  */
+} LX_NOR_FLASH_SIMULATOR_STATS;
+
+
+/* Define the simulator services.  */
+
+UINT    _lx_nor_flash_simulator_initialize(LX_NOR_FLASH *nor_flash);
+UINT    _lx_nor_flash_simulator_erase_all(VOID);
+UINT    _lx_nor_flash_simulator_geometry_set(ULONG block_size, ULONG total_blocks);
+VOID    _lx_nor_flash_simulator_geometry_get(ULONG *block_size, ULONG *total_blocks);
+VOID    _lx_nor_flash_simulator_timing_set(const LX_NOR_FLASH_SIMULATOR_TIMING *timing);
+VOID    _lx_nor_flash_simulator_timing_get(LX_NOR_FLASH_SIMULATOR_TIMING *timing);
+VOID    _lx_nor_flash_simulator_stats_get(LX_NOR_FLASH_SIMULATOR_STATS *stats);
+VOID    _lx_nor_flash_simulator_stats_reset(VOID);
+ULONG64 _lx_nor_flash_simulator_time_get(VOID);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
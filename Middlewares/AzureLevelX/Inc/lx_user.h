@@ -65,10 +65,12 @@
 
 /* Defined, this option bypasses the NOR flash driver read routine in favor or reading 
    the NOR memory directly, resulting in a significant performance increase. 
+   nor_driver.c keeps the QSPI bank memory-mapped at 0x90000000 while no program/erase 
+   is running. The host build leaves it off so the simulator accounts every read.
 */
-/*
+#ifndef LX_HOST_BUILD
 #define LX_DIRECT_READ
-*/
+#endif
 
 
 /* Defined, this causes the LevelX NOR instance open logic to verify free NOR 
@@ -91,10 +93,12 @@
 */
 
 /* By default this value is 8, which represents a maximum of 8 sectors that 
-   can be cached in a NOR instance.
+   can be cached in a NOR instance. The cache is hashed, so the lookup cost does not grow with this value.
+   Only one word metadata reads fill the cache, with LX_DIRECT_READ (the target build) these are read
+   from the memory-mapped bank, so the sector cache is inactive on target and osbdev.c gives it no memory.
 */
 
-#define LX_NOR_EXTENDED_CACHE_SIZE   8 
+#define LX_NOR_EXTENDED_CACHE_SIZE   64 
 
 
 
@@ -129,27 +133,109 @@
 
 /* Determine if logical sector mapping bitmap should be enabled in extended cache. 
    Cache memory will be allocated to sector mapping bitmap first. One bit can be allocated for each physical sector.  */
-/* 
+
 #define LX_NOR_ENABLE_MAPPING_BITMAP
-*/
+
 
 /* Determine if obsolete count cache should be enabled in extended cache.  
    Cache memory will be allocated to obsolete count cache after the mapping bitmap if enabled, 
    and the rest of the cache memory is allocated to sector cache.  */
-/* 
+
 #define LX_NOR_ENABLE_OBSOLETE_COUNT_CACHE
-*/
+
 
 /* Defines obsolete count cache element size. If number of sectors per block is greater than 256, use USHORT instead of UCHAR.  */
 /* 
 #define LX_NOR_OBSOLETE_COUNT_CACHE_TYPE            UCHAR
 */
 
-/* Define the logical sector size for NOR flash. The sector size is in units of 32-bit words. 
+/* Defined, this enables the RAM logical to physical sector mapping table of the NOR instance. The table is 
+   supplied with lx_nor_flash_mapping_table_enable after open, one entry per covered logical sector, and turns 
+   the search of a covered sector into a single table access.  */
+
+#define LX_NOR_ENABLE_MAPPING_TABLE
+
+/* Defines mapping table element size. The element must hold the total number of physical sectors of the 
+   NOR instance, USHORT covers up to 65534 physical sectors (32 MB of 512 byte sectors).  */
+/* 
+#define LX_NOR_MAPPING_TABLE_TYPE                   USHORT
+*/
+
+/* Defined, this enables the fast-mount checkpoint of the NOR instance. The driver reserves erase blocks after the
+   managed blocks and lx_nor_flash_checkpoint_write stores the per block erase, free and obsolete counts there at
+   close and at idle points. Blocks are marked in the checkpoint before they are first changed, so open only scans
+   the blocks changed since the last checkpoint (and only those are checked by LX_FREE_SECTOR_DATA_VERIFY).  */
+
+#define LX_NOR_ENABLE_CHECKPOINT
+
+/* Defines the number of blocks changed since the last checkpoint before an idle point writes a new one. Each
+   checkpoint costs a record program (about 2.5 KB with 64 KB blocks), a changed block costs a scan on the next
+   open after a power loss.  */
+/*
+#define LX_NOR_CHECKPOINT_DIRTY_BLOCKS              16
+*/
+
+/* Defined, this enables lx_nor_flash_background_reclaim. Called at idle points with a time budget, it moves the
+   mapped sectors out of the next block to erase one at a time and erases the block once it is empty, so blocks
+   are reclaimed before sector writes have to do it inline. It only works while the obsolete sectors exceed
+   LX_NOR_BACKGROUND_RECLAIM_OBSOLETE_BLOCKS blocks' worth.  */
+
+#define LX_NOR_ENABLE_BACKGROUND_RECLAIM
+
+/* Define the time in microseconds the background reclaim charges against its budget for moving one sector and for
+   erasing one block. LevelX has no clock, the defaults are the N25Q typical page program (0.5 ms, seven programs per
+   moved sector) and 64 KB sector erase (0.7 s) times. With 4 KB subsectors use 252000 for the erase.  */
+/*
+#define LX_NOR_BACKGROUND_RECLAIM_MOVE_TIME         3500
+#define LX_NOR_BACKGROUND_RECLAIM_ERASE_TIME        702000
+*/
+
+/* Defines the obsolete sectors, in blocks' worth, above which the background reclaim works. Lower values keep more
+   sectors free for bursts but move more mapped sectors per reclaimed sector.  */
+/*
+#define LX_NOR_BACKGROUND_RECLAIM_OBSOLETE_BLOCKS   2
+*/
+
+/* Defined, this keeps a RAM table of erase, free, mapped and obsolete sector counts per block, bucketed by obsolete
+   count, so the next block to erase is chosen without reading the flash. It only takes effect when the driver
+   initialization supplies the table (24 bytes per block) and the bucket heads, see lx_api.h.  */
+
+#define LX_NOR_ENABLE_BLOCK_STATS
+
+/* Defined, lx_nor_flash_reclaim_policy_set can switch the choice of the next block to erase from greedy (most
+   obsolete sectors) to cost-benefit or hot/cold separated, see lx_api.h. Requires LX_NOR_ENABLE_BLOCK_STATS and
+   adds 4 bytes per block to its table.  */
+
+#define LX_NOR_ENABLE_RECLAIM_POLICY
+
+/* Defined, free physical sectors are allocated from the block statistics table: the search skips full blocks and
+   the free sector is found without reading the bit map, and the minimum and maximum logical sector of a block that
+   fills up are taken from the table instead of its mapping list. Requires LX_NOR_ENABLE_BLOCK_STATS, no extra RAM.  */
+
+#define LX_NOR_ENABLE_RAM_ALLOCATE
+
+/* Define the logical sector size for NOR flash. The sector size is in units of 32-bit words.
    This sector size should match the sector size used in file system.  */
 
 #define LX_NOR_SECTOR_SIZE                          (512/sizeof(ULONG))
 
 
+/* Defined, LevelX is built for a 64-bit host (NOR flash simulator and benchmarks). LevelX relies
+   on ULONG being 32 bits wide, so the basic types are provided here instead of in lx_api.h.  */
+#ifdef LX_HOST_BUILD
+#include <stdint.h>
+#define VOID                                        void
+typedef char                                        CHAR;
+typedef char                                        BOOL;
+typedef unsigned char                               UCHAR;
+typedef int                                         INT;
+typedef unsigned int                                UINT;
+typedef int32_t                                     LONG;
+typedef uint32_t                                    ULONG;
+typedef short                                       SHORT;
+typedef unsigned short                              USHORT;
+#endif
+
+
 #endif
 
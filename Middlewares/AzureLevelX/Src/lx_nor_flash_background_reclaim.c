@@ -0,0 +1,348 @@
+/**************************************************************************/
+/**************************************************************************/
+/**                                                                       */
+/** LevelX Component                                                      */
+/**                                                                       */
+/**   NOR Flash                                                           */
+/**                                                                       */
+/**************************************************************************/
+/**************************************************************************/
+
+#define LX_SOURCE_CODE
+
+
+/* Disable ThreadX error checking.  */
+
+#ifndef LX_DISABLE_ERROR_CHECKING
+#define LX_DISABLE_ERROR_CHECKING
+#endif
+
+
+/* Include necessary system files.  */
+
+#include "lx_api.h"
+
+
+/**************************************************************************/
+/*                                                                        */
+/*  FUNCTION                                               RELEASE        */
+/*                                                                        */
+/*    _lx_nor_flash_background_reclaim                    PORTABLE C      */
+/*                                                                        */
+/*  DESCRIPTION                                                           */
+/*                                                                        */
+/*    This function reclaims blocks ahead of the sector writes, in steps  */
+/*    that fit the time budget. While the obsolete sectors exceed the     */
+/*    watermark it takes the next block to erase and moves its mapped     */
+/*    sectors out one at a time, then erases the block once a full pass   */
+/*    over its mapping list finds nothing left to move. A step is only    */
+/*    started if its charged time (LX_NOR_BACKGROUND_RECLAIM_MOVE_TIME    */
+/*    or _ERASE_TIME) still fits the budget, the block in progress is     */
+/*    kept across calls, so the caller regains control between sector     */
+/*    moves. It must be called while no sector operation is in progress.  */
+/*                                                                        */
+/*    Moved sectors are counted obsolete right away, so the instance      */
+/*    counts, the obsolete count cache and checkpoints stay exact while a */
+/*    block is half reclaimed. A block reclaimed inline in between ends   */
+/*    the step in progress.                                               */
+/*                                                                        */
+/*  INPUT                                                                 */
+/*                                                                        */
+/*    nor_flash                             NOR flash instance            */
+/*    time_budget                           Microseconds available        */
+/*    time_used                             Destination for microseconds  */
+/*                                            charged, 0 when nothing     */
+/*                                            fit (may be NULL)           */
+/*                                                                        */
+/*  OUTPUT                                                                */
+/*                                                                        */
+/*    return status                                                       */
+/*                                                                        */
+/*  CALLS                                                                 */
+/*                                                                        */
+/*    _lx_nor_flash_block_reclaim_erase     Erase reclaimed block         */
+/*    _lx_nor_flash_block_reclaim_sector_move                             */
+/*                                          Move sector out of block      */
+/*    _lx_nor_flash_driver_read             Driver flash sector read      */
+/*    _lx_nor_flash_next_block_to_erase_find                              */
+/*                                          Find next block to erase      */
+/*    _lx_nor_flash_system_error            Internal system error handler */
+/*    tx_mutex_get                          Get thread protection         */
+/*    tx_mutex_put                          Release thread protection     */
+/*                                                                        */
+/*  CALLED BY                                                             */
+/*                                                                        */
+/*    Application Code                                                    */
+/*                                                                        */
+/**************************************************************************/
+UINT  _lx_nor_flash_background_reclaim(LX_NOR_FLASH *nor_flash, ULONG time_budget, ULONG *time_used)
+{
+#ifdef LX_NOR_ENABLE_BACKGROUND_RECLAIM
+
+ULONG   *block_word_ptr;
+ULONG   *list_word_ptr;
+ULONG   list_word;
+ULONG   erase_block;
+ULONG   erase_count;
+ULONG   mapped_sectors;
+ULONG   obsolete_sectors;
+ULONG   free_sectors;
+ULONG   used;
+ULONG   i;
+UINT    status;
+
+
+#ifdef LX_THREAD_SAFE_ENABLE
+
+    /* Obtain the thread safe mutex.  */
+    tx_mutex_get(&nor_flash -> lx_nor_flash_mutex, TX_WAIT_FOREVER);
+#endif
+
+    /* Nothing charged yet.  */
+    used =    0;
+    status =  LX_SUCCESS;
+
+    /* Loop while the budget allows another step.  */
+    while (status == LX_SUCCESS)
+    {
+
+        /* Determine if a block needs to be chosen.  */
+        if (nor_flash -> lx_nor_flash_background_reclaim_block == LX_ALL_ONES)
+        {
+
+            /* Determine if there are enough obsolete sectors to be worth a reclaim.  */
+            if (nor_flash -> lx_nor_flash_obsolete_physical_sectors <
+                (nor_flash -> lx_nor_flash_physical_sectors_per_block * LX_NOR_BACKGROUND_RECLAIM_OBSOLETE_BLOCKS))
+            {
+
+                /* No, nothing to do.  */
+                break;
+            }
+
+            /* Determine the next block to erase, the same choice an inline reclaim would make.  */
+            status =  _lx_nor_flash_next_block_to_erase_find(nor_flash, &erase_block, &erase_count, &mapped_sectors, &obsolete_sectors);
+            if (status)
+            {
+                break;
+            }
+
+            /* Calculate the number of free sectors in this block.  */
+            free_sectors =  nor_flash -> lx_nor_flash_physical_sectors_per_block - (obsolete_sectors + mapped_sectors);
+
+            /* Determine if there are enough free sectors outside of this block to reclaim this block.  */
+            if (mapped_sectors > (nor_flash -> lx_nor_flash_free_physical_sectors - free_sectors))
+            {
+
+                /* No, leave it to the inline reclaim.  */
+                break;
+            }
+
+            /* Ensure the search block is not the block we are trying to free.  */
+            if (nor_flash -> lx_nor_flash_free_block_search == erase_block)
+            {
+
+                /* Move the search to the next block.  */
+                nor_flash -> lx_nor_flash_free_block_search =  erase_block + 1;
+
+                /* Check for wrap condition.  */
+                if (nor_flash -> lx_nor_flash_free_block_search >= nor_flash -> lx_nor_flash_total_blocks)
+                    nor_flash -> lx_nor_flash_free_block_search =  0;
+            }
+#ifdef LX_NOR_ENABLE_RECLAIM_POLICY
+
+            /* Likewise for the search pointer of relocated sectors.  */
+            if (nor_flash -> lx_nor_flash_reclaim_policy_relocate_search == erase_block)
+            {
+                nor_flash -> lx_nor_flash_reclaim_policy_relocate_search =  erase_block + 1;
+                if (nor_flash -> lx_nor_flash_reclaim_policy_relocate_search >= nor_flash -> lx_nor_flash_total_blocks)
+                    nor_flash -> lx_nor_flash_reclaim_policy_relocate_search =  0;
+            }
+#endif
+
+            /* Remember the block in progress.  */
+            nor_flash -> lx_nor_flash_background_reclaim_block =        erase_block;
+            nor_flash -> lx_nor_flash_background_reclaim_sector =       0;
+            nor_flash -> lx_nor_flash_background_reclaim_erase_count =  erase_count;
+        }
+
+        /* Pickup the block in progress.  */
+        erase_block =     nor_flash -> lx_nor_flash_background_reclaim_block;
+        block_word_ptr =  nor_flash -> lx_nor_flash_base_address + (nor_flash -> lx_nor_flash_words_per_block * erase_block);
+        list_word_ptr =   block_word_ptr + nor_flash -> lx_nor_flash_block_physical_sector_mapping_offset;
+
+        /* Continue with the mapping list where the previous step stopped. Sector writes may have allocated
+           sectors of this block since, so the whole list is checked and not only up to the first free entry.  */
+        obsolete_sectors =  0;
+        for (i = nor_flash -> lx_nor_flash_background_reclaim_sector; i < nor_flash -> lx_nor_flash_physical_sectors_per_block; i++)
+        {
+
+            /* Pickup the mapped sector list entry.  */
+#ifdef LX_DIRECT_READ
+
+            /* Read the word directly.  */
+            list_word =  *(list_word_ptr + i);
+#else
+            status =  _lx_nor_flash_driver_read(nor_flash, list_word_ptr + i, &list_word, 1);
+
+            /* Check for an error from flash driver. Drivers should never return an error..  */
+            if (status)
+            {
+
+                /* Call system error handler.  */
+                _lx_nor_flash_system_error(nor_flash, status);
+                break;
+            }
+#endif
+
+            /* Determine if this entry is mapped.  */
+            if ((list_word == LX_NOR_PHYSICAL_SECTOR_FREE) || ((list_word & LX_NOR_PHYSICAL_SECTOR_VALID) == 0))
+            {
+
+                /* No, nothing to move.  */
+                continue;
+            }
+
+            /* Determine if the move still fits the budget.  */
+            if ((time_budget - used) < LX_NOR_BACKGROUND_RECLAIM_MOVE_TIME)
+            {
+
+                /* No, stop here.  */
+                break;
+            }
+
+            /* Move the sector out of the block.  */
+            status =  _lx_nor_flash_block_reclaim_sector_move(nor_flash, erase_block, i, list_word);
+            if (status)
+            {
+                break;
+            }
+
+            /* The moved sector takes a free sector and leaves an obsolete one behind.  */
+            nor_flash -> lx_nor_flash_free_physical_sectors--;
+            nor_flash -> lx_nor_flash_obsolete_physical_sectors++;
+#ifdef LX_NOR_ENABLE_OBSOLETE_COUNT_CACHE
+
+            /* Check if the block is cached by obsolete count cache.  */
+            if (erase_block < nor_flash -> lx_nor_flash_extended_cache_obsolete_count_max_block)
+            {
+
+                /* Yes, increment the obsolete count for this block.  */
+                nor_flash -> lx_nor_flash_extended_cache_obsolete_count[erase_block]++;
+            }
+#endif
+
+            /* Charge the move.  */
+            used =  used + LX_NOR_BACKGROUND_RECLAIM_MOVE_TIME;
+            nor_flash -> lx_nor_flash_background_reclaim_moves++;
+        }
+
+        /* Remember where to continue.  */
+        nor_flash -> lx_nor_flash_background_reclaim_sector =  i;
+
+        /* Determine if the pass is incomplete.  */
+        if ((status) || (i < nor_flash -> lx_nor_flash_physical_sectors_per_block))
+        {
+
+            /* Yes, the budget is used up or there was an error.  */
+            break;
+        }
+
+        /* Restart the next pass from the beginning, an erase that does not fit now must recheck the list.  */
+        nor_flash -> lx_nor_flash_background_reclaim_sector =  0;
+
+        /* Determine if the erase still fits the budget.  */
+        if ((time_budget - used) < LX_NOR_BACKGROUND_RECLAIM_ERASE_TIME)
+        {
+
+            /* No, the next call erases the block.  */
+            break;
+        }
+
+        /* Count the obsolete sectors of the block, a final check that nothing is left to move.  */
+        for (i = 0; i < nor_flash -> lx_nor_flash_physical_sectors_per_block; i++)
+        {
+
+            /* Pickup the mapped sector list entry.  */
+#ifdef LX_DIRECT_READ
+
+            /* Read the word directly.  */
+            list_word =  *(list_word_ptr + i);
+#else
+            status =  _lx_nor_flash_driver_read(nor_flash, list_word_ptr + i, &list_word, 1);
+
+            /* Check for an error from flash driver. Drivers should never return an error..  */
+            if (status)
+            {
+
+                /* Call system error handler.  */
+                _lx_nor_flash_system_error(nor_flash, status);
+                break;
+            }
+#endif
+
+            /* Determine if the entry has been used.  */
+            if (list_word != LX_NOR_PHYSICAL_SECTOR_FREE)
+            {
+
+                /* Determine if the entry is still mapped.  */
+                if (list_word & LX_NOR_PHYSICAL_SECTOR_VALID)
+                {
+
+                    /* Call system error handler, a full pass just moved every mapped sector.  */
+                    _lx_nor_flash_system_error(nor_flash, LX_SYSTEM_INVALID_BLOCK);
+                    status =  LX_ERROR;
+                    break;
+                }
+
+                /* Increment the number of obsolete sectors.  */
+                obsolete_sectors++;
+            }
+        }
+
+        /* Check for an error.  */
+        if (status)
+        {
+            break;
+        }
+
+        /* Erase the block and free its obsolete sectors, this also ends the block in progress.  */
+        status =  _lx_nor_flash_block_reclaim_erase(nor_flash, erase_block, nor_flash -> lx_nor_flash_background_reclaim_erase_count, obsolete_sectors);
+        if (status)
+        {
+            break;
+        }
+
+        /* Charge the erase.  */
+        used =  used + LX_NOR_BACKGROUND_RECLAIM_ERASE_TIME;
+        nor_flash -> lx_nor_flash_background_reclaim_erases++;
+    }
+
+    /* Return the charged time.  */
+    if (time_used)
+    {
+        *time_used =  used;
+    }
+
+#ifdef LX_THREAD_SAFE_ENABLE
+
+    /* Release the thread safe mutex.  */
+    tx_mutex_put(&nor_flash -> lx_nor_flash_mutex);
+#endif
+
+    /* Return completion status.  */
+    return(status);
+#else
+
+    LX_PARAMETER_NOT_USED(nor_flash);
+    LX_PARAMETER_NOT_USED(time_budget);
+
+    /* Nothing charged.  */
+    if (time_used)
+    {
+        *time_used =  0;
+    }
+
+    /* Return disabled status.  */
+    return(LX_DISABLED);
+#endif
+}
@@ -0,0 +1,208 @@
+/**************************************************************************/
+/**************************************************************************/
+/**                                                                       */
+/** LevelX Component                                                      */
+/**                                                                       */
+/**   NOR Flash                                                           */
+/**                                                                       */
+/**************************************************************************/
+/**************************************************************************/
+
+#define LX_SOURCE_CODE
+
+
+/* Disable ThreadX error checking.  */
+
+#ifndef LX_DISABLE_ERROR_CHECKING
+#define LX_DISABLE_ERROR_CHECKING
+#endif
+
+
+/* Include necessary system files.  */
+
+#include "lx_api.h"
+
+
+/**************************************************************************/
+/*                                                                        */
+/*  FUNCTION                                               RELEASE        */
+/*                                                                        */
+/*    _lx_nor_flash_block_reclaim_erase                   PORTABLE C      */
+/*                                                                        */
+/*  DESCRIPTION                                                           */
+/*                                                                        */
+/*    This function erases a block that no longer holds mapped sectors,   */
+/*    writes its new erase count and free bit map and returns its         */
+/*    obsolete sectors to the free sectors of the flash.                  */
+/*                                                                        */
+/*  INPUT                                                                 */
+/*                                                                        */
+/*    nor_flash                             NOR flash instance            */
+/*    erase_block                           Block to erase                */
+/*    erase_count                           Current erase count of block  */
+/*    obsolete_sectors                      Obsolete sectors to free      */
+/*                                                                        */
+/*  OUTPUT                                                                */
+/*                                                                        */
+/*    return status                                                       */
+/*                                                                        */
+/*  CALLS                                                                 */
+/*                                                                        */
+/*    _lx_nor_flash_block_stats_erase       Record erase in table         */
+/*    _lx_nor_flash_driver_block_erase      Driver erase block            */
+/*    _lx_nor_flash_driver_write            Driver flash sector write     */
+/*    _lx_nor_flash_system_error            Internal system error handler */
+/*                                                                        */
+/*  CALLED BY                                                             */
+/*                                                                        */
+/*    _lx_nor_flash_background_reclaim      Background block reclaim      */
+/*    _lx_nor_flash_block_reclaim           Reclaim one flash block       */
+/*                                                                        */
+/**************************************************************************/
+UINT  _lx_nor_flash_block_reclaim_erase(LX_NOR_FLASH *nor_flash, ULONG erase_block, ULONG erase_count, ULONG obsolete_sectors)
+{
+
+ULONG   *block_word_ptr;
+ULONG   erase_started_value;
+ULONG   temp_erase_count;
+UINT    status;
+
+
+    /* Setup the block word pointer to the first word of the block.  */
+    block_word_ptr =  nor_flash -> lx_nor_flash_base_address + (nor_flash -> lx_nor_flash_words_per_block * erase_block);
+
+#ifdef LX_NOR_ENABLE_BACKGROUND_RECLAIM
+
+    /* Determine if the background reclaim is working on this block.  */
+    if (nor_flash -> lx_nor_flash_background_reclaim_block == erase_block)
+    {
+
+        /* Yes, the block is done, the background reclaim must choose a new one.  */
+        nor_flash -> lx_nor_flash_background_reclaim_block =  LX_ALL_ONES;
+    }
+#endif
+
+    /* Write the erased started indication.  */
+    erase_started_value =  LX_BLOCK_ERASE_STARTED;
+    status =  _lx_nor_flash_driver_write(nor_flash, block_word_ptr, &erase_started_value, 1);
+
+    /* Check for an error from flash driver. Drivers should never return an error..  */
+    if (status)
+    {
+
+        /* Call system error handler.  */
+        _lx_nor_flash_system_error(nor_flash, status);
+
+        /* Return the error.  */
+        return(status);
+    }
+
+    /* Erase the entire block.  */
+    status =  _lx_nor_flash_driver_block_erase(nor_flash, erase_block, erase_count+1);
+
+    /* Check for an error from flash driver. Drivers should never return an error..  */
+    if (status)
+    {
+
+        /* Call system error handler.  */
+        _lx_nor_flash_system_error(nor_flash, status);
+
+        /* Return the error.  */
+        return(status);
+    }
+
+    /* Determine if the erase count is at the minimum.  */
+    if (erase_count == nor_flash -> lx_nor_flash_minimum_erase_count)
+    {
+
+        /* Yes, decrement the minimum erased block count.  */
+        nor_flash -> lx_nor_flash_minimum_erased_blocks--;
+    }
+
+    /* Increment the erase count.  */
+    erase_count++;
+
+    /* Determine if the new erase count exceeds the maximum.  */
+    if (erase_count > ((ULONG) LX_BLOCK_ERASE_COUNT_MAX))
+    {
+
+        /* Yes, erase count is in overflow. Stay at the maximum count.  */
+        erase_count =  ((ULONG) LX_BLOCK_ERASE_COUNT_MAX);
+    }
+
+    /* Determine if we need to update the maximum erase count.  */
+    if (erase_count > nor_flash -> lx_nor_flash_maximum_erase_count)
+    {
+
+        /* Yes, a new maximum is present.  */
+        nor_flash -> lx_nor_flash_maximum_erase_count =  erase_count;
+    }
+
+    /* Setup the free bit map that corresponds to the free physical sectors in this
+       block. Note that we only need to setup the portion of the free bit map that doesn't
+       have sectors associated with it.  */
+    status =  _lx_nor_flash_driver_write(nor_flash, block_word_ptr+(nor_flash -> lx_nor_flash_block_free_bit_map_offset + (nor_flash -> lx_nor_flash_block_bit_map_words - 1)),
+                                                                    &(nor_flash -> lx_nor_flash_block_bit_map_mask), 1);
+
+    /* Check for an error from flash driver. Drivers should never return an error..  */
+    if (status)
+    {
+
+        /* Call system error handler.  */
+        _lx_nor_flash_system_error(nor_flash, status);
+
+        /* Return the error.  */
+        return(status);
+    }
+
+    /* Write the initial erase count for the block with upper bit set.  */
+    temp_erase_count =  (erase_count | LX_BLOCK_ERASED);
+    status =  _lx_nor_flash_driver_write(nor_flash, block_word_ptr, &temp_erase_count, 1);
+
+    /* Check for an error from flash driver. Drivers should never return an error..  */
+    if (status)
+    {
+
+        /* Call system error handler.  */
+        _lx_nor_flash_system_error(nor_flash, status);
+
+        /* Return the error.  */
+        return(status);
+    }
+
+    /* Write the final initial erase count for the block.  */
+    status =  _lx_nor_flash_driver_write(nor_flash, block_word_ptr, &erase_count, 1);
+
+    /* Check for an error from flash driver. Drivers should never return an error..  */
+    if (status)
+    {
+
+        /* Call system error handler.  */
+        _lx_nor_flash_system_error(nor_flash, status);
+
+        /* Return the error.  */
+        return(status);
+    }
+
+    /* Update parameters of this flash.  */
+    nor_flash -> lx_nor_flash_free_physical_sectors =      nor_flash -> lx_nor_flash_free_physical_sectors + obsolete_sectors;
+    nor_flash -> lx_nor_flash_obsolete_physical_sectors =  nor_flash -> lx_nor_flash_obsolete_physical_sectors - obsolete_sectors;
+#ifdef LX_NOR_ENABLE_OBSOLETE_COUNT_CACHE
+
+    /* Check if the block is cached by obsolete count cache.  */
+    if (erase_block < nor_flash -> lx_nor_flash_extended_cache_obsolete_count_max_block)
+    {
+
+        /* Yes, clear the obsolete count for this block.  */
+        nor_flash -> lx_nor_flash_extended_cache_obsolete_count[erase_block] =  0;
+    }
+#endif
+#ifdef LX_NOR_ENABLE_BLOCK_STATS
+
+    /* Record the erased block in the block statistics table.  */
+    _lx_nor_flash_block_stats_erase(nor_flash, erase_block, erase_count);
+#endif
+
+    /* Return success.  */
+    return(LX_SUCCESS);
+}
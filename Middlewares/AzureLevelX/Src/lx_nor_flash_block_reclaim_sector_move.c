@@ -0,0 +1,290 @@
+/**************************************************************************/
+/**************************************************************************/
+/**                                                                       */
+/** LevelX Component                                                      */
+/**                                                                       */
+/**   NOR Flash                                                           */
+/**                                                                       */
+/**************************************************************************/
+/**************************************************************************/
+
+#define LX_SOURCE_CODE
+
+
+/* Disable ThreadX error checking.  */
+
+#ifndef LX_DISABLE_ERROR_CHECKING
+#define LX_DISABLE_ERROR_CHECKING
+#endif
+
+
+/* Include necessary system files.  */
+
+#include "lx_api.h"
+
+
+/**************************************************************************/
+/*                                                                        */
+/*  FUNCTION                                               RELEASE        */
+/*                                                                        */
+/*    _lx_nor_flash_block_reclaim_sector_move             PORTABLE C      */
+/*                                                                        */
+/*  DESCRIPTION                                                           */
+/*                                                                        */
+/*    This function moves one mapped physical sector out of the block     */
+/*    being reclaimed: the data is copied to a newly allocated sector     */
+/*    outside of the block, the new mapping is made valid and the old     */
+/*    one is obsoleted, in the power safe order of a sector write. The    */
+/*    free and obsolete totals are left to the caller.                    */
+/*                                                                        */
+/*  INPUT                                                                 */
+/*                                                                        */
+/*    nor_flash                             NOR flash instance            */
+/*    erase_block                           Block being reclaimed         */
+/*    sector                                Physical sector in the block  */
+/*    list_word                             Its mapping list entry        */
+/*                                                                        */
+/*  OUTPUT                                                                */
+/*                                                                        */
+/*    return status                                                       */
+/*                                                                        */
+/*  CALLS                                                                 */
+/*                                                                        */
+/*    _lx_nor_flash_block_stats_obsolete    Record obsolete sector        */
+/*    _lx_nor_flash_driver_write            Driver flash sector write     */
+/*    _lx_nor_flash_driver_read             Driver flash sector read      */
+/*    _lx_nor_flash_physical_sector_allocate                              */
+/*                                          Allocate new logical sector   */
+/*    _lx_nor_flash_sector_mapping_cache_invalidate                       */
+/*                                          Invalidate cache entry        */
+/*    _lx_nor_flash_mapping_table_update    Update RAM mapping table      */
+/*    _lx_nor_flash_system_error            Internal system error handler */
+/*                                                                        */
+/*  CALLED BY                                                             */
+/*                                                                        */
+/*    _lx_nor_flash_background_reclaim      Background block reclaim      */
+/*    _lx_nor_flash_block_reclaim           Reclaim one flash block       */
+/*                                                                        */
+/**************************************************************************/
+UINT  _lx_nor_flash_block_reclaim_sector_move(LX_NOR_FLASH *nor_flash, ULONG erase_block, ULONG sector, ULONG list_word)
+{
+
+ULONG   *block_word_ptr;
+ULONG   *list_word_ptr;
+ULONG   logical_sector;
+ULONG   *new_mapping_address;
+ULONG   *new_sector_address;
+ULONG   new_mapping_entry;
+UINT    status;
+
+
+    /* Setup the block word pointer to the first word of the block and the pointer to the mapping list entry.  */
+    block_word_ptr =  nor_flash -> lx_nor_flash_base_address + (nor_flash -> lx_nor_flash_words_per_block * erase_block);
+    list_word_ptr =   block_word_ptr + nor_flash -> lx_nor_flash_block_physical_sector_mapping_offset + sector;
+
+    /* Pickup the logical sector associated with this mapped physical sector.  */
+    logical_sector =  list_word & LX_NOR_LOGICAL_SECTOR_MASK;
+
+    /* Invalidate the old sector mapping cache entry.  */
+    _lx_nor_flash_sector_mapping_cache_invalidate(nor_flash, logical_sector);
+
+#ifdef LX_NOR_ENABLE_RECLAIM_POLICY
+
+    /* The allocation is for a relocated sector.  */
+    nor_flash -> lx_nor_flash_reclaim_policy_relocating =  LX_TRUE;
+#endif
+
+    /* Allocate a new physical sector for this write.  */
+    _lx_nor_flash_physical_sector_allocate(nor_flash, logical_sector, &new_mapping_address, &new_sector_address);
+
+    /* Check to see if the new sector is also in the erase block.  */
+    if ((new_sector_address >= block_word_ptr) && (new_sector_address < (block_word_ptr + nor_flash -> lx_nor_flash_words_per_block)))
+    {
+
+        /* Yes, the new sector was found in the block to be erased. Simply move the search pointer
+           to the block after the erase block and search for another sector from there.  */
+#ifdef LX_NOR_ENABLE_RECLAIM_POLICY
+        if (nor_flash -> lx_nor_flash_reclaim_policy == LX_NOR_RECLAIM_POLICY_HOT_COLD)
+        {
+
+            /* The sector came from the search pointer of relocated sectors, move that one.  */
+            nor_flash -> lx_nor_flash_reclaim_policy_relocate_search =  erase_block + 1;
+
+            /* Check for wrap condition.  */
+            if (nor_flash -> lx_nor_flash_reclaim_policy_relocate_search >= nor_flash -> lx_nor_flash_total_blocks)
+                nor_flash -> lx_nor_flash_reclaim_policy_relocate_search =  0;
+        }
+        else
+#endif
+        {
+            nor_flash -> lx_nor_flash_free_block_search =  erase_block + 1;
+
+            /* Check for wrap condition.  */
+            if (nor_flash -> lx_nor_flash_free_block_search >= nor_flash -> lx_nor_flash_total_blocks)
+                nor_flash -> lx_nor_flash_free_block_search =  0;
+        }
+
+        /* Allocate a new physical sector for this write.  */
+        _lx_nor_flash_physical_sector_allocate(nor_flash, logical_sector, &new_mapping_address, &new_sector_address);
+
+        /* Check again for the new sector inside of the block to erase. This should be impossible, since
+           we check previously if there are enough free sectors outside of this block needed to reclaim
+           this block.  */
+        if ((new_sector_address >= block_word_ptr) && (new_sector_address < (block_word_ptr + LX_NOR_SECTOR_SIZE)))
+        {
+
+            /* System error, a new sector is not available outside of the erase block.
+               Clear the new sector so we fall through to the error handling. */
+            new_mapping_address =  LX_NULL;
+        }
+    }
+#ifdef LX_NOR_ENABLE_RECLAIM_POLICY
+
+    /* Allocations are for sector writes again.  */
+    nor_flash -> lx_nor_flash_reclaim_policy_relocating =  LX_FALSE;
+#endif
+
+    /* Determine if the new sector allocation was successful.  */
+    if (new_mapping_address == LX_NULL)
+    {
+
+        /* Call system error handler - the allocation should always succeed at this point.  */
+        _lx_nor_flash_system_error(nor_flash, LX_SYSTEM_ALLOCATION_FAILED);
+
+        /* Return the error.  */
+        return(LX_ERROR);
+    }
+
+#ifdef LX_DIRECT_READ
+    /* First, write the sector data to the new physical sector.  */
+    status =  _lx_nor_flash_driver_write(nor_flash, new_sector_address, (block_word_ptr + nor_flash -> lx_nor_flash_block_physical_sector_offset) +
+                                                    (sector * LX_NOR_SECTOR_SIZE), LX_NOR_SECTOR_SIZE);
+
+    /* Check for an error from flash driver. Drivers should never return an error..  */
+    if (status)
+    {
+
+        /* Call system error handler.  */
+        _lx_nor_flash_system_error(nor_flash, status);
+
+        /* Return the error.  */
+        return(status);
+    }
+#else
+
+    /* First, read the sector data into the internal memory of the NOR flash instance. This internal memory
+       is supplied by the underlying driver during initialization.  */
+    status =  _lx_nor_flash_driver_read(nor_flash, (block_word_ptr + nor_flash -> lx_nor_flash_block_physical_sector_offset) +
+                                                   (sector * LX_NOR_SECTOR_SIZE), nor_flash -> lx_nor_flash_sector_buffer,
+                                                   LX_NOR_SECTOR_SIZE);
+
+    /* Check for an error from flash driver. Drivers should never return an error..  */
+    if (status)
+    {
+
+        /* Call system error handler.  */
+        _lx_nor_flash_system_error(nor_flash, status);
+
+        /* Return the error.  */
+        return(status);
+    }
+
+    /* Next, write the sector data from the internal buffer to the new physical sector.  */
+    status =  _lx_nor_flash_driver_write(nor_flash, new_sector_address, nor_flash -> lx_nor_flash_sector_buffer, LX_NOR_SECTOR_SIZE);
+
+    /* Check for an error from flash driver. Drivers should never return an error..  */
+    if (status)
+    {
+
+        /* Call system error handler.  */
+        _lx_nor_flash_system_error(nor_flash, status);
+
+        /* Return the error.  */
+        return(status);
+    }
+#endif
+
+    /* Now deprecate the old sector mapping.  */
+
+    /* Clear bit 30, which indicates this sector is superceded.  */
+    list_word =  list_word & ~((ULONG) LX_NOR_PHYSICAL_SECTOR_SUPERCEDED);
+
+    /* Write the value back to the flash to clear bit 30.  */
+    status =  _lx_nor_flash_driver_write(nor_flash, list_word_ptr, &list_word, 1);
+
+    /* Check for an error from flash driver. Drivers should never return an error..  */
+    if (status)
+    {
+
+        /* Call system error handler.  */
+        _lx_nor_flash_system_error(nor_flash, status);
+
+        /* Return the error.  */
+        return(status);
+    }
+
+    /* Now build the new mapping entry - with the not valid bit set initially.  */
+    new_mapping_entry =  ((ULONG) LX_NOR_PHYSICAL_SECTOR_VALID) | ((ULONG) LX_NOR_PHYSICAL_SECTOR_SUPERCEDED) | (ULONG) LX_NOR_PHYSICAL_SECTOR_MAPPING_NOT_VALID | logical_sector;
+
+    /* Write out the new mapping entry.  */
+    status =  _lx_nor_flash_driver_write(nor_flash, new_mapping_address, &new_mapping_entry, 1);
+
+    /* Check for an error from flash driver. Drivers should never return an error..  */
+    if (status)
+    {
+
+        /* Call system error handler.  */
+        _lx_nor_flash_system_error(nor_flash, status);
+
+        /* Return the error.  */
+        return(status);
+    }
+
+    /* Now clear the not valid bit to make this sector mapping valid.  This is done because the writing of the extra bytes itself can
+       be interrupted and we need to make sure this can be detected when the flash is opened again.  */
+    new_mapping_entry =  new_mapping_entry & ~((ULONG) LX_NOR_PHYSICAL_SECTOR_MAPPING_NOT_VALID);
+
+    /* Clear the not valid bit.  */
+    status =  _lx_nor_flash_driver_write(nor_flash, new_mapping_address, &new_mapping_entry, 1);
+
+    /* Check for an error from flash driver. Drivers should never return an error..  */
+    if (status)
+    {
+
+        /* Call system error handler.  */
+        _lx_nor_flash_system_error(nor_flash, status);
+
+        /* Return the error.  */
+        return(status);
+    }
+#ifdef LX_NOR_ENABLE_MAPPING_TABLE
+
+    /* Point the RAM mapping table to the moved physical sector.  */
+    _lx_nor_flash_mapping_table_update(nor_flash, logical_sector, new_mapping_address);
+#endif
+
+    /* Now clear bit 31, which indicates this sector is now obsoleted.  */
+    list_word =  list_word & ~((ULONG) LX_NOR_PHYSICAL_SECTOR_VALID);
+
+    /* Write the value back to the flash to clear bit 31.  */
+    status =  _lx_nor_flash_driver_write(nor_flash, list_word_ptr, &list_word, 1);
+
+    /* Check for an error from flash driver. Drivers should never return an error..  */
+    if (status)
+    {
+
+        /* Call system error handler.  */
+        _lx_nor_flash_system_error(nor_flash, status);
+
+        /* Return the error.  */
+        return(status);
+    }
+#ifdef LX_NOR_ENABLE_BLOCK_STATS
+
+    /* Record the obsolete sector in the block statistics table.  */
+    _lx_nor_flash_block_stats_obsolete(nor_flash, list_word_ptr);
+#endif
+
+    /* Return success.  */
+    return(LX_SUCCESS);
+}
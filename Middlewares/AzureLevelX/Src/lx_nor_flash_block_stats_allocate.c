@@ -0,0 +1,98 @@
+/**************************************************************************/
+/**************************************************************************/
+/**                                                                       */
+/** LevelX Component                                                      */
+/**                                                                       */
+/**   NOR Flash                                                           */
+/**                                                                       */
+/**************************************************************************/
+/**************************************************************************/
+
+#define LX_SOURCE_CODE
+
+
+/* Disable ThreadX error checking.  */
+
+#ifndef LX_DISABLE_ERROR_CHECKING
+#define LX_DISABLE_ERROR_CHECKING
+#endif
+
+
+/* Include necessary system files.  */
+
+#include "lx_api.h"
+
+
+/**************************************************************************/
+/*                                                                        */
+/*  FUNCTION                                               RELEASE        */
+/*                                                                        */
+/*    _lx_nor_flash_block_stats_allocate                  PORTABLE C      */
+/*                                                                        */
+/*  DESCRIPTION                                                           */
+/*                                                                        */
+/*    This function records a physical sector allocated for a logical     */
+/*    sector in the block statistics table: the block has one free        */
+/*    sector less, one mapped sector more and its logical sector range    */
+/*    is widened to the new sector.                                       */
+/*                                                                        */
+/*  INPUT                                                                 */
+/*                                                                        */
+/*    nor_flash                             NOR flash instance            */
+/*    block                                 Block of the new sector       */
+/*    logical_sector                        Logical sector mapped to it   */
+/*                                                                        */
+/*  OUTPUT                                                                */
+/*                                                                        */
+/*    None                                                                */
+/*                                                                        */
+/*  CALLS                                                                 */
+/*                                                                        */
+/*    None                                                                */
+/*                                                                        */
+/*  CALLED BY                                                             */
+/*                                                                        */
+/*    _lx_nor_flash_physical_sector_allocate                              */
+/*                                          Allocate new logical sector   */
+/*                                                                        */
+/**************************************************************************/
+VOID  _lx_nor_flash_block_stats_allocate(LX_NOR_FLASH *nor_flash, ULONG block, ULONG logical_sector)
+{
+#ifdef LX_NOR_ENABLE_BLOCK_STATS
+
+LX_NOR_FLASH_BLOCK_STATS    *entry;
+
+
+    /* Determine if the block statistics table is in use.  */
+    if (nor_flash -> lx_nor_flash_block_stats == LX_NULL)
+    {
+
+        /* No, nothing to record.  */
+        return;
+    }
+
+    /* Pickup the entry of this block.  */
+    entry =  &nor_flash -> lx_nor_flash_block_stats[block];
+
+    /* The allocated sector is no longer free and holds the logical sector.  */
+    entry -> lx_nor_flash_block_stats_free_sectors--;
+    entry -> lx_nor_flash_block_stats_mapped_sectors++;
+
+    /* Widen the logical sector range of the block.  */
+    if (logical_sector < entry -> lx_nor_flash_block_stats_min_logical_sector)
+        entry -> lx_nor_flash_block_stats_min_logical_sector =  logical_sector;
+    if (logical_sector > entry -> lx_nor_flash_block_stats_max_logical_sector)
+        entry -> lx_nor_flash_block_stats_max_logical_sector =  logical_sector;
+#ifdef LX_NOR_ENABLE_RECLAIM_POLICY
+
+    /* Advance the allocation clock, the block was written now.  */
+    nor_flash -> lx_nor_flash_reclaim_policy_clock++;
+    entry -> lx_nor_flash_block_stats_write_time =  nor_flash -> lx_nor_flash_reclaim_policy_clock;
+#endif
+#else
+
+    LX_PARAMETER_NOT_USED(nor_flash);
+    LX_PARAMETER_NOT_USED(block);
+    LX_PARAMETER_NOT_USED(logical_sector);
+#endif
+}
@@ -0,0 +1,110 @@
+/**************************************************************************/
+/**************************************************************************/
+/**                                                                       */
+/** LevelX Component                                                      */
+/**                                                                       */
+/**   NOR Flash                                                           */
+/**                                                                       */
+/**************************************************************************/
+/**************************************************************************/
+
+#define LX_SOURCE_CODE
+
+
+/* Disable ThreadX error checking.  */
+
+#ifndef LX_DISABLE_ERROR_CHECKING
+#define LX_DISABLE_ERROR_CHECKING
+#endif
+
+
+/* Include necessary system files.  */
+
+#include "lx_api.h"
+
+
+/**************************************************************************/
+/*                                                                        */
+/*  FUNCTION                                               RELEASE        */
+/*                                                                        */
+/*    _lx_nor_flash_block_stats_bucket_move               PORTABLE C      */
+/*                                                                        */
+/*  DESCRIPTION                                                           */
+/*                                                                        */
+/*    This function sets the obsolete sector count of a block in the      */
+/*    block statistics table and moves the block from the bucket of its   */
+/*    old count to the bucket of the new one.                             */
+/*                                                                        */
+/*  INPUT                                                                 */
+/*                                                                        */
+/*    nor_flash                             NOR flash instance            */
+/*    block                                 Block to move                 */
+/*    obsolete_sectors                      New obsolete sector count     */
+/*                                                                        */
+/*  OUTPUT                                                                */
+/*                                                                        */
+/*    None                                                                */
+/*                                                                        */
+/*  CALLS                                                                 */
+/*                                                                        */
+/*    None                                                                */
+/*                                                                        */
+/*  CALLED BY                                                             */
+/*                                                                        */
+/*    _lx_nor_flash_block_stats_erase       Block erased                  */
+/*    _lx_nor_flash_block_stats_obsolete    Sector obsoleted              */
+/*                                                                        */
+/**************************************************************************/
+VOID  _lx_nor_flash_block_stats_bucket_move(LX_NOR_FLASH *nor_flash, ULONG block, ULONG obsolete_sectors)
+{
+#ifdef LX_NOR_ENABLE_BLOCK_STATS
+
+LX_NOR_FLASH_BLOCK_STATS    *stats;
+LX_NOR_FLASH_BLOCK_STATS    *entry;
+USHORT                      *buckets;
+ULONG                       bucket;
+
+
+    /* Pickup the table, the bucket heads and the entry of this block.  */
+    stats =    nor_flash -> lx_nor_flash_block_stats;
+    buckets =  nor_flash -> lx_nor_flash_block_stats_buckets;
+    entry =    &stats[block];
+
+    /* Unlink the block from the bucket of its current obsolete count.  */
+    bucket =  (ULONG) entry -> lx_nor_flash_block_stats_obsolete_sectors;
+    if (entry -> lx_nor_flash_block_stats_previous != LX_NOR_BLOCK_STATS_NONE)
+        stats[entry -> lx_nor_flash_block_stats_previous].lx_nor_flash_block_stats_next =  entry -> lx_nor_flash_block_stats_next;
+    else
+        buckets[bucket] =  entry -> lx_nor_flash_block_stats_next;
+    if (entry -> lx_nor_flash_block_stats_next != LX_NOR_BLOCK_STATS_NONE)
+        stats[entry -> lx_nor_flash_block_stats_next].lx_nor_flash_block_stats_previous =  entry -> lx_nor_flash_block_stats_previous;
+
+    /* Link the block at the head of the bucket of the new count.  */
+    entry -> lx_nor_flash_block_stats_obsolete_sectors =  (USHORT) obsolete_sectors;
+    entry -> lx_nor_flash_block_stats_previous =          LX_NOR_BLOCK_STATS_NONE;
+    entry -> lx_nor_flash_block_stats_next =              buckets[obsolete_sectors];
+    if (buckets[obsolete_sectors] != LX_NOR_BLOCK_STATS_NONE)
+        stats[buckets[obsolete_sectors]].lx_nor_flash_block_stats_previous =  (USHORT) block;
+    buckets[obsolete_sectors] =  (USHORT) block;
+
+    /* Determine if this is the new highest bucket in use.  */
+    if (obsolete_sectors > nor_flash -> lx_nor_flash_block_stats_highest_bucket)
+    {
+
+        /* Yes, remember it.  */
+        nor_flash -> lx_nor_flash_block_stats_highest_bucket =  obsolete_sectors;
+    }
+
+    /* Otherwise, walk the highest bucket down past the buckets left empty.  */
+    while ((nor_flash -> lx_nor_flash_block_stats_highest_bucket) &&
+           (buckets[nor_flash -> lx_nor_flash_block_stats_highest_bucket] == LX_NOR_BLOCK_STATS_NONE))
+    {
+        nor_flash -> lx_nor_flash_block_stats_highest_bucket--;
+    }
+#else
+
+    LX_PARAMETER_NOT_USED(nor_flash);
+    LX_PARAMETER_NOT_USED(block);
+    LX_PARAMETER_NOT_USED(obsolete_sectors);
+#endif
+}
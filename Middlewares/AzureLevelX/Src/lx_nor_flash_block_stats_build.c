@@ -0,0 +1,115 @@
+/**************************************************************************/
+/**************************************************************************/
+/**                                                                       */
+/** LevelX Component                                                      */
+/**                                                                       */
+/**   NOR Flash                                                           */
+/**                                                                       */
+/**************************************************************************/
+/**************************************************************************/
+
+#define LX_SOURCE_CODE
+
+
+/* Disable ThreadX error checking.  */
+
+#ifndef LX_DISABLE_ERROR_CHECKING
+#define LX_DISABLE_ERROR_CHECKING
+#endif
+
+
+/* Include necessary system files.  */
+
+#include "lx_api.h"
+
+
+/**************************************************************************/
+/*                                                                        */
+/*  FUNCTION                                               RELEASE        */
+/*                                                                        */
+/*    _lx_nor_flash_block_stats_build                     PORTABLE C      */
+/*                                                                        */
+/*  DESCRIPTION                                                           */
+/*                                                                        */
+/*    This function links the blocks of the statistics table filled by    */
+/*    open into the buckets of their obsolete sector counts. Without a    */
+/*    table from the driver, or with more blocks than the USHORT links    */
+/*    can hold, the table is left disabled.                               */
+/*                                                                        */
+/*  INPUT                                                                 */
+/*                                                                        */
+/*    nor_flash                             NOR flash instance            */
+/*                                                                        */
+/*  OUTPUT                                                                */
+/*                                                                        */
+/*    None                                                                */
+/*                                                                        */
+/*  CALLS                                                                 */
+/*                                                                        */
+/*    None                                                                */
+/*                                                                        */
+/*  CALLED BY                                                             */
+/*                                                                        */
+/*    _lx_nor_flash_open                    Open NOR flash                */
+/*                                                                        */
+/**************************************************************************/
+VOID  _lx_nor_flash_block_stats_build(LX_NOR_FLASH *nor_flash)
+{
+#ifdef LX_NOR_ENABLE_BLOCK_STATS
+
+LX_NOR_FLASH_BLOCK_STATS    *stats;
+USHORT                      *buckets;
+ULONG                       bucket;
+ULONG                       i;
+
+
+    /* Pickup the table and the bucket heads.  */
+    stats =    nor_flash -> lx_nor_flash_block_stats;
+    buckets =  nor_flash -> lx_nor_flash_block_stats_buckets;
+
+    /* Determine if the table can be used.  */
+    if ((stats == LX_NULL) || (buckets == LX_NULL) || (nor_flash -> lx_nor_flash_total_blocks >= (ULONG) LX_NOR_BLOCK_STATS_NONE))
+    {
+
+        /* No, the next block to erase is found by scanning the flash.  */
+        nor_flash -> lx_nor_flash_block_stats =  LX_NULL;
+        return;
+    }
+
+    /* Empty all the buckets.  */
+    for (i = 0; i <= nor_flash -> lx_nor_flash_physical_sectors_per_block; i++)
+    {
+        buckets[i] =  LX_NOR_BLOCK_STATS_NONE;
+    }
+    nor_flash -> lx_nor_flash_block_stats_highest_bucket =  0;
+
+    /* Link every block at the head of the bucket of its obsolete count, in reverse so each bucket lists its
+       blocks in ascending order.  */
+    i =  nor_flash -> lx_nor_flash_total_blocks;
+    while (i--)
+    {
+
+        /* Pickup the bucket of this block.  */
+        bucket =  (ULONG) stats[i].lx_nor_flash_block_stats_obsolete_sectors;
+
+        /* Link the block.  */
+        stats[i].lx_nor_flash_block_stats_previous =  LX_NOR_BLOCK_STATS_NONE;
+        stats[i].lx_nor_flash_block_stats_next =      buckets[bucket];
+        if (buckets[bucket] != LX_NOR_BLOCK_STATS_NONE)
+            stats[buckets[bucket]].lx_nor_flash_block_stats_previous =  (USHORT) i;
+        buckets[bucket] =  (USHORT) i;
+#ifdef LX_NOR_ENABLE_RECLAIM_POLICY
+
+        /* The age of the data is not known, all blocks start as written at open.  */
+        stats[i].lx_nor_flash_block_stats_write_time =  0;
+#endif
+
+        /* Determine if this is the new highest bucket in use.  */
+        if (bucket > nor_flash -> lx_nor_flash_block_stats_highest_bucket)
+            nor_flash -> lx_nor_flash_block_stats_highest_bucket =  bucket;
+    }
+#else
+
+    LX_PARAMETER_NOT_USED(nor_flash);
+#endif
+}
@@ -0,0 +1,129 @@
+/**************************************************************************/
+/**************************************************************************/
+/**                                                                       */
+/** LevelX Component                                                      */
+/**                                                                       */
+/**   NOR Flash                                                           */
+/**                                                                       */
+/**************************************************************************/
+/**************************************************************************/
+
+#define LX_SOURCE_CODE
+
+
+/* Disable ThreadX error checking.  */
+
+#ifndef LX_DISABLE_ERROR_CHECKING
+#define LX_DISABLE_ERROR_CHECKING
+#endif
+
+
+/* Include necessary system files.  */
+
+#include "lx_api.h"
+
+
+/**************************************************************************/
+/*                                                                        */
+/*  FUNCTION                                               RELEASE        */
+/*                                                                        */
+/*    _lx_nor_flash_block_stats_erase                     PORTABLE C      */
+/*                                                                        */
+/*  DESCRIPTION                                                           */
+/*                                                                        */
+/*    This function records an erased block in the block statistics       */
+/*    table: all its sectors are free again, it returns to the bucket of  */
+/*    no obsolete sectors and takes its new erase count. When the last    */
+/*    block at the minimum erase count was erased, the minimum and the    */
+/*    number of blocks at it are recomputed from the table.               */
+/*                                                                        */
+/*  INPUT                                                                 */
+/*                                                                        */
+/*    nor_flash                             NOR flash instance            */
+/*    block                                 Erased block                  */
+/*    erase_count                           New erase count of block      */
+/*                                                                        */
+/*  OUTPUT                                                                */
+/*                                                                        */
+/*    None                                                                */
+/*                                                                        */
+/*  CALLS                                                                 */
+/*                                                                        */
+/*    _lx_nor_flash_block_stats_bucket_move Move block to another bucket  */
+/*                                                                        */
+/*  CALLED BY                                                             */
+/*                                                                        */
+/*    _lx_nor_flash_block_reclaim_erase     Erase reclaimed block         */
+/*                                                                        */
+/**************************************************************************/
+VOID  _lx_nor_flash_block_stats_erase(LX_NOR_FLASH *nor_flash, ULONG block, ULONG erase_count)
+{
+#ifdef LX_NOR_ENABLE_BLOCK_STATS
+
+LX_NOR_FLASH_BLOCK_STATS    *stats;
+ULONG                       min_erase_count;
+ULONG                       min_erased_blocks;
+ULONG                       i;
+
+
+    /* Determine if the block statistics table is in use.  */
+    stats =  nor_flash -> lx_nor_flash_block_stats;
+    if (stats == LX_NULL)
+    {
+
+        /* No, nothing to record.  */
+        return;
+    }
+
+    /* The erased block is all free sectors.  */
+    stats[block].lx_nor_flash_block_stats_erase_count =         erase_count;
+    stats[block].lx_nor_flash_block_stats_free_sectors =        (USHORT) nor_flash -> lx_nor_flash_physical_sectors_per_block;
+    stats[block].lx_nor_flash_block_stats_mapped_sectors =      0;
+    stats[block].lx_nor_flash_block_stats_min_logical_sector =  LX_ALL_ONES;
+    stats[block].lx_nor_flash_block_stats_max_logical_sector =  0;
+
+    /* Move the block to the bucket of no obsolete sectors.  */
+    _lx_nor_flash_block_stats_bucket_move(nor_flash, block, 0);
+
+    /* Determine if blocks are left at the minimum erase count.  */
+    if (nor_flash -> lx_nor_flash_minimum_erased_blocks)
+    {
+
+        /* Yes, the minimum is unchanged.  */
+        return;
+    }
+
+    /* Find the new minimum erase count and the number of blocks at it.  */
+    min_erase_count =    LX_ALL_ONES;
+    min_erased_blocks =  0;
+    for (i = 0; i < nor_flash -> lx_nor_flash_total_blocks; i++)
+    {
+
+        /* Is the erase count the minimum?  */
+        if (stats[i].lx_nor_flash_block_stats_erase_count == min_erase_count)
+        {
+
+            /* Yes, increment the minimum erased block count.  */
+            min_erased_blocks++;
+        }
+
+        /* Is this the new minimum?  */
+        else if (stats[i].lx_nor_flash_block_stats_erase_count < min_erase_count)
+        {
+
+            /* Yes, remember the new minimum.  */
+            min_erase_count =    stats[i].lx_nor_flash_block_stats_erase_count;
+            min_erased_blocks =  1;
+        }
+    }
+
+    /* Update the overall minimum erase count.  */
+    nor_flash -> lx_nor_flash_minimum_erase_count =    min_erase_count;
+    nor_flash -> lx_nor_flash_minimum_erased_blocks =  min_erased_blocks;
+#else
+
+    LX_PARAMETER_NOT_USED(nor_flash);
+    LX_PARAMETER_NOT_USED(block);
+    LX_PARAMETER_NOT_USED(erase_count);
+#endif
+}
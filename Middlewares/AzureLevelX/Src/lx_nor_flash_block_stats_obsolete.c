@@ -0,0 +1,89 @@
+/**************************************************************************/
+/**************************************************************************/
+/**                                                                       */
+/** LevelX Component                                                      */
+/**                                                                       */
+/**   NOR Flash                                                           */
+/**                                                                       */
+/**************************************************************************/
+/**************************************************************************/
+
+#define LX_SOURCE_CODE
+
+
+/* Disable ThreadX error checking.  */
+
+#ifndef LX_DISABLE_ERROR_CHECKING
+#define LX_DISABLE_ERROR_CHECKING
+#endif
+
+
+/* Include necessary system files.  */
+
+#include "lx_api.h"
+
+
+/**************************************************************************/
+/*                                                                        */
+/*  FUNCTION                                               RELEASE        */
+/*                                                                        */
+/*    _lx_nor_flash_block_stats_obsolete                  PORTABLE C      */
+/*                                                                        */
+/*  DESCRIPTION                                                           */
+/*                                                                        */
+/*    This function records a mapped physical sector made obsolete in     */
+/*    the block statistics table and moves its block to the next bucket.  */
+/*                                                                        */
+/*  INPUT                                                                 */
+/*                                                                        */
+/*    nor_flash                             NOR flash instance            */
+/*    mapping_address                       Mapping entry of the sector   */
+/*                                                                        */
+/*  OUTPUT                                                                */
+/*                                                                        */
+/*    None                                                                */
+/*                                                                        */
+/*  CALLS                                                                 */
+/*                                                                        */
+/*    _lx_nor_flash_block_stats_bucket_move Move block to another bucket  */
+/*                                                                        */
+/*  CALLED BY                                                             */
+/*                                                                        */
+/*    _lx_nor_flash_block_reclaim_sector_move                             */
+/*                                          Move sector out of block      */
+/*    _lx_nor_flash_sector_release          Release a sector              */
+/*    _lx_nor_flash_sector_write            Write a sector                */
+/*    _lx_nor_flash_sectors_write           Write a run of sectors        */
+/*                                                                        */
+/**************************************************************************/
+VOID  _lx_nor_flash_block_stats_obsolete(LX_NOR_FLASH *nor_flash, ULONG *mapping_address)
+{
+#ifdef LX_NOR_ENABLE_BLOCK_STATS
+
+LX_NOR_FLASH_BLOCK_STATS    *entry;
+ULONG                       block;
+
+
+    /* Determine if the block statistics table is in use.  */
+    if (nor_flash -> lx_nor_flash_block_stats == LX_NULL)
+    {
+
+        /* No, nothing to record.  */
+        return;
+    }
+
+    /* Get the block number from mapping address.  */
+    block =  (ULONG)(mapping_address - nor_flash -> lx_nor_flash_base_address) / nor_flash -> lx_nor_flash_words_per_block;
+    entry =  &nor_flash -> lx_nor_flash_block_stats[block];
+
+    /* The sector is no longer mapped.  */
+    entry -> lx_nor_flash_block_stats_mapped_sectors--;
+
+    /* Move the block to the bucket of one more obsolete sector.  */
+    _lx_nor_flash_block_stats_bucket_move(nor_flash, block, (ULONG) entry -> lx_nor_flash_block_stats_obsolete_sectors + 1);
+#else
+
+    LX_PARAMETER_NOT_USED(nor_flash);
+    LX_PARAMETER_NOT_USED(mapping_address);
+#endif
+}
@@ -0,0 +1,292 @@
+/**************************************************************************/
+/**************************************************************************/
+/**                                                                       */
+/** LevelX Component                                                      */
+/**                                                                       */
+/**   NOR Flash                                                           */
+/**                                                                       */
+/**************************************************************************/
+/**************************************************************************/
+
+#define LX_SOURCE_CODE
+
+
+/* Disable ThreadX error checking.  */
+
+#ifndef LX_DISABLE_ERROR_CHECKING
+#define LX_DISABLE_ERROR_CHECKING
+#endif
+
+
+/* Include necessary system files.  */
+
+#include "lx_api.h"
+
+
+/**************************************************************************/
+/*                                                                        */
+/*  FUNCTION                                               RELEASE        */
+/*                                                                        */
+/*    _lx_nor_flash_block_stats_sector_allocate           PORTABLE C      */
+/*                                                                        */
+/*  DESCRIPTION                                                           */
+/*                                                                        */
+/*    This function allocates a free physical sector with the block       */
+/*    statistics table. Starting at the search pointer it passes over     */
+/*    full blocks, and the block of the other search pointer on a first   */
+/*    round, without reading the flash. The free sectors of a block are   */
+/*    always its last ones, so the first free sector follows from the     */
+/*    free count and its bit map word is programmed without reading it.   */
+/*    When the block fills up, its minimum and maximum logical sector     */
+/*    are taken from the table, the mapping list is only read when the    */
+/*    range is not known.                                                 */
+/*                                                                        */
+/*  INPUT                                                                 */
+/*                                                                        */
+/*    nor_flash                             NOR flash instance            */
+/*    logical_sector                        Logical sector number         */
+/*    search_pointer                        Search pointer to use         */
+/*    search_blocks                         Blocks to search              */
+/*    other_block                           Block of the other search     */
+/*                                            pointer, LX_ALL_ONES if none*/
+/*    physical_sector_map_entry             Pointer to sector map entry   */
+/*    physical_sector_address               Address of physical sector    */
+/*                                                                        */
+/*  OUTPUT                                                                */
+/*                                                                        */
+/*    return status                                                       */
+/*                                                                        */
+/*  CALLS                                                                 */
+/*                                                                        */
+/*    _lx_nor_flash_block_stats_allocate    Record allocation in table    */
+/*    _lx_nor_flash_driver_read             Driver flash sector read      */
+/*    _lx_nor_flash_driver_write            Driver flash sector write     */
+/*    _lx_nor_flash_system_error            Internal system error handler */
+/*                                                                        */
+/*  CALLED BY                                                             */
+/*                                                                        */
+/*    _lx_nor_flash_physical_sector_allocate                              */
+/*                                          Allocate new logical sector   */
+/*                                                                        */
+/**************************************************************************/
+UINT  _lx_nor_flash_block_stats_sector_allocate(LX_NOR_FLASH *nor_flash, ULONG logical_sector, ULONG *search_pointer, ULONG search_blocks,
+                                                ULONG other_block, ULONG **physical_sector_map_entry, ULONG **physical_sector_address)
+{
+#ifdef LX_NOR_ENABLE_RAM_ALLOCATE
+
+LX_NOR_FLASH_BLOCK_STATS    *entry;
+ULONG                       search_block;
+ULONG                       *block_word_ptr;
+ULONG                       block_word;
+ULONG                       min_logical_sector;
+ULONG                       max_logical_sector;
+ULONG                       *list_word_ptr;
+ULONG                       list_word;
+ULONG                       sector;
+ULONG                       i, j, k;
+UINT                        status;
+
+
+    /* Pickup the search for a free physical sector at the specified block.  */
+    search_block =  *search_pointer;
+
+    /* Loop through the blocks to find one with a free physical sector.  */
+    for (i = 0; i < search_blocks; i++)
+    {
+
+        /* Is there a free sector in this block that may be used?  */
+        if ((nor_flash -> lx_nor_flash_block_stats[search_block].lx_nor_flash_block_stats_free_sectors) &&
+            ((search_block != other_block) || (i >= nor_flash -> lx_nor_flash_total_blocks)))
+        {
+
+            /* Yes, use this block.  */
+            break;
+        }
+
+        /* Move to the next flash block.  */
+        search_block++;
+
+        /* Determine if we have to wrap the search block.  */
+        if (search_block >= nor_flash -> lx_nor_flash_total_blocks)
+        {
+
+            /* Set the search block to the beginning.  */
+            search_block =  0;
+        }
+    }
+
+    /* Determine if a block was found.  */
+    if (i == search_blocks)
+    {
+
+        /* Increment the number of failed allocations.  */
+        nor_flash -> lx_nor_flash_physical_block_allocate_errors++;
+
+        /* Return no sector completion.  */
+        return(LX_NO_SECTORS);
+    }
+
+    /* Pickup the entry of the block and the first free sector, the free sectors are the last ones of the block.  */
+    entry =   &nor_flash -> lx_nor_flash_block_stats[search_block];
+    sector =  nor_flash -> lx_nor_flash_physical_sectors_per_block - (ULONG) entry -> lx_nor_flash_block_stats_free_sectors;
+    j =       sector / 32;
+    k =       sector % 32;
+
+    /* Setup the block word pointer to the first word of the search block.  */
+    block_word_ptr =  nor_flash -> lx_nor_flash_base_address + (search_block * nor_flash -> lx_nor_flash_words_per_block);
+
+    /* Build the free bit map word with the bits of this sector and the sectors before it cleared.  */
+    block_word =  (LX_ALL_ONES << k) << 1;
+    if (j == (nor_flash -> lx_nor_flash_block_bit_map_words - 1))
+    {
+
+        /* The last word only holds the bits of the remaining sectors.  */
+        block_word =  block_word & nor_flash -> lx_nor_flash_block_bit_map_mask;
+    }
+
+    /* Now write the free bit map word with the bit for this sector cleared.  */
+    status =  _lx_nor_flash_driver_write(nor_flash, (block_word_ptr + nor_flash -> lx_nor_flash_block_free_bit_map_offset + j), &block_word, 1);
+
+    /* Check for an error from flash driver. Drivers should never return an error..  */
+    if (status)
+    {
+
+        /* Call system error handler.  */
+        _lx_nor_flash_system_error(nor_flash, status);
+
+        /* Return the error.  */
+        return(status);
+    }
+
+    /* Record the allocation in the block statistics table.  */
+    _lx_nor_flash_block_stats_allocate(nor_flash, search_block, logical_sector);
+
+    /* Determine if this is the last entry available in this block.  */
+    if (entry -> lx_nor_flash_block_stats_free_sectors == 0)
+    {
+
+        /* Yes, pickup the minimum and maximum logical sector of the block.  */
+        min_logical_sector =  entry -> lx_nor_flash_block_stats_min_logical_sector;
+        max_logical_sector =  entry -> lx_nor_flash_block_stats_max_logical_sector;
+
+        /* Determine if the range is not known.  */
+        if (max_logical_sector == LX_NOR_LOGICAL_SECTOR_MASK)
+        {
+
+            /* Setup the minimum and maximum logical sectors to the current logical sector.  */
+            min_logical_sector =  logical_sector;
+            max_logical_sector =  logical_sector;
+
+            /* Setup a pointer to the mapped list.  */
+            list_word_ptr =  block_word_ptr + nor_flash -> lx_nor_flash_block_physical_sector_mapping_offset;
+
+            /* Loop to search the mapped list.  */
+            for (i = 0; i < nor_flash -> lx_nor_flash_physical_sectors_per_block; i++)
+            {
+
+                /* Read the mapped sector entry.  */
+#ifdef LX_DIRECT_READ
+
+                /* Read the word directly.  */
+                list_word =  *(list_word_ptr);
+#else
+                status =  _lx_nor_flash_driver_read(nor_flash, list_word_ptr, &list_word, 1);
+
+                /* Check for an error from flash driver. Drivers should never return an error..  */
+                if (status)
+                {
+
+                    /* Call system error handler.  */
+                    _lx_nor_flash_system_error(nor_flash, status);
+
+                    /* Return the error.  */
+                    return(status);
+                }
+#endif
+
+                /* Is this entry valid?  */
+                if (list_word & LX_NOR_PHYSICAL_SECTOR_VALID)
+                {
+
+                    /* Isolate the logical sector.  */
+                    list_word =  list_word & LX_NOR_LOGICAL_SECTOR_MASK;
+
+                    /* Determine if a new minimum has been found.  */
+                    if (list_word < min_logical_sector)
+                        min_logical_sector =  list_word;
+
+                    /* Determine if a new maximum has been found.  */
+                    if (list_word != LX_NOR_LOGICAL_SECTOR_MASK)
+                    {
+                        if (list_word > max_logical_sector)
+                            max_logical_sector =  list_word;
+                    }
+                }
+
+                /* Move the list pointer ahead.  */
+                list_word_ptr++;
+            }
+        }
+
+        /* Move the search pointer forward, since we know this block is exhausted.  */
+        search_block++;
+
+        /* Check for wrap condition on the search block.  */
+        if (search_block >= nor_flash -> lx_nor_flash_total_blocks)
+        {
+
+            /* Reset search block to the beginning.  */
+            search_block =  0;
+        }
+
+        /* Now write the minimum and maximum logical sector in this block.  */
+        status =  _lx_nor_flash_driver_write(nor_flash, block_word_ptr + LX_NOR_FLASH_MIN_LOGICAL_SECTOR_OFFSET, &min_logical_sector, 1);
+
+        /* Check for an error from flash driver. Drivers should never return an error..  */
+        if (status)
+        {
+
+            /* Call system error handler.  */
+            _lx_nor_flash_system_error(nor_flash, status);
+
+            /* Return the error.  */
+            return(status);
+        }
+
+        status =  _lx_nor_flash_driver_write(nor_flash, block_word_ptr + LX_NOR_FLASH_MAX_LOGICAL_SECTOR_OFFSET, &max_logical_sector, 1);
+
+        /* Check for an error from flash driver. Drivers should never return an error..  */
+        if (status)
+        {
+
+            /* Call system error handler.  */
+            _lx_nor_flash_system_error(nor_flash, status);
+
+            /* Return the error.  */
+            return(status);
+        }
+    }
+
+    /* Remember the block to search.  */
+    *search_pointer =  search_block;
+
+    /* Prepare the return information.  */
+    *physical_sector_map_entry =  block_word_ptr + nor_flash -> lx_nor_flash_block_physical_sector_mapping_offset + sector;
+    *physical_sector_address =    block_word_ptr + nor_flash -> lx_nor_flash_block_physical_sector_offset + (sector * LX_NOR_SECTOR_SIZE);
+
+    /* Return success!  */
+    return(LX_SUCCESS);
+#else
+
+    LX_PARAMETER_NOT_USED(nor_flash);
+    LX_PARAMETER_NOT_USED(logical_sector);
+    LX_PARAMETER_NOT_USED(search_pointer);
+    LX_PARAMETER_NOT_USED(search_blocks);
+    LX_PARAMETER_NOT_USED(other_block);
+    LX_PARAMETER_NOT_USED(physical_sector_map_entry);
+    LX_PARAMETER_NOT_USED(physical_sector_address);
+
+    /* Return disabled status.  */
+    return(LX_DISABLED);
+#endif
+}
@@ -0,0 +1,187 @@
+/**************************************************************************/
+/**************************************************************************/
+/**                                                                       */
+/** LevelX Component                                                      */
+/**                                                                       */
+/**   NOR Flash                                                           */
+/**                                                                       */
+/**************************************************************************/
+/**************************************************************************/
+
+#define LX_SOURCE_CODE
+
+
+/* Disable ThreadX error checking.  */
+
+#ifndef LX_DISABLE_ERROR_CHECKING
+#define LX_DISABLE_ERROR_CHECKING
+#endif
+
+
+/* Include necessary system files.  */
+
+#include "lx_api.h"
+
+
+/**************************************************************************/
+/*                                                                        */
+/*  FUNCTION                                               RELEASE        */
+/*                                                                        */
+/*    _lx_nor_flash_block_stats_victim_find               PORTABLE C      */
+/*                                                                        */
+/*  DESCRIPTION                                                           */
+/*                                                                        */
+/*    This function finds the next block to erase from the block          */
+/*    statistics table, without reading the flash. It makes the choice    */
+/*    of the flash scan: a fully obsolete block at the minimum erase      */
+/*    count first, then the block with the most obsolete sectors within   */
+/*    the erase count threshold (the smaller erase count, then the lower  */
+/*    block on a tie), and the block with the smallest erase count when   */
+/*    no block within the threshold has obsolete sectors. The buckets     */
+/*    are searched from the highest obsolete count down, so usually only  */
+/*    the first bucket is looked at.                                      */
+/*                                                                        */
+/*  INPUT                                                                 */
+/*                                                                        */
+/*    nor_flash                             NOR flash instance            */
+/*    return_erase_block                    Returned block to erase       */
+/*    return_erase_count                    Returned erase count of block */
+/*    return_mapped_sectors                 Returned number of mapped     */
+/*                                            sectors                     */
+/*    return_obsolete_sectors               Returned number of obsolete   */
+/*                                            sectors                     */
+/*                                                                        */
+/*  OUTPUT                                                                */
+/*                                                                        */
+/*    return status                                                       */
+/*                                                                        */
+/*  CALLS                                                                 */
+/*                                                                        */
+/*    None                                                                */
+/*                                                                        */
+/*  CALLED BY                                                             */
+/*                                                                        */
+/*    _lx_nor_flash_next_block_to_erase_find                              */
+/*                                          Find next block to erase      */
+/*                                                                        */
+/**************************************************************************/
+UINT  _lx_nor_flash_block_stats_victim_find(LX_NOR_FLASH *nor_flash, ULONG *return_erase_block, ULONG *return_erase_count, ULONG *return_mapped_sectors, ULONG *return_obsolete_sectors)
+{
+#ifdef LX_NOR_ENABLE_BLOCK_STATS
+
+LX_NOR_FLASH_BLOCK_STATS    *stats;
+ULONG                       erase_count_threshold;
+ULONG                       erase_count;
+ULONG                       best_block;
+ULONG                       best_erase_count;
+ULONG                       bucket;
+ULONG                       block;
+
+
+    /* Pickup the table.  */
+    stats =  nor_flash -> lx_nor_flash_block_stats;
+
+    /* No block found yet.  */
+    best_block =        LX_ALL_ONES;
+    best_erase_count =  LX_ALL_ONES;
+
+    /* Determine if fully obsoleted blocks are present and blocks are at the minimum erase count.  */
+    bucket =  nor_flash -> lx_nor_flash_physical_sectors_per_block;
+    if ((nor_flash -> lx_nor_flash_block_stats_highest_bucket == bucket) && (nor_flash -> lx_nor_flash_minimum_erased_blocks > 0))
+    {
+
+        /* Look for the lowest fully obsoleted block with the minimum erase count.  */
+        for (block = nor_flash -> lx_nor_flash_block_stats_buckets[bucket]; block != LX_NOR_BLOCK_STATS_NONE; block = stats[block].lx_nor_flash_block_stats_next)
+        {
+
+            /* Is this block at the minimum erase count?  */
+            if ((stats[block].lx_nor_flash_block_stats_erase_count == nor_flash -> lx_nor_flash_minimum_erase_count) && (block < best_block))
+            {
+
+                /* Yes, remember it.  */
+                best_block =  block;
+            }
+        }
+    }
+
+    /* Determine if the block is found.  */
+    if (best_block == LX_ALL_ONES)
+    {
+
+        /* Calculate the erase count threshold.  */
+        if (nor_flash -> lx_nor_flash_free_physical_sectors >= nor_flash -> lx_nor_flash_physical_sectors_per_block)
+        {
+
+            /* Calculate erase count threshold by adding constant to the current minimum.  */
+            erase_count_threshold =  nor_flash -> lx_nor_flash_minimum_erase_count + LX_NOR_FLASH_MAX_ERASE_COUNT_DELTA;
+        }
+        else
+        {
+
+            /* When the number of free sectors is low, simply pick the block that has the most number of obsolete sectors.  */
+            erase_count_threshold =  LX_ALL_ONES;
+        }
+
+        /* Search the buckets from the most obsolete sectors down.  */
+        for (bucket = nor_flash -> lx_nor_flash_block_stats_highest_bucket; (bucket) && (best_block == LX_ALL_ONES); bucket--)
+        {
+
+            /* Look for the block with the smallest erase count within the threshold in this bucket.  */
+            for (block = nor_flash -> lx_nor_flash_block_stats_buckets[bucket]; block != LX_NOR_BLOCK_STATS_NONE; block = stats[block].lx_nor_flash_block_stats_next)
+            {
+
+                /* Pickup the erase count of this block.  */
+                erase_count =  stats[block].lx_nor_flash_block_stats_erase_count;
+
+                /* Is this block a better choice?  */
+                if ((erase_count <= erase_count_threshold) &&
+                    ((erase_count < best_erase_count) || ((erase_count == best_erase_count) && (block < best_block))))
+                {
+
+                    /* Yes, remember it.  */
+                    best_block =        block;
+                    best_erase_count =  erase_count;
+                }
+            }
+        }
+    }
+
+    /* Determine if the block is found.  */
+    if (best_block == LX_ALL_ONES)
+    {
+
+        /* Otherwise, choose the block with the smallest erase count.  */
+        for (block = 0; block < nor_flash -> lx_nor_flash_total_blocks; block++)
+        {
+
+            /* Determine if we have a new minimum erase count.  */
+            if (stats[block].lx_nor_flash_block_stats_erase_count < best_erase_count)
+            {
+
+                /* Update the new minimum erase count.  */
+                best_block =        block;
+                best_erase_count =  stats[block].lx_nor_flash_block_stats_erase_count;
+            }
+        }
+    }
+
+    /* Return the block and its counts.  */
+    *return_erase_block =       best_block;
+    *return_erase_count =       stats[best_block].lx_nor_flash_block_stats_erase_count;
+    *return_mapped_sectors =    (ULONG) stats[best_block].lx_nor_flash_block_stats_mapped_sectors;
+    *return_obsolete_sectors =  (ULONG) stats[best_block].lx_nor_flash_block_stats_obsolete_sectors;
+
+    /* Return success.  */
+    return(LX_SUCCESS);
+#else
+
+    LX_PARAMETER_NOT_USED(nor_flash);
+    LX_PARAMETER_NOT_USED(return_erase_block);
+    LX_PARAMETER_NOT_USED(return_erase_count);
+    LX_PARAMETER_NOT_USED(return_mapped_sectors);
+    LX_PARAMETER_NOT_USED(return_obsolete_sectors);
+
+    /* Return disabled status.  */
+    return(LX_DISABLED);
+#endif
+}
@@ -0,0 +1,111 @@
+/**************************************************************************/
+/**************************************************************************/
+/**                                                                       */
+/** LevelX Component                                                      */
+/**                                                                       */
+/**   NOR Flash                                                           */
+/**                                                                       */
+/**************************************************************************/
+/**************************************************************************/
+
+#define LX_SOURCE_CODE
+
+
+/* Disable ThreadX error checking.  */
+
+#ifndef LX_DISABLE_ERROR_CHECKING
+#define LX_DISABLE_ERROR_CHECKING
+#endif
+
+
+/* Include necessary system files.  */
+
+#include "lx_api.h"
+
+
+/**************************************************************************/
+/*                                                                        */
+/*  FUNCTION                                               RELEASE        */
+/*                                                                        */
+/*    _lx_nor_flash_checkpoint_block_dirty                PORTABLE C      */
+/*                                                                        */
+/*  DESCRIPTION                                                           */
+/*                                                                        */
+/*    This function marks a block as changed in the active checkpoint     */
+/*    record before the block is first written or erased, so a power      */
+/*    loss can never leave a changed block trusted by the next open.      */
+/*    Only the first change after a checkpoint programs the flash, later  */
+/*    ones are filtered by the RAM copy of the bit map.                   */
+/*                                                                        */
+/*  INPUT                                                                 */
+/*                                                                        */
+/*    nor_flash                             NOR flash instance            */
+/*    block                                 Block about to change         */
+/*                                                                        */
+/*  OUTPUT                                                                */
+/*                                                                        */
+/*    return status                                                       */
+/*                                                                        */
+/*  CALLS                                                                 */
+/*                                                                        */
+/*    (lx_nor_flash_driver_write)           Actual driver write           */
+/*                                                                        */
+/*  CALLED BY                                                             */
+/*                                                                        */
+/*    _lx_nor_flash_driver_block_erase      Driver erase block            */
+/*    _lx_nor_flash_driver_write            Driver flash sector write     */
+/*                                                                        */
+/**************************************************************************/
+UINT  _lx_nor_flash_checkpoint_block_dirty(LX_NOR_FLASH *nor_flash, ULONG block)
+{
+#ifdef LX_NOR_ENABLE_CHECKPOINT
+
+ULONG   *map_word_ptr;
+ULONG   bit;
+ULONG   map_word;
+UINT    status;
+
+
+    /* Determine if there is an active record and the address is a managed block.  */
+    if ((nor_flash -> lx_nor_flash_checkpoint_record == LX_NULL) || (block >= nor_flash -> lx_nor_flash_total_blocks))
+    {
+
+        /* Nothing to mark.  */
+        return(LX_SUCCESS);
+    }
+
+    /* Determine if the block is already marked.  */
+    map_word_ptr =  &nor_flash -> lx_nor_flash_checkpoint_block_map[block >> 5];
+    bit =           (ULONG) 1 << (block & 31);
+    if (*map_word_ptr & bit)
+    {
+
+        /* Yes, nothing to do.  */
+        return(LX_SUCCESS);
+    }
+
+    /* Mark the block in RAM and count it.  */
+    *map_word_ptr =  *map_word_ptr | bit;
+    nor_flash -> lx_nor_flash_checkpoint_dirty_blocks++;
+
+    /* Program the bit map word of the record. The RAM copy mirrors it, so only cleared bits are written.  */
+    map_word =  ~(*map_word_ptr);
+#ifdef LX_NOR_ENABLE_CONTROL_BLOCK_FOR_DRIVER_INTERFACE
+    status =  (nor_flash -> lx_nor_flash_driver_write)(nor_flash, nor_flash -> lx_nor_flash_checkpoint_record + LX_NOR_CHECKPOINT_HEADER_WORDS +
+                                                       (nor_flash -> lx_nor_flash_total_blocks * LX_NOR_CHECKPOINT_SUMMARY_WORDS) + (block >> 5), &map_word, 1);
+#else
+    status =  (nor_flash -> lx_nor_flash_driver_write)(nor_flash -> lx_nor_flash_checkpoint_record + LX_NOR_CHECKPOINT_HEADER_WORDS +
+                                                       (nor_flash -> lx_nor_flash_total_blocks * LX_NOR_CHECKPOINT_SUMMARY_WORDS) + (block >> 5), &map_word, 1);
+#endif
+
+    /* Return completion status.  */
+    return(status);
+#else
+
+    LX_PARAMETER_NOT_USED(nor_flash);
+    LX_PARAMETER_NOT_USED(block);
+
+    /* Return successful completion.  */
+    return(LX_SUCCESS);
+#endif
+}
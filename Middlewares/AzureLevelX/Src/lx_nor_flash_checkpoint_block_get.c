@@ -0,0 +1,127 @@
+/**************************************************************************/
+/**************************************************************************/
+/**                                                                       */
+/** LevelX Component                                                      */
+/**                                                                       */
+/**   NOR Flash                                                           */
+/**                                                                       */
+/**************************************************************************/
+/**************************************************************************/
+
+#define LX_SOURCE_CODE
+
+
+/* Disable ThreadX error checking.  */
+
+#ifndef LX_DISABLE_ERROR_CHECKING
+#define LX_DISABLE_ERROR_CHECKING
+#endif
+
+
+/* Include necessary system files.  */
+
+#include "lx_api.h"
+
+
+/**************************************************************************/
+/*                                                                        */
+/*  FUNCTION                                               RELEASE        */
+/*                                                                        */
+/*    _lx_nor_flash_checkpoint_block_get                  PORTABLE C      */
+/*                                                                        */
+/*  DESCRIPTION                                                           */
+/*                                                                        */
+/*    This function returns the erase count, free and obsolete sectors    */
+/*    of a block from the active checkpoint record. It fails if there is  */
+/*    no active record or the block changed since it was written, the     */
+/*    caller then scans the block in flash.                               */
+/*                                                                        */
+/*  INPUT                                                                 */
+/*                                                                        */
+/*    nor_flash                             NOR flash instance            */
+/*    block                                 Block number                  */
+/*    erase_count                           Destination for erase count   */
+/*    free_sectors                          Destination for free sectors  */
+/*    obsolete_sectors                      Destination for obsolete      */
+/*                                            sectors                     */
+/*                                                                        */
+/*  OUTPUT                                                                */
+/*                                                                        */
+/*    return status                                                       */
+/*                                                                        */
+/*  CALLS                                                                 */
+/*                                                                        */
+/*    _lx_nor_flash_driver_read             Driver flash sector read      */
+/*                                                                        */
+/*  CALLED BY                                                             */
+/*                                                                        */
+/*    _lx_nor_flash_open                    Open NOR flash                */
+/*    _lx_nor_flash_extended_cache_enable   Enable extended cache         */
+/*                                                                        */
+/**************************************************************************/
+UINT  _lx_nor_flash_checkpoint_block_get(LX_NOR_FLASH *nor_flash, ULONG block, ULONG *erase_count, ULONG *free_sectors, ULONG *obsolete_sectors)
+{
+#ifdef LX_NOR_ENABLE_CHECKPOINT
+
+ULONG   *summary_ptr;
+ULONG   summary[LX_NOR_CHECKPOINT_SUMMARY_WORDS];
+#ifndef LX_DIRECT_READ
+UINT    status;
+#endif
+
+
+    /* Determine if there is an active record and the block is unchanged since it was written.  */
+    if ((nor_flash -> lx_nor_flash_checkpoint_record == LX_NULL) ||
+        (nor_flash -> lx_nor_flash_checkpoint_block_map[block >> 5] & ((ULONG) 1 << (block & 31))))
+    {
+
+        /* No, the block must be scanned.  */
+        return(LX_ERROR);
+    }
+
+    /* Pickup the summary of the block.  */
+    summary_ptr =  nor_flash -> lx_nor_flash_checkpoint_record + LX_NOR_CHECKPOINT_HEADER_WORDS + (block * LX_NOR_CHECKPOINT_SUMMARY_WORDS);
+#ifdef LX_DIRECT_READ
+
+    /* Read the summary directly.  */
+    summary[0] =  *(summary_ptr);
+    summary[1] =  *(summary_ptr + 1);
+#else
+    status =  _lx_nor_flash_driver_read(nor_flash, summary_ptr, summary, LX_NOR_CHECKPOINT_SUMMARY_WORDS);
+
+    /* Check for an error from flash driver.  */
+    if (status)
+    {
+
+        /* Let the caller scan the block, it reports the error.  */
+        return(LX_ERROR);
+    }
+#endif
+
+    /* A block that was being erased when the record was written has to be scanned.  */
+    if (((summary[0] & LX_BLOCK_ERASED) == LX_BLOCK_ERASED) || (summary[0] == LX_BLOCK_ERASE_STARTED))
+    {
+
+        /* Scan the block.  */
+        return(LX_ERROR);
+    }
+
+    /* Return the summary.  */
+    *erase_count =       summary[0] & LX_BLOCK_ERASE_COUNT_MASK;
+    *free_sectors =      summary[1] & LX_NOR_CHECKPOINT_COUNT_MASK;
+    *obsolete_sectors =  summary[1] >> LX_NOR_CHECKPOINT_OBSOLETE_SHIFT;
+
+    /* Return successful completion.  */
+    return(LX_SUCCESS);
+#else
+
+    LX_PARAMETER_NOT_USED(nor_flash);
+    LX_PARAMETER_NOT_USED(block);
+    LX_PARAMETER_NOT_USED(erase_count);
+    LX_PARAMETER_NOT_USED(free_sectors);
+    LX_PARAMETER_NOT_USED(obsolete_sectors);
+
+    /* Return disabled status.  */
+    return(LX_DISABLED);
+#endif
+}
@@ -0,0 +1,106 @@
+/**************************************************************************/
+/**************************************************************************/
+/**                                                                       */
+/** LevelX Component                                                      */
+/**                                                                       */
+/**   NOR Flash                                                           */
+/**                                                                       */
+/**************************************************************************/
+/**************************************************************************/
+
+#define LX_SOURCE_CODE
+
+
+/* Disable ThreadX error checking.  */
+
+#ifndef LX_DISABLE_ERROR_CHECKING
+#define LX_DISABLE_ERROR_CHECKING
+#endif
+
+
+/* Include necessary system files.  */
+
+#include "lx_api.h"
+
+
+#ifdef LX_NOR_ENABLE_CHECKPOINT
+
+/* Reflected CRC-32 (polynomial 0xEDB88320) of every 4-bit value, the table costs 64 bytes of flash.  */
+
+static const ULONG  _lx_nor_flash_checkpoint_crc_table[16] =
+{
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+#endif
+
+
+/**************************************************************************/
+/*                                                                        */
+/*  FUNCTION                                               RELEASE        */
+/*                                                                        */
+/*    _lx_nor_flash_checkpoint_crc                        PORTABLE C      */
+/*                                                                        */
+/*  DESCRIPTION                                                           */
+/*                                                                        */
+/*    This function updates the CRC-32 of a checkpoint record with an     */
+/*    array of words, least significant byte first. Pass 0 to start and   */
+/*    the previous result to continue, like RedCrc32Update.               */
+/*                                                                        */
+/*  INPUT                                                                 */
+/*                                                                        */
+/*    crc                                   Previous CRC, 0 to start      */
+/*    words                                 Words to add                  */
+/*    count                                 Number of words               */
+/*                                                                        */
+/*  OUTPUT                                                                */
+/*                                                                        */
+/*    updated CRC                                                         */
+/*                                                                        */
+/*  CALLS                                                                 */
+/*                                                                        */
+/*    None                                                                */
+/*                                                                        */
+/*  CALLED BY                                                             */
+/*                                                                        */
+/*    _lx_nor_flash_checkpoint_load         Load checkpoint at open       */
+/*    _lx_nor_flash_checkpoint_write        Write checkpoint              */
+/*                                                                        */
+/**************************************************************************/
+ULONG  _lx_nor_flash_checkpoint_crc(ULONG crc, ULONG *words, ULONG count)
+{
+#ifdef LX_NOR_ENABLE_CHECKPOINT
+
+ULONG   word;
+ULONG   i;
+
+
+    /* Start from the inverted CRC.  */
+    crc =  ~crc;
+
+    /* Loop through the words.  */
+    while (count--)
+    {
+
+        /* Pickup the next word.  */
+        word =  *words++;
+
+        /* Process the word a nibble at a time, least significant first.  */
+        for (i = 0; i < 8; i++)
+        {
+            crc =   (crc >> 4) ^ _lx_nor_flash_checkpoint_crc_table[(crc ^ word) & 0xF];
+            word =  word >> 4;
+        }
+    }
+
+    /* Return the final CRC.  */
+    return(~crc);
+#else
+
+    LX_PARAMETER_NOT_USED(words);
+    LX_PARAMETER_NOT_USED(count);
+
+    /* Return the CRC unchanged.  */
+    return(crc);
+#endif
+}
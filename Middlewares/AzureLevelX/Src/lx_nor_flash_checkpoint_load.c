@@ -0,0 +1,300 @@
+/**************************************************************************/
+/**************************************************************************/
+/**                                                                       */
+/** LevelX Component                                                      */
+/**                                                                       */
+/**   NOR Flash                                                           */
+/**                                                                       */
+/**************************************************************************/
+/**************************************************************************/
+
+#define LX_SOURCE_CODE
+
+
+/* Disable ThreadX error checking.  */
+
+#ifndef LX_DISABLE_ERROR_CHECKING
+#define LX_DISABLE_ERROR_CHECKING
+#endif
+
+
+/* Include necessary system files.  */
+
+#include "lx_api.h"
+
+
+/**************************************************************************/
+/*                                                                        */
+/*  FUNCTION                                               RELEASE        */
+/*                                                                        */
+/*    _lx_nor_flash_checkpoint_load                       PORTABLE C      */
+/*                                                                        */
+/*  DESCRIPTION                                                           */
+/*                                                                        */
+/*    This function finds the newest valid checkpoint record in the area  */
+/*    reserved by the driver and loads its changed block bit map into     */
+/*    RAM. A record is valid if its magic, geometry, CRC and totals       */
+/*    match. Without one (or without a checkpoint area) the checkpoint    */
+/*    is left inactive and open scans every block.                        */
+/*                                                                        */
+/*  INPUT                                                                 */
+/*                                                                        */
+/*    nor_flash                             NOR flash instance            */
+/*                                                                        */
+/*  OUTPUT                                                                */
+/*                                                                        */
+/*    return status                                                       */
+/*                                                                        */
+/*  CALLS                                                                 */
+/*                                                                        */
+/*    _lx_nor_flash_checkpoint_crc          Checkpoint record CRC         */
+/*    _lx_nor_flash_driver_read             Driver flash sector read      */
+/*    _lx_nor_flash_system_error            Internal system error handler */
+/*                                                                        */
+/*  CALLED BY                                                             */
+/*                                                                        */
+/*    _lx_nor_flash_open                    Open NOR flash                */
+/*                                                                        */
+/**************************************************************************/
+UINT  _lx_nor_flash_checkpoint_load(LX_NOR_FLASH *nor_flash)
+{
+#ifdef LX_NOR_ENABLE_CHECKPOINT
+
+ULONG   *area_ptr;
+ULONG   *record_ptr;
+ULONG   *best_record_ptr;
+ULONG   *summary_ptr;
+ULONG   header[LX_NOR_CHECKPOINT_HEADER_WORDS];
+ULONG   map_words;
+ULONG   summary_words;
+ULONG   record_words;
+ULONG   records;
+ULONG   crc;
+ULONG   words;
+ULONG   free_sectors;
+ULONG   obsolete_sectors;
+ULONG   mapped_sectors;
+ULONG   total_free;
+ULONG   total_mapped;
+ULONG   total_obsolete;
+ULONG   dirty_word;
+ULONG   dirty_blocks;
+ULONG   i, j, k;
+#ifndef LX_DIRECT_READ
+UINT    status;
+#endif
+
+
+    /* Default to no checkpoint.  */
+    nor_flash -> lx_nor_flash_checkpoint_record =        LX_NULL;
+    nor_flash -> lx_nor_flash_checkpoint_dirty_blocks =  0;
+
+    /* Determine if the driver reserved an area and the RAM needed for it.  */
+    if ((nor_flash -> lx_nor_flash_checkpoint_blocks == 0) || (nor_flash -> lx_nor_flash_checkpoint_block_map == LX_NULL) ||
+        (nor_flash -> lx_nor_flash_sector_buffer == LX_NULL))
+    {
+
+        /* No, the checkpoint is not used by this instance.  */
+        nor_flash -> lx_nor_flash_checkpoint_blocks =  0;
+        return(LX_SUCCESS);
+    }
+
+    /* Calculate the record size, rounded up to whole sectors so every record starts on a program page.  */
+    map_words =      (nor_flash -> lx_nor_flash_total_blocks + 31) / 32;
+    summary_words =  nor_flash -> lx_nor_flash_total_blocks * LX_NOR_CHECKPOINT_SUMMARY_WORDS;
+    record_words =   LX_NOR_CHECKPOINT_HEADER_WORDS + summary_words + map_words;
+    record_words =   ((record_words + LX_NOR_SECTOR_SIZE - 1) / LX_NOR_SECTOR_SIZE) * LX_NOR_SECTOR_SIZE;
+    records =        (nor_flash -> lx_nor_flash_checkpoint_blocks * nor_flash -> lx_nor_flash_words_per_block) / record_words;
+
+    /* Determine if the area holds at least one record.  */
+    if (records == 0)
+    {
+
+        /* No, the area is too small for this geometry.  */
+        nor_flash -> lx_nor_flash_checkpoint_blocks =  0;
+        return(LX_SUCCESS);
+    }
+
+    /* Save the record size.  */
+    nor_flash -> lx_nor_flash_checkpoint_record_words =  record_words;
+
+    /* Clear the changed block bit map.  */
+    for (i = 0; i < map_words; i++)
+    {
+        nor_flash -> lx_nor_flash_checkpoint_block_map[i] =  0;
+    }
+
+    /* The area starts right after the last managed block.  */
+    area_ptr =  nor_flash -> lx_nor_flash_base_address + (nor_flash -> lx_nor_flash_total_blocks * nor_flash -> lx_nor_flash_words_per_block);
+
+    /* Loop through the records to find the newest valid one.  */
+    best_record_ptr =  LX_NULL;
+    for (i = 0; i < records; i++)
+    {
+
+        /* Pickup the header of this record.  */
+        record_ptr =  area_ptr + (i * record_words);
+#ifdef LX_DIRECT_READ
+
+        /* Read the header directly.  */
+        for (j = 0; j < LX_NOR_CHECKPOINT_HEADER_WORDS; j++)
+        {
+            header[j] =  *(record_ptr + j);
+        }
+#else
+        status =  _lx_nor_flash_driver_read(nor_flash, record_ptr, header, LX_NOR_CHECKPOINT_HEADER_WORDS);
+
+        /* Check for an error from flash driver. Drivers should never return an error..  */
+        if (status)
+        {
+
+            /* Call system error handler.  */
+            _lx_nor_flash_system_error(nor_flash, status);
+
+            /* Return an error.  */
+            return(LX_ERROR);
+        }
+#endif
+
+        /* Determine if this is a complete record of this geometry that is newer than the best so far.  */
+        if ((header[LX_NOR_CHECKPOINT_MAGIC_OFFSET] != LX_NOR_CHECKPOINT_MAGIC) ||
+            (header[LX_NOR_CHECKPOINT_BLOCKS_OFFSET] != nor_flash -> lx_nor_flash_total_blocks) ||
+            (header[LX_NOR_CHECKPOINT_SECTORS_OFFSET] != nor_flash -> lx_nor_flash_physical_sectors_per_block) ||
+            ((best_record_ptr) && (header[LX_NOR_CHECKPOINT_SEQUENCE_OFFSET] <= nor_flash -> lx_nor_flash_checkpoint_sequence)))
+        {
+
+            /* No, skip it.  */
+            continue;
+        }
+
+        /* Verify the block summaries a sector at a time and add up the counts.  */
+        crc =             0;
+        total_free =      0;
+        total_mapped =    0;
+        total_obsolete =  0;
+        for (j = 0; j < summary_words; j =  j + words)
+        {
+
+            /* Calculate the number of summary words in this piece.  */
+            words =  summary_words - j;
+            if (words > LX_NOR_SECTOR_SIZE)
+            {
+                words =  LX_NOR_SECTOR_SIZE;
+            }
+
+#ifdef LX_DIRECT_READ
+
+            /* Use the summaries directly.  */
+            summary_ptr =  record_ptr + LX_NOR_CHECKPOINT_HEADER_WORDS + j;
+#else
+            summary_ptr =  nor_flash -> lx_nor_flash_sector_buffer;
+            status =  _lx_nor_flash_driver_read(nor_flash, record_ptr + LX_NOR_CHECKPOINT_HEADER_WORDS + j, summary_ptr, words);
+
+            /* Check for an error from flash driver. Drivers should never return an error..  */
+            if (status)
+            {
+
+                /* Call system error handler.  */
+                _lx_nor_flash_system_error(nor_flash, status);
+
+                /* Return an error.  */
+                return(LX_ERROR);
+            }
+#endif
+
+            /* Add this piece to the CRC.  */
+            crc =  _lx_nor_flash_checkpoint_crc(crc, summary_ptr, words);
+
+            /* Add up the counts of the blocks in this piece.  */
+            for (k = 0; k < words; k =  k + LX_NOR_CHECKPOINT_SUMMARY_WORDS)
+            {
+                free_sectors =      summary_ptr[k + 1] & LX_NOR_CHECKPOINT_COUNT_MASK;
+                obsolete_sectors =  summary_ptr[k + 1] >> LX_NOR_CHECKPOINT_OBSOLETE_SHIFT;
+                mapped_sectors =    nor_flash -> lx_nor_flash_physical_sectors_per_block - free_sectors - obsolete_sectors;
+                total_free =        total_free + free_sectors;
+                total_mapped =      total_mapped + mapped_sectors;
+                total_obsolete =    total_obsolete + obsolete_sectors;
+            }
+        }
+
+        /* Finish the CRC with the header words it covers.  */
+        crc =  _lx_nor_flash_checkpoint_crc(crc, &header[LX_NOR_CHECKPOINT_SEQUENCE_OFFSET], LX_NOR_CHECKPOINT_CRC_OFFSET - LX_NOR_CHECKPOINT_SEQUENCE_OFFSET);
+
+        /* Determine if the record is intact and its totals agree with the summaries.  */
+        if ((crc != header[LX_NOR_CHECKPOINT_CRC_OFFSET]) ||
+            (total_free != header[LX_NOR_CHECKPOINT_FREE_OFFSET]) ||
+            (total_mapped != header[LX_NOR_CHECKPOINT_MAPPED_OFFSET]) ||
+            (total_obsolete != header[LX_NOR_CHECKPOINT_OBSOLETE_OFFSET]))
+        {
+
+            /* No, skip it.  */
+            continue;
+        }
+
+        /* Remember the newest valid record.  */
+        best_record_ptr =  record_ptr;
+        nor_flash -> lx_nor_flash_checkpoint_sequence =  header[LX_NOR_CHECKPOINT_SEQUENCE_OFFSET];
+    }
+
+    /* Determine if a valid record was found.  */
+    if (best_record_ptr == LX_NULL)
+    {
+
+        /* No, open scans every block.  */
+        return(LX_SUCCESS);
+    }
+
+    /* Load the changed block bit map, where a cleared bit in flash is a set bit in RAM.  */
+    dirty_blocks =  0;
+    for (i = 0; i < map_words; i++)
+    {
+
+#ifdef LX_DIRECT_READ
+
+        /* Read the word directly.  */
+        dirty_word =  *(best_record_ptr + LX_NOR_CHECKPOINT_HEADER_WORDS + summary_words + i);
+#else
+        status =  _lx_nor_flash_driver_read(nor_flash, best_record_ptr + LX_NOR_CHECKPOINT_HEADER_WORDS + summary_words + i, &dirty_word, 1);
+
+        /* Check for an error from flash driver. Drivers should never return an error..  */
+        if (status)
+        {
+
+            /* Call system error handler.  */
+            _lx_nor_flash_system_error(nor_flash, status);
+
+            /* Return an error.  */
+            return(LX_ERROR);
+        }
+#endif
+
+        /* Only the bits of existing blocks count.  */
+        dirty_word =  ~dirty_word;
+        if ((i == (map_words - 1)) && (nor_flash -> lx_nor_flash_total_blocks % 32))
+        {
+            dirty_word =  dirty_word & (((ULONG) 1 << (nor_flash -> lx_nor_flash_total_blocks % 32)) - 1);
+        }
+        nor_flash -> lx_nor_flash_checkpoint_block_map[i] =  dirty_word;
+
+        /* Count the changed blocks.  */
+        while (dirty_word)
+        {
+            dirty_word =  dirty_word & (dirty_word - 1);
+            dirty_blocks++;
+        }
+    }
+
+    /* The record is now active: open trusts it for the unchanged blocks and changes are marked in it.  */
+    nor_flash -> lx_nor_flash_checkpoint_record =        best_record_ptr;
+    nor_flash -> lx_nor_flash_checkpoint_dirty_blocks =  dirty_blocks;
+
+    /* Return successful completion.  */
+    return(LX_SUCCESS);
+#else
+
+    LX_PARAMETER_NOT_USED(nor_flash);
+
+    /* Return disabled status.  */
+    return(LX_DISABLED);
+#endif
+}
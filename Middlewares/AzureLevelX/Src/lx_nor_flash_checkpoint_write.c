@@ -0,0 +1,523 @@
+/**************************************************************************/
+/**************************************************************************/
+/**                                                                       */
+/** LevelX Component                                                      */
+/**                                                                       */
+/**   NOR Flash                                                           */
+/**                                                                       */
+/**************************************************************************/
+/**************************************************************************/
+
+#define LX_SOURCE_CODE
+
+
+/* Disable ThreadX error checking.  */
+
+#ifndef LX_DISABLE_ERROR_CHECKING
+#define LX_DISABLE_ERROR_CHECKING
+#endif
+
+
+/* Include necessary system files.  */
+
+#include "lx_api.h"
+
+
+/**************************************************************************/
+/*                                                                        */
+/*  FUNCTION                                               RELEASE        */
+/*                                                                        */
+/*    _lx_nor_flash_checkpoint_write                      PORTABLE C      */
+/*                                                                        */
+/*  DESCRIPTION                                                           */
+/*                                                                        */
+/*    This function writes a fast-mount checkpoint record if there is no  */
+/*    active one or at least dirty_blocks blocks (at least one) changed   */
+/*    since it was written. It must be called while no sector operation   */
+/*    is in progress, i.e. at close or at an idle point.                  */
+/*                                                                        */
+/*    The record goes into the next blank slot of the area, the area is   */
+/*    erased when there is none left. Block summaries are built from the  */
+/*    block headers and the obsolete count cache and must add up to the   */
+/*    instance counts. The magic is programmed last, then the previous    */
+/*    record is cleared, so at any time at most the previous and the new  */
+/*    record are valid and open picks the one with the higher sequence.   */
+/*                                                                        */
+/*  INPUT                                                                 */
+/*                                                                        */
+/*    nor_flash                             NOR flash instance            */
+/*    dirty_blocks                          Changed blocks that trigger   */
+/*                                            a new record                */
+/*                                                                        */
+/*  OUTPUT                                                                */
+/*                                                                        */
+/*    return status                                                       */
+/*                                                                        */
+/*  CALLS                                                                 */
+/*                                                                        */
+/*    _lx_nor_flash_checkpoint_crc          Checkpoint record CRC         */
+/*    _lx_nor_flash_driver_block_erase      Driver erase block            */
+/*    _lx_nor_flash_driver_read             Driver flash sector read      */
+/*    _lx_nor_flash_driver_write            Driver flash sector write     */
+/*    _lx_nor_flash_system_error            Internal system error handler */
+/*    tx_mutex_get                          Get thread protection         */
+/*    tx_mutex_put                          Release thread protection     */
+/*                                                                        */
+/*  CALLED BY                                                             */
+/*                                                                        */
+/*    Application Code                                                    */
+/*    _lx_nor_flash_close                   Close NOR flash               */
+/*                                                                        */
+/**************************************************************************/
+UINT  _lx_nor_flash_checkpoint_write(LX_NOR_FLASH *nor_flash, ULONG dirty_blocks)
+{
+#ifdef LX_NOR_ENABLE_CHECKPOINT
+
+ULONG   *area_ptr;
+ULONG   *record_ptr;
+ULONG   *block_word_ptr;
+ULONG   *summary_ptr;
+ULONG   header[LX_NOR_CHECKPOINT_HEADER_WORDS];
+ULONG   map_words;
+ULONG   summary_words;
+ULONG   record_words;
+ULONG   records;
+ULONG   record;
+ULONG   block_word;
+ULONG   erase_word;
+ULONG   free_sectors;
+ULONG   used_sectors;
+ULONG   obsolete_sectors;
+ULONG   total_free;
+ULONG   total_mapped;
+ULONG   total_obsolete;
+ULONG   crc;
+ULONG   words;
+ULONG   block;
+ULONG   i, j, k;
+UINT    status;
+
+
+    /* Determine if this instance uses a checkpoint.  */
+    if (nor_flash -> lx_nor_flash_checkpoint_blocks == 0)
+    {
+
+        /* No checkpoint area.  */
+        return(LX_DISABLED);
+    }
+
+#ifdef LX_THREAD_SAFE_ENABLE
+
+    /* Obtain the thread safe mutex.  */
+    tx_mutex_get(&nor_flash -> lx_nor_flash_mutex, TX_WAIT_FOREVER);
+#endif
+
+    /* Determine if the active record is still good enough.  */
+    if (dirty_blocks == 0)
+    {
+        dirty_blocks =  1;
+    }
+    if ((nor_flash -> lx_nor_flash_checkpoint_record) && (nor_flash -> lx_nor_flash_checkpoint_dirty_blocks < dirty_blocks))
+    {
+
+#ifdef LX_THREAD_SAFE_ENABLE
+
+        /* Release the thread safe mutex.  */
+        tx_mutex_put(&nor_flash -> lx_nor_flash_mutex);
+#endif
+
+        /* Nothing to write.  */
+        return(LX_SUCCESS);
+    }
+
+    /* Pickup the record geometry computed at open.  */
+    map_words =      (nor_flash -> lx_nor_flash_total_blocks + 31) / 32;
+    summary_words =  nor_flash -> lx_nor_flash_total_blocks * LX_NOR_CHECKPOINT_SUMMARY_WORDS;
+    record_words =   nor_flash -> lx_nor_flash_checkpoint_record_words;
+    records =        (nor_flash -> lx_nor_flash_checkpoint_blocks * nor_flash -> lx_nor_flash_words_per_block) / record_words;
+    area_ptr =       nor_flash -> lx_nor_flash_base_address + (nor_flash -> lx_nor_flash_total_blocks * nor_flash -> lx_nor_flash_words_per_block);
+
+    /* Start looking for a blank slot after the active record.  */
+    record =  0;
+    if (nor_flash -> lx_nor_flash_checkpoint_record)
+    {
+        record =  ((ULONG) (nor_flash -> lx_nor_flash_checkpoint_record - area_ptr) / record_words) + 1;
+    }
+
+    /* Loop through the remaining slots, a slot with an interrupted record is skipped.  */
+    for (; record < records; record++)
+    {
+
+        /* Check the slot a sector at a time.  */
+        record_ptr =  area_ptr + (record * record_words);
+        for (i = 0; i < record_words; i++)
+        {
+
+#ifdef LX_DIRECT_READ
+
+            /* Read the word directly.  */
+            block_word =  *(record_ptr + i);
+#else
+            /* Read the next sector of the slot.  */
+            if ((i % LX_NOR_SECTOR_SIZE) == 0)
+            {
+
+                status =  _lx_nor_flash_driver_read(nor_flash, record_ptr + i, nor_flash -> lx_nor_flash_sector_buffer, LX_NOR_SECTOR_SIZE);
+
+                /* Check for an error from flash driver. Drivers should never return an error..  */
+                if (status)
+                {
+
+                    /* Call system error handler.  */
+                    _lx_nor_flash_system_error(nor_flash, status);
+
+#ifdef LX_THREAD_SAFE_ENABLE
+
+                    /* Release the thread safe mutex.  */
+                    tx_mutex_put(&nor_flash -> lx_nor_flash_mutex);
+#endif
+
+                    /* Return an error.  */
+                    return(LX_ERROR);
+                }
+            }
+            block_word =  nor_flash -> lx_nor_flash_sector_buffer[i % LX_NOR_SECTOR_SIZE];
+#endif
+
+            /* Stop at the first programmed word.  */
+            if (block_word != LX_ALL_ONES)
+            {
+                break;
+            }
+        }
+
+        /* Determine if the slot is blank.  */
+        if (i == record_words)
+        {
+            break;
+        }
+    }
+
+    /* Determine if the area is full.  */
+    if (record == records)
+    {
+
+        /* Yes, clear the active record first, an interrupted erase must not leave it behind half erased.  */
+        if (nor_flash -> lx_nor_flash_checkpoint_record)
+        {
+
+            block_word =  0;
+            status =  _lx_nor_flash_driver_write(nor_flash, nor_flash -> lx_nor_flash_checkpoint_record + LX_NOR_CHECKPOINT_MAGIC_OFFSET, &block_word, 1);
+
+            /* Check for an error from flash driver. Drivers should never return an error..  */
+            if (status)
+            {
+
+                /* Call system error handler.  */
+                _lx_nor_flash_system_error(nor_flash, status);
+
+#ifdef LX_THREAD_SAFE_ENABLE
+
+                /* Release the thread safe mutex.  */
+                tx_mutex_put(&nor_flash -> lx_nor_flash_mutex);
+#endif
+
+                /* Return an error.  */
+                return(LX_ERROR);
+            }
+
+            /* There is no active record until the new one is complete.  */
+            nor_flash -> lx_nor_flash_checkpoint_record =  LX_NULL;
+        }
+
+        /* Erase the area.  */
+        for (i = 0; i < nor_flash -> lx_nor_flash_checkpoint_blocks; i++)
+        {
+
+            status =  _lx_nor_flash_driver_block_erase(nor_flash, nor_flash -> lx_nor_flash_total_blocks + i, 0);
+
+            /* Check for an error from flash driver. Drivers should never return an error..  */
+            if (status)
+            {
+
+                /* Call system error handler.  */
+                _lx_nor_flash_system_error(nor_flash, status);
+
+#ifdef LX_THREAD_SAFE_ENABLE
+
+                /* Release the thread safe mutex.  */
+                tx_mutex_put(&nor_flash -> lx_nor_flash_mutex);
+#endif
+
+                /* Return an error.  */
+                return(LX_ERROR);
+            }
+        }
+
+        /* Start over with the first slot.  */
+        record =  0;
+    }
+
+    /* Build and program the block summaries a sector at a time.  */
+    record_ptr =      area_ptr + (record * record_words);
+    summary_ptr =     nor_flash -> lx_nor_flash_sector_buffer;
+    crc =             0;
+    total_free =      0;
+    total_mapped =    0;
+    total_obsolete =  0;
+    block =           0;
+    for (j = 0; j < summary_words; j =  j + words)
+    {
+
+        /* Calculate the number of summary words in this piece.  */
+        words =  summary_words - j;
+        if (words > LX_NOR_SECTOR_SIZE)
+        {
+            words =  LX_NOR_SECTOR_SIZE;
+        }
+
+        /* Loop through the blocks of this piece.  */
+        for (i = 0; i < words; i =  i + LX_NOR_CHECKPOINT_SUMMARY_WORDS)
+        {
+
+            /* Setup the block word pointer to the first word of the block.  */
+            block_word_ptr =  nor_flash -> lx_nor_flash_base_address + (block * nor_flash -> lx_nor_flash_words_per_block);
+
+            /* Pickup the erase count word.  */
+#ifdef LX_DIRECT_READ
+
+            /* Read the word directly.  */
+            erase_word =  *block_word_ptr;
+#else
+            status =  _lx_nor_flash_driver_read(nor_flash, block_word_ptr, &erase_word, 1);
+
+            /* Check for an error from flash driver. Drivers should never return an error..  */
+            if (status)
+            {
+
+                /* Call system error handler.  */
+                _lx_nor_flash_system_error(nor_flash, status);
+
+#ifdef LX_THREAD_SAFE_ENABLE
+
+                /* Release the thread safe mutex.  */
+                tx_mutex_put(&nor_flash -> lx_nor_flash_mutex);
+#endif
+
+                /* Return an error.  */
+                return(LX_ERROR);
+            }
+#endif
+
+            /* Calculate the number of free sectors from the free sector bit map.  */
+            free_sectors =  0;
+            for (k = 0; k < nor_flash -> lx_nor_flash_block_bit_map_words; k++)
+            {
+
+#ifdef LX_DIRECT_READ
+
+                /* Read the word directly.  */
+                block_word =  *(block_word_ptr + nor_flash -> lx_nor_flash_block_free_bit_map_offset + k);
+#else
+                status =  _lx_nor_flash_driver_read(nor_flash, (block_word_ptr + nor_flash -> lx_nor_flash_block_free_bit_map_offset + k), &block_word, 1);
+
+                /* Check for an error from flash driver. Drivers should never return an error..  */
+                if (status)
+                {
+
+                    /* Call system error handler.  */
+                    _lx_nor_flash_system_error(nor_flash, status);
+
+#ifdef LX_THREAD_SAFE_ENABLE
+
+                    /* Release the thread safe mutex.  */
+                    tx_mutex_put(&nor_flash -> lx_nor_flash_mutex);
+#endif
+
+                    /* Return an error.  */
+                    return(LX_ERROR);
+                }
+#endif
+
+                /* Count the set bits (free sectors).  */
+                while (block_word)
+                {
+                    block_word =  block_word & (block_word - 1);
+                    free_sectors++;
+                }
+            }
+
+            /* Calculate how many non-free sectors there are - this includes valid and obsolete sectors.  */
+            used_sectors =  nor_flash -> lx_nor_flash_physical_sectors_per_block - free_sectors;
+
+            /* Pickup the obsolete sectors of the block.  */
+            obsolete_sectors =  0;
+#ifdef LX_NOR_ENABLE_OBSOLETE_COUNT_CACHE
+            if (block < nor_flash -> lx_nor_flash_extended_cache_obsolete_count_max_block)
+            {
+
+                /* The obsolete count cache holds it.  */
+                obsolete_sectors =  (ULONG) nor_flash -> lx_nor_flash_extended_cache_obsolete_count[block];
+            }
+            else
+#endif
+            {
+
+                /* Walk the used entries of the mapping list.  */
+                for (k = 0; k < used_sectors; k++)
+                {
+
+#ifdef LX_DIRECT_READ
+
+                    /* Read the word directly.  */
+                    block_word =  *(block_word_ptr + nor_flash -> lx_nor_flash_block_physical_sector_mapping_offset + k);
+#else
+                    status =  _lx_nor_flash_driver_read(nor_flash, (block_word_ptr + nor_flash -> lx_nor_flash_block_physical_sector_mapping_offset + k), &block_word, 1);
+
+                    /* Check for an error from flash driver. Drivers should never return an error..  */
+                    if (status)
+                    {
+
+                        /* Call system error handler.  */
+                        _lx_nor_flash_system_error(nor_flash, status);
+
+#ifdef LX_THREAD_SAFE_ENABLE
+
+                        /* Release the thread safe mutex.  */
+                        tx_mutex_put(&nor_flash -> lx_nor_flash_mutex);
+#endif
+
+                        /* Return an error.  */
+                        return(LX_ERROR);
+                    }
+#endif
+
+                    /* Is this entry obsolete or was its mapping never completed?  */
+                    if ((block_word & (LX_NOR_PHYSICAL_SECTOR_VALID | LX_NOR_PHYSICAL_SECTOR_MAPPING_NOT_VALID)) != LX_NOR_PHYSICAL_SECTOR_VALID)
+                    {
+                        obsolete_sectors++;
+                    }
+                }
+            }
+
+            /* Store the summary of the block.  */
+            summary_ptr[i] =      erase_word;
+            summary_ptr[i + 1] =  free_sectors | (obsolete_sectors << LX_NOR_CHECKPOINT_OBSOLETE_SHIFT);
+
+            /* Add up the counts.  */
+            total_free =      total_free + free_sectors;
+            total_mapped =    total_mapped + (used_sectors - obsolete_sectors);
+            total_obsolete =  total_obsolete + obsolete_sectors;
+
+            /* Move to the next block.  */
+            block++;
+        }
+
+        /* Add this piece to the CRC and program it.  */
+        crc =     _lx_nor_flash_checkpoint_crc(crc, summary_ptr, words);
+        status =  _lx_nor_flash_driver_write(nor_flash, record_ptr + LX_NOR_CHECKPOINT_HEADER_WORDS + j, summary_ptr, words);
+
+        /* Check for an error from flash driver. Drivers should never return an error..  */
+        if (status)
+        {
+
+            /* Call system error handler.  */
+            _lx_nor_flash_system_error(nor_flash, status);
+
+#ifdef LX_THREAD_SAFE_ENABLE
+
+            /* Release the thread safe mutex.  */
+            tx_mutex_put(&nor_flash -> lx_nor_flash_mutex);
+#endif
+
+            /* Return an error.  */
+            return(LX_ERROR);
+        }
+    }
+
+    /* The summaries must describe the instance, otherwise a sector operation is in progress.  */
+    if ((total_free != nor_flash -> lx_nor_flash_free_physical_sectors) ||
+        (total_mapped != nor_flash -> lx_nor_flash_mapped_physical_sectors) ||
+        (total_obsolete != nor_flash -> lx_nor_flash_obsolete_physical_sectors))
+    {
+
+#ifdef LX_THREAD_SAFE_ENABLE
+
+        /* Release the thread safe mutex.  */
+        tx_mutex_put(&nor_flash -> lx_nor_flash_mutex);
+#endif
+
+        /* Leave the slot without magic, it is skipped next time.  */
+        return(LX_ERROR);
+    }
+
+    /* Build the header and finish the CRC.  */
+    header[LX_NOR_CHECKPOINT_SEQUENCE_OFFSET] =  nor_flash -> lx_nor_flash_checkpoint_sequence + 1;
+    header[LX_NOR_CHECKPOINT_BLOCKS_OFFSET] =    nor_flash -> lx_nor_flash_total_blocks;
+    header[LX_NOR_CHECKPOINT_SECTORS_OFFSET] =   nor_flash -> lx_nor_flash_physical_sectors_per_block;
+    header[LX_NOR_CHECKPOINT_FREE_OFFSET] =      total_free;
+    header[LX_NOR_CHECKPOINT_MAPPED_OFFSET] =    total_mapped;
+    header[LX_NOR_CHECKPOINT_OBSOLETE_OFFSET] =  total_obsolete;
+    header[LX_NOR_CHECKPOINT_CRC_OFFSET] =       _lx_nor_flash_checkpoint_crc(crc, &header[LX_NOR_CHECKPOINT_SEQUENCE_OFFSET],
+                                                                              LX_NOR_CHECKPOINT_CRC_OFFSET - LX_NOR_CHECKPOINT_SEQUENCE_OFFSET);
+    header[LX_NOR_CHECKPOINT_MAGIC_OFFSET] =     LX_NOR_CHECKPOINT_MAGIC;
+
+    /* Program the header without the magic, then the magic to complete the record.  */
+    status =  _lx_nor_flash_driver_write(nor_flash, record_ptr + LX_NOR_CHECKPOINT_SEQUENCE_OFFSET, &header[LX_NOR_CHECKPOINT_SEQUENCE_OFFSET],
+                                         LX_NOR_CHECKPOINT_HEADER_WORDS - LX_NOR_CHECKPOINT_SEQUENCE_OFFSET);
+    if (status == LX_SUCCESS)
+    {
+        status =  _lx_nor_flash_driver_write(nor_flash, record_ptr + LX_NOR_CHECKPOINT_MAGIC_OFFSET, &header[LX_NOR_CHECKPOINT_MAGIC_OFFSET], 1);
+    }
+
+    /* Clear the magic of the previous record, the new one supersedes it.  */
+    if ((status == LX_SUCCESS) && (nor_flash -> lx_nor_flash_checkpoint_record))
+    {
+        block_word =  0;
+        status =  _lx_nor_flash_driver_write(nor_flash, nor_flash -> lx_nor_flash_checkpoint_record + LX_NOR_CHECKPOINT_MAGIC_OFFSET, &block_word, 1);
+    }
+
+    /* Check for an error from flash driver. Drivers should never return an error..  */
+    if (status)
+    {
+
+        /* Call system error handler.  */
+        _lx_nor_flash_system_error(nor_flash, status);
+
+#ifdef LX_THREAD_SAFE_ENABLE
+
+        /* Release the thread safe mutex.  */
+        tx_mutex_put(&nor_flash -> lx_nor_flash_mutex);
+#endif
+
+        /* Return an error.  */
+        return(LX_ERROR);
+    }
+
+    /* The new record is active and no block changed since.  */
+    nor_flash -> lx_nor_flash_checkpoint_record =        record_ptr;
+    nor_flash -> lx_nor_flash_checkpoint_sequence =      header[LX_NOR_CHECKPOINT_SEQUENCE_OFFSET];
+    nor_flash -> lx_nor_flash_checkpoint_dirty_blocks =  0;
+    nor_flash -> lx_nor_flash_checkpoint_writes++;
+    for (i = 0; i < map_words; i++)
+    {
+        nor_flash -> lx_nor_flash_checkpoint_block_map[i] =  0;
+    }
+
+#ifdef LX_THREAD_SAFE_ENABLE
+
+    /* Release the thread safe mutex.  */
+    tx_mutex_put(&nor_flash -> lx_nor_flash_mutex);
+#endif
+
+    /* Return successful completion.  */
+    return(LX_SUCCESS);
+#else
+
+    LX_PARAMETER_NOT_USED(nor_flash);
+    LX_PARAMETER_NOT_USED(dirty_blocks);
+
+    /* Return disabled status.  */
+    return(LX_DISABLED);
+#endif
+}
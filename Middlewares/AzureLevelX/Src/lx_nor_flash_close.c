@@ -59,6 +59,7 @@
 /*                                                                        */ 
 /*  CALLS                                                                 */ 
 /*                                                                        */ 
+/*    _lx_nor_flash_checkpoint_write        Write checkpoint              */ 
 /*    tx_mutex_delete                       Delete thread-safe mutex      */ 
 /*                                                                        */ 
 /*  CALLED BY                                                             */ 
@@ -81,6 +82,12 @@ UINT  _lx_nor_flash_close(LX_NOR_FLASH *nor_flash)
 
 LX_INTERRUPT_SAVE_AREA
 
+#ifdef LX_NOR_ENABLE_CHECKPOINT
+
+    /* Write a checkpoint if any block changed, so the next open does not scan the flash. An error leaves 
+       the previous checkpoint or none, the next open then scans the changed blocks.  */
+    _lx_nor_flash_checkpoint_write(nor_flash, 0);
+#endif
 
     /* Lockout interrupts for NOR flash close.  */
     LX_DISABLE
@@ -62,6 +62,7 @@
 /*  CALLS                                                                 */ 
 /*                                                                        */ 
 /*    (lx_nor_flash_driver_block_erase)     Actual driver block erase     */ 
+/*    _lx_nor_flash_checkpoint_block_dirty  Mark block changed            */ 
 /*                                                                        */ 
 /*  CALLED BY                                                             */ 
 /*                                                                        */ 
@@ -92,7 +93,6 @@ UINT    i;
 ULONG   *block_start_address;
 ULONG   *block_end_address;
 ULONG   *cache_entry_start;
-ULONG   *cache_entry_end;
 
 
     /* Calculate the block starting address.  */
@@ -107,19 +107,32 @@ ULONG   *cache_entry_end;
                 
         /* Determine the cache entry addresses.  */
         cache_entry_start =  nor_flash -> lx_nor_flash_extended_cache[i].lx_nor_flash_extended_cache_entry_sector_address;
-        cache_entry_end =    cache_entry_start + LX_NOR_SECTOR_SIZE;
                 
-        /* Determine if the flash address in in the cache entry.  */
-        if ((cache_entry_start) && (block_start_address <= cache_entry_start) && (block_end_address > cache_entry_end))
+        /* Determine if the cached sector is in the block, including its last sector.  */
+        if ((cache_entry_start) && (block_start_address <= cache_entry_start) && (block_end_address > cache_entry_start))
         {
     
             /* Yes, this cache entry is in the block to be erased so invalidate it.  */
             nor_flash -> lx_nor_flash_extended_cache[i].lx_nor_flash_extended_cache_entry_sector_address =  LX_NULL;
-            nor_flash -> lx_nor_flash_extended_cache[i].lx_nor_flash_extended_cache_entry_access_count =    0;
+            nor_flash -> lx_nor_flash_extended_cache[i].lx_nor_flash_extended_cache_entry_access_stamp =    0;
         }
     }
 #endif
 
+#ifdef LX_NOR_ENABLE_CHECKPOINT
+
+    /* Mark the block in the checkpoint before it is erased.  */
+    status =  _lx_nor_flash_checkpoint_block_dirty(nor_flash, block);
+
+    /* Check for an error from flash driver.  */
+    if (status)
+    {
+
+        /* Return the error.  */
+        return(status);
+    }
+#endif
+
     /* Call the actual driver block erase function.  */
 #ifdef LX_NOR_ENABLE_CONTROL_BLOCK_FOR_DRIVER_INTERFACE
     status =  (nor_flash -> lx_nor_flash_driver_block_erase)(nor_flash, block, erase_count);
@@ -47,7 +47,10 @@
 /*                                                                        */
 /*  DESCRIPTION                                                           */ 
 /*                                                                        */ 
-/*    This function performs a read of the NOR flash memory.              */ 
+/*    This function performs a read of the NOR flash memory. If the       */ 
+/*    extended cache is enabled, requests within one cached sector are    */ 
+/*    served from RAM and one word (metadata) misses load the sector into */ 
+/*    the least recently used entry of its hash set.                      */ 
 /*                                                                        */ 
 /*  INPUT                                                                 */ 
 /*                                                                        */ 
@@ -63,6 +66,8 @@
 /*  CALLS                                                                 */ 
 /*                                                                        */ 
 /*    (lx_nor_flash_driver_read)            Actual driver read            */ 
+/*    _lx_nor_flash_extended_cache_entry_find                             */ 
+/*                                          Find sector in extended cache */ 
 /*                                                                        */ 
 /*  CALLED BY                                                             */ 
 /*                                                                        */ 
@@ -86,129 +91,102 @@ UINT  _lx_nor_flash_driver_read(LX_NOR_FLASH *nor_flash, ULONG *flash_address, U
 {
 #ifndef LX_NOR_DISABLE_EXTENDED_CACHE
 
-UINT    status;
-UINT    i;
-ULONG   *cache_entry_start;
-ULONG   *cache_entry_end;
-ULONG   cache_offset;
-UINT    least_used_cache_entry;
+UINT                                status;
+ULONG                               i;
+ULONG                               *cache_entry_start;
+ULONG                               cache_offset;
+LX_NOR_FLASH_EXTENDED_CACHE_ENTRY   *cache_entry_ptr;
+LX_NOR_FLASH_EXTENDED_CACHE_ENTRY   *victim_entry_ptr;
 
 
-    /* Is the request a whole sector or a partial sector.  */
-    if ((words == 1) && (nor_flash -> lx_nor_flash_extended_cache_entries))
+    /* Determine if the extended cache is enabled.  */
+    if (nor_flash -> lx_nor_flash_extended_cache_entries)
     {
 
-        /* One word request, which implies that it is a NOR flash metadata read.  */
-            
-            
-        /* Initialize the least used cache entry.  */
-        least_used_cache_entry =  0;
-            
-        do
-        {    
-
-            /* Loop through the cache entries to see if there is a sector in cache.  */
-            for (i = 0; i < nor_flash -> lx_nor_flash_extended_cache_entries; i++)
+        /* Calculate the sector containing the first word and the offset into it.  */
+        cache_offset =       (ULONG)(flash_address - nor_flash -> lx_nor_flash_base_address);
+        cache_entry_start =  nor_flash -> lx_nor_flash_base_address + (cache_offset & ~((ULONG) (LX_NOR_SECTOR_SIZE-1)));
+        cache_offset =       cache_offset & ((ULONG) (LX_NOR_SECTOR_SIZE-1));
+
+        /* Determine if the request is within that sector.  */
+        if ((cache_offset + words) <= LX_NOR_SECTOR_SIZE)
+        {
+
+            /* Look up the sector. Only one word requests, which imply NOR flash metadata reads, 
+               bring a sector into the cache. Larger requests are served only if the sector is already cached.  */
+            cache_entry_ptr =  _lx_nor_flash_extended_cache_entry_find(nor_flash, cache_entry_start, (words == 1) ? &victim_entry_ptr : LX_NULL);
+
+            /* Determine if the sector is in the cache.  */
+            if (cache_entry_ptr == LX_NULL)
             {
-        
-                /* Search through the cache to find the entry.  */
-                
-                /* Determine the cache entry addresses.  */
-                cache_entry_start =  nor_flash -> lx_nor_flash_extended_cache[i].lx_nor_flash_extended_cache_entry_sector_address;
-                cache_entry_end =    cache_entry_start + LX_NOR_SECTOR_SIZE;
-                
-                /* Determine if the flash address in in the cache entry.  */
-                if ((cache_entry_start) && (flash_address >= cache_entry_start) && (flash_address < cache_entry_end))
-                {
-                
-                    /* Yes, we found the entry.  */
-                    
-                    /* Increment the accessed count.  */
-                    nor_flash -> lx_nor_flash_extended_cache[i].lx_nor_flash_extended_cache_entry_access_count++;
-                    
-                    /* Calculate the offset into the cache entry.  */
-                    cache_offset =  (ULONG)(flash_address - cache_entry_start);
-                    
-                    /* Copy the word from the cache.  */
-                    *destination =  *(nor_flash -> lx_nor_flash_extended_cache[i].lx_nor_flash_extended_cache_entry_sector_memory + cache_offset);
-                    
-                    /* Increment the number of cache hits.  */
-                    nor_flash -> lx_nor_flash_extended_cache_hits++;
-                    
-                    /* Return success.  */
-                    return(LX_SUCCESS);                    
-                }
-                else
+
+                /* Determine if the sector should be brought into the cache.  */
+                if (words == 1)
                 {
-                    
-                    /* Determine if we have a new least used sector.  */
-                    if (i != least_used_cache_entry)
+
+                    /* Yes, read in the sector into the victim entry.  */
+#ifdef LX_NOR_ENABLE_CONTROL_BLOCK_FOR_DRIVER_INTERFACE
+                    status =  (nor_flash -> lx_nor_flash_driver_read)(nor_flash, cache_entry_start, 
+                                    victim_entry_ptr -> lx_nor_flash_extended_cache_entry_sector_memory, LX_NOR_SECTOR_SIZE);
+#else
+                    status =  (nor_flash -> lx_nor_flash_driver_read)(cache_entry_start, 
+                                    victim_entry_ptr -> lx_nor_flash_extended_cache_entry_sector_memory, LX_NOR_SECTOR_SIZE);
+#endif
+
+                    /* Determine if there was an error.  */
+                    if (status != LX_SUCCESS)
                     {
-                    
-                        /* Determine if this entry has a smaller accessed count.  */
-                        if (nor_flash -> lx_nor_flash_extended_cache[i].lx_nor_flash_extended_cache_entry_access_count <
-                            nor_flash -> lx_nor_flash_extended_cache[least_used_cache_entry].lx_nor_flash_extended_cache_entry_access_count)
-                        {
-                        
-                            /* New least used entry.  */
-                            least_used_cache_entry =  i;
-                        }
+
+                        /* The victim content is lost, invalidate it.  */
+                        victim_entry_ptr -> lx_nor_flash_extended_cache_entry_sector_address =  LX_NULL;
+
+                        /* Return the error to the caller.  */
+                        return(status);
                     }
+
+                    /* Setup the cache entry.  */
+                    victim_entry_ptr -> lx_nor_flash_extended_cache_entry_sector_address =  cache_entry_start;
+                    cache_entry_ptr =  victim_entry_ptr;
+
+                    /* Increment the number of cache misses.  */
+                    nor_flash -> lx_nor_flash_extended_cache_misses++;
                 }
             }
+            else
+            {
 
-            /* Now read in the sector into the cache.  */
-            cache_offset =  (ULONG)(flash_address - nor_flash -> lx_nor_flash_base_address);
-            cache_offset =  cache_offset & ~((ULONG) (LX_NOR_SECTOR_SIZE-1));
-            cache_entry_start =  nor_flash -> lx_nor_flash_base_address + cache_offset;
-            
-            /* Call the actual driver read function.  */
-#ifdef LX_NOR_ENABLE_CONTROL_BLOCK_FOR_DRIVER_INTERFACE
-            status =  (nor_flash -> lx_nor_flash_driver_read)(nor_flash, cache_entry_start, 
-                            nor_flash -> lx_nor_flash_extended_cache[least_used_cache_entry].lx_nor_flash_extended_cache_entry_sector_memory, 
-                            LX_NOR_SECTOR_SIZE);
-#else
-            status =  (nor_flash -> lx_nor_flash_driver_read)(cache_entry_start, 
-                            nor_flash -> lx_nor_flash_extended_cache[least_used_cache_entry].lx_nor_flash_extended_cache_entry_sector_memory, 
-                            LX_NOR_SECTOR_SIZE);
-#endif
+                /* Increment the number of cache hits.  */
+                nor_flash -> lx_nor_flash_extended_cache_hits++;
+            }
 
-            /* Determine if there was an error.  */
-            if (status != LX_SUCCESS)
+            /* Determine if the request can be served from the cache.  */
+            if (cache_entry_ptr)
             {
-            
-                /* Return the error to the caller.  */
-                return(status);
+
+                /* Mark the entry as the most recently used one.  */
+                cache_entry_ptr -> lx_nor_flash_extended_cache_entry_access_stamp =  ++nor_flash -> lx_nor_flash_extended_cache_access_stamp;
+
+                /* Copy the words from the cache.  */
+                for (i = 0; i < words; i++)
+                {
+                    destination[i] =  cache_entry_ptr -> lx_nor_flash_extended_cache_entry_sector_memory[cache_offset + i];
+                }
+
+                /* Return success.  */
+                return(LX_SUCCESS);
             }
-            
-            /* Setup the cache entry.  */
-            nor_flash -> lx_nor_flash_extended_cache[least_used_cache_entry].lx_nor_flash_extended_cache_entry_sector_address =  cache_entry_start;
-            nor_flash -> lx_nor_flash_extended_cache[least_used_cache_entry].lx_nor_flash_extended_cache_entry_access_count =    0;
-            
-            /* Increment the number of cache misses.  */
-            nor_flash -> lx_nor_flash_extended_cache_misses++;
-            
-            /* Decrement the number of cache hits, so that the increment that will happen next will be cancelled out.  */
-            nor_flash -> lx_nor_flash_extended_cache_hits--;
-            
-        } while (status == LX_SUCCESS);
-        
-        /* Return success.  */
-        return(LX_SUCCESS);
+        }
     }
-    else
-    {
-    
-        /* Call the actual driver read function.  */
+
+    /* Call the actual driver read function.  */
 #ifdef LX_NOR_ENABLE_CONTROL_BLOCK_FOR_DRIVER_INTERFACE
-        status =  (nor_flash -> lx_nor_flash_driver_read)(nor_flash, flash_address, destination, words);
+    status =  (nor_flash -> lx_nor_flash_driver_read)(nor_flash, flash_address, destination, words);
 #else
-        status =  (nor_flash -> lx_nor_flash_driver_read)(flash_address, destination, words);
+    status =  (nor_flash -> lx_nor_flash_driver_read)(flash_address, destination, words);
 #endif
 
-        /* Return completion status.  */
-        return(status);   
-    }
+    /* Return completion status.  */
+    return(status);   
 #else
 UINT    status;
 
@@ -48,6 +48,8 @@
 /*  DESCRIPTION                                                           */ 
 /*                                                                        */ 
 /*    This function performs a write of the NOR flash memory.             */ 
+/*    Sectors held in the extended cache are updated with the written     */ 
+/*    words, whatever the size of the request.                            */ 
 /*                                                                        */ 
 /*  INPUT                                                                 */ 
 /*                                                                        */ 
@@ -63,6 +65,9 @@
 /*  CALLS                                                                 */ 
 /*                                                                        */ 
 /*    (lx_nor_flash_driver_write)           Actual driver write           */ 
+/*    _lx_nor_flash_checkpoint_block_dirty  Mark block changed            */ 
+/*    _lx_nor_flash_extended_cache_entry_find                             */ 
+/*                                          Find sector in extended cache */ 
 /*                                                                        */ 
 /*  CALLED BY                                                             */ 
 /*                                                                        */ 
@@ -87,47 +92,72 @@ UINT  _lx_nor_flash_driver_write(LX_NOR_FLASH *nor_flash, ULONG *flash_address,
 
 #ifndef LX_NOR_DISABLE_EXTENDED_CACHE
 
-UINT    status;
-UINT    i;
-ULONG   *cache_entry_start;
-ULONG   *cache_entry_end;
-ULONG   cache_offset;
+UINT                                status;
+ULONG                               *cache_entry_start;
+ULONG                               cache_offset;
+ULONG                               cache_words;
+ULONG                               remaining_words;
+ULONG                               *write_source;
+ULONG                               i;
+LX_NOR_FLASH_EXTENDED_CACHE_ENTRY   *cache_entry_ptr;
 
 
-    /* Is the request a whole sector or a partial sector.  */
-    if ((words == 1) && (nor_flash -> lx_nor_flash_extended_cache_entries))
+    /* Determine if the extended cache is enabled.  */
+    if (nor_flash -> lx_nor_flash_extended_cache_entries)
     {
 
-        /* One word request, which implies that it is a NOR flash metadata write.  */
+        /* Calculate the sector containing the first word and the offset into it.  */
+        cache_offset =       (ULONG)(flash_address - nor_flash -> lx_nor_flash_base_address);
+        cache_entry_start =  nor_flash -> lx_nor_flash_base_address + (cache_offset & ~((ULONG) (LX_NOR_SECTOR_SIZE-1)));
+        cache_offset =       cache_offset & ((ULONG) (LX_NOR_SECTOR_SIZE-1));
 
-        /* Loop through the cache entries to see if there is a sector in cache.  */
-        for (i = 0; i < nor_flash -> lx_nor_flash_extended_cache_entries; i++)
+        /* Loop through the sectors touched by the write.  */
+        write_source =     source;
+        remaining_words =  words;
+        while (remaining_words)
         {
-        
-            /* Search through the cache to see if there is a cache entry.  */
-                
-            /* Determine the cache entry addresses.  */
-            cache_entry_start =  nor_flash -> lx_nor_flash_extended_cache[i].lx_nor_flash_extended_cache_entry_sector_address;
-            cache_entry_end =    cache_entry_start + LX_NOR_SECTOR_SIZE;
-                
-            /* Determine if the flash address in in the cache entry.  */
-            if ((cache_entry_start) && (flash_address >= cache_entry_start) && (flash_address < cache_entry_end))
+
+            /* Calculate the number of words written to this sector.  */
+            cache_words =  LX_NOR_SECTOR_SIZE - cache_offset;
+            if (cache_words > remaining_words)
+            {
+                cache_words =  remaining_words;
+            }
+
+            /* Determine if the sector is in the cache.  */
+            cache_entry_ptr =  _lx_nor_flash_extended_cache_entry_find(nor_flash, cache_entry_start, LX_NULL);
+            if (cache_entry_ptr)
             {
-                
-                /* Yes, we found the entry.  */
-                    
-                /* Calculate the offset into the cache entry.  */
-                cache_offset =  (ULONG)(flash_address - cache_entry_start);
-                    
-                /* Copy the word into the cache.  */
-                *(nor_flash -> lx_nor_flash_extended_cache[i].lx_nor_flash_extended_cache_entry_sector_memory + cache_offset) =  *source;
-                
-                /* Get out of the loop.  */
-                break;
+
+                /* Yes, copy the words into the cache so it matches the flash.  */
+                for (i = 0; i < cache_words; i++)
+                {
+                    cache_entry_ptr -> lx_nor_flash_extended_cache_entry_sector_memory[cache_offset + i] =  write_source[i];
+                }
             }
+
+            /* Move to the next sector.  */
+            write_source =       write_source + cache_words;
+            remaining_words =    remaining_words - cache_words;
+            cache_entry_start =  cache_entry_start + LX_NOR_SECTOR_SIZE;
+            cache_offset =       0;
         }
     }
     
+#ifdef LX_NOR_ENABLE_CHECKPOINT
+
+    /* Mark the block in the checkpoint before it changes.  */
+    status =  _lx_nor_flash_checkpoint_block_dirty(nor_flash, (ULONG)(flash_address - nor_flash -> lx_nor_flash_base_address) / nor_flash -> lx_nor_flash_words_per_block);
+
+    /* Check for an error from flash driver.  */
+    if (status)
+    {
+
+        /* Return the error.  */
+        return(status);
+    }
+#endif
+
     /* In any case, call the actual driver write function.  */
 #ifdef LX_NOR_ENABLE_CONTROL_BLOCK_FOR_DRIVER_INTERFACE
     status =  (nor_flash -> lx_nor_flash_driver_write)(nor_flash, flash_address, source, words);
@@ -142,6 +172,20 @@ ULONG   cache_offset;
 UINT    status;
 
 
+#ifdef LX_NOR_ENABLE_CHECKPOINT
+
+    /* Mark the block in the checkpoint before it changes.  */
+    status =  _lx_nor_flash_checkpoint_block_dirty(nor_flash, (ULONG)(flash_address - nor_flash -> lx_nor_flash_base_address) / nor_flash -> lx_nor_flash_words_per_block);
+
+    /* Check for an error from flash driver.  */
+    if (status)
+    {
+
+        /* Return the error.  */
+        return(status);
+    }
+#endif
+
     /* Call the actual driver write function.  */
 #ifdef LX_NOR_ENABLE_CONTROL_BLOCK_FOR_DRIVER_INTERFACE
     status =  (nor_flash -> lx_nor_flash_driver_write)(nor_flash, flash_address, source, words);
@@ -48,6 +48,11 @@
 /*  DESCRIPTION                                                           */ 
 /*                                                                        */ 
 /*    This function enables or disables the extended cache.               */ 
+/*    The sector cache is split in hash sets of                           */ 
+/*    LX_NOR_EXTENDED_CACHE_WAYS entries. The mapping bitmap is taken     */ 
+/*    from a complete mapping table and the obsolete counts of blocks     */ 
+/*    unchanged since the checkpoint from the checkpoint, only the blocks */ 
+/*    still needed are scanned.                                           */ 
 /*                                                                        */ 
 /*  INPUT                                                                 */ 
 /*                                                                        */ 
@@ -61,7 +66,9 @@
 /*                                                                        */ 
 /*  CALLS                                                                 */ 
 /*                                                                        */ 
-/*    None                                                                */ 
+/*    _lx_nor_flash_checkpoint_block_get    Get block summary             */ 
+/*    _lx_nor_flash_driver_read             Driver flash sector read      */ 
+/*    _lx_nor_flash_system_error            Internal system error handler */ 
 /*                                                                        */ 
 /*  CALLED BY                                                             */ 
 /*                                                                        */ 
@@ -97,6 +104,9 @@ UINT  _lx_nor_flash_extended_cache_enable(LX_NOR_FLASH *nor_flash, VOID *memory,
 UINT    i;
 ULONG   cache_size;
 ULONG   *cache_memory;
+ULONG   sectors;
+UINT    ways;
+UINT    sets;
 #ifdef LX_NOR_ENABLE_MAPPING_BITMAP
 ULONG   mapping_bitmap_words;
 ULONG   mapping_bitmap_word;
@@ -110,8 +120,16 @@ ULONG   obsolete_sectors;
 #if defined(LX_NOR_ENABLE_MAPPING_BITMAP) || defined(LX_NOR_ENABLE_OBSOLETE_COUNT_CACHE)
 ULONG   *block_word_ptr;
 UINT    j;
+#ifndef LX_DIRECT_READ
 UINT    status;
+#endif
 ULONG   block_word;
+ULONG   scan_block;
+ULONG   scan_mapping;
+#endif
+#if defined(LX_NOR_ENABLE_OBSOLETE_COUNT_CACHE) && defined(LX_NOR_ENABLE_CHECKPOINT)
+ULONG   erase_count;
+ULONG   free_sectors;
 #endif
 
 
@@ -132,6 +150,18 @@ ULONG   block_word;
     /* Initialize the internal NOR cache.  */
     nor_flash -> lx_nor_flash_extended_cache_entries =  0;
 
+    /* Clear the cache statistics.  */
+    nor_flash -> lx_nor_flash_extended_cache_hits =    0;
+    nor_flash -> lx_nor_flash_extended_cache_misses =  0;
+#ifdef LX_NOR_ENABLE_MAPPING_BITMAP
+    nor_flash -> lx_nor_flash_extended_cache_mapping_bitmap_hits =    0;
+    nor_flash -> lx_nor_flash_extended_cache_mapping_bitmap_misses =  0;
+#endif
+#ifdef LX_NOR_ENABLE_OBSOLETE_COUNT_CACHE
+    nor_flash -> lx_nor_flash_extended_cache_obsolete_count_hits =    0;
+    nor_flash -> lx_nor_flash_extended_cache_obsolete_count_misses =  0;
+#endif
+
     /* Calculate cache size in words.  */
     cache_size = size/sizeof(ULONG);
 
@@ -181,7 +211,7 @@ ULONG   block_word;
 #if defined(LX_NOR_ENABLE_OBSOLETE_COUNT_CACHE)
 
         /* Get the obsolete count cache size.  */
-        obsolete_count_words = nor_flash -> lx_nor_flash_total_blocks * sizeof(LX_NOR_OBSOLETE_COUNT_CACHE_TYPE) / 4;
+        obsolete_count_words = ((nor_flash -> lx_nor_flash_total_blocks * sizeof(LX_NOR_OBSOLETE_COUNT_CACHE_TYPE)) + 3) / 4;
         
         /* Check if the obsolete count cache fits in the suppiled cache memory.  */
         if (cache_size < obsolete_count_words)
@@ -204,20 +234,68 @@ ULONG   block_word;
         cache_memory =  cache_memory + obsolete_count_words;
 #endif
 
+        /* By default the mappings of every block are needed for the mapping bitmap.  */
+        scan_mapping =  LX_FALSE;
+#if defined(LX_NOR_ENABLE_MAPPING_BITMAP)
+        scan_mapping =  LX_TRUE;
+#if defined(LX_NOR_ENABLE_MAPPING_TABLE)
+
+        /* Determine if the mapping table holds every valid mapping.  */
+        if ((nor_flash -> lx_nor_flash_mapping_table) && (nor_flash -> lx_nor_flash_mapping_table_complete))
+        {
+
+            /* Yes, set the bits of the mapped logical sectors from the table.  */
+            for (logical_sector = 0; (logical_sector < nor_flash -> lx_nor_flash_mapping_table_max_logical_sector) &&
+                                     (logical_sector < (mapping_bitmap_words * 32)); logical_sector++)
+            {
+                if (nor_flash -> lx_nor_flash_mapping_table[logical_sector] != LX_NOR_MAPPING_TABLE_ENTRY_FREE)
+                {
+                    mapping_bitmap_ptr[logical_sector >> 5] |=  (ULONG)1 << (logical_sector & 31);
+                }
+            }
+
+            /* The blocks do not need to be scanned for the bitmap.  */
+            scan_mapping =  LX_FALSE;
+        }
+#endif
+#endif
+
         /* Loop through the blocks.  */
         for (i = 0; i < nor_flash -> lx_nor_flash_total_blocks; i++)
         {
             /* Setup the block word pointer to the first word of the block.  */
             block_word_ptr =  (nor_flash -> lx_nor_flash_base_address + (i * nor_flash -> lx_nor_flash_words_per_block));
 
+            /* Determine if the block needs to be scanned.  */
+            scan_block =  scan_mapping;
 #if defined(LX_NOR_ENABLE_OBSOLETE_COUNT_CACHE)
 
             /* Initialize the obsolete count cache.  */
             obsolete_sectors = 0;
+
+            /* Check if the block is cached by obsolete count cache.  */
+            if (i < nor_flash -> lx_nor_flash_extended_cache_obsolete_count_max_block)
+            {
+#if defined(LX_NOR_ENABLE_CHECKPOINT)
+
+                /* An unchanged block has the obsolete count of the checkpoint, unless it is scanned for the bitmap anyway.  */
+                if ((scan_block) || (_lx_nor_flash_checkpoint_block_get(nor_flash, i, &erase_count, &free_sectors, &obsolete_sectors) != LX_SUCCESS))
+                {
+
+                    /* Count the obsolete sectors of the block.  */
+                    obsolete_sectors =  0;
+                    scan_block =        LX_TRUE;
+                }
+#else
+
+                /* Count the obsolete sectors of the block.  */
+                scan_block =  LX_TRUE;
+#endif
+            }
 #endif
 
             /* Now walk the list of logical-physical sector mapping.  */
-            for (j = 0; j < nor_flash ->lx_nor_flash_physical_sectors_per_block; j++)
+            for (j = 0; (scan_block) && (j < nor_flash ->lx_nor_flash_physical_sectors_per_block); j++)
             {
                 
                 /* Read this word of the sector mapping list.  */
@@ -289,37 +367,35 @@ ULONG   block_word;
     }
 #endif
     
+    /* Calculate the number of sectors that fit in the memory left, up to the size of the cache table.  */
+    sectors =  cache_size / LX_NOR_SECTOR_SIZE;
+    if (sectors > LX_NOR_EXTENDED_CACHE_SIZE)
+    {
+        sectors =  LX_NOR_EXTENDED_CACHE_SIZE;
+    }
+
+    /* Calculate the set geometry: each set holds up to LX_NOR_EXTENDED_CACHE_WAYS sectors.  */
+    ways =  (sectors < LX_NOR_EXTENDED_CACHE_WAYS) ? (UINT) sectors : LX_NOR_EXTENDED_CACHE_WAYS;
+    sets =  (ways) ? (UINT) (sectors / ways) : 0;
+    
     /* Loop through the memory supplied and assign to cache entries.  */
-    i =  0;
-    while (cache_size >= LX_NOR_SECTOR_SIZE)
+    for (i = 0; i < (ways * sets); i++)
     {
     
         /* Setup this cache entry.  */
         nor_flash -> lx_nor_flash_extended_cache[i].lx_nor_flash_extended_cache_entry_sector_address =  LX_NULL;
         nor_flash -> lx_nor_flash_extended_cache[i].lx_nor_flash_extended_cache_entry_sector_memory =   cache_memory;
-        nor_flash -> lx_nor_flash_extended_cache[i].lx_nor_flash_extended_cache_entry_access_count =    0;
+        nor_flash -> lx_nor_flash_extended_cache[i].lx_nor_flash_extended_cache_entry_access_stamp =    0;
         
         /* Move the cache memory forward.   */
         cache_memory =  cache_memory + LX_NOR_SECTOR_SIZE;
-        
-        /* Decrement the size.  */
-        cache_size =  cache_size - LX_NOR_SECTOR_SIZE;
-    
-        /* Move to next cache entry.  */
-        i++;
     }
     
-    /* Save the number of cache entries.  */
-    if(i > LX_NOR_EXTENDED_CACHE_SIZE)
-    {
-
-        nor_flash -> lx_nor_flash_extended_cache_entries =  LX_NOR_EXTENDED_CACHE_SIZE;
-    }
-    else
-    {
-
-        nor_flash -> lx_nor_flash_extended_cache_entries =  i;
-    }  
+    /* Save the cache geometry.  */
+    nor_flash -> lx_nor_flash_extended_cache_ways =          ways;
+    nor_flash -> lx_nor_flash_extended_cache_sets =          sets;
+    nor_flash -> lx_nor_flash_extended_cache_access_stamp =  0;
+    nor_flash -> lx_nor_flash_extended_cache_entries =       ways * sets;
 
 #ifdef LX_THREAD_SAFE_ENABLE
 
@@ -0,0 +1,148 @@
+/**************************************************************************/
+/**************************************************************************/
+/**                                                                       */
+/** LevelX Component                                                      */
+/**                                                                       */
+/**   NOR Flash                                                           */
+/**                                                                       */
+/**************************************************************************/
+/**************************************************************************/
+
+#define LX_SOURCE_CODE
+
+
+/* Disable ThreadX error checking.  */
+
+#ifndef LX_DISABLE_ERROR_CHECKING
+#define LX_DISABLE_ERROR_CHECKING
+#endif
+
+
+/* Include necessary system files.  */
+
+#include "lx_api.h"
+
+
+/**************************************************************************/
+/*                                                                        */
+/*  FUNCTION                                               RELEASE        */
+/*                                                                        */
+/*    _lx_nor_flash_extended_cache_entry_find             PORTABLE C      */
+/*                                                                        */
+/*  DESCRIPTION                                                           */
+/*                                                                        */
+/*    This function looks up a flash sector in the extended cache. The    */
+/*    cache is set associative: the sector number is hashed to one set of */
+/*    lx_nor_flash_extended_cache_ways entries, so a lookup costs at most */
+/*    one set scan regardless of the cache size. On a miss, the empty or  */
+/*    least recently used entry of the set is returned as the victim if   */
+/*    requested. Access stamps are compared as distances to the current   */
+/*    stamp, so the wrap of the stamp counter does not disturb the order. */
+/*                                                                        */
+/*  INPUT                                                                 */
+/*                                                                        */
+/*    nor_flash                             NOR flash instance            */
+/*    sector_address                        Sector aligned flash address  */
+/*    victim_entry                          Destination for the entry to  */
+/*                                            replace on a miss, may be   */
+/*                                            NULL                        */
+/*                                                                        */
+/*  OUTPUT                                                                */
+/*                                                                        */
+/*    Cache entry holding the sector, or NULL                             */
+/*                                                                        */
+/*  CALLS                                                                 */
+/*                                                                        */
+/*    None                                                                */
+/*                                                                        */
+/*  CALLED BY                                                             */
+/*                                                                        */
+/*    Internal LevelX                                                     */
+/*                                                                        */
+/**************************************************************************/
+LX_NOR_FLASH_EXTENDED_CACHE_ENTRY  *_lx_nor_flash_extended_cache_entry_find(LX_NOR_FLASH *nor_flash, ULONG *sector_address, LX_NOR_FLASH_EXTENDED_CACHE_ENTRY **victim_entry)
+{
+#ifndef LX_NOR_DISABLE_EXTENDED_CACHE
+
+LX_NOR_FLASH_EXTENDED_CACHE_ENTRY   *cache_entry_ptr;
+LX_NOR_FLASH_EXTENDED_CACHE_ENTRY   *victim_entry_ptr;
+ULONG                               sector;
+ULONG                               set;
+ULONG                               age;
+ULONG                               victim_age;
+UINT                                i;
+
+
+    /* Calculate the sector number.  */
+    sector =  (ULONG) (sector_address - nor_flash -> lx_nor_flash_base_address) / LX_NOR_SECTOR_SIZE;
+
+    /* Hash the sector number to a set. Metadata sectors are one block apart, so the upper bits of a 
+       multiplicative hash are used to spread them over all the sets.  */
+    set =  ((ULONG) (sector * 0x9E3779B1UL) >> 16) % nor_flash -> lx_nor_flash_extended_cache_sets;
+
+    /* Build a pointer to the first entry of the set.  */
+    cache_entry_ptr =  &nor_flash -> lx_nor_flash_extended_cache[set * nor_flash -> lx_nor_flash_extended_cache_ways];
+
+    /* Start with the first entry as the victim.  */
+    victim_entry_ptr =  cache_entry_ptr;
+    victim_age =        0;
+
+    /* Loop through the entries of the set.  */
+    for (i = 0; i < nor_flash -> lx_nor_flash_extended_cache_ways; i++)
+    {
+
+        /* Determine if this entry holds the sector.  */
+        if (cache_entry_ptr -> lx_nor_flash_extended_cache_entry_sector_address == sector_address)
+        {
+
+            /* Yes, return the entry.  */
+            return(cache_entry_ptr);
+        }
+
+        /* Determine if this entry is empty.  */
+        if (cache_entry_ptr -> lx_nor_flash_extended_cache_entry_sector_address == LX_NULL)
+        {
+
+            /* An empty entry is always the best victim.  */
+            victim_entry_ptr =  cache_entry_ptr;
+            victim_age =        LX_ALL_ONES;
+        }
+        else
+        {
+
+            /* Calculate how long ago the entry was used.  */
+            age =  nor_flash -> lx_nor_flash_extended_cache_access_stamp - cache_entry_ptr -> lx_nor_flash_extended_cache_entry_access_stamp;
+
+            /* Determine if this entry is older than the victim.  */
+            if (age > victim_age)
+            {
+
+                /* New least recently used entry.  */
+                victim_entry_ptr =  cache_entry_ptr;
+                victim_age =        age;
+            }
+        }
+
+        /* Move to the next entry of the set.  */
+        cache_entry_ptr++;
+    }
+
+    /* Return the victim if requested.  */
+    if (victim_entry)
+    {
+        *victim_entry =  victim_entry_ptr;
+    }
+
+    /* The sector is not in the cache.  */
+    return(LX_NULL);
+#else
+
+    LX_PARAMETER_NOT_USED(nor_flash);
+    LX_PARAMETER_NOT_USED(sector_address);
+    LX_PARAMETER_NOT_USED(victim_entry);
+
+    /* The extended cache is not available.  */
+    return(LX_NULL);
+#endif
+}
+
@@ -0,0 +1,115 @@
+/**************************************************************************/
+/**************************************************************************/
+/**                                                                       */
+/** LevelX Component                                                      */
+/**                                                                       */
+/**   NOR Flash                                                           */
+/**                                                                       */
+/**************************************************************************/
+/**************************************************************************/
+
+#define LX_SOURCE_CODE
+
+
+/* Disable ThreadX error checking.  */
+
+#ifndef LX_DISABLE_ERROR_CHECKING
+#define LX_DISABLE_ERROR_CHECKING
+#endif
+
+
+/* Include necessary system files.  */
+
+#include "lx_api.h"
+
+
+/**************************************************************************/
+/*                                                                        */
+/*  FUNCTION                                               RELEASE        */
+/*                                                                        */
+/*    _lx_nor_flash_extended_cache_stats_get              PORTABLE C      */
+/*                                                                        */
+/*  DESCRIPTION                                                           */
+/*                                                                        */
+/*    This function returns the extended cache statistics: the sector     */
+/*    cache, mapping bitmap and obsolete count cache sizes with their     */
+/*    hit and miss counters. The counters are cleared by                  */
+/*    _lx_nor_flash_extended_cache_enable. Parts that are compiled out    */
+/*    are reported as zero.                                               */
+/*                                                                        */
+/*  INPUT                                                                 */
+/*                                                                        */
+/*    nor_flash                             NOR flash instance            */
+/*    stats                                 Destination for statistics    */
+/*                                                                        */
+/*  OUTPUT                                                                */
+/*                                                                        */
+/*    return status                                                       */
+/*                                                                        */
+/*  CALLS                                                                 */
+/*                                                                        */
+/*    tx_mutex_get                          Get thread protection         */
+/*    tx_mutex_put                          Release thread protection     */
+/*                                                                        */
+/*  CALLED BY                                                             */
+/*                                                                        */
+/*    Application Code                                                    */
+/*                                                                        */
+/**************************************************************************/
+UINT  _lx_nor_flash_extended_cache_stats_get(LX_NOR_FLASH *nor_flash, LX_NOR_FLASH_EXTENDED_CACHE_STATS *stats)
+{
+#ifndef LX_NOR_DISABLE_EXTENDED_CACHE
+
+#ifdef LX_THREAD_SAFE_ENABLE
+
+    /* Obtain the thread safe mutex.  */
+    tx_mutex_get(&nor_flash -> lx_nor_flash_mutex, TX_WAIT_FOREVER);
+#endif
+
+    /* Return the sector cache statistics.  */
+    stats -> lx_nor_flash_extended_cache_stats_entries =  nor_flash -> lx_nor_flash_extended_cache_entries;
+    stats -> lx_nor_flash_extended_cache_stats_hits =     nor_flash -> lx_nor_flash_extended_cache_hits;
+    stats -> lx_nor_flash_extended_cache_stats_misses =   nor_flash -> lx_nor_flash_extended_cache_misses;
+
+#ifdef LX_NOR_ENABLE_MAPPING_BITMAP
+
+    /* Return the mapping bitmap statistics.  */
+    stats -> lx_nor_flash_extended_cache_stats_mapping_bitmap_max_logical_sector =  nor_flash -> lx_nor_flash_extended_cache_mapping_bitmap_max_logical_sector;
+    stats -> lx_nor_flash_extended_cache_stats_mapping_bitmap_hits =                nor_flash -> lx_nor_flash_extended_cache_mapping_bitmap_hits;
+    stats -> lx_nor_flash_extended_cache_stats_mapping_bitmap_misses =              nor_flash -> lx_nor_flash_extended_cache_mapping_bitmap_misses;
+#else
+    stats -> lx_nor_flash_extended_cache_stats_mapping_bitmap_max_logical_sector =  0;
+    stats -> lx_nor_flash_extended_cache_stats_mapping_bitmap_hits =                0;
+    stats -> lx_nor_flash_extended_cache_stats_mapping_bitmap_misses =              0;
+#endif
+
+#ifdef LX_NOR_ENABLE_OBSOLETE_COUNT_CACHE
+
+    /* Return the obsolete count cache statistics.  */
+    stats -> lx_nor_flash_extended_cache_stats_obsolete_count_max_block =  nor_flash -> lx_nor_flash_extended_cache_obsolete_count_max_block;
+    stats -> lx_nor_flash_extended_cache_stats_obsolete_count_hits =       nor_flash -> lx_nor_flash_extended_cache_obsolete_count_hits;
+    stats -> lx_nor_flash_extended_cache_stats_obsolete_count_misses =     nor_flash -> lx_nor_flash_extended_cache_obsolete_count_misses;
+#else
+    stats -> lx_nor_flash_extended_cache_stats_obsolete_count_max_block =  0;
+    stats -> lx_nor_flash_extended_cache_stats_obsolete_count_hits =       0;
+    stats -> lx_nor_flash_extended_cache_stats_obsolete_count_misses =     0;
+#endif
+
+#ifdef LX_THREAD_SAFE_ENABLE
+
+    /* Release the thread safe mutex.  */
+    tx_mutex_put(&nor_flash -> lx_nor_flash_mutex);
+#endif
+
+    /* Return successful completion.  */
+    return(LX_SUCCESS);
+#else
+
+    LX_PARAMETER_NOT_USED(nor_flash);
+    LX_PARAMETER_NOT_USED(stats);
+
+    /* Return disabled status.  */
+    return(LX_DISABLED);
+#endif
+}
+
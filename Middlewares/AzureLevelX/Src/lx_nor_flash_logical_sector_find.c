@@ -114,6 +114,10 @@ ULONG                               valid_sector_found;
 #endif
 #if !defined(LX_DIRECT_READ)  || !defined(LX_NOR_ENABLE_OBSOLETE_COUNT_CACHE)
 UINT                                status;
+#endif
+#ifdef LX_NOR_ENABLE_MAPPING_TABLE
+ULONG                               physical_sector;
+ULONG                               block;
 #endif
 
 
@@ -128,6 +132,43 @@ UINT                                status;
         /* No mapped sector so nothing can be found!.  */
         return(LX_SECTOR_NOT_FOUND);
     }
+
+#ifdef LX_NOR_ENABLE_MAPPING_TABLE
+
+    /* Determine if the logical sector is covered by the RAM mapping table. The table only holds
+       valid mappings, so the search for superceded sectors done by open must walk the flash.  */
+    if ((superceded_check == LX_FALSE) && (logical_sector < nor_flash -> lx_nor_flash_mapping_table_max_logical_sector))
+    {
+
+        /* Pickup the physical sector index.  */
+        physical_sector =  (ULONG) nor_flash -> lx_nor_flash_mapping_table[logical_sector];
+
+        /* Determine if the logical sector is mapped.  */
+        if (physical_sector == (ULONG) LX_NOR_MAPPING_TABLE_ENTRY_FREE)
+        {
+
+            /* Not mapped, return not found.  */
+            return(LX_SECTOR_NOT_FOUND);
+        }
+
+        /* Increment the mapping table hit counter.  */
+        nor_flash -> lx_nor_flash_mapping_table_hits++;
+
+        /* Split the index into the block and the sector within the block.  */
+        block =            physical_sector / nor_flash -> lx_nor_flash_physical_sectors_per_block;
+        physical_sector =  physical_sector - (block * nor_flash -> lx_nor_flash_physical_sectors_per_block);
+
+        /* Setup the block word pointer to the first word of the block.  */
+        block_word_ptr =  nor_flash -> lx_nor_flash_base_address + (block * nor_flash -> lx_nor_flash_words_per_block);
+
+        /* Return the map entry and the sector data addresses.  */
+        *physical_sector_map_entry =  block_word_ptr + nor_flash -> lx_nor_flash_block_physical_sector_mapping_offset + physical_sector;
+        *physical_sector_address =    block_word_ptr + nor_flash -> lx_nor_flash_block_physical_sector_offset + (physical_sector * LX_NOR_SECTOR_SIZE);
+
+        /* Return a successful status.  */
+        return(LX_SUCCESS);
+    }
+#endif
     
 #ifndef LX_NOR_DISABLE_EXTENDED_CACHE
 #ifdef LX_NOR_ENABLE_MAPPING_BITMAP
@@ -139,10 +180,16 @@ UINT                                status;
         /* Determine if the logical sector is mapped.  */
         if ((nor_flash -> lx_nor_flash_extended_cache_mapping_bitmap[logical_sector >> 5] & (ULONG)(1 << (logical_sector & 31))) == 0)
         {
+
+            /* Increment the mapping bitmap hit counter.  */
+            nor_flash -> lx_nor_flash_extended_cache_mapping_bitmap_hits++;
             
             /* Not mapped, return not found.  */
             return(LX_SECTOR_NOT_FOUND);
         }
+
+        /* Mapped, the sector must be searched for.  */
+        nor_flash -> lx_nor_flash_extended_cache_mapping_bitmap_misses++;
     }
 #endif
 #endif
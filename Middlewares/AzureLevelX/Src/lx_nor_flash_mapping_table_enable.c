@@ -0,0 +1,221 @@
+/**************************************************************************/
+/**************************************************************************/
+/**                                                                       */
+/** LevelX Component                                                      */
+/**                                                                       */
+/**   NOR Flash                                                           */
+/**                                                                       */
+/**************************************************************************/
+/**************************************************************************/
+
+#define LX_SOURCE_CODE
+
+
+/* Disable ThreadX error checking.  */
+
+#ifndef LX_DISABLE_ERROR_CHECKING
+#define LX_DISABLE_ERROR_CHECKING
+#endif
+
+
+/* Include necessary system files.  */
+
+#include "lx_api.h"
+
+
+/**************************************************************************/
+/*                                                                        */
+/*  FUNCTION                                               RELEASE        */
+/*                                                                        */
+/*    _lx_nor_flash_mapping_table_enable                  PORTABLE C      */
+/*                                                                        */
+/*  DESCRIPTION                                                           */
+/*                                                                        */
+/*    This function enables or disables the RAM logical to physical       */
+/*    mapping table. Each table entry holds the physical sector index of  */
+/*    one logical sector (or LX_NOR_MAPPING_TABLE_ENTRY_FREE), so a       */
+/*    covered sector is found without walking the mapping lists in flash. */
+/*    The table is built from the flash mapping lists, so the NOR flash   */
+/*    must be opened first. Logical sectors beyond the memory supplied    */
+/*    fall back to the regular search. A NULL memory disables the table.  */
+/*    The table is marked complete while no valid mapping lies beyond     */
+/*    it, the extended cache then derives its mapping bitmap from it.     */
+/*                                                                        */
+/*  INPUT                                                                 */
+/*                                                                        */
+/*    nor_flash                             NOR flash instance            */
+/*    memory                                Address of RAM for the table  */
+/*    size                                  Size of the RAM for the table */
+/*                                                                        */
+/*  OUTPUT                                                                */
+/*                                                                        */
+/*    return status                                                       */
+/*                                                                        */
+/*  CALLS                                                                 */
+/*                                                                        */
+/*    _lx_nor_flash_driver_read             Driver flash sector read      */
+/*    _lx_nor_flash_system_error            Internal system error handler */
+/*    tx_mutex_get                          Get thread protection         */
+/*    tx_mutex_put                          Release thread protection     */
+/*                                                                        */
+/*  CALLED BY                                                             */
+/*                                                                        */
+/*    Application Code                                                    */
+/*                                                                        */
+/**************************************************************************/
+UINT  _lx_nor_flash_mapping_table_enable(LX_NOR_FLASH *nor_flash, VOID *memory, ULONG size)
+{
+#ifdef LX_NOR_ENABLE_MAPPING_TABLE
+
+LX_NOR_MAPPING_TABLE_TYPE   *table;
+ULONG                       table_entries;
+ULONG                       *block_word_ptr;
+ULONG                       block_word;
+ULONG                       logical_sector;
+ULONG                       i, j;
+#ifndef LX_DIRECT_READ
+UINT                        status;
+#endif
+
+
+    /* The table is built from the mapping lists, the flash must be opened.  */
+    if (nor_flash -> lx_nor_flash_state != LX_NOR_FLASH_OPENED)
+    {
+
+        /* Not opened yet.  */
+        return(LX_ERROR);
+    }
+
+    /* Every physical sector index must fit in a table entry, the free marker excluded.  */
+    if (nor_flash -> lx_nor_flash_total_physical_sectors >= (ULONG) LX_NOR_MAPPING_TABLE_ENTRY_FREE)
+    {
+
+        /* Table entry type is too small for this flash.  */
+        return(LX_ERROR);
+    }
+
+#ifdef LX_THREAD_SAFE_ENABLE
+
+    /* Obtain the thread safe mutex.  */
+    tx_mutex_get(&nor_flash -> lx_nor_flash_mutex, TX_WAIT_FOREVER);
+#endif
+
+    /* Disable the table while it is built.  */
+    nor_flash -> lx_nor_flash_mapping_table =                     LX_NULL;
+    nor_flash -> lx_nor_flash_mapping_table_max_logical_sector =  0;
+    nor_flash -> lx_nor_flash_mapping_table_hits =                0;
+    nor_flash -> lx_nor_flash_mapping_table_complete =            LX_FALSE;
+
+    /* Determine if the table is being disabled.  */
+    if (memory == LX_NULL)
+    {
+
+#ifdef LX_THREAD_SAFE_ENABLE
+
+        /* Release the thread safe mutex.  */
+        tx_mutex_put(&nor_flash -> lx_nor_flash_mutex);
+#endif
+
+        /* Return successful completion.  */
+        return(LX_SUCCESS);
+    }
+
+    /* Calculate the number of logical sectors covered by the memory.  */
+    table =          (LX_NOR_MAPPING_TABLE_TYPE *) memory;
+    table_entries =  size / sizeof(LX_NOR_MAPPING_TABLE_TYPE);
+
+    /* Mark all covered logical sectors as not mapped.  */
+    for (i = 0; i < table_entries; i++)
+    {
+        table[i] =  LX_NOR_MAPPING_TABLE_ENTRY_FREE;
+    }
+
+    /* Assume every valid mapping is covered until one beyond the table is found.  */
+    nor_flash -> lx_nor_flash_mapping_table_complete =  LX_TRUE;
+
+    /* Loop through the blocks.  */
+    for (i = 0; i < nor_flash -> lx_nor_flash_total_blocks; i++)
+    {
+
+        /* Setup the block word pointer to the first word of the block.  */
+        block_word_ptr =  (nor_flash -> lx_nor_flash_base_address + (i * nor_flash -> lx_nor_flash_words_per_block));
+
+        /* Now walk the list of logical-physical sector mapping.  */
+        for (j = 0; j < nor_flash -> lx_nor_flash_physical_sectors_per_block; j++)
+        {
+
+            /* Read this word of the sector mapping list.  */
+#ifdef LX_DIRECT_READ
+
+            /* Read the word directly.  */
+            block_word =  *(block_word_ptr + nor_flash -> lx_nor_flash_block_physical_sector_mapping_offset + j);
+#else
+            status =  _lx_nor_flash_driver_read(nor_flash, (block_word_ptr + nor_flash -> lx_nor_flash_block_physical_sector_mapping_offset + j), &block_word, 1);
+
+            /* Check for an error from flash driver. Drivers should never return an error..  */
+            if (status)
+            {
+
+                /* Call system error handler.  */
+                _lx_nor_flash_system_error(nor_flash, status);
+
+#ifdef LX_THREAD_SAFE_ENABLE
+
+                /* Release the thread safe mutex.  */
+                tx_mutex_put(&nor_flash -> lx_nor_flash_mutex);
+#endif
+
+                /* Return an error.  */
+                return(LX_ERROR);
+            }
+#endif
+
+            /* Determine if the entry hasn't been used.  */
+            if (block_word == LX_NOR_PHYSICAL_SECTOR_FREE)
+            {
+                break;
+            }
+
+            /* Is this entry a valid mapping?  */
+            if ((block_word & (LX_NOR_PHYSICAL_SECTOR_VALID | LX_NOR_PHYSICAL_SECTOR_MAPPING_NOT_VALID)) == LX_NOR_PHYSICAL_SECTOR_VALID)
+            {
+
+                /* Yes, get the logical sector.  */
+                logical_sector =  block_word & LX_NOR_LOGICAL_SECTOR_MASK;
+
+                /* Record the physical sector index if the logical sector is covered.  */
+                if (logical_sector < table_entries)
+                {
+                    table[logical_sector] =  (LX_NOR_MAPPING_TABLE_TYPE) ((i * nor_flash -> lx_nor_flash_physical_sectors_per_block) + j);
+                }
+                else
+                {
+                    nor_flash -> lx_nor_flash_mapping_table_complete =  LX_FALSE;
+                }
+            }
+        }
+    }
+
+    /* The table is complete, enable it.  */
+    nor_flash -> lx_nor_flash_mapping_table =                     table;
+    nor_flash -> lx_nor_flash_mapping_table_max_logical_sector =  table_entries;
+
+#ifdef LX_THREAD_SAFE_ENABLE
+
+    /* Release the thread safe mutex.  */
+    tx_mutex_put(&nor_flash -> lx_nor_flash_mutex);
+#endif
+
+    /* Return successful completion.  */
+    return(LX_SUCCESS);
+#else
+
+    LX_PARAMETER_NOT_USED(nor_flash);
+    LX_PARAMETER_NOT_USED(memory);
+    LX_PARAMETER_NOT_USED(size);
+
+    /* Return disabled status.  */
+    return(LX_DISABLED);
+#endif
+}
+
@@ -0,0 +1,103 @@
+/**************************************************************************/
+/**************************************************************************/
+/**                                                                       */
+/** LevelX Component                                                      */
+/**                                                                       */
+/**   NOR Flash                                                           */
+/**                                                                       */
+/**************************************************************************/
+/**************************************************************************/
+
+#define LX_SOURCE_CODE
+
+
+/* Disable ThreadX error checking.  */
+
+#ifndef LX_DISABLE_ERROR_CHECKING
+#define LX_DISABLE_ERROR_CHECKING
+#endif
+
+
+/* Include necessary system files.  */
+
+#include "lx_api.h"
+
+
+/**************************************************************************/
+/*                                                                        */
+/*  FUNCTION                                               RELEASE        */
+/*                                                                        */
+/*    _lx_nor_flash_mapping_table_update                  PORTABLE C      */
+/*                                                                        */
+/*  DESCRIPTION                                                           */
+/*                                                                        */
+/*    This function records the new physical sector of a logical sector   */
+/*    in the RAM mapping table. It is called once the new mapping entry   */
+/*    is valid in flash. A NULL map entry marks the logical sector as not */
+/*    mapped. Logical sectors not covered by the table are ignored.       */
+/*                                                                        */
+/*  INPUT                                                                 */
+/*                                                                        */
+/*    nor_flash                             NOR flash instance            */
+/*    logical_sector                        Logical sector number         */
+/*    physical_sector_map_entry             Address of the valid physical */
+/*                                            sector map entry, or NULL   */
+/*                                                                        */
+/*  OUTPUT                                                                */
+/*                                                                        */
+/*    None                                                                */
+/*                                                                        */
+/*  CALLS                                                                 */
+/*                                                                        */
+/*    None                                                                */
+/*                                                                        */
+/*  CALLED BY                                                             */
+/*                                                                        */
+/*    Internal LevelX                                                     */
+/*                                                                        */
+/**************************************************************************/
+VOID  _lx_nor_flash_mapping_table_update(LX_NOR_FLASH *nor_flash, ULONG logical_sector, ULONG *physical_sector_map_entry)
+{
+#ifdef LX_NOR_ENABLE_MAPPING_TABLE
+
+ULONG   block_offset;
+ULONG   block;
+
+
+    /* Determine if the logical sector is covered by the mapping table.  */
+    if (logical_sector >= nor_flash -> lx_nor_flash_mapping_table_max_logical_sector)
+    {
+
+        /* No, nothing to record. A mapping beyond the table means it no longer holds every mapped sector.  */
+        if (physical_sector_map_entry != LX_NULL)
+        {
+            nor_flash -> lx_nor_flash_mapping_table_complete =  LX_FALSE;
+        }
+        return;
+    }
+
+    /* Determine if the logical sector is no longer mapped.  */
+    if (physical_sector_map_entry == LX_NULL)
+    {
+
+        /* Mark the entry free.  */
+        nor_flash -> lx_nor_flash_mapping_table[logical_sector] =  LX_NOR_MAPPING_TABLE_ENTRY_FREE;
+        return;
+    }
+
+    /* Calculate the block and the offset of the map entry within it.  */
+    block_offset =  (ULONG) (physical_sector_map_entry - nor_flash -> lx_nor_flash_base_address);
+    block =         block_offset / nor_flash -> lx_nor_flash_words_per_block;
+    block_offset =  block_offset - (block * nor_flash -> lx_nor_flash_words_per_block);
+
+    /* Record the physical sector index.  */
+    nor_flash -> lx_nor_flash_mapping_table[logical_sector] =
+        (LX_NOR_MAPPING_TABLE_TYPE) ((block * nor_flash -> lx_nor_flash_physical_sectors_per_block) + (block_offset - nor_flash -> lx_nor_flash_block_physical_sector_mapping_offset));
+#else
+
+    LX_PARAMETER_NOT_USED(nor_flash);
+    LX_PARAMETER_NOT_USED(logical_sector);
+    LX_PARAMETER_NOT_USED(physical_sector_map_entry);
+#endif
+}
+
@@ -65,6 +65,9 @@
 /*                                                                        */ 
 /*  CALLS                                                                 */ 
 /*                                                                        */ 
+/*    _lx_nor_flash_block_stats_victim_find Find block from RAM table     */
+/*    (lx_nor_flash_reclaim_policy_victim_find)                           */
+/*                                          Installed reclaim policy      */
 /*    _lx_nor_flash_driver_read             Driver flash sector read      */ 
 /*    _lx_nor_flash_system_error            Internal system error handler */ 
 /*                                                                        */ 
@@ -122,6 +125,27 @@ UINT    obsolete_sectors_available;
 UINT    mapped_sectors_available;
 
 
+#ifdef LX_NOR_ENABLE_BLOCK_STATS
+
+    /* Determine if the block statistics table is in use.  */
+    if (nor_flash -> lx_nor_flash_block_stats)
+    {
+#ifdef LX_NOR_ENABLE_RECLAIM_POLICY
+
+        /* Determine if a reclaim policy other than greedy is installed.  */
+        if (nor_flash -> lx_nor_flash_reclaim_policy_victim_find)
+        {
+
+            /* Yes, let the policy make the choice.  */
+            return((nor_flash -> lx_nor_flash_reclaim_policy_victim_find)(nor_flash, return_erase_block, return_erase_count, return_mapped_sectors, return_obsolete_sectors));
+        }
+#endif
+
+        /* Make the greedy choice from the table without reading the flash.  */
+        return(_lx_nor_flash_block_stats_victim_find(nor_flash, return_erase_block, return_erase_count, return_mapped_sectors, return_obsolete_sectors));
+    }
+#endif
+
     /* Setup the block word pointer to the first word of the search block.  */
     block_word_ptr =  nor_flash -> lx_nor_flash_base_address;
 
@@ -190,6 +214,9 @@ UINT    mapped_sectors_available;
         /* Initialize the obsolete and mapped sector count available flags.  */
         obsolete_sectors_available =  LX_FALSE;
         mapped_sectors_available =  LX_FALSE;
+
+        /* Clear the mapped sector count, a block found fully obsolete in the cache has none.  */
+        mapped_sectors =  0;
         
 #ifdef LX_NOR_ENABLE_OBSOLETE_COUNT_CACHE
 
@@ -202,9 +229,15 @@ UINT    mapped_sectors_available;
 
             /* Pickup the obsolete sector count from the cache.  */
             obsolete_sectors = (ULONG)nor_flash -> lx_nor_flash_extended_cache_obsolete_count[i];
+
+            /* Increment the obsolete count cache hit counter.  */
+            nor_flash -> lx_nor_flash_extended_cache_obsolete_count_hits++;
         }
         else
         {
+
+        /* Increment the obsolete count cache miss counter.  */
+        nor_flash -> lx_nor_flash_extended_cache_obsolete_count_misses++;
 #endif
         /* Read the minimum and maximum logical sector values in this block.  */
 #ifdef LX_DIRECT_READ
@@ -48,7 +48,8 @@
 /*  DESCRIPTION                                                           */ 
 /*                                                                        */ 
 /*    This function opens a NOR flash instance and ensures the NOR flash  */ 
-/*    is in a coherent state.                                             */ 
+/*    is in a coherent state. With a valid checkpoint only the blocks     */ 
+/*    changed since it was written are scanned.                           */ 
 /*                                                                        */ 
 /*  INPUT                                                                 */ 
 /*                                                                        */ 
@@ -63,6 +64,9 @@
 /*  CALLS                                                                 */ 
 /*                                                                        */ 
 /*    (nor_driver_initialize)               Driver initialize             */ 
+/*    _lx_nor_flash_block_stats_build       Link block statistics table   */
+/*    _lx_nor_flash_checkpoint_block_get    Get block summary             */ 
+/*    _lx_nor_flash_checkpoint_load         Load checkpoint               */ 
 /*    _lx_nor_flash_driver_read             Driver read                   */ 
 /*    _lx_nor_flash_driver_write            Driver write                  */ 
 /*    (lx_nor_flash_driver_block_erased_verify)                           */ 
@@ -123,6 +127,15 @@ ULONG           *new_sector_address;
 ULONG           erased_count, min_erased_count, max_erased_count, temp_erased_count, min_erased_blocks;
 ULONG           j, k, l;    
 UINT            status;
+#ifdef LX_NOR_ENABLE_CHECKPOINT
+ULONG           obsolete_sectors;
+#endif
+#ifdef LX_NOR_ENABLE_BLOCK_STATS
+LX_NOR_FLASH_BLOCK_STATS    *block_stats;
+ULONG           block_free_sectors;
+ULONG           block_mapped_sectors;
+ULONG           block_obsolete_sectors;
+#endif
 #ifdef LX_FREE_SECTOR_DATA_VERIFY
 ULONG           *sector_word_ptr;
 ULONG           sector_word;
@@ -218,6 +231,20 @@ LX_INTERRUPT_SAVE_AREA
 
     /* Save the free bit map mask in the control block.  */
     nor_flash -> lx_nor_flash_block_bit_map_mask =  bit_map_mask;
+
+#ifdef LX_NOR_ENABLE_CHECKPOINT
+
+    /* Find the newest checkpoint, the blocks unchanged since it was written are not scanned.  */
+    status =  _lx_nor_flash_checkpoint_load(nor_flash);
+
+    /* Check for an error from flash driver.  */
+    if (status)
+    {
+
+        /* Return an error.  */
+        return(LX_ERROR);
+    }
+#endif
     
     /* Setup default values for the max/min erased counts.  */
     min_erased_count =  LX_ALL_ONES;
@@ -235,27 +262,32 @@ LX_INTERRUPT_SAVE_AREA
         /* Pickup the first word of the block. If the flash manager has executed before, this word contains the
            erase count for the block. Otherwise, if the word is 0xFFFFFFFF, this flash block was either erased
            or this is the first time it was used.  */
+#ifdef LX_NOR_ENABLE_CHECKPOINT
+
+        /* An unchanged block has the erase count of the checkpoint.  */
+        if (_lx_nor_flash_checkpoint_block_get(nor_flash, l, &block_word, &free_sectors, &obsolete_sectors) != LX_SUCCESS)
+#endif
+        {
 #ifdef LX_DIRECT_READ
         
-        /* Read the word directly.  */
-        block_word =  *block_word_ptr;
+            /* Read the word directly.  */
+            block_word =  *block_word_ptr;
 #else
 
+            status =  _lx_nor_flash_driver_read(nor_flash, block_word_ptr, &block_word, 1);
         
-
-        status =  _lx_nor_flash_driver_read(nor_flash, block_word_ptr, &block_word, 1);
-        
-        /* Check for an error from flash driver. Drivers should never return an error..  */
-        if (status)
-        {
+            /* Check for an error from flash driver. Drivers should never return an error..  */
+            if (status)
+            {
         
-            /* Call system error handler.  */
-            _lx_nor_flash_system_error(nor_flash, status);
+                /* Call system error handler.  */
+                _lx_nor_flash_system_error(nor_flash, status);
 
-            /* Return an error.  */
-            return(LX_ERROR);
-        }
+                /* Return an error.  */
+                return(LX_ERROR);
+            }
 #endif
+        }
 
         /* Is the block erased?  */
         if (((block_word & LX_BLOCK_ERASED) != LX_BLOCK_ERASED) && (block_word != LX_BLOCK_ERASE_STARTED))
@@ -352,6 +384,22 @@ LX_INTERRUPT_SAVE_AREA
 
             /* Update the number of free physical sectors.  */
             nor_flash -> lx_nor_flash_free_physical_sectors =   nor_flash -> lx_nor_flash_free_physical_sectors + sectors_per_block;
+#ifdef LX_NOR_ENABLE_BLOCK_STATS
+
+            /* Determine if the driver supplied the block statistics table.  */
+            if (nor_flash -> lx_nor_flash_block_stats)
+            {
+
+                /* Yes, the block starts with all its sectors free.  */
+                block_stats =  &nor_flash -> lx_nor_flash_block_stats[l];
+                block_stats -> lx_nor_flash_block_stats_erase_count =         1;
+                block_stats -> lx_nor_flash_block_stats_free_sectors =        (USHORT) sectors_per_block;
+                block_stats -> lx_nor_flash_block_stats_mapped_sectors =      0;
+                block_stats -> lx_nor_flash_block_stats_obsolete_sectors =    0;
+                block_stats -> lx_nor_flash_block_stats_min_logical_sector =  LX_ALL_ONES;
+                block_stats -> lx_nor_flash_block_stats_max_logical_sector =  0;
+            }
+#endif
         
             /* Move to the next flash block.  */
             block_word_ptr =  block_word_ptr + (nor_flash -> lx_nor_flash_words_per_block);
@@ -373,6 +421,70 @@ LX_INTERRUPT_SAVE_AREA
         /* Loop through the blocks.  */
         for (l = 0; l < nor_flash -> lx_nor_flash_total_blocks; l++)
         {
+#ifdef LX_NOR_ENABLE_BLOCK_STATS
+
+            /* Remember the counts so far, what this block adds to them goes to the block statistics table.  */
+            block_free_sectors =      nor_flash -> lx_nor_flash_free_physical_sectors;
+            block_mapped_sectors =    nor_flash -> lx_nor_flash_mapped_physical_sectors;
+            block_obsolete_sectors =  nor_flash -> lx_nor_flash_obsolete_physical_sectors;
+
+            /* Determine if the driver supplied the block statistics table.  */
+            block_stats =  LX_NULL;
+            if (nor_flash -> lx_nor_flash_block_stats)
+            {
+
+                /* Yes, start the entry of this block with an empty logical sector range.  */
+                block_stats =  &nor_flash -> lx_nor_flash_block_stats[l];
+                block_stats -> lx_nor_flash_block_stats_min_logical_sector =  LX_ALL_ONES;
+                block_stats -> lx_nor_flash_block_stats_max_logical_sector =  0;
+            }
+#endif
+
+#ifdef LX_NOR_ENABLE_CHECKPOINT
+
+            /* Determine if the block is unchanged since the checkpoint.  */
+            if (_lx_nor_flash_checkpoint_block_get(nor_flash, l, &block_word, &free_sectors, &obsolete_sectors) == LX_SUCCESS)
+            {
+
+                /* Yes, take its counts from the checkpoint instead of scanning it.  */
+                nor_flash -> lx_nor_flash_free_physical_sectors =      nor_flash -> lx_nor_flash_free_physical_sectors + free_sectors;
+                nor_flash -> lx_nor_flash_obsolete_physical_sectors =  nor_flash -> lx_nor_flash_obsolete_physical_sectors + obsolete_sectors;
+                nor_flash -> lx_nor_flash_mapped_physical_sectors =    nor_flash -> lx_nor_flash_mapped_physical_sectors + (sectors_per_block - free_sectors - obsolete_sectors);
+
+                /* Determine if we need to update the search pointer.  */
+                if ((free_sectors) && (nor_flash -> lx_nor_flash_free_block_search == nor_flash -> lx_nor_flash_total_blocks))
+                {
+
+                    /* Remember the block with free sectors.  */
+                    nor_flash -> lx_nor_flash_free_block_search =  l;
+                }
+
+                /* Count the trusted block.  */
+                nor_flash -> lx_nor_flash_checkpoint_trusted_blocks++;
+#ifdef LX_NOR_ENABLE_BLOCK_STATS
+
+                /* Determine if the block statistics table is supplied.  */
+                if (block_stats)
+                {
+
+                    /* Yes, take the counts of the checkpoint. The logical sectors of a used block are not known.  */
+                    block_stats -> lx_nor_flash_block_stats_erase_count =       block_word & LX_BLOCK_ERASE_COUNT_MASK;
+                    block_stats -> lx_nor_flash_block_stats_free_sectors =      (USHORT) free_sectors;
+                    block_stats -> lx_nor_flash_block_stats_mapped_sectors =    (USHORT) (sectors_per_block - free_sectors - obsolete_sectors);
+                    block_stats -> lx_nor_flash_block_stats_obsolete_sectors =  (USHORT) obsolete_sectors;
+                    if (free_sectors != sectors_per_block)
+                    {
+                        block_stats -> lx_nor_flash_block_stats_min_logical_sector =  0;
+                        block_stats -> lx_nor_flash_block_stats_max_logical_sector =  LX_NOR_LOGICAL_SECTOR_MASK;
+                    }
+                }
+#endif
+
+                /* Move to the next flash block.  */
+                block_word_ptr =  block_word_ptr + (nor_flash -> lx_nor_flash_words_per_block);
+                continue;
+            }
+#endif
          
             /* First, determine if this block has a valid erase count.  */
 #ifdef LX_DIRECT_READ
@@ -504,9 +616,19 @@ LX_INTERRUPT_SAVE_AREA
 
                 /* Update the number of free physical sectors.  */
                 nor_flash -> lx_nor_flash_free_physical_sectors =   nor_flash -> lx_nor_flash_free_physical_sectors + sectors_per_block;
+#ifdef LX_NOR_ENABLE_BLOCK_STATS
+
+                /* The block now has the maximum erase count.  */
+                erased_count =  max_erased_count;
+#endif
             }
             else
             {
+#ifdef LX_NOR_ENABLE_BLOCK_STATS
+
+                /* Isolate the erase count of the block.  */
+                erased_count =  block_word & LX_BLOCK_ERASE_COUNT_MASK;
+#endif
 
                 /* Calculate the number of free sectors from the free sector bit map.  */
                 free_sectors =  0;
@@ -735,6 +857,19 @@ LX_INTERRUPT_SAVE_AREA
                         {
                             /* Increment the number of mapped physical sectors.  */
                             nor_flash -> lx_nor_flash_mapped_physical_sectors++;
+#ifdef LX_NOR_ENABLE_BLOCK_STATS
+
+                            /* Determine if the block statistics table is supplied.  */
+                            if (block_stats)
+                            {
+
+                                /* Yes, widen the logical sector range of the block.  */
+                                if ((block_word & LX_NOR_LOGICAL_SECTOR_MASK) < block_stats -> lx_nor_flash_block_stats_min_logical_sector)
+                                    block_stats -> lx_nor_flash_block_stats_min_logical_sector =  block_word & LX_NOR_LOGICAL_SECTOR_MASK;
+                                if ((block_word & LX_NOR_LOGICAL_SECTOR_MASK) > block_stats -> lx_nor_flash_block_stats_max_logical_sector)
+                                    block_stats -> lx_nor_flash_block_stats_max_logical_sector =  block_word & LX_NOR_LOGICAL_SECTOR_MASK;
+                            }
+#endif
                         }
                         
                         /* Decrease the number of used sectors.  */
@@ -820,6 +955,19 @@ LX_INTERRUPT_SAVE_AREA
                     }
                 }
             }       
+#ifdef LX_NOR_ENABLE_BLOCK_STATS
+
+            /* Determine if the block statistics table is supplied.  */
+            if (block_stats)
+            {
+
+                /* Yes, record what the scan of this block added to the counts.  */
+                block_stats -> lx_nor_flash_block_stats_erase_count =       erased_count;
+                block_stats -> lx_nor_flash_block_stats_free_sectors =      (USHORT) (nor_flash -> lx_nor_flash_free_physical_sectors - block_free_sectors);
+                block_stats -> lx_nor_flash_block_stats_mapped_sectors =    (USHORT) (nor_flash -> lx_nor_flash_mapped_physical_sectors - block_mapped_sectors);
+                block_stats -> lx_nor_flash_block_stats_obsolete_sectors =  (USHORT) (nor_flash -> lx_nor_flash_obsolete_physical_sectors - block_obsolete_sectors);
+            }
+#endif
             
             /* Move to the next flash block.  */
             block_word_ptr =  block_word_ptr + (nor_flash -> lx_nor_flash_words_per_block);
@@ -838,6 +986,11 @@ LX_INTERRUPT_SAVE_AREA
             nor_flash -> lx_nor_flash_free_block_search =  0;
         }
     }
+#ifdef LX_NOR_ENABLE_BLOCK_STATS
+
+    /* Link the blocks of the statistics table into the buckets of their obsolete counts.  */
+    _lx_nor_flash_block_stats_build(nor_flash);
+#endif
 
 #ifdef LX_THREAD_SAFE_ENABLE
 
@@ -863,6 +1016,11 @@ LX_INTERRUPT_SAVE_AREA
     /* Initialize the last found block and sector markers.  */
     nor_flash -> lx_nor_flash_found_block_search =   0;
     nor_flash -> lx_nor_flash_found_sector_search =  0;
+#ifdef LX_NOR_ENABLE_BACKGROUND_RECLAIM
+
+    /* The background reclaim has no block in progress.  */
+    nor_flash -> lx_nor_flash_background_reclaim_block =  LX_ALL_ONES;
+#endif
 
     /* Lockout interrupts.  */
     LX_DISABLE
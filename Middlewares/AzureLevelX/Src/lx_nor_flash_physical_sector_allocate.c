@@ -48,7 +48,8 @@
 /*  DESCRIPTION                                                           */ 
 /*                                                                        */ 
 /*    This function allocates a free physical sector for mapping to a     */ 
-/*    logical sector.                                                     */ 
+/*    logical sector. With the hot/cold reclaim policy, sectors moved by  */
+/*    a reclaim are allocated from a search pointer of their own.         */
 /*                                                                        */ 
 /*  INPUT                                                                 */ 
 /*                                                                        */ 
@@ -63,6 +64,9 @@
 /*                                                                        */ 
 /*  CALLS                                                                 */ 
 /*                                                                        */ 
+/*    _lx_nor_flash_block_stats_allocate    Record allocation in table    */
+/*    _lx_nor_flash_block_stats_sector_allocate                           */
+/*                                          Allocate sector from table    */
 /*    _lx_nor_flash_driver_write            Driver flash sector write     */ 
 /*    _lx_nor_flash_driver_read             Driver flash sector read      */ 
 /*    _lx_nor_flash_system_error            Internal system error handler */ 
@@ -86,6 +90,9 @@ UINT  _lx_nor_flash_physical_sector_allocate(LX_NOR_FLASH *nor_flash, ULONG logi
 {
 
 ULONG   search_block;
+ULONG   *search_pointer;
+ULONG   search_blocks;
+ULONG   other_block;
 ULONG   *block_word_ptr;
 ULONG   block_word;
 ULONG   min_logical_sector;
@@ -114,18 +121,57 @@ UINT    status;
         return(LX_NO_SECTORS);
     }
 
+    /* By default there is one search pointer and every block is searched once.  */
+    search_pointer =  &nor_flash -> lx_nor_flash_free_block_search;
+    search_blocks =   nor_flash -> lx_nor_flash_total_blocks;
+    other_block =     LX_ALL_ONES;
+#ifdef LX_NOR_ENABLE_RECLAIM_POLICY
+
+    /* Determine if hot and cold sectors are written apart.  */
+    if (nor_flash -> lx_nor_flash_reclaim_policy == LX_NOR_RECLAIM_POLICY_HOT_COLD)
+    {
+
+        /* Yes, sectors moved by a reclaim have a search pointer of their own. On a first round each search 
+           passes over the block of the other one, a second round takes any free sector left.  */
+        if (nor_flash -> lx_nor_flash_reclaim_policy_relocating)
+        {
+            search_pointer =  &nor_flash -> lx_nor_flash_reclaim_policy_relocate_search;
+            other_block =     nor_flash -> lx_nor_flash_free_block_search;
+        }
+        else
+        {
+            other_block =     nor_flash -> lx_nor_flash_reclaim_policy_relocate_search;
+        }
+        search_blocks =  search_blocks * 2;
+    }
+#endif
+
+#ifdef LX_NOR_ENABLE_RAM_ALLOCATE
+
+    /* Determine if the block statistics table is in use.  */
+    if (nor_flash -> lx_nor_flash_block_stats)
+    {
+
+        /* Yes, allocate the sector from the table without reading the flash.  */
+        return(_lx_nor_flash_block_stats_sector_allocate(nor_flash, logical_sector, search_pointer, search_blocks, other_block,
+                                                         physical_sector_map_entry, physical_sector_address));
+    }
+#endif
+
     /* Pickup the search for a free physical sector at the specified block.  */
-    search_block =  nor_flash -> lx_nor_flash_free_block_search;
+    search_block =  *search_pointer;
 
     /* Loop through the blocks to find a free physical sector.  */
-    for (i = 0; i < nor_flash -> lx_nor_flash_total_blocks; i++)
+    for (i = 0; i < search_blocks; i++)
     {
 
         /* Setup the block word pointer to the first word of the search block.  */
         block_word_ptr =  nor_flash -> lx_nor_flash_base_address + (search_block * nor_flash -> lx_nor_flash_words_per_block);
 
-        /* Find the first free physical sector from the free sector bit map of this block.  */
-        for (j = 0; j < nor_flash -> lx_nor_flash_block_bit_map_words; j++)
+        /* Find the first free physical sector from the free sector bit map of this block, unless the block
+           belongs to the other search pointer and this is the first round.  */
+        for (j = 0; (j < nor_flash -> lx_nor_flash_block_bit_map_words) && 
+                    ((search_block != other_block) || (i >= nor_flash -> lx_nor_flash_total_blocks)); j++)
         {
                 
             /* Read this word of the free sector bit map.  */
@@ -199,6 +245,12 @@ UINT    status;
                             return(status);
                         }
 
+#ifdef LX_NOR_ENABLE_BLOCK_STATS
+
+                        /* Record the allocation in the block statistics table.  */
+                        _lx_nor_flash_block_stats_allocate(nor_flash, search_block, logical_sector);
+#endif
+
                         /* Determine if this is the last entry available in this block.  */
                         if (((block_word >> 1) == 0) && (j == (nor_flash -> lx_nor_flash_block_bit_map_words - 1)))
                         {
@@ -300,7 +352,7 @@ UINT    status;
                         }
                                                 
                         /* Remember the block to search.  */
-                        nor_flash -> lx_nor_flash_free_block_search =  search_block;
+                        *search_pointer =  search_block;
                                                 
                         /* Prepare the return information.  */
                         *physical_sector_map_entry =  block_word_ptr + (nor_flash -> lx_nor_flash_block_physical_sector_mapping_offset + (j * 32)) + k;
@@ -0,0 +1,171 @@
+/**************************************************************************/
+/**************************************************************************/
+/**                                                                       */
+/** LevelX Component                                                      */
+/**                                                                       */
+/**   NOR Flash                                                           */
+/**                                                                       */
+/**************************************************************************/
+/**************************************************************************/
+
+#define LX_SOURCE_CODE
+
+
+/* Disable ThreadX error checking.  */
+
+#ifndef LX_DISABLE_ERROR_CHECKING
+#define LX_DISABLE_ERROR_CHECKING
+#endif
+
+
+/* Include necessary system files.  */
+
+#include "lx_api.h"
+
+
+/**************************************************************************/
+/*                                                                        */
+/*  FUNCTION                                               RELEASE        */
+/*                                                                        */
+/*    _lx_nor_flash_reclaim_policy_cost_benefit_find      PORTABLE C      */
+/*                                                                        */
+/*  DESCRIPTION                                                           */
+/*                                                                        */
+/*    This function chooses the next block to erase from the block        */
+/*    statistics table by cost-benefit. Among the blocks with obsolete    */
+/*    sectors and within the erase count threshold of the greedy choice,  */
+/*    it takes the one with the highest obsolete sectors times age over   */
+/*    one block's worth of sectors plus its mapped sectors, the smallest  */
+/*    erase count and then the lowest block on a tie. The age is the      */
+/*    number of sector allocations since the block was last written, so   */
+/*    blocks of cold data are reclaimed before they are fully obsolete    */
+/*    and blocks of hot data are given time to become so. When no block   */
+/*    qualifies, the greedy choice is made.                               */
+/*                                                                        */
+/*  INPUT                                                                 */
+/*                                                                        */
+/*    nor_flash                             NOR flash instance            */
+/*    return_erase_block                    Returned block to erase       */
+/*    return_erase_count                    Returned erase count of block */
+/*    return_mapped_sectors                 Returned number of mapped     */
+/*                                            sectors                     */
+/*    return_obsolete_sectors               Returned number of obsolete   */
+/*                                            sectors                     */
+/*                                                                        */
+/*  OUTPUT                                                                */
+/*                                                                        */
+/*    return status                                                       */
+/*                                                                        */
+/*  CALLS                                                                 */
+/*                                                                        */
+/*    _lx_nor_flash_block_stats_victim_find Greedy choice from RAM table  */
+/*                                                                        */
+/*  CALLED BY                                                             */
+/*                                                                        */
+/*    _lx_nor_flash_next_block_to_erase_find                              */
+/*                                          Find next block to erase      */
+/*                                                                        */
+/**************************************************************************/
+UINT  _lx_nor_flash_reclaim_policy_cost_benefit_find(LX_NOR_FLASH *nor_flash, ULONG *return_erase_block, ULONG *return_erase_count, ULONG *return_mapped_sectors, ULONG *return_obsolete_sectors)
+{
+#ifdef LX_NOR_ENABLE_RECLAIM_POLICY
+
+LX_NOR_FLASH_BLOCK_STATS    *stats;
+ULONG                       erase_count_threshold;
+ULONG                       erase_count;
+ULONG                       best_block;
+ULONG                       best_erase_count;
+ULONG64                     best_benefit;
+ULONG64                     best_cost;
+ULONG64                     benefit;
+ULONG64                     cost;
+ULONG                       bucket;
+ULONG                       block;
+
+
+    /* Pickup the table.  */
+    stats =  nor_flash -> lx_nor_flash_block_stats;
+
+    /* Calculate the erase count threshold.  */
+    if (nor_flash -> lx_nor_flash_free_physical_sectors >= nor_flash -> lx_nor_flash_physical_sectors_per_block)
+    {
+
+        /* Calculate erase count threshold by adding constant to the current minimum.  */
+        erase_count_threshold =  nor_flash -> lx_nor_flash_minimum_erase_count + LX_NOR_FLASH_MAX_ERASE_COUNT_DELTA;
+    }
+    else
+    {
+
+        /* When the number of free sectors is low, any block with obsolete sectors will do.  */
+        erase_count_threshold =  LX_ALL_ONES;
+    }
+
+    /* No block found yet.  */
+    best_block =        LX_ALL_ONES;
+    best_erase_count =  LX_ALL_ONES;
+    best_benefit =      0;
+    best_cost =         1;
+
+    /* Look at every block with obsolete sectors.  */
+    for (bucket = nor_flash -> lx_nor_flash_block_stats_highest_bucket; bucket; bucket--)
+    {
+
+        /* Look at the blocks of this bucket.  */
+        for (block = nor_flash -> lx_nor_flash_block_stats_buckets[bucket]; block != LX_NOR_BLOCK_STATS_NONE; block = stats[block].lx_nor_flash_block_stats_next)
+        {
+
+            /* Pickup the erase count of this block.  */
+            erase_count =  stats[block].lx_nor_flash_block_stats_erase_count;
+
+            /* Skip the block if it is too worn.  */
+            if (erase_count > erase_count_threshold)
+                continue;
+
+            /* Calculate the benefit, the obsolete sectors times their age, and the cost, the erase plus the moves.  */
+            benefit =  ((ULONG64) bucket) * 
+                       ((ULONG64) (nor_flash -> lx_nor_flash_reclaim_policy_clock - stats[block].lx_nor_flash_block_stats_write_time) + 1);
+            cost =     (ULONG64) (nor_flash -> lx_nor_flash_physical_sectors_per_block + stats[block].lx_nor_flash_block_stats_mapped_sectors);
+
+            /* Is this block a better choice? Compare benefit over cost without dividing.  */
+            if (((benefit * best_cost) > (best_benefit * cost)) ||
+                (((benefit * best_cost) == (best_benefit * cost)) && 
+                 ((erase_count < best_erase_count) || ((erase_count == best_erase_count) && (block < best_block)))))
+            {
+
+                /* Yes, remember it.  */
+                best_block =        block;
+                best_erase_count =  erase_count;
+                best_benefit =      benefit;
+                best_cost =         cost;
+            }
+        }
+    }
+
+    /* Determine if the block is found.  */
+    if (best_block == LX_ALL_ONES)
+    {
+
+        /* No, the greedy search picks the block with the smallest erase count.  */
+        return(_lx_nor_flash_block_stats_victim_find(nor_flash, return_erase_block, return_erase_count, return_mapped_sectors, return_obsolete_sectors));
+    }
+
+    /* Return the block and its counts.  */
+    *return_erase_block =       best_block;
+    *return_erase_count =       best_erase_count;
+    *return_mapped_sectors =    (ULONG) stats[best_block].lx_nor_flash_block_stats_mapped_sectors;
+    *return_obsolete_sectors =  (ULONG) stats[best_block].lx_nor_flash_block_stats_obsolete_sectors;
+
+    /* Return success.  */
+    return(LX_SUCCESS);
+#else
+
+    LX_PARAMETER_NOT_USED(nor_flash);
+    LX_PARAMETER_NOT_USED(return_erase_block);
+    LX_PARAMETER_NOT_USED(return_erase_count);
+    LX_PARAMETER_NOT_USED(return_mapped_sectors);
+    LX_PARAMETER_NOT_USED(return_obsolete_sectors);
+
+    /* Return disabled status.  */
+    return(LX_DISABLED);
+#endif
+}
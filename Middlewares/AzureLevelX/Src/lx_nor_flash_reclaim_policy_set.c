@@ -0,0 +1,131 @@
+/**************************************************************************/
+/**************************************************************************/
+/**                                                                       */
+/** LevelX Component                                                      */
+/**                                                                       */
+/**   NOR Flash                                                           */
+/**                                                                       */
+/**************************************************************************/
+/**************************************************************************/
+
+#define LX_SOURCE_CODE
+
+
+/* Disable ThreadX error checking.  */
+
+#ifndef LX_DISABLE_ERROR_CHECKING
+#define LX_DISABLE_ERROR_CHECKING
+#endif
+
+
+/* Include necessary system files.  */
+
+#include "lx_api.h"
+
+
+/**************************************************************************/
+/*                                                                        */
+/*  FUNCTION                                               RELEASE        */
+/*                                                                        */
+/*    _lx_nor_flash_reclaim_policy_set                    PORTABLE C      */
+/*                                                                        */
+/*  DESCRIPTION                                                           */
+/*                                                                        */
+/*    This function selects how the next block to erase is chosen: greedy */
+/*    (the default after open), cost-benefit or hot/cold separated, see   */
+/*    lx_api.h. The policies other than greedy need the block statistics  */
+/*    table. With hot/cold, sectors moved by a reclaim are allocated from */
+/*    a search pointer that starts one block after the one of the sector  */
+/*    writes.                                                             */
+/*                                                                        */
+/*  INPUT                                                                 */
+/*                                                                        */
+/*    nor_flash                             NOR flash instance            */
+/*    policy                                LX_NOR_RECLAIM_POLICY_*       */
+/*                                                                        */
+/*  OUTPUT                                                                */
+/*                                                                        */
+/*    return status                                                       */
+/*                                                                        */
+/*  CALLS                                                                 */
+/*                                                                        */
+/*    tx_mutex_get                          Get thread protection         */
+/*    tx_mutex_put                          Release thread protection     */
+/*                                                                        */
+/*  CALLED BY                                                             */
+/*                                                                        */
+/*    Application Code                                                    */
+/*                                                                        */
+/**************************************************************************/
+UINT  _lx_nor_flash_reclaim_policy_set(LX_NOR_FLASH *nor_flash, UINT policy)
+{
+#ifdef LX_NOR_ENABLE_RECLAIM_POLICY
+
+    /* Determine if the policy is known.  */
+    if (policy > LX_NOR_RECLAIM_POLICY_HOT_COLD)
+    {
+
+        /* No, return an error.  */
+        return(LX_ERROR);
+    }
+
+    /* Determine if the block statistics table is in use.  */
+    if ((policy != LX_NOR_RECLAIM_POLICY_GREEDY) && (nor_flash -> lx_nor_flash_block_stats == LX_NULL))
+    {
+
+        /* No, only the greedy flash scan is available.  */
+        return(LX_NOT_SUPPORTED);
+    }
+
+#ifdef LX_THREAD_SAFE_ENABLE
+
+    /* Obtain the thread safe mutex.  */
+    tx_mutex_get(&nor_flash -> lx_nor_flash_mutex, TX_WAIT_FOREVER);
+#endif
+
+    /* Install the victim choice of the policy.  */
+    if (policy == LX_NOR_RECLAIM_POLICY_GREEDY)
+    {
+
+        /* The greedy choice is the default of the block statistics table.  */
+        nor_flash -> lx_nor_flash_reclaim_policy_victim_find =  LX_NULL;
+    }
+    else
+    {
+
+        /* Cost-benefit, with or without hot/cold separation.  */
+        nor_flash -> lx_nor_flash_reclaim_policy_victim_find =  _lx_nor_flash_reclaim_policy_cost_benefit_find;
+    }
+
+    /* Determine if relocated sectors need a search pointer of their own.  */
+    if ((policy == LX_NOR_RECLAIM_POLICY_HOT_COLD) && (nor_flash -> lx_nor_flash_reclaim_policy != LX_NOR_RECLAIM_POLICY_HOT_COLD))
+    {
+
+        /* Yes, start it one block after the search pointer of the sector writes.  */
+        nor_flash -> lx_nor_flash_reclaim_policy_relocate_search =  nor_flash -> lx_nor_flash_free_block_search + 1;
+
+        /* Check for wrap condition.  */
+        if (nor_flash -> lx_nor_flash_reclaim_policy_relocate_search >= nor_flash -> lx_nor_flash_total_blocks)
+            nor_flash -> lx_nor_flash_reclaim_policy_relocate_search =  0;
+    }
+
+    /* Remember the policy.  */
+    nor_flash -> lx_nor_flash_reclaim_policy =  policy;
+
+#ifdef LX_THREAD_SAFE_ENABLE
+
+    /* Release the thread safe mutex.  */
+    tx_mutex_put(&nor_flash -> lx_nor_flash_mutex);
+#endif
+
+    /* Return success.  */
+    return(LX_SUCCESS);
+#else
+
+    LX_PARAMETER_NOT_USED(nor_flash);
+    LX_PARAMETER_NOT_USED(policy);
+
+    /* Return disabled status.  */
+    return(LX_DISABLED);
+#endif
+}
@@ -67,6 +67,7 @@
 /*    _lx_nor_flash_logical_sector_find     Find logical sector           */ 
 /*    _lx_nor_flash_physical_sector_allocate                              */ 
 /*                                          Allocate new logical sector   */ 
+/*    _lx_nor_flash_mapping_table_update    Update RAM mapping table      */ 
 /*    _lx_nor_flash_system_error            Internal system error handler */ 
 /*    tx_mutex_get                          Get thread protection         */ 
 /*    tx_mutex_put                          Release thread protection     */ 
@@ -193,6 +194,11 @@ ULONG   *sector_address;
                 nor_flash -> lx_nor_flash_extended_cache_mapping_bitmap[logical_sector >> 5] |= (ULONG)(1 << (logical_sector & 31));
             }
 #endif
+#endif
+#ifdef LX_NOR_ENABLE_MAPPING_TABLE
+
+            /* Point the RAM mapping table to the new physical sector.  */
+            _lx_nor_flash_mapping_table_update(nor_flash, logical_sector, mapping_address);
 #endif
 
             /* Increment the number of mapped physical sectors.  */
@@ -64,9 +64,11 @@
 /*    _lx_nor_flash_driver_write            Driver flash sector write     */ 
 /*    _lx_nor_flash_driver_read             Driver flash sector read      */ 
 /*    _lx_nor_flash_block_reclaim           Reclaim one flash block       */ 
+/*    _lx_nor_flash_block_stats_obsolete    Record obsolete sector        */ 
 /*    _lx_nor_flash_sector_mapping_cache_invalidate                       */ 
 /*                                          Invalidate cache entry        */ 
 /*    _lx_nor_flash_logical_sector_find     Find logical sector           */ 
+/*    _lx_nor_flash_mapping_table_update    Update RAM mapping table      */ 
 /*    _lx_nor_flash_system_error            Internal system error handler */ 
 /*    tx_mutex_get                          Get thread protection         */ 
 /*    tx_mutex_put                          Release thread protection     */ 
@@ -182,6 +184,11 @@ ULONG   block;
             nor_flash -> lx_nor_flash_extended_cache_mapping_bitmap[logical_sector >> 5] &= (ULONG)~(1 << (logical_sector & 31));
         }
 #endif
+#endif
+#ifdef LX_NOR_ENABLE_MAPPING_TABLE
+
+        /* The logical sector is no longer mapped.  */
+        _lx_nor_flash_mapping_table_update(nor_flash, logical_sector, LX_NULL);
 #endif
 
         /* Increment the number of obsolete physical sectors.  */
@@ -200,6 +207,11 @@ ULONG   block;
             nor_flash -> lx_nor_flash_extended_cache_obsolete_count[block] ++;
         }
 #endif
+#ifdef LX_NOR_ENABLE_BLOCK_STATS
+
+        /* Record the obsolete sector in the block statistics table.  */
+        _lx_nor_flash_block_stats_obsolete(nor_flash, mapping_address);
+#endif
 
         /* Decrement the number of mapped physical sectors.  */
         nor_flash -> lx_nor_flash_mapped_physical_sectors--;
@@ -65,11 +65,13 @@
 /*    _lx_nor_flash_driver_write            Driver flash sector write     */ 
 /*    _lx_nor_flash_driver_read             Driver flash sector read      */ 
 /*    _lx_nor_flash_block_reclaim           Reclaim one flash block       */ 
+/*    _lx_nor_flash_block_stats_obsolete    Record obsolete sector        */ 
 /*    _lx_nor_flash_logical_sector_find     Find logical sector           */ 
 /*    _lx_nor_flash_physical_sector_allocate                              */ 
 /*                                          Allocate new physical sector  */ 
 /*    _lx_nor_flash_sector_mapping_cache_invalidate                       */ 
 /*                                          Invalidate cache entry        */ 
+/*    _lx_nor_flash_mapping_table_update    Update RAM mapping table      */ 
 /*    _lx_nor_flash_system_error            Internal system error handler */ 
 /*    tx_mutex_get                          Get thread protection         */ 
 /*    tx_mutex_put                          Release thread protection     */ 
@@ -286,6 +288,11 @@ ULONG                           block;
             nor_flash -> lx_nor_flash_extended_cache_mapping_bitmap[logical_sector >> 5] |= (ULONG)(1 << (logical_sector & 31));
         }
 #endif
+#endif
+#ifdef LX_NOR_ENABLE_MAPPING_TABLE
+
+        /* Point the RAM mapping table to the new physical sector.  */
+        _lx_nor_flash_mapping_table_update(nor_flash, logical_sector, new_mapping_address);
 #endif
 
         /* Increment the number of mapped physical sectors.  */
@@ -334,6 +341,11 @@ ULONG                           block;
                 nor_flash -> lx_nor_flash_extended_cache_obsolete_count[block] ++;
             }
 #endif
+#ifdef LX_NOR_ENABLE_BLOCK_STATS
+
+            /* Record the obsolete sector in the block statistics table.  */
+            _lx_nor_flash_block_stats_obsolete(nor_flash, old_mapping_address);
+#endif
 
             /* Decrement the number of mapped physical sectors.  */
             nor_flash -> lx_nor_flash_mapped_physical_sectors--;
@@ -0,0 +1,193 @@
+/**************************************************************************/
+/**************************************************************************/
+/**                                                                       */
+/** LevelX Component                                                      */
+/**                                                                       */
+/**   NOR Flash                                                           */
+/**                                                                       */
+/**************************************************************************/
+/**************************************************************************/
+
+#define LX_SOURCE_CODE
+
+
+/* Disable ThreadX error checking.  */
+
+#ifndef LX_DISABLE_ERROR_CHECKING
+#define LX_DISABLE_ERROR_CHECKING
+#endif
+
+
+/* Include necessary system files.  */
+
+#include "lx_api.h"
+
+
+/**************************************************************************/
+/*                                                                        */
+/*  FUNCTION                                               RELEASE        */
+/*                                                                        */
+/*    _lx_nor_flash_sectors_read                          PORTABLE C      */
+/*                                                                        */
+/*  DESCRIPTION                                                           */
+/*                                                                        */
+/*    This function reads multiple consecutive logical sectors from NOR   */
+/*    flash. Logical sectors that are stored in physically contiguous     */
+/*    sectors are fetched with a single driver read, so a run of N        */
+/*    sectors costs one flash command instead of N. Sectors that are not  */
+/*    mapped yet are handed to _lx_nor_flash_sector_read, which keeps the */
+/*    single sector semantics (allocation of the sector) unchanged.       */
+/*                                                                        */
+/*  INPUT                                                                 */
+/*                                                                        */
+/*    nor_flash                             NOR flash instance            */
+/*    logical_sector                        First logical sector number   */
+/*    buffer                                Pointer to buffer to read into*/
+/*                                            (the size is sector_count   */
+/*                                             times 512 bytes)           */
+/*    sector_count                          Number of sectors to read     */
+/*                                                                        */
+/*  OUTPUT                                                                */
+/*                                                                        */
+/*    return status                                                       */
+/*                                                                        */
+/*  CALLS                                                                 */
+/*                                                                        */
+/*    _lx_nor_flash_driver_read             Driver flash sector read      */
+/*    _lx_nor_flash_logical_sector_find     Find logical sector           */
+/*    _lx_nor_flash_sector_read             Read (allocate) one sector    */
+/*    _lx_nor_flash_system_error            Internal system error handler */
+/*    tx_mutex_get                          Get thread protection         */
+/*    tx_mutex_put                          Release thread protection     */
+/*                                                                        */
+/*  CALLED BY                                                             */
+/*                                                                        */
+/*    Application Code                                                    */
+/*                                                                        */
+/**************************************************************************/
+UINT  _lx_nor_flash_sectors_read(LX_NOR_FLASH *nor_flash, ULONG logical_sector, VOID *buffer, ULONG sector_count)
+{
+
+UINT    status;
+ULONG   *mapping_address;
+ULONG   *sector_address;
+ULONG   *run_address;
+ULONG   *run_buffer;
+ULONG   run_sectors;
+ULONG   *destination;
+ULONG   i;
+
+
+#ifdef LX_THREAD_SAFE_ENABLE
+
+    /* Obtain the thread safe mutex.  */
+    tx_mutex_get(&nor_flash -> lx_nor_flash_mutex, TX_WAIT_FOREVER);
+#endif
+
+    /* Start without a pending run of physically contiguous sectors.  */
+    status =       LX_SUCCESS;
+    run_address =  LX_NULL;
+    run_buffer =   LX_NULL;
+    run_sectors =  0;
+    destination =  (ULONG *) buffer;
+
+    /* Loop to read all the sectors.  */
+    for (i = 0; i < sector_count; i++)
+    {
+
+        /* See if we can find the sector in the current mapping.  */
+        _lx_nor_flash_logical_sector_find(nor_flash, logical_sector + i, LX_FALSE, &mapping_address, &sector_address);
+
+        /* Determine if this sector extends the pending run.  */
+        if ((mapping_address) && (run_sectors) && (sector_address == run_address + (run_sectors * LX_NOR_SECTOR_SIZE)))
+        {
+
+            /* Yes, the sector follows the run in flash. Just grow the run.  */
+            nor_flash -> lx_nor_flash_read_requests++;
+            run_sectors++;
+        }
+        else
+        {
+
+            /* Flush the pending run, if any.  */
+            if (run_sectors)
+            {
+
+                /* Read the whole run with one driver request.  */
+                status =  _lx_nor_flash_driver_read(nor_flash, run_address, run_buffer, run_sectors * LX_NOR_SECTOR_SIZE);
+
+                /* Check for an error from flash driver. Drivers should never return an error..  */
+                if (status)
+                {
+
+                    /* Call system error handler.  */
+                    _lx_nor_flash_system_error(nor_flash, status);
+
+                    /* Adjust return status.  */
+                    status =  LX_ERROR;
+                    break;
+                }
+
+                /* The run is consumed.  */
+                run_sectors =  0;
+            }
+
+            /* Determine if the logical sector was found.  */
+            if (mapping_address)
+            {
+
+                /* Yes, start a new run at this sector.  */
+                nor_flash -> lx_nor_flash_read_requests++;
+                run_address =  sector_address;
+                run_buffer =   destination;
+                run_sectors =  1;
+            }
+            else
+            {
+
+                /* The sector is not mapped, the single sector read allocates it.  */
+                status =  _lx_nor_flash_sector_read(nor_flash, logical_sector + i, destination);
+
+                /* Check return status.  */
+                if (status)
+                {
+
+                    /* Error, break the loop.  */
+                    break;
+                }
+            }
+        }
+
+        /* Move the destination to the next sector.  */
+        destination =  destination + LX_NOR_SECTOR_SIZE;
+    }
+
+    /* Flush the last run.  */
+    if ((status == LX_SUCCESS) && (run_sectors))
+    {
+
+        /* Read the whole run with one driver request.  */
+        status =  _lx_nor_flash_driver_read(nor_flash, run_address, run_buffer, run_sectors * LX_NOR_SECTOR_SIZE);
+
+        /* Check for an error from flash driver. Drivers should never return an error..  */
+        if (status)
+        {
+
+            /* Call system error handler.  */
+            _lx_nor_flash_system_error(nor_flash, status);
+
+            /* Adjust return status.  */
+            status =  LX_ERROR;
+        }
+    }
+
+#ifdef LX_THREAD_SAFE_ENABLE
+
+    /* Release the thread safe mutex.  */
+    tx_mutex_put(&nor_flash -> lx_nor_flash_mutex);
+#endif
+
+    /* Return status.  */
+    return(status);
+}
+
@@ -0,0 +1,451 @@
+/**************************************************************************/
+/**************************************************************************/
+/**                                                                       */
+/** LevelX Component                                                      */
+/**                                                                       */
+/**   NOR Flash                                                           */
+/**                                                                       */
+/**************************************************************************/
+/**************************************************************************/
+
+#define LX_SOURCE_CODE
+
+
+/* Disable ThreadX error checking.  */
+
+#ifndef LX_DISABLE_ERROR_CHECKING
+#define LX_DISABLE_ERROR_CHECKING
+#endif
+
+
+/* Include necessary system files.  */
+
+#include "lx_api.h"
+
+
+/**************************************************************************/
+/*                                                                        */
+/*  FUNCTION                                               RELEASE        */
+/*                                                                        */
+/*    _lx_nor_flash_sectors_write                         PORTABLE C      */
+/*                                                                        */
+/*  DESCRIPTION                                                           */
+/*                                                                        */
+/*    This function writes multiple consecutive logical sectors to NOR    */
+/*    flash. Sectors are staged in batches of LX_NOR_SECTORS_WRITE_BATCH: */
+/*    all physical sectors of a batch are allocated first and their new   */
+/*    mapping entries are written with the not valid bit still set, then  */
+/*    the data of physically contiguous sectors is programmed with one    */
+/*    driver write, and finally each mapping is committed in the same     */
+/*    order as _lx_nor_flash_sector_write does. An interrupted batch is   */
+/*    therefore recovered by open exactly like an interrupted single      */
+/*    sector write.                                                       */
+/*                                                                        */
+/*  INPUT                                                                 */
+/*                                                                        */
+/*    nor_flash                             NOR flash instance            */
+/*    logical_sector                        First logical sector number   */
+/*    buffer                                Pointer to buffer to write    */
+/*                                            (the size is sector_count   */
+/*                                             times 512 bytes)           */
+/*    sector_count                          Number of sectors to write    */
+/*                                                                        */
+/*  OUTPUT                                                                */
+/*                                                                        */
+/*    return status                                                       */
+/*                                                                        */
+/*  CALLS                                                                 */
+/*                                                                        */
+/*    _lx_nor_flash_block_reclaim           Reclaim one flash block       */
+/*    _lx_nor_flash_block_stats_obsolete    Record obsolete sector        */
+/*    _lx_nor_flash_driver_read             Driver flash sector read      */
+/*    _lx_nor_flash_driver_write            Driver flash sector write     */
+/*    _lx_nor_flash_logical_sector_find     Find logical sector           */
+/*    _lx_nor_flash_physical_sector_allocate                              */
+/*                                          Allocate new physical sector  */
+/*    _lx_nor_flash_sector_mapping_cache_invalidate                       */
+/*                                          Invalidate cache entry        */
+/*    _lx_nor_flash_sector_write            Write one sector              */
+/*    _lx_nor_flash_mapping_table_update    Update RAM mapping table      */
+/*    _lx_nor_flash_system_error            Internal system error handler */
+/*    tx_mutex_get                          Get thread protection         */
+/*    tx_mutex_put                          Release thread protection     */
+/*                                                                        */
+/*  CALLED BY                                                             */
+/*                                                                        */
+/*    Application Code                                                    */
+/*                                                                        */
+/**************************************************************************/
+UINT  _lx_nor_flash_sectors_write(LX_NOR_FLASH *nor_flash, ULONG logical_sector, VOID *buffer, ULONG sector_count)
+{
+
+ULONG                           *old_mapping_address[LX_NOR_SECTORS_WRITE_BATCH];
+ULONG                           *old_sector_address;
+ULONG                           old_mapping_entry;
+ULONG                           *new_mapping_address[LX_NOR_SECTORS_WRITE_BATCH];
+ULONG                           *new_sector_address[LX_NOR_SECTORS_WRITE_BATCH];
+ULONG                           new_mapping_entry;
+ULONG                           *source;
+ULONG                           sector;
+ULONG                           batch;
+ULONG                           run;
+ULONG                           i, j;
+LX_NOR_SECTOR_MAPPING_CACHE_ENTRY  *sector_mapping_cache_entry_ptr;
+UINT                            status;
+UINT                            batch_status;
+#ifdef LX_NOR_ENABLE_OBSOLETE_COUNT_CACHE
+ULONG                           block;
+#endif
+
+#ifdef LX_THREAD_SAFE_ENABLE
+
+    /* Obtain the thread safe mutex.  */
+    tx_mutex_get(&nor_flash -> lx_nor_flash_mutex, TX_WAIT_FOREVER);
+#endif
+
+    /* Start with the first sector of the request.  */
+    status =  LX_SUCCESS;
+    sector =  logical_sector;
+    source =  (ULONG *) buffer;
+
+    /* Loop to write all the sectors, one batch at a time.  */
+    while ((status == LX_SUCCESS) && (sector < logical_sector + sector_count))
+    {
+
+        /* Calculate the size of this batch.  */
+        batch =  (logical_sector + sector_count) - sector;
+        if (batch > LX_NOR_SECTORS_WRITE_BATCH)
+            batch =  LX_NOR_SECTORS_WRITE_BATCH;
+
+        /* Keep at least one block's worth of free sectors after the whole batch is allocated. Reclaim
+           must not run in the middle of a batch, since the staged sectors are not valid yet.  */
+        i =  0;
+        while (nor_flash -> lx_nor_flash_free_physical_sectors < nor_flash -> lx_nor_flash_physical_sectors_per_block + batch)
+        {
+
+            /* Attempt to reclaim one physical block.  */
+            _lx_nor_flash_block_reclaim(nor_flash);
+
+            /* Increment the block count.  */
+            i++;
+
+            /* Have we exceeded the number of blocks in the system?  */
+            if (i >= nor_flash -> lx_nor_flash_total_blocks)
+            {
+
+                /* Yes, break out of the loop.  */
+                break;
+            }
+        }
+
+        /* Determine if the flash is too full to stage a batch.  */
+        if (nor_flash -> lx_nor_flash_free_physical_sectors < nor_flash -> lx_nor_flash_physical_sectors_per_block + batch)
+        {
+
+            /* Yes, fall back to single sector writes, which may use the last free sectors.  */
+            for (i = 0; i < batch; i++)
+            {
+
+                /* Write one sector.  */
+                status =  _lx_nor_flash_sector_write(nor_flash, sector, source);
+
+                /* Check return status.  */
+                if (status)
+                {
+
+                    /* Error, break the loop.  */
+                    break;
+                }
+
+                /* Move to the next sector.  */
+                sector++;
+                source =  source + LX_NOR_SECTOR_SIZE;
+            }
+
+            /* Continue with the next batch.  */
+            continue;
+        }
+
+        /* Allocate the physical sectors of the batch and stage their mapping entries.  */
+        batch_status =  LX_SUCCESS;
+        for (i = 0; i < batch; i++)
+        {
+
+            /* Increment the number of write requests.  */
+            nor_flash -> lx_nor_flash_write_requests++;
+
+            /* See if we can find the sector in the current mapping.  */
+            _lx_nor_flash_logical_sector_find(nor_flash, sector + i, LX_FALSE, &old_mapping_address[i], &old_sector_address);
+
+            /* Allocate a new physical sector for this write.  */
+            _lx_nor_flash_physical_sector_allocate(nor_flash, sector + i, &new_mapping_address[i], &new_sector_address[i]);
+
+            /* Determine if the new sector allocation was successful.  */
+            if (new_mapping_address[i] == LX_NULL)
+            {
+
+                /* No, finish the sectors staged so far and stop.  */
+                batch_status =  LX_NO_SECTORS;
+                batch =         i;
+                break;
+            }
+
+            /* Update the number of free physical sectors.  */
+            nor_flash -> lx_nor_flash_free_physical_sectors--;
+
+            /* Build the new mapping entry with the not valid bit set. Open treats such an entry as an
+               interrupted write, and logical sector find skips it until it is committed.  */
+            new_mapping_entry =  ((ULONG) LX_NOR_PHYSICAL_SECTOR_VALID) | ((ULONG) LX_NOR_PHYSICAL_SECTOR_SUPERCEDED) | ((ULONG) LX_NOR_PHYSICAL_SECTOR_MAPPING_NOT_VALID) | (sector + i);
+
+            /* Write out the new mapping entry.  */
+            status =  _lx_nor_flash_driver_write(nor_flash, new_mapping_address[i], &new_mapping_entry, 1);
+
+            /* Check for an error from flash driver. Drivers should never return an error..  */
+            if (status)
+            {
+
+                /* Call system error handler.  */
+                _lx_nor_flash_system_error(nor_flash, status);
+
+#ifdef LX_THREAD_SAFE_ENABLE
+
+                /* Release the thread safe mutex.  */
+                tx_mutex_put(&nor_flash -> lx_nor_flash_mutex);
+#endif
+
+                /* Return status.  */
+                return(LX_ERROR);
+            }
+        }
+
+        /* Write the sector data, one driver request per physically contiguous run.  */
+        for (i = 0; i < batch; i =  i + run)
+        {
+
+            /* Find the length of the run starting at this sector.  */
+            run =  1;
+            while ((i + run < batch) && (new_sector_address[i + run] == new_sector_address[i] + (run * LX_NOR_SECTOR_SIZE)))
+            {
+                run++;
+            }
+
+            /* Write the sector data of the whole run.  */
+            status =  _lx_nor_flash_driver_write(nor_flash, new_sector_address[i], source + (i * LX_NOR_SECTOR_SIZE), run * LX_NOR_SECTOR_SIZE);
+
+            /* Check for an error from flash driver. Drivers should never return an error..  */
+            if (status)
+            {
+
+                /* Call system error handler.  */
+                _lx_nor_flash_system_error(nor_flash, status);
+
+#ifdef LX_THREAD_SAFE_ENABLE
+
+                /* Release the thread safe mutex.  */
+                tx_mutex_put(&nor_flash -> lx_nor_flash_mutex);
+#endif
+
+                /* Return status.  */
+                return(LX_ERROR);
+            }
+        }
+
+        /* Commit the mapping of every sector in the batch.  */
+        for (i = 0; i < batch; i++)
+        {
+
+            /* Was there a previously mapped sector?  */
+            if (old_mapping_address[i])
+            {
+
+                /* Now deprecate the old sector mapping.  */
+
+                /* Read in the old sector mapping.  */
+#ifdef LX_DIRECT_READ
+
+                /* Read the word directly.  */
+                old_mapping_entry =  *(old_mapping_address[i]);
+#else
+                status =  _lx_nor_flash_driver_read(nor_flash, old_mapping_address[i], &old_mapping_entry, 1);
+
+                /* Check for an error from flash driver. Drivers should never return an error..  */
+                if (status)
+                {
+
+                    /* Call system error handler.  */
+                    _lx_nor_flash_system_error(nor_flash, status);
+
+#ifdef LX_THREAD_SAFE_ENABLE
+
+                    /* Release the thread safe mutex.  */
+                    tx_mutex_put(&nor_flash -> lx_nor_flash_mutex);
+#endif
+
+                    /* Return status.  */
+                    return(LX_ERROR);
+                }
+#endif
+
+                /* Clear bit 30, which indicates this sector is superceded.  */
+                old_mapping_entry =  old_mapping_entry & ~((ULONG) LX_NOR_PHYSICAL_SECTOR_SUPERCEDED);
+
+                /* Write the value back to the flash to clear bit 30.  */
+                status =  _lx_nor_flash_driver_write(nor_flash, old_mapping_address[i], &old_mapping_entry, 1);
+
+                /* Check for an error from flash driver. Drivers should never return an error..  */
+                if (status)
+                {
+
+                    /* Call system error handler.  */
+                    _lx_nor_flash_system_error(nor_flash, status);
+
+#ifdef LX_THREAD_SAFE_ENABLE
+
+                    /* Release the thread safe mutex.  */
+                    tx_mutex_put(&nor_flash -> lx_nor_flash_mutex);
+#endif
+
+                    /* Return status.  */
+                    return(LX_ERROR);
+                }
+            }
+
+            /* Now clear the not valid bit to make this sector mapping valid.  */
+            new_mapping_entry =  ((ULONG) LX_NOR_PHYSICAL_SECTOR_VALID) | ((ULONG) LX_NOR_PHYSICAL_SECTOR_SUPERCEDED) | (sector + i);
+
+            /* Clear the not valid bit.  */
+            status =  _lx_nor_flash_driver_write(nor_flash, new_mapping_address[i], &new_mapping_entry, 1);
+
+            /* Check for an error from flash driver. Drivers should never return an error..  */
+            if (status)
+            {
+
+                /* Call system error handler.  */
+                _lx_nor_flash_system_error(nor_flash, status);
+
+#ifdef LX_THREAD_SAFE_ENABLE
+
+                /* Release the thread safe mutex.  */
+                tx_mutex_put(&nor_flash -> lx_nor_flash_mutex);
+#endif
+
+                /* Return status.  */
+                return(LX_ERROR);
+            }
+#ifndef LX_NOR_DISABLE_EXTENDED_CACHE
+#ifdef LX_NOR_ENABLE_MAPPING_BITMAP
+
+            /* Determine if the logical sector is within the mapping bitmap.  */
+            if ((sector + i) < nor_flash -> lx_nor_flash_extended_cache_mapping_bitmap_max_logical_sector)
+            {
+
+                /* Set the bit in the mapping bitmap.  */
+                nor_flash -> lx_nor_flash_extended_cache_mapping_bitmap[(sector + i) >> 5] |= ((ULONG) 1) << ((sector + i) & 31);
+            }
+#endif
+#endif
+#ifdef LX_NOR_ENABLE_MAPPING_TABLE
+
+            /* Point the RAM mapping table to the new physical sector.  */
+            _lx_nor_flash_mapping_table_update(nor_flash, sector + i, new_mapping_address[i]);
+#endif
+
+            /* Increment the number of mapped physical sectors.  */
+            nor_flash -> lx_nor_flash_mapped_physical_sectors++;
+
+            /* Was there a previously mapped sector?  */
+            if (old_mapping_address[i])
+            {
+
+                /* Now clear bit 31, which indicates this sector is now obsoleted.  */
+                old_mapping_entry =  old_mapping_entry & ~((ULONG) LX_NOR_PHYSICAL_SECTOR_VALID);
+
+                /* Write the value back to the flash to clear bit 31.  */
+                status =  _lx_nor_flash_driver_write(nor_flash, old_mapping_address[i], &old_mapping_entry, 1);
+
+                /* Check for an error from flash driver. Drivers should never return an error..  */
+                if (status)
+                {
+
+                    /* Call system error handler.  */
+                    _lx_nor_flash_system_error(nor_flash, status);
+
+#ifdef LX_THREAD_SAFE_ENABLE
+
+                    /* Release the thread safe mutex.  */
+                    tx_mutex_put(&nor_flash -> lx_nor_flash_mutex);
+#endif
+
+                    /* Return status.  */
+                    return(LX_ERROR);
+                }
+
+                /* Increment the number of obsolete physical sectors.  */
+                nor_flash -> lx_nor_flash_obsolete_physical_sectors++;
+
+#ifdef LX_NOR_ENABLE_OBSOLETE_COUNT_CACHE
+
+                /* Get the block number from mapping address.  */
+                block = (ULONG)(old_mapping_address[i] - nor_flash -> lx_nor_flash_base_address) / nor_flash -> lx_nor_flash_words_per_block;
+
+                /* Determine if this block is within the range of the obsolete count cache.  */
+                if (block < nor_flash -> lx_nor_flash_extended_cache_obsolete_count_max_block)
+                {
+
+                    /* Increment the obsolete count for this block.  */
+                    nor_flash -> lx_nor_flash_extended_cache_obsolete_count[block] ++;
+                }
+#endif
+#ifdef LX_NOR_ENABLE_BLOCK_STATS
+
+                /* Record the obsolete sector in the block statistics table.  */
+                _lx_nor_flash_block_stats_obsolete(nor_flash, old_mapping_address[i]);
+#endif
+
+                /* Decrement the number of mapped physical sectors.  */
+                nor_flash -> lx_nor_flash_mapped_physical_sectors--;
+
+                /* Invalidate the old sector mapping cache entry.  */
+                _lx_nor_flash_sector_mapping_cache_invalidate(nor_flash, sector + i);
+            }
+
+            /* Determine if the sector mapping cache is enabled.  */
+            if (nor_flash -> lx_nor_flash_sector_mapping_cache_enabled)
+            {
+
+                /* Yes, sector mapping cache is enabled, place this sector information in the cache.  */
+
+                /* Calculate the starting index of the sector mapping cache for this sector entry.  */
+                j =  ((sector + i) & LX_NOR_SECTOR_MAPPING_CACHE_HASH_MASK) * LX_NOR_SECTOR_MAPPING_CACHE_DEPTH;
+
+                /* Build a pointer to the cache entry.  */
+                sector_mapping_cache_entry_ptr =  &nor_flash -> lx_nor_flash_sector_mapping_cache[j];
+
+                /* Move all the cache entries down so the oldest is at the bottom.  */
+                *(sector_mapping_cache_entry_ptr + 3) =  *(sector_mapping_cache_entry_ptr + 2);
+                *(sector_mapping_cache_entry_ptr + 2) =  *(sector_mapping_cache_entry_ptr + 1);
+                *(sector_mapping_cache_entry_ptr + 1) =  *(sector_mapping_cache_entry_ptr);
+
+                /* Setup the new sector information in the cache.  */
+                sector_mapping_cache_entry_ptr -> lx_nor_sector_mapping_cache_logical_sector =             ((sector + i) | LX_NOR_SECTOR_MAPPING_CACHE_ENTRY_VALID);
+                sector_mapping_cache_entry_ptr -> lx_nor_sector_mapping_cache_physical_sector_map_entry =  new_mapping_address[i];
+                sector_mapping_cache_entry_ptr -> lx_nor_sector_mapping_cache_physical_sector_address =    new_sector_address[i];
+            }
+        }
+
+        /* Move to the next batch, unless the batch was cut short.  */
+        status =  batch_status;
+        sector =  sector + batch;
+        source =  source + (batch * LX_NOR_SECTOR_SIZE);
+    }
+
+#ifdef LX_THREAD_SAFE_ENABLE
+
+    /* Release the thread safe mutex.  */
+    tx_mutex_put(&nor_flash -> lx_nor_flash_mutex);
+#endif
+
+    /* Return the completion status.  */
+    return(status);
+}
+
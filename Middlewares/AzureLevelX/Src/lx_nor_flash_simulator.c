@@ -0,0 +1,432 @@
+/**************************************************************************/
+/**************************************************************************/
+/**                                                                       */
+/** LevelX Component                                                      */
+/**                                                                       */
+/**   NOR Flash Simulator                                                 */
+/**                                                                       */
+/**************************************************************************/
+/**************************************************************************/
+
+
+/* Include necessary files.  */
+
+#include "lx_api.h"
+#include "lx_nor_flash_simulator.h"
+
+
+/* Default latency model: N25Q128A13EF840E on the QUADSPI of the STM32F412 (100 MHz bus, 10 dummy clocks).
+   Quad I/O fast read moves one byte every two clocks, the command phase covers the 8 instruction, 6 address
+   and 10 dummy clocks plus the HAL command setup. Busy times are the typical datasheet values.  */
+
+#define LX_NOR_SIMULATOR_DEFAULT_COMMAND_NS             1000
+#define LX_NOR_SIMULATOR_DEFAULT_READ_BYTE_NS           20
+#define LX_NOR_SIMULATOR_DEFAULT_WRITE_BYTE_NS          20
+#define LX_NOR_SIMULATOR_DEFAULT_WRITE_ENABLE_NS        1500
+#define LX_NOR_SIMULATOR_DEFAULT_PAGE_PROGRAM_NS        500000
+#define LX_NOR_SIMULATOR_DEFAULT_SUBSECTOR_ERASE_NS     250000000
+#define LX_NOR_SIMULATOR_DEFAULT_SECTOR_ERASE_NS        700000000
+
+
+
+/* Simulated memory array, statistics and latency model.  */
+
+static ULONG                            nor_simulator_memory[LX_NOR_SIMULATOR_FLASH_SIZE / sizeof(ULONG)];
+static ULONG                            nor_simulator_sector_buffer[LX_NOR_SECTOR_SIZE];
+static LX_NOR_FLASH_SIMULATOR_STATS     nor_simulator_stats;
+static ULONG                            nor_simulator_block_size =    LX_NOR_SIMULATOR_BLOCK_SIZE;
+static ULONG                            nor_simulator_total_blocks =  LX_NOR_SIMULATOR_TOTAL_BLOCKS;
+#ifdef LX_NOR_ENABLE_CHECKPOINT
+static ULONG                            nor_simulator_checkpoint_block_map[((LX_NOR_SIMULATOR_FLASH_SIZE / LX_NOR_SIMULATOR_SUBSECTOR_SIZE) + 31) / 32];
+#endif
+#ifdef LX_NOR_ENABLE_BLOCK_STATS
+static LX_NOR_FLASH_BLOCK_STATS         nor_simulator_block_stats[LX_NOR_SIMULATOR_FLASH_SIZE / LX_NOR_SIMULATOR_SUBSECTOR_SIZE];
+static USHORT                           nor_simulator_block_stats_buckets[LX_NOR_BLOCK_STATS_BUCKETS(LX_NOR_SIMULATOR_SECTOR_SIZE / sizeof(ULONG))];
+#endif
+static LX_NOR_FLASH_SIMULATOR_TIMING    nor_simulator_timing =
+{
+    LX_NOR_SIMULATOR_DEFAULT_COMMAND_NS,
+    LX_NOR_SIMULATOR_DEFAULT_READ_BYTE_NS,
+    LX_NOR_SIMULATOR_DEFAULT_WRITE_BYTE_NS,
+    LX_NOR_SIMULATOR_DEFAULT_WRITE_ENABLE_NS,
+    LX_NOR_SIMULATOR_DEFAULT_PAGE_PROGRAM_NS,
+    LX_NOR_SIMULATOR_DEFAULT_SUBSECTOR_ERASE_NS,
+    LX_NOR_SIMULATOR_DEFAULT_SECTOR_ERASE_NS
+};
+
+
+#ifdef LX_NOR_ENABLE_CONTROL_BLOCK_FOR_DRIVER_INTERFACE
+UINT  _lx_nor_flash_simulator_read(LX_NOR_FLASH *nor_flash, ULONG *flash_address, ULONG *destination, ULONG words);
+UINT  _lx_nor_flash_simulator_write(LX_NOR_FLASH *nor_flash, ULONG *flash_address, ULONG *source, ULONG words);
+UINT  _lx_nor_flash_simulator_block_erase(LX_NOR_FLASH *nor_flash, ULONG block, ULONG erase_count);
+UINT  _lx_nor_flash_simulator_block_erased_verify(LX_NOR_FLASH *nor_flash, ULONG block);
+UINT  _lx_nor_flash_simulator_system_error(LX_NOR_FLASH *nor_flash, UINT error_code);
+#else
+UINT  _lx_nor_flash_simulator_read(ULONG *flash_address, ULONG *destination, ULONG words);
+UINT  _lx_nor_flash_simulator_write(ULONG *flash_address, ULONG *source, ULONG words);
+UINT  _lx_nor_flash_simulator_block_erase(ULONG block, ULONG erase_count);
+UINT  _lx_nor_flash_simulator_block_erased_verify(ULONG block);
+UINT  _lx_nor_flash_simulator_system_error(UINT error_code);
+#endif
+
+static UINT  _lx_nor_flash_simulator_address_check(ULONG *flash_address, ULONG words);
+static VOID  _lx_nor_flash_simulator_page_program(ULONG offset, UCHAR *source, ULONG size);
+static VOID  _lx_nor_flash_simulator_erase_unit(ULONG offset, ULONG size);
+
+
+UINT  _lx_nor_flash_simulator_initialize(LX_NOR_FLASH *nor_flash)
+{
+
+#ifdef LX_NOR_ENABLE_CHECKPOINT
+ULONG   checkpoint_blocks;
+#endif
+
+    /* Setup the base address of the flash memory. Reads are served from the array, so LX_DIRECT_READ works too.  */
+    nor_flash -> lx_nor_flash_base_address =                (ULONG *) &nor_simulator_memory[0];
+
+    /* Setup geometry of the NOR flash.  */
+    nor_flash -> lx_nor_flash_total_blocks =                nor_simulator_total_blocks;
+    nor_flash -> lx_nor_flash_words_per_block =             nor_simulator_block_size / sizeof(ULONG);
+
+    /* Setup function pointers for the NOR flash services.  */
+    nor_flash -> lx_nor_flash_driver_read =                 _lx_nor_flash_simulator_read;
+    nor_flash -> lx_nor_flash_driver_write =                _lx_nor_flash_simulator_write;
+    nor_flash -> lx_nor_flash_driver_block_erase =          _lx_nor_flash_simulator_block_erase;
+    nor_flash -> lx_nor_flash_driver_block_erased_verify =  _lx_nor_flash_simulator_block_erased_verify;
+    nor_flash -> lx_nor_flash_driver_system_error =         _lx_nor_flash_simulator_system_error;
+
+    /* Setup local buffer for NOR flash operation. This buffer must be the sector size of the NOR flash memory.  */
+    nor_flash -> lx_nor_flash_sector_buffer =  &nor_simulator_sector_buffer[0];
+
+#ifdef LX_NOR_ENABLE_CHECKPOINT
+
+    /* Like nor_driver.c, the checkpoint area is the spare space after the managed blocks, up to one 64 KB sector.  */
+    checkpoint_blocks =  (LX_NOR_SIMULATOR_FLASH_SIZE / nor_simulator_block_size) - nor_simulator_total_blocks;
+    if (checkpoint_blocks > ((LX_NOR_SIMULATOR_SECTOR_SIZE + nor_simulator_block_size - 1) / nor_simulator_block_size))
+        checkpoint_blocks =  (LX_NOR_SIMULATOR_SECTOR_SIZE + nor_simulator_block_size - 1) / nor_simulator_block_size;
+    nor_flash -> lx_nor_flash_checkpoint_blocks =     checkpoint_blocks;
+    nor_flash -> lx_nor_flash_checkpoint_block_map =  &nor_simulator_checkpoint_block_map[0];
+#endif
+#ifdef LX_NOR_ENABLE_BLOCK_STATS
+
+    /* The block statistics table covers blocks of up to one 64 KB sector, larger ones are found by scanning.  */
+    if (nor_simulator_block_size <= LX_NOR_SIMULATOR_SECTOR_SIZE)
+    {
+        nor_flash -> lx_nor_flash_block_stats =          &nor_simulator_block_stats[0];
+        nor_flash -> lx_nor_flash_block_stats_buckets =  &nor_simulator_block_stats_buckets[0];
+    }
+#endif
+
+    /* Return success.  */
+    return(LX_SUCCESS);
+}
+
+
+UINT  _lx_nor_flash_simulator_erase_all(VOID)
+{
+
+    /* A fresh part reads back all ones. Bulk erase is not timed, it models the factory state.  */
+    LX_MEMSET(nor_simulator_memory, 0xFF, sizeof(nor_simulator_memory));
+
+    /* Return success.  */
+    return(LX_SUCCESS);
+}
+
+
+UINT  _lx_nor_flash_simulator_geometry_set(ULONG block_size, ULONG total_blocks)
+{
+
+    /* Blocks must be made of whole erase units and fit into the part.  */
+    if ((block_size == 0) || (block_size % LX_NOR_SIMULATOR_SUBSECTOR_SIZE) ||
+        (total_blocks == 0) || (total_blocks > LX_NOR_SIMULATOR_FLASH_SIZE / block_size))
+        return(LX_ERROR);
+
+    nor_simulator_block_size =    block_size;
+    nor_simulator_total_blocks =  total_blocks;
+
+    /* Return success.  */
+    return(LX_SUCCESS);
+}
+
+
+VOID  _lx_nor_flash_simulator_geometry_get(ULONG *block_size, ULONG *total_blocks)
+{
+
+    *block_size =    nor_simulator_block_size;
+    *total_blocks =  nor_simulator_total_blocks;
+}
+
+
+VOID  _lx_nor_flash_simulator_timing_set(const LX_NOR_FLASH_SIMULATOR_TIMING *timing)
+{
+
+    nor_simulator_timing =  *timing;
+}
+
+
+VOID  _lx_nor_flash_simulator_timing_get(LX_NOR_FLASH_SIMULATOR_TIMING *timing)
+{
+
+    *timing =  nor_simulator_timing;
+}
+
+
+VOID  _lx_nor_flash_simulator_stats_get(LX_NOR_FLASH_SIMULATOR_STATS *stats)
+{
+
+    *stats =  nor_simulator_stats;
+}
+
+
+VOID  _lx_nor_flash_simulator_stats_reset(VOID)
+{
+
+    LX_MEMSET(&nor_simulator_stats, 0, sizeof(nor_simulator_stats));
+}
+
+
+ULONG64  _lx_nor_flash_simulator_time_get(VOID)
+{
+
+    return(nor_simulator_stats.lx_nor_flash_simulator_busy_ns);
+}
+
+
+#ifdef LX_NOR_ENABLE_CONTROL_BLOCK_FOR_DRIVER_INTERFACE
+UINT  _lx_nor_flash_simulator_read(LX_NOR_FLASH *nor_flash, ULONG *flash_address, ULONG *destination, ULONG words)
+#else
+UINT  _lx_nor_flash_simulator_read(ULONG *flash_address, ULONG *destination, ULONG words)
+#endif
+{
+
+#ifdef LX_NOR_ENABLE_CONTROL_BLOCK_FOR_DRIVER_INTERFACE
+    LX_PARAMETER_NOT_USED(nor_flash);
+#endif
+
+    /* Reject accesses outside of the part.  */
+    if (_lx_nor_flash_simulator_address_check(flash_address, words))
+        return(LX_ERROR);
+
+    /* One quad I/O fast read command per request, the data phase streams all the words.  */
+    LX_MEMCPY(destination, flash_address, words * sizeof(ULONG)); /* Use case of memcpy is verified. */
+
+    nor_simulator_stats.lx_nor_flash_simulator_read_commands++;
+    nor_simulator_stats.lx_nor_flash_simulator_bytes_read +=  words * sizeof(ULONG);
+    nor_simulator_stats.lx_nor_flash_simulator_busy_ns +=     nor_simulator_timing.lx_nor_flash_simulator_command_ns +
+                                                              (ULONG64) words * sizeof(ULONG) * nor_simulator_timing.lx_nor_flash_simulator_read_byte_ns;
+
+    return(LX_SUCCESS);
+}
+
+
+#ifdef LX_NOR_ENABLE_CONTROL_BLOCK_FOR_DRIVER_INTERFACE
+UINT  _lx_nor_flash_simulator_write(LX_NOR_FLASH *nor_flash, ULONG *flash_address, ULONG *source, ULONG words)
+#else
+UINT  _lx_nor_flash_simulator_write(ULONG *flash_address, ULONG *source, ULONG words)
+#endif
+{
+
+ULONG   offset;
+ULONG   end_offset;
+ULONG   chunk;
+UCHAR   *data;
+
+
+#ifdef LX_NOR_ENABLE_CONTROL_BLOCK_FOR_DRIVER_INTERFACE
+    LX_PARAMETER_NOT_USED(nor_flash);
+#endif
+
+    /* Reject accesses outside of the part.  */
+    if (_lx_nor_flash_simulator_address_check(flash_address, words))
+        return(LX_ERROR);
+
+    nor_simulator_stats.lx_nor_flash_simulator_write_requests++;
+
+    /* Split the request on page boundaries exactly like the QSPI driver does.  */
+    offset =      (ULONG) ((UCHAR *) flash_address - (UCHAR *) nor_simulator_memory);
+    end_offset =  offset + (ULONG) (words * sizeof(ULONG));
+    data =        (UCHAR *) source;
+    while (offset < end_offset)
+    {
+
+        chunk =  LX_NOR_SIMULATOR_PAGE_SIZE - (offset % LX_NOR_SIMULATOR_PAGE_SIZE);
+        if (chunk > (end_offset - offset))
+            chunk =  end_offset - offset;
+
+        _lx_nor_flash_simulator_page_program(offset, data, chunk);
+
+        offset +=  chunk;
+        data +=    chunk;
+    }
+
+    return(LX_SUCCESS);
+}
+
+
+#ifdef LX_NOR_ENABLE_CONTROL_BLOCK_FOR_DRIVER_INTERFACE
+UINT  _lx_nor_flash_simulator_block_erase(LX_NOR_FLASH *nor_flash, ULONG block, ULONG erase_count)
+#else
+UINT  _lx_nor_flash_simulator_block_erase(ULONG block, ULONG erase_count)
+#endif
+{
+
+ULONG   offset;
+ULONG   end_offset;
+
+
+#ifdef LX_NOR_ENABLE_CONTROL_BLOCK_FOR_DRIVER_INTERFACE
+    LX_PARAMETER_NOT_USED(nor_flash);
+#endif
+    LX_PARAMETER_NOT_USED(erase_count);
+
+    /* The blocks after the managed ones hold the checkpoint.  */
+    if (block >= (LX_NOR_SIMULATOR_FLASH_SIZE / nor_simulator_block_size))
+        return(LX_ERROR);
+
+    /* Erase the block with the largest erase units it is aligned to.  */
+    offset =      block * nor_simulator_block_size;
+    end_offset =  offset + nor_simulator_block_size;
+    while (offset < end_offset)
+    {
+
+        if (((offset % LX_NOR_SIMULATOR_SECTOR_SIZE) == 0) && ((end_offset - offset) >= LX_NOR_SIMULATOR_SECTOR_SIZE))
+        {
+            _lx_nor_flash_simulator_erase_unit(offset, LX_NOR_SIMULATOR_SECTOR_SIZE);
+            offset +=  LX_NOR_SIMULATOR_SECTOR_SIZE;
+        }
+        else
+        {
+            _lx_nor_flash_simulator_erase_unit(offset, LX_NOR_SIMULATOR_SUBSECTOR_SIZE);
+            offset +=  LX_NOR_SIMULATOR_SUBSECTOR_SIZE;
+        }
+    }
+
+    return(LX_SUCCESS);
+}
+
+
+#ifdef LX_NOR_ENABLE_CONTROL_BLOCK_FOR_DRIVER_INTERFACE
+UINT  _lx_nor_flash_simulator_block_erased_verify(LX_NOR_FLASH *nor_flash, ULONG block)
+#else
+UINT  _lx_nor_flash_simulator_block_erased_verify(ULONG block)
+#endif
+{
+
+ULONG   *word_ptr;
+ULONG   words;
+
+
+#ifdef LX_NOR_ENABLE_CONTROL_BLOCK_FOR_DRIVER_INTERFACE
+    LX_PARAMETER_NOT_USED(nor_flash);
+#endif
+
+    if (block >= (LX_NOR_SIMULATOR_FLASH_SIZE / nor_simulator_block_size))
+        return(LX_ERROR);
+
+    nor_simulator_stats.lx_nor_flash_simulator_erased_verifies++;
+
+    /* The driver reads the block back sector by sector, account for the same bus traffic.  */
+    nor_simulator_stats.lx_nor_flash_simulator_read_commands +=  nor_simulator_block_size / (LX_NOR_SECTOR_SIZE * sizeof(ULONG));
+    nor_simulator_stats.lx_nor_flash_simulator_bytes_read +=     nor_simulator_block_size;
+    nor_simulator_stats.lx_nor_flash_simulator_busy_ns +=        (ULONG64) (nor_simulator_block_size / (LX_NOR_SECTOR_SIZE * sizeof(ULONG))) * nor_simulator_timing.lx_nor_flash_simulator_command_ns +
+                                                                 (ULONG64) nor_simulator_block_size * nor_simulator_timing.lx_nor_flash_simulator_read_byte_ns;
+
+    /* Determine if the whole block reads back as all ones.  */
+    words =     nor_simulator_block_size / sizeof(ULONG);
+    word_ptr =  &nor_simulator_memory[block * words];
+    while (words--)
+    {
+
+        if (*word_ptr++ != LX_ALL_ONES)
+            return(LX_ERROR);
+    }
+
+    return(LX_SUCCESS);
+}
+
+
+#ifdef LX_NOR_ENABLE_CONTROL_BLOCK_FOR_DRIVER_INTERFACE
+UINT  _lx_nor_flash_simulator_system_error(LX_NOR_FLASH *nor_flash, UINT error_code)
+#else
+UINT  _lx_nor_flash_simulator_system_error(UINT error_code)
+#endif
+{
+
+#ifdef LX_NOR_ENABLE_CONTROL_BLOCK_FOR_DRIVER_INTERFACE
+    LX_PARAMETER_NOT_USED(nor_flash);
+#endif
+    LX_PARAMETER_NOT_USED(error_code);
+
+    /* Count the error, the caller inspects the counters instead of halting like the target driver.  */
+    nor_simulator_stats.lx_nor_flash_simulator_system_errors++;
+
+    return(LX_SUCCESS);
+}
+
+
+static UINT  _lx_nor_flash_simulator_address_check(ULONG *flash_address, ULONG words)
+{
+
+    if ((flash_address < &nor_simulator_memory[0]) ||
+        (flash_address + words > &nor_simulator_memory[LX_NOR_SIMULATOR_FLASH_SIZE / sizeof(ULONG)]))
+    {
+
+        nor_simulator_stats.lx_nor_flash_simulator_system_errors++;
+        return(LX_ERROR);
+    }
+
+    return(LX_SUCCESS);
+}
+
+
+static VOID  _lx_nor_flash_simulator_page_program(ULONG offset, UCHAR *source, ULONG size)
+{
+
+UCHAR   *memory;
+ULONG   page_start;
+ULONG   column;
+ULONG   i;
+
+
+    /* Like the real part, the column address wraps inside the 256-byte page buffer.  */
+    memory =      (UCHAR *) nor_simulator_memory;
+    page_start =  offset - (offset % LX_NOR_SIMULATOR_PAGE_SIZE);
+    column =      offset % LX_NOR_SIMULATOR_PAGE_SIZE;
+    for (i = 0; i < size; i++)
+    {
+
+        /* Programming can only clear bits. Record any attempt to set a cleared bit back to one.  */
+        if ((UCHAR) (source[i] & ~memory[page_start + column]) != 0)
+            nor_simulator_stats.lx_nor_flash_simulator_program_violations++;
+
+        memory[page_start + column] &=  source[i];
+        column =  (column + 1) % LX_NOR_SIMULATOR_PAGE_SIZE;
+    }
+
+    nor_simulator_stats.lx_nor_flash_simulator_page_programs++;
+    nor_simulator_stats.lx_nor_flash_simulator_bytes_programmed +=  size;
+    nor_simulator_stats.lx_nor_flash_simulator_busy_ns +=           nor_simulator_timing.lx_nor_flash_simulator_write_enable_ns +
+                                                                    nor_simulator_timing.lx_nor_flash_simulator_command_ns +
+                                                                    (ULONG64) size * nor_simulator_timing.lx_nor_flash_simulator_write_byte_ns +
+                                                                    nor_simulator_timing.lx_nor_flash_simulator_page_program_ns;
+}
+
+
+static VOID  _lx_nor_flash_simulator_erase_unit(ULONG offset, ULONG size)
+{
+
+    LX_MEMSET((UCHAR *) nor_simulator_memory + offset, 0xFF, size);
+
+    nor_simulator_stats.lx_nor_flash_simulator_busy_ns +=  nor_simulator_timing.lx_nor_flash_simulator_write_enable_ns +
+                                                           nor_simulator_timing.lx_nor_flash_simulator_command_ns;
+    if (size == LX_NOR_SIMULATOR_SECTOR_SIZE)
+    {
+        nor_simulator_stats.lx_nor_flash_simulator_sector_erases++;
+        nor_simulator_stats.lx_nor_flash_simulator_busy_ns +=  nor_simulator_timing.lx_nor_flash_simulator_sector_erase_ns;
+    }
+    else
+    {
+        nor_simulator_stats.lx_nor_flash_simulator_subsector_erases++;
+        nor_simulator_stats.lx_nor_flash_simulator_busy_ns +=  nor_simulator_timing.lx_nor_flash_simulator_subsector_erase_ns;
+    }
+}
@@ -32,6 +32,11 @@
     volumes).  Block buffers may be either dirty or clean.  Most I/O passes
     through this module.  When a buffer is needed for a block which is not in
     the cache, a "victim" is selected via a simple LRU scheme.
+
+    Buffers are looked up through a hash of the block number, and the LRU order
+    is kept in a doubly linked list threaded through the buffer heads, so the
+    cost of finding a block and of promoting a buffer does not grow with the
+    buffer count.
 */
 #include <redfs.h>
 #include <redcore.h>
@@ -44,13 +49,45 @@
 #error "REDCONF_BUFFER_COUNT cannot be greater than 255"
 #endif
 
-/*  This implementation does not support the write-gather buffer.
+/*  The write-gather buffer collects dirty buffers for consecutive blocks, so
+    that a flush writes them with one RedIoWrite() request.  Gathering a single
+    block would be pointless, so the buffer must hold at least two.
 */
-#if REDCONF_BUFFER_WRITE_GATHER_SIZE_KB != 0U
-  #error "Configuration error: REDCONF_BUFFER_WRITE_GATHER_SIZE_KB must be zero"
+#define WG_BLOCKS ((REDCONF_BUFFER_WRITE_GATHER_SIZE_KB * 1024U) / REDCONF_BLOCK_SIZE)
+
+#if (REDCONF_BUFFER_WRITE_GATHER_SIZE_KB != 0U) && (WG_BLOCKS < 2U)
+  #error "Configuration error: REDCONF_BUFFER_WRITE_GATHER_SIZE_KB must be large enough for two blocks"
 #endif
 
 
+/** @brief Number of hash buckets: the buffer count rounded up to a power of
+           two, with a minimum of 16.
+*/
+#if REDCONF_BUFFER_COUNT <= 16U
+#define BUFFER_HASH_BUCKETS 16U
+#elif REDCONF_BUFFER_COUNT <= 32U
+#define BUFFER_HASH_BUCKETS 32U
+#elif REDCONF_BUFFER_COUNT <= 64U
+#define BUFFER_HASH_BUCKETS 64U
+#elif REDCONF_BUFFER_COUNT <= 128U
+#define BUFFER_HASH_BUCKETS 128U
+#else
+#define BUFFER_HASH_BUCKETS 256U
+#endif
+
+
+/** @brief Hash bucket of a block.  Consecutive blocks land in consecutive
+           buckets.
+*/
+#define BUFFER_HASH(vol, blk) (((blk) ^ ((uint32_t)(vol) << 4U)) & (BUFFER_HASH_BUCKETS - 1U))
+
+
+/** @brief Buffer index which terminates the hash chains and the LRU list.
+           The buffer count is at most 255, so this is never a valid index.
+*/
+#define BIDX_NONE UINT8_MAX
+
+
 /** @brief Convert a buffer index into a block buffer pointer.
 */
 #define BIDX2BUF(idx) (&gBufCtx.pbBlkBuf[(uint32_t)(idx) << BLOCK_SIZE_P2])
@@ -67,6 +104,9 @@ typedef struct
     uint8_t     bVolNum;    /**< Volume the block resides on. */
     uint8_t     bRefCount;  /**< Number of references. */
     uint16_t    uFlags;     /**< Buffer flags: mask of BFLAG_* values. */
+    uint8_t     bHashNext;  /**< Next buffer in the same hash bucket; BIDX_NONE at the end of the chain. */
+    uint8_t     bMRUPrev;   /**< More recently used neighbor; BIDX_NONE for the MRU buffer. */
+    uint8_t     bMRUNext;   /**< Less recently used neighbor; BIDX_NONE for the LRU buffer. */
 } BUFFERHEAD;
 
 
@@ -78,13 +118,30 @@ typedef struct
     */
     uint16_t    uNumUsed;
 
-    /** MRU array.  Each element of the array stores a buffer index; each buffer
-        index appears in the array once and only once.  The first element of the
-        array is the most-recently-used (MRU) buffer, followed by the next most
-        recently used, and so on, till the last element, which is the least-
-        recently-used (LRU) buffer.
+    /** Index of the most-recently-used (MRU) buffer.  Every buffer is on the
+        list which starts here and continues through BUFFERHEAD::bMRUNext.
+    */
+    uint8_t     bMRUFirst;
+
+    /** Index of the least-recently-used (LRU) buffer, the end of the list.
     */
-    uint8_t     abMRU[REDCONF_BUFFER_COUNT];
+    uint8_t     bLRULast;
+
+    /** Hash buckets.  Each bucket is the index of the first buffer in a chain
+        linked through BUFFERHEAD::bHashNext; a buffer is on the chain for its
+        block if, and only if, its ulBlock is not BBLK_INVALID.
+    */
+    uint8_t     abHash[BUFFER_HASH_BUCKETS];
+
+    /** Lookup and I/O counters.
+    */
+    REDBUFFERSTATS stats;
+
+  #if WG_BLOCKS > 0U
+    /** Indices of the dirty buffers being flushed, sorted by block number.
+    */
+    uint8_t     abFlushIdx[REDCONF_BUFFER_COUNT];
+  #endif
 
     /** Buffer heads, storing metadata for each buffer.
     */
@@ -92,12 +149,13 @@ typedef struct
 
     /** Byte array used as the heap for the block buffers.
     */
-    uint8_t     abBlkHeap[(REDCONF_BUFFER_ALIGNMENT - 1U) + (REDCONF_BUFFER_COUNT * REDCONF_BLOCK_SIZE)];
+    uint8_t     abBlkHeap[(REDCONF_BUFFER_ALIGNMENT - 1U) + ((REDCONF_BUFFER_COUNT + WG_BLOCKS) * REDCONF_BLOCK_SIZE)];
 
     /** Pointer to the start of the block buffers.  This points into the
         abBlkHeap array, skipping over the initial bytes if necessary for the
         block buffers to be aligned.  Each block-sized chunk of this buffer
         is associated with the corresponding element in the aHead array.
+        The write-gather buffer, if enabled, follows the last block buffer.
     */
     uint8_t    *pbBlkBuf;
 } BUFFERCTX;
@@ -106,9 +164,16 @@ typedef struct
 static bool BufferToIdx(const void *pBuffer, uint8_t *pbIdx);
 #if REDCONF_READ_ONLY == 0
 static REDSTATUS BufferWrite(uint8_t bIdx);
+#if WG_BLOCKS > 0U
+static uint32_t BufferFlushSort(uint32_t ulBlockStart, uint32_t ulBlockCount);
+static REDSTATUS BufferWriteGather(const uint8_t *pbIdx, uint32_t ulCount);
+#endif
 #endif
 static void BufferMakeLRU(uint8_t bIdx);
 static void BufferMakeMRU(uint8_t bIdx);
+static void BufferUnlink(uint8_t bIdx);
+static void BufferHashInsert(uint8_t bIdx);
+static void BufferHashRemove(uint8_t bIdx);
 static bool BufferFind(uint32_t ulBlock, uint8_t *pbIdx);
 
 
@@ -122,14 +187,23 @@ void RedBufferInit(void)
     uint8_t bIdx;
 
     RedMemSet(&gBufCtx, 0U, sizeof(gBufCtx));
+    RedMemSet(gBufCtx.abHash, BIDX_NONE, sizeof(gBufCtx.abHash));
+
+    /*  When the buffers have been freshly initialized, acquire the buffers in
+        the order in which they appear in the array: the last buffer is MRU and
+        the first one is LRU.
+    */
+    gBufCtx.bMRUFirst = (uint8_t)(REDCONF_BUFFER_COUNT - 1U);
+    gBufCtx.bLRULast = 0U;
 
     for(bIdx = 0U; bIdx < REDCONF_BUFFER_COUNT; bIdx++)
     {
-        /*  When the buffers have been freshly initialized, acquire the buffers
-            in the order in which they appear in the array.
-        */
-        gBufCtx.abMRU[bIdx] = (uint8_t)((REDCONF_BUFFER_COUNT - bIdx) - 1U);
-        gBufCtx.aHead[bIdx].ulBlock = BBLK_INVALID;
+        BUFFERHEAD *pHead = &gBufCtx.aHead[bIdx];
+
+        pHead->ulBlock = BBLK_INVALID;
+        pHead->bHashNext = BIDX_NONE;
+        pHead->bMRUPrev = (bIdx == (REDCONF_BUFFER_COUNT - 1U)) ? BIDX_NONE : (uint8_t)(bIdx + 1U);
+        pHead->bMRUNext = (bIdx == 0U) ? BIDX_NONE : (uint8_t)(bIdx - 1U);
     }
 
     /*  Get an aligned pointer for the block buffers.
@@ -170,8 +244,12 @@ REDSTATUS RedBufferGet(
     }
     else
     {
+        gBufCtx.stats.ulLookups++;
+
         if(BufferFind(ulBlock, &bIdx))
         {
+            gBufCtx.stats.ulHits++;
+
             /*  Error if the buffer exists and BFLAG_NEW was specified, since
                 the new flag is used when a block is newly allocated/created, so
                 the block was previously free and and there should never be an
@@ -197,23 +275,23 @@ REDSTATUS RedBufferGet(
         }
         else
         {
-            BUFFERHEAD *pHead;
+            BUFFERHEAD *pHead = NULL;
 
             /*  Search for the least recently used buffer which is not
-                referenced.
+                referenced, walking from the LRU end of the list.  At most
+                MINIMUM_BUFFER_COUNT buffers are referenced at a time, so this
+                stops after a few steps no matter how many buffers there are.
             */
-            for(bIdx = (uint8_t)(REDCONF_BUFFER_COUNT - 1U); bIdx > 0U; bIdx--)
+            for(bIdx = gBufCtx.bLRULast; bIdx != BIDX_NONE; bIdx = gBufCtx.aHead[bIdx].bMRUPrev)
             {
-                if(gBufCtx.aHead[gBufCtx.abMRU[bIdx]].bRefCount == 0U)
+                if(gBufCtx.aHead[bIdx].bRefCount == 0U)
                 {
+                    pHead = &gBufCtx.aHead[bIdx];
                     break;
                 }
             }
 
-            bIdx = gBufCtx.abMRU[bIdx];
-            pHead = &gBufCtx.aHead[bIdx];
-
-            if(pHead->bRefCount == 0U)
+            if(pHead != NULL)
             {
                 /*  If the LRU buffer is valid and dirty, write it out before
                     repurposing it.
@@ -241,6 +319,11 @@ REDSTATUS RedBufferGet(
             {
                 uint8_t *pbBuffer = BIDX2BUF(bIdx);
 
+                /*  The buffer is about to hold another block, so it must no
+                    longer be found under the old one.
+                */
+                BufferHashRemove(bIdx);
+
                 if((uFlags & BFLAG_NEW) == 0U)
                 {
                     /*  Invalidate the LRU buffer.  If the read fails, we do not
@@ -255,6 +338,7 @@ REDSTATUS RedBufferGet(
                     pHead->ulBlock = BBLK_INVALID;
 
                     ret = RedIoRead(gbRedVolNum, ulBlock, 1U, pbBuffer);
+                    gBufCtx.stats.ulReads++;
 
                     if((ret == 0) && ((uFlags & BFLAG_META) != 0U))
                     {
@@ -289,6 +373,8 @@ REDSTATUS RedBufferGet(
                 pHead->bVolNum = gbRedVolNum;
                 pHead->ulBlock = ulBlock;
                 pHead->uFlags = 0U;
+
+                BufferHashInsert(bIdx);
             }
         }
 
@@ -377,6 +463,50 @@ REDSTATUS RedBufferFlushRange(
         REDERROR();
         ret = -RED_EINVAL;
     }
+  #if WG_BLOCKS > 0U
+    else
+    {
+        uint32_t ulDirty = BufferFlushSort(ulBlockStart, ulBlockCount);
+        uint32_t ulPos = 0U;
+
+        /*  Write the dirty buffers in block order, each run of consecutive
+            blocks (up to the size of the write-gather buffer) with one request.
+        */
+        while((ret == 0) && (ulPos < ulDirty))
+        {
+            const uint8_t  *pbRun = &gBufCtx.abFlushIdx[ulPos];
+            uint32_t        ulFirstBlock = gBufCtx.aHead[pbRun[0U]].ulBlock;
+            uint32_t        ulRun = 1U;
+            uint32_t        ulIdx;
+
+            while(    ((ulPos + ulRun) < ulDirty)
+                   && (ulRun < WG_BLOCKS)
+                   && (gBufCtx.aHead[pbRun[ulRun]].ulBlock == (ulFirstBlock + ulRun)))
+            {
+                ulRun++;
+            }
+
+            if(ulRun == 1U)
+            {
+                ret = BufferWrite(pbRun[0U]);
+            }
+            else
+            {
+                ret = BufferWriteGather(pbRun, ulRun);
+            }
+
+            if(ret == 0)
+            {
+                for(ulIdx = 0U; ulIdx < ulRun; ulIdx++)
+                {
+                    gBufCtx.aHead[pbRun[ulIdx]].uFlags &= (~BFLAG_DIRTY);
+                }
+
+                ulPos += ulRun;
+            }
+        }
+    }
+  #else
     else
     {
         uint8_t bIdx;
@@ -404,6 +534,7 @@ REDSTATUS RedBufferFlushRange(
             }
         }
     }
+  #endif
 
     return ret;
 }
@@ -454,8 +585,12 @@ void RedBufferBranch(
         REDASSERT(pHead->bRefCount > 0U);
         REDASSERT((pHead->uFlags & BFLAG_DIRTY) == 0U);
 
+        BufferHashRemove(bIdx);
+
         pHead->uFlags |= BFLAG_DIRTY;
         pHead->ulBlock = ulBlockNew;
+
+        BufferHashInsert(bIdx);
     }
 }
 
@@ -479,6 +614,8 @@ void RedBufferDiscard(
         REDASSERT(gBufCtx.aHead[bIdx].bRefCount == 1U);
         REDASSERT(gBufCtx.uNumUsed > 0U);
 
+        BufferHashRemove(bIdx);
+
         gBufCtx.aHead[bIdx].bRefCount = 0U;
         gBufCtx.aHead[bIdx].ulBlock = BBLK_INVALID;
 
@@ -531,6 +668,8 @@ REDSTATUS RedBufferDiscardRange(
             {
                 if(pHead->bRefCount == 0U)
                 {
+                    BufferHashRemove(bIdx);
+
                     pHead->ulBlock = BBLK_INVALID;
 
                     BufferMakeLRU(bIdx);
@@ -663,6 +802,24 @@ REDSTATUS RedBufferWriteRange(
 #endif
 
 
+/** @brief Get the block buffer statistics.
+
+    @param pStats   Populated with the counters.
+*/
+void RedBufferStatsGet(
+    REDBUFFERSTATS *pStats)
+{
+    if(pStats == NULL)
+    {
+        REDERROR();
+    }
+    else
+    {
+        *pStats = gBufCtx.stats;
+    }
+}
+
+
 /** @brief Derive the index of the buffer.
 
     @param pBuffer  The buffer to derive the index of.
@@ -735,6 +892,7 @@ static REDSTATUS BufferWrite(
         if(ret == 0)
         {
             ret = RedIoWrite(pHead->bVolNum, pHead->ulBlock, 1U, pbBuffer);
+            gBufCtx.stats.ulWrites++;
 
           #ifdef REDCONF_ENDIAN_SWAP
             RedBufferEndianSwap(pbBuffer, pHead->uFlags);
@@ -749,49 +907,150 @@ static REDSTATUS BufferWrite(
 
     return ret;
 }
-#endif /* REDCONF_READ_ONLY == 0 */
 
 
-/** @brief Mark a buffer as least recently used.
+#if WG_BLOCKS > 0U
+/** @brief List the dirty buffers in a range of blocks, sorted by block number.
 
-    @param bIdx The index of the buffer to make LRU.
+    @param ulBlockStart Starting block number.
+    @param ulBlockCount Count of blocks, starting at @p ulBlockStart.
+
+    @return The number of dirty buffers stored in BUFFERCTX::abFlushIdx.
 */
-static void BufferMakeLRU(
-    uint8_t bIdx)
+static uint32_t BufferFlushSort(
+    uint32_t    ulBlockStart,
+    uint32_t    ulBlockCount)
 {
-    if(bIdx >= REDCONF_BUFFER_COUNT)
+    uint32_t    ulDirty = 0U;
+    uint8_t     bIdx;
+
+    for(bIdx = 0U; bIdx < REDCONF_BUFFER_COUNT; bIdx++)
+    {
+        const BUFFERHEAD *pHead = &gBufCtx.aHead[bIdx];
+
+        if(    (pHead->bVolNum == gbRedVolNum)
+            && (pHead->ulBlock != BBLK_INVALID)
+            && ((pHead->uFlags & BFLAG_DIRTY) != 0U)
+            && (pHead->ulBlock >= ulBlockStart)
+            && (pHead->ulBlock < (ulBlockStart + ulBlockCount)))
+        {
+            uint32_t ulPos = ulDirty;
+
+            /*  Insertion sort: there are few dirty buffers, and they are often
+                already in block order.
+            */
+            while((ulPos > 0U) && (gBufCtx.aHead[gBufCtx.abFlushIdx[ulPos - 1U]].ulBlock > pHead->ulBlock))
+            {
+                gBufCtx.abFlushIdx[ulPos] = gBufCtx.abFlushIdx[ulPos - 1U];
+                ulPos--;
+            }
+
+            gBufCtx.abFlushIdx[ulPos] = bIdx;
+            ulDirty++;
+        }
+    }
+
+    return ulDirty;
+}
+
+
+/** @brief Write out dirty buffers for consecutive blocks with one request.
+
+    The buffers are finalized and copied into the write-gather buffer, which is
+    then written to disk.
+
+    @param pbIdx    Indices of the buffers, in block order.  The buffer for
+                    the first block comes first and the block numbers must be
+                    consecutive.
+    @param ulCount  Number of buffers; at most WG_BLOCKS.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EIO    A disk I/O error occurred.
+    @retval -RED_EINVAL Invalid parameters.
+*/
+static REDSTATUS BufferWriteGather(
+    const uint8_t  *pbIdx,
+    uint32_t        ulCount)
+{
+    REDSTATUS       ret = 0;
+
+    if((pbIdx == NULL) || (ulCount == 0U) || (ulCount > WG_BLOCKS))
     {
         REDERROR();
+        ret = -RED_EINVAL;
     }
-    else if(bIdx != gBufCtx.abMRU[REDCONF_BUFFER_COUNT - 1U])
+    else
     {
-        uint8_t bMruIdx;
+        uint8_t    *pbGather = &gBufCtx.pbBlkBuf[REDCONF_BUFFER_COUNT << BLOCK_SIZE_P2];
+        uint32_t    ulIdx;
 
-        /*  Find the current position of the buffer in the MRU array.  We do not
-            need to check the last slot, since we already know from the above
-            check that the index is not there.
-        */
-        for(bMruIdx = 0U; bMruIdx < (REDCONF_BUFFER_COUNT - 1U); bMruIdx++)
+        for(ulIdx = 0U; ulIdx < ulCount; ulIdx++)
         {
-            if(bIdx == gBufCtx.abMRU[bMruIdx])
+            const BUFFERHEAD   *pHead = &gBufCtx.aHead[pbIdx[ulIdx]];
+            uint8_t            *pbBuffer = BIDX2BUF(pbIdx[ulIdx]);
+
+            REDASSERT((pHead->uFlags & BFLAG_DIRTY) != 0U);
+            REDASSERT(pHead->ulBlock == (gBufCtx.aHead[pbIdx[0U]].ulBlock + ulIdx));
+
+            if((pHead->uFlags & BFLAG_META) != 0U)
+            {
+                ret = RedBufferFinalize(pbBuffer, pHead->bVolNum, pHead->uFlags);
+            }
+
+            if(ret != 0)
             {
                 break;
             }
-        }
 
-        if(bMruIdx < (REDCONF_BUFFER_COUNT - 1U))
-        {
-            /*  Move the buffer index to the back of the MRU array, making it
-                the LRU buffer.
-            */
-            RedMemMove(&gBufCtx.abMRU[bMruIdx], &gBufCtx.abMRU[bMruIdx + 1U], REDCONF_BUFFER_COUNT - ((uint32_t)bMruIdx + 1U));
-            gBufCtx.abMRU[REDCONF_BUFFER_COUNT - 1U] = bIdx;
+            RedMemCpy(&pbGather[ulIdx << BLOCK_SIZE_P2], pbBuffer, REDCONF_BLOCK_SIZE);
+
+          #ifdef REDCONF_ENDIAN_SWAP
+            RedBufferEndianSwap(pbBuffer, pHead->uFlags);
+          #endif
         }
-        else
+
+        if(ret == 0)
         {
-            REDERROR();
+            const BUFFERHEAD *pHead = &gBufCtx.aHead[pbIdx[0U]];
+
+            ret = RedIoWrite(pHead->bVolNum, pHead->ulBlock, ulCount, pbGather);
+            gBufCtx.stats.ulWrites += ulCount;
+            gBufCtx.stats.ulGatherWrites++;
         }
     }
+
+    return ret;
+}
+#endif /* WG_BLOCKS > 0U */
+#endif /* REDCONF_READ_ONLY == 0 */
+
+
+/** @brief Mark a buffer as least recently used.
+
+    @param bIdx The index of the buffer to make LRU.
+*/
+static void BufferMakeLRU(
+    uint8_t bIdx)
+{
+    if(bIdx >= REDCONF_BUFFER_COUNT)
+    {
+        REDERROR();
+    }
+    else if(bIdx != gBufCtx.bLRULast)
+    {
+        BUFFERHEAD *pHead = &gBufCtx.aHead[bIdx];
+
+        BufferUnlink(bIdx);
+
+        /*  Append the buffer to the LRU end of the list.
+        */
+        pHead->bMRUPrev = gBufCtx.bLRULast;
+        pHead->bMRUNext = BIDX_NONE;
+        gBufCtx.aHead[gBufCtx.bLRULast].bMRUNext = bIdx;
+        gBufCtx.bLRULast = bIdx;
+    }
     else
     {
         /*  Buffer already LRU, nothing to do.
@@ -811,40 +1070,110 @@ static void BufferMakeMRU(
     {
         REDERROR();
     }
-    else if(bIdx != gBufCtx.abMRU[0U])
+    else if(bIdx != gBufCtx.bMRUFirst)
     {
-        uint8_t bMruIdx;
+        BUFFERHEAD *pHead = &gBufCtx.aHead[bIdx];
+
+        BufferUnlink(bIdx);
 
-        /*  Find the current position of the buffer in the MRU array.  We do not
-            need to check the first slot, since we already know from the above
-            check that the index is not there.
+        /*  Insert the buffer at the MRU end of the list.
         */
-        for(bMruIdx = 1U; bMruIdx < REDCONF_BUFFER_COUNT; bMruIdx++)
+        pHead->bMRUPrev = BIDX_NONE;
+        pHead->bMRUNext = gBufCtx.bMRUFirst;
+        gBufCtx.aHead[gBufCtx.bMRUFirst].bMRUPrev = bIdx;
+        gBufCtx.bMRUFirst = bIdx;
+    }
+    else
+    {
+        /*  Buffer already MRU, nothing to do.
+        */
+    }
+}
+
+
+/** @brief Remove a buffer from the LRU list.
+
+    The caller must relink the buffer at one end of the list.  There are always
+    several buffers, so the list never becomes empty in between.
+
+    @param bIdx The index of the buffer to unlink.
+*/
+static void BufferUnlink(
+    uint8_t     bIdx)
+{
+    const BUFFERHEAD *pHead = &gBufCtx.aHead[bIdx];
+
+    if(pHead->bMRUPrev == BIDX_NONE)
+    {
+        REDASSERT(gBufCtx.bMRUFirst == bIdx);
+        gBufCtx.bMRUFirst = pHead->bMRUNext;
+    }
+    else
+    {
+        gBufCtx.aHead[pHead->bMRUPrev].bMRUNext = pHead->bMRUNext;
+    }
+
+    if(pHead->bMRUNext == BIDX_NONE)
+    {
+        REDASSERT(gBufCtx.bLRULast == bIdx);
+        gBufCtx.bLRULast = pHead->bMRUPrev;
+    }
+    else
+    {
+        gBufCtx.aHead[pHead->bMRUNext].bMRUPrev = pHead->bMRUPrev;
+    }
+}
+
+
+/** @brief Add a buffer to the hash chain of its block.
+
+    @param bIdx The index of the buffer, which must hold a valid block.
+*/
+static void BufferHashInsert(
+    uint8_t     bIdx)
+{
+    BUFFERHEAD *pHead = &gBufCtx.aHead[bIdx];
+    uint32_t    ulBucket;
+
+    REDASSERT(pHead->ulBlock != BBLK_INVALID);
+
+    ulBucket = BUFFER_HASH(pHead->bVolNum, pHead->ulBlock);
+    pHead->bHashNext = gBufCtx.abHash[ulBucket];
+    gBufCtx.abHash[ulBucket] = bIdx;
+}
+
+
+/** @brief Remove a buffer from the hash chain of its block.
+
+    Buffers which do not hold a valid block are not on any chain, in which case
+    this function does nothing.
+
+    @param bIdx The index of the buffer.
+*/
+static void BufferHashRemove(
+    uint8_t     bIdx)
+{
+    BUFFERHEAD *pHead = &gBufCtx.aHead[bIdx];
+
+    if(pHead->ulBlock != BBLK_INVALID)
+    {
+        uint8_t *pbLink = &gBufCtx.abHash[BUFFER_HASH(pHead->bVolNum, pHead->ulBlock)];
+
+        while((*pbLink != bIdx) && (*pbLink != BIDX_NONE))
         {
-            if(bIdx == gBufCtx.abMRU[bMruIdx])
-            {
-                break;
-            }
+            pbLink = &gBufCtx.aHead[*pbLink].bHashNext;
         }
 
-        if(bMruIdx < REDCONF_BUFFER_COUNT)
+        if(*pbLink == bIdx)
         {
-            /*  Move the buffer index to the front of the MRU array, making it
-                the MRU buffer.
-            */
-            RedMemMove(&gBufCtx.abMRU[1U], &gBufCtx.abMRU[0U], bMruIdx);
-            gBufCtx.abMRU[0U] = bIdx;
+            *pbLink = pHead->bHashNext;
+            pHead->bHashNext = BIDX_NONE;
         }
         else
         {
             REDERROR();
         }
     }
-    else
-    {
-        /*  Buffer already MRU, nothing to do.
-        */
-    }
 }
 
 
@@ -874,7 +1203,7 @@ static bool BufferFind(
     {
         uint8_t bIdx;
 
-        for(bIdx = 0U; bIdx < REDCONF_BUFFER_COUNT; bIdx++)
+        for(bIdx = gBufCtx.abHash[BUFFER_HASH(gbRedVolNum, ulBlock)]; bIdx != BIDX_NONE; bIdx = gBufCtx.aHead[bIdx].bHashNext)
         {
             const BUFFERHEAD *pHead = &gBufCtx.aHead[bIdx];
 
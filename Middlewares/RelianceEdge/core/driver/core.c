@@ -364,6 +364,10 @@ REDSTATUS RedCoreVolUnmount(void)
     if(ret == 0)
     {
         gpRedVolume->fMounted = false;
+
+      #if REDCONF_API_POSIX == 1
+        RedDcachePurge();
+      #endif
     }
 
     return ret;
@@ -705,6 +709,10 @@ REDSTATUS RedCoreCreate(
     }
     else
     {
+        /*  Whatever the outcome, the cached lookup of the name is stale.
+        */
+        RedDcacheRemove(ulPInode, pszName);
+
         ret = CoreCreate(ulPInode, pszName, uMode, pulInode);
 
         if(ret == -RED_ENOSPC)
@@ -719,6 +727,8 @@ REDSTATUS RedCoreCreate(
 
         if(ret == 0)
         {
+            RedDcacheInsert(ulPInode, pszName, *pulInode);
+
             ret = CoreAutoTransact(RED_S_ISDIR(uMode) ? RED_TRANSACT_MKDIR : RED_TRANSACT_CREAT);
         }
     }
@@ -883,6 +893,10 @@ REDSTATUS RedCoreLink(
     }
     else
     {
+        /*  Whatever the outcome, the cached lookup of the name is stale.
+        */
+        RedDcacheRemove(ulPInode, pszName);
+
         ret = CoreLink(ulPInode, pszName, ulInode);
 
         if(ret == -RED_ENOSPC)
@@ -897,6 +911,8 @@ REDSTATUS RedCoreLink(
 
         if(ret == 0)
         {
+            RedDcacheInsert(ulPInode, pszName, ulInode);
+
             ret = CoreAutoTransact(RED_TRANSACT_LINK);
         }
     }
@@ -1071,6 +1087,10 @@ REDSTATUS RedCoreUnlink(
     }
     else
     {
+        /*  Whatever the outcome, the cached lookup of the name is stale.
+        */
+        RedDcacheRemove(ulPInode, pszName);
+
         ret = CoreUnlink(ulPInode, pszName, fOrphan);
 
         if(ret == -RED_ENOSPC)
@@ -1085,6 +1105,8 @@ REDSTATUS RedCoreUnlink(
 
         if(ret == 0)
         {
+            RedDcacheInsert(ulPInode, pszName, INODE_INVALID);
+
             ret = CoreAutoTransact(RED_TRANSACT_UNLINK);
         }
     }
@@ -1358,16 +1380,37 @@ REDSTATUS RedCoreLookup(
     }
     else
     {
-        CINODE ino;
+        if(RedDcacheLookup(ulPInode, pszName, pulInode))
+        {
+            ret = (*pulInode == INODE_INVALID) ? -RED_ENOENT : 0;
+        }
+        else
+        {
+            CINODE ino;
 
-        ino.ulInode = ulPInode;
-        ret = RedInodeMount(&ino, FTYPE_DIR, false);
+            ino.ulInode = ulPInode;
+            ret = RedInodeMount(&ino, FTYPE_DIR, false);
 
-        if(ret == 0)
-        {
-            ret = RedDirEntryLookup(&ino, pszName, NULL, pulInode);
+            if(ret == 0)
+            {
+                ret = RedDirEntryLookup(&ino, pszName, NULL, pulInode);
 
-            RedInodePut(&ino, 0U);
+                RedInodePut(&ino, 0U);
+            }
+
+            if(ret == 0)
+            {
+                RedDcacheInsert(ulPInode, pszName, *pulInode);
+            }
+            else if(ret == -RED_ENOENT)
+            {
+                RedDcacheInsert(ulPInode, pszName, INODE_INVALID);
+            }
+            else
+            {
+                /*  Other errors are not cached.
+                */
+            }
         }
     }
 
@@ -1460,6 +1503,11 @@ REDSTATUS RedCoreRename(
     }
     else
     {
+        /*  Whatever the outcome, the cached lookups of both names are stale.
+        */
+        RedDcacheRemove(ulSrcPInode, pszSrcName);
+        RedDcacheRemove(ulDstPInode, pszDstName);
+
         ret = CoreRename(ulSrcPInode, pszSrcName, ulDstPInode, pszDstName, fOrphan);
 
         if(ret == -RED_ENOSPC)
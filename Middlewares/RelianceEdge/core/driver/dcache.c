@@ -0,0 +1,593 @@
+/*             ----> DO NOT REMOVE THE FOLLOWING NOTICE <----
+
+                  Copyright (c) 2014-2024 Tuxera US Inc.
+                      All Rights Reserved Worldwide.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; use version 2 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but "AS-IS," WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+/*  Businesses and individuals that for commercial or other reasons cannot
+    comply with the terms of the GPLv2 license must obtain a commercial
+    license before incorporating Reliance Edge into proprietary software
+    for distribution in any form.
+
+    Visit https://www.tuxera.com/products/reliance-edge/ for more information.
+*/
+/** @file
+    @brief Implements the directory entry lookup cache.
+
+    This module remembers the result of recent RedCoreLookup() calls: for a
+    (volume, parent directory, name) it holds either the inode the name points
+    at or the fact that the name does not exist (a negative entry).  Walking a
+    path which was recently walked thus neither mounts the parent directory
+    inodes nor reads their entries.
+
+    The cache is kept coherent by the core: every operation which adds, removes
+    or renames a name updates or drops its entry, a freed directory drops the
+    entries below it, and mount and rollback drop everything the volume had.
+    Entries are found through a hash of the parent inode and the name, and the
+    least recently used entry is replaced when the cache is full.
+*/
+#include <redfs.h>
+
+#if REDCONF_API_POSIX == 1
+
+#include <redcore.h>
+
+
+/*  Number of cached lookups; zero disables the cache.
+*/
+#ifndef REDCONF_DCACHE_ENTRIES
+#define REDCONF_DCACHE_ENTRIES 0U
+#endif
+
+#if REDCONF_DCACHE_ENTRIES > 0U
+
+#if REDCONF_DCACHE_ENTRIES > 255U
+#error "Configuration error: REDCONF_DCACHE_ENTRIES cannot be greater than 255"
+#endif
+
+/*  A cache hit skips RedDirEntryLookup() and with it the search permission
+    check of the parent directory.
+*/
+#if REDCONF_POSIX_OWNER_PERM == 1
+#error "Configuration error: REDCONF_DCACHE_ENTRIES must be 0 when REDCONF_POSIX_OWNER_PERM is enabled"
+#endif
+
+
+/** @brief Number of hash buckets: the entry count rounded up to a power of
+           two, with a minimum of 16.
+*/
+#if REDCONF_DCACHE_ENTRIES <= 16U
+#define DCACHE_BUCKETS 16U
+#elif REDCONF_DCACHE_ENTRIES <= 32U
+#define DCACHE_BUCKETS 32U
+#elif REDCONF_DCACHE_ENTRIES <= 64U
+#define DCACHE_BUCKETS 64U
+#elif REDCONF_DCACHE_ENTRIES <= 128U
+#define DCACHE_BUCKETS 128U
+#else
+#define DCACHE_BUCKETS 256U
+#endif
+
+/** @brief Entry index value meaning "no entry".
+*/
+#define DIDX_NONE UINT8_MAX
+
+
+/** @brief A cached lookup.
+*/
+typedef struct
+{
+    uint32_t    ulPInode;   /**< Parent directory; INODE_INVALID if the entry is unused. */
+    uint32_t    ulInode;    /**< Inode the name points at; INODE_INVALID if the name does not exist. */
+    uint32_t    ulHash;     /**< Hash of ulPInode and the name. */
+    uint8_t     bVolNum;    /**< Volume of the parent directory. */
+    uint8_t     bNameLen;   /**< Length of acName. */
+    uint8_t     bHashNext;  /**< Next entry in the same hash bucket. */
+    uint8_t     bMRUPrev;   /**< More recently used neighbor; DIDX_NONE for the MRU entry. */
+    uint8_t     bMRUNext;   /**< Less recently used neighbor; DIDX_NONE for the LRU entry. */
+    char        acName[REDCONF_NAME_MAX]; /**< The name, not null terminated. */
+} DCENTRY;
+
+
+/** @brief State of the lookup cache.
+*/
+typedef struct
+{
+    bool            fInited;
+    uint8_t         bMRUFirst;
+    uint8_t         bLRULast;
+    uint8_t         abHash[DCACHE_BUCKETS];
+    DCENTRY         aEntry[REDCONF_DCACHE_ENTRIES];
+    REDDCACHESTATS  stats;
+} DCACHECTX;
+
+
+static void DcacheInit(void);
+static uint32_t DcacheHash(uint32_t ulPInode, const char *pszName, uint32_t ulNameLen);
+static uint8_t DcacheFind(uint32_t ulPInode, const char *pszName, uint32_t ulNameLen, uint32_t ulHash);
+static void DcacheDrop(uint8_t bIdx);
+static void DcacheUnlink(uint8_t bIdx);
+static void DcacheMakeMRU(uint8_t bIdx);
+static void DcacheMakeLRU(uint8_t bIdx);
+
+
+static DCACHECTX gDcache;
+
+
+/** @brief Look up a name in the cache.
+
+    @param ulPInode The inode number of the parent directory.
+    @param pszName  The name, terminated by a null or a path separator.
+    @param pulInode On a hit, populated with the inode number the name points
+                    at, or INODE_INVALID if the name is known not to exist.
+
+    @return Whether the lookup was found in the cache.
+*/
+bool RedDcacheLookup(
+    uint32_t    ulPInode,
+    const char *pszName,
+    uint32_t   *pulInode)
+{
+    bool        fHit = false;
+    uint32_t    ulNameLen = RedNameLen(pszName);
+
+    if(!gDcache.fInited)
+    {
+        DcacheInit();
+    }
+
+    gDcache.stats.ulLookups++;
+
+    if((ulNameLen > 0U) && (ulNameLen <= REDCONF_NAME_MAX))
+    {
+        uint8_t bIdx = DcacheFind(ulPInode, pszName, ulNameLen, DcacheHash(ulPInode, pszName, ulNameLen));
+
+        if(bIdx != DIDX_NONE)
+        {
+            *pulInode = gDcache.aEntry[bIdx].ulInode;
+            DcacheMakeMRU(bIdx);
+
+            gDcache.stats.ulHits++;
+            if(*pulInode == INODE_INVALID)
+            {
+                gDcache.stats.ulNegativeHits++;
+            }
+
+            fHit = true;
+        }
+    }
+
+    return fHit;
+}
+
+
+/** @brief Record the result of a lookup.
+
+    @param ulPInode The inode number of the parent directory.
+    @param pszName  The name, terminated by a null or a path separator.
+    @param ulInode  The inode number the name points at, or INODE_INVALID if
+                    the name does not exist.
+*/
+void RedDcacheInsert(
+    uint32_t    ulPInode,
+    const char *pszName,
+    uint32_t    ulInode)
+{
+    uint32_t    ulNameLen = RedNameLen(pszName);
+
+    if(!gDcache.fInited)
+    {
+        DcacheInit();
+    }
+
+    if((ulNameLen > 0U) && (ulNameLen <= REDCONF_NAME_MAX))
+    {
+        uint32_t    ulHash = DcacheHash(ulPInode, pszName, ulNameLen);
+        uint8_t     bIdx = DcacheFind(ulPInode, pszName, ulNameLen, ulHash);
+
+        if(bIdx == DIDX_NONE)
+        {
+            DCENTRY    *pEntry;
+            uint32_t    ulBucket = ulHash & (DCACHE_BUCKETS - 1U);
+
+            /*  Replace the least recently used entry.  Unused entries are kept
+                at the LRU end, so they are taken first.
+            */
+            bIdx = gDcache.bLRULast;
+            DcacheDrop(bIdx);
+
+            pEntry = &gDcache.aEntry[bIdx];
+            pEntry->ulPInode = ulPInode;
+            pEntry->ulHash = ulHash;
+            pEntry->bVolNum = gbRedVolNum;
+            pEntry->bNameLen = (uint8_t)ulNameLen;
+            RedMemCpy(pEntry->acName, pszName, ulNameLen);
+
+            pEntry->bHashNext = gDcache.abHash[ulBucket];
+            gDcache.abHash[ulBucket] = bIdx;
+        }
+
+        gDcache.aEntry[bIdx].ulInode = ulInode;
+        DcacheMakeMRU(bIdx);
+    }
+}
+
+
+/** @brief Forget a name.
+
+    @param ulPInode The inode number of the parent directory.
+    @param pszName  The name, terminated by a null or a path separator.
+*/
+void RedDcacheRemove(
+    uint32_t    ulPInode,
+    const char *pszName)
+{
+    uint32_t    ulNameLen = RedNameLen(pszName);
+
+    if(gDcache.fInited && (ulNameLen > 0U) && (ulNameLen <= REDCONF_NAME_MAX))
+    {
+        uint8_t bIdx = DcacheFind(ulPInode, pszName, ulNameLen, DcacheHash(ulPInode, pszName, ulNameLen));
+
+        if(bIdx != DIDX_NONE)
+        {
+            DcacheDrop(bIdx);
+            DcacheMakeLRU(bIdx);
+        }
+    }
+}
+
+
+/** @brief Forget every name below a directory of the current volume.
+
+    Called when the directory inode is freed, since the inode number may be
+    reused for an inode of another type.
+
+    @param ulDirInode   The directory inode number.
+*/
+void RedDcachePurgeDir(
+    uint32_t    ulDirInode)
+{
+    if(gDcache.fInited)
+    {
+        uint8_t bIdx;
+
+        for(bIdx = 0U; bIdx < REDCONF_DCACHE_ENTRIES; bIdx++)
+        {
+            const DCENTRY *pEntry = &gDcache.aEntry[bIdx];
+
+            if((pEntry->ulPInode == ulDirInode) && (pEntry->bVolNum == gbRedVolNum))
+            {
+                DcacheDrop(bIdx);
+                DcacheMakeLRU(bIdx);
+            }
+        }
+    }
+}
+
+
+/** @brief Forget every name of the current volume.
+
+    Must be called whenever the names of the volume may have changed behind the
+    cache, i.e. when the volume is mounted, unmounted or rolled back.
+*/
+void RedDcachePurge(void)
+{
+    if(gDcache.fInited)
+    {
+        uint8_t bIdx;
+
+        for(bIdx = 0U; bIdx < REDCONF_DCACHE_ENTRIES; bIdx++)
+        {
+            const DCENTRY *pEntry = &gDcache.aEntry[bIdx];
+
+            if((pEntry->ulPInode != INODE_INVALID) && (pEntry->bVolNum == gbRedVolNum))
+            {
+                DcacheDrop(bIdx);
+                DcacheMakeLRU(bIdx);
+            }
+        }
+    }
+}
+
+
+/** @brief Get the lookup cache statistics.
+
+    @param pStats   Populated with the counters, which are cumulative over all
+                    volumes.
+*/
+void RedDcacheStatsGet(
+    REDDCACHESTATS *pStats)
+{
+    if(pStats != NULL)
+    {
+        *pStats = gDcache.stats;
+    }
+}
+
+
+/** @brief Empty the lookup cache.
+*/
+static void DcacheInit(void)
+{
+    uint8_t bIdx;
+
+    RedMemSet(gDcache.abHash, DIDX_NONE, sizeof(gDcache.abHash));
+
+    for(bIdx = 0U; bIdx < REDCONF_DCACHE_ENTRIES; bIdx++)
+    {
+        DCENTRY *pEntry = &gDcache.aEntry[bIdx];
+
+        pEntry->ulPInode = INODE_INVALID;
+        pEntry->bHashNext = DIDX_NONE;
+        pEntry->bMRUPrev = (bIdx == 0U) ? DIDX_NONE : (uint8_t)(bIdx - 1U);
+        pEntry->bMRUNext = (bIdx == (REDCONF_DCACHE_ENTRIES - 1U)) ? DIDX_NONE : (uint8_t)(bIdx + 1U);
+    }
+
+    gDcache.bMRUFirst = 0U;
+    gDcache.bLRULast = (uint8_t)(REDCONF_DCACHE_ENTRIES - 1U);
+    gDcache.fInited = true;
+}
+
+
+/** @brief Hash a parent inode and a name (FNV-1a).
+
+    @param ulPInode     The inode number of the parent directory.
+    @param pszName      The name; need not be null terminated.
+    @param ulNameLen    The length of @p pszName.
+
+    @return The hash.
+*/
+static uint32_t DcacheHash(
+    uint32_t    ulPInode,
+    const char *pszName,
+    uint32_t    ulNameLen)
+{
+    uint32_t    ulHash = 2166136261U ^ ulPInode;
+    uint32_t    ulIdx;
+
+    for(ulIdx = 0U; ulIdx < ulNameLen; ulIdx++)
+    {
+        ulHash ^= (uint8_t)pszName[ulIdx];
+        ulHash *= 16777619U;
+    }
+
+    return ulHash;
+}
+
+
+/** @brief Find the entry of a name of the current volume.
+
+    @param ulPInode     The inode number of the parent directory.
+    @param pszName      The name; need not be null terminated.
+    @param ulNameLen    The length of @p pszName.
+    @param ulHash       DcacheHash() of the parent inode and the name.
+
+    @return The index of the entry, or DIDX_NONE if the name is not cached.
+*/
+static uint8_t DcacheFind(
+    uint32_t    ulPInode,
+    const char *pszName,
+    uint32_t    ulNameLen,
+    uint32_t    ulHash)
+{
+    uint8_t     bIdx = gDcache.abHash[ulHash & (DCACHE_BUCKETS - 1U)];
+
+    while(bIdx != DIDX_NONE)
+    {
+        const DCENTRY *pEntry = &gDcache.aEntry[bIdx];
+
+        if(    (pEntry->ulHash == ulHash)
+            && (pEntry->ulPInode == ulPInode)
+            && (pEntry->bVolNum == gbRedVolNum)
+            && (pEntry->bNameLen == ulNameLen)
+            && (RedMemCmp(pEntry->acName, pszName, ulNameLen) == 0))
+        {
+            break;
+        }
+
+        bIdx = pEntry->bHashNext;
+    }
+
+    return bIdx;
+}
+
+
+/** @brief Take an entry out of its hash bucket and mark it unused.
+
+    @param bIdx The entry index.  Nothing happens if it is already unused.
+*/
+static void DcacheDrop(
+    uint8_t     bIdx)
+{
+    DCENTRY    *pEntry = &gDcache.aEntry[bIdx];
+
+    if(pEntry->ulPInode != INODE_INVALID)
+    {
+        uint8_t *pbLink = &gDcache.abHash[pEntry->ulHash & (DCACHE_BUCKETS - 1U)];
+
+        while(*pbLink != bIdx)
+        {
+            REDASSERT(*pbLink != DIDX_NONE);
+            pbLink = &gDcache.aEntry[*pbLink].bHashNext;
+        }
+
+        *pbLink = pEntry->bHashNext;
+        pEntry->bHashNext = DIDX_NONE;
+        pEntry->ulPInode = INODE_INVALID;
+    }
+}
+
+
+/** @brief Take an entry out of the MRU list.
+
+    @param bIdx The entry index.
+*/
+static void DcacheUnlink(
+    uint8_t     bIdx)
+{
+    DCENTRY    *pEntry = &gDcache.aEntry[bIdx];
+
+    if(pEntry->bMRUPrev == DIDX_NONE)
+    {
+        gDcache.bMRUFirst = pEntry->bMRUNext;
+    }
+    else
+    {
+        gDcache.aEntry[pEntry->bMRUPrev].bMRUNext = pEntry->bMRUNext;
+    }
+
+    if(pEntry->bMRUNext == DIDX_NONE)
+    {
+        gDcache.bLRULast = pEntry->bMRUPrev;
+    }
+    else
+    {
+        gDcache.aEntry[pEntry->bMRUNext].bMRUPrev = pEntry->bMRUPrev;
+    }
+}
+
+
+/** @brief Mark an entry as the most recently used.
+
+    @param bIdx The entry index.
+*/
+static void DcacheMakeMRU(
+    uint8_t     bIdx)
+{
+    if(gDcache.bMRUFirst != bIdx)
+    {
+        DCENTRY *pEntry = &gDcache.aEntry[bIdx];
+
+        DcacheUnlink(bIdx);
+
+        pEntry->bMRUPrev = DIDX_NONE;
+        pEntry->bMRUNext = gDcache.bMRUFirst;
+        gDcache.aEntry[gDcache.bMRUFirst].bMRUPrev = bIdx;
+        gDcache.bMRUFirst = bIdx;
+    }
+}
+
+
+/** @brief Mark an entry as the least recently used, so that it is the next
+           one to be replaced.
+
+    @param bIdx The entry index.
+*/
+static void DcacheMakeLRU(
+    uint8_t     bIdx)
+{
+    if(gDcache.bLRULast != bIdx)
+    {
+        DCENTRY *pEntry = &gDcache.aEntry[bIdx];
+
+        DcacheUnlink(bIdx);
+
+        pEntry->bMRUNext = DIDX_NONE;
+        pEntry->bMRUPrev = gDcache.bLRULast;
+        gDcache.aEntry[gDcache.bLRULast].bMRUNext = bIdx;
+        gDcache.bLRULast = bIdx;
+    }
+}
+
+#else /* REDCONF_DCACHE_ENTRIES > 0U */
+
+/** @brief Look up a name in the cache.
+
+    The cache is disabled, so this always misses.
+
+    @param ulPInode The inode number of the parent directory.
+    @param pszName  The name.
+    @param pulInode Unused.
+
+    @return false.
+*/
+bool RedDcacheLookup(
+    uint32_t    ulPInode,
+    const char *pszName,
+    uint32_t   *pulInode)
+{
+    (void)ulPInode;
+    (void)pszName;
+    (void)pulInode;
+
+    return false;
+}
+
+
+/** @brief Record the result of a lookup; the cache is disabled.
+
+    @param ulPInode The inode number of the parent directory.
+    @param pszName  The name.
+    @param ulInode  The inode number the name points at.
+*/
+void RedDcacheInsert(
+    uint32_t    ulPInode,
+    const char *pszName,
+    uint32_t    ulInode)
+{
+    (void)ulPInode;
+    (void)pszName;
+    (void)ulInode;
+}
+
+
+/** @brief Forget a name; the cache is disabled.
+
+    @param ulPInode The inode number of the parent directory.
+    @param pszName  The name.
+*/
+void RedDcacheRemove(
+    uint32_t    ulPInode,
+    const char *pszName)
+{
+    (void)ulPInode;
+    (void)pszName;
+}
+
+
+/** @brief Forget every name below a directory; the cache is disabled.
+
+    @param ulDirInode   The directory inode number.
+*/
+void RedDcachePurgeDir(
+    uint32_t    ulDirInode)
+{
+    (void)ulDirInode;
+}
+
+
+/** @brief Forget every name of the current volume; the cache is disabled.
+*/
+void RedDcachePurge(void)
+{
+}
+
+
+/** @brief Get the lookup cache statistics.
+
+    @param pStats   Populated with zeros: the cache is disabled.
+*/
+void RedDcacheStatsGet(
+    REDDCACHESTATS *pStats)
+{
+    if(pStats != NULL)
+    {
+        RedMemSet(pStats, 0U, sizeof(*pStats));
+    }
+}
+
+#endif /* REDCONF_DCACHE_ENTRIES > 0U */
+
+#endif /* REDCONF_API_POSIX == 1 */
@@ -74,6 +74,79 @@ typedef struct
 } DIRENT;
 
 
+/*  The directory index keeps, for a few recently searched directories, the
+    hash of every name and the position of its dirent, so that a lookup reads
+    only the dirents whose name hash matches instead of the whole directory.
+    REDCONF_DIR_INDEX_ENTRIES is the budget for the names of all indexed
+    directories together; zero disables the index.  A directory is indexed
+    only if all its dirents fit in the budget, so a position always fits in 16
+    bits, and 16 bits of the name hash are kept: an entry takes 8 bytes and
+    the buckets 1 more per name.
+*/
+#ifndef REDCONF_DIR_INDEX_ENTRIES
+#define REDCONF_DIR_INDEX_ENTRIES 0U
+#endif
+#ifndef REDCONF_DIR_INDEX_DIRS
+#define REDCONF_DIR_INDEX_DIRS 4U
+#endif
+
+#define DIRIDX_ENABLED (REDCONF_DIR_INDEX_ENTRIES > 0U)
+
+#if DIRIDX_ENABLED
+
+#if REDCONF_DIR_INDEX_ENTRIES >= 65535U
+#error "Configuration error: REDCONF_DIR_INDEX_ENTRIES must be less than 65535"
+#endif
+#if (REDCONF_DIR_INDEX_DIRS == 0U) || (REDCONF_DIR_INDEX_DIRS >= 255U)
+#error "Configuration error: REDCONF_DIR_INDEX_DIRS must be between 1 and 254"
+#endif
+
+#define DIRIDX_ENTRY_NONE   UINT16_MAX
+#define DIRIDX_DIR_NONE     UINT8_MAX
+#define DIRIDX_BUCKETS      REDMAX(REDCONF_DIR_INDEX_ENTRIES / 2U, 1U)
+#define DIRIDX_BUCKET(dir, hash) (((hash) ^ ((uint32_t)(dir) * 0x9E3779B1U)) % DIRIDX_BUCKETS)
+#define DIRIDX_TAG(hash)    ((uint16_t)((hash) >> 16U))
+
+
+/** @brief A name in the directory index.
+*/
+typedef struct
+{
+    uint16_t    uTag;       /**< Upper half of the name hash, see DIRIDX_TAG(). */
+    uint16_t    uIdx;       /**< Position of the dirent in the directory. */
+    uint16_t    uNext;      /**< Next entry in the bucket or in the free list. */
+    uint8_t     bDir;       /**< Index of the DIRIDXDIR the entry belongs to. */
+} DIRIDXENTRY;
+
+
+/** @brief An indexed directory.
+*/
+typedef struct
+{
+    uint32_t    ulInode;    /**< Directory inode; INODE_INVALID if the slot is unused. */
+    uint32_t    ulStamp;    /**< Use stamp, the least recently used directory is evicted. */
+    uint32_t    ulHoles;    /**< Number of unused dirents below the end of the directory. */
+    uint32_t    ulFreeHint; /**< There is no unused dirent below this position. */
+    uint8_t     bVolNum;    /**< Volume of the directory. */
+    bool        fIndexed;   /**< False if the directory did not fit in the budget. */
+} DIRIDXDIR;
+
+
+/** @brief State of the directory index.
+*/
+typedef struct
+{
+    bool        fInited;
+    uint16_t    uFree;
+    uint32_t    ulStamp;
+    uint16_t    auBucket[DIRIDX_BUCKETS];
+    DIRIDXDIR   aDir[REDCONF_DIR_INDEX_DIRS];
+    DIRIDXENTRY aEntry[REDCONF_DIR_INDEX_ENTRIES];
+} DIRIDXCTX;
+
+#endif /* DIRIDX_ENABLED */
+
+
 #if (REDCONF_READ_ONLY == 0) && (REDCONF_API_POSIX_RENAME == 1)
 static REDSTATUS DirCyclicRenameCheck(uint32_t ulSrcInode, const CINODE *pDstPInode);
 #endif
@@ -82,6 +155,28 @@ static REDSTATUS DirEntryWrite(CINODE *pPInode, uint32_t ulIdx, uint32_t ulInode
 static uint64_t DirEntryIndexToOffset(uint32_t ulIdx);
 #endif
 static uint32_t DirOffsetToEntryIndex(uint64_t ullOffset);
+static REDSTATUS DirEntryScan(CINODE *pPInode, const char *pszName, uint32_t ulNameLen, uint32_t *pulEntryIdx, uint32_t *pulInode);
+static bool DirEntryNameMatch(const DIRENT *pDirent, const char *pszName, uint32_t ulNameLen);
+#if DIRIDX_ENABLED
+static uint32_t DirEntryNameLen(const DIRENT *pDirent);
+static void DirIdxInit(void);
+static uint32_t DirIdxHash(const char *pszName, uint32_t ulNameLen);
+static uint8_t DirIdxFind(uint32_t ulInode);
+static REDSTATUS DirIdxGet(CINODE *pPInode, uint8_t *pbDir);
+static REDSTATUS DirIdxBuild(CINODE *pPInode, uint8_t bDir);
+static REDSTATUS DirIdxLookup(CINODE *pPInode, uint8_t bDir, const char *pszName, uint32_t ulNameLen, uint32_t *pulEntryIdx, uint32_t *pulInode);
+static bool DirIdxInsert(uint8_t bDir, uint32_t ulHash, uint32_t ulIdx);
+static void DirIdxRemove(uint8_t bDir, uint32_t ulHash, uint32_t ulIdx);
+static bool DirIdxEvict(uint8_t bKeep);
+static void DirIdxDrop(uint8_t bDir);
+static REDSTATUS DirIdxFreeEntry(CINODE *pPInode, uint8_t bDir, uint32_t *pulIdx);
+#if REDCONF_READ_ONLY == 0
+static void DirIdxEntryAdded(const CINODE *pPInode, uint32_t ulIdx, const char *pszName, uint32_t ulNameLen, bool fWasUnused);
+#endif
+
+
+static DIRIDXCTX gDirIdx;
+#endif
 
 
 #if REDCONF_READ_ONLY == 0
@@ -184,7 +279,22 @@ REDSTATUS RedDirEntryCreate(
 
             if(ret == 0)
             {
+              #if DIRIDX_ENABLED
+                bool fWasUnused = ulEntryIdx < DirOffsetToEntryIndex(pPInode->pInodeBuf->ullSize);
+              #endif
+
                 ret = DirEntryWrite(pPInode, ulEntryIdx, ulInode, pszName, ulNameLen);
+
+              #if DIRIDX_ENABLED
+                if(ret == 0)
+                {
+                    DirIdxEntryAdded(pPInode, ulEntryIdx, pszName, ulNameLen, fWasUnused);
+                }
+                else
+                {
+                    RedDirIndexInvalidate(pPInode->ulInode);
+                }
+              #endif
             }
         }
     }
@@ -231,6 +341,12 @@ REDSTATUS RedDirEntryDelete(
 {
     REDSTATUS   ret = 0;
     uint64_t    ullIdxOffset = DirEntryIndexToOffset(ulDeleteIdx);
+  #if DIRIDX_ENABLED
+    uint8_t     bDir = DIRIDX_DIR_NONE;
+    uint32_t    ulHash = 0U;
+    uint32_t    ulOldCount = 0U;
+    bool        fWasUsed = false;
+  #endif
 
     if(!CINODE_IS_DIRTY(pPInode))
     {
@@ -258,6 +374,47 @@ REDSTATUS RedDirEntryDelete(
       #endif
     }
 
+  #if DIRIDX_ENABLED
+    /*  The index is keyed by name, so get the hash of the name being deleted
+        while the dirent still holds it.
+    */
+    if(ret == 0)
+    {
+        bDir = DirIdxFind(pPInode->ulInode);
+
+        if((bDir != DIRIDX_DIR_NONE) && !gDirIdx.aDir[bDir].fIndexed)
+        {
+            bDir = DIRIDX_DIR_NONE;
+        }
+
+        if(bDir != DIRIDX_DIR_NONE)
+        {
+            ulOldCount = DirOffsetToEntryIndex(pPInode->pInodeBuf->ullSize);
+
+            ret = RedInodeDataSeekAndRead(pPInode, ulDeleteIdx / DIRENTS_PER_BLOCK);
+            if(ret == 0)
+            {
+                const DIRENT *pDirent = &DIRENT_PTR(pPInode->pbData)[ulDeleteIdx % DIRENTS_PER_BLOCK];
+
+                if(pDirent->ulInode != INODE_INVALID)
+                {
+                    ulHash = DirIdxHash(pDirent->acName, DirEntryNameLen(pDirent));
+                    fWasUsed = true;
+                }
+            }
+            else if(ret == -RED_ENODATA)
+            {
+                ret = 0;
+            }
+            else
+            {
+                /*  Unexpected error, no action.
+                */
+            }
+        }
+    }
+  #endif
+
     if(ret == 0)
     {
         if((ullIdxOffset + DIRENT_SIZE) == pPInode->pInodeBuf->ullSize)
@@ -354,6 +511,35 @@ REDSTATUS RedDirEntryDelete(
         }
     }
 
+  #if DIRIDX_ENABLED
+    if(bDir != DIRIDX_DIR_NONE)
+    {
+        if(ret == 0)
+        {
+            DIRIDXDIR  *pDir = &gDirIdx.aDir[bDir];
+            uint32_t    ulNewCount = DirOffsetToEntryIndex(pPInode->pInodeBuf->ullSize);
+
+            if(fWasUsed)
+            {
+                DirIdxRemove(bDir, ulHash, ulDeleteIdx);
+                pDir->ulHoles++;
+                pDir->ulFreeHint = REDMIN(pDir->ulFreeHint, ulDeleteIdx);
+            }
+
+            /*  If the directory was truncated, the unused dirents at its end
+                are gone.
+            */
+            REDASSERT(pDir->ulHoles >= (ulOldCount - ulNewCount));
+            pDir->ulHoles -= ulOldCount - ulNewCount;
+            pDir->ulFreeHint = REDMIN(pDir->ulFreeHint, ulNewCount);
+        }
+        else
+        {
+            RedDirIndexInvalidate(pPInode->ulInode);
+        }
+    }
+  #endif
+
     return ret;
 }
 #endif /* DELETE_SUPPORTED */
@@ -433,121 +619,24 @@ REDSTATUS RedDirEntryLookup(
         }
         else
         {
-            uint32_t    ulIdx = 0U;
-            uint32_t    ulDirentCount = DirOffsetToEntryIndex(pPInode->pInodeBuf->ullSize);
-            uint32_t    ulFreeIdx = DIR_INDEX_INVALID;  /* Index of first free dirent. */
-
-            /*  Loop over the directory blocks, searching each block for a
-                dirent that matches the given name.
-            */
-            while((ret == 0) && (ulIdx < ulDirentCount))
-            {
-                ret = RedInodeDataSeekAndRead(pPInode, ulIdx / DIRENTS_PER_BLOCK);
-
-                if(ret == 0)
-                {
-                    const DIRENT *pDirents = DIRENT_PTR(pPInode->pbData);
-                    uint32_t      ulBlockLastIdx = REDMIN(DIRENTS_PER_BLOCK, ulDirentCount - ulIdx);
-                    uint32_t      ulBlockIdx;
-
-                    for(ulBlockIdx = 0U; ulBlockIdx < ulBlockLastIdx; ulBlockIdx++)
-                    {
-                        const DIRENT *pDirent = &pDirents[ulBlockIdx];
-
-                        if(pDirent->ulInode != INODE_INVALID)
-                        {
-                            /*  The name in the dirent will not be null
-                                terminated if it is of the maximum length, so
-                                use a bounded string compare and then make sure
-                                there is nothing more to the name.
-                            */
-                            if(    (RedStrNCmp(pDirent->acName, pszName, ulNameLen) == 0)
-                                && ((ulNameLen == REDCONF_NAME_MAX) || (pDirent->acName[ulNameLen] == '\0')))
-                            {
-                                /*  Found a matching dirent, stop and return its
-                                    information.
-                                */
-                                if(pulInode != NULL)
-                                {
-                                    *pulInode = pDirent->ulInode;
-
-                                  #ifdef REDCONF_ENDIAN_SWAP
-                                    *pulInode = RedRev32(*pulInode);
-                                  #endif
-                                }
-
-                                ulIdx += ulBlockIdx;
-                                break;
-                            }
-                        }
-                        else if(ulFreeIdx == DIR_INDEX_INVALID)
-                        {
-                            ulFreeIdx = ulIdx + ulBlockIdx;
-                        }
-                        else
-                        {
-                            /*  The directory entry is free, but we already found a free one, so there's
-                                nothing to do here.
-                            */
-                        }
-                    }
-
-                    if(ulBlockIdx < ulBlockLastIdx)
-                    {
-                        /*  If we broke out of the for loop, we found a matching
-                            dirent and can stop the search.
-                        */
-                        break;
-                    }
-
-                    ulIdx += ulBlockLastIdx;
-                }
-                else if(ret == -RED_ENODATA)
-                {
-                    if(ulFreeIdx == DIR_INDEX_INVALID)
-                    {
-                        ulFreeIdx = ulIdx;
-                    }
-
-                    ret = 0;
-                    ulIdx += DIRENTS_PER_BLOCK;
-                }
-                else
-                {
-                    /*  Unexpected error, let the loop terminate, no action
-                        here.
-                    */
-                }
-            }
+          #if DIRIDX_ENABLED
+            uint8_t bDir;
 
+            ret = DirIdxGet(pPInode, &bDir);
             if(ret == 0)
             {
-                /*  If we made it all the way to the end of the directory
-                    without stopping, then the given name does not exist in the
-                    directory.
-                */
-                if(ulIdx == ulDirentCount)
+                if(bDir != DIRIDX_DIR_NONE)
                 {
-                    /*  If the directory had no sparse dirents, then the first
-                        free dirent is beyond the end of the directory.  If the
-                        directory is already the maximum size, then there is no
-                        free dirent.
-                    */
-                    if((ulFreeIdx == DIR_INDEX_INVALID) && (ulDirentCount < DIRENTS_MAX))
-                    {
-                        ulFreeIdx = ulDirentCount;
-                    }
-
-                    ulIdx = ulFreeIdx;
-
-                    ret = -RED_ENOENT;
+                    ret = DirIdxLookup(pPInode, bDir, pszName, ulNameLen, pulEntryIdx, pulInode);
                 }
-
-                if(pulEntryIdx != NULL)
+                else
                 {
-                    *pulEntryIdx = ulIdx;
+                    ret = DirEntryScan(pPInode, pszName, ulNameLen, pulEntryIdx, pulInode);
                 }
             }
+          #else
+            ret = DirEntryScan(pPInode, pszName, ulNameLen, pulEntryIdx, pulInode);
+          #endif
         }
     }
 
@@ -868,7 +957,23 @@ REDSTATUS RedDirEntryRename(
 
             if(ret == 0)
             {
+              #if DIRIDX_ENABLED
+                bool fWasUnused = ulDstIdx < DirOffsetToEntryIndex(pDstPInode->pInodeBuf->ullSize);
+              #endif
+
                 ret = DirEntryWrite(pDstPInode, ulDstIdx, pSrcInode->ulInode, pszDstName, ulDstNameLen);
+
+              #if DIRIDX_ENABLED
+                if(ret == 0)
+                {
+                  #if REDCONF_RENAME_ATOMIC == 1
+                    if(pDstInode->ulInode == INODE_INVALID)
+                  #endif
+                    {
+                        DirIdxEntryAdded(pDstPInode, ulDstIdx, pszDstName, ulDstNameLen, fWasUnused);
+                    }
+                }
+              #endif
             }
 
             if(ret == 0)
@@ -907,6 +1012,16 @@ REDSTATUS RedDirEntryRename(
             {
                 pSrcInode->pInodeBuf->ulPInode = pDstPInode->ulInode;
             }
+
+          #if DIRIDX_ENABLED
+            /*  A failed rename may have left either directory half updated.
+            */
+            if(ret != 0)
+            {
+                RedDirIndexInvalidate(pSrcPInode->ulInode);
+                RedDirIndexInvalidate(pDstPInode->ulInode);
+            }
+          #endif
         }
     }
 
@@ -1132,4 +1247,905 @@ static uint32_t DirOffsetToEntryIndex(
 }
 
 
+/** @brief Search a directory for a name by reading every dirent.
+
+    @param pPInode      A pointer to the cached inode structure of the directory
+                        to search.
+    @param pszName      The name of the desired entry.
+    @param ulNameLen    The length of @p pszName.
+    @param pulEntryIdx  On successful return, if non-NULL, populated with the
+                        index of the entry.  On -RED_ENOENT return, populated
+                        with the index of the first free dirent, or
+                        DIR_INDEX_INVALID if the directory is full.
+    @param pulInode     On successful return, if non-NULL, populated with the
+                        inode number that the name points to.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EIO    A disk I/O error occurred.
+    @retval -RED_ENOENT @p pszName does not name an existing entry.
+*/
+static REDSTATUS DirEntryScan(
+    CINODE     *pPInode,
+    const char *pszName,
+    uint32_t    ulNameLen,
+    uint32_t   *pulEntryIdx,
+    uint32_t   *pulInode)
+{
+    REDSTATUS   ret = 0;
+    uint32_t    ulIdx = 0U;
+    uint32_t    ulDirentCount = DirOffsetToEntryIndex(pPInode->pInodeBuf->ullSize);
+    uint32_t    ulFreeIdx = DIR_INDEX_INVALID;  /* Index of first free dirent. */
+
+    /*  Loop over the directory blocks, searching each block for a dirent that
+        matches the given name.
+    */
+    while((ret == 0) && (ulIdx < ulDirentCount))
+    {
+        ret = RedInodeDataSeekAndRead(pPInode, ulIdx / DIRENTS_PER_BLOCK);
+
+        if(ret == 0)
+        {
+            const DIRENT *pDirents = DIRENT_PTR(pPInode->pbData);
+            uint32_t      ulBlockLastIdx = REDMIN(DIRENTS_PER_BLOCK, ulDirentCount - ulIdx);
+            uint32_t      ulBlockIdx;
+
+            for(ulBlockIdx = 0U; ulBlockIdx < ulBlockLastIdx; ulBlockIdx++)
+            {
+                const DIRENT *pDirent = &pDirents[ulBlockIdx];
+
+                if(pDirent->ulInode != INODE_INVALID)
+                {
+                    if(DirEntryNameMatch(pDirent, pszName, ulNameLen))
+                    {
+                        /*  Found a matching dirent, stop and return its
+                            information.
+                        */
+                        if(pulInode != NULL)
+                        {
+                            *pulInode = pDirent->ulInode;
+
+                          #ifdef REDCONF_ENDIAN_SWAP
+                            *pulInode = RedRev32(*pulInode);
+                          #endif
+                        }
+
+                        ulIdx += ulBlockIdx;
+                        break;
+                    }
+                }
+                else if(ulFreeIdx == DIR_INDEX_INVALID)
+                {
+                    ulFreeIdx = ulIdx + ulBlockIdx;
+                }
+                else
+                {
+                    /*  The directory entry is free, but we already found a free one, so there's
+                        nothing to do here.
+                    */
+                }
+            }
+
+            if(ulBlockIdx < ulBlockLastIdx)
+            {
+                /*  If we broke out of the for loop, we found a matching dirent
+                    and can stop the search.
+                */
+                break;
+            }
+
+            ulIdx += ulBlockLastIdx;
+        }
+        else if(ret == -RED_ENODATA)
+        {
+            if(ulFreeIdx == DIR_INDEX_INVALID)
+            {
+                ulFreeIdx = ulIdx;
+            }
+
+            ret = 0;
+            ulIdx += DIRENTS_PER_BLOCK;
+        }
+        else
+        {
+            /*  Unexpected error, let the loop terminate, no action here.
+            */
+        }
+    }
+
+    if(ret == 0)
+    {
+        /*  If we made it all the way to the end of the directory without
+            stopping, then the given name does not exist in the directory.
+        */
+        if(ulIdx == ulDirentCount)
+        {
+            /*  If the directory had no sparse dirents, then the first free
+                dirent is beyond the end of the directory.  If the directory is
+                already the maximum size, then there is no free dirent.
+            */
+            if((ulFreeIdx == DIR_INDEX_INVALID) && (ulDirentCount < DIRENTS_MAX))
+            {
+                ulFreeIdx = ulDirentCount;
+            }
+
+            ulIdx = ulFreeIdx;
+
+            ret = -RED_ENOENT;
+        }
+
+        if(pulEntryIdx != NULL)
+        {
+            *pulEntryIdx = ulIdx;
+        }
+    }
+
+    return ret;
+}
+
+
+/** @brief Determine whether a dirent holds the given name.
+
+    @param pDirent      The dirent to check.
+    @param pszName      The name to compare against.
+    @param ulNameLen    The length of @p pszName.
+
+    @return Whether the name in @p pDirent is @p pszName.
+*/
+static bool DirEntryNameMatch(
+    const DIRENT   *pDirent,
+    const char     *pszName,
+    uint32_t        ulNameLen)
+{
+    /*  The name in the dirent will not be null terminated if it is of the
+        maximum length, so use a bounded string compare and then make sure
+        there is nothing more to the name.
+    */
+    return (RedStrNCmp(pDirent->acName, pszName, ulNameLen) == 0)
+        && ((ulNameLen == REDCONF_NAME_MAX) || (pDirent->acName[ulNameLen] == '\0'));
+}
+
+
+#if DIRIDX_ENABLED
+/** @brief Length of the name in a dirent.
+
+    @param pDirent  The dirent, which must be in use.
+
+    @return The length of the name, at most #REDCONF_NAME_MAX.
+*/
+static uint32_t DirEntryNameLen(
+    const DIRENT   *pDirent)
+{
+    uint32_t        ulLen = 0U;
+
+    while((ulLen < REDCONF_NAME_MAX) && (pDirent->acName[ulLen] != '\0'))
+    {
+        ulLen++;
+    }
+
+    return ulLen;
+}
+
+
+/** @brief Forget the directories of the current volume.
+
+    Must be called whenever directory contents may have changed behind the
+    index, i.e. when the volume is mounted or rolled back.
+*/
+void RedDirIndexReset(void)
+{
+    if(!gDirIdx.fInited)
+    {
+        DirIdxInit();
+    }
+    else
+    {
+        uint8_t bDir;
+
+        for(bDir = 0U; bDir < REDCONF_DIR_INDEX_DIRS; bDir++)
+        {
+            if((gDirIdx.aDir[bDir].ulInode != INODE_INVALID) && (gDirIdx.aDir[bDir].bVolNum == gbRedVolNum))
+            {
+                DirIdxDrop(bDir);
+            }
+        }
+    }
+}
+
+
+/** @brief Forget a directory of the current volume.
+
+    @param ulDirInode   The directory inode.  Nothing happens if it is not
+                        indexed.
+*/
+void RedDirIndexInvalidate(
+    uint32_t    ulDirInode)
+{
+    uint8_t     bDir = DirIdxFind(ulDirInode);
+
+    if(bDir != DIRIDX_DIR_NONE)
+    {
+        DirIdxDrop(bDir);
+    }
+}
+
+
+/** @brief Empty the directory index.
+*/
+static void DirIdxInit(void)
+{
+    uint32_t ulIdx;
+
+    for(ulIdx = 0U; ulIdx < DIRIDX_BUCKETS; ulIdx++)
+    {
+        gDirIdx.auBucket[ulIdx] = DIRIDX_ENTRY_NONE;
+    }
+
+    for(ulIdx = 0U; ulIdx < REDCONF_DIR_INDEX_DIRS; ulIdx++)
+    {
+        gDirIdx.aDir[ulIdx].ulInode = INODE_INVALID;
+        gDirIdx.aDir[ulIdx].fIndexed = false;
+    }
+
+    for(ulIdx = 0U; ulIdx < REDCONF_DIR_INDEX_ENTRIES; ulIdx++)
+    {
+        gDirIdx.aEntry[ulIdx].bDir = DIRIDX_DIR_NONE;
+        gDirIdx.aEntry[ulIdx].uNext = (uint16_t)(ulIdx + 1U);
+    }
+    gDirIdx.aEntry[REDCONF_DIR_INDEX_ENTRIES - 1U].uNext = DIRIDX_ENTRY_NONE;
+
+    gDirIdx.uFree = 0U;
+    gDirIdx.ulStamp = 0U;
+    gDirIdx.fInited = true;
+}
+
+
+/** @brief Hash a name (FNV-1a).
+
+    @param pszName      The name; need not be null terminated.
+    @param ulNameLen    The length of @p pszName.
+
+    @return The hash of the name.
+*/
+static uint32_t DirIdxHash(
+    const char *pszName,
+    uint32_t    ulNameLen)
+{
+    uint32_t    ulHash = 2166136261U;
+    uint32_t    ulIdx;
+
+    for(ulIdx = 0U; ulIdx < ulNameLen; ulIdx++)
+    {
+        ulHash ^= (uint8_t)pszName[ulIdx];
+        ulHash *= 16777619U;
+    }
+
+    return ulHash;
+}
+
+
+/** @brief Find the index slot of a directory of the current volume.
+
+    @param ulInode  The directory inode.
+
+    @return The slot of the directory, or DIRIDX_DIR_NONE if the directory
+            has none.
+*/
+static uint8_t DirIdxFind(
+    uint32_t    ulInode)
+{
+    uint8_t     bDir = DIRIDX_DIR_NONE;
+
+    if(gDirIdx.fInited && (ulInode != INODE_INVALID))
+    {
+        uint8_t bIdx;
+
+        for(bIdx = 0U; bIdx < REDCONF_DIR_INDEX_DIRS; bIdx++)
+        {
+            if((gDirIdx.aDir[bIdx].ulInode == ulInode) && (gDirIdx.aDir[bIdx].bVolNum == gbRedVolNum))
+            {
+                bDir = bIdx;
+                break;
+            }
+        }
+    }
+
+    return bDir;
+}
+
+
+/** @brief Get the index of a directory, building it if needed.
+
+    @param pPInode  A pointer to the cached inode structure of the directory.
+    @param pbDir    On successful return, populated with the slot of the
+                    directory, or DIRIDX_DIR_NONE if the directory does not fit
+                    in the index and must be searched without it.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EIO    A disk I/O error occurred.
+*/
+static REDSTATUS DirIdxGet(
+    CINODE     *pPInode,
+    uint8_t    *pbDir)
+{
+    REDSTATUS   ret = 0;
+    uint8_t     bDir;
+
+    if(!gDirIdx.fInited)
+    {
+        DirIdxInit();
+    }
+
+    bDir = DirIdxFind(pPInode->ulInode);
+
+    if(bDir == DIRIDX_DIR_NONE)
+    {
+        uint8_t bIdx;
+
+        /*  Take a free slot, or else the least recently used one.
+        */
+        bDir = 0U;
+        for(bIdx = 0U; bIdx < REDCONF_DIR_INDEX_DIRS; bIdx++)
+        {
+            if(gDirIdx.aDir[bIdx].ulInode == INODE_INVALID)
+            {
+                bDir = bIdx;
+                break;
+            }
+
+            if((gDirIdx.ulStamp - gDirIdx.aDir[bIdx].ulStamp) > (gDirIdx.ulStamp - gDirIdx.aDir[bDir].ulStamp))
+            {
+                bDir = bIdx;
+            }
+        }
+
+        if(gDirIdx.aDir[bDir].ulInode != INODE_INVALID)
+        {
+            DirIdxDrop(bDir);
+        }
+
+        ret = DirIdxBuild(pPInode, bDir);
+        if(ret != 0)
+        {
+            DirIdxDrop(bDir);
+        }
+    }
+
+    if(ret == 0)
+    {
+        gDirIdx.ulStamp++;
+        gDirIdx.aDir[bDir].ulStamp = gDirIdx.ulStamp;
+
+        *pbDir = gDirIdx.aDir[bDir].fIndexed ? bDir : DIRIDX_DIR_NONE;
+    }
+
+    return ret;
+}
+
+
+/** @brief Index every name of a directory.
+
+    If the names do not fit in the index, even after evicting the other
+    directories, the slot is kept with fIndexed false so that the directory is
+    not scanned for nothing on every lookup.
+
+    @param pPInode  A pointer to the cached inode structure of the directory.
+    @param bDir     The unused slot to fill.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EIO    A disk I/O error occurred.
+*/
+static REDSTATUS DirIdxBuild(
+    CINODE     *pPInode,
+    uint8_t     bDir)
+{
+    REDSTATUS   ret = 0;
+    DIRIDXDIR  *pDir = &gDirIdx.aDir[bDir];
+    uint32_t    ulDirentCount = DirOffsetToEntryIndex(pPInode->pInodeBuf->ullSize);
+    uint32_t    ulIdx = 0U;
+
+    pDir->ulInode = pPInode->ulInode;
+    pDir->bVolNum = gbRedVolNum;
+    pDir->ulHoles = 0U;
+    pDir->ulFreeHint = ulDirentCount;
+    pDir->fIndexed = ulDirentCount <= REDCONF_DIR_INDEX_ENTRIES;
+
+    while((ret == 0) && pDir->fIndexed && (ulIdx < ulDirentCount))
+    {
+        uint32_t ulBlockLastIdx = REDMIN(DIRENTS_PER_BLOCK, ulDirentCount - ulIdx);
+
+        ret = RedInodeDataSeekAndRead(pPInode, ulIdx / DIRENTS_PER_BLOCK);
+
+        if(ret == 0)
+        {
+            const DIRENT *pDirents = DIRENT_PTR(pPInode->pbData);
+            uint32_t      ulBlockIdx;
+
+            for(ulBlockIdx = 0U; pDir->fIndexed && (ulBlockIdx < ulBlockLastIdx); ulBlockIdx++)
+            {
+                const DIRENT *pDirent = &pDirents[ulBlockIdx];
+
+                if(pDirent->ulInode != INODE_INVALID)
+                {
+                    uint32_t ulHash = DirIdxHash(pDirent->acName, DirEntryNameLen(pDirent));
+
+                    while(!DirIdxInsert(bDir, ulHash, ulIdx + ulBlockIdx))
+                    {
+                        if(!DirIdxEvict(bDir))
+                        {
+                            pDir->fIndexed = false;
+                            break;
+                        }
+                    }
+                }
+                else
+                {
+                    pDir->ulHoles++;
+                    pDir->ulFreeHint = REDMIN(pDir->ulFreeHint, ulIdx + ulBlockIdx);
+                }
+            }
+        }
+        else if(ret == -RED_ENODATA)
+        {
+            /*  Sparse block: all of its dirents are unused.
+            */
+            pDir->ulHoles += ulBlockLastIdx;
+            pDir->ulFreeHint = REDMIN(pDir->ulFreeHint, ulIdx);
+            ret = 0;
+        }
+        else
+        {
+            /*  Unexpected error, let the loop terminate, no action here.
+            */
+        }
+
+        ulIdx += ulBlockLastIdx;
+    }
+
+    if((ret == 0) && !pDir->fIndexed)
+    {
+        DirIdxDrop(bDir);
+
+        pDir->ulInode = pPInode->ulInode;
+        pDir->bVolNum = gbRedVolNum;
+    }
+
+    return ret;
+}
+
+
+/** @brief Look up a name through the directory index.
+
+    Only the dirents whose name hash matches are read.
+
+    @param pPInode      A pointer to the cached inode structure of the directory
+                        to search.
+    @param bDir         The slot of the directory, which must be indexed.
+    @param pszName      The name of the desired entry.
+    @param ulNameLen    The length of @p pszName.
+    @param pulEntryIdx  On successful return, if non-NULL, populated with the
+                        index of the entry.  On -RED_ENOENT return, populated
+                        with the index of the first free dirent, or
+                        DIR_INDEX_INVALID if the directory is full.
+    @param pulInode     On successful return, if non-NULL, populated with the
+                        inode number that the name points to.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EIO    A disk I/O error occurred.
+    @retval -RED_ENOENT @p pszName does not name an existing entry.
+*/
+static REDSTATUS DirIdxLookup(
+    CINODE     *pPInode,
+    uint8_t     bDir,
+    const char *pszName,
+    uint32_t    ulNameLen,
+    uint32_t   *pulEntryIdx,
+    uint32_t   *pulInode)
+{
+    REDSTATUS   ret = -RED_ENOENT;
+    uint32_t    ulHash = DirIdxHash(pszName, ulNameLen);
+    uint16_t    uEntry = gDirIdx.auBucket[DIRIDX_BUCKET(bDir, ulHash)];
+
+    while((ret == -RED_ENOENT) && (uEntry != DIRIDX_ENTRY_NONE))
+    {
+        const DIRIDXENTRY *pEntry = &gDirIdx.aEntry[uEntry];
+
+        if((pEntry->bDir == bDir) && (pEntry->uTag == DIRIDX_TAG(ulHash)))
+        {
+            ret = RedInodeDataSeekAndRead(pPInode, pEntry->uIdx / DIRENTS_PER_BLOCK);
+
+            if(ret == 0)
+            {
+                const DIRENT *pDirent = &DIRENT_PTR(pPInode->pbData)[pEntry->uIdx % DIRENTS_PER_BLOCK];
+
+                REDASSERT(pDirent->ulInode != INODE_INVALID);
+
+                if((pDirent->ulInode != INODE_INVALID) && DirEntryNameMatch(pDirent, pszName, ulNameLen))
+                {
+                    if(pulInode != NULL)
+                    {
+                        *pulInode = pDirent->ulInode;
+
+                      #ifdef REDCONF_ENDIAN_SWAP
+                        *pulInode = RedRev32(*pulInode);
+                      #endif
+                    }
+
+                    if(pulEntryIdx != NULL)
+                    {
+                        *pulEntryIdx = pEntry->uIdx;
+                    }
+                }
+                else
+                {
+                    /*  Hash collision, keep looking.
+                    */
+                    ret = -RED_ENOENT;
+                }
+            }
+            else if(ret == -RED_ENODATA)
+            {
+                /*  Indexed names are never in sparse blocks.
+                */
+                REDERROR();
+                ret = -RED_ENOENT;
+            }
+            else
+            {
+                /*  Unexpected error, let the loop terminate, no action here.
+                */
+            }
+        }
+
+        uEntry = pEntry->uNext;
+    }
+
+    if((ret == -RED_ENOENT) && (pulEntryIdx != NULL))
+    {
+        REDSTATUS ret2 = DirIdxFreeEntry(pPInode, bDir, pulEntryIdx);
+
+        if(ret2 != 0)
+        {
+            ret = ret2;
+        }
+    }
+
+    return ret;
+}
+
+
+/** @brief Add a name to the index of a directory.
+
+    @param bDir     The slot of the directory.
+    @param ulHash   The hash of the name.
+    @param ulIdx    The position of the dirent.
+
+    @return Whether the name was added; false if the index is full.
+*/
+static bool DirIdxInsert(
+    uint8_t     bDir,
+    uint32_t    ulHash,
+    uint32_t    ulIdx)
+{
+    bool        fAdded = false;
+    uint16_t    uEntry = gDirIdx.uFree;
+
+    if(uEntry != DIRIDX_ENTRY_NONE)
+    {
+        DIRIDXENTRY *pEntry = &gDirIdx.aEntry[uEntry];
+        uint32_t     ulBucket = DIRIDX_BUCKET(bDir, ulHash);
+
+        REDASSERT(ulIdx < REDCONF_DIR_INDEX_ENTRIES);
+
+        gDirIdx.uFree = pEntry->uNext;
+
+        pEntry->uTag = DIRIDX_TAG(ulHash);
+        pEntry->uIdx = (uint16_t)ulIdx;
+        pEntry->bDir = bDir;
+        pEntry->uNext = gDirIdx.auBucket[ulBucket];
+        gDirIdx.auBucket[ulBucket] = uEntry;
+
+        fAdded = true;
+    }
+
+    return fAdded;
+}
+
+
+/** @brief Remove a name from the index of a directory.
+
+    @param bDir     The slot of the directory.
+    @param ulHash   The hash of the name.
+    @param ulIdx    The position of the dirent.
+*/
+static void DirIdxRemove(
+    uint8_t     bDir,
+    uint32_t    ulHash,
+    uint32_t    ulIdx)
+{
+    uint16_t   *puLink = &gDirIdx.auBucket[DIRIDX_BUCKET(bDir, ulHash)];
+
+    while(*puLink != DIRIDX_ENTRY_NONE)
+    {
+        DIRIDXENTRY *pEntry = &gDirIdx.aEntry[*puLink];
+
+        if((pEntry->bDir == bDir) && (pEntry->uIdx == ulIdx))
+        {
+            uint16_t uEntry = *puLink;
+
+            *puLink = pEntry->uNext;
+
+            pEntry->bDir = DIRIDX_DIR_NONE;
+            pEntry->uNext = gDirIdx.uFree;
+            gDirIdx.uFree = uEntry;
+            break;
+        }
+
+        puLink = &pEntry->uNext;
+    }
+}
+
+
+/** @brief Evict the least recently used indexed directory to free entries.
+
+    @param bKeep    The slot which must not be evicted.
+
+    @return Whether a directory was evicted.
+*/
+static bool DirIdxEvict(
+    uint8_t     bKeep)
+{
+    uint8_t     bVictim = DIRIDX_DIR_NONE;
+    uint8_t     bIdx;
+
+    for(bIdx = 0U; bIdx < REDCONF_DIR_INDEX_DIRS; bIdx++)
+    {
+        const DIRIDXDIR *pDir = &gDirIdx.aDir[bIdx];
+
+        if((bIdx != bKeep) && (pDir->ulInode != INODE_INVALID) && pDir->fIndexed)
+        {
+            if(    (bVictim == DIRIDX_DIR_NONE)
+                || ((gDirIdx.ulStamp - pDir->ulStamp) > (gDirIdx.ulStamp - gDirIdx.aDir[bVictim].ulStamp)))
+            {
+                bVictim = bIdx;
+            }
+        }
+    }
+
+    if(bVictim != DIRIDX_DIR_NONE)
+    {
+        DirIdxDrop(bVictim);
+    }
+
+    return bVictim != DIRIDX_DIR_NONE;
+}
+
+
+/** @brief Remove a directory and all its names from the index.
+
+    @param bDir The slot of the directory.
+*/
+static void DirIdxDrop(
+    uint8_t     bDir)
+{
+    DIRIDXDIR  *pDir = &gDirIdx.aDir[bDir];
+
+    if(pDir->fIndexed)
+    {
+        uint32_t ulBucket;
+
+        for(ulBucket = 0U; ulBucket < DIRIDX_BUCKETS; ulBucket++)
+        {
+            uint16_t *puLink = &gDirIdx.auBucket[ulBucket];
+
+            while(*puLink != DIRIDX_ENTRY_NONE)
+            {
+                DIRIDXENTRY *pEntry = &gDirIdx.aEntry[*puLink];
+
+                if(pEntry->bDir == bDir)
+                {
+                    uint16_t uEntry = *puLink;
+
+                    *puLink = pEntry->uNext;
+
+                    pEntry->bDir = DIRIDX_DIR_NONE;
+                    pEntry->uNext = gDirIdx.uFree;
+                    gDirIdx.uFree = uEntry;
+                }
+                else
+                {
+                    puLink = &pEntry->uNext;
+                }
+            }
+        }
+    }
+
+    pDir->ulInode = INODE_INVALID;
+    pDir->fIndexed = false;
+}
+
+
+/** @brief Find the first free dirent of an indexed directory.
+
+    Unused dirents are only searched for when the directory is known to have
+    some, starting from the position below which there are none.
+
+    @param pPInode  A pointer to the cached inode structure of the directory.
+    @param bDir     The slot of the directory, which must be indexed.
+    @param pulIdx   On successful return, populated with the index of the first
+                    free dirent, or DIR_INDEX_INVALID if the directory is full.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EIO    A disk I/O error occurred.
+*/
+static REDSTATUS DirIdxFreeEntry(
+    CINODE     *pPInode,
+    uint8_t     bDir,
+    uint32_t   *pulIdx)
+{
+    REDSTATUS   ret = 0;
+    DIRIDXDIR  *pDir = &gDirIdx.aDir[bDir];
+    uint32_t    ulDirentCount = DirOffsetToEntryIndex(pPInode->pInodeBuf->ullSize);
+    uint32_t    ulIdx = ulDirentCount;
+
+    if(pDir->ulHoles > 0U)
+    {
+        bool fFound = false;
+
+        ulIdx = pDir->ulFreeHint;
+
+        while((ret == 0) && !fFound && (ulIdx < ulDirentCount))
+        {
+            uint32_t ulBlockOffset = ulIdx / DIRENTS_PER_BLOCK;
+
+            ret = RedInodeDataSeekAndRead(pPInode, ulBlockOffset);
+
+            if(ret == 0)
+            {
+                const DIRENT *pDirents = DIRENT_PTR(pPInode->pbData);
+                uint32_t      ulBlockLastIdx = REDMIN(DIRENTS_PER_BLOCK, ulDirentCount - (ulBlockOffset * DIRENTS_PER_BLOCK));
+                uint32_t      ulBlockIdx;
+
+                for(ulBlockIdx = ulIdx % DIRENTS_PER_BLOCK; ulBlockIdx < ulBlockLastIdx; ulBlockIdx++)
+                {
+                    if(pDirents[ulBlockIdx].ulInode == INODE_INVALID)
+                    {
+                        fFound = true;
+                        break;
+                    }
+
+                    ulIdx++;
+                }
+            }
+            else if(ret == -RED_ENODATA)
+            {
+                fFound = true;
+                ret = 0;
+            }
+            else
+            {
+                /*  Unexpected error, let the loop terminate, no action here.
+                */
+            }
+        }
+
+        if((ret == 0) && !fFound)
+        {
+            /*  The hole count is wrong; recover by appending.
+            */
+            REDERROR();
+            pDir->ulHoles = 0U;
+        }
+
+        pDir->ulFreeHint = ulIdx;
+    }
+
+    if(ret == 0)
+    {
+        if((ulIdx == ulDirentCount) && (ulDirentCount >= DIRENTS_MAX))
+        {
+            ulIdx = DIR_INDEX_INVALID;
+        }
+
+        *pulIdx = ulIdx;
+    }
+
+    return ret;
+}
+
+
+#if REDCONF_READ_ONLY == 0
+/** @brief Update the index after a name was written to a directory.
+
+    @param pPInode      A pointer to the cached inode structure of the directory.
+    @param ulIdx        The position of the new dirent.
+    @param pszName      The new name.
+    @param ulNameLen    The length of @p pszName.
+    @param fWasUnused   Whether the dirent was an unused one below the end of
+                        the directory, rather than appended to it.
+*/
+static void DirIdxEntryAdded(
+    const CINODE   *pPInode,
+    uint32_t        ulIdx,
+    const char     *pszName,
+    uint32_t        ulNameLen,
+    bool            fWasUnused)
+{
+    uint8_t         bDir = DirIdxFind(pPInode->ulInode);
+
+    if((bDir != DIRIDX_DIR_NONE) && gDirIdx.aDir[bDir].fIndexed)
+    {
+        DIRIDXDIR  *pDir = &gDirIdx.aDir[bDir];
+        uint32_t    ulHash = DirIdxHash(pszName, ulNameLen);
+
+        if(fWasUnused)
+        {
+            REDASSERT(pDir->ulHoles > 0U);
+            pDir->ulHoles--;
+        }
+
+        if(pDir->ulFreeHint == ulIdx)
+        {
+            pDir->ulFreeHint = ulIdx + 1U;
+        }
+
+        if(ulIdx >= REDCONF_DIR_INDEX_ENTRIES)
+        {
+            /*  Appended past the budget: the dirents no longer fit.
+            */
+            DirIdxDrop(bDir);
+        }
+        else
+        {
+            while(!DirIdxInsert(bDir, ulHash, ulIdx))
+            {
+                if(!DirIdxEvict(bDir))
+                {
+                    /*  The directory outgrew the index: it will be found not
+                        to fit the next time it is looked up.
+                    */
+                    DirIdxDrop(bDir);
+                    break;
+                }
+            }
+        }
+    }
+}
+#endif /* REDCONF_READ_ONLY == 0 */
+
+#else /* DIRIDX_ENABLED */
+
+/** @brief Forget the directories of the current volume.
+
+    The directory index is disabled, so there is nothing to do.
+*/
+void RedDirIndexReset(void)
+{
+}
+
+
+/** @brief Forget a directory of the current volume.
+
+    The directory index is disabled, so there is nothing to do.
+
+    @param ulDirInode   The directory inode.
+*/
+void RedDirIndexInvalidate(
+    uint32_t    ulDirInode)
+{
+    (void)ulDirInode;
+}
+
+#endif /* DIRIDX_ENABLED */
+
+
 #endif /* REDCONF_API_POSIX == 1 */
@@ -272,6 +272,51 @@ REDSTATUS RedImapAllocBlock(
 
     return ret;
 }
+
+
+#if REDCONF_API_POSIX == 1
+/** @brief Find an inode whose two slots are both free in the working state.
+
+    Will pass the call down either to the inline imap or to the external imap
+    implementation, whichever is appropriate for the current volume.
+
+    @param ulInode      The first inode to examine.
+    @param ulEndInode   One past the last inode to examine.
+    @param pulFreeInode On success, populated with the found free inode.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EINVAL @p ulInode or @p ulEndInode is out of range; or
+                        @p pulFreeInode is `NULL`.
+    @retval -RED_EIO    A disk I/O error occurred.
+    @retval -RED_ENFILE No free inode was found.
+*/
+REDSTATUS RedImapInodeFindFree(
+    uint32_t    ulInode,
+    uint32_t    ulEndInode,
+    uint32_t   *pulFreeInode)
+{
+    REDSTATUS   ret;
+
+  #if (REDCONF_IMAP_INLINE == 1) && (REDCONF_IMAP_EXTERNAL == 1)
+    if(gpRedCoreVol->fImapInline)
+    {
+        ret = RedImapIInodeFindFree(ulInode, ulEndInode, pulFreeInode);
+    }
+    else
+    {
+        ret = RedImapEInodeFindFree(ulInode, ulEndInode, pulFreeInode);
+    }
+  #elif REDCONF_IMAP_INLINE == 1
+    ret = RedImapIInodeFindFree(ulInode, ulEndInode, pulFreeInode);
+  #else
+    ret = RedImapEInodeFindFree(ulInode, ulEndInode, pulFreeInode);
+  #endif
+
+    return ret;
+}
+#endif
 #endif /* REDCONF_READ_ONLY == 0 */
 
 
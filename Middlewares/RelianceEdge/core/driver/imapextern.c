@@ -219,6 +219,12 @@ REDSTATUS RedImapEBlockFindFree(
             uint32_t ulImapNode = ulBmpIdx / IMAPNODE_ENTRIES;
             uint32_t ulImapIdx = ulBmpIdx % IMAPNODE_ENTRIES;
 
+            /*  Don't search past the end of the volume, nor past the starting
+                block once the search has wrapped around.
+            */
+            uint32_t ulLimitBlock = (ulSearchBlock < ulBlock) ? ulBlock : gpRedVolume->ulBlockCount;
+            uint32_t ulNodeEnd = REDMIN(IMAPNODE_ENTRIES, ulImapIdx + (ulLimitBlock - ulSearchBlock));
+
             /*  If we have an imap node buffered but it isn't the one we want,
                 release that buffer.
             */
@@ -240,54 +246,64 @@ REDSTATUS RedImapEBlockFindFree(
 
             if(ret == 0)
             {
-                /*  As an optimization to reduce the number of RedBitGet()
-                    calls, if all eight blocks in the current byte are
-                    allocated, then skip to the next byte.
+                /*  Find the next block which is free in the working state,
+                    32 blocks at a time.
                 */
-                if(((ulImapIdx & 7U) == 0U) && (pImap->abEntries[ulImapIdx >> 3U] == UINT8_MAX))
+                uint32_t ulCandIdx = RedBitFindClear(pImap->abEntries, NULL, ulImapIdx, ulNodeEnd);
+
+                if(ulCandIdx == ulNodeEnd)
                 {
-                    ulSearchBlock += REDMIN(8U, gpRedVolume->ulBlockCount - ulSearchBlock);
+                    ulSearchBlock += ulNodeEnd - ulImapIdx;
                 }
                 else
                 {
-                    /*  If the block is free in the working state...
+                    /*  Check the whole 32-bit word containing the candidate
+                        against the committed state.  We aren't allowed to
+                        hold multiple imap buffers at the same time, since
+                        doing so would increase the minimum buffer count, so
+                        the working state bits of the word are copied before
+                        the buffer is released.
+                    */
+                    uint32_t    ulWordIdx = ulCandIdx & ~31U;
+                    uint32_t    ulWordEnd = REDMIN(ulWordIdx + 32U, ulNodeEnd);
+                    uint32_t    ulWordBytes = ((ulWordEnd - ulWordIdx) + 7U) >> 3U;
+                    uint8_t     abCurWord[4U];
+                    uint8_t     abCmtWord[4U];
+
+                    RedMemCpy(abCurWord, &pImap->abEntries[ulWordIdx >> 3U], ulWordBytes);
+
+                    RedBufferPut(pImap);
+                    pImap = NULL;
+
+                    /*  Get the buffer for the committed state imap.
                     */
-                    if(!RedBitGet(pImap->abEntries, ulImapIdx))
+                    ret = RedBufferGet(RedImapNodeBlock(1U - gpRedCoreVol->bCurMR, ulImapNode),
+                        BFLAG_META_IMAP, (void **)&pImap);
+                    if(ret == 0)
                     {
-                        /*  We aren't allowed to hold multiple imap buffers at
-                            the same time, since doing so would increase the
-                            minimum buffer count.
+                        uint32_t ulFreeIdx;
+
+                        RedMemCpy(abCmtWord, &pImap->abEntries[ulWordIdx >> 3U], ulWordBytes);
+
+                        /*  Release the committed state imap buffer so we can
+                            reacquire the working state imap buffer on the
+                            next loop iteration.
                         */
                         RedBufferPut(pImap);
                         pImap = NULL;
 
-                        /*  Get the buffer for the committed state imap.
-                        */
-                        ret = RedBufferGet(RedImapNodeBlock(1U - gpRedCoreVol->bCurMR, ulImapNode),
-                            BFLAG_META_IMAP, (void **)&pImap);
-                        if(ret == 0)
+                        ulFreeIdx = RedBitFindClear(abCurWord, abCmtWord, ulCandIdx - ulWordIdx, ulWordEnd - ulWordIdx);
+                        if(ulFreeIdx < (ulWordEnd - ulWordIdx))
                         {
-                            /*  If the block is free in the committed state...
-                            */
-                            if(!RedBitGet(pImap->abEntries, ulImapIdx))
-                            {
-                                /*  Found a free block.
-                                */
-                                fFoundFree = true;
-                                *pulFreeBlock = ulSearchBlock;
-                                break;
-                            }
-
-                            /*  Release the committed state imap buffer so we
-                                can reacquire the working state imap buffer on
-                                the next loop iteration.
+                            /*  Found a free block.
                             */
-                            RedBufferPut(pImap);
-                            pImap = NULL;
+                            fFoundFree = true;
+                            *pulFreeBlock = ulSearchBlock + ((ulWordIdx + ulFreeIdx) - ulImapIdx);
+                            break;
                         }
-                    }
 
-                    ulSearchBlock++;
+                        ulSearchBlock += ulWordEnd - ulImapIdx;
+                    }
                 }
 
                 if(ulSearchBlock == gpRedVolume->ulBlockCount)
@@ -315,6 +331,86 @@ REDSTATUS RedImapEBlockFindFree(
 }
 
 
+#if REDCONF_API_POSIX == 1
+/** @brief Scan the imap for an inode whose two slots are both free in the
+           working state.
+
+    @param ulInode      The first inode to examine.
+    @param ulEndInode   One past the last inode to examine.
+    @param pulFreeInode On success, populated with the found free inode.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EINVAL @p ulInode or @p ulEndInode is out of range; or
+                        @p pulFreeInode is `NULL`.
+    @retval -RED_EIO    A disk I/O error occurred.
+    @retval -RED_ENFILE No free inode was found.
+*/
+REDSTATUS RedImapEInodeFindFree(
+    uint32_t    ulInode,
+    uint32_t    ulEndInode,
+    uint32_t   *pulFreeInode)
+{
+    REDSTATUS   ret = 0;
+
+    if(    gpRedCoreVol->fImapInline
+        || (ulInode < INODE_FIRST_VALID)
+        || (ulEndInode < ulInode)
+        || (ulEndInode > (INODE_FIRST_VALID + gpRedCoreVol->ulInodeCount))
+        || (pulFreeInode == NULL))
+    {
+        REDERROR();
+        ret = -RED_EINVAL;
+    }
+    else
+    {
+        /*  The inode table is at the start of the bitmap, two bits per inode.
+            IMAPNODE_ENTRIES is even, so the two slots of an inode are always
+            in the same imap node.
+        */
+        uint32_t ulPair = ulInode - INODE_FIRST_VALID;
+        uint32_t ulEndPair = ulEndInode - INODE_FIRST_VALID;
+
+        ret = -RED_ENFILE;
+
+        while(ulPair < ulEndPair)
+        {
+            uint32_t    ulImapNode = (ulPair * 2U) / IMAPNODE_ENTRIES;
+            uint32_t    ulNodePair = ulPair - (ulImapNode * (IMAPNODE_ENTRIES / 2U));
+            uint32_t    ulNodeEnd = REDMIN(IMAPNODE_ENTRIES / 2U, ulNodePair + (ulEndPair - ulPair));
+            IMAPNODE   *pImap;
+            REDSTATUS   retGet;
+
+            retGet = RedBufferGet(RedImapNodeBlock(gpRedCoreVol->bCurMR, ulImapNode), BFLAG_META_IMAP, (void **)&pImap);
+            if(retGet != 0)
+            {
+                ret = retGet;
+                break;
+            }
+            else
+            {
+                uint32_t ulFreePair = RedBitFindClearPair(pImap->abEntries, ulNodePair, ulNodeEnd);
+
+                RedBufferPut(pImap);
+
+                if(ulFreePair < ulNodeEnd)
+                {
+                    *pulFreeInode = ulPair + (ulFreePair - ulNodePair) + INODE_FIRST_VALID;
+                    ret = 0;
+                    break;
+                }
+
+                ulPair += ulNodeEnd - ulNodePair;
+            }
+        }
+    }
+
+    return ret;
+}
+#endif
+
+
 /** @brief Branch an imap node and get a buffer for it.
 
     If the imap node is already branched, it can be overwritten in its current
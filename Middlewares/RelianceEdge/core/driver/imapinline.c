@@ -160,57 +160,99 @@ REDSTATUS RedImapIBlockFindFree(
     {
         const uint8_t  *pbBmpCurMR = gpRedCoreVol->aMR[gpRedCoreVol->bCurMR].abEntries;
         const uint8_t  *pbBmpCmtMR = gpRedCoreVol->aMR[1U - gpRedCoreVol->bCurMR].abEntries;
-        uint32_t        ulSearchBlock = ulBlock;
 
-        /*  Default to an ENOSPC error, which will be returned if we search
-            every allocable block without finding a free block.
+        /*  Blocks before the inode table aren't included in the bitmap.
         */
-        ret = -RED_ENOSPC;
+        uint32_t        ulStartIdx = ulBlock - gpRedCoreVol->ulInodeTableStartBN;
+        uint32_t        ulFirstIdx = gpRedCoreVol->ulFirstAllocableBN - gpRedCoreVol->ulInodeTableStartBN;
+        uint32_t        ulEndIdx = gpRedVolume->ulBlockCount - gpRedCoreVol->ulInodeTableStartBN;
+        uint32_t        ulFreeIdx;
+
+        /*  A block is free if it is free in both the working state and the
+            committed state.  Search 32 blocks at a time from the requested
+            block to the end of the volume, then wrap around to the first
+            allocable block.
+        */
+        ulFreeIdx = RedBitFindClear(pbBmpCurMR, pbBmpCmtMR, ulStartIdx, ulEndIdx);
+        if(ulFreeIdx == ulEndIdx)
+        {
+            ulFreeIdx = RedBitFindClear(pbBmpCurMR, pbBmpCmtMR, ulFirstIdx, ulStartIdx);
+            if(ulFreeIdx == ulStartIdx)
+            {
+                ulFreeIdx = ulEndIdx;
+            }
+        }
 
-        do
+        if(ulFreeIdx == ulEndIdx)
         {
-            /*  Blocks before the inode table aren't included in the bitmap.
+            /*  Searched every allocable block without finding a free block.
             */
-            uint32_t ulBmpIdx = ulSearchBlock - gpRedCoreVol->ulInodeTableStartBN;
+            ret = -RED_ENOSPC;
+        }
+        else
+        {
+            *pulFreeBlock = ulFreeIdx + gpRedCoreVol->ulInodeTableStartBN;
+            ret = 0;
+        }
+    }
 
-            /*  As an optimization to reduce the number of RedBitGet() calls, if
-                all eight blocks in the current byte are allocated, then skip
-                to the next byte.
-            */
-            if(((ulBmpIdx & 7U) == 0U) && (pbBmpCurMR[ulBmpIdx >> 3U] == UINT8_MAX))
-            {
-                ulSearchBlock += REDMIN(8U, gpRedVolume->ulBlockCount - ulSearchBlock);
-            }
-            else
-            {
-                /*  If the block is free in the working state...
-                */
-                if(!RedBitGet(pbBmpCurMR, ulBmpIdx))
-                {
-                    /*  If the block is free in the committed state...
-                    */
-                    if(!RedBitGet(pbBmpCmtMR, ulBmpIdx))
-                    {
-                        /*  Found a free block.
-                        */
-                        *pulFreeBlock = ulSearchBlock;
-                        ret = 0;
-                        break;
-                    }
-                }
-
-                ulSearchBlock++;
-            }
+    return ret;
+}
 
-            if(ulSearchBlock == gpRedVolume->ulBlockCount)
-            {
-                ulSearchBlock = gpRedCoreVol->ulFirstAllocableBN;
-            }
-        } while(ulSearchBlock != ulBlock);
+
+#if REDCONF_API_POSIX == 1
+/** @brief Scan the imap for an inode whose two slots are both free in the
+           working state.
+
+    @param ulInode      The first inode to examine.
+    @param ulEndInode   One past the last inode to examine.
+    @param pulFreeInode On success, populated with the found free inode.
+
+    @return A negated ::REDSTATUS code indicating the operation result.
+
+    @retval 0           Operation was successful.
+    @retval -RED_EINVAL @p ulInode or @p ulEndInode is out of range; or
+                        @p pulFreeInode is `NULL`.
+    @retval -RED_ENFILE No free inode was found.
+*/
+REDSTATUS RedImapIInodeFindFree(
+    uint32_t    ulInode,
+    uint32_t    ulEndInode,
+    uint32_t   *pulFreeInode)
+{
+    REDSTATUS   ret;
+
+    if(    (!gpRedCoreVol->fImapInline)
+        || (ulInode < INODE_FIRST_VALID)
+        || (ulEndInode < ulInode)
+        || (ulEndInode > (INODE_FIRST_VALID + gpRedCoreVol->ulInodeCount))
+        || (pulFreeInode == NULL))
+    {
+        REDERROR();
+        ret = -RED_EINVAL;
+    }
+    else
+    {
+        /*  The inode table is at the start of the bitmap, two bits per inode.
+        */
+        uint32_t ulStartPair = ulInode - INODE_FIRST_VALID;
+        uint32_t ulEndPair = ulEndInode - INODE_FIRST_VALID;
+        uint32_t ulFreePair = RedBitFindClearPair(gpRedMR->abEntries, ulStartPair, ulEndPair);
+
+        if(ulFreePair == ulEndPair)
+        {
+            ret = -RED_ENFILE;
+        }
+        else
+        {
+            *pulFreeInode = ulFreePair + INODE_FIRST_VALID;
+            ret = 0;
+        }
     }
 
     return ret;
 }
+#endif
 #endif /* REDCONF_READ_ONLY == 0 */
 
 #endif /* REDCONF_IMAP_INLINE == 1 */
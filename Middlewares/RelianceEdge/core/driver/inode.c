@@ -537,6 +537,12 @@ REDSTATUS RedInodeFree(
     {
         bool fSlot0Allocated;
 
+        if(pInode->fDirectory)
+        {
+            RedDirIndexInvalidate(pInode->ulInode);
+            RedDcachePurgeDir(pInode->ulInode);
+        }
+
         RedBufferDiscard(pInode->pInodeBuf);
         pInode->pInodeBuf = NULL;
 
@@ -924,35 +930,39 @@ static REDSTATUS InodeFindFree(
     }
     else
     {
-        uint32_t ulInode;
+        uint32_t ulInodeEnd = INODE_FIRST_VALID + gpRedCoreVol->ulInodeCount;
+        uint32_t ulStart = gpRedCoreVol->ulInodeAllocNext;
 
-        ret = 0;
-
-        for(ulInode = INODE_FIRST_FREE; ulInode < (INODE_FIRST_VALID + gpRedCoreVol->ulInodeCount); ulInode++)
+        if((ulStart < INODE_FIRST_FREE) || (ulStart >= ulInodeEnd))
         {
-            bool fFree;
-
-            ret = RedInodeIsFree(ulInode, &fFree);
+            ulStart = INODE_FIRST_FREE;
+        }
 
-            if((ret != 0) || fFree)
-            {
-                break;
-            }
+        /*  Search the working state imap from the allocation pointer to the
+            last inode, then wrap around to the first free inode.  Inodes are
+            handed out round-robin, as blocks are, so the allocated inodes at
+            the start of the table are not rescanned on every create.
+        */
+        ret = RedImapInodeFindFree(ulStart, ulInodeEnd, pulInode);
+        if((ret == -RED_ENFILE) && (ulStart > INODE_FIRST_FREE))
+        {
+            ret = RedImapInodeFindFree(INODE_FIRST_FREE, ulStart, pulInode);
         }
 
         if(ret == 0)
         {
-            if(ulInode < (INODE_FIRST_VALID + gpRedCoreVol->ulInodeCount))
-            {
-                *pulInode = ulInode;
-            }
-            else
-            {
-                /*  If gpRedMR->ulFreeInodes > 0, we should have found an inode.
-                */
-                CRITICAL_ERROR();
-                ret = -RED_ENFILE;
-            }
+            gpRedCoreVol->ulInodeAllocNext = *pulInode + 1U;
+        }
+        else if(ret == -RED_ENFILE)
+        {
+            /*  If gpRedMR->ulFreeInodes > 0, we should have found an inode.
+            */
+            CRITICAL_ERROR();
+        }
+        else
+        {
+            /*  Other errors are propagated.
+            */
         }
     }
 
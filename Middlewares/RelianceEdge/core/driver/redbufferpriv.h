@@ -31,7 +31,8 @@
 
 
 /*  The original implementation in buffer.c.  Simpler, smaller (code size),
-    but has more limitations (fewer buffers, lower performance).
+    but has more limitations (fewer buffers, lower performance).  Supports the
+    write-gather buffer for flushes only.
 */
 #define BM_SIMPLE   1U
 
@@ -43,8 +44,8 @@
 /*  GPL release only has the simple buffer module.
 
     Commercial release has both, so:
-      - Only the enhanced buffer module supports the write-gather buffer, so
-        using enabling it automatically selects the enhanced buffer module.
+      - The enhanced buffer module makes fuller use of the write-gather buffer,
+        so enabling it automatically selects the enhanced buffer module.
       - Otherwise, the decision is based on a buffer count threshold, for now.
 */
 #if (RED_KIT == RED_KIT_GPL) || ((REDCONF_BUFFER_WRITE_GATHER_SIZE_KB == 0U) && (REDCONF_BUFFER_COUNT < 24U))
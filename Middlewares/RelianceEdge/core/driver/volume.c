@@ -437,6 +437,15 @@ REDSTATUS RedVolMountMetaroot(
     REDSTATUS   retMR1;
     REDSTATUS   ret;
 
+  #if REDCONF_API_POSIX == 1
+    /*  Directory contents are about to be reloaded from the committed state,
+        forget what the directory index and the lookup cache learned about
+        them.
+    */
+    RedDirIndexReset();
+    RedDcachePurge();
+  #endif
+
     retMR0 = RedIoRead(gbRedVolNum, BLOCK_NUM_FIRST_METAROOT, 1U, &gpRedCoreVol->aMR[0U]);
     retMR1 = RedIoRead(gbRedVolNum, BLOCK_NUM_FIRST_METAROOT + 1U, 1U, &gpRedCoreVol->aMR[1U]);
 
@@ -539,6 +548,9 @@ REDSTATUS RedVolMountMetaroot(
         gpRedCoreVol->fUseReservedBlocks = false;
       #endif
         gpRedCoreVol->ulAlmostFreeBlocks = 0U;
+      #if (REDCONF_READ_ONLY == 0) && (REDCONF_API_POSIX == 1)
+        gpRedCoreVol->ulInodeAllocNext = INODE_FIRST_FREE;
+      #endif
 
         gpRedCoreVol->aMR[1U - gpRedCoreVol->bCurMR] = *gpRedMR;
         gpRedCoreVol->bCurMR = 1U - gpRedCoreVol->bCurMR;
@@ -96,6 +96,32 @@ REDSTATUS RedIoFlush(uint8_t bVolNum);
 #define BFLAG_META              ((uint16_t) 0x8000U)
 
 
+/** @brief Block buffer statistics, see RedBufferStatsGet().
+
+    The counters are cumulative since RedBufferInit() and wrap around.
+*/
+typedef struct
+{
+    uint32_t    ulLookups;      /**< RedBufferGet() calls. */
+    uint32_t    ulHits;         /**< RedBufferGet() calls which found the block buffered. */
+    uint32_t    ulReads;        /**< Blocks read from disk into a buffer. */
+    uint32_t    ulWrites;       /**< Dirty buffers written to disk. */
+    uint32_t    ulGatherWrites; /**< Disk writes which carried several dirty buffers. */
+} REDBUFFERSTATS;
+
+
+/** @brief Directory entry lookup cache statistics, see RedDcacheStatsGet().
+
+    The counters are cumulative and wrap around.
+*/
+typedef struct
+{
+    uint32_t    ulLookups;      /**< RedDcacheLookup() calls. */
+    uint32_t    ulHits;         /**< Lookups answered by the cache. */
+    uint32_t    ulNegativeHits; /**< Hits which found the name does not exist. */
+} REDDCACHESTATS;
+
+
 void RedBufferInit(void);
 REDSTATUS RedBufferGet(uint32_t ulBlock, uint16_t uFlags, void **ppBuffer);
 void RedBufferPut(const void *pBuffer);
@@ -108,6 +134,7 @@ void RedBufferDiscard(const void *pBuffer);
 #endif
 #endif
 REDSTATUS RedBufferDiscardRange(uint32_t ulBlockStart, uint32_t ulBlockCount);
+void RedBufferStatsGet(REDBUFFERSTATS *pStats);
 REDSTATUS RedBufferReadRange(uint32_t ulBlockStart, uint32_t ulBlockCount, uint8_t *pbDataBuffer);
 #if REDCONF_READ_ONLY == 0
 REDSTATUS RedBufferWriteRange(uint32_t ulBlockStart, uint32_t ulBlockCount, const uint8_t *pbDataBuffer);
@@ -128,6 +155,9 @@ REDSTATUS RedImapBlockGet(uint8_t bMR, uint32_t ulBlock, bool *pfAllocated);
 #if REDCONF_READ_ONLY == 0
 REDSTATUS RedImapBlockSet(uint32_t ulBlock, bool fAllocated);
 REDSTATUS RedImapAllocBlock(uint32_t *pulBlock);
+#if REDCONF_API_POSIX == 1
+REDSTATUS RedImapInodeFindFree(uint32_t ulInode, uint32_t ulEndInode, uint32_t *pulFreeInode);
+#endif
 #endif
 REDSTATUS RedImapBlockState(uint32_t ulBlock, ALLOCSTATE *pState);
 
@@ -136,6 +166,9 @@ REDSTATUS RedImapIBlockGet(uint8_t bMR, uint32_t ulBlock, bool *pfAllocated);
 #if REDCONF_READ_ONLY == 0
 REDSTATUS RedImapIBlockSet(uint32_t ulBlock, bool fAllocated);
 REDSTATUS RedImapIBlockFindFree(uint32_t ulBlock, uint32_t *pulFreeBlock);
+#if REDCONF_API_POSIX == 1
+REDSTATUS RedImapIInodeFindFree(uint32_t ulInode, uint32_t ulEndInode, uint32_t *pulFreeInode);
+#endif
 #endif
 #endif
 
@@ -144,6 +177,9 @@ REDSTATUS RedImapEBlockGet(uint8_t bMR, uint32_t ulBlock, bool *pfAllocated);
 #if REDCONF_READ_ONLY == 0
 REDSTATUS RedImapEBlockSet(uint32_t ulBlock, bool fAllocated);
 REDSTATUS RedImapEBlockFindFree(uint32_t ulBlock, uint32_t *pulFreeBlock);
+#if REDCONF_API_POSIX == 1
+REDSTATUS RedImapEInodeFindFree(uint32_t ulInode, uint32_t ulEndInode, uint32_t *pulFreeInode);
+#endif
 #endif
 uint32_t RedImapNodeBlock(uint8_t bMR, uint32_t ulImapNode);
 #endif
@@ -260,6 +296,15 @@ REDSTATUS RedDirEntryRead(CINODE *pPInode, uint32_t *pulIdx, char *pszName, uint
 #if (REDCONF_READ_ONLY == 0) && (REDCONF_API_POSIX_RENAME == 1)
 REDSTATUS RedDirEntryRename(CINODE *pSrcPInode, const char *pszSrcName, CINODE *pSrcInode, CINODE *pDstPInode, const char *pszDstName, CINODE *pDstInode);
 #endif
+void RedDirIndexReset(void);
+void RedDirIndexInvalidate(uint32_t ulDirInode);
+
+bool RedDcacheLookup(uint32_t ulPInode, const char *pszName, uint32_t *pulInode);
+void RedDcacheInsert(uint32_t ulPInode, const char *pszName, uint32_t ulInode);
+void RedDcacheRemove(uint32_t ulPInode, const char *pszName);
+void RedDcachePurgeDir(uint32_t ulDirInode);
+void RedDcachePurge(void);
+void RedDcacheStatsGet(REDDCACHESTATS *pStats);
 #endif
 
 REDSTATUS RedVolInitBlockGeometry(void);
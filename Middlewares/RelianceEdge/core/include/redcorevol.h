@@ -84,6 +84,13 @@ typedef struct
     */
     uint32_t    ulAlmostFreeBlocks;
 
+  #if (REDCONF_READ_ONLY == 0) && (REDCONF_API_POSIX == 1)
+    /** Forward inode allocation pointer: where the next free inode search
+        starts.  Only a hint, kept in RAM and reset on mount.
+    */
+    uint32_t    ulInodeAllocNext;
+  #endif
+
   #if RESERVED_BLOCKS > 0U
     /** Whether to use the blocks reserved for operations that create free
         space.
@@ -106,6 +106,10 @@ REDSTATUS RedOsTimestampUninit(void);
 REDTIMESTAMP RedOsTimestamp(void);
 uint64_t RedOsTimePassed(REDTIMESTAMP tsSince);
 
+#if REDOSCONF_CRC_OVERRIDE == 1
+uint32_t RedOsCrc32Update(uint32_t ulInitCrc32, const uint32_t *pulBuffer, uint32_t ulWords);
+#endif
+
 #if REDCONF_OUTPUT == 1
 void RedOsOutputString(const char *pszString);
 #endif
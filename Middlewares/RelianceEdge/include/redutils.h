@@ -49,6 +49,7 @@ int32_t RedStrNCmp(const char *pszStr1, const char *pszStr2, uint32_t ulLen);
 void RedStrNCpy(char *pszDst, const char *pszSrc, uint32_t ulLen);
 
 uint32_t RedCrc32Update(uint32_t ulInitCrc32, const void *pBuffer, uint32_t ulLength);
+uint32_t RedCrc32UpdateSw(uint32_t ulInitCrc32, const void *pBuffer, uint32_t ulLength);
 uint32_t RedCrcNode(const void *pBuffer);
 
 #if REDCONF_API_POSIX == 1
@@ -58,6 +59,8 @@ uint32_t RedNameLen(const char *pszName);
 bool RedBitGet(const uint8_t *pbBitmap, uint32_t ulBit);
 void RedBitSet(uint8_t *pbBitmap, uint32_t ulBit);
 void RedBitClear(uint8_t *pbBitmap, uint32_t ulBit);
+uint32_t RedBitFindClear(const uint8_t *pbBitmap1, const uint8_t *pbBitmap2, uint32_t ulStartBit, uint32_t ulEndBit);
+uint32_t RedBitFindClearPair(const uint8_t *pbBitmap, uint32_t ulStartPair, uint32_t ulEndPair);
 
 #ifdef REDCONF_ENDIAN_SWAP
 uint64_t RedRev64(uint64_t ullToRev);
@@ -68,13 +71,27 @@ uint16_t RedRev16(uint16_t uToRev);
 void RedSignOn(void);
 
 #ifdef REDCONF_HEAP_ALLOCATOR
+/** @brief Heap free space and fragmentation, as reported by RedHeapStats().
+
+    Blocks on the small block quick lists are free for the caller but not yet
+    combined with their neighbors, so they are counted apart.
+*/
+typedef struct
+{
+    uint32_t    ulFreeBytes;    /**< Bytes in free blocks, headers included. */
+    uint32_t    ulFreeBlocks;   /**< Number of free blocks. */
+    uint32_t    ulLargestFree;  /**< Largest allocation a free block can satisfy. */
+    uint32_t    ulQuickBytes;   /**< Bytes in blocks cached on quick lists. */
+    uint32_t    ulQuickBlocks;  /**< Number of blocks cached on quick lists. */
+} REDHEAPFRAG;
+
 void RedHeapInit(void *pMemBase, uint32_t ulMemSize);
 void *RedHeapAlloc(uint32_t nSize);
 void RedHeapFree(void *pMem);
 void *RedHeapRealloc(void *pMem, uint32_t ulSize);
 void *RedHeapCalloc(uint32_t ulElements, uint32_t ulElementSize);
 int32_t RedHeapCheck(uint8_t bVerbosity);
-void RedHeapStats(uint32_t *pulAllocBytes, uint32_t *pulMaxAllocBytes, uint32_t *pulAllocHdr, uint32_t *pulTotalHdr);
+void RedHeapStats(uint32_t *pulAllocBytes, uint32_t *pulMaxAllocBytes, uint32_t *pulAllocHdr, uint32_t *pulTotalHdr, REDHEAPFRAG *pFrag);
 
 #define malloc      RedHeapAlloc
 #define free        RedHeapFree
@@ -74,5 +74,25 @@
 */
 #define REDOSCONF_FAKE_UID_GID 0
 
+/** @brief Whether RedOsCrc32Update() is implemented by the OS services.
+
+    If enabled, RedCrc32Update() hands the aligned 32-bit words of buffers of
+    at least #REDOSCONF_CRC_MIN_LENGTH bytes to RedOsCrc32Update(), typically
+    backed by CRC hardware.  The software algorithm selected with
+    #REDCONF_CRC_ALGORITHM still handles short buffers and unaligned bytes, so
+    a small one (CRC_SARWATE or CRC_BITWISE) is usually sufficient.
+
+    This port forwards to crc_driver_update(): the STM32 CRC unit on target,
+    PCLMUL or ARMv8 CRC32 instructions in host builds.
+*/
+#define REDOSCONF_CRC_OVERRIDE 1
+
+/** @brief Shortest buffer, in bytes, for which RedOsCrc32Update() is used.
+
+    Below this length the setup cost of the OS implementation outweighs its
+    per-byte advantage over the software algorithm.
+*/
+#define REDOSCONF_CRC_MIN_LENGTH 32U
+
 
 #endif
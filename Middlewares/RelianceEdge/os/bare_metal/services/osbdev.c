@@ -40,6 +40,37 @@ LX_NOR_FLASH nor_mem_desc = {0};
 /* Aligned buffer (for unaligned buffer writing/reading) (uint32_t) */
 ULONG ulBuffer[LX_NOR_SECTOR_SIZE] __attribute__((aligned(4))) = {0};
 
+/* LevelX RAM structures are placed in the .lx_cache section (see STM32F412ZGTX_FLASH.ld) */
+#define BDEV_LX_CACHE               __attribute__((section(".lx_cache"), aligned(4)))
+
+#ifdef LX_NOR_ENABLE_MAPPING_TABLE
+/* Logical sectors covered by the LevelX RAM mapping table, 2 bytes per sector. The MSC LUN exposes the whole
+   device, not only the Reliance Edge volume, so the table has one entry per physical sector (the logical
+   capacity is one block smaller): 32640 entries, ~64 KB with both 64 KB and 4 KB blocks */
+#define BDEV_MAPPING_TABLE_SECTORS  (DRIVER_BLOCK_COUNT * (DRIVER_BLOCK_SIZE / (LX_NOR_SECTOR_SIZE * sizeof(ULONG))))
+
+/* LevelX RAM mapping table (logical -> physical sector index) */
+static LX_NOR_MAPPING_TABLE_TYPE usMappingTable[BDEV_MAPPING_TABLE_SECTORS] BDEV_LX_CACHE;
+#endif
+
+#ifndef LX_NOR_DISABLE_EXTENDED_CACHE
+#ifdef LX_DIRECT_READ
+/* LevelX extended cache size. With LX_DIRECT_READ the metadata is read straight from the memory-mapped
+   bank and never fills the sector cache, so the memory only holds the mapping bitmap (1 bit per physical
+   sector, at most 4080 B) and the obsolete count cache (1 byte per block, 255 B for 64 KB / 4080 B for 4 KB blocks) */
+#define BDEV_EXTENDED_CACHE_SIZE    ((((DRIVER_BLOCK_COUNT * (DRIVER_BLOCK_SIZE / (LX_NOR_SECTOR_SIZE * sizeof(ULONG)))) + 31U) / 32U) * sizeof(ULONG) + \
+                                     (((DRIVER_BLOCK_COUNT * sizeof(LX_NOR_OBSOLETE_COUNT_CACHE_TYPE)) + 3U) / 4U) * sizeof(ULONG))
+#else
+/* LevelX extended cache size. Memory is given to the mapping bitmap (1 bit per physical sector, ~4 KB),
+   then to the obsolete count cache (1 byte per block, 255 B for 64 KB / 4 KB for 4 KB blocks),
+   the rest holds up to LX_NOR_EXTENDED_CACHE_SIZE metadata sectors */
+#define BDEV_EXTENDED_CACHE_SIZE    (12U * 1024U)
+#endif
+
+/* LevelX extended cache memory */
+static ULONG ulExtendedCache[BDEV_EXTENDED_CACHE_SIZE / sizeof(ULONG)] BDEV_LX_CACHE;
+#endif
+
 /* Low level init status */
 enum {LX_NOINIT, LX_INIT, LX_INITERR} ini_sts = LX_NOINIT;
 
@@ -124,12 +155,32 @@ REDSTATUS RedOsBDevOpen(
     _lx_nor_flash_initialize();
 
     /* Initialize QSPI low level & nor flash*/
-    if (_lx_nor_flash_open(&nor_mem_desc, gaRedVolConf[0].pszPathPrefix, flash_driver_init) != LX_SUCCESS)
+    if (_lx_nor_flash_open(&nor_mem_desc, (CHAR *)gaRedVolConf[0].pszPathPrefix, flash_driver_init) != LX_SUCCESS)
+    {
+        /* Error in initialization */
+        ini_sts = LX_INITERR;
+        return -RED_EIO;
+    }
+
+#ifdef LX_NOR_ENABLE_MAPPING_TABLE
+    /* Build RAM mapping table (open clears the control block, so it is enabled after open) */
+    if (_lx_nor_flash_mapping_table_enable(&nor_mem_desc, usMappingTable, sizeof(usMappingTable)) != LX_SUCCESS)
+    {
+        /* Error in initialization */
+        ini_sts = LX_INITERR;
+        return -RED_EIO;
+    }
+#endif
+
+#ifndef LX_NOR_DISABLE_EXTENDED_CACHE
+    /* Enable extended cache (mapping bitmap and obsolete counts are built from the opened flash) */
+    if (_lx_nor_flash_extended_cache_enable(&nor_mem_desc, ulExtendedCache, sizeof(ulExtendedCache)) != LX_SUCCESS)
     {
         /* Error in initialization */
         ini_sts = LX_INITERR;
         return -RED_EIO;
     }
+#endif
 
     /* Change init status */
     ini_sts = LX_INIT;
@@ -260,6 +311,19 @@ REDSTATUS RedOsBDevRead(
         return -RED_EINVAL;
     }
 
+    /* If pointer is aligned, the whole range goes to LevelX in one request */
+    if (IS_ALIGNED_PTR(pBuffer, sizeof(uint32_t)))
+    {
+        /* Read ulSectorCount (512 bytes block), contiguous runs are read in one burst */
+        if (_lx_nor_flash_sectors_read(&nor_mem_desc, (ULONG)ullSectorStart, pBuffer, ulSectorCount) != LX_SUCCESS)
+        {
+            return -RED_EIO;
+        }
+
+        /* All operations success */
+        return 0;
+    }
+
     /* Copy data pointer */
     uint8_t *tmpBuf = pBuffer;
 
@@ -269,27 +333,15 @@ REDSTATUS RedOsBDevRead(
     /* Read ulSectorCount (512 bytes block) */
     for (uint32_t ulCnt = 0; ulCnt < ulSectorCount; ulCnt++)
     {
-        /* If pointer is aligned */
-        if (IS_ALIGNED_PTR(pBuffer, sizeof(uint32_t)))
-        {
-            /* Read 512 byte logical sector */
-            if (_lx_nor_flash_sector_read(&nor_mem_desc, ullTmpSector, tmpBuf) != LX_SUCCESS)
-            {
-                return -RED_EIO;
-            }
-        }
-        else
+        /* Read 512 byte logical sector to aligned buffer */
+        if (_lx_nor_flash_sector_read(&nor_mem_desc, ullTmpSector, ulBuffer) != LX_SUCCESS)
         {
-            /* Read 512 byte logical sector to aligned buffer */
-            if (_lx_nor_flash_sector_read(&nor_mem_desc, ullTmpSector, ulBuffer) != LX_SUCCESS)
-            {
-                return -RED_EIO;
-            }
-
-            /* Copy to unaligned buffer */
-            RedMemCpy(tmpBuf, ulBuffer, sizeof(ulBuffer));
+            return -RED_EIO;
         }
 
+        /* Copy to unaligned buffer */
+        RedMemCpy(tmpBuf, ulBuffer, sizeof(ulBuffer));
+
         /* Increase sector counter */
         ullTmpSector += 1;
 
@@ -336,8 +388,21 @@ REDSTATUS RedOsBDevWrite(
         return -RED_EINVAL;
     }
 
+    /* If pointer is aligned, the whole range goes to LevelX in one request */
+    if (IS_ALIGNED_PTR(pBuffer, sizeof(uint32_t)))
+    {
+        /* Write ulSectorCount (512 bytes block), contiguous runs are programmed in one burst */
+        if (_lx_nor_flash_sectors_write(&nor_mem_desc, (ULONG)ullSectorStart, (void *)pBuffer, ulSectorCount) != LX_SUCCESS)
+        {
+            return -RED_EIO;
+        }
+
+        /* All operations success */
+        return 0;
+    }
+
     /* Copy data pointer */
-    uint8_t *tmpBuf = pBuffer;
+    const uint8_t *tmpBuf = pBuffer;
 
     /* Copy start sector index */
     uint64_t ullTmpSector = ullSectorStart;
@@ -345,25 +410,13 @@ REDSTATUS RedOsBDevWrite(
     /* Write ulSectorCount (512 bytes block) */
     for (uint32_t ulCnt = 0; ulCnt < ulSectorCount; ulCnt++)
     {
-        /* If pointer is aligned */
-        if (IS_ALIGNED_PTR(tmpBuf, sizeof(uint32_t)))
-        {
-            /* Write 512 byte logical sector */
-            if (_lx_nor_flash_sector_write(&nor_mem_desc, ullTmpSector, tmpBuf) != LX_SUCCESS)
-            {
-                return -RED_EIO;
-            }
-        }
-        else
+        /* Copy data to aligned buffer */
+        RedMemCpy(ulBuffer, tmpBuf, sizeof(ulBuffer));
+
+        /* Write 512 byte logical sector from aligned buffer */
+        if (_lx_nor_flash_sector_write(&nor_mem_desc, ullTmpSector, ulBuffer) != LX_SUCCESS)
         {
-            /* Copy data to aligned buffer */
-            RedMemCpy(ulBuffer, tmpBuf, sizeof(ulBuffer));
-
-            /* Write 512 byte logical sector from aligned buffer */
-            if (_lx_nor_flash_sector_write(&nor_mem_desc, ullTmpSector, ulBuffer) != LX_SUCCESS)
-            {
-                return -RED_EIO;
-            }
+            return -RED_EIO;
         }
 
         /* Increase sector counter */
@@ -408,7 +461,15 @@ REDSTATUS RedOsBDevFlush(
         return -RED_EINVAL;
     }
 
-    /* Not used in this implementation*/
+#ifdef LX_NOR_ENABLE_CHECKPOINT
+    /* Transaction point: the volume is idle, let LevelX checkpoint its block
+       state once enough blocks changed. The checkpoint only shortens the next
+       mount, a failed one leaves the previous and is not a flush error. */
+    if (ini_sts == LX_INIT)
+    {
+        (void)_lx_nor_flash_checkpoint_write(&nor_mem_desc, LX_NOR_CHECKPOINT_DIRTY_BLOCKS);
+    }
+#endif
 
     /* All operations success */
     return 0;
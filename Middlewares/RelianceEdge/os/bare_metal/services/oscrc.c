@@ -0,0 +1,55 @@
+/*             ----> DO NOT REMOVE THE FOLLOWING NOTICE <----
+
+                  Copyright (c) 2014-2024 Tuxera US Inc.
+                      All Rights Reserved Worldwide.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; use version 2 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but "AS-IS," WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+/*  Businesses and individuals that for commercial or other reasons cannot
+    comply with the terms of the GPLv2 license must obtain a commercial
+    license before incorporating Reliance Edge into proprietary software
+    for distribution in any form.
+
+    Visit https://www.tuxera.com/products/reliance-edge/ for more information.
+*/
+/** @file
+    @brief Implements the CRC-32 service.
+*/
+#include <redfs.h>
+
+#if REDOSCONF_CRC_OVERRIDE == 1
+
+#include "crc_driver.h"
+
+
+/** @brief Compute a CRC32 for a buffer of aligned 32-bit words.
+
+    Called by RedCrc32Update() for the aligned part of long buffers.  The
+    result must be identical to RedCrc32UpdateSw() over the same bytes.
+
+    @param ulInitCrc32  Starting CRC value.
+    @param pulBuffer    Data buffer to calculate the CRC from, 32-bit aligned.
+    @param ulWords      Number of 32-bit words of data in the given buffer.
+
+    @return The updated CRC value.
+*/
+uint32_t RedOsCrc32Update(
+    uint32_t        ulInitCrc32,
+    const uint32_t *pulBuffer,
+    uint32_t        ulWords)
+{
+    return crc_driver_update(ulInitCrc32, pulBuffer, ulWords);
+}
+
+#endif /* REDOSCONF_CRC_OVERRIDE == 1 */
@@ -29,6 +29,12 @@
 #include <redfs.h>
 
 
+static uint32_t BitWordLoad(const uint8_t *pbBitmap, uint32_t ulWordBit, uint32_t ulEndBit);
+static uint32_t BitWordSkipSet(const uint8_t *pbBitmap, uint32_t ulWordBit, uint32_t ulEndBit);
+static uint32_t BitWordSwap(uint32_t ulWord);
+static uint32_t BitClz32(uint32_t ulWord);
+
+
 /** @brief Query the state of a bit in a bitmap.
 
     Bits are counted from most significant to least significant.  Thus, the mask
@@ -100,3 +106,298 @@ void RedBitClear(
     }
 }
 
+
+/** @brief Find the first bit which is clear in one or two bitmaps.
+
+    Bits are counted from most significant to least significant, as for
+    RedBitGet().  The bitmaps are scanned 32 bits at a time: the complement of
+    the OR of both bitmap words gives the bits which are clear in both, and the
+    first of them is located with a count of leading zeros.  Words of the first
+    bitmap with every bit set are skipped without being byte swapped.
+
+    @param pbBitmap1    Pointer to the first bitmap.
+    @param pbBitmap2    Pointer to the second bitmap, or `NULL` to search only
+                        @p pbBitmap1.
+    @param ulStartBit   The first bit to examine.
+    @param ulEndBit     One past the last bit to examine.  Bytes of the bitmaps
+                        beyond this bit are not accessed.
+
+    @return The first bit in [@p ulStartBit, @p ulEndBit) which is clear, or
+            @p ulEndBit if all of them are set.
+*/
+uint32_t RedBitFindClear(
+    const uint8_t  *pbBitmap1,
+    const uint8_t  *pbBitmap2,
+    uint32_t        ulStartBit,
+    uint32_t        ulEndBit)
+{
+    uint32_t        ulRet = ulEndBit;
+
+    if(pbBitmap1 == NULL)
+    {
+        REDERROR();
+    }
+    else
+    {
+        uint32_t    ulWordBit = ulStartBit & ~31U;
+        uint32_t    ulMask = UINT32_MAX >> (ulStartBit & 31U);
+
+        while(ulWordBit < ulEndBit)
+        {
+            uint32_t ulFree;
+            uint32_t ulSkipBit = BitWordSkipSet(pbBitmap1, ulWordBit, ulEndBit);
+
+            /*  Bits before the start bit only exist in the first word.
+            */
+            if(ulSkipBit != ulWordBit)
+            {
+                ulWordBit = ulSkipBit;
+                ulMask = UINT32_MAX;
+            }
+
+            ulFree = ~BitWordLoad(pbBitmap1, ulWordBit, ulEndBit) & ulMask;
+
+            ulMask = UINT32_MAX;
+
+            /*  The second bitmap is only loaded when the first one has clear
+                bits in this word.
+            */
+            if((ulFree != 0U) && (pbBitmap2 != NULL))
+            {
+                ulFree &= ~BitWordLoad(pbBitmap2, ulWordBit, ulEndBit);
+            }
+
+            if(ulFree != 0U)
+            {
+                ulRet = REDMIN(ulWordBit + BitClz32(ulFree), ulEndBit);
+                break;
+            }
+
+            ulWordBit += 32U;
+        }
+    }
+
+    return ulRet;
+}
+
+
+/** @brief Find the first pair of adjacent bits which are both clear.
+
+    Pair N is made of bits 2N and 2N+1, counted as for RedBitGet().  The bitmap
+    is scanned 32 bits (16 pairs) at a time: the complement of the word ANDed
+    with itself shifted by one bit leaves, at the position of the first bit of
+    each pair, a one if both bits of the pair are clear; the first such pair is
+    located with a count of leading zeros.
+
+    @param pbBitmap     Pointer to the bitmap.
+    @param ulStartPair  The first pair to examine.
+    @param ulEndPair    One past the last pair to examine.  Bytes of the bitmap
+                        beyond this pair are not accessed.
+
+    @return The first pair in [@p ulStartPair, @p ulEndPair) whose bits are
+            both clear, or @p ulEndPair if every pair has a bit set.
+*/
+uint32_t RedBitFindClearPair(
+    const uint8_t  *pbBitmap,
+    uint32_t        ulStartPair,
+    uint32_t        ulEndPair)
+{
+    uint32_t        ulRet = ulEndPair;
+
+    if(pbBitmap == NULL)
+    {
+        REDERROR();
+    }
+    else
+    {
+        uint32_t    ulEndBit = ulEndPair * 2U;
+        uint32_t    ulWordBit = (ulStartPair * 2U) & ~31U;
+        uint32_t    ulMask = UINT32_MAX >> ((ulStartPair * 2U) & 31U);
+
+        while(ulWordBit < ulEndBit)
+        {
+            uint32_t ulClear = ~BitWordLoad(pbBitmap, ulWordBit, ulEndBit);
+
+            /*  0xAAAAAAAA selects the first bit of each pair (bit zero is the
+                MSB).  Bits past the end are loaded as set, so no pair beyond
+                ulEndPair can match.
+            */
+            ulClear &= (ulClear << 1U) & 0xAAAAAAAAU & ulMask;
+
+            ulMask = UINT32_MAX;
+
+            if(ulClear != 0U)
+            {
+                ulRet = REDMIN((ulWordBit + BitClz32(ulClear)) / 2U, ulEndPair);
+                break;
+            }
+
+            ulWordBit += 32U;
+        }
+    }
+
+    return ulRet;
+}
+
+
+/** @brief Load 32 bits of a bitmap as a word, bit zero in the MSB.
+
+    Bytes which hold no bit below @p ulEndBit are not read; their bits are
+    returned as set.
+
+    @param pbBitmap     Pointer to the bitmap.
+    @param ulWordBit    The first bit of the word, a multiple of 32.
+    @param ulEndBit     One past the last valid bit.
+
+    @return The bitmap word.
+*/
+static uint32_t BitWordLoad(
+    const uint8_t  *pbBitmap,
+    uint32_t        ulWordBit,
+    uint32_t        ulEndBit)
+{
+    uint32_t        ulByte = ulWordBit >> 3U;
+    uint32_t        ulWord;
+
+    if(((ulEndBit - ulWordBit) >= 32U) && IS_ALIGNED_PTR(&pbBitmap[ulByte], sizeof(uint32_t)))
+    {
+        /*  Interior word: one aligned load, in bitmap order once swapped.
+        */
+        ulWord = BitWordSwap(*(const uint32_t *)&pbBitmap[ulByte]);
+    }
+    else if((ulEndBit - ulWordBit) >= 32U)
+    {
+        ulWord =   ((uint32_t)pbBitmap[ulByte] << 24U)
+                 | ((uint32_t)pbBitmap[ulByte + 1U] << 16U)
+                 | ((uint32_t)pbBitmap[ulByte + 2U] << 8U)
+                 |  (uint32_t)pbBitmap[ulByte + 3U];
+    }
+    else
+    {
+        uint32_t ulIdx;
+
+        ulWord = 0U;
+        for(ulIdx = 0U; ulIdx < 4U; ulIdx++)
+        {
+            uint32_t ulByteVal = UINT8_MAX;
+
+            if((ulWordBit + (ulIdx * 8U)) < ulEndBit)
+            {
+                ulByteVal = pbBitmap[ulByte + ulIdx];
+            }
+
+            ulWord = (ulWord << 8U) | ulByteVal;
+        }
+    }
+
+    return ulWord;
+}
+
+
+/** @brief Skip the words of a bitmap which have every bit set.
+
+    Whether a word is all ones does not depend on the byte order, so the words
+    are compared as loaded.  Only done when the words are aligned; the tail
+    word, shorter than 32 bits, is never skipped.
+
+    @param pbBitmap     Pointer to the bitmap.
+    @param ulWordBit    The first bit of the first word, a multiple of 32.
+    @param ulEndBit     One past the last valid bit.
+
+    @return The first bit of the first word which has a clear bit or is the
+            tail word, or @p ulWordBit if the words are not aligned.
+*/
+static uint32_t BitWordSkipSet(
+    const uint8_t  *pbBitmap,
+    uint32_t        ulWordBit,
+    uint32_t        ulEndBit)
+{
+    uint32_t        ulBit = ulWordBit;
+
+    if(IS_ALIGNED_PTR(&pbBitmap[ulBit >> 3U], sizeof(uint32_t)))
+    {
+        const uint32_t *pulWord = (const uint32_t *)&pbBitmap[ulBit >> 3U];
+
+        while(((ulEndBit - ulBit) >= 32U) && (*pulWord == UINT32_MAX))
+        {
+            pulWord++;
+            ulBit += 32U;
+        }
+    }
+
+    return ulBit;
+}
+
+
+/** @brief Put a word loaded from a bitmap in bitmap order, bit zero in the MSB.
+
+    @param ulWord   The word as loaded from memory.
+
+    @return The word with the first byte of the bitmap in the most significant
+            byte.
+*/
+static uint32_t BitWordSwap(
+    uint32_t    ulWord)
+{
+  #if REDCONF_ENDIAN_BIG == 1
+    return ulWord;
+  #elif defined(__GNUC__)
+    /*  Compiles to a single REV instruction on Cortex-M3 and later.
+    */
+    return __builtin_bswap32(ulWord);
+  #else
+    return   (ulWord << 24U)
+           | ((ulWord & 0x0000FF00U) << 8U)
+           | ((ulWord & 0x00FF0000U) >> 8U)
+           |  (ulWord >> 24U);
+  #endif
+}
+
+
+/** @brief Count the leading zero bits of a nonzero word.
+
+    @param ulWord   The word, which must not be zero.
+
+    @return The number of zero bits above the most significant set bit.
+*/
+static uint32_t BitClz32(
+    uint32_t    ulWord)
+{
+    uint32_t    ulCount;
+
+    REDASSERT(ulWord != 0U);
+
+  #if defined(__GNUC__)
+    /*  Compiles to a single CLZ instruction on Cortex-M3 and later.
+    */
+    ulCount = (uint32_t)__builtin_clz(ulWord);
+  #else
+    ulCount = 0U;
+    if((ulWord & 0xFFFF0000U) == 0U)
+    {
+        ulCount += 16U;
+        ulWord <<= 16U;
+    }
+    if((ulWord & 0xFF000000U) == 0U)
+    {
+        ulCount += 8U;
+        ulWord <<= 8U;
+    }
+    if((ulWord & 0xF0000000U) == 0U)
+    {
+        ulCount += 4U;
+        ulWord <<= 4U;
+    }
+    if((ulWord & 0xC0000000U) == 0U)
+    {
+        ulCount += 2U;
+        ulWord <<= 2U;
+    }
+    if((ulWord & 0x80000000U) == 0U)
+    {
+        ulCount += 1U;
+    }
+  #endif
+
+    return ulCount;
+}
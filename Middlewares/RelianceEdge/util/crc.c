@@ -55,7 +55,7 @@
 #define CCITT_32_POLYNOMIAL (0xEDB88320U)
 
 
-/** @brief Compute a CRC32 for the given data buffer.
+/** @brief Compute a CRC32 for the given data buffer in software.
 
     For CCITT-32 compliance, the initial CRC must be set to 0.  To CRC multiple
     buffers, call this function with the previously returned CRC value.
@@ -66,7 +66,7 @@
 
     @return The updated CRC value.
 */
-uint32_t RedCrc32Update(
+uint32_t RedCrc32UpdateSw(
     uint32_t    ulInitCrc32,
     const void *pBuffer,
     uint32_t    ulLength)
@@ -107,7 +107,7 @@ uint32_t RedCrc32Update(
 
 #elif REDCONF_CRC_ALGORITHM == CRC_SARWATE
 
-/** @brief Compute a CRC32 for the given data buffer.
+/** @brief Compute a CRC32 for the given data buffer in software.
 
     For CCITT-32 compliance, the initial CRC must be set to 0.  To CRC multiple
     buffers, call this function with the previously returned CRC value.
@@ -118,7 +118,7 @@ uint32_t RedCrc32Update(
 
     @return The updated CRC value.
 */
-uint32_t RedCrc32Update(
+uint32_t RedCrc32UpdateSw(
     uint32_t    ulInitCrc32,
     const void *pBuffer,
     uint32_t    ulLength)
@@ -187,7 +187,7 @@ uint32_t RedCrc32Update(
 #elif REDCONF_CRC_ALGORITHM == CRC_SLICEBY8
 
 
-/** @brief Compute a CRC32 for the given data buffer.
+/** @brief Compute a CRC32 for the given data buffer in software.
 
     For CCITT-32 compliance, the initial CRC must be set to 0.  To CRC multiple
     buffers, call this function with the previously returned CRC value.
@@ -198,7 +198,7 @@ uint32_t RedCrc32Update(
 
     @return The updated CRC value.
 */
-uint32_t RedCrc32Update(
+uint32_t RedCrc32UpdateSw(
     uint32_t    ulInitCrc32,
     const void *pBuffer,
     uint32_t    ulLength)
@@ -572,6 +572,71 @@ uint32_t RedCrc32Update(
 #endif
 
 
+#if (REDOSCONF_CRC_OVERRIDE == 1) && (REDCONF_ENDIAN_BIG == 1)
+#error "REDOSCONF_CRC_OVERRIDE requires a little-endian target"
+#endif
+
+
+/** @brief Compute a CRC32 for the given data buffer.
+
+    For CCITT-32 compliance, the initial CRC must be set to 0.  To CRC multiple
+    buffers, call this function with the previously returned CRC value.
+
+    If the OS services provide a CRC-32 implementation (REDOSCONF_CRC_OVERRIDE),
+    the aligned 32-bit words of buffers of at least REDOSCONF_CRC_MIN_LENGTH
+    bytes are handed to RedOsCrc32Update(); shorter buffers and the unaligned
+    bytes at either end use the software algorithm.
+
+    @param ulInitCrc32  Starting CRC value.
+    @param pBuffer      Data buffer to calculate the CRC from.
+    @param ulLength     Number of bytes of data in the given buffer.
+
+    @return The updated CRC value.
+*/
+uint32_t RedCrc32Update(
+    uint32_t    ulInitCrc32,
+    const void *pBuffer,
+    uint32_t    ulLength)
+{
+    uint32_t    ulCrc32;
+
+  #if REDOSCONF_CRC_OVERRIDE == 1
+    if((pBuffer == NULL) || (ulLength < REDOSCONF_CRC_MIN_LENGTH))
+    {
+        ulCrc32 = RedCrc32UpdateSw(ulInitCrc32, pBuffer, ulLength);
+    }
+    else
+    {
+        const uint8_t  *pbBuffer = pBuffer;
+        uint32_t        ulIdx = 0U;
+        uint32_t        ulWords;
+
+        while((ulIdx < ulLength) && !IS_ALIGNED_PTR(&pbBuffer[ulIdx], sizeof(uint32_t)))
+        {
+            ulIdx++;
+        }
+
+        ulWords = (ulLength - ulIdx) >> 2U;
+
+        ulCrc32 = RedCrc32UpdateSw(ulInitCrc32, pbBuffer, ulIdx);
+
+        /*  The cast to (const void *) placates compilers which warn when a
+            pointer is cast to a type with stricter alignment; the pointer was
+            aligned above.
+        */
+        ulCrc32 = RedOsCrc32Update(ulCrc32, (const uint32_t *)((const void *)&pbBuffer[ulIdx]), ulWords);
+        ulIdx += ulWords << 2U;
+
+        ulCrc32 = RedCrc32UpdateSw(ulCrc32, &pbBuffer[ulIdx], ulLength - ulIdx);
+    }
+  #else
+    ulCrc32 = RedCrc32UpdateSw(ulInitCrc32, pBuffer, ulLength);
+  #endif
+
+    return ulCrc32;
+}
+
+
 /** @brief Compute a CRC32 for a metadata node buffer.
 
     @param pBuffer  The metadata node buffer for which to compute a CRC.  Must
@@ -25,6 +25,19 @@
 */
 /** @file
     @brief Implements a heap for memory allocation.
+
+    The heap is a two level segregated fit (TLSF) allocator: free blocks are
+    kept in REDHEAP_FL_COUNT x REDHEAP_SL_COUNT lists, the first level indexed
+    by the power of two of the block size and the second level splitting each
+    power of two range in REDHEAP_SL_COUNT equal parts.  Two bitmaps record
+    which lists are non-empty, so that finding a fitting block, splitting it,
+    and coalescing a freed block with its physical neighbors are all constant
+    time, independent of the number of blocks in the heap.
+
+    Small blocks are additionally cached on exact-size quick lists when freed,
+    so that the common allocate/free/allocate pattern for small objects is a
+    list pop.  Cached blocks are not coalesced; they are flushed back into the
+    TLSF lists when an allocation would otherwise fail.
 */
 #include <redfs.h>
 
@@ -44,37 +57,81 @@
 
 #define REDHEAP_ALIGN_SIZE  (sizeof(void *))
 #define REDHEAP_ALIGN_MASK  (REDHEAP_ALIGN_SIZE - 1U)
+#define REDHEAP_ALIGN_LOG2  ((REDHEAP_ALIGN_SIZE == 8U) ? 3U : 2U)
 
 
-/*  Header for each memory block in the heap
+/*  Header for each memory block in the heap.  The next block in memory is
+    found from the block size, the previous one from pPrevPhys.
 */
 typedef struct sREDHEAPHDR
 {
     uint32_t            ulSentinel;     /* Sentinel with low bit allocation indicator */
     uint32_t            ulBlockSize;    /* Size of this heap allocation including header */
-    struct sREDHEAPHDR *pNext;          /* Next heap header or NULL */
-    struct sREDHEAPHDR *pPrev;          /* Previous heap header or NULL */
+    struct sREDHEAPHDR *pPrevPhys;      /* Previous heap header in memory or NULL */
 } REDHEAPHDR;
 
+/*  Free list links, stored in the payload of free and quick list blocks
+*/
+typedef struct
+{
+    REDHEAPHDR         *pNextFree;      /* Next block in the same list or NULL */
+    REDHEAPHDR         *pPrevFree;      /* Previous block in the same list or NULL */
+} REDHEAPLINKS;
+
 #define REDHEAP_HDR_SIZE            ((sizeof(REDHEAPHDR) + REDHEAP_ALIGN_MASK) & ~REDHEAP_ALIGN_MASK)
+#define REDHEAP_MIN_BLOCK_SIZE      (REDHEAP_HDR_SIZE + ((sizeof(REDHEAPLINKS) + REDHEAP_ALIGN_MASK) & ~REDHEAP_ALIGN_MASK))
 #define REDHEAP_MEM_TO_HDR(_pMem)   ((REDHEAPHDR *)((uint8_t *)(_pMem) - REDHEAP_HDR_SIZE))
 #define REDHEAP_HDR_TO_MEM(_pHdr)   (((uint8_t *)(_pHdr)) + REDHEAP_HDR_SIZE)
+#define REDHEAP_LINKS(_pHdr)        ((REDHEAPLINKS *)REDHEAP_HDR_TO_MEM(_pHdr))
+#define REDHEAP_NEXT_PHYS(_pHdr)    ((REDHEAPHDR *)((uint8_t *)(_pHdr) + (_pHdr)->ulBlockSize))
 #define REDHEAP_SENTINEL_FREE       (0xFBFCFDFEU)
 #define REDHEAP_SENTINEL_ALLOC      (REDHEAP_SENTINEL_FREE | 1U)
+#define REDHEAP_SENTINEL_QUICK      (REDHEAP_SENTINEL_FREE & ~2U)
 #define REDHEAP_IS_ALLOC(_pHdr)     ((_pHdr)->ulSentinel == REDHEAP_SENTINEL_ALLOC)
 #define REDHEAP_IS_FREE(_pHdr)      ((_pHdr)->ulSentinel == REDHEAP_SENTINEL_FREE)
 
+/*  TLSF list geometry.  Blocks smaller than REDHEAP_SMALL_BLOCK_SIZE share
+    first level list 0, one second level list per REDHEAP_ALIGN_SIZE step;
+    larger blocks land in list (log2(size) - REDHEAP_FL_SHIFT + 1).  Block
+    sizes are limited to less than 2^REDHEAP_FL_MAX bytes (16 MB), which caps
+    the usable part of the pool.
+*/
+#define REDHEAP_SL_LOG2             4U
+#define REDHEAP_SL_COUNT            (1U << REDHEAP_SL_LOG2)
+#define REDHEAP_FL_SHIFT            (REDHEAP_SL_LOG2 + REDHEAP_ALIGN_LOG2)
+#define REDHEAP_FL_MAX              24U
+#define REDHEAP_FL_COUNT            (REDHEAP_FL_MAX - REDHEAP_FL_SHIFT + 1U)
+#define REDHEAP_SMALL_BLOCK_SIZE    (1U << REDHEAP_FL_SHIFT)
+#define REDHEAP_MAX_BLOCK_SIZE      ((1U << REDHEAP_FL_MAX) - REDHEAP_ALIGN_SIZE)
+
+/*  Quick lists: freed blocks up to REDHEAP_QUICK_MAX_SIZE bytes (header
+    included) are cached by exact size, at most REDHEAP_QUICK_DEPTH per size.
+*/
+#define REDHEAP_QUICK_MAX_SIZE      128U
+#define REDHEAP_QUICK_DEPTH         8U
+#define REDHEAP_QUICK_COUNT         ((REDHEAP_QUICK_MAX_SIZE >> REDHEAP_ALIGN_LOG2) + 1U)
+#define REDHEAP_QUICK_INDEX(_ulSize) ((_ulSize) >> REDHEAP_ALIGN_LOG2)
+
 
 /*  Heap management
 */
 typedef struct
 {
     uint8_t    *pbPoolBase;         /* original pool base, never changes */
-    uint32_t    ulPoolSize;         /* original pool size, never changes */
+    uint32_t    ulPoolSize;         /* usable pool size, never changes */
     uint32_t    ulAllocBytes;       /* Bytes allocated */
     uint32_t    ulMaxAllocBytes;    /* Maximum bytes allocated */
     uint32_t    ulAllocCount;       /* Allocated headers */
     uint32_t    ulTotalCount;       /* Total headers */
+    uint32_t    ulFreeBytes;        /* Bytes in free (TLSF listed) blocks */
+    uint32_t    ulFreeCount;        /* Free (TLSF listed) headers */
+    uint32_t    ulQuickBytes;       /* Bytes cached on quick lists */
+    uint32_t    ulQuickCount;       /* Headers cached on quick lists */
+    uint32_t    ulFlBitmap;         /* Bit per non-empty first level */
+    uint32_t    aulSlBitmap[REDHEAP_FL_COUNT];  /* Bit per non-empty list */
+    REDHEAPHDR *apFree[REDHEAP_FL_COUNT][REDHEAP_SL_COUNT];
+    REDHEAPHDR *apQuick[REDHEAP_QUICK_COUNT];
+    uint8_t     abQuickDepth[REDHEAP_QUICK_COUNT];
 } REDHEAPINFO;
 
 /*  Verbosity levels for RedHeapCheck()
@@ -87,90 +144,287 @@ typedef struct
 static REDHEAPINFO gHI;
 
 
-/** @brief Initialize the memory heap subsystem.
+/** @brief Find the most significant set bit.
 
-    It must be called early in the driver initialization process, before any
-    other functions are invoked that may attempt to allocate memory.
+    @param ulWord   Non-zero word.
 
-    @param pMemBase     The address of the base of the memory pool.  This must
-                        be aligned on an REDHEAP_ALIGN_SIZE boundary.
-    @param ulMemSize    The size of the memory pool.  This value must be evenly
-                        divided by REDHEAP_ALIGN_SIZE.
+    @return Bit index, 0 for the least significant bit.
 */
-void RedHeapInit(
-    void       *pMemBase,
-    uint32_t    ulMemSize)
+static uint32_t HeapFls(
+    uint32_t    ulWord)
 {
-    REDHEAPHDR  *pHead;
-    REDHEAPHDR  *pLast;
+  #if defined(__GNUC__)
+    return 31U - (uint32_t)__builtin_clz(ulWord);
+  #else
+    uint32_t    ulBit = 31U;
 
-    REDPRINTF(1U, ("RedHeapInit() base=0x%p size=0x%lx\n", pMemBase, (unsigned long)ulMemSize));
+    while((ulWord & (1UL << ulBit)) == 0U)
+    {
+        ulBit--;
+    }
 
-    REDASSERT(pMemBase != NULL);
-    REDASSERT(IS_ALIGNED_PTR(pMemBase, REDHEAP_ALIGN_SIZE));
-    REDASSERT(ulMemSize >= (REDHEAP_HDR_SIZE * 2U));
-    REDASSERT((ulMemSize % REDHEAP_ALIGN_SIZE) == 0U);
+    return ulBit;
+  #endif
+}
 
-    RedMemSet(&gHI, 0, sizeof(gHI));
-    gHI.pbPoolBase = pMemBase;
-    gHI.ulPoolSize = ulMemSize;
-    gHI.ulTotalCount = 2U;
-    gHI.ulAllocCount = 1U;
-    gHI.ulAllocBytes = REDHEAP_HDR_SIZE;
-    gHI.ulMaxAllocBytes = gHI.ulAllocBytes;
 
-    /*  Make the first header
+/** @brief Find the least significant set bit.
+
+    @param ulWord   Non-zero word.
+
+    @return Bit index, 0 for the least significant bit.
+*/
+static uint32_t HeapFfs(
+    uint32_t    ulWord)
+{
+  #if defined(__GNUC__)
+    return (uint32_t)__builtin_ctz(ulWord);
+  #else
+    return HeapFls(ulWord & (0U - ulWord));
+  #endif
+}
+
+
+/** @brief Map a block size to the free list that holds blocks of that size.
+
+    @param ulSize   Block size, including header.
+    @param pulFl    Populated with the first level index.
+    @param pulSl    Populated with the second level index.
+*/
+static void HeapMapping(
+    uint32_t    ulSize,
+    uint32_t   *pulFl,
+    uint32_t   *pulSl)
+{
+    if(ulSize < REDHEAP_SMALL_BLOCK_SIZE)
+    {
+        *pulFl = 0U;
+        *pulSl = ulSize >> REDHEAP_ALIGN_LOG2;
+    }
+    else
+    {
+        uint32_t ulFls = HeapFls(ulSize);
+
+        *pulSl = (ulSize >> (ulFls - REDHEAP_SL_LOG2)) ^ REDHEAP_SL_COUNT;
+        *pulFl = ulFls - (REDHEAP_FL_SHIFT - 1U);
+    }
+}
+
+
+/** @brief Put a free block on the head of its free list.
+
+    @param pBlock   Free block.
+*/
+static void HeapFreeInsert(
+    REDHEAPHDR *pBlock)
+{
+    REDHEAPLINKS   *pLinks = REDHEAP_LINKS(pBlock);
+    uint32_t        ulFl;
+    uint32_t        ulSl;
+
+    HeapMapping(pBlock->ulBlockSize, &ulFl, &ulSl);
+
+    pLinks->pNextFree = gHI.apFree[ulFl][ulSl];
+    pLinks->pPrevFree = NULL;
+    if(pLinks->pNextFree != NULL)
+    {
+        REDHEAP_LINKS(pLinks->pNextFree)->pPrevFree = pBlock;
+    }
+    gHI.apFree[ulFl][ulSl] = pBlock;
+
+    gHI.aulSlBitmap[ulFl] |= 1UL << ulSl;
+    gHI.ulFlBitmap |= 1UL << ulFl;
+    gHI.ulFreeCount++;
+    gHI.ulFreeBytes += pBlock->ulBlockSize;
+}
+
+
+/** @brief Take a free block off its free list.
+
+    @param pBlock   Free block.
+*/
+static void HeapFreeRemove(
+    REDHEAPHDR *pBlock)
+{
+    REDHEAPLINKS   *pLinks = REDHEAP_LINKS(pBlock);
+    uint32_t        ulFl;
+    uint32_t        ulSl;
+
+    HeapMapping(pBlock->ulBlockSize, &ulFl, &ulSl);
+
+    if(pLinks->pNextFree != NULL)
+    {
+        REDHEAP_LINKS(pLinks->pNextFree)->pPrevFree = pLinks->pPrevFree;
+    }
+
+    if(pLinks->pPrevFree != NULL)
+    {
+        REDHEAP_LINKS(pLinks->pPrevFree)->pNextFree = pLinks->pNextFree;
+    }
+    else
+    {
+        gHI.apFree[ulFl][ulSl] = pLinks->pNextFree;
+        if(pLinks->pNextFree == NULL)
+        {
+            gHI.aulSlBitmap[ulFl] &= ~(1UL << ulSl);
+            if(gHI.aulSlBitmap[ulFl] == 0U)
+            {
+                gHI.ulFlBitmap &= ~(1UL << ulFl);
+            }
+        }
+    }
+
+    gHI.ulFreeCount--;
+    gHI.ulFreeBytes -= pBlock->ulBlockSize;
+}
+
+
+/** @brief Find a free block at least as large as the requested size.
+
+    The size is rounded up to the next list boundary, so that any block on
+    the list found is large enough and no list needs to be searched.
+
+    @param ulSize   Block size, including header.
+    @param fExact   If nothing is found that way, also search the list of
+                    @p ulSize itself for a block large enough.  That list is
+                    walked, so this is only done before failing.
+
+    @return A free block on its free list, or NULL if there is none.
+*/
+static REDHEAPHDR *HeapFreeFind(
+    uint32_t    ulSize,
+    bool        fExact)
+{
+    REDHEAPHDR *pBlock = NULL;
+    uint32_t    ulRounded = ulSize;
+    uint32_t    ulFl;
+    uint32_t    ulSl;
+    uint32_t    ulSlMap;
+
+    if(ulSize >= REDHEAP_SMALL_BLOCK_SIZE)
+    {
+        ulRounded += (1UL << (HeapFls(ulSize) - REDHEAP_SL_LOG2)) - 1U;
+    }
+
+    if(ulRounded <= REDHEAP_MAX_BLOCK_SIZE)
+    {
+        HeapMapping(ulRounded, &ulFl, &ulSl);
+
+        ulSlMap = gHI.aulSlBitmap[ulFl] & (UINT32_MAX << ulSl);
+        if(ulSlMap == 0U)
+        {
+            uint32_t ulFlMap = 0U;
+
+            if((ulFl + 1U) < REDHEAP_FL_COUNT)
+            {
+                ulFlMap = gHI.ulFlBitmap & (UINT32_MAX << (ulFl + 1U));
+            }
+
+            if(ulFlMap != 0U)
+            {
+                ulFl = HeapFfs(ulFlMap);
+                ulSlMap = gHI.aulSlBitmap[ulFl];
+            }
+        }
+
+        if(ulSlMap != 0U)
+        {
+            pBlock = gHI.apFree[ulFl][HeapFfs(ulSlMap)];
+        }
+    }
+
+    /*  Nothing on the larger lists: a block on the list of the size itself
+        may still be large enough.
     */
-    pHead = (REDHEAPHDR *)gHI.pbPoolBase;
-    pHead->ulSentinel = REDHEAP_SENTINEL_FREE;
-    pHead->ulBlockSize = ((gHI.ulPoolSize - REDHEAP_HDR_SIZE) & ~REDHEAP_ALIGN_MASK);
-    pHead->pNext = (REDHEAPHDR *)&gHI.pbPoolBase[pHead->ulBlockSize];
-    pHead->pPrev = NULL;
+    if(fExact && (pBlock == NULL) && (ulRounded != ulSize) && (ulSize <= REDHEAP_MAX_BLOCK_SIZE))
+    {
+        HeapMapping(ulSize, &ulFl, &ulSl);
 
-    /*  Now make the terminating header.  This places a sentinel at the end
-        of the heap.  Mark as allocated so it will never combine with a free
-        allocation.
+        pBlock = gHI.apFree[ulFl][ulSl];
+        while((pBlock != NULL) && (pBlock->ulBlockSize < ulSize))
+        {
+            pBlock = REDHEAP_LINKS(pBlock)->pNextFree;
+        }
+    }
+
+    return pBlock;
+}
+
+
+/** @brief Mark a free block as free and put it on its list.
+
+    Combine the block with the previous and next blocks in memory if they are
+    free, then list the result.  Quick list blocks are never combined.
+
+    @param pBlock   Block to free; not on any list.
+*/
+static void HeapBlockFree(
+    REDHEAPHDR *pBlock)
+{
+    REDHEAPHDR *pNext = REDHEAP_NEXT_PHYS(pBlock);
+    REDHEAPHDR *pPrev = pBlock->pPrevPhys;
+
+    pBlock->ulSentinel = REDHEAP_SENTINEL_FREE;
+
+    /*  Combine with the next free block
     */
-    pLast = pHead->pNext;
-    pLast->ulSentinel = REDHEAP_SENTINEL_ALLOC;
-    pLast->ulBlockSize = REDHEAP_HDR_SIZE;
-    pLast->pNext = NULL;
-    pLast->pPrev = pHead;
+    if(REDHEAP_IS_FREE(pNext))
+    {
+        HeapFreeRemove(pNext);
+        pBlock->ulBlockSize += pNext->ulBlockSize;
+        pNext->ulSentinel = ~REDHEAP_SENTINEL_FREE;
+        gHI.ulTotalCount--;
+    }
+
+    /*  Combine with the previous free block
+    */
+    if((pPrev != NULL) && REDHEAP_IS_FREE(pPrev))
+    {
+        HeapFreeRemove(pPrev);
+        pPrev->ulBlockSize += pBlock->ulBlockSize;
+        pBlock->ulSentinel = ~REDHEAP_SENTINEL_FREE;
+        gHI.ulTotalCount--;
+        pBlock = pPrev;
+    }
+
+    REDHEAP_NEXT_PHYS(pBlock)->pPrevPhys = pBlock;
+    HeapFreeInsert(pBlock);
 }
 
 
-/** @brief Mark memory block as allocated.
+/** @brief Split the tail off an allocated block and free it.
 
-    Mark memory block as allocated while also splitting the allocation if it is
-    too large.
+    The tail is only split off if it is large enough to be a block.  The
+    caller accounts for the bytes given back.
 
-    @param pBlock           Header to be allocated.
-    @param ulRequestedSize  Size to be allocated.
+    @param pBlock           Allocated block.
+    @param ulRequestedSize  Size to keep, including header.
 */
-static void HeapBlockAlloc(
+static void HeapBlockTrim(
     REDHEAPHDR *pBlock,
     uint32_t    ulRequestedSize)
 {
-    /*  Split this allocation if it is too large
-    */
-    if(pBlock->ulBlockSize > (ulRequestedSize + REDHEAP_HDR_SIZE))
+    if((pBlock->ulBlockSize - ulRequestedSize) >= REDHEAP_MIN_BLOCK_SIZE)
     {
-        REDHEAPHDR *pNext;
+        REDHEAPHDR *pTail = (REDHEAPHDR *)((uint8_t *)pBlock + ulRequestedSize);
 
-        pNext = (REDHEAPHDR *)((uint8_t *)pBlock + ulRequestedSize);
-        pNext->pNext = pBlock->pNext;
-        pNext->pNext->pPrev = pNext;
-        pNext->pPrev = pBlock;
-        pNext->pPrev->pNext = pNext;
-        pNext->ulBlockSize = pBlock->ulBlockSize - ulRequestedSize;
-        pNext->ulSentinel = REDHEAP_SENTINEL_FREE;
+        pTail->ulBlockSize = pBlock->ulBlockSize - ulRequestedSize;
+        pTail->pPrevPhys = pBlock;
+        pBlock->ulBlockSize = ulRequestedSize;
         gHI.ulTotalCount++;
 
-        pBlock->ulBlockSize = ulRequestedSize;
+        HeapBlockFree(pTail);
     }
+}
 
-    /*  Mark this block as allocated
-    */
+
+/** @brief Mark memory block as allocated.
+
+    @param pBlock   Header to be allocated; not on any list.
+*/
+static void HeapBlockAlloc(
+    REDHEAPHDR *pBlock)
+{
     pBlock->ulSentinel = REDHEAP_SENTINEL_ALLOC;
     gHI.ulAllocCount++;
     gHI.ulAllocBytes += pBlock->ulBlockSize;
@@ -181,129 +435,251 @@ static void HeapBlockAlloc(
 }
 
 
-/** @brief Allocate a block of memory.
+/** @brief Take a block from the TLSF free lists and allocate it.
 
-    Allocate a block of memory from an internal heap.
+    @param ulRequestedSize  Size to be allocated, including header.
+    @param fExact           Search the list of the size itself as well, see
+                            HeapFreeFind().
 
-    @param ulSize  Number of bytes to allocate.
-
-    @return Pointer to allocated memory or NULL on failure.
+    @return The allocated block, or NULL if no free block is large enough.
 */
-void *RedHeapAlloc(
-    uint32_t  ulSize)
+static REDHEAPHDR *HeapTlsfAlloc(
+    uint32_t    ulRequestedSize,
+    bool        fExact)
 {
-    REDHEAPHDR *pHead;
-    REDHEAPHDR *pBestBlock = NULL;
-    void       *pMem = NULL;
-    uint32_t    ulBestSize = 0U;
-    uint32_t    ulRequestedSize;
+    REDHEAPHDR *pBlock = HeapFreeFind(ulRequestedSize, fExact);
 
-    /*  Search for the best fit
-    */
-    ulRequestedSize = ((ulSize + REDHEAP_ALIGN_MASK) & ~REDHEAP_ALIGN_MASK) + REDHEAP_HDR_SIZE;
-    pHead = (REDHEAPHDR *)gHI.pbPoolBase;
-    while(pHead != NULL)
+    if(pBlock != NULL)
     {
-        /*  Determine if this free block is the best fit so far
-        */
-        if(REDHEAP_IS_FREE(pHead))
+        if(!REDHEAP_IS_FREE(pBlock))
         {
-            if((pHead->ulBlockSize >= ulRequestedSize) && ((ulBestSize == 0U) || (pHead->ulBlockSize < ulBestSize)))
-            {
-                ulBestSize = pHead->ulBlockSize;
-                pBestBlock = pHead;
-
-                /*  Early out for optimal fit
-                */
-                if(ulBestSize == ulRequestedSize)
-                {
-                    break;
-                }
-            }
+            REDPRINTF(1U, ("RedHeapAlloc() Corrupted heap, pBlock=0x%p\n", pBlock));
+            REDERROR();
+            pBlock = NULL;
         }
-        else if(!REDHEAP_IS_ALLOC(pHead))
+        else
         {
-            REDPRINTF(1U, ("RedHeapAlloc() Corrupted heap, pHead=0x%p\n", pHead));
-            REDERROR();
-            ulBestSize = 0U;
-            pBestBlock = NULL;
-            break;
+            HeapFreeRemove(pBlock);
+
+            /*  Split this allocation if it is too large.  Mark it allocated
+                first so that the tail does not combine with it again.
+            */
+            pBlock->ulSentinel = REDHEAP_SENTINEL_ALLOC;
+            HeapBlockTrim(pBlock, ulRequestedSize);
+            HeapBlockAlloc(pBlock);
         }
+    }
+
+    return pBlock;
+}
+
 
-        pHead = pHead->pNext;
+/** @brief Return every quick list block to the TLSF free lists.
+
+    Done when an allocation fails, so that cached small blocks can be combined
+    with their neighbors.
+*/
+static void HeapQuickFlush(void)
+{
+    uint32_t    ulIdx;
+
+    for(ulIdx = 0U; ulIdx < REDHEAP_QUICK_COUNT; ulIdx++)
+    {
+        while(gHI.apQuick[ulIdx] != NULL)
+        {
+            REDHEAPHDR *pBlock = gHI.apQuick[ulIdx];
+
+            gHI.apQuick[ulIdx] = REDHEAP_LINKS(pBlock)->pNextFree;
+            gHI.ulQuickCount--;
+            gHI.ulQuickBytes -= pBlock->ulBlockSize;
+
+            HeapBlockFree(pBlock);
+        }
+
+        gHI.abQuickDepth[ulIdx] = 0U;
     }
+}
+
+
+/** @brief Compute the block size needed for an allocation.
+
+    @param ulSize   Number of bytes requested by the caller.
+
+    @return Block size including header, or 0 if @p ulSize is too large.
+*/
+static uint32_t HeapRequestSize(
+    uint32_t    ulSize)
+{
+    uint32_t    ulRequestedSize = 0U;
 
-    if(ulBestSize > 0U)
+    if(ulSize <= (REDHEAP_MAX_BLOCK_SIZE - REDHEAP_HDR_SIZE))
     {
-        /*  Mark this block as allocated
-        */
-        HeapBlockAlloc(pBestBlock, ulRequestedSize);
+        ulRequestedSize = ((ulSize + REDHEAP_ALIGN_MASK) & ~REDHEAP_ALIGN_MASK) + REDHEAP_HDR_SIZE;
+        ulRequestedSize = REDMAX(ulRequestedSize, REDHEAP_MIN_BLOCK_SIZE);
+    }
 
-        /*  Determine the allocation for the caller
+    return ulRequestedSize;
+}
+
+
+/** @brief Check that a caller pointer refers to an allocated block.
+
+    @param pMem     Pointer returned by an allocation function.
+    @param pszFunc  Caller name, for debug output.
+
+    @return The block header, or NULL if @p pMem is invalid.
+*/
+static REDHEAPHDR *HeapValidate(
+    const void *pMem,
+    const char *pszFunc)
+{
+    REDHEAPHDR *pHead = NULL;
+
+    (void)pszFunc;
+
+    /*  Memory block should be within the heap
+    */
+    if(    ((const uint8_t *)pMem < &gHI.pbPoolBase[REDHEAP_HDR_SIZE])
+        || ((const uint8_t *)pMem > &gHI.pbPoolBase[gHI.ulPoolSize - REDHEAP_MIN_BLOCK_SIZE]))
+    {
+        REDPRINTF(1U, ("%s() memory outside of heap, pMem=0x%p\n", pszFunc, pMem));
+        REDERROR();
+    }
+    else
+    {
+        /*  Validate this header
         */
-        pMem = REDHEAP_HDR_TO_MEM(pBestBlock);
+        pHead = REDHEAP_MEM_TO_HDR(pMem);
+        if(pHead->ulSentinel != REDHEAP_SENTINEL_ALLOC)
+        {
+            REDPRINTF(1U, ("%s() Corrupted heap, pHead=0x%p\n", pszFunc, pHead));
+            REDERROR();
+            pHead = NULL;
+        }
     }
 
-    return pMem;
+    return pHead;
 }
 
 
-/** @brief Mark memory block as free.
-
-    Mark memory block as free then combine with the previous and next
-    allocations if they are free.
+/** @brief Initialize the memory heap subsystem.
 
-    @param pBlock Header to free
+    It must be called early in the driver initialization process, before any
+    other functions are invoked that may attempt to allocate memory.
 
-    @return If there is a previous block and it's free, returns a pointer to the
-            previous block; otherwise, returns @p pBlock.
+    @param pMemBase     The address of the base of the memory pool.  This must
+                        be aligned on an REDHEAP_ALIGN_SIZE boundary.
+    @param ulMemSize    The size of the memory pool.  This value must be evenly
+                        divided by REDHEAP_ALIGN_SIZE.  Only the first
+                        REDHEAP_MAX_BLOCK_SIZE bytes are used.
 */
-static REDHEAPHDR *HeapBlockFree(
-    REDHEAPHDR *pBlock)
+void RedHeapInit(
+    void       *pMemBase,
+    uint32_t    ulMemSize)
 {
-    REDHEAPHDR *pRet = pBlock;
+    REDHEAPHDR  *pHead;
+    REDHEAPHDR  *pLast;
 
-    /*  Mark this block as free
+    REDPRINTF(1U, ("RedHeapInit() base=0x%p size=0x%lx\n", pMemBase, (unsigned long)ulMemSize));
+
+    REDASSERT(pMemBase != NULL);
+    REDASSERT(IS_ALIGNED_PTR(pMemBase, REDHEAP_ALIGN_SIZE));
+    REDASSERT(ulMemSize >= (REDHEAP_MIN_BLOCK_SIZE + REDHEAP_HDR_SIZE));
+    REDASSERT((ulMemSize % REDHEAP_ALIGN_SIZE) == 0U);
+
+    RedMemSet(&gHI, 0, sizeof(gHI));
+    gHI.pbPoolBase = pMemBase;
+    gHI.ulPoolSize = REDMIN(ulMemSize, REDHEAP_MAX_BLOCK_SIZE + REDHEAP_HDR_SIZE) & ~REDHEAP_ALIGN_MASK;
+    gHI.ulTotalCount = 1U;
+    gHI.ulAllocCount = 1U;
+    gHI.ulAllocBytes = REDHEAP_HDR_SIZE;
+    gHI.ulMaxAllocBytes = gHI.ulAllocBytes;
+
+    /*  Make the terminating header.  This places a sentinel at the end of the
+        heap.  Mark as allocated so it will never combine with a free
+        allocation.
     */
-    pBlock->ulSentinel = REDHEAP_SENTINEL_FREE;
-    gHI.ulAllocCount--;
-    gHI.ulAllocBytes -= pBlock->ulBlockSize;
+    pLast = (REDHEAPHDR *)&gHI.pbPoolBase[gHI.ulPoolSize - REDHEAP_HDR_SIZE];
+    pLast->ulSentinel = REDHEAP_SENTINEL_ALLOC;
+    pLast->ulBlockSize = REDHEAP_HDR_SIZE;
 
-    /*  Combine with the next free block
+    /*  Now make the first header, spanning the rest of the pool
     */
-    if((pBlock->pNext != NULL) && (pBlock->pNext->ulSentinel == REDHEAP_SENTINEL_FREE))
+    pHead = (REDHEAPHDR *)gHI.pbPoolBase;
+    pHead->ulBlockSize = gHI.ulPoolSize - REDHEAP_HDR_SIZE;
+    pHead->pPrevPhys = NULL;
+    gHI.ulTotalCount++;
+
+    HeapBlockFree(pHead);
+}
+
+
+/** @brief Allocate a block of memory.
+
+    Allocate a block of memory from an internal heap.
+
+    @param ulSize  Number of bytes to allocate.
+
+    @return Pointer to allocated memory or NULL on failure.
+*/
+void *RedHeapAlloc(
+    uint32_t  ulSize)
+{
+    REDHEAPHDR *pBlock = NULL;
+    void       *pMem = NULL;
+    uint32_t    ulRequestedSize = HeapRequestSize(ulSize);
+
+    if(ulRequestedSize != 0U)
     {
-        REDHEAPHDR *pNext = pBlock->pNext;
+        /*  Fast path: a cached block of exactly this size
+        */
+        if(ulRequestedSize <= REDHEAP_QUICK_MAX_SIZE)
+        {
+            uint32_t ulIdx = REDHEAP_QUICK_INDEX(ulRequestedSize);
 
-        pBlock->ulBlockSize += pNext->ulBlockSize;
-        pBlock->pNext = pNext->pNext;
-        if(pBlock->pNext != NULL)
+            pBlock = gHI.apQuick[ulIdx];
+            if(pBlock != NULL)
+            {
+                gHI.apQuick[ulIdx] = REDHEAP_LINKS(pBlock)->pNextFree;
+                gHI.abQuickDepth[ulIdx]--;
+                gHI.ulQuickCount--;
+                gHI.ulQuickBytes -= pBlock->ulBlockSize;
+
+                HeapBlockAlloc(pBlock);
+            }
+        }
+
+        if(pBlock == NULL)
         {
-            pBlock->pNext->pPrev = pBlock;
+            pBlock = HeapTlsfAlloc(ulRequestedSize, false);
         }
-        pNext->ulSentinel = ~REDHEAP_SENTINEL_FREE;
-        gHI.ulTotalCount--;
-    }
 
-    /*  Combine with the previous free block
-    */
-    if((pBlock->pPrev != NULL) && (pBlock->pPrev->ulSentinel == REDHEAP_SENTINEL_FREE))
-    {
-        REDHEAPHDR *pPrev = pBlock->pPrev;
+        /*  Out of memory, or fragmented by cached blocks: give the quick lists
+            back and try once more.
+        */
+        if((pBlock == NULL) && (gHI.ulQuickCount > 0U))
+        {
+            HeapQuickFlush();
+            pBlock = HeapTlsfAlloc(ulRequestedSize, false);
+        }
 
-        pPrev->ulBlockSize += pBlock->ulBlockSize;
-        pPrev->pNext = pBlock->pNext;
-        if(pPrev->pNext != NULL)
+        /*  Last resort, once the cached blocks are combined: a block of the
+            right list which the rounded search skipped.
+        */
+        if(pBlock == NULL)
         {
-            pPrev->pNext->pPrev = pPrev;
+            pBlock = HeapTlsfAlloc(ulRequestedSize, true);
         }
-        pBlock->ulSentinel = ~REDHEAP_SENTINEL_FREE;
-        gHI.ulTotalCount--;
+    }
 
-        pRet = pPrev;
+    if(pBlock != NULL)
+    {
+        /*  Determine the allocation for the caller
+        */
+        pMem = REDHEAP_HDR_TO_MEM(pBlock);
     }
 
-    return pRet;
+    return pMem;
 }
 
 
@@ -325,11 +701,10 @@ void *RedHeapRealloc(
     void       *pMem,
     uint32_t    ulSize)
 {
-    REDHEAPHDR *pHead;
     REDHEAPHDR *pCurrent;
-    REDHEAPHDR *pBestBlock;
-    uint32_t    ulBestSize;
+    REDHEAPHDR *pNext;
     uint32_t    ulRequestedSize;
+    uint32_t    ulOldSize;
     void       *pNewMem = NULL;
 
     /*  Specifying a new size of zero indicates that the memory block should be
@@ -341,144 +716,52 @@ void *RedHeapRealloc(
         return NULL;
     }
 
-    /*  Memory block being freed should be within the heap
-    */
-    if(    ((uint8_t *)pMem < &gHI.pbPoolBase[REDHEAP_HDR_SIZE])
-        || ((uint8_t *)pMem >= &gHI.pbPoolBase[gHI.ulPoolSize - (REDHEAP_HDR_SIZE * 2U)]))
-    {
-        REDPRINTF(1U, ("RedHeapRealloc() memory outside of heap, pMem=0x%p\n", pMem));
-        REDERROR();
-        return NULL;
-    }
-
-    /*  Validate this header
-    */
-    pCurrent = REDHEAP_MEM_TO_HDR(pMem);
-    if(pCurrent->ulSentinel != REDHEAP_SENTINEL_ALLOC)
+    pCurrent = HeapValidate(pMem, "RedHeapRealloc");
+    ulRequestedSize = HeapRequestSize(ulSize);
+    if((pCurrent == NULL) || (ulRequestedSize == 0U))
     {
-        REDPRINTF(1U, ("RedHeapRealloc() Corrupted heap, pCurrent=0x%p\n", pCurrent));
-        REDERROR();
         return NULL;
     }
 
-    /*  For the moment, assume that the best memory block is the current block.
-    */
-    pBestBlock = pCurrent;
-    ulBestSize = pCurrent->ulBlockSize;
-
-    /*  Account for the merger of the previous and next memory blocks.
+    /*  Grow in place by absorbing the next block when it is free and large
+        enough.
     */
-    if((pCurrent->pNext != NULL) && (pCurrent->pNext->ulSentinel == REDHEAP_SENTINEL_FREE))
+    ulOldSize = pCurrent->ulBlockSize;
+    pNext = REDHEAP_NEXT_PHYS(pCurrent);
+    if(    (ulRequestedSize > pCurrent->ulBlockSize)
+        && REDHEAP_IS_FREE(pNext)
+        && ((pCurrent->ulBlockSize + pNext->ulBlockSize) >= ulRequestedSize))
     {
-        ulBestSize += pCurrent->pNext->ulBlockSize;
-    }
-    if((pCurrent->pPrev != NULL) && (pCurrent->pPrev->ulSentinel == REDHEAP_SENTINEL_FREE))
-    {
-        ulBestSize += pCurrent->pPrev->ulBlockSize;
-        pBestBlock = pCurrent->pPrev;
-    }
-
-    /*  Ensure the obtimistic best fit actually fits
-    */
-    ulRequestedSize = ((ulSize + REDHEAP_ALIGN_MASK) & ~REDHEAP_ALIGN_MASK) + REDHEAP_HDR_SIZE;
-    if(ulBestSize < ulRequestedSize)
-    {
-        pBestBlock = NULL;
-        ulBestSize = 0U;
+        HeapFreeRemove(pNext);
+        pCurrent->ulBlockSize += pNext->ulBlockSize;
+        pNext->ulSentinel = ~REDHEAP_SENTINEL_FREE;
+        REDHEAP_NEXT_PHYS(pCurrent)->pPrevPhys = pCurrent;
+        gHI.ulTotalCount--;
     }
 
-    /*  Search for the best fit
-    */
-    pHead = (REDHEAPHDR *)gHI.pbPoolBase;
-    while(pHead != NULL)
+    if(ulRequestedSize <= pCurrent->ulBlockSize)
     {
-        /*  Skip over the best block which could be part of a future merge
+        /*  Resize in place, giving back the tail if it is large enough
         */
-        if(pHead == pBestBlock)
+        HeapBlockTrim(pCurrent, ulRequestedSize);
+        gHI.ulAllocBytes = (gHI.ulAllocBytes - ulOldSize) + pCurrent->ulBlockSize;
+        if(gHI.ulAllocBytes > gHI.ulMaxAllocBytes)
         {
-            pHead = (REDHEAPHDR *)((uint8_t *)pBestBlock + ulBestSize);
-            continue;
-        }
-
-        /*  Determine if this free block is the best fit so far
-        */
-        if(REDHEAP_IS_FREE(pHead))
-        {
-            if((pHead->ulBlockSize >= ulRequestedSize) && ((ulBestSize == 0U) || (pHead->ulBlockSize < ulBestSize)))
-            {
-                pBestBlock = pHead;
-                ulBestSize = pHead->ulBlockSize;
-
-                /*  Early out for optimal fit
-                */
-                if(ulBestSize == ulRequestedSize)
-                {
-                    break;
-                }
-            }
+            gHI.ulMaxAllocBytes = gHI.ulAllocBytes;
         }
-        else if(!REDHEAP_IS_ALLOC(pHead))
-        {
-            REDPRINTF(1U, ("RedHeapRealloc() Corrupted heap, pHead=0x%p\n", pHead));
-            REDERROR();
-            ulBestSize = 0;
-            pBestBlock = NULL;
-            break;
-        }
-
-        pHead = pHead->pNext;
+        pNewMem = pMem;
     }
-
-    if(ulBestSize > 0U)
+    else
     {
-        uint32_t ulCopySize = REDMIN(ulSize, pCurrent->ulBlockSize - REDHEAP_HDR_SIZE);
-
-        if((pBestBlock == pCurrent) || (pBestBlock == pCurrent->pPrev))
+        pNewMem = RedHeapAlloc(ulSize);
+        if(pNewMem != NULL)
         {
-            uint8_t *pbDst;
-            uint8_t *pbSrc = REDHEAP_HDR_TO_MEM(pCurrent);
-
-            /*  Combine neighboring blocks
+            /*  Copy the user data from the old block to the new block, then
+                free the old block.
             */
-            pBestBlock = HeapBlockFree(pCurrent);
-
-            /*  Copy user data from the old location to the new location
-            */
-            pbDst = REDHEAP_HDR_TO_MEM(pBestBlock);
-            if(pbDst != pbSrc)
-            {
-                if((pbSrc >= pbDst) && (pbSrc < &pbDst[ulCopySize]))
-                {
-                    RedMemMove(pbDst, pbSrc, ulCopySize);
-                }
-                else
-                {
-                    RedMemCpy(pbDst, pbSrc, ulCopySize);
-                }
-            }
-
-            /*  Split this allocation if it is too large
-            */
-            HeapBlockAlloc(pBestBlock, ulRequestedSize);
+            RedMemCpy(pNewMem, pMem, pCurrent->ulBlockSize - REDHEAP_HDR_SIZE);
+            RedHeapFree(pMem);
         }
-        else
-        {
-            /*  Copy the user data from the old block to the new block
-            */
-            RedMemCpy(REDHEAP_HDR_TO_MEM(pBestBlock), REDHEAP_HDR_TO_MEM(pCurrent), ulCopySize);
-
-            /*  Allocate the new block
-            */
-            HeapBlockAlloc(pBestBlock, ulRequestedSize);
-
-            /*  Free the old block
-            */
-            HeapBlockFree(pCurrent);
-        }
-
-        /*  Determine the allocation for the caller
-        */
-        pNewMem = REDHEAP_HDR_TO_MEM(pBestBlock);
     }
 
     return pNewMem;
@@ -494,50 +777,61 @@ void *RedHeapRealloc(
 void RedHeapFree(
     void       *pMem)
 {
-    REDHEAPHDR *pHead;
+    REDHEAPHDR *pHead = HeapValidate(pMem, "RedHeapFree");
 
-    /*  Memory block being freed should be within the heap
-    */
-    if(    ((uint8_t *)pMem < &gHI.pbPoolBase[REDHEAP_HDR_SIZE])
-        || ((uint8_t *)pMem >= &gHI.pbPoolBase[gHI.ulPoolSize - (REDHEAP_HDR_SIZE * 2U)]))
+    if(pHead != NULL)
     {
-        REDPRINTF(1U, ("RedHeapFree() memory outside of heap, pMem=0x%p\n", pMem));
-        REDERROR();
-        return;
-    }
+        uint32_t ulIdx = REDHEAP_QUICK_INDEX(pHead->ulBlockSize);
 
-    /*  Validate this header
-    */
-    pHead = REDHEAP_MEM_TO_HDR(pMem);
-    if(pHead->ulSentinel != REDHEAP_SENTINEL_ALLOC)
-    {
-        REDPRINTF(1U, ("RedHeapFree() Corrupted heap, pHead=0x%p\n", pHead));
-        REDERROR();
-        return;
-    }
+        gHI.ulAllocCount--;
+        gHI.ulAllocBytes -= pHead->ulBlockSize;
 
-    /*  Mark this block as free
-    */
-    HeapBlockFree(pHead);
+        if(    (pHead->ulBlockSize <= REDHEAP_QUICK_MAX_SIZE)
+            && (gHI.abQuickDepth[ulIdx] < REDHEAP_QUICK_DEPTH)
+            && !REDHEAP_IS_FREE(REDHEAP_NEXT_PHYS(pHead))
+            && ((pHead->pPrevPhys == NULL) || !REDHEAP_IS_FREE(pHead->pPrevPhys)))
+        {
+            /*  Cache the block for the next allocation of this size.  Blocks
+                with a free neighbor are combined instead, so that caching does
+                not keep free space split.
+            */
+            pHead->ulSentinel = REDHEAP_SENTINEL_QUICK;
+            REDHEAP_LINKS(pHead)->pNextFree = gHI.apQuick[ulIdx];
+            gHI.apQuick[ulIdx] = pHead;
+            gHI.abQuickDepth[ulIdx]++;
+            gHI.ulQuickCount++;
+            gHI.ulQuickBytes += pHead->ulBlockSize;
+        }
+        else
+        {
+            /*  Mark this block as free
+            */
+            HeapBlockFree(pHead);
+        }
+    }
 }
 
 
 /** @brief Get heap stats.
 
     Get heap stats for number of bytes allocated, number of allocation headers,
-    and total number of headers.
+    total number of headers and, optionally, fragmentation.
 
     @param pulAllocBytes    Address to record the number of bytes allocated.
     @param pulMaxAllocBytes Address to record the Maximum number of bytes
                             allocated.
     @param pulAllocHdr      Address to record the allocated headers.
     @param pulTotalHdr      Address to record the total headers.
+    @param pFrag            Address to record free space and fragmentation
+                            statistics.  Finding the largest free block walks
+                            one free list.
 */
 void RedHeapStats(
-    uint32_t *pulAllocBytes,
-    uint32_t *pulMaxAllocBytes,
-    uint32_t *pulAllocHdr,
-    uint32_t *pulTotalHdr)
+    uint32_t       *pulAllocBytes,
+    uint32_t       *pulMaxAllocBytes,
+    uint32_t       *pulAllocHdr,
+    uint32_t       *pulTotalHdr,
+    REDHEAPFRAG    *pFrag)
 {
     if(pulAllocBytes != NULL)
     {
@@ -555,13 +849,36 @@ void RedHeapStats(
     {
         *pulTotalHdr = gHI.ulTotalCount;
     }
+    if(pFrag != NULL)
+    {
+        pFrag->ulFreeBytes = gHI.ulFreeBytes;
+        pFrag->ulFreeBlocks = gHI.ulFreeCount;
+        pFrag->ulQuickBytes = gHI.ulQuickBytes;
+        pFrag->ulQuickBlocks = gHI.ulQuickCount;
+        pFrag->ulLargestFree = 0U;
+
+        /*  The largest free block is on the highest non-empty list
+        */
+        if(gHI.ulFlBitmap != 0U)
+        {
+            uint32_t    ulFl = HeapFls(gHI.ulFlBitmap);
+            REDHEAPHDR *pBlock = gHI.apFree[ulFl][HeapFls(gHI.aulSlBitmap[ulFl])];
+
+            while(pBlock != NULL)
+            {
+                pFrag->ulLargestFree = REDMAX(pFrag->ulLargestFree, pBlock->ulBlockSize - REDHEAP_HDR_SIZE);
+                pBlock = REDHEAP_LINKS(pBlock)->pNextFree;
+            }
+        }
+    }
 }
 
 
 /** @brief Check the state of the heap.
 
     Check the state of the heap while optionally displaying each heap header
-    and/or a heap summary.
+    and/or a heap summary.  Besides the blocks in memory order, the free lists,
+    their bitmaps and the quick lists are checked.
 
     @note This function is always silent, regardless of @p bVerbosity, when
           heap debugging is disabled.
@@ -575,28 +892,48 @@ int32_t RedHeapCheck(
     uint8_t     bVerbosity)
 {
     REDHEAPHDR *pHead;
+    REDHEAPHDR *pPrev = NULL;
+    REDHEAPHDR *pLast = (REDHEAPHDR *)&gHI.pbPoolBase[gHI.ulPoolSize - REDHEAP_HDR_SIZE];
     bool        fCorrupt = false;
     uint32_t    ulAllocated = 0U;
     uint32_t    ulFree = 0U;
+    uint32_t    ulQuick = 0U;
     uint32_t    ulBytesFree = 0U;
+    uint32_t    ulBytesQuick = 0U;
     uint32_t    ulBytesAllocated = 0U;
+    uint32_t    ulListed = 0U;
+    uint32_t    ulFl;
+    uint32_t    ulSl;
 
-    /*  Traverse the allocation list
+    /*  Traverse the blocks in memory order
     */
     pHead = (REDHEAPHDR *)gHI.pbPoolBase;
     while(pHead != NULL)
     {
         if(bVerbosity >= RED_HEAP_VERBOSITY_HEADERS)
         {
-            REDPRINTF(1U, ("RedHeapCheck() Address=0x%p Next=0x%p Prev=0x%p Sentinel=0x%x Size=0x%lx\n",
-                pHead, pHead->pNext, pHead->pPrev, (unsigned)pHead->ulSentinel, (unsigned long)pHead->ulBlockSize));
+            REDPRINTF(1U, ("RedHeapCheck() Address=0x%p PrevPhys=0x%p Sentinel=0x%x Size=0x%lx\n",
+                pHead, pHead->pPrevPhys, (unsigned)pHead->ulSentinel, (unsigned long)pHead->ulBlockSize));
         }
 
         if(pHead->ulSentinel == REDHEAP_SENTINEL_FREE)
         {
+            /*  Free neighbors must have been combined
+            */
+            if((pPrev != NULL) && REDHEAP_IS_FREE(pPrev))
+            {
+                fCorrupt = true;
+                break;
+            }
+
             ulFree++;
             ulBytesFree += pHead->ulBlockSize;
         }
+        else if(pHead->ulSentinel == REDHEAP_SENTINEL_QUICK)
+        {
+            ulQuick++;
+            ulBytesQuick += pHead->ulBlockSize;
+        }
         else if(pHead->ulSentinel == REDHEAP_SENTINEL_ALLOC)
         {
             ulAllocated++;
@@ -608,30 +945,88 @@ int32_t RedHeapCheck(
             break;
         }
 
-        if((pHead->pNext != NULL) && (pHead->pNext->pPrev != pHead))
+        if(pHead->pPrevPhys != pPrev)
         {
             fCorrupt = true;
             break;
         }
-        if((pHead->pPrev != NULL) && (pHead->pPrev->pNext != pHead))
+
+        if(pHead == pLast)
         {
-            fCorrupt = true;
             break;
         }
-        if((pHead->pNext != NULL) && ((uint32_t)((uint8_t *)pHead->pNext - (uint8_t *)pHead) != pHead->ulBlockSize))
+
+        if(    ((pHead->ulBlockSize & REDHEAP_ALIGN_MASK) != 0U)
+            || (pHead->ulBlockSize < REDHEAP_MIN_BLOCK_SIZE)
+            || (pHead->ulBlockSize > (uint32_t)((uint8_t *)pLast - (uint8_t *)pHead)))
         {
             fCorrupt = true;
             break;
         }
 
-        pHead = pHead->pNext;
+        pPrev = pHead;
+        pHead = REDHEAP_NEXT_PHYS(pHead);
+    }
+
+    /*  Every free block must be on the list its size maps to, and the bitmaps
+        must match the lists.
+    */
+    for(ulFl = 0U; (ulFl < REDHEAP_FL_COUNT) && !fCorrupt; ulFl++)
+    {
+        fCorrupt |= ((gHI.ulFlBitmap >> ulFl) & 1U) != ((gHI.aulSlBitmap[ulFl] != 0U) ? 1U : 0U);
+
+        for(ulSl = 0U; (ulSl < REDHEAP_SL_COUNT) && !fCorrupt; ulSl++)
+        {
+            REDHEAPHDR *pBlock = gHI.apFree[ulFl][ulSl];
+            REDHEAPHDR *pPrevFree = NULL;
+
+            fCorrupt |= ((gHI.aulSlBitmap[ulFl] >> ulSl) & 1U) != ((pBlock != NULL) ? 1U : 0U);
+
+            while((pBlock != NULL) && !fCorrupt)
+            {
+                uint32_t ulBlockFl;
+                uint32_t ulBlockSl;
+
+                HeapMapping(pBlock->ulBlockSize, &ulBlockFl, &ulBlockSl);
+                fCorrupt |= !REDHEAP_IS_FREE(pBlock);
+                fCorrupt |= (ulBlockFl != ulFl) || (ulBlockSl != ulSl);
+                fCorrupt |= REDHEAP_LINKS(pBlock)->pPrevFree != pPrevFree;
+                fCorrupt |= ulListed >= ulFree;
+                ulListed++;
+
+                pPrevFree = pBlock;
+                pBlock = REDHEAP_LINKS(pBlock)->pNextFree;
+            }
+        }
+    }
+
+    /*  Quick lists hold blocks of exactly their size
+    */
+    for(ulFl = 0U; (ulFl < REDHEAP_QUICK_COUNT) && !fCorrupt; ulFl++)
+    {
+        REDHEAPHDR *pBlock = gHI.apQuick[ulFl];
+        uint32_t    ulDepth = 0U;
+
+        while((pBlock != NULL) && !fCorrupt)
+        {
+            fCorrupt |= pBlock->ulSentinel != REDHEAP_SENTINEL_QUICK;
+            fCorrupt |= REDHEAP_QUICK_INDEX(pBlock->ulBlockSize) != ulFl;
+            fCorrupt |= ulDepth >= REDHEAP_QUICK_DEPTH;
+            ulDepth++;
+
+            pBlock = REDHEAP_LINKS(pBlock)->pNextFree;
+        }
+
+        fCorrupt |= ulDepth != gHI.abQuickDepth[ulFl];
     }
 
     if(!fCorrupt)
     {
         fCorrupt |= ulBytesAllocated != gHI.ulAllocBytes;
         fCorrupt |= ulAllocated != gHI.ulAllocCount;
-        fCorrupt |= ulFree != (gHI.ulTotalCount - gHI.ulAllocCount);
+        fCorrupt |= (ulFree + ulQuick) != (gHI.ulTotalCount - gHI.ulAllocCount);
+        fCorrupt |= (ulListed != ulFree) || (ulFree != gHI.ulFreeCount) || (ulBytesFree != gHI.ulFreeBytes);
+        fCorrupt |= (ulQuick != gHI.ulQuickCount) || (ulBytesQuick != gHI.ulQuickBytes);
     }
 
     if(fCorrupt)
@@ -641,8 +1036,9 @@ int32_t RedHeapCheck(
     }
     else if(bVerbosity >= RED_HEAP_VERBOSITY_SUMMARY)
     {
-        REDPRINTF(1U, ("Heap Summary: BlocksAllocated=%3lu BlocksFree=%3lu BytesAllocated=%6lu BytesFree=%6lu\n",
-            (unsigned long)ulAllocated, (unsigned long)ulFree, (unsigned long)ulBytesAllocated, (unsigned long)ulBytesFree));
+        REDPRINTF(1U, ("Heap Summary: BlocksAllocated=%3lu BlocksFree=%3lu BlocksQuick=%3lu BytesAllocated=%6lu BytesFree=%6lu BytesQuick=%6lu\n",
+            (unsigned long)ulAllocated, (unsigned long)ulFree, (unsigned long)ulQuick,
+            (unsigned long)ulBytesAllocated, (unsigned long)ulBytesFree, (unsigned long)ulBytesQuick));
     }
 
     return fCorrupt ? -1 : 0;
@@ -47,6 +47,12 @@ extern "C" {
 #define MSC_MEDIA_PACKET             512U
 #endif /* MSC_MEDIA_PACKET */
 
+/* Media transfer run by MSC_BOT_Process (media_state) */
+#define MSC_MEDIA_IDLE               0U
+#define MSC_MEDIA_READ               1U
+#define MSC_MEDIA_WRITE              2U
+#define MSC_MEDIA_UNMAP              3U
+
 #define MSC_MAX_FS_PACKET            0x40U
 #define MSC_MAX_HS_PACKET            0x200U
 
@@ -79,6 +85,8 @@ typedef struct _USBD_STORAGE
   int8_t (* Write)(uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t blk_len);
   int8_t (* GetMaxLun)(void);
   int8_t *pInquiry;
+  int8_t (* Release)(uint8_t lun, uint32_t blk_addr, uint32_t blk_len); /* Optional (UNMAP), may be NULL */
+  int8_t (* Eject)(uint8_t lun);                                         /* Optional (START STOP UNIT eject), may be NULL */
 
 } USBD_StorageTypeDef;
 
@@ -104,6 +112,18 @@ typedef struct
 
   uint32_t                 scsi_blk_addr;
   uint32_t                 scsi_blk_len;
+
+  /* Ping-pong media buffers: bot_data and bot_data_alt take turns on the
+     wire and in the storage Read/Write, see SCSI_ProcessMedia */
+  uint8_t                  bot_data_alt[MSC_MEDIA_PACKET];
+  __IO uint8_t             media_state;     /* MSC_MEDIA_xxx, set last when a transfer starts */
+  __IO uint8_t             media_wire_done; /* Set by the endpoint callback, cleared by MSC_BOT_Process */
+  uint8_t                  media_wire_busy; /* A buffer is armed on the endpoint */
+  uint8_t                  media_wire_idx;  /* Buffer on (or next to go on) the wire */
+  uint8_t                  media_io_idx;    /* Buffer next read into / committed by the storage */
+  uint8_t                  media_ready;     /* Buffers waiting to be sent / committed */
+  uint32_t                 media_wire_left; /* Bytes the host has still to send (WRITE, UNMAP) */
+  uint32_t                 media_len[2];    /* Bytes held by each buffer */
 } USBD_MSC_BOT_HandleTypeDef;
 
 /* Structure for MSC process */
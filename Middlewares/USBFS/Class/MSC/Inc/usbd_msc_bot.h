@@ -127,6 +127,8 @@ void MSC_BOT_SendCSW(USBD_HandleTypeDef  *pdev,
 
 void  MSC_BOT_CplClrFeature(USBD_HandleTypeDef  *pdev,
                             uint8_t epnum);
+
+void MSC_BOT_Process(USBD_HandleTypeDef  *pdev);
 /**
   * @}
   */
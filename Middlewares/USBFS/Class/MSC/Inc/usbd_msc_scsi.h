@@ -71,6 +71,7 @@ extern "C" {
 #define SCSI_VERIFY16                               0x8FU
 
 #define SCSI_SEND_DIAGNOSTIC                        0x1DU
+#define SCSI_UNMAP                                  0x42U
 #define SCSI_READ_FORMAT_CAPACITIES                 0x23U
 
 #define NO_SENSE                                    0U
@@ -155,6 +156,7 @@ typedef struct _SENSE_ITEM
   * @{
   */
 int8_t SCSI_ProcessCmd(USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t *cmd);
+int8_t SCSI_ProcessMedia(USBD_HandleTypeDef *pdev, uint8_t lun);
 
 void SCSI_SenseCode(USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t sKey,
                     uint8_t ASC);
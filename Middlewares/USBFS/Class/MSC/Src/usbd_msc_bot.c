@@ -112,6 +112,7 @@ void MSC_BOT_Init(USBD_HandleTypeDef *pdev)
 
   hmsc->bot_state = USBD_BOT_IDLE;
   hmsc->bot_status = USBD_BOT_STATUS_NORMAL;
+  hmsc->media_state = MSC_MEDIA_IDLE;
 
   hmsc->scsi_sense_tail = 0U;
   hmsc->scsi_sense_head = 0U;
@@ -150,6 +151,7 @@ void MSC_BOT_Reset(USBD_HandleTypeDef *pdev)
 
   hmsc->bot_state  = USBD_BOT_IDLE;
   hmsc->bot_status = USBD_BOT_STATUS_RECOVERY;
+  hmsc->media_state = MSC_MEDIA_IDLE;
 
   (void)USBD_LL_ClearStallEP(pdev, MSCInEpAdd);
   (void)USBD_LL_ClearStallEP(pdev, MSCOutEpAdd);
@@ -172,6 +174,7 @@ void MSC_BOT_DeInit(USBD_HandleTypeDef  *pdev)
   if (hmsc != NULL)
   {
     hmsc->bot_state = USBD_BOT_IDLE;
+    hmsc->media_state = MSC_MEDIA_IDLE;
   }
 }
 
@@ -196,10 +199,8 @@ void MSC_BOT_DataIn(USBD_HandleTypeDef *pdev, uint8_t epnum)
   switch (hmsc->bot_state)
   {
     case USBD_BOT_DATA_IN:
-      if (SCSI_ProcessCmd(pdev, hmsc->cbw.bLUN, &hmsc->cbw.CB[0]) < 0)
-      {
-        MSC_BOT_SendCSW(pdev, USBD_CSW_CMD_FAILED);
-      }
+      /* Media buffer sent: MSC_BOT_Process queues the next one */
+      hmsc->media_wire_done = 1U;
       break;
 
     case USBD_BOT_SEND_DATA:
@@ -236,10 +237,19 @@ void MSC_BOT_DataOut(USBD_HandleTypeDef *pdev, uint8_t epnum)
       break;
 
     case USBD_BOT_DATA_OUT:
-      if (SCSI_ProcessCmd(pdev, hmsc->cbw.bLUN, &hmsc->cbw.CB[0]) < 0)
+      if (hmsc->media_state != MSC_MEDIA_IDLE)
+      {
+        /* Media buffer received: MSC_BOT_Process commits it */
+        hmsc->media_wire_done = 1U;
+      }
+      else if (SCSI_ProcessCmd(pdev, hmsc->cbw.bLUN, &hmsc->cbw.CB[0]) < 0)
       {
         MSC_BOT_SendCSW(pdev, USBD_CSW_CMD_FAILED);
       }
+      else
+      {
+        /* Nothing to do */
+      }
       break;
 
     default:
@@ -462,6 +472,48 @@ void  MSC_BOT_CplClrFeature(USBD_HandleTypeDef *pdev, uint8_t epnum)
     return;
   }
 }
+
+/**
+  * @brief  MSC_BOT_Process
+  *         Run the storage side of a READ/WRITE/UNMAP data stage. Called
+  *         from the main loop, not from the USB interrupt: while a media
+  *         buffer is on the wire the other one is read from / committed to
+  *         the storage, and the PCD keeps refilling the FIFO meanwhile.
+  * @param  pdev: device instance
+  * @retval None
+  */
+void MSC_BOT_Process(USBD_HandleTypeDef *pdev)
+{
+  USBD_MSC_BOT_HandleTypeDef *hmsc = (USBD_MSC_BOT_HandleTypeDef *)pdev->pClassDataCmsit[pdev->classId];
+  int8_t ret;
+
+  if ((hmsc == NULL) || (hmsc->media_state == MSC_MEDIA_IDLE))
+  {
+    return;
+  }
+
+  ret = SCSI_ProcessMedia(pdev, hmsc->cbw.bLUN);
+
+  if (ret > 0)
+  {
+    MSC_BOT_SendCSW(pdev, USBD_CSW_CMD_PASSED);
+  }
+  else if (ret < 0)
+  {
+    if (hmsc->bot_state == USBD_BOT_NO_DATA)
+    {
+      MSC_BOT_SendCSW(pdev, USBD_CSW_CMD_FAILED);
+    }
+    else
+    {
+      MSC_BOT_Abort(pdev);
+    }
+  }
+  else
+  {
+    /* Data stage still running */
+  }
+}
 /**
   * @}
   */
@@ -72,7 +72,9 @@ uint8_t MSC_Page00_Inquiry_Data[LENGTH_INQUIRY_PAGE00] =
   0x00,
   (LENGTH_INQUIRY_PAGE00 - 4U),
   0x00,
-  0x80
+  0x80,
+  0xB0,
+  0xB2
 };
 
 /* USB Mass storage VPD Page 0x80 Inquiry Data for Unit Serial Number */
@@ -88,6 +90,46 @@ uint8_t MSC_Page80_Inquiry_Data[LENGTH_INQUIRY_PAGE80] =
   0x20
 };
 
+/* USB Mass storage VPD Page 0xB0 Inquiry Data for Block Limits:
+   unlimited UNMAP LBA count, as many UNMAP descriptors as fit in MSC_MEDIA_PACKET */
+uint8_t MSC_PageB0_Inquiry_Data[LENGTH_INQUIRY_PAGEB0] =
+{
+  0x00,
+  0xB0,
+  0x00,
+  (LENGTH_INQUIRY_PAGEB0 - 4U),
+  0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00,
+  0xFF, 0xFF, 0xFF, 0xFF,                                 /* Maximum UNMAP LBA count */
+  0x00, 0x00,
+  (uint8_t)(((MSC_MEDIA_PACKET - 8U) / 16U) >> 8),
+  (uint8_t)((MSC_MEDIA_PACKET - 8U) / 16U),                /* Maximum UNMAP block descriptor count */
+  0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00
+};
+
+/* USB Mass storage VPD Page 0xB2 Inquiry Data for Logical Block Provisioning (LBPU: UNMAP supported) */
+uint8_t MSC_PageB2_Inquiry_Data[LENGTH_INQUIRY_PAGEB2] =
+{
+  0x00,
+  0xB2,
+  0x00,
+  (LENGTH_INQUIRY_PAGEB2 - 4U),
+  0x00,
+  0x80,
+  0x00,
+  0x00
+};
+
 /* USB Mass storage sense 6 Data */
 uint8_t MSC_Mode_Sense6_data[MODE_SENSE6_LEN] =
 {
@@ -92,11 +92,15 @@ static int8_t SCSI_Write12(USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t *param
 static int8_t SCSI_Read10(USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t *params);
 static int8_t SCSI_Read12(USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t *params);
 static int8_t SCSI_Verify10(USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t *params);
+static int8_t SCSI_Unmap(USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t *params);
 static int8_t SCSI_CheckAddressRange(USBD_HandleTypeDef *pdev, uint8_t lun,
                                      uint32_t blk_offset, uint32_t blk_nbr);
 
+static void SCSI_MediaStart(USBD_MSC_BOT_HandleTypeDef *hmsc, uint8_t state, uint32_t len);
+static uint8_t *SCSI_MediaBuffer(USBD_MSC_BOT_HandleTypeDef *hmsc, uint8_t idx);
 static int8_t SCSI_ProcessRead(USBD_HandleTypeDef *pdev, uint8_t lun);
 static int8_t SCSI_ProcessWrite(USBD_HandleTypeDef *pdev, uint8_t lun);
+static int8_t SCSI_ProcessUnmap(USBD_HandleTypeDef *pdev, uint8_t lun);
 
 static int8_t SCSI_UpdateBotData(USBD_MSC_BOT_HandleTypeDef *hmsc,
                                  uint8_t *pBuff, uint16_t length);
@@ -190,6 +194,10 @@ int8_t SCSI_ProcessCmd(USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t *cmd)
       ret = SCSI_Verify10(pdev, lun, cmd);
       break;
 
+    case SCSI_UNMAP:
+      ret = SCSI_Unmap(pdev, lun, cmd);
+      break;
+
     default:
       SCSI_SenseCode(pdev, lun, ILLEGAL_REQUEST, INVALID_CDB);
       hmsc->bot_status = USBD_BOT_STATUS_ERROR;
@@ -280,6 +288,16 @@ static int8_t SCSI_Inquiry(USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t *param
     {
       (void)SCSI_UpdateBotData(hmsc, MSC_Page80_Inquiry_Data, LENGTH_INQUIRY_PAGE80);
     }
+    else if ((params[2] == 0xB0U) && /* Request for VPD page 0xB0 Block Limits */
+             (((USBD_StorageTypeDef *)pdev->pUserData[pdev->classId])->Release != NULL))
+    {
+      (void)SCSI_UpdateBotData(hmsc, MSC_PageB0_Inquiry_Data, LENGTH_INQUIRY_PAGEB0);
+    }
+    else if ((params[2] == 0xB2U) && /* Request for VPD page 0xB2 Logical Block Provisioning */
+             (((USBD_StorageTypeDef *)pdev->pUserData[pdev->classId])->Release != NULL))
+    {
+      (void)SCSI_UpdateBotData(hmsc, MSC_PageB2_Inquiry_Data, LENGTH_INQUIRY_PAGEB2);
+    }
     else /* Request Not supported */
     {
       SCSI_SenseCode(pdev, hmsc->cbw.bLUN, ILLEGAL_REQUEST,
@@ -396,6 +414,12 @@ static int8_t SCSI_ReadCapacity16(USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t
   hmsc->bot_data[10] = (uint8_t)(hmsc->scsi_blk_size >>  8);
   hmsc->bot_data[11] = (uint8_t)(hmsc->scsi_blk_size);
 
+  /* LBPME: logical block provisioning (UNMAP) enabled */
+  if (((USBD_StorageTypeDef *)pdev->pUserData[pdev->classId])->Release != NULL)
+  {
+    hmsc->bot_data[14] = 0x80U;
+  }
+
   hmsc->bot_data_length = ((uint32_t)params[10] << 24) |
                           ((uint32_t)params[11] << 16) |
                           ((uint32_t)params[12] <<  8) |
@@ -632,6 +656,12 @@ static int8_t SCSI_StartStopUnit(USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t
   else if ((params[4] & 0x3U) == 0x2U) /* START=0 and LOEJ Load Eject=1 */
   {
     hmsc->scsi_medium_state = SCSI_MEDIUM_EJECTED;
+
+    /* The media may be unplugged next: let the storage make its state durable */
+    if (((USBD_StorageTypeDef *)pdev->pUserData[pdev->classId])->Eject != NULL)
+    {
+      (void)((USBD_StorageTypeDef *)pdev->pUserData[pdev->classId])->Eject(lun);
+    }
   }
   else if ((params[4] & 0x3U) == 0x3U) /* START=1 and LOEJ Load Eject=1 */
   {
@@ -737,11 +767,12 @@ static int8_t SCSI_Read10(USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t *params
       return -1;
     }
 
+    /* Data stage run by MSC_BOT_Process */
     hmsc->bot_state = USBD_BOT_DATA_IN;
+    SCSI_MediaStart(hmsc, MSC_MEDIA_READ, hmsc->cbw.dDataLength);
   }
-  hmsc->bot_data_length = MSC_MEDIA_PACKET;
 
-  return SCSI_ProcessRead(pdev, lun);
+  return 0;
 }
 
 
@@ -805,11 +836,12 @@ static int8_t SCSI_Read12(USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t *params
       return -1;
     }
 
+    /* Data stage run by MSC_BOT_Process */
     hmsc->bot_state = USBD_BOT_DATA_IN;
+    SCSI_MediaStart(hmsc, MSC_MEDIA_READ, hmsc->cbw.dDataLength);
   }
-  hmsc->bot_data_length = MSC_MEDIA_PACKET;
 
-  return SCSI_ProcessRead(pdev, lun);
+  return 0;
 }
 
 
@@ -830,11 +862,6 @@ static int8_t SCSI_Write10(USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t *param
     return -1;
   }
 
-#ifdef USE_USBD_COMPOSITE
-  /* Get the Endpoints addresses allocated for this class instance */
-  MSCOutEpAdd = USBD_CoreGetEPAdd(pdev, USBD_EP_OUT, USBD_EP_TYPE_BULK);
-#endif /* USE_USBD_COMPOSITE */
-
   if (hmsc->bot_state == USBD_BOT_IDLE) /* Idle */
   {
     if (hmsc->cbw.dDataLength == 0U)
@@ -888,15 +915,9 @@ static int8_t SCSI_Write10(USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t *param
       return -1;
     }
 
-    len = MIN(len, MSC_MEDIA_PACKET);
-
-    /* Prepare EP to receive first data packet */
+    /* Data stage run by MSC_BOT_Process */
     hmsc->bot_state = USBD_BOT_DATA_OUT;
-    (void)USBD_LL_PrepareReceive(pdev, MSCOutEpAdd, hmsc->bot_data, len);
-  }
-  else /* Write Process ongoing */
-  {
-    return SCSI_ProcessWrite(pdev, lun);
+    SCSI_MediaStart(hmsc, MSC_MEDIA_WRITE, len);
   }
 
   return 0;
@@ -919,10 +940,6 @@ static int8_t SCSI_Write12(USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t *param
   {
     return -1;
   }
-#ifdef USE_USBD_COMPOSITE
-  /* Get the Endpoints addresses allocated for this class instance */
-  MSCOutEpAdd = USBD_CoreGetEPAdd(pdev, USBD_EP_OUT, USBD_EP_TYPE_BULK);
-#endif /* USE_USBD_COMPOSITE */
 
   if (hmsc->bot_state == USBD_BOT_IDLE) /* Idle */
   {
@@ -981,15 +998,9 @@ static int8_t SCSI_Write12(USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t *param
       return -1;
     }
 
-    len = MIN(len, MSC_MEDIA_PACKET);
-
-    /* Prepare EP to receive first data packet */
+    /* Data stage run by MSC_BOT_Process */
     hmsc->bot_state = USBD_BOT_DATA_OUT;
-    (void)USBD_LL_PrepareReceive(pdev, MSCOutEpAdd, hmsc->bot_data, len);
-  }
-  else /* Write Process ongoing */
-  {
-    return SCSI_ProcessWrite(pdev, lun);
+    SCSI_MediaStart(hmsc, MSC_MEDIA_WRITE, len);
   }
 
   return 0;
@@ -1028,6 +1039,54 @@ static int8_t SCSI_Verify10(USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t *para
   return 0;
 }
 
+/**
+  * @brief  SCSI_Unmap
+  *         Process Unmap command: the parameter list is received and the
+  *         block ranges released by SCSI_ProcessUnmap
+  * @param  lun: Logical unit number
+  * @param  params: Command parameters
+  * @retval status
+  */
+static int8_t SCSI_Unmap(USBD_HandleTypeDef *pdev, uint8_t lun, uint8_t *params)
+{
+  USBD_MSC_BOT_HandleTypeDef *hmsc = (USBD_MSC_BOT_HandleTypeDef *)pdev->pClassDataCmsit[pdev->classId];
+  uint32_t len;
+
+  if (hmsc == NULL)
+  {
+    return -1;
+  }
+
+  if (((USBD_StorageTypeDef *)pdev->pUserData[pdev->classId])->Release == NULL)
+  {
+    SCSI_SenseCode(pdev, lun, ILLEGAL_REQUEST, INVALID_CDB);
+    return -1;
+  }
+
+  len = ((uint32_t)params[7] << 8) | (uint32_t)params[8];
+
+  /* No parameter list: nothing to release */
+  if (len == 0U)
+  {
+    hmsc->bot_data_length = 0U;
+    return 0;
+  }
+
+  /* case 8 : Hi <> Do, cases 3,11,13 : Hn,Ho <> D0 */
+  if (((hmsc->cbw.bmFlags & 0x80U) == 0x80U) || (hmsc->cbw.dDataLength != len) ||
+      (len > MSC_MEDIA_PACKET))
+  {
+    SCSI_SenseCode(pdev, hmsc->cbw.bLUN, ILLEGAL_REQUEST, INVALID_CDB);
+    return -1;
+  }
+
+  /* Data stage run by MSC_BOT_Process */
+  hmsc->bot_state = USBD_BOT_DATA_OUT;
+  SCSI_MediaStart(hmsc, MSC_MEDIA_UNMAP, len);
+
+  return 0;
+}
+
 /**
   * @brief  SCSI_CheckAddressRange
   *         Check address range
@@ -1055,50 +1114,160 @@ static int8_t SCSI_CheckAddressRange(USBD_HandleTypeDef *pdev, uint8_t lun,
   return 0;
 }
 
+/**
+  * @brief  SCSI_MediaStart
+  *         Arm the media pipeline for a data stage, MSC_BOT_Process
+  *         picks it up once media_state is set
+  * @param  hmsc: MSC handler
+  * @param  state: MSC_MEDIA_READ, MSC_MEDIA_WRITE or MSC_MEDIA_UNMAP
+  * @param  len: bytes the host sends (WRITE, UNMAP)
+  * @retval None
+  */
+static void SCSI_MediaStart(USBD_MSC_BOT_HandleTypeDef *hmsc, uint8_t state, uint32_t len)
+{
+  hmsc->media_wire_done = 0U;
+  hmsc->media_wire_busy = 0U;
+  hmsc->media_wire_idx = 0U;
+  hmsc->media_io_idx = 0U;
+  hmsc->media_ready = 0U;
+  hmsc->media_wire_left = len;
+  hmsc->media_state = state;
+}
+
+/**
+  * @brief  SCSI_MediaBuffer
+  *         Ping-pong buffer by index
+  * @param  hmsc: MSC handler
+  * @param  idx: 0 or 1
+  * @retval buffer
+  */
+static uint8_t *SCSI_MediaBuffer(USBD_MSC_BOT_HandleTypeDef *hmsc, uint8_t idx)
+{
+  return (idx == 0U) ? hmsc->bot_data : hmsc->bot_data_alt;
+}
+
+/**
+  * @brief  SCSI_ProcessMedia
+  *         Advance the READ/WRITE/UNMAP data stage, from MSC_BOT_Process
+  * @param  lun: Logical unit number
+  * @retval 1 when the command completed, 0 while the data stage runs,
+  *         -1 on error (bot_state USBD_BOT_NO_DATA if nothing is left on
+  *         the wire, the CSW can then be sent without stalling)
+  */
+int8_t SCSI_ProcessMedia(USBD_HandleTypeDef *pdev, uint8_t lun)
+{
+  USBD_MSC_BOT_HandleTypeDef *hmsc = (USBD_MSC_BOT_HandleTypeDef *)pdev->pClassDataCmsit[pdev->classId];
+  int8_t ret;
+
+  if (hmsc == NULL)
+  {
+    return -1;
+  }
+
+  switch (hmsc->media_state)
+  {
+    case MSC_MEDIA_READ:
+      ret = SCSI_ProcessRead(pdev, lun);
+      break;
+
+    case MSC_MEDIA_WRITE:
+      ret = SCSI_ProcessWrite(pdev, lun);
+      break;
+
+    case MSC_MEDIA_UNMAP:
+      ret = SCSI_ProcessUnmap(pdev, lun);
+      break;
+
+    default:
+      ret = 0;
+      break;
+  }
+
+  if (ret != 0)
+  {
+    hmsc->media_state = MSC_MEDIA_IDLE;
+  }
+
+  return ret;
+}
+
 /**
   * @brief  SCSI_ProcessRead
-  *         Handle Read Process
+  *         Handle Read Process: one buffer on the wire while the storage
+  *         reads the next blocks into the other one
   * @param  lun: Logical unit number
-  * @retval status
+  * @retval 1 done, 0 ongoing, -1 error
   */
 static int8_t SCSI_ProcessRead(USBD_HandleTypeDef *pdev, uint8_t lun)
 {
   USBD_MSC_BOT_HandleTypeDef *hmsc = (USBD_MSC_BOT_HandleTypeDef *)pdev->pClassDataCmsit[pdev->classId];
   uint32_t len;
+  uint8_t idx;
 
   if (hmsc == NULL)
   {
     return -1;
   }
 
-  len = hmsc->scsi_blk_len * hmsc->scsi_blk_size;
-
 #ifdef USE_USBD_COMPOSITE
   /* Get the Endpoints addresses allocated for this class instance */
   MSCInEpAdd  = USBD_CoreGetEPAdd(pdev, USBD_EP_IN, USBD_EP_TYPE_BULK);
 #endif /* USE_USBD_COMPOSITE */
 
-  len = MIN(len, MSC_MEDIA_PACKET);
-
-  if (((USBD_StorageTypeDef *)pdev->pUserData[pdev->classId])->Read(lun, hmsc->bot_data,
-                                                                    hmsc->scsi_blk_addr,
-                                                                    (len / hmsc->scsi_blk_size)) < 0)
+  for (;;)
   {
-    SCSI_SenseCode(pdev, lun, HARDWARE_ERROR, UNRECOVERED_READ_ERROR);
-    return -1;
-  }
+    if (hmsc->media_wire_done != 0U)
+    {
+      hmsc->media_wire_done = 0U;
+      hmsc->media_wire_busy = 0U;
+      hmsc->media_wire_idx ^= 1U;
+    }
 
-  (void)USBD_LL_Transmit(pdev, MSCInEpAdd, hmsc->bot_data, len);
+    if ((hmsc->media_wire_busy == 0U) && (hmsc->media_ready != 0U))
+    {
+      /* Send the oldest filled buffer */
+      idx = hmsc->media_wire_idx;
+      len = hmsc->media_len[idx];
 
-  hmsc->scsi_blk_addr += (len / hmsc->scsi_blk_size);
-  hmsc->scsi_blk_len -= (len / hmsc->scsi_blk_size);
+      hmsc->media_ready--;
+      hmsc->media_wire_busy = 1U;
 
-  /* case 6 : Hi = Di */
-  hmsc->csw.dDataResidue -= len;
+      /* case 6 : Hi = Di */
+      hmsc->csw.dDataResidue -= len;
+
+      (void)USBD_LL_Transmit(pdev, MSCInEpAdd, SCSI_MediaBuffer(hmsc, idx), len);
+    }
+    else if ((hmsc->scsi_blk_len != 0U) &&
+             ((hmsc->media_ready + hmsc->media_wire_busy) < 2U))
+    {
+      /* Read ahead into the free buffer */
+      idx = hmsc->media_io_idx;
+      len = MIN(hmsc->scsi_blk_len * hmsc->scsi_blk_size, MSC_MEDIA_PACKET);
+
+      if (((USBD_StorageTypeDef *)pdev->pUserData[pdev->classId])->Read(lun, SCSI_MediaBuffer(hmsc, idx),
+                                                                        hmsc->scsi_blk_addr,
+                                                                        (len / hmsc->scsi_blk_size)) < 0)
+      {
+        SCSI_SenseCode(pdev, lun, HARDWARE_ERROR, UNRECOVERED_READ_ERROR);
+        return -1;
+      }
+
+      hmsc->scsi_blk_addr += (len / hmsc->scsi_blk_size);
+      hmsc->scsi_blk_len -= (len / hmsc->scsi_blk_size);
+
+      hmsc->media_len[idx] = len;
+      hmsc->media_ready++;
+      hmsc->media_io_idx ^= 1U;
+    }
+    else
+    {
+      break;
+    }
+  }
 
-  if (hmsc->scsi_blk_len == 0U)
+  if ((hmsc->scsi_blk_len == 0U) && (hmsc->media_ready == 0U) && (hmsc->media_wire_busy == 0U))
   {
-    hmsc->bot_state = USBD_BOT_LAST_DATA_IN;
+    return 1;
   }
 
   return 0;
@@ -1106,56 +1275,183 @@ static int8_t SCSI_ProcessRead(USBD_HandleTypeDef *pdev, uint8_t lun)
 
 /**
   * @brief  SCSI_ProcessWrite
-  *         Handle Write Process
+  *         Handle Write Process: the host fills one buffer while the
+  *         storage commits the other one
   * @param  lun: Logical unit number
-  * @retval status
+  * @retval 1 done, 0 ongoing, -1 error
   */
 static int8_t SCSI_ProcessWrite(USBD_HandleTypeDef *pdev, uint8_t lun)
 {
   USBD_MSC_BOT_HandleTypeDef *hmsc = (USBD_MSC_BOT_HandleTypeDef *)pdev->pClassDataCmsit[pdev->classId];
   uint32_t len;
+  uint8_t idx;
 
   if (hmsc == NULL)
   {
     return -1;
   }
 
-  len = hmsc->scsi_blk_len * hmsc->scsi_blk_size;
-
 #ifdef USE_USBD_COMPOSITE
   /* Get the Endpoints addresses allocated for this class instance */
   MSCOutEpAdd = USBD_CoreGetEPAdd(pdev, USBD_EP_OUT, USBD_EP_TYPE_BULK);
 #endif /* USE_USBD_COMPOSITE */
 
-  len = MIN(len, MSC_MEDIA_PACKET);
+  for (;;)
+  {
+    if (hmsc->media_wire_done != 0U)
+    {
+      hmsc->media_wire_done = 0U;
+      hmsc->media_wire_busy = 0U;
+      hmsc->media_ready++;
+      hmsc->media_wire_idx ^= 1U;
+    }
+
+    if ((hmsc->media_wire_busy == 0U) && (hmsc->media_wire_left != 0U) &&
+        (hmsc->media_ready < 2U))
+    {
+      /* Prepare EP to receive the next packet into the free buffer */
+      idx = hmsc->media_wire_idx;
+      len = MIN(hmsc->media_wire_left, MSC_MEDIA_PACKET);
+
+      hmsc->media_len[idx] = len;
+      hmsc->media_wire_left -= len;
+      hmsc->media_wire_busy = 1U;
+
+      (void)USBD_LL_PrepareReceive(pdev, MSCOutEpAdd, SCSI_MediaBuffer(hmsc, idx), len);
+    }
+    else if (hmsc->media_ready != 0U)
+    {
+      /* Commit the oldest received buffer */
+      idx = hmsc->media_io_idx;
+      len = hmsc->media_len[idx];
+
+      if (((USBD_StorageTypeDef *)pdev->pUserData[pdev->classId])->Write(lun, SCSI_MediaBuffer(hmsc, idx),
+                                                                         hmsc->scsi_blk_addr,
+                                                                         (len / hmsc->scsi_blk_size)) < 0)
+      {
+        SCSI_SenseCode(pdev, lun, HARDWARE_ERROR, WRITE_FAULT);
+
+        /* Whole data stage received: no need to stall */
+        if ((hmsc->media_wire_left == 0U) && (hmsc->media_wire_busy == 0U))
+        {
+          hmsc->bot_state = USBD_BOT_NO_DATA;
+        }
+        return -1;
+      }
+
+      hmsc->scsi_blk_addr += (len / hmsc->scsi_blk_size);
+      hmsc->scsi_blk_len -= (len / hmsc->scsi_blk_size);
+
+      /* case 12 : Ho = Do */
+      hmsc->csw.dDataResidue -= len;
+
+      hmsc->media_ready--;
+      hmsc->media_io_idx ^= 1U;
+    }
+    else
+    {
+      break;
+    }
+  }
+
+  return (hmsc->scsi_blk_len == 0U) ? 1 : 0;
+}
 
-  if (((USBD_StorageTypeDef *)pdev->pUserData[pdev->classId])->Write(lun, hmsc->bot_data,
-                                                                     hmsc->scsi_blk_addr,
-                                                                     (len / hmsc->scsi_blk_size)) < 0)
+/**
+  * @brief  SCSI_ProcessUnmap
+  *         Handle Unmap Process: receive the parameter list, then release
+  *         every block range it describes through the storage Release callback
+  * @param  lun: Logical unit number
+  * @retval 1 done, 0 ongoing, -1 error
+  */
+static int8_t SCSI_ProcessUnmap(USBD_HandleTypeDef *pdev, uint8_t lun)
+{
+  USBD_MSC_BOT_HandleTypeDef *hmsc = (USBD_MSC_BOT_HandleTypeDef *)pdev->pClassDataCmsit[pdev->classId];
+  USBD_StorageTypeDef *pStorage = (USBD_StorageTypeDef *)pdev->pUserData[pdev->classId];
+  uint32_t len;
+  uint32_t desc_len;
+  uint32_t idx;
+
+  if (hmsc == NULL)
   {
-    SCSI_SenseCode(pdev, lun, HARDWARE_ERROR, WRITE_FAULT);
     return -1;
   }
 
-  hmsc->scsi_blk_addr += (len / hmsc->scsi_blk_size);
-  hmsc->scsi_blk_len -= (len / hmsc->scsi_blk_size);
+#ifdef USE_USBD_COMPOSITE
+  /* Get the Endpoints addresses allocated for this class instance */
+  MSCOutEpAdd = USBD_CoreGetEPAdd(pdev, USBD_EP_OUT, USBD_EP_TYPE_BULK);
+#endif /* USE_USBD_COMPOSITE */
+
+  if (hmsc->media_wire_left != 0U)
+  {
+    /* Prepare EP to receive the parameter list */
+    hmsc->media_len[0] = hmsc->media_wire_left;
+    hmsc->media_wire_left = 0U;
+    hmsc->media_wire_busy = 1U;
+    (void)USBD_LL_PrepareReceive(pdev, MSCOutEpAdd, hmsc->bot_data, hmsc->media_len[0]);
+    return 0;
+  }
+
+  if (hmsc->media_wire_done == 0U)
+  {
+    return 0;
+  }
+
+  hmsc->media_wire_done = 0U;
+  hmsc->media_wire_busy = 0U;
 
-  /* case 12 : Ho = Do */
+  /* Parameter list received: 8 byte header, then 16 byte block descriptors
+     (8 byte LBA, 4 byte block count, 4 reserved) */
+  len = hmsc->media_len[0];
   hmsc->csw.dDataResidue -= len;
+  hmsc->bot_state = USBD_BOT_NO_DATA;
 
-  if (hmsc->scsi_blk_len == 0U)
+  desc_len = ((uint32_t)hmsc->bot_data[2] << 8) | (uint32_t)hmsc->bot_data[3];
+  if ((len < 8U) || (desc_len > (len - 8U)))
   {
-    MSC_BOT_SendCSW(pdev, USBD_CSW_CMD_PASSED);
+    SCSI_SenseCode(pdev, lun, ILLEGAL_REQUEST, INVALID_FIELD_IN_PARAMETER_LIST);
+    return -1;
   }
-  else
+
+  for (idx = 8U; (idx + 16U) <= (8U + desc_len); idx += 16U)
   {
-    len = MIN((hmsc->scsi_blk_len * hmsc->scsi_blk_size), MSC_MEDIA_PACKET);
+    uint8_t *pDesc = &hmsc->bot_data[idx];
+    uint32_t blk_addr = ((uint32_t)pDesc[4] << 24) | ((uint32_t)pDesc[5] << 16) |
+                        ((uint32_t)pDesc[6] << 8) | (uint32_t)pDesc[7];
+    uint32_t blk_nbr = ((uint32_t)pDesc[8] << 24) | ((uint32_t)pDesc[9] << 16) |
+                       ((uint32_t)pDesc[10] << 8) | (uint32_t)pDesc[11];
+
+    if ((pDesc[0] | pDesc[1] | pDesc[2] | pDesc[3]) != 0U)
+    {
+      SCSI_SenseCode(pdev, lun, ILLEGAL_REQUEST, ADDRESS_OUT_OF_RANGE);
+      return -1;
+    }
+
+    if (blk_nbr == 0U)
+    {
+      continue;
+    }
+
+    /* Checked in two steps, blk_addr + blk_nbr may wrap */
+    if (blk_nbr > hmsc->scsi_blk_nbr)
+    {
+      SCSI_SenseCode(pdev, lun, ILLEGAL_REQUEST, ADDRESS_OUT_OF_RANGE);
+      return -1;
+    }
 
-    /* Prepare EP to Receive next packet */
-    (void)USBD_LL_PrepareReceive(pdev, MSCOutEpAdd, hmsc->bot_data, len);
+    if (SCSI_CheckAddressRange(pdev, lun, blk_addr, blk_nbr) < 0)
+    {
+      return -1; /* error */
+    }
+
+    if (pStorage->Release(lun, blk_addr, blk_nbr) < 0)
+    {
+      SCSI_SenseCode(pdev, lun, HARDWARE_ERROR, WRITE_FAULT);
+      return -1;
+    }
   }
 
-  return 0;
+  return 1;
 }
 
 
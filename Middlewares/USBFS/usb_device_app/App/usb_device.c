@@ -33,6 +33,12 @@
 /* USER CODE BEGIN PV */
 /* Private variables ---------------------------------------------------------*/
 
+/* Host quiet time before the storage idle work starts, in ms */
+#define USB_DEVICE_IDLE_MS  200U
+
+/* Tick of the last running MSC media data stage */
+static uint32_t usb_device_busy_tick;
+
 /* USER CODE END PV */
 
 /* USER CODE BEGIN PFP */
@@ -55,6 +61,28 @@ USBD_HandleTypeDef hUsbDeviceFS;
  */
 /* USER CODE BEGIN 1 */
 
+/**
+  * Run the MSC media data stage (storage reads/writes) and the storage idle work,
+  * call from the main loop
+  * @retval None
+  */
+void MX_USB_DEVICE_Process(void)
+{
+  USBD_MSC_BOT_HandleTypeDef *hmsc = (USBD_MSC_BOT_HandleTypeDef *)hUsbDeviceFS.pClassDataCmsit[hUsbDeviceFS.classId];
+
+  MSC_BOT_Process(&hUsbDeviceFS);
+
+  /* Storage idle work (LevelX background reclaim) once the host has been quiet for a while */
+  if ((hmsc != NULL) && (hmsc->media_state != MSC_MEDIA_IDLE))
+  {
+    usb_device_busy_tick = HAL_GetTick();
+  }
+  else if ((HAL_GetTick() - usb_device_busy_tick) >= USB_DEVICE_IDLE_MS)
+  {
+    STORAGE_Idle_FS();
+  }
+}
+
 /* USER CODE END 1 */
 
 /**
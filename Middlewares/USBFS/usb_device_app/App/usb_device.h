@@ -81,7 +81,8 @@ void MX_USB_DEVICE_Init(void);
  * -- Insert functions declaration here --
  */
 /* USER CODE BEGIN FD */
-
+/** USB MSC storage side, polled from the main loop. */
+void MX_USB_DEVICE_Process(void);
 /* USER CODE END FD */
 /**
   * @}
@@ -22,7 +22,9 @@
 #include "usbd_storage_if.h"
 
 /* USER CODE BEGIN INCLUDE */
+#include <redfs.h>
 
+#include "lx_api.h"
 /* USER CODE END INCLUDE */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -32,7 +34,10 @@
 /* USER CODE BEGIN PV */
 /* Private variables ---------------------------------------------------------*/
 
-// RAM disk buffer
+/* The LUN is the LevelX NOR volume also used by Reliance Edge (osbdev.c).
+   The host owns the media while the LUN is exposed: the volume must not be
+   mounted by Reliance Edge at the same time. */
+extern LX_NOR_FLASH nor_mem_desc;
 /* USER CODE END PV */
 
 /** @addtogroup STM32_USB_OTG_DEVICE_LIBRARY
@@ -64,11 +69,13 @@
   */
 
 #define STORAGE_LUN_NBR                  1
-#define STORAGE_BLK_NBR                  0x100
-#define STORAGE_BLK_SIZ                  0x200
+#define STORAGE_BLK_SIZ                  (LX_NOR_SECTOR_SIZE * sizeof(ULONG))
 
 /* USER CODE BEGIN PRIVATE_DEFINES */
 
+/* Flash time one idle call may spend on LevelX background reclaim (one block erase) */
+#define STORAGE_RECLAIM_BUDGET_US        750000U
+
 /* USER CODE END PRIVATE_DEFINES */
 
 /**
@@ -115,6 +122,16 @@ const int8_t STORAGE_Inquirydata_FS[] = {/* 36 */
 
 /* USER CODE BEGIN PRIVATE_VARIABLES */
 
+/* LevelX opened by STORAGE_Open_FS */
+static uint8_t storage_ready = 0U;
+
+/* Aligned bounce sector for unaligned class buffers */
+static ULONG storage_sector[LX_NOR_SECTOR_SIZE] __attribute__((aligned(4)));
+
+/* Host ejected the medium (set from the USB interrupt): no background work changes
+   the flash until the host writes again */
+static volatile uint8_t storage_ejected = 0U;
+
 /* USER CODE END PRIVATE_VARIABLES */
 
 /**
@@ -150,7 +167,8 @@ static int8_t STORAGE_Write_FS(uint8_t lun, uint8_t *buf, uint32_t blk_addr, uin
 static int8_t STORAGE_GetMaxLun_FS(void);
 
 /* USER CODE BEGIN PRIVATE_FUNCTIONS_DECLARATION */
-
+static int8_t STORAGE_Release_FS(uint8_t lun, uint32_t blk_addr, uint32_t blk_len);
+static int8_t STORAGE_Eject_FS(uint8_t lun);
 /* USER CODE END PRIVATE_FUNCTIONS_DECLARATION */
 
 /**
@@ -166,7 +184,9 @@ USBD_StorageTypeDef USBD_Storage_Interface_fops_FS =
   STORAGE_Read_FS,
   STORAGE_Write_FS,
   STORAGE_GetMaxLun_FS,
-  (int8_t *)STORAGE_Inquirydata_FS
+  (int8_t *)STORAGE_Inquirydata_FS,
+  STORAGE_Release_FS,
+  STORAGE_Eject_FS
 };
 
 /* Private functions ---------------------------------------------------------*/
@@ -178,9 +198,11 @@ USBD_StorageTypeDef USBD_Storage_Interface_fops_FS =
 int8_t STORAGE_Init_FS(uint8_t lun)
 {
   /* USER CODE BEGIN 2 */
- UNUSED(lun);
+  UNUSED(lun);
 
-  return (USBD_OK);
+  /* Called from the SET_CONFIGURATION interrupt: the flash scan and the recovery writes
+     of the open can't run here, LevelX is opened by STORAGE_Open_FS before the device starts */
+  return (storage_ready != 0U) ? (USBD_OK) : (USBD_FAIL);
   /* USER CODE END 2 */
 }
 
@@ -196,7 +218,15 @@ int8_t STORAGE_GetCapacity_FS(uint8_t lun, uint32_t *block_num, uint16_t *block_
   /* USER CODE BEGIN 3 */
   UNUSED(lun);
 
-  *block_num  = STORAGE_BLK_NBR;
+  if (storage_ready == 0U)
+  {
+    return (USBD_FAIL);
+  }
+
+  /* LevelX needs one block of free sectors to reclaim into, so the logical
+     capacity is one block smaller than the physical sector count */
+  *block_num  = nor_mem_desc.lx_nor_flash_total_physical_sectors -
+                nor_mem_desc.lx_nor_flash_physical_sectors_per_block;
   *block_size = STORAGE_BLK_SIZ;
   return (USBD_OK);
   /* USER CODE END 3 */
@@ -212,7 +242,7 @@ int8_t STORAGE_IsReady_FS(uint8_t lun)
   /* USER CODE BEGIN 4 */
   UNUSED(lun);
 
-  return (USBD_OK);
+  return (storage_ready != 0U) ? (USBD_OK) : (USBD_FAIL);
   /* USER CODE END 4 */
 }
 
@@ -241,6 +271,29 @@ int8_t STORAGE_IsWriteProtected_FS(uint8_t lun)
 int8_t STORAGE_Read_FS(uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t blk_len)
 {
   /* USER CODE BEGIN 6 */
+  UNUSED(lun);
+
+  if (storage_ready == 0U)
+  {
+    return (USBD_FAIL);
+  }
+
+  /* Whole MSC_MEDIA_PACKET in one request, contiguous runs are read in one burst */
+  if (((uintptr_t)buf & 3U) == 0U)
+  {
+    return (_lx_nor_flash_sectors_read(&nor_mem_desc, blk_addr, buf, blk_len) == LX_SUCCESS) ? (USBD_OK) : (USBD_FAIL);
+  }
+
+  for (uint32_t cnt = 0; cnt < blk_len; cnt++)
+  {
+    if (_lx_nor_flash_sector_read(&nor_mem_desc, blk_addr + cnt, storage_sector) != LX_SUCCESS)
+    {
+      return (USBD_FAIL);
+    }
+
+    memcpy(&buf[cnt * STORAGE_BLK_SIZ], storage_sector, STORAGE_BLK_SIZ);
+  }
+
   return (USBD_OK);
   /* USER CODE END 6 */
 }
@@ -255,11 +308,34 @@ int8_t STORAGE_Read_FS(uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t bl
   */
 int8_t STORAGE_Write_FS(uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t blk_len)
 {
-    /* USER CODE BEGIN 7 */
+  /* USER CODE BEGIN 7 */
+  UNUSED(lun);
 
+  if (storage_ready == 0U)
+  {
+    return (USBD_FAIL);
+  }
 
-    return (USBD_OK);
-    /* USER CODE END 7 */
+  storage_ejected = 0U;
+
+  /* Whole MSC_MEDIA_PACKET in one request, programmed in LX_NOR_SECTORS_WRITE_BATCH bursts */
+  if (((uintptr_t)buf & 3U) == 0U)
+  {
+    return (_lx_nor_flash_sectors_write(&nor_mem_desc, blk_addr, buf, blk_len) == LX_SUCCESS) ? (USBD_OK) : (USBD_FAIL);
+  }
+
+  for (uint32_t cnt = 0; cnt < blk_len; cnt++)
+  {
+    memcpy(storage_sector, &buf[cnt * STORAGE_BLK_SIZ], STORAGE_BLK_SIZ);
+
+    if (_lx_nor_flash_sector_write(&nor_mem_desc, blk_addr + cnt, storage_sector) != LX_SUCCESS)
+    {
+      return (USBD_FAIL);
+    }
+  }
+
+  return (USBD_OK);
+  /* USER CODE END 7 */
 }
 
 /**
@@ -276,6 +352,107 @@ int8_t STORAGE_GetMaxLun_FS(void)
 
 /* USER CODE BEGIN PRIVATE_FUNCTIONS_IMPLEMENTATION */
 
+/**
+  * @brief  Releases blocks the host no longer uses (SCSI UNMAP).
+  *         Released sectors are obsolete for LevelX, so reclaim does not copy them.
+  * @param  lun: Logical unit number.
+  * @param  blk_addr: Logical block address.
+  * @param  blk_len: Blocks number.
+  * @retval USBD_OK if all operations are OK else USBD_FAIL
+  */
+static int8_t STORAGE_Release_FS(uint8_t lun, uint32_t blk_addr, uint32_t blk_len)
+{
+  UNUSED(lun);
+
+  if (storage_ready == 0U)
+  {
+    return (USBD_FAIL);
+  }
+
+  storage_ejected = 0U;
+
+  for (uint32_t cnt = 0; cnt < blk_len; cnt++)
+  {
+    UINT status = _lx_nor_flash_sector_release(&nor_mem_desc, blk_addr + cnt);
+
+    /* A sector never written (or already released) is not an error */
+    if ((status != LX_SUCCESS) && (status != LX_SECTOR_NOT_FOUND))
+    {
+      return (USBD_FAIL);
+    }
+  }
+
+  return (USBD_OK);
+}
+
+/**
+  * @brief  Host ejected the medium (SCSI START STOP UNIT, LOEJ=1). Called from the
+  *         USB interrupt: the checkpoint is written by the next STORAGE_Idle_FS.
+  * @param  lun: Logical unit number.
+  * @retval USBD_OK
+  */
+static int8_t STORAGE_Eject_FS(uint8_t lun)
+{
+  UNUSED(lun);
+
+  storage_ejected = 1U;
+
+  return (USBD_OK);
+}
+
+/**
+  * @brief  Opens LevelX with the same mapping table and extended cache as Reliance Edge
+  *         (does nothing if the block device is already open). Called from main()
+  *         before MX_USB_DEVICE_Init, the LUN reports not ready if it fails.
+  * @retval USBD_OK if all operations are OK else USBD_FAIL
+  */
+int8_t STORAGE_Open_FS(void)
+{
+  if (RedOsBDevOpen(0U, BDEV_O_RDWR) != 0)
+  {
+    storage_ready = 0U;
+    return (USBD_FAIL);
+  }
+
+  storage_ready = 1U;
+
+  return (USBD_OK);
+}
+
+/**
+  * @brief  Lets LevelX reclaim blocks while the host leaves the medium alone, so
+  *         host writes find free sectors instead of erasing inline, then writes
+  *         the fast-mount checkpoint. While the LUN owns the media Reliance Edge
+  *         is not mounted, RedOsBDevFlush and the close never run: without this
+  *         the next boot scans every block changed since the first write.
+  * @retval None
+  */
+void STORAGE_Idle_FS(void)
+{
+  if (storage_ready == 0U)
+  {
+    return;
+  }
+
+  /* Ejected: record every changed block, the media may be unplugged at any time
+     (nothing to write once the checkpoint is current, a failed one is retried) */
+  if (storage_ejected != 0U)
+  {
+#ifdef LX_NOR_ENABLE_CHECKPOINT
+    (void)_lx_nor_flash_checkpoint_write(&nor_mem_desc, 1U);
+#endif
+    return;
+  }
+
+#ifdef LX_NOR_ENABLE_BACKGROUND_RECLAIM
+  (void)_lx_nor_flash_background_reclaim(&nor_mem_desc, STORAGE_RECLAIM_BUDGET_US, NULL);
+#endif
+
+#ifdef LX_NOR_ENABLE_CHECKPOINT
+  (void)_lx_nor_flash_checkpoint_write(&nor_mem_desc, LX_NOR_CHECKPOINT_DIRTY_BLOCKS);
+#endif
+}
+
 /* USER CODE END PRIVATE_FUNCTIONS_IMPLEMENTATION */
 
 /**
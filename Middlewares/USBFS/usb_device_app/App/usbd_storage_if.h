@@ -105,6 +105,9 @@ extern USBD_StorageTypeDef USBD_Storage_Interface_fops_FS;
 
 /* USER CODE BEGIN EXPORTED_FUNCTIONS */
 
+int8_t STORAGE_Open_FS(void);
+void STORAGE_Idle_FS(void);
+
 /* USER CODE END EXPORTED_FUNCTIONS */
 
 /**
@@ -75,7 +75,9 @@
 /*---------- -----------*/
 #define USBD_SELF_POWERED     1U
 /*---------- -----------*/
-#define MSC_MEDIA_PACKET     512U
+/* One LevelX write batch (LX_NOR_SECTORS_WRITE_BATCH x 512 byte sectors) per
+   storage call instead of a single sector */
+#define MSC_MEDIA_PACKET     4096U
 
 /****************************************/
 /* #define for FS and HS identification */